@@ -0,0 +1,85 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <format>
+#include <string>
+#include <string_view>
+
+namespace sr::fedora {
+
+// How the system-audio and microphone tracks are captured.
+//   Pulse:    pulsesrc through PipeWire's Pulse compatibility layer. Every
+//             source converts and resamples on its own, the mix is
+//             converted again, and each source queues up to 2 s.
+//   PipeWire: pipewiresrc negotiates F32LE/48 kHz/stereo with the graph
+//             (PipeWire's adapter does any conversion), the mixer
+//             passes that through, and only the encoder's one audioconvert
+//             remains. The queues hold latency_ms, and node.latency asks
+//             the graph for the given quantum.
+enum class AudioBackend { Pulse, PipeWire };
+
+constexpr std::string_view audio_backend_key(AudioBackend backend) {
+    return backend == AudioBackend::PipeWire ? "pipewire" : "pulse";
+}
+
+constexpr AudioBackend parse_audio_backend(std::string_view key) {
+    return key == "pipewire" ? AudioBackend::PipeWire : AudioBackend::Pulse;
+}
+
+constexpr int kAudioRate = 48000;
+
+struct AudioCaptureTuning {
+    int quantum{1024};     // frames per PipeWire cycle (21 ms at 48 kHz)
+    int latency_ms{100};   // per-source queue limit
+};
+
+constexpr AudioCaptureTuning clamp_audio_tuning(AudioCaptureTuning tuning) {
+    return {std::clamp(tuning.quantum, 64, 8192), std::clamp(tuning.latency_ms, 10, 2000)};
+}
+
+// The audio part of the recording pipeline, from the sources to `mux_pad`.
+// Empty without any audio track.
+inline std::string audio_branch_description(AudioBackend backend, AudioCaptureTuning tuning,
+                                            bool system_audio, bool microphone, std::string_view mux_pad) {
+    if (!system_audio && !microphone) return {};
+    constexpr std::string_view expander =
+        "audiodynamic mode=expander threshold=0.02 ratio=4 characteristics=soft-knee ! audio_mix. ";
+    const auto encoder = std::format("volume name=audio_volume ! audioconvert ! avenc_aac bitrate=128000 "
+                                     "! aacparse name=audio_parse ! queue ! {} ", mux_pad);
+    if (backend == AudioBackend::Pulse) {
+        auto description = std::format("audiomixer name=audio_mix ! audioconvert ! audioresample ! "
+                                       "audio/x-raw,format=F32LE,rate={},channels=2 ! volume name=audio_volume ! "
+                                       "avenc_aac bitrate=128000 ! aacparse name=audio_parse ! queue ! {} ",
+                                       kAudioRate, mux_pad);
+        if (system_audio) {
+            // The Pulse compatibility monitor is the PipeWire desktop-output
+            // loopback; the ordinary default source would be the microphone.
+            description += "pulsesrc device=@DEFAULT_MONITOR@ do-timestamp=true ! queue max-size-buffers=12 "
+                           "max-size-time=2000000000 leaky=downstream ! audioconvert ! audioresample ! audio_mix. ";
+        }
+        if (microphone) {
+            description += "pulsesrc do-timestamp=true ! queue max-size-buffers=12 max-size-time=2000000000 leaky=downstream "
+                           "! audioconvert ! audioresample ! ";
+            description += expander;
+        }
+        return description;
+    }
+
+    tuning = clamp_audio_tuning(tuning);
+    const auto caps = std::format("audio/x-raw,format=F32LE,rate={},channels=2", kAudioRate);
+    const auto queue = std::format("queue max-size-buffers=0 max-size-bytes=0 max-size-time={} leaky=downstream",
+                                   static_cast<std::uint64_t>(tuning.latency_ms) * 1'000'000ULL);
+    auto source = [&](std::string_view name, std::string_view extra_properties) {
+        return std::format("pipewiresrc name={} do-timestamp=true stream-properties=\"props,media.type=Audio,"
+                           "media.category=Capture,node.latency={}/{}{}\" ! {} ! {} ! ",
+                           name, tuning.quantum, kAudioRate, extra_properties, caps, queue);
+    };
+    auto description = std::format("audiomixer name=audio_mix ! {} ! {}", caps, encoder);
+    // stream.capture.sink records the default output's monitor
+    if (system_audio) description += source("audio_capture_system", ",stream.capture.sink=true") + "audio_mix. ";
+    if (microphone) description += source("audio_capture_microphone", "") + std::string{expander};
+    return description;
+}
+
+}  // namespace sr::fedora
@@ -0,0 +1,45 @@
+#pragma once
+
+namespace sr::fedora {
+
+// Where the camera PiP is blended into the screen frames.
+enum class CameraCompositor {
+    // vacompositor: screen and camera stay in VAMemory from vapostproc to the
+    // VA encoder, so turning the camera on keeps the zero-copy path.
+    VaCompositor,
+    // glvideomixer: blends on the GPU but hands NV12 back through a single
+    // gldownload before vapostproc uploads it for the encoder.
+    GlVideoMixer,
+    // compositor: videoconvert/videoscale on both inputs, about two extra
+    // cores at 1080p. Software encoders always take this path.
+    Cpu,
+};
+
+struct CompositorAvailability {
+    bool va_compositor{};
+    bool gl_video_mixer{};
+    bool va_postproc{};
+};
+
+// A GPU compositor is only worth it when a hardware encoder consumes the VA
+// surfaces directly; `gpu_rejected` is set after a GPU variant failed to
+// start for this recording.
+constexpr CameraCompositor camera_compositor_for(bool hardware_encoder,
+                                                 const CompositorAvailability& availability,
+                                                 bool gpu_rejected) {
+    if (!hardware_encoder || gpu_rejected || !availability.va_postproc) return CameraCompositor::Cpu;
+    if (availability.va_compositor) return CameraCompositor::VaCompositor;
+    if (availability.gl_video_mixer) return CameraCompositor::GlVideoMixer;
+    return CameraCompositor::Cpu;
+}
+
+constexpr const char* camera_compositor_name(CameraCompositor compositor) {
+    switch (compositor) {
+        case CameraCompositor::VaCompositor: return "vacompositor";
+        case CameraCompositor::GlVideoMixer: return "glvideomixer";
+        case CameraCompositor::Cpu: return "compositor";
+    }
+    return "compositor";
+}
+
+}  // namespace sr::fedora
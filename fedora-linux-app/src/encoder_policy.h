@@ -1,7 +1,11 @@
 #pragma once
 
+#include <algorithm>
+#include <array>
 #include <cstddef>
 #include <cstdint>
+#include <string>
+#include <string_view>
 #include <vector>
 
 namespace sr::fedora {
@@ -29,6 +33,83 @@ inline std::vector<EncoderKind> encoder_candidates(const EncoderAvailability& av
     return candidates;
 }
 
+constexpr std::size_t kEncoderKindCount = 4;
+
+constexpr std::size_t encoder_kind_index(EncoderKind kind) {
+    return static_cast<std::size_t>(kind);
+}
+
+// Key in the probe cache and GStreamer factory used for the test encode
+constexpr std::string_view encoder_kind_key(EncoderKind kind) {
+    switch (kind) {
+        case EncoderKind::VaLowPower: return "va_low_power";
+        case EncoderKind::QuickSync: return "quick_sync";
+        case EncoderKind::VaApi: return "va_api";
+        case EncoderKind::OpenH264: return "openh264";
+    }
+    return "";
+}
+
+constexpr const char* encoder_kind_factory(EncoderKind kind) {
+    switch (kind) {
+        case EncoderKind::VaLowPower: return "vah264lpenc";
+        case EncoderKind::QuickSync: return "qsvh264enc";
+        case EncoderKind::VaApi: return "vah264enc";
+        case EncoderKind::OpenH264: return "openh264enc";
+    }
+    return "";
+}
+
+enum class ProbeState { Unknown, Passed, Failed };
+
+// Startup test-encode results. A present element can still fail to open
+// (wrong VA driver, missing firmware); probing once means the first
+// recording starts on a known-good encoder instead of discovering that
+// through a pipeline teardown. Valid only for the driver fingerprint it was
+// taken with.
+struct EncoderProbeResults {
+    std::string fingerprint;
+    std::array<ProbeState, kEncoderKindCount> state{};
+
+    ProbeState operator[](EncoderKind kind) const { return state[encoder_kind_index(kind)]; }
+    void set(EncoderKind kind, ProbeState value) { state[encoder_kind_index(kind)] = value; }
+};
+
+constexpr std::string_view probe_state_key(ProbeState state) {
+    return state == ProbeState::Passed ? "pass" : state == ProbeState::Failed ? "fail" : "";
+}
+
+constexpr ProbeState parse_probe_state(std::string_view value) {
+    if (value == "pass") return ProbeState::Passed;
+    if (value == "fail") return ProbeState::Failed;
+    return ProbeState::Unknown;
+}
+
+// Order-independent identity of the GPU, its VA/Mesa driver files and the
+// GStreamer version. Each part is e.g. "iHD_drv_video.so:123456:1712345678".
+inline std::string compose_probe_fingerprint(std::vector<std::string> parts) {
+    std::sort(parts.begin(), parts.end());
+    std::string fingerprint;
+    for (const auto& part : parts) {
+        if (!fingerprint.empty()) fingerprint += ';';
+        fingerprint += part;
+    }
+    return fingerprint;
+}
+
+// Candidates minus the ones that failed their probe. Unprobed kinds stay
+// (a probe still running, or one added since); if every kind failed the
+// original list is kept so the user sees the encoder's own error.
+inline std::vector<EncoderKind> probed_encoder_candidates(const std::vector<EncoderKind>& candidates,
+                                                          const EncoderProbeResults* probe) {
+    if (!probe) return candidates;
+    std::vector<EncoderKind> usable;
+    for (const auto kind : candidates) {
+        if ((*probe)[kind] != ProbeState::Failed) usable.push_back(kind);
+    }
+    return usable.empty() ? candidates : usable;
+}
+
 constexpr bool should_retry_encoder_startup(std::uint64_t encoded_frames,
                                             std::size_t candidate_index,
                                             std::size_t candidate_count) {
@@ -11,20 +11,30 @@
 #include "telemetry.h"
 #include "recovery_actions.h"
 #include "camera_preview_policy.h"
+#include "camera_compositor_policy.h"
 #include "recording_faults.h"
 #include "encoder_policy.h"
 #include "recording_clock.h"
+#include "output_policy.h"
+#include "power_adaptation.h"
+#include "replay_queue.h"
+#include "screen_preview_policy.h"
+#include "audio_capture_policy.h"
 
 #include <chrono>
 #include <algorithm>
 #include <atomic>
 #include <cstddef>
+#include <deque>
 #include <filesystem>
 #include <fstream>
 #include <format>
+#include <memory>
+#include <mutex>
 #include <optional>
 #include <string>
 #include <string_view>
+#include <utility>
 #include <vector>
 
 #include <unistd.h>
@@ -36,13 +46,20 @@ constexpr char kAppId[] = "io.github.screenrecorder.Fedora";
 struct AppSettings {
     bool system_audio{true};
     bool microphone{};
+    std::string audio_backend{"pulse"};   // "pulse" | "pipewire"
+    sr::fedora::AudioCaptureTuning audio_tuning{};
     bool high_quality{};
     bool battery_saver{};
     bool camera{};
     bool camera_preview{true};
+    bool screen_preview{};
     std::string camera_device;
     int fps{30};
     std::string output_dir;
+    std::string container{"mp4"};   // "mp4" | "fragmented"
+    int segment_minutes{};           // 0 = no duration limit
+    int segment_mb{};                // 0 = no size limit
+    int replay_seconds{};            // instant replay window, 0 = off
 };
 
 std::filesystem::path settings_path() {
@@ -57,6 +74,17 @@ AppSettings load_settings() {
     if (g_key_file_load_from_file(key_file, path.c_str(), G_KEY_FILE_NONE, &error)) {
         settings.system_audio = g_key_file_get_boolean(key_file, "Recording", "system_audio", nullptr);
         settings.microphone = g_key_file_get_boolean(key_file, "Recording", "microphone", nullptr);
+        gchar* backend = g_key_file_get_string(key_file, "Audio", "backend", nullptr);
+        if (backend) settings.audio_backend = sr::fedora::audio_backend_key(sr::fedora::parse_audio_backend(backend));
+        g_free(backend);
+        // Absent keys keep the defaults
+        if (g_key_file_has_key(key_file, "Audio", "quantum", nullptr)) {
+            settings.audio_tuning.quantum = g_key_file_get_integer(key_file, "Audio", "quantum", nullptr);
+        }
+        if (g_key_file_has_key(key_file, "Audio", "latency_ms", nullptr)) {
+            settings.audio_tuning.latency_ms = g_key_file_get_integer(key_file, "Audio", "latency_ms", nullptr);
+        }
+        settings.audio_tuning = sr::fedora::clamp_audio_tuning(settings.audio_tuning);
         settings.high_quality = g_key_file_get_boolean(key_file, "Video", "high_quality", nullptr);
         settings.battery_saver = g_key_file_get_boolean(key_file, "Video", "battery_saver", nullptr);
         settings.camera = g_key_file_get_boolean(key_file, "Camera", "enabled", nullptr);
@@ -68,9 +96,17 @@ AppSettings load_settings() {
         if (camera_device) settings.camera_device = camera_device;
         g_free(camera_device);
         settings.fps = g_key_file_get_integer(key_file, "Video", "fps", nullptr);
+        settings.screen_preview = g_key_file_get_boolean(key_file, "Video", "screen_preview", nullptr);
         gchar* output = g_key_file_get_string(key_file, "Storage", "output_dir", nullptr);
         if (output) settings.output_dir = output;
         g_free(output);
+        gchar* container = g_key_file_get_string(key_file, "Storage", "container", nullptr);
+        if (container) settings.container = sr::fedora::output_container_key(sr::fedora::parse_output_container(container));
+        g_free(container);
+        settings.segment_minutes = std::max(0, g_key_file_get_integer(key_file, "Storage", "segment_minutes", nullptr));
+        settings.segment_mb = std::max(0, g_key_file_get_integer(key_file, "Storage", "segment_mb", nullptr));
+        settings.replay_seconds = std::clamp(g_key_file_get_integer(key_file, "Replay", "seconds", nullptr),
+                                             0, sr::fedora::kReplayMaxSeconds);
     }
     g_clear_error(&error);
     g_key_file_unref(key_file);
@@ -84,13 +120,21 @@ void save_settings(const AppSettings& settings) {
     GKeyFile* key_file = g_key_file_new();
     g_key_file_set_boolean(key_file, "Recording", "system_audio", settings.system_audio);
     g_key_file_set_boolean(key_file, "Recording", "microphone", settings.microphone);
+    g_key_file_set_string(key_file, "Audio", "backend", settings.audio_backend.c_str());
+    g_key_file_set_integer(key_file, "Audio", "quantum", settings.audio_tuning.quantum);
+    g_key_file_set_integer(key_file, "Audio", "latency_ms", settings.audio_tuning.latency_ms);
     g_key_file_set_boolean(key_file, "Video", "high_quality", settings.high_quality);
     g_key_file_set_boolean(key_file, "Video", "battery_saver", settings.battery_saver);
     g_key_file_set_boolean(key_file, "Camera", "enabled", settings.camera);
     g_key_file_set_boolean(key_file, "Camera", "preview", settings.camera_preview);
     g_key_file_set_string(key_file, "Camera", "device", settings.camera_device.c_str());
     g_key_file_set_integer(key_file, "Video", "fps", settings.fps);
+    g_key_file_set_boolean(key_file, "Video", "screen_preview", settings.screen_preview);
     g_key_file_set_string(key_file, "Storage", "output_dir", settings.output_dir.c_str());
+    g_key_file_set_string(key_file, "Storage", "container", settings.container.c_str());
+    g_key_file_set_integer(key_file, "Storage", "segment_minutes", settings.segment_minutes);
+    g_key_file_set_integer(key_file, "Storage", "segment_mb", settings.segment_mb);
+    g_key_file_set_integer(key_file, "Replay", "seconds", settings.replay_seconds);
     gsize length = 0;
     gchar* data = g_key_file_to_data(key_file, &length, nullptr);
     const auto path = settings_path().string();
@@ -104,16 +148,16 @@ std::string default_output_directory() {
     return (std::filesystem::path(videos ? videos : g_get_home_dir()) / "Screen Recordings").string();
 }
 
-std::string output_path(const std::string& configured_output_dir) {
+std::string output_path(const std::string& configured_output_dir, std::string_view prefix = "Screen Recording") {
     const auto directory = std::filesystem::path(configured_output_dir.empty() ? default_output_directory() : configured_output_dir);
     std::error_code error;
     std::filesystem::create_directories(directory, error);
     if (error) return {};
     const auto now = std::chrono::system_clock::now();
     const auto stamp = std::format("{:%Y-%m-%d_%H-%M-%S}", now);
-    auto candidate = directory / std::format("Screen Recording {}.partial.mp4", stamp);
+    auto candidate = directory / std::format("{} {}.partial.mp4", prefix, stamp);
     for (unsigned index = 2; std::filesystem::exists(candidate); ++index) {
-        candidate = directory / std::format("Screen Recording {} ({}).partial.mp4", stamp, index);
+        candidate = directory / std::format("{} {} ({}).partial.mp4", prefix, stamp, index);
     }
     return candidate.string();
 }
@@ -133,6 +177,173 @@ bool has_element(const char* name) {
     return true;
 }
 
+// SCREEN_RECORDER_LATENCY_TRACE=1 runs GStreamer's latency (per element and
+// source-to-sink) and interlatency tracers. Their GST_TRACER log records
+// are aggregated here instead of printed, and reach the telemetry snapshot
+// and the STOP diagnostics.
+struct LatencyTrace {
+    bool enabled{};
+    std::mutex mutex;
+    sr::fedora::LatencyTable table;
+};
+
+LatencyTrace& latency_trace() {
+    static LatencyTrace trace;
+    return trace;
+}
+
+constexpr std::size_t kLatencyReportEntries = 12;
+
+void on_tracer_log(GstDebugCategory* category, GstDebugLevel, const gchar*, const gchar*, gint, GObject*,
+                   GstDebugMessage* message, gpointer) {
+    if (g_strcmp0(gst_debug_category_get_name(category), "GST_TRACER") != 0) return;
+    const gchar* text = gst_debug_message_get(message);
+    if (!text) return;
+    if (const auto sample = sr::fedora::parse_tracer_record(text)) {
+        auto& trace = latency_trace();
+        std::lock_guard lock(trace.mutex);
+        trace.table.record(*sample);
+    }
+}
+
+// Before gst_init: the tracers and the GST_TRACER threshold are read from the environment
+void enable_latency_trace_environment() {
+    if (!g_getenv("GST_TRACERS")) g_setenv("GST_TRACERS", "latency(flags=pipeline+element);interlatency", FALSE);
+    const char* debug = g_getenv("GST_DEBUG");
+    g_setenv("GST_DEBUG", debug ? std::format("{},GST_TRACER:7", debug).c_str() : "GST_TRACER:7", TRUE);
+    latency_trace().enabled = true;
+}
+
+// After gst_init. Without a user GST_DEBUG the default stderr logger would
+// only print tracer records, so it is replaced rather than joined.
+void install_latency_trace_logger(bool user_debug) {
+    if (!latency_trace().enabled) return;
+    if (!user_debug) gst_debug_remove_log_function(gst_debug_log_default);
+    gst_debug_add_log_function(on_tracer_log, nullptr, nullptr);
+}
+
+void reset_latency_trace() {
+    auto& trace = latency_trace();
+    if (!trace.enabled) return;
+    std::lock_guard lock(trace.mutex);
+    trace.table.clear();
+}
+
+std::vector<sr::fedora::ElementLatency> latency_trace_snapshot() {
+    auto& trace = latency_trace();
+    if (!trace.enabled) return {};
+    std::lock_guard lock(trace.mutex);
+    return trace.table.slowest(kLatencyReportEntries);
+}
+
+// Owning GstBuffer reference held by the replay queue
+class BufferRef {
+public:
+    BufferRef() = default;
+    explicit BufferRef(GstBuffer* buffer) : buffer_(gst_buffer_ref(buffer)) {}
+    BufferRef(const BufferRef& other) : buffer_(other.buffer_ ? gst_buffer_ref(other.buffer_) : nullptr) {}
+    BufferRef(BufferRef&& other) noexcept : buffer_(std::exchange(other.buffer_, nullptr)) {}
+    BufferRef& operator=(BufferRef other) noexcept {
+        std::swap(buffer_, other.buffer_);
+        return *this;
+    }
+    ~BufferRef() {
+        if (buffer_) gst_buffer_unref(buffer_);
+    }
+    GstBuffer* get() const { return buffer_; }
+
+private:
+    GstBuffer* buffer_{};
+};
+
+using ReplayQueue = sr::fedora::ReplayQueue<BufferRef>;
+
+// A snapshot of the replay queue handed to the save worker
+struct ReplayClip {
+    std::deque<ReplayQueue::Entry> entries;
+    std::int64_t offset{};
+    GstCaps* video_caps{};
+    GstCaps* audio_caps{};   // null without an audio track
+    std::string partial_path;
+
+    ReplayClip() = default;
+    ReplayClip(const ReplayClip&) = delete;
+    ReplayClip& operator=(const ReplayClip&) = delete;
+    ~ReplayClip() {
+        if (video_caps) gst_caps_unref(video_caps);
+        if (audio_caps) gst_caps_unref(audio_caps);
+    }
+};
+
+// Muxes the clip once through mp4mux and renames it from .partial. Runs on
+// a worker thread; the buffers are shallow copies re-timed to start at zero.
+bool write_replay_clip(const ReplayClip& clip, std::string& failure) {
+    gchar* escaped_path = g_strescape(clip.partial_path.c_str(), nullptr);
+    const auto description = sr::fedora::replay_save_description(escaped_path, clip.audio_caps != nullptr);
+    g_free(escaped_path);
+    GError* error = nullptr;
+    GstElement* pipeline = gst_parse_launch(description.c_str(), &error);
+    if (!pipeline) {
+        failure = error ? error->message : "unknown error";
+        g_clear_error(&error);
+        return false;
+    }
+    g_clear_error(&error);
+    GstElement* video = gst_bin_get_by_name(GST_BIN(pipeline), "replay_video_src");
+    GstElement* audio = gst_bin_get_by_name(GST_BIN(pipeline), "replay_audio_src");
+    g_object_set(video, "caps", clip.video_caps, nullptr);
+    if (audio) g_object_set(audio, "caps", clip.audio_caps, nullptr);
+    bool pushed = gst_element_set_state(pipeline, GST_STATE_PLAYING) != GST_STATE_CHANGE_FAILURE;
+    const bool started = pushed;
+    for (const auto& entry : clip.entries) {
+        if (!pushed) break;
+        GstElement* source = entry.video ? video : audio;
+        // Audio captured just ahead of the first keyframe is not part of the clip
+        if (!source || (entry.video ? entry.dts : entry.pts) < clip.offset) continue;
+        GstBuffer* buffer = gst_buffer_copy(entry.sample.get());
+        GST_BUFFER_PTS(buffer) = static_cast<GstClockTime>(entry.pts - clip.offset);
+        GST_BUFFER_DTS(buffer) = entry.video ? static_cast<GstClockTime>(entry.dts - clip.offset) : GST_CLOCK_TIME_NONE;
+        GstFlowReturn flow = GST_FLOW_OK;
+        g_signal_emit_by_name(source, "push-buffer", buffer, &flow);
+        gst_buffer_unref(buffer);
+        pushed = flow == GST_FLOW_OK;
+    }
+    bool completed = false;
+    if (started) {
+        GstFlowReturn flow = GST_FLOW_OK;
+        g_signal_emit_by_name(video, "end-of-stream", &flow);
+        if (audio) g_signal_emit_by_name(audio, "end-of-stream", &flow);
+        GstBus* bus = gst_element_get_bus(pipeline);
+        GstMessage* message = gst_bus_timed_pop_filtered(
+            bus, GST_CLOCK_TIME_NONE, static_cast<GstMessageType>(GST_MESSAGE_EOS | GST_MESSAGE_ERROR));
+        if (message && GST_MESSAGE_TYPE(message) == GST_MESSAGE_ERROR) {
+            GError* bus_error = nullptr;
+            gst_message_parse_error(message, &bus_error, nullptr);
+            failure = bus_error ? bus_error->message : "unknown error";
+            g_clear_error(&bus_error);
+        } else {
+            completed = message != nullptr;
+        }
+        if (message) gst_message_unref(message);
+        gst_object_unref(bus);
+    } else {
+        failure = "the MP4 writer could not start";
+    }
+    gst_element_set_state(pipeline, GST_STATE_NULL);
+    if (audio) gst_object_unref(audio);
+    gst_object_unref(video);
+    gst_object_unref(pipeline);
+
+    std::error_code file_error;
+    if (!completed) {
+        std::filesystem::remove(clip.partial_path, file_error);
+        return false;
+    }
+    std::filesystem::rename(clip.partial_path, final_path_for(clip.partial_path), file_error);
+    if (file_error) failure = file_error.message();
+    return !file_error;
+}
+
 using sr::fedora::RecordingProfile;
 
 struct EncoderChoice {
@@ -174,13 +385,18 @@ RecordingProfile selected_profile(bool high_quality, bool battery_saver, int fps
     return sr::fedora::profile_for(high_quality, battery_saver, is_on_ac_power(), fps);
 }
 
-std::vector<EncoderChoice> choose_encoders(const RecordingProfile& profile) {
+sr::fedora::EncoderAvailability encoder_availability() {
+    return {has_element("vah264lpenc"), has_element("qsvh264enc"), has_element("vah264enc"), has_element("openh264enc")};
+}
+
+std::vector<EncoderChoice> choose_encoders(const RecordingProfile& profile,
+                                           const sr::fedora::EncoderProbeResults* probe = nullptr) {
     // The Iris Xe driver exposes VA low-power H.264. These branches preserve
     // DMABUF/VAMemory through vapostproc, avoiding a CPU encoder on the normal
     // no-camera path. OpenH264 is a portable fallback only.
     std::vector<EncoderChoice> candidates;
-    const auto available = sr::fedora::encoder_candidates({
-        has_element("vah264lpenc"), has_element("qsvh264enc"), has_element("vah264enc"), has_element("openh264enc")});
+    const auto available = sr::fedora::probed_encoder_candidates(
+        sr::fedora::encoder_candidates(encoder_availability()), probe);
     for (const auto kind : available) {
         switch (kind) {
             case sr::fedora::EncoderKind::VaLowPower:
@@ -200,6 +416,128 @@ std::vector<EncoderChoice> choose_encoders(const RecordingProfile& profile) {
     return candidates;
 }
 
+std::filesystem::path encoder_probe_path() {
+    return settings_path().parent_path() / "encoder-probe.ini";
+}
+
+// GPU, VA driver, Mesa and GStreamer identity. Driver files are identified by
+// size and mtime: any package update rewrites them, and a stat is far cheaper
+// than loading libva to ask each driver for its version.
+std::string encoder_probe_fingerprint() {
+    std::vector<std::string> parts;
+    gchar* gst_version = gst_version_string();
+    parts.emplace_back(gst_version);
+    g_free(gst_version);
+    if (const char* driver = g_getenv("LIBVA_DRIVER_NAME")) parts.push_back(std::format("LIBVA_DRIVER_NAME={}", driver));
+
+    const auto first_line = [](const std::filesystem::path& path) {
+        std::ifstream file(path);
+        std::string line;
+        std::getline(file, line);
+        return line;
+    };
+    std::error_code error;
+    for (std::filesystem::directory_iterator it("/sys/class/drm", error), end; !error && it != end; it.increment(error)) {
+        const auto name = it->path().filename().string();
+        if (!name.starts_with("renderD")) continue;
+        parts.push_back(std::format("{}={}:{}", name, first_line(it->path() / "device" / "vendor"),
+                                    first_line(it->path() / "device" / "device")));
+    }
+
+    std::vector<std::filesystem::path> driver_dirs{
+        "/usr/lib64/dri", "/usr/lib64/dri-nonfree", "/usr/lib64/dri-freeworld", "/usr/lib64"};
+    if (const char* custom = g_getenv("LIBVA_DRIVERS_PATH")) {
+        std::string_view paths{custom};
+        for (std::size_t at = 0; at <= paths.size();) {
+            const auto next = std::min(paths.find(':', at), paths.size());
+            if (next > at) driver_dirs.emplace_back(std::string{paths.substr(at, next - at)});
+            at = next + 1;
+        }
+    }
+    for (const auto& directory : driver_dirs) {
+        for (std::filesystem::directory_iterator it(directory, error), end; !error && it != end; it.increment(error)) {
+            const auto name = it->path().filename().string();
+            // VA drivers, and Mesa's versioned gallium library (its version is the file name)
+            if (!name.ends_with("_drv_video.so") && !name.starts_with("libgallium")) continue;
+            std::error_code stat_error;
+            const auto size = std::filesystem::file_size(it->path(), stat_error);
+            const auto written = std::filesystem::last_write_time(it->path(), stat_error);
+            if (stat_error) continue;
+            parts.push_back(std::format("{}:{}:{}", name, size, written.time_since_epoch().count()));
+        }
+        error.clear();
+    }
+    return sr::fedora::compose_probe_fingerprint(std::move(parts));
+}
+
+std::optional<sr::fedora::EncoderProbeResults> load_encoder_probe(const std::string& fingerprint) {
+    std::optional<sr::fedora::EncoderProbeResults> cached;
+    GKeyFile* key_file = g_key_file_new();
+    const auto path = encoder_probe_path().string();
+    if (g_key_file_load_from_file(key_file, path.c_str(), G_KEY_FILE_NONE, nullptr)) {
+        gchar* stored = g_key_file_get_string(key_file, "Probe", "fingerprint", nullptr);
+        if (stored && fingerprint == stored) {
+            cached.emplace();
+            cached->fingerprint = fingerprint;
+            for (std::size_t index = 0; index < sr::fedora::kEncoderKindCount; ++index) {
+                const auto kind = static_cast<sr::fedora::EncoderKind>(index);
+                const std::string key{sr::fedora::encoder_kind_key(kind)};
+                gchar* value = g_key_file_get_string(key_file, "Encoders", key.c_str(), nullptr);
+                cached->set(kind, sr::fedora::parse_probe_state(value ? value : ""));
+                g_free(value);
+            }
+        }
+        g_free(stored);
+    }
+    g_key_file_unref(key_file);
+    return cached;
+}
+
+void save_encoder_probe(const sr::fedora::EncoderProbeResults& results) {
+    std::error_code error;
+    std::filesystem::create_directories(encoder_probe_path().parent_path(), error);
+    if (error) return;
+    GKeyFile* key_file = g_key_file_new();
+    g_key_file_set_string(key_file, "Probe", "fingerprint", results.fingerprint.c_str());
+    for (std::size_t index = 0; index < sr::fedora::kEncoderKindCount; ++index) {
+        const auto kind = static_cast<sr::fedora::EncoderKind>(index);
+        const auto state = sr::fedora::probe_state_key(results[kind]);
+        if (state.empty()) continue;
+        const std::string key{sr::fedora::encoder_kind_key(kind)};
+        g_key_file_set_string(key_file, "Encoders", key.c_str(), std::string{state}.c_str());
+    }
+    gsize length = 0;
+    gchar* data = g_key_file_to_data(key_file, &length, nullptr);
+    const auto path = encoder_probe_path().string();
+    g_file_set_contents(path.c_str(), data, static_cast<gssize>(length), nullptr);
+    g_free(data);
+    g_key_file_unref(key_file);
+}
+
+// Ten 640x360 frames through the encoder's default settings. Passing means
+// the element opened its device and produced H.264 before EOS.
+bool test_encode(sr::fedora::EncoderKind kind) {
+    const auto description = std::format(
+        "videotestsrc num-buffers=10 ! video/x-raw,format=NV12,width=640,height=360,framerate=30/1 "
+        "! {} ! h264parse ! fakesink", sr::fedora::encoder_kind_factory(kind));
+    GError* error = nullptr;
+    GstElement* pipeline = gst_parse_launch(description.c_str(), &error);
+    g_clear_error(&error);
+    if (!pipeline) return false;
+    bool passed = false;
+    if (gst_element_set_state(pipeline, GST_STATE_PLAYING) != GST_STATE_CHANGE_FAILURE) {
+        GstBus* bus = gst_element_get_bus(pipeline);
+        GstMessage* message = gst_bus_timed_pop_filtered(
+            bus, 5 * GST_SECOND, static_cast<GstMessageType>(GST_MESSAGE_EOS | GST_MESSAGE_ERROR));
+        passed = message && GST_MESSAGE_TYPE(message) == GST_MESSAGE_EOS;
+        if (message) gst_message_unref(message);
+        gst_object_unref(bus);
+    }
+    gst_element_set_state(pipeline, GST_STATE_NULL);
+    gst_object_unref(pipeline);
+    return passed;
+}
+
 std::string named_encoder_element(const EncoderChoice& encoder) {
     const auto separator = encoder.element.find(' ');
     if (separator == std::string::npos) return encoder.element + " name=video_encoder";
@@ -221,6 +559,11 @@ public:
     }
 
     ~RecorderWindow() {
+        stop_orphan_scan();
+        if (encoder_probe_) g_cancellable_cancel(encoder_probe_);
+        g_clear_object(&encoder_probe_);
+        if (replay_save_) g_cancellable_cancel(replay_save_);
+        g_clear_object(&replay_save_);
         stop_camera_preview();
         cleanup_pipeline();
         if (session_) {
@@ -245,11 +588,21 @@ private:
     GstElement* pipeline_{};
     GstElement* camera_preview_pipeline_{};
     GtkWindow* camera_preview_window_{};
+    GtkWindow* screen_preview_window_{};
     guint bus_watch_{};
     guint camera_preview_bus_watch_{};
     guint timer_{};
     guint disk_check_{};
     guint power_check_{};
+    guint orphan_rescan_{};
+    GCancellable* orphan_scan_{};
+    GCancellable* encoder_probe_{};
+    std::optional<sr::fedora::EncoderProbeResults> encoder_probe_results_;
+    // Snapshot per recording: encoder retries index into the same list even
+    // if the probe completes in between
+    std::optional<sr::fedora::EncoderProbeResults> recording_probe_;
+    GFileMonitor* output_monitor_{};
+    std::string monitored_directory_;
     int remote_fd_{-1};
     std::string partial_path_;
     sr::fedora::RecordingClock recording_clock_;
@@ -265,16 +618,35 @@ private:
     std::size_t active_candidate_index_{};
     std::size_t active_candidate_count_{};
     bool active_audio_{};
+    sr::fedora::AudioBackend active_audio_backend_{sr::fedora::AudioBackend::Pulse};
     bool active_camera_{};
+    bool active_screen_preview_{};
+    sr::fedora::CameraCompositor active_compositor_{sr::fedora::CameraCompositor::Cpu};
+    bool gpu_compositor_rejected_{};
+    sr::fedora::OutputContainer active_container_{sr::fedora::OutputContainer::Mp4};
+    sr::fedora::SegmentLimits active_segments_{};
+    std::size_t segments_saved_{};
     std::atomic_uint64_t captured_frames_{};
     std::atomic_uint64_t encoded_frames_{};
     std::atomic_uint64_t audio_buffers_{};
     std::atomic_uint64_t qos_drops_{};
+    // Frame rate the pipeline caps were negotiated at; battery transitions
+    // drop below it in front of the encoder rather than renegotiating
+    int negotiated_fps_{};
+    sr::fedora::FrameRateLimiter frame_limiter_;
+    // Instant replay: the session's encoded buffers stay in replay_queue_
+    // (filled from the streaming threads) and reach disk only on a save
+    bool replay_active_{};
+    std::mutex replay_mutex_;
+    ReplayQueue replay_queue_;
+    GCancellable* replay_save_{};
+    std::string replay_save_path_;
 
     GtkButton* record_button_{};
     GtkButton* pause_button_{};
     GtkButton* stop_button_{};
     GtkButton* mute_button_{};
+    GtkButton* save_replay_button_{};
     GtkLabel* status_label_{};
     GtkLabel* time_label_{};
     GtkSwitch* audio_switch_{};
@@ -283,8 +655,13 @@ private:
     GtkSwitch* battery_saver_switch_{};
     GtkSwitch* camera_switch_{};
     GtkSwitch* camera_preview_switch_{};
+    GtkSwitch* screen_preview_switch_{};
     GtkDropDown* camera_device_dropdown_{};
     GtkDropDown* fps_dropdown_{};
+    GtkDropDown* audio_backend_dropdown_{};
+    GtkDropDown* container_dropdown_{};
+    GtkDropDown* segment_dropdown_{};
+    GtkDropDown* replay_dropdown_{};
     GtkLabel* profile_label_{};
     GtkLabel* output_label_{};
     GtkLabel* telemetry_label_{};
@@ -417,6 +794,10 @@ private:
         mute_button_ = GTK_BUTTON(gtk_button_new_with_label("Mute"));
         stop_button_ = GTK_BUTTON(gtk_button_new_with_label("Stop"));
         gtk_widget_add_css_class(GTK_WIDGET(stop_button_), "destructive-action");
+        save_replay_button_ = GTK_BUTTON(gtk_button_new_with_label("Save replay"));
+        gtk_widget_set_tooltip_text(GTK_WIDGET(save_replay_button_), "Write the instant replay buffer to an MP4 (Alt+F10)");
+        gtk_widget_set_sensitive(GTK_WIDGET(save_replay_button_), FALSE);
+        gtk_widget_set_visible(GTK_WIDGET(save_replay_button_), settings_.replay_seconds > 0);
         gtk_widget_set_sensitive(GTK_WIDGET(pause_button_), FALSE);
         gtk_widget_set_sensitive(GTK_WIDGET(mute_button_), FALSE);
         gtk_widget_set_sensitive(GTK_WIDGET(stop_button_), FALSE);
@@ -424,10 +805,12 @@ private:
         g_signal_connect(pause_button_, "clicked", G_CALLBACK(on_pause), this);
         g_signal_connect(mute_button_, "clicked", G_CALLBACK(on_mute), this);
         g_signal_connect(stop_button_, "clicked", G_CALLBACK(on_stop), this);
+        g_signal_connect(save_replay_button_, "clicked", G_CALLBACK(on_save_replay), this);
         append(GTK_BOX(controls), GTK_WIDGET(record_button_));
         append(GTK_BOX(controls), GTK_WIDGET(pause_button_));
         append(GTK_BOX(controls), GTK_WIDGET(mute_button_));
         append(GTK_BOX(controls), GTK_WIDGET(stop_button_));
+        append(GTK_BOX(controls), GTK_WIDGET(save_replay_button_));
         append(GTK_BOX(content), controls);
 
         preferences_button_ = GTK_BUTTON(gtk_button_new_with_label("Recording settings"));
@@ -436,9 +819,18 @@ private:
         append(GTK_BOX(content), GTK_WIDGET(preferences_button_));
         gtk_window_set_child(window_, content);
 
+        // Wayland has no global hotkeys for a plain app, so this works while
+        // the window is focused
+        auto* shortcuts = gtk_shortcut_controller_new();
+        gtk_shortcut_controller_set_scope(GTK_SHORTCUT_CONTROLLER(shortcuts), GTK_SHORTCUT_SCOPE_GLOBAL);
+        gtk_shortcut_controller_add_shortcut(GTK_SHORTCUT_CONTROLLER(shortcuts), gtk_shortcut_new(
+            gtk_shortcut_trigger_parse_string("<Alt>F10"), gtk_callback_action_new(on_save_replay_shortcut, this, nullptr)));
+        gtk_widget_add_controller(GTK_WIDGET(window_), shortcuts);
+
         build_preferences_dialog();
         refresh_profile_label();
         report_orphaned_recordings();
+        start_encoder_probe();
     }
 
     void build_preferences_dialog() {
@@ -454,6 +846,13 @@ private:
         auto* audio_group = make_preferences_group("Audio", "Choose which audio tracks are written to the MP4.");
         audio_switch_ = add_switch_row(audio_group, "System audio", "Include current desktop output.", settings_.system_audio);
         microphone_switch_ = add_switch_row(audio_group, "Microphone", "Optional voice track with a light noise gate.", settings_.microphone);
+        auto* backend_row = make_action_row("Capture", "Native PipeWire negotiates 48 kHz at the source with short buffers.");
+        const char* backend_options[] = {"PulseAudio compatibility", "Native PipeWire", nullptr};
+        audio_backend_dropdown_ = GTK_DROP_DOWN(gtk_drop_down_new_from_strings(backend_options));
+        gtk_drop_down_set_selected(audio_backend_dropdown_, audio_backend() == sr::fedora::AudioBackend::PipeWire ? 1 : 0);
+        adw_action_row_add_suffix(backend_row, GTK_WIDGET(audio_backend_dropdown_));
+        adw_action_row_set_activatable_widget(backend_row, GTK_WIDGET(audio_backend_dropdown_));
+        adw_preferences_group_add(audio_group, GTK_WIDGET(backend_row));
         adw_preferences_page_add(recording_page, audio_group);
         adw_preferences_dialog_add(settings_dialog_, recording_page);
 
@@ -471,6 +870,10 @@ private:
         adw_action_row_set_activatable_widget(fps_row, GTK_WIDGET(fps_dropdown_));
         adw_preferences_group_add(profile_group, GTK_WIDGET(fps_row));
         adw_preferences_page_add(video_page, profile_group);
+        auto* monitor_group = make_preferences_group("Monitoring", nullptr);
+        screen_preview_switch_ = add_switch_row(monitor_group, "Screen preview",
+            "A small live view while recording, teed from the recorded PipeWire stream on the GPU.", settings_.screen_preview);
+        adw_preferences_page_add(video_page, monitor_group);
         adw_preferences_dialog_add(settings_dialog_, video_page);
 
         auto* camera_page = ADW_PREFERENCES_PAGE(adw_preferences_page_new());
@@ -517,6 +920,39 @@ private:
         adw_action_row_set_activatable_widget(settings_output_row_, GTK_WIDGET(choose_folder_button_));
         adw_preferences_group_add(storage_group, GTK_WIDGET(settings_output_row_));
         adw_preferences_page_add(storage_page, storage_group);
+        auto* layout_group = make_preferences_group("File layout", "Fragmented and split recordings finish instantly and survive a crash.");
+        auto* container_row = make_action_row("Format", "Fragmented MP4 needs no rewrite at the end and stays playable if interrupted.");
+        const char* container_options[] = {"Standard MP4", "Fragmented MP4", nullptr};
+        container_dropdown_ = GTK_DROP_DOWN(gtk_drop_down_new_from_strings(container_options));
+        gtk_drop_down_set_selected(container_dropdown_, output_container() == sr::fedora::OutputContainer::FragmentedMp4 ? 1 : 0);
+        adw_action_row_add_suffix(container_row, GTK_WIDGET(container_dropdown_));
+        adw_action_row_set_activatable_widget(container_row, GTK_WIDGET(container_dropdown_));
+        adw_preferences_group_add(layout_group, GTK_WIDGET(container_row));
+        auto* segment_row = make_action_row("Split recording", "Start a new file on a keyframe after the chosen duration or size.");
+        auto* segment_model = gtk_string_list_new(nullptr);
+        for (const auto& preset : sr::fedora::kSegmentPresets) gtk_string_list_append(segment_model, preset.label);
+        const auto preset_index = sr::fedora::segment_preset_index(segment_limits());
+        if (preset_index == sr::fedora::kSegmentPresets.size()) gtk_string_list_append(segment_model, "Custom (settings.ini)");
+        segment_dropdown_ = GTK_DROP_DOWN(gtk_drop_down_new(G_LIST_MODEL(segment_model), nullptr));
+        g_object_unref(segment_model);
+        gtk_drop_down_set_selected(segment_dropdown_, static_cast<guint>(preset_index));
+        adw_action_row_add_suffix(segment_row, GTK_WIDGET(segment_dropdown_));
+        adw_action_row_set_activatable_widget(segment_row, GTK_WIDGET(segment_dropdown_));
+        adw_preferences_group_add(layout_group, GTK_WIDGET(segment_row));
+        adw_preferences_page_add(storage_page, layout_group);
+        auto* replay_group = make_preferences_group("Instant replay", "Keeps recent video in memory; nothing is written until you save.");
+        auto* replay_row = make_action_row("Replay buffer", "Record fills the buffer; Save replay or Alt+F10 writes it to an MP4.");
+        auto* replay_model = gtk_string_list_new(nullptr);
+        for (const auto& preset : sr::fedora::kReplayPresets) gtk_string_list_append(replay_model, preset.label);
+        const auto replay_index = sr::fedora::replay_preset_index(settings_.replay_seconds);
+        if (replay_index == sr::fedora::kReplayPresets.size()) gtk_string_list_append(replay_model, "Custom (settings.ini)");
+        replay_dropdown_ = GTK_DROP_DOWN(gtk_drop_down_new(G_LIST_MODEL(replay_model), nullptr));
+        g_object_unref(replay_model);
+        gtk_drop_down_set_selected(replay_dropdown_, static_cast<guint>(replay_index));
+        adw_action_row_add_suffix(replay_row, GTK_WIDGET(replay_dropdown_));
+        adw_action_row_set_activatable_widget(replay_row, GTK_WIDGET(replay_dropdown_));
+        adw_preferences_group_add(replay_group, GTK_WIDGET(replay_row));
+        adw_preferences_page_add(storage_page, replay_group);
         adw_preferences_dialog_add(settings_dialog_, storage_page);
 
         g_signal_connect(audio_switch_, "notify::active", G_CALLBACK(on_settings_changed), this);
@@ -524,27 +960,171 @@ private:
         g_signal_connect(high_quality_switch_, "notify::active", G_CALLBACK(on_settings_changed), this);
         g_signal_connect(battery_saver_switch_, "notify::active", G_CALLBACK(on_settings_changed), this);
         g_signal_connect(camera_switch_, "notify::active", G_CALLBACK(on_settings_changed), this);
+        g_signal_connect(screen_preview_switch_, "notify::active", G_CALLBACK(on_settings_changed), this);
         g_signal_connect(camera_preview_switch_, "notify::active", G_CALLBACK(on_camera_preview_changed), this);
         g_signal_connect(camera_device_dropdown_, "notify::selected", G_CALLBACK(on_camera_device_changed), this);
         g_signal_connect(fps_dropdown_, "notify::selected", G_CALLBACK(on_fps_changed), this);
+        g_signal_connect(container_dropdown_, "notify::selected", G_CALLBACK(on_storage_layout_changed), this);
+        g_signal_connect(audio_backend_dropdown_, "notify::selected", G_CALLBACK(on_audio_backend_changed), this);
+        g_signal_connect(segment_dropdown_, "notify::selected", G_CALLBACK(on_storage_layout_changed), this);
+        g_signal_connect(replay_dropdown_, "notify::selected", G_CALLBACK(on_replay_changed), this);
         g_signal_connect(preview_camera_button_, "clicked", G_CALLBACK(on_preview_camera), this);
         g_signal_connect(choose_folder_button_, "clicked", G_CALLBACK(on_choose_folder), this);
     }
 
     void set_status(const std::string& text) { gtk_label_set_text(status_label_, text.c_str()); }
 
+    using OrphanList = std::vector<std::filesystem::path>;
+
+    // The scan runs on a GTask worker so a slow network folder never holds
+    // up the window; a newer scan cancels the one still running. The result
+    // stays cached until the folder monitor sees a recording come or go.
     void report_orphaned_recordings() {
-        std::error_code error;
-        orphaned_recordings_.clear();
-        for (const auto& entry : std::filesystem::directory_iterator(output_directory(), error)) {
-            if (entry.is_regular_file() && entry.path().filename().string().ends_with(".partial.mp4")) {
-                orphaned_recordings_.push_back(entry.path());
+        if (orphan_scan_) g_cancellable_cancel(orphan_scan_);
+        g_clear_object(&orphan_scan_);
+        orphan_scan_ = g_cancellable_new();
+        watch_output_directory();
+        GTask* task = g_task_new(nullptr, orphan_scan_, on_orphan_scan_done, this);
+        g_task_set_task_data(task, new std::string(output_directory()),
+                             [](gpointer directory) { delete static_cast<std::string*>(directory); });
+        g_task_run_in_thread(task, scan_orphans_thread);
+        g_object_unref(task);
+    }
+
+    static void scan_orphans_thread(GTask* task, gpointer, gpointer task_data, GCancellable* cancellable) {
+        const auto& directory = *static_cast<const std::string*>(task_data);
+        auto* found = new OrphanList(sr::fedora::find_partial_recordings(directory, [cancellable] {
+            return g_cancellable_is_cancelled(cancellable) != FALSE;
+        }));
+        g_task_return_pointer(task, found, [](gpointer list) { delete static_cast<OrphanList*>(list); });
+    }
+
+    static void on_orphan_scan_done(GObject*, GAsyncResult* result, gpointer data) {
+        // Cancelled means superseded or the window is gone: `data` may be stale
+        if (g_cancellable_is_cancelled(g_task_get_cancellable(G_TASK(result)))) return;
+        auto* self = static_cast<RecorderWindow*>(data);
+        std::unique_ptr<OrphanList> found(static_cast<OrphanList*>(g_task_propagate_pointer(G_TASK(result), nullptr)));
+        self->orphaned_recordings_.clear();
+        if (found) {
+            for (auto& path : *found) {
+                // The recording in progress is not an orphan
+                if (self->recording_ && (path == self->partial_path_ ||
+                                         sr::fedora::is_segment_of(path.string(), self->partial_path_))) continue;
+                // Nor is a replay being written
+                if (!self->replay_save_path_.empty() && path == self->replay_save_path_) continue;
+                self->orphaned_recordings_.push_back(std::move(path));
             }
         }
-        gtk_widget_set_visible(GTK_WIDGET(recovery_button_), !orphaned_recordings_.empty());
-        if (!orphaned_recordings_.empty()) {
-            const auto count = orphaned_recordings_.size();
-            set_status(std::format("Found {} unfinished recording{}; choose Recover to rename safely.", count, count == 1 ? "" : "s"));
+        gtk_widget_set_visible(GTK_WIDGET(self->recovery_button_), !self->orphaned_recordings_.empty());
+        gtk_widget_set_sensitive(GTK_WIDGET(self->recovery_button_), !self->recording_ && !self->orphaned_recordings_.empty());
+        if (!self->orphaned_recordings_.empty()) {
+            const auto count = self->orphaned_recordings_.size();
+            self->set_status(std::format("Found {} unfinished recording{}; choose Recover to rename safely.", count, count == 1 ? "" : "s"));
+        }
+    }
+
+    // Each encoder is test-encoded once per driver fingerprint on a GTask
+    // worker; later launches read the cached verdicts. Until the probe
+    // finishes, recordings use the unfiltered candidate list.
+    void start_encoder_probe() {
+        encoder_probe_ = g_cancellable_new();
+        GTask* task = g_task_new(nullptr, encoder_probe_, on_encoder_probe_done, this);
+        g_task_run_in_thread(task, probe_encoders_thread);
+        g_object_unref(task);
+    }
+
+    static void probe_encoders_thread(GTask* task, gpointer, gpointer, GCancellable* cancellable) {
+        auto* results = new sr::fedora::EncoderProbeResults;
+        results->fingerprint = encoder_probe_fingerprint();
+        if (auto cached = load_encoder_probe(results->fingerprint)) {
+            *results = std::move(*cached);
+        } else {
+            bool complete = true;
+            for (const auto kind : sr::fedora::encoder_candidates(encoder_availability())) {
+                if (g_cancellable_is_cancelled(cancellable)) {
+                    complete = false;
+                    break;
+                }
+                results->set(kind, test_encode(kind) ? sr::fedora::ProbeState::Passed : sr::fedora::ProbeState::Failed);
+            }
+            if (complete) save_encoder_probe(*results);
+        }
+        g_task_return_pointer(task, results, [](gpointer value) {
+            delete static_cast<sr::fedora::EncoderProbeResults*>(value);
+        });
+    }
+
+    static void on_encoder_probe_done(GObject*, GAsyncResult* result, gpointer data) {
+        // Cancelled means the window is gone: `data` may be stale
+        if (g_cancellable_is_cancelled(g_task_get_cancellable(G_TASK(result)))) return;
+        auto* self = static_cast<RecorderWindow*>(data);
+        std::unique_ptr<sr::fedora::EncoderProbeResults> probed(
+            static_cast<sr::fedora::EncoderProbeResults*>(g_task_propagate_pointer(G_TASK(result), nullptr)));
+        if (probed) self->encoder_probe_results_ = std::move(*probed);
+        g_clear_object(&self->encoder_probe_);
+    }
+
+    const sr::fedora::EncoderProbeResults* encoder_probe() const {
+        return encoder_probe_results_ ? &*encoder_probe_results_ : nullptr;
+    }
+
+    void watch_output_directory() {
+        const auto directory = output_directory();
+        if (output_monitor_ && directory == monitored_directory_) return;
+        if (output_monitor_) {
+            g_signal_handlers_disconnect_by_data(output_monitor_, this);
+            g_file_monitor_cancel(output_monitor_);
+            g_clear_object(&output_monitor_);
+        }
+        monitored_directory_ = directory;
+        GFile* folder = g_file_new_for_path(directory.c_str());
+        output_monitor_ = g_file_monitor_directory(folder, G_FILE_MONITOR_WATCH_MOVES, nullptr, nullptr);
+        g_object_unref(folder);
+        if (output_monitor_) g_signal_connect(output_monitor_, "changed", G_CALLBACK(on_output_directory_changed), this);
+    }
+
+    // Only a .partial.mp4 appearing or disappearing invalidates the cache;
+    // writes to the recording in progress do not
+    static void on_output_directory_changed(GFileMonitor*, GFile* file, GFile* other, GFileMonitorEvent event, gpointer data) {
+        auto* self = static_cast<RecorderWindow*>(data);
+        switch (event) {
+        case G_FILE_MONITOR_EVENT_CREATED:
+        case G_FILE_MONITOR_EVENT_DELETED:
+        case G_FILE_MONITOR_EVENT_MOVED_IN:
+        case G_FILE_MONITOR_EVENT_MOVED_OUT:
+        case G_FILE_MONITOR_EVENT_RENAMED:
+            break;
+        default:
+            return;
+        }
+        auto names_partial = [](GFile* candidate) {
+            if (!candidate) return false;
+            gchar* name = g_file_get_basename(candidate);
+            const bool partial = name && sr::fedora::is_partial_recording_name(name);
+            g_free(name);
+            return partial;
+        };
+        if (!names_partial(file) && !names_partial(other)) return;
+        if (self->orphan_rescan_ == 0) {
+            // Coalesce bursts (a recovery renames files in quick succession)
+            self->orphan_rescan_ = g_timeout_add(500, [](gpointer window) -> gboolean {
+                auto* owner = static_cast<RecorderWindow*>(window);
+                owner->orphan_rescan_ = 0;
+                owner->report_orphaned_recordings();
+                return G_SOURCE_REMOVE;
+            }, self);
+        }
+    }
+
+    void stop_orphan_scan() {
+        if (orphan_rescan_) g_source_remove(orphan_rescan_);
+        orphan_rescan_ = 0;
+        if (orphan_scan_) g_cancellable_cancel(orphan_scan_);
+        g_clear_object(&orphan_scan_);
+        if (output_monitor_) {
+            g_signal_handlers_disconnect_by_data(output_monitor_, this);
+            g_file_monitor_cancel(output_monitor_);
+            g_clear_object(&output_monitor_);
         }
     }
 
@@ -570,15 +1150,19 @@ private:
             (gtk_switch_get_active(audio_switch_) || gtk_switch_get_active(microphone_switch_)));
         gtk_widget_set_sensitive(GTK_WIDGET(audio_switch_), !is_recording);
         gtk_widget_set_sensitive(GTK_WIDGET(microphone_switch_), !is_recording);
+        gtk_widget_set_sensitive(GTK_WIDGET(audio_backend_dropdown_), !is_recording);
         gtk_widget_set_sensitive(GTK_WIDGET(high_quality_switch_), !is_recording);
         gtk_widget_set_sensitive(GTK_WIDGET(battery_saver_switch_), !is_recording);
         gtk_widget_set_sensitive(GTK_WIDGET(camera_switch_), !is_recording);
+        gtk_widget_set_sensitive(GTK_WIDGET(screen_preview_switch_), !is_recording);
         gtk_widget_set_sensitive(GTK_WIDGET(camera_device_dropdown_), !is_recording && !camera_devices_.empty());
         gtk_widget_set_sensitive(GTK_WIDGET(camera_preview_switch_), !is_recording && !camera_devices_.empty());
         gtk_widget_set_sensitive(GTK_WIDGET(preview_camera_button_), !is_recording && !camera_devices_.empty());
         gtk_widget_set_sensitive(GTK_WIDGET(choose_folder_button_), !is_recording);
         gtk_widget_set_sensitive(GTK_WIDGET(recovery_button_), !is_recording && !orphaned_recordings_.empty());
         gtk_widget_set_sensitive(GTK_WIDGET(fps_dropdown_), !is_recording);
+        gtk_widget_set_sensitive(GTK_WIDGET(replay_dropdown_), !is_recording);
+        gtk_widget_set_sensitive(GTK_WIDGET(save_replay_button_), is_recording && settings_.replay_seconds > 0);
         if (!is_recording) open_configured_camera_preview();
     }
 
@@ -608,15 +1192,40 @@ private:
     void sync_settings() {
         settings_.system_audio = gtk_switch_get_active(audio_switch_);
         settings_.microphone = gtk_switch_get_active(microphone_switch_);
+        settings_.audio_backend = sr::fedora::audio_backend_key(gtk_drop_down_get_selected(audio_backend_dropdown_) == 1
+            ? sr::fedora::AudioBackend::PipeWire : sr::fedora::AudioBackend::Pulse);
         settings_.high_quality = gtk_switch_get_active(high_quality_switch_);
         settings_.battery_saver = gtk_switch_get_active(battery_saver_switch_);
         settings_.camera = gtk_switch_get_active(camera_switch_);
         settings_.camera_preview = gtk_switch_get_active(camera_preview_switch_);
+        settings_.screen_preview = gtk_switch_get_active(screen_preview_switch_);
         settings_.camera_device = selected_camera_device();
         settings_.fps = gtk_drop_down_get_selected(fps_dropdown_) == 1 ? 60 : 30;
+        settings_.container = sr::fedora::output_container_key(gtk_drop_down_get_selected(container_dropdown_) == 1
+            ? sr::fedora::OutputContainer::FragmentedMp4 : sr::fedora::OutputContainer::Mp4);
+        // The "Custom" entry leaves hand-edited limits alone
+        const auto preset = gtk_drop_down_get_selected(segment_dropdown_);
+        if (preset < sr::fedora::kSegmentPresets.size()) {
+            settings_.segment_minutes = sr::fedora::kSegmentPresets[preset].limits.max_minutes;
+            settings_.segment_mb = sr::fedora::kSegmentPresets[preset].limits.max_mb;
+        }
+        const auto replay = gtk_drop_down_get_selected(replay_dropdown_);
+        if (replay < sr::fedora::kReplayPresets.size()) settings_.replay_seconds = sr::fedora::kReplayPresets[replay].seconds;
         save_settings(settings_);
     }
 
+    sr::fedora::AudioBackend audio_backend() const {
+        return sr::fedora::parse_audio_backend(settings_.audio_backend);
+    }
+
+    sr::fedora::OutputContainer output_container() const {
+        return sr::fedora::parse_output_container(settings_.container);
+    }
+
+    sr::fedora::SegmentLimits segment_limits() const {
+        return {settings_.segment_minutes, settings_.segment_mb};
+    }
+
     static void on_settings_changed(GtkSwitch*, GParamSpec*, gpointer data) {
         auto* self = static_cast<RecorderWindow*>(data);
         self->sync_settings();
@@ -629,6 +1238,20 @@ private:
         self->refresh_profile_label();
     }
 
+    static void on_storage_layout_changed(GtkDropDown*, GParamSpec*, gpointer data) {
+        static_cast<RecorderWindow*>(data)->sync_settings();
+    }
+
+    static void on_audio_backend_changed(GtkDropDown*, GParamSpec*, gpointer data) {
+        static_cast<RecorderWindow*>(data)->sync_settings();
+    }
+
+    static void on_replay_changed(GtkDropDown*, GParamSpec*, gpointer data) {
+        auto* self = static_cast<RecorderWindow*>(data);
+        self->sync_settings();
+        gtk_widget_set_visible(GTK_WIDGET(self->save_replay_button_), self->settings_.replay_seconds > 0);
+    }
+
     static void on_camera_device_changed(GtkDropDown*, GParamSpec*, gpointer data) {
         auto* self = static_cast<RecorderWindow*>(data);
         self->sync_settings();
@@ -871,6 +1494,40 @@ private:
         }
     }
 
+    // Lives only as long as the recording pipeline that owns its paintable
+    void open_screen_preview_window(GstElement* sink) {
+        GdkPaintable* paintable = nullptr;
+        g_object_get(sink, "paintable", &paintable, nullptr);
+        if (!paintable) return;
+        GtkWidget* widget = gtk_picture_new_for_paintable(paintable);
+        g_object_unref(paintable);
+        gtk_picture_set_can_shrink(GTK_PICTURE(widget), TRUE);
+        gtk_picture_set_content_fit(GTK_PICTURE(widget), GTK_CONTENT_FIT_CONTAIN);
+        screen_preview_window_ = GTK_WINDOW(gtk_window_new());
+        gtk_window_set_title(screen_preview_window_, "Screen Preview");
+        gtk_window_set_default_size(screen_preview_window_, sr::fedora::kScreenPreviewDefaultWindowWidth,
+                                    sr::fedora::kScreenPreviewDefaultWindowHeight);
+        gtk_window_set_child(screen_preview_window_, widget);
+        g_signal_connect(screen_preview_window_, "close-request", G_CALLBACK(on_screen_preview_close), this);
+        gtk_window_present(screen_preview_window_);
+    }
+
+    static gboolean on_screen_preview_close(GtkWindow* preview_window, gpointer data) {
+        auto* self = static_cast<RecorderWindow*>(data);
+        if (self->screen_preview_window_ != preview_window) return FALSE;
+        // The leaky branch keeps running unseen; the recording is unaffected
+        self->screen_preview_window_ = nullptr;
+        self->set_status("Screen preview closed; recording continues.");
+        return FALSE;
+    }
+
+    void close_screen_preview() {
+        if (!screen_preview_window_) return;
+        auto* preview_window = screen_preview_window_;
+        screen_preview_window_ = nullptr;
+        gtk_window_destroy(preview_window);
+    }
+
     static void on_choose_folder(GtkButton*, gpointer data) {
         auto* self = static_cast<RecorderWindow*>(data);
         auto* dialog = gtk_file_dialog_new();
@@ -896,6 +1553,7 @@ private:
             gtk_label_set_text(self->output_label_, path);
             adw_action_row_set_subtitle(self->settings_output_row_, path);
             self->sync_settings();
+            self->report_orphaned_recordings();
         }
         g_free(path);
         g_object_unref(folder);
@@ -907,7 +1565,7 @@ private:
             self->set_status("The xdg-desktop-portal service is unavailable.");
             return;
         }
-        if (choose_encoders(self->profile()).empty()) {
+        if (choose_encoders(self->profile(), self->encoder_probe()).empty()) {
             self->set_status("No H.264 encoder found. Install gstreamer1-plugin-openh264.");
             return;
         }
@@ -970,13 +1628,17 @@ private:
             set_status("Could not open the portal's PipeWire connection.");
             return false;
         }
-        if (!reuse_output_path) partial_path_ = output_path(output_directory());
+        if (!reuse_output_path) {
+            partial_path_ = output_path(output_directory());
+            gpu_compositor_rejected_ = false;
+            recording_probe_ = encoder_probe_results_;
+        }
         if (partial_path_.empty()) {
             set_status("Could not create the Videos/Screen Recordings folder.");
             return false;
         }
         const auto active_profile = profile();
-        const auto candidates = choose_encoders(active_profile);
+        const auto candidates = choose_encoders(active_profile, recording_probe_ ? &*recording_probe_ : nullptr);
         if (candidate_index >= candidates.size()) {
             set_status("No supported H.264 encoder is available.");
             return false;
@@ -991,20 +1653,38 @@ private:
             set_status("Camera overlay is enabled but the selected V4L2 camera is unavailable.");
             return false;
         }
-        gchar* escaped_path = g_strescape(partial_path_.c_str(), nullptr);
+        // Instant replay replaces the muxer; segments apply to disk recordings only
+        const bool replay = settings_.replay_seconds > 0;
+        const auto segments = replay ? sr::fedora::SegmentLimits{} : segment_limits();
+        // Segments are written as "<name> part NNN.partial.mp4" and renamed as
+        // each one closes; partial_path_ stays the session's base name.
+        gchar* escaped_path = g_strescape(
+            (segments.enabled() ? sr::fedora::segment_location_pattern(partial_path_) : partial_path_).c_str(), nullptr);
+        // The screen preview tees the one PipeWire stream ahead of the
+        // recording's queue; without GL it is left out rather than forcing
+        // the recording into system memory.
+        const auto screen_preview = settings_.screen_preview && has_element("gtk4paintablesink")
+            ? sr::fedora::screen_preview_branch(sr::fedora::screen_preview_for(active_profile), "screen_tee",
+                                                has_element("glupload") && has_element("glcolorscale"))
+            : std::string{};
         const auto source = std::format(
-            "pipewiresrc fd={} path={} do-timestamp=true ! identity name=captured_counter signal-handoffs=true "
+            "pipewiresrc name=pipewiresrc_capture fd={} path={} do-timestamp=true {}"
             "! queue max-size-buffers=3 max-size-time=2000000000 leaky=downstream ",
-            remote_fd_, node_id);
+            remote_fd_, node_id, screen_preview.empty() ? "" : "! tee name=screen_tee screen_tee. ");
         const auto encoder_element = named_encoder_element(encoder);
+        const auto* video_pad = replay ? sr::fedora::replay_video_pad() : sr::fedora::video_mux_pad(segments);
+        const auto compositor = with_camera ? sr::fedora::camera_compositor_for(encoder.hardware, {
+            has_element("vacompositor"), has_element("glvideomixer"), has_element("vapostproc")},
+            gpu_compositor_rejected_) : sr::fedora::CameraCompositor::Cpu;
         std::string video;
         if (!with_camera && encoder.hardware) {
             // This is the normal laptop path: PipeWire negotiates DMA-BUF and
             // VA post-processing feeds Intel's low-power encoder on the GPU.
             video = std::format(
-                "{}! vapostproc ! video/x-raw(memory:VAMemory),format=NV12,width={},height={},framerate={}/1 "
-                "! {} ! identity name=encoded_counter signal-handoffs=true ! h264parse config-interval=-1 ! queue max-size-buffers=3 leaky=downstream ! mux. ",
-                source, active_profile.width, active_profile.height, active_profile.fps, encoder_element);
+                "{}! vapostproc ! capsfilter name=scale_caps "
+                "caps=\"video/x-raw(memory:VAMemory),format=NV12,width={},height={},framerate={}/1\" "
+                "! {} ! h264parse config-interval=-1 ! queue max-size-buffers=3 leaky=downstream ! {} ",
+                source, active_profile.width, active_profile.height, active_profile.fps, encoder_element, video_pad);
         } else if (with_camera) {
             const int camera_width = active_profile.high_quality ? 1280 : active_profile.battery_saver ? 160 : 320;
             const int camera_height = active_profile.high_quality ? 720 : active_profile.battery_saver ? 90 : 180;
@@ -1017,43 +1697,64 @@ private:
                 "! gtk4paintablesink name=recording_camera_preview_sink sync=false ",
                 sr::fedora::kCameraPreviewQueueBuffers,
                 live_preview.width, live_preview.height, live_preview.fps) : "";
-            video = std::format(
-                "{}! videoconvert ! videoscale ! videorate ! video/x-raw,format=I420,width={},height={},framerate={}/1 "
-                "! queue max-size-buffers=3 leaky=downstream ! compositor name=mix sink_1::xpos=24 sink_1::ypos=24 "
-                "! videoconvert ! {} ! identity name=encoded_counter signal-handoffs=true ! h264parse config-interval=-1 ! queue ! mux. "
-                "v4l2src device=\"{}\" do-timestamp=true ! queue max-size-buffers=1 max-size-bytes=0 max-size-time=0 leaky=downstream "
-                "! videoconvert ! tee name=camera_tee "
-                "camera_tee. ! queue max-size-buffers=1 max-size-bytes=0 max-size-time=0 leaky=downstream "
-                "! videoscale ! videorate ! video/x-raw,format=I420,width={},height={},framerate={}/1 "
-                "! mix. {}",
-                source, active_profile.width, active_profile.height, active_profile.fps, encoder_element,
-                camera_device, camera_width, camera_height, camera_fps, preview_branch);
+            // The GPU variants import the camera's DMA-BUFs; the tee sits ahead
+            // of any conversion so the preview branch converts only for itself.
+            if (compositor == sr::fedora::CameraCompositor::VaCompositor) {
+                video = std::format(
+                    "{}! vapostproc ! video/x-raw(memory:VAMemory),format=NV12,width={},height={},framerate={}/1 "
+                    "! queue max-size-buffers=3 leaky=downstream ! vacompositor name=mix sink_1::xpos=24 sink_1::ypos=24 "
+                    "! video/x-raw(memory:VAMemory),format=NV12,width={},height={} "
+                    "! {} ! h264parse config-interval=-1 ! queue ! {} "
+                    "v4l2src device=\"{}\" io-mode=dmabuf do-timestamp=true ! queue max-size-buffers=1 max-size-bytes=0 max-size-time=0 leaky=downstream "
+                    "! tee name=camera_tee "
+                    "camera_tee. ! queue max-size-buffers=1 max-size-bytes=0 max-size-time=0 leaky=downstream "
+                    "! videorate drop-only=true max-rate={} ! vapostproc "
+                    "! video/x-raw(memory:VAMemory),format=NV12,width={},height={} ! mix. {}",
+                    source, active_profile.width, active_profile.height, active_profile.fps,
+                    active_profile.width, active_profile.height, encoder_element, video_pad,
+                    camera_device, camera_fps, camera_width, camera_height, preview_branch);
+            } else if (compositor == sr::fedora::CameraCompositor::GlVideoMixer) {
+                video = std::format(
+                    "{}! glupload ! glcolorconvert ! queue max-size-buffers=3 leaky=downstream "
+                    "! glvideomixer name=mix sink_0::width={} sink_0::height={} "
+                    "sink_1::xpos=24 sink_1::ypos=24 sink_1::width={} sink_1::height={} "
+                    "! video/x-raw(memory:GLMemory),width={},height={},framerate={}/1 ! glcolorconvert ! gldownload "
+                    "! video/x-raw,format=NV12 ! vapostproc ! video/x-raw(memory:VAMemory),format=NV12 "
+                    "! {} ! h264parse config-interval=-1 ! queue ! {} "
+                    "v4l2src device=\"{}\" io-mode=dmabuf do-timestamp=true ! queue max-size-buffers=1 max-size-bytes=0 max-size-time=0 leaky=downstream "
+                    "! tee name=camera_tee "
+                    "camera_tee. ! queue max-size-buffers=1 max-size-bytes=0 max-size-time=0 leaky=downstream "
+                    "! videorate drop-only=true max-rate={} ! glupload ! glcolorconvert ! mix. {}",
+                    source, active_profile.width, active_profile.height, camera_width, camera_height,
+                    active_profile.width, active_profile.height, active_profile.fps, encoder_element, video_pad,
+                    camera_device, camera_fps, preview_branch);
+            } else {
+                video = std::format(
+                    "{}! videoconvert ! videoscale ! videorate ! capsfilter name=scale_caps "
+                    "caps=\"video/x-raw,format=I420,width={},height={},framerate={}/1\" "
+                    "! queue max-size-buffers=3 leaky=downstream ! compositor name=mix sink_1::xpos=24 sink_1::ypos=24 "
+                    "! videoconvert ! {} ! h264parse config-interval=-1 ! queue ! {} "
+                    "v4l2src device=\"{}\" do-timestamp=true ! queue max-size-buffers=1 max-size-bytes=0 max-size-time=0 leaky=downstream "
+                    "! videoconvert ! tee name=camera_tee "
+                    "camera_tee. ! queue max-size-buffers=1 max-size-bytes=0 max-size-time=0 leaky=downstream "
+                    "! videoscale ! videorate ! video/x-raw,format=I420,width={},height={},framerate={}/1 "
+                    "! mix. {}",
+                    source, active_profile.width, active_profile.height, active_profile.fps, encoder_element, video_pad,
+                    camera_device, camera_width, camera_height, camera_fps, preview_branch);
+            }
         } else {
             // Software fallback retains the same bounded, scaled pipeline.
             video = std::format(
-                "{}! videoconvert ! videoscale ! videorate ! video/x-raw,format=I420,width={},height={},framerate={}/1 "
-                "! {} ! identity name=encoded_counter signal-handoffs=true ! h264parse config-interval=-1 ! queue max-size-buffers=3 leaky=downstream ! mux. ",
-                source, active_profile.width, active_profile.height, active_profile.fps, encoder_element);
-        }
-        std::string audio;
-        if (with_system_audio || with_microphone) {
-            audio = "audiomixer name=audio_mix ! audioconvert ! audioresample ! "
-                    "audio/x-raw,format=F32LE,rate=48000,channels=2 ! volume name=audio_volume ! "
-                    "avenc_aac bitrate=128000 ! aacparse ! identity name=audio_counter signal-handoffs=true ! queue ! mux. ";
-            if (with_system_audio) {
-                // The Pulse compatibility monitor is the PipeWire desktop-output
-                // loopback; the ordinary default source would be the microphone.
-                audio += "pulsesrc device=@DEFAULT_MONITOR@ do-timestamp=true ! queue max-size-buffers=12 "
-                         "max-size-time=2000000000 leaky=downstream ! audioconvert ! audioresample ! audio_mix. ";
-            }
-            if (with_microphone) {
-                audio += "pulsesrc do-timestamp=true ! queue max-size-buffers=12 max-size-time=2000000000 leaky=downstream "
-                         "! audioconvert ! audioresample ! audiodynamic mode=expander threshold=0.02 ratio=4 "
-                         "characteristics=soft-knee ! audio_mix. ";
-            }
+                "{}! videoconvert ! videoscale ! videorate ! capsfilter name=scale_caps "
+                "caps=\"video/x-raw,format=I420,width={},height={},framerate={}/1\" "
+                "! {} ! h264parse config-interval=-1 ! queue max-size-buffers=3 leaky=downstream ! {} ",
+                source, active_profile.width, active_profile.height, active_profile.fps, encoder_element, video_pad);
         }
-        const std::string description = std::format(
-            "mp4mux name=mux faststart=true ! filesink location=\"{}\" {}{}", escaped_path, video, audio);
+        const auto audio = sr::fedora::audio_branch_description(
+            audio_backend(), settings_.audio_tuning, with_system_audio, with_microphone,
+            replay ? sr::fedora::replay_audio_pad() : sr::fedora::audio_mux_pad(segments));
+        const std::string description = (replay ? sr::fedora::replay_sinks(!audio.empty()) : sr::fedora::muxer_description(
+            output_container(), segments, escaped_path, has_element("isofmp4mux"))) + video + audio + screen_preview;
         g_free(escaped_path);
         GError* error = nullptr;
         pipeline_ = gst_parse_launch(description.c_str(), &error);
@@ -1062,6 +1763,12 @@ private:
             g_clear_error(&error);
             close(remote_fd_);
             remote_fd_ = -1;
+            if (compositor != sr::fedora::CameraCompositor::Cpu) {
+                gpu_compositor_rejected_ = true;
+                set_status(std::format("GPU camera compositing ({}) was unavailable; retrying on the CPU…",
+                                       sr::fedora::camera_compositor_name(compositor)));
+                return start_pipeline(candidate_index, true);
+            }
             if (candidate_index + 1 < candidates.size()) {
                 set_status(std::format("{} was unavailable; retrying {}…", encoder.name, candidates[candidate_index + 1].name));
                 return start_pipeline(candidate_index + 1, true);
@@ -1073,21 +1780,31 @@ private:
         encoded_frames_.store(0, std::memory_order_relaxed);
         audio_buffers_.store(0, std::memory_order_relaxed);
         qos_drops_.store(0, std::memory_order_relaxed);
-        if (GstElement* counter = gst_bin_get_by_name(GST_BIN(pipeline_), "captured_counter")) {
-            g_signal_connect(counter, "handoff", G_CALLBACK(on_captured_handoff), this);
-            gst_object_unref(counter);
-        }
-        if (GstElement* counter = gst_bin_get_by_name(GST_BIN(pipeline_), "encoded_counter")) {
-            g_signal_connect(counter, "handoff", G_CALLBACK(on_encoded_handoff), this);
-            gst_object_unref(counter);
-        }
-        if (GstElement* counter = gst_bin_get_by_name(GST_BIN(pipeline_), "audio_counter")) {
-            g_signal_connect(counter, "handoff", G_CALLBACK(on_audio_handoff), this);
-            gst_object_unref(counter);
+        count_buffers("pipewiresrc_capture", captured_frames_);
+        count_buffers("video_encoder", encoded_frames_);
+        count_buffers("audio_parse", audio_buffers_);
+        frame_limiter_.set_max_fps(0);
+        frame_limiter_.reset();
+        limit_frame_rate();
+        if (replay) {
+            {
+                std::lock_guard lock(replay_mutex_);
+                replay_queue_.reset(static_cast<std::int64_t>(settings_.replay_seconds) * 1'000'000'000LL,
+                                    sr::fedora::replay_byte_cap(settings_.replay_seconds, active_profile.bitrate_kbps,
+                                                                with_system_audio || with_microphone ? 128 : 0));
+            }
+            capture_replay("replay_video", on_replay_video);
+            capture_replay("replay_audio", on_replay_audio);
         }
+        if (!reuse_output_path) reset_latency_trace();
         GstBus* bus = gst_element_get_bus(pipeline_);
         bus_watch_ = gst_bus_add_watch(bus, on_bus_message, this);
         gst_object_unref(bus);
+        if (!screen_preview.empty()) {
+            GstElement* preview_sink = gst_bin_get_by_name(GST_BIN(pipeline_), "screen_preview_sink");
+            if (preview_sink) open_screen_preview_window(preview_sink);
+            if (preview_sink) gst_object_unref(preview_sink);
+        }
         if (with_live_camera_preview) {
             GstElement* preview_sink = gst_bin_get_by_name(
                 GST_BIN(pipeline_), "recording_camera_preview_sink");
@@ -1102,6 +1819,12 @@ private:
         if (gst_element_set_state(pipeline_, GST_STATE_PLAYING) == GST_STATE_CHANGE_FAILURE) {
             const auto failed_encoder = encoder.name;
             cleanup_pipeline();
+            if (compositor != sr::fedora::CameraCompositor::Cpu) {
+                gpu_compositor_rejected_ = true;
+                set_status(std::format("GPU camera compositing ({}) could not start; retrying on the CPU…",
+                                       sr::fedora::camera_compositor_name(compositor)));
+                return start_pipeline(candidate_index, true);
+            }
             if (candidate_index + 1 < candidates.size()) {
                 set_status(std::format("{} could not start; retrying {}…", failed_encoder, candidates[candidate_index + 1].name));
                 return start_pipeline(candidate_index + 1, true);
@@ -1113,13 +1836,26 @@ private:
         recording_ = true;
         muted_ = false;
         active_profile_ = active_profile;
+        negotiated_fps_ = active_profile.fps;
         active_encoder_ = encoder;
         active_candidate_index_ = candidate_index;
         active_candidate_count_ = candidates.size();
         active_audio_ = with_system_audio || with_microphone;
+        active_audio_backend_ = audio_backend();
         active_camera_ = with_camera;
+        active_screen_preview_ = !screen_preview.empty();
+        active_compositor_ = compositor;
+        active_container_ = output_container();
+        active_segments_ = segments;
+        segments_saved_ = 0;
+        replay_active_ = replay;
         write_diagnostics("START", active_profile, encoder, with_system_audio || with_microphone, with_camera);
-        set_status(std::format("Recording to {} ({})", std::filesystem::path(final_path_for(partial_path_)).filename().string(), encoder.name));
+        if (replay) {
+            set_status(std::format("Instant replay is keeping the last {} s in memory ({}); Save replay or Alt+F10 writes it.",
+                                   settings_.replay_seconds, encoder.name));
+        } else {
+            set_status(std::format("Recording to {} ({})", std::filesystem::path(final_path_for(partial_path_)).filename().string(), encoder.name));
+        }
         timer_ = g_timeout_add(250, update_timer, this);
         disk_check_ = g_timeout_add_seconds(10, check_disk_space, this);
         power_check_ = g_timeout_add_seconds(10, check_power_state, this);
@@ -1128,6 +1864,8 @@ private:
 
     void write_diagnostics(const char* phase, const RecordingProfile& active_profile,
                            const EncoderChoice& encoder, bool with_audio, bool with_camera) const {
+        // An instant replay session writes nothing to disk until a save
+        if (replay_active_) return;
         std::ofstream file(partial_path_ + ".diagnostics.txt", std::ios::app);
         if (!file) return;
         file << phase << '\n'
@@ -1138,10 +1876,38 @@ private:
              << "video=" << active_profile.width << 'x' << active_profile.height << '@' << active_profile.fps
              << " bitrate_kbps=" << active_profile.bitrate_kbps << '\n'
              << "system_audio=" << (with_audio ? "on" : "off") << " camera_overlay=" << (with_camera ? "on" : "off") << '\n';
-        if (with_camera) file << "camera_device=" << selected_camera_device() << '\n';
+        if (with_audio) {
+            file << "audio_backend=" << sr::fedora::audio_backend_key(active_audio_backend_);
+            if (active_audio_backend_ == sr::fedora::AudioBackend::PipeWire) {
+                file << " quantum=" << settings_.audio_tuning.quantum << " latency_ms=" << settings_.audio_tuning.latency_ms;
+            }
+            file << '\n';
+        }
+        file << "encoder_probe=";
+        if (const auto* probe = recording_probe_ ? &*recording_probe_ : nullptr) {
+            for (std::size_t index = 0; index < sr::fedora::kEncoderKindCount; ++index) {
+                const auto kind = static_cast<sr::fedora::EncoderKind>(index);
+                const auto state = sr::fedora::probe_state_key((*probe)[kind]);
+                if (!state.empty()) file << sr::fedora::encoder_kind_key(kind) << ':' << state << ' ';
+            }
+        } else {
+            file << "pending";
+        }
+        file << '\n';
+        if (with_camera) {
+            file << "camera_device=" << selected_camera_device() << '\n'
+                 << "camera_compositor=" << sr::fedora::camera_compositor_name(active_compositor_) << '\n';
+        }
+        file << "screen_preview=" << (active_screen_preview_ ? "gl" : "off") << '\n'
+             << "container=" << sr::fedora::output_container_key(active_container_);
+        if (active_segments_.enabled()) {
+            file << " segment_minutes=" << active_segments_.max_minutes << " segment_mb=" << active_segments_.max_mb;
+        }
+        file << '\n';
     }
 
     void write_stop_diagnostics(bool completed) const {
+        if (replay_active_) return;
         std::ofstream file(partial_path_ + ".diagnostics.txt", std::ios::app);
         if (!file) return;
         const auto snapshot = telemetry_snapshot();
@@ -1149,11 +1915,14 @@ private:
              << "captured_frames=" << snapshot.captured_frames << '\n'
              << "encoded_frames=" << snapshot.encoded_frames << '\n'
              << "audio_buffers=" << snapshot.audio_buffers << '\n'
-             << "qos_drops=" << snapshot.qos_drops << '\n';
+             << "qos_drops=" << snapshot.qos_drops << '\n'
+             << "power_dropped_frames=" << frame_limiter_.dropped() << '\n'
+             << sr::fedora::format_latency_report(snapshot.latency);
     }
 
     void write_fault_diagnostics(const sr::fedora::RecordingFault& fault, std::string_view source_name,
                                  std::string_view detail) const {
+        if (replay_active_) return;
         std::ofstream file(partial_path_ + ".diagnostics.txt", std::ios::app);
         if (!file) return;
         file << "FAULT\nkind=" << fault.diagnostic_name << '\n'
@@ -1179,22 +1948,34 @@ private:
         const auto updated = self->profile();
         if (updated.on_ac == self->active_profile_.on_ac) return G_SOURCE_CONTINUE;
 
-        // The active portal stream keeps its negotiated resolution/FPS to avoid
-        // an MP4 discontinuity. The encoder bitrate is mutable, so efficiency
-        // mode immediately applies the battery cap; the next session receives
-        // the full negotiated battery profile including 15 FPS.
-        if (!updated.high_quality && self->pipeline_ && self->active_encoder_) {
+        // Bitrate is a mutable encoder property and FPS is lowered by dropping
+        // frames ahead of the encoder, so neither changes the MP4 track. A new
+        // resolution renegotiates the scaler's caps, which only a segmented
+        // recording can take: splitmuxsink starts the next part at that size.
+        const auto plan = sr::fedora::plan_power_adaptation(self->active_profile_, updated,
+                                                            self->active_segments_.enabled());
+        auto applied = updated;
+        if (plan.bitrate && self->pipeline_ && self->active_encoder_) {
             if (GstElement* encoder = gst_bin_get_by_name(GST_BIN(self->pipeline_), "video_encoder")) {
                 const int bitrate = self->active_encoder_->hardware ? updated.bitrate_kbps : updated.bitrate_kbps * 1000;
                 g_object_set(encoder, "bitrate", bitrate, nullptr);
                 gst_object_unref(encoder);
             }
         }
-        self->active_profile_ = updated;
-        self->write_diagnostics("POWER_CHANGE", updated,
+        if (plan.fps) {
+            self->frame_limiter_.set_max_fps(updated.fps < self->negotiated_fps_ ? updated.fps : 0);
+            applied.fps = std::min(updated.fps, self->negotiated_fps_);
+        }
+        if (!plan.resolution || !self->rescale(updated.width, updated.height)) {
+            applied.width = self->active_profile_.width;
+            applied.height = self->active_profile_.height;
+        }
+        self->active_profile_ = applied;
+        self->write_diagnostics("POWER_CHANGE", applied,
                                 self->active_encoder_.value_or(EncoderChoice{}), self->active_audio_, self->active_camera_);
-        self->set_status(std::format("Power changed to {}; active encoder bitrate is now {} Mbps.",
-            updated.on_ac ? "AC" : "battery", updated.bitrate_kbps / 1000));
+        self->set_status(std::format("Power changed to {}; now {}×{} at {} FPS, {:.1f} Mbps.",
+            updated.on_ac ? "AC" : "battery", applied.width, applied.height, applied.fps,
+            applied.bitrate_kbps / 1000.0));
         return G_SOURCE_CONTINUE;
     }
 
@@ -1217,6 +1998,29 @@ private:
                     sr::fedora::should_retry_encoder_startup(
                         self->encoded_frames_.load(std::memory_order_relaxed),
                         self->active_candidate_index_, self->active_candidate_count_);
+                // A GPU compositor can negotiate and still fail on its first
+                // frame, e.g. a camera whose DMA-BUFs VA cannot import. Only
+                // GPU-path elements (unnamed va/gl elements, mix) and the
+                // camera qualify; encoder and output faults keep their handling.
+                const auto retry_compositor = !self->stopping_ &&
+                    self->active_compositor_ != sr::fedora::CameraCompositor::Cpu &&
+                    self->encoded_frames_.load(std::memory_order_relaxed) == 0 &&
+                    ((fault.kind == sr::fedora::RecordingFaultKind::Unknown && source_name != "mux") ||
+                     fault.kind == sr::fedora::RecordingFaultKind::Camera);
+                if (retry_compositor) {
+                    g_clear_error(&error);
+                    g_free(debug);
+                    self->bus_watch_ = 0;
+                    self->recording_ = false;
+                    self->gpu_compositor_rejected_ = true;
+                    self->cleanup_pipeline();
+                    self->set_status("GPU camera compositing failed before the first frame; retrying on the CPU…");
+                    if (!self->start_pipeline(self->active_candidate_index_, true)) {
+                        self->close_session();
+                        self->set_controls(false);
+                    }
+                    return G_SOURCE_REMOVE;
+                }
                 if (retry_encoder) {
                     const auto next_index = self->active_candidate_index_ + 1;
                     const auto failed_encoder = self->active_encoder_.value_or(EncoderChoice{}).name;
@@ -1239,6 +2043,16 @@ private:
                 self->finish_recording(false, fault.user_message);
                 return G_SOURCE_REMOVE;
             }
+            case GST_MESSAGE_ELEMENT: {
+                // splitmuxsink closed a segment: it is complete, so publish it now
+                const GstStructure* structure = gst_message_get_structure(message);
+                if (structure && gst_structure_has_name(structure, "splitmuxsink-fragment-closed")) {
+                    if (const gchar* location = gst_structure_get_string(structure, "location")) {
+                        self->publish_segment(location);
+                    }
+                }
+                return G_SOURCE_CONTINUE;
+            }
             case GST_MESSAGE_QOS: {
                 guint64 processed = 0;
                 guint64 dropped = 0;
@@ -1265,19 +2079,180 @@ private:
         return {captured_frames_.load(std::memory_order_relaxed),
                 encoded_frames_.load(std::memory_order_relaxed),
                 audio_buffers_.load(std::memory_order_relaxed),
-                qos_drops_.load(std::memory_order_relaxed)};
+                qos_drops_.load(std::memory_order_relaxed),
+                latency_trace_snapshot()};
+    }
+
+    // Drops frames on the encoder's sink pad down to frame_limiter_'s rate
+    void limit_frame_rate() {
+        GstElement* encoder = gst_bin_get_by_name(GST_BIN(pipeline_), "video_encoder");
+        if (!encoder) return;
+        if (GstPad* pad = gst_element_get_static_pad(encoder, "sink")) {
+            gst_pad_add_probe(pad, GST_PAD_PROBE_TYPE_BUFFER, on_limited_frame, &frame_limiter_, nullptr);
+            gst_object_unref(pad);
+        }
+        gst_object_unref(encoder);
+    }
+
+    static GstPadProbeReturn on_limited_frame(GstPad*, GstPadProbeInfo* info, gpointer data) {
+        const auto pts = GST_BUFFER_PTS(GST_PAD_PROBE_INFO_BUFFER(info));
+        if (!GST_CLOCK_TIME_IS_VALID(pts)) return GST_PAD_PROBE_OK;
+        return static_cast<sr::fedora::FrameRateLimiter*>(data)->admit(pts) ? GST_PAD_PROBE_OK : GST_PAD_PROBE_DROP;
+    }
+
+    // New caps on the scaler ahead of the encoder, starting a new segment.
+    // False on the GPU compositor paths, whose mixers fix their own size.
+    bool rescale(int width, int height) {
+        if (!pipeline_) return false;
+        GstElement* filter = gst_bin_get_by_name(GST_BIN(pipeline_), "scale_caps");
+        if (!filter) return false;
+        GstElement* mux = gst_bin_get_by_name(GST_BIN(pipeline_), "mux");
+        if (mux) {
+            // The encoder's first keyframe at the new size opens the next part
+            g_signal_emit_by_name(mux, "split-now");
+            gst_object_unref(mux);
+        }
+        GstCaps* current = nullptr;
+        g_object_get(filter, "caps", &current, nullptr);
+        GstCaps* caps = current ? gst_caps_make_writable(current) : gst_caps_new_empty_simple("video/x-raw");
+        gst_caps_set_simple(caps, "width", G_TYPE_INT, width, "height", G_TYPE_INT, height, nullptr);
+        g_object_set(filter, "caps", caps, nullptr);
+        gst_caps_unref(caps);
+        gst_object_unref(filter);
+        return true;
+    }
+
+    // Encoded buffers reaching the replay sinks go to replay_queue_
+    void capture_replay(const char* sink_name, GstPadProbeCallback callback) {
+        GstElement* sink = gst_bin_get_by_name(GST_BIN(pipeline_), sink_name);
+        if (!sink) return;
+        if (GstPad* pad = gst_element_get_static_pad(sink, "sink")) {
+            gst_pad_add_probe(pad, GST_PAD_PROBE_TYPE_BUFFER, callback, this, nullptr);
+            gst_object_unref(pad);
+        }
+        gst_object_unref(sink);
+    }
+
+    static GstPadProbeReturn on_replay_video(GstPad*, GstPadProbeInfo* info, gpointer data) {
+        auto* self = static_cast<RecorderWindow*>(data);
+        GstBuffer* buffer = GST_PAD_PROBE_INFO_BUFFER(info);
+        if (!GST_BUFFER_PTS_IS_VALID(buffer)) return GST_PAD_PROBE_OK;
+        const auto pts = static_cast<std::int64_t>(GST_BUFFER_PTS(buffer));
+        const auto dts = GST_BUFFER_DTS_IS_VALID(buffer) ? static_cast<std::int64_t>(GST_BUFFER_DTS(buffer)) : pts;
+        std::lock_guard lock(self->replay_mutex_);
+        self->replay_queue_.push_video(BufferRef(buffer), pts, dts, static_cast<std::uint32_t>(gst_buffer_get_size(buffer)),
+                                       !GST_BUFFER_FLAG_IS_SET(buffer, GST_BUFFER_FLAG_DELTA_UNIT));
+        return GST_PAD_PROBE_OK;
     }
 
-    static void on_captured_handoff(GstElement*, GstBuffer*, gpointer data) {
-        static_cast<RecorderWindow*>(data)->captured_frames_.fetch_add(1, std::memory_order_relaxed);
+    static GstPadProbeReturn on_replay_audio(GstPad*, GstPadProbeInfo* info, gpointer data) {
+        auto* self = static_cast<RecorderWindow*>(data);
+        GstBuffer* buffer = GST_PAD_PROBE_INFO_BUFFER(info);
+        if (!GST_BUFFER_PTS_IS_VALID(buffer)) return GST_PAD_PROBE_OK;
+        std::lock_guard lock(self->replay_mutex_);
+        self->replay_queue_.push_audio(BufferRef(buffer), static_cast<std::int64_t>(GST_BUFFER_PTS(buffer)),
+                                       static_cast<std::uint32_t>(gst_buffer_get_size(buffer)));
+        return GST_PAD_PROBE_OK;
     }
 
-    static void on_encoded_handoff(GstElement*, GstBuffer*, gpointer data) {
-        static_cast<RecorderWindow*>(data)->encoded_frames_.fetch_add(1, std::memory_order_relaxed);
+    GstCaps* replay_sink_caps(const char* sink_name) const {
+        GstElement* sink = gst_bin_get_by_name(GST_BIN(pipeline_), sink_name);
+        if (!sink) return nullptr;
+        GstPad* pad = gst_element_get_static_pad(sink, "sink");
+        GstCaps* caps = pad ? gst_pad_get_current_caps(pad) : nullptr;
+        if (pad) gst_object_unref(pad);
+        gst_object_unref(sink);
+        return caps;
     }
 
-    static void on_audio_handoff(GstElement*, GstBuffer*, gpointer data) {
-        static_cast<RecorderWindow*>(data)->audio_buffers_.fetch_add(1, std::memory_order_relaxed);
+    static void on_save_replay(GtkButton*, gpointer data) { static_cast<RecorderWindow*>(data)->save_replay(); }
+
+    static gboolean on_save_replay_shortcut(GtkWidget*, GVariant*, gpointer data) {
+        static_cast<RecorderWindow*>(data)->save_replay();
+        return TRUE;
+    }
+
+    // The queue is snapshotted here (buffer references only) and muxed on a
+    // GTask worker while the session keeps buffering.
+    void save_replay() {
+        if (!replay_active_ || !pipeline_ || stopping_) {
+            set_status("Instant replay is not running.");
+            return;
+        }
+        if (replay_save_) {
+            set_status("The previous replay is still being saved…");
+            return;
+        }
+        auto clip = std::make_unique<ReplayClip>();
+        std::int64_t duration = 0;
+        {
+            std::lock_guard lock(replay_mutex_);
+            clip->entries = replay_queue_.entries();
+            clip->offset = replay_queue_.time_offset();
+            duration = replay_queue_.duration();
+        }
+        clip->video_caps = replay_sink_caps("replay_video");
+        clip->audio_caps = active_audio_ ? replay_sink_caps("replay_audio") : nullptr;
+        if (clip->entries.empty() || !clip->video_caps) {
+            set_status("Nothing has been buffered yet.");
+            return;
+        }
+        clip->partial_path = output_path(output_directory(), "Replay");
+        if (clip->partial_path.empty()) {
+            set_status("Could not create the Videos/Screen Recordings folder.");
+            return;
+        }
+        replay_save_path_ = clip->partial_path;
+        replay_save_ = g_cancellable_new();
+        GTask* task = g_task_new(nullptr, replay_save_, on_replay_saved, this);
+        g_task_set_task_data(task, clip.release(), [](gpointer value) { delete static_cast<ReplayClip*>(value); });
+        g_task_run_in_thread(task, save_replay_thread);
+        g_object_unref(task);
+        set_status(std::format("Saving the last {} s…", duration / 1'000'000'000LL));
+    }
+
+    static void save_replay_thread(GTask* task, gpointer, gpointer task_data, GCancellable*) {
+        std::string failure;
+        if (write_replay_clip(*static_cast<const ReplayClip*>(task_data), failure)) {
+            g_task_return_boolean(task, TRUE);
+        } else {
+            g_task_return_new_error(task, G_IO_ERROR, G_IO_ERROR_FAILED, "%s", failure.c_str());
+        }
+    }
+
+    static void on_replay_saved(GObject*, GAsyncResult* result, gpointer data) {
+        // Cancelled means the window is gone: `data` may be stale
+        if (g_cancellable_is_cancelled(g_task_get_cancellable(G_TASK(result)))) return;
+        auto* self = static_cast<RecorderWindow*>(data);
+        GError* error = nullptr;
+        if (g_task_propagate_boolean(G_TASK(result), &error)) {
+            self->set_status(std::format("Saved replay {}", final_path_for(self->replay_save_path_)));
+        } else {
+            self->set_status(std::format("Could not save the replay: {}", error ? error->message : "unknown error"));
+            g_clear_error(&error);
+        }
+        g_clear_object(&self->replay_save_);
+        self->replay_save_path_.clear();
+    }
+
+    // Buffer probes on the elements' own src pads: a streaming-thread
+    // callback per buffer, with none of identity's signal emission
+    void count_buffers(const char* element_name, std::atomic_uint64_t& counter) {
+        GstElement* element = gst_bin_get_by_name(GST_BIN(pipeline_), element_name);
+        if (!element) return;
+        if (GstPad* pad = gst_element_get_static_pad(element, "src")) {
+            gst_pad_add_probe(pad, static_cast<GstPadProbeType>(GST_PAD_PROBE_TYPE_BUFFER | GST_PAD_PROBE_TYPE_BUFFER_LIST),
+                              on_counted_buffer, &counter, nullptr);
+            gst_object_unref(pad);
+        }
+        gst_object_unref(element);
+    }
+
+    static GstPadProbeReturn on_counted_buffer(GstPad*, GstPadProbeInfo* info, gpointer data) {
+        const auto count = (GST_PAD_PROBE_INFO_TYPE(info) & GST_PAD_PROBE_TYPE_BUFFER_LIST)
+            ? gst_buffer_list_length(GST_PAD_PROBE_INFO_BUFFER_LIST(info)) : 1U;
+        static_cast<std::atomic_uint64_t*>(data)->fetch_add(count, std::memory_order_relaxed);
+        return GST_PAD_PROBE_OK;
     }
 
     static void on_pause(GtkButton*, gpointer data) {
@@ -1315,10 +2290,30 @@ private:
         gtk_widget_set_sensitive(GTK_WIDGET(self->stop_button_), FALSE);
         gtk_widget_set_sensitive(GTK_WIDGET(self->pause_button_), FALSE);
         gtk_widget_set_sensitive(GTK_WIDGET(self->mute_button_), FALSE);
-        self->set_status("Finalizing MP4…");
+        self->set_status(self->replay_active_ ? "Stopping instant replay…" : "Finalizing MP4…");
         gst_element_send_event(self->pipeline_, gst_event_new_eos());
     }
 
+    // A closed segment is a complete MP4; only the one being written is .partial
+    bool publish_segment(const std::string& location) {
+        if (!sr::fedora::is_segment_of(location, partial_path_) || !std::filesystem::exists(location)) return false;
+        std::error_code error;
+        std::filesystem::rename(location, final_path_for(location), error);
+        if (error) return false;
+        ++segments_saved_;
+        return true;
+    }
+
+    // Segments whose close message was not seen (the last one, at EOS)
+    void publish_remaining_segments() {
+        std::error_code error;
+        const auto directory = std::filesystem::path(partial_path_).parent_path();
+        for (std::filesystem::directory_iterator it(directory, error), end; !error && it != end; it.increment(error)) {
+            const auto path = it->path().string();
+            if (sr::fedora::is_segment_of(path, partial_path_)) publish_segment(path);
+        }
+    }
+
     void finish_recording(bool completed, std::string_view failure_message = {}) {
         const auto partial = partial_path_;
         write_stop_diagnostics(completed);
@@ -1328,7 +2323,31 @@ private:
         stopping_ = false;
         set_controls(false);
         gtk_label_set_text(time_label_, "00:00:00");
-        if (completed && std::filesystem::exists(partial)) {
+        if (replay_active_) {
+            // A save in progress holds its own snapshot of the buffers
+            replay_active_ = false;
+            {
+                std::lock_guard lock(replay_mutex_);
+                replay_queue_.clear();
+            }
+            if (!replay_save_) {
+                set_status(failure_message.empty() ? std::string{"Instant replay stopped."} : std::string{failure_message});
+            }
+        } else if (active_segments_.enabled()) {
+            // An interrupted session keeps its open segment as .partial for
+            // orphan recovery; every closed one is already published.
+            if (completed) publish_remaining_segments();
+            const auto final = final_path_for(partial);
+            if (completed) {
+                std::error_code diagnostics_error;
+                std::filesystem::rename(partial + ".diagnostics.txt", final + ".diagnostics.txt", diagnostics_error);
+            }
+            const auto saved = std::format("{} segment{} in {}", segments_saved_, segments_saved_ == 1 ? "" : "s",
+                                           std::filesystem::path(partial).parent_path().string());
+            if (completed) set_status(std::format("Saved {}", saved));
+            else set_status(failure_message.empty() ? std::format("Recording interrupted; saved {}", saved)
+                                                    : std::format("{} Saved {}", failure_message, saved));
+        } else if (completed && std::filesystem::exists(partial)) {
             const auto final = final_path_for(partial);
             std::error_code error;
             std::filesystem::rename(partial, final, error);
@@ -1365,6 +2384,7 @@ private:
         // The GTK paintable is owned by a sink in pipeline_. Destroy its
         // window before releasing the pipeline at the end of a recording.
         close_recording_camera_preview();
+        close_screen_preview();
         if (pipeline_) {
             gst_element_set_state(pipeline_, GST_STATE_NULL);
             gst_object_unref(pipeline_);
@@ -1419,7 +2439,10 @@ int main(int argc, char** argv) {
             g_setenv("GST_REGISTRY", (registry_dir / "gstreamer-registry.bin").c_str(), FALSE);
         }
     }
+    const bool user_debug = g_getenv("GST_DEBUG") != nullptr;
+    if (g_strcmp0(g_getenv("SCREEN_RECORDER_LATENCY_TRACE"), "1") == 0) enable_latency_trace_environment();
     gst_init(&argc, &argv);
+    install_latency_trace_logger(user_debug);
     gst_update_registry();
     const auto application_flags = g_getenv("SCREEN_RECORDER_UI_SMOKE")
         ? G_APPLICATION_NON_UNIQUE
@@ -0,0 +1,127 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <format>
+#include <string>
+#include <string_view>
+
+namespace sr::fedora {
+
+// How the MP4 is laid out on disk.
+//   Mp4:           mp4mux faststart=true. The moov moves to the front at EOS,
+//                  a second pass over the whole file, and a crash leaves
+//                  nothing playable.
+//   FragmentedMp4: moof/mdat every kFragmentDurationMs. There is no EOS
+//                  rewrite, and a crash loses at most the last fragment.
+enum class OutputContainer { Mp4, FragmentedMp4 };
+
+constexpr int kFragmentDurationMs = 2000;
+
+constexpr std::string_view output_container_key(OutputContainer container) {
+    return container == OutputContainer::FragmentedMp4 ? "fragmented" : "mp4";
+}
+
+constexpr OutputContainer parse_output_container(std::string_view key) {
+    return key == "fragmented" ? OutputContainer::FragmentedMp4 : OutputContainer::Mp4;
+}
+
+// splitmuxsink rotation, mirroring the Windows app's segmented recording:
+// a new file every max_minutes or max_mb, whichever comes first, each
+// starting on a keyframe so it plays on its own.
+struct SegmentLimits {
+    int max_minutes{};   // 0 = no duration limit
+    int max_mb{};        // 0 = no size limit
+
+    constexpr bool enabled() const { return max_minutes > 0 || max_mb > 0; }
+    constexpr bool operator==(const SegmentLimits&) const = default;
+};
+
+struct SegmentPreset {
+    const char* label;
+    SegmentLimits limits;
+};
+
+inline constexpr std::array<SegmentPreset, 6> kSegmentPresets{{
+    {"Off", {}},
+    {"Every 15 minutes", {15, 0}},
+    {"Every 30 minutes", {30, 0}},
+    {"Every hour", {60, 0}},
+    {"Every 2 GB", {0, 2048}},
+    {"Every 4 GB", {0, 4096}},
+}};
+
+// kSegmentPresets.size() for limits set by hand in settings.ini
+constexpr std::size_t segment_preset_index(const SegmentLimits& limits) {
+    for (std::size_t index = 0; index < kSegmentPresets.size(); ++index) {
+        if (kSegmentPresets[index].limits == limits) return index;
+    }
+    return kSegmentPresets.size();
+}
+
+inline constexpr std::string_view kPartialSuffix = ".partial.mp4";
+inline constexpr std::string_view kSegmentInfix = " part ";
+
+// "X.partial.mp4" -> "X part %03d.partial.mp4" for splitmuxsink's location;
+// a literal '%' in the folder or file name is doubled.
+inline std::string segment_location_pattern(std::string_view partial_path) {
+    if (partial_path.ends_with(kPartialSuffix)) partial_path.remove_suffix(kPartialSuffix.size());
+    std::string pattern;
+    for (const char c : partial_path) {
+        pattern += c;
+        if (c == '%') pattern += '%';
+    }
+    return pattern + std::string{kSegmentInfix} + "%03d" + std::string{kPartialSuffix};
+}
+
+// Whether `path` is one of the segments splitmuxsink writes for `partial_path`
+inline bool is_segment_of(std::string_view path, std::string_view partial_path) {
+    if (!partial_path.ends_with(kPartialSuffix) || !path.ends_with(kPartialSuffix)) return false;
+    partial_path.remove_suffix(kPartialSuffix.size());
+    path.remove_suffix(kPartialSuffix.size());
+    if (!path.starts_with(partial_path)) return false;
+    path.remove_prefix(partial_path.size());
+    if (!path.starts_with(kSegmentInfix)) return false;
+    path.remove_prefix(kSegmentInfix.size());
+    if (path.size() < 3) return false;
+    for (const char c : path) {
+        if (c < '0' || c > '9') return false;
+    }
+    return true;
+}
+
+// Muxer and sink for the pipeline, named "mux". `location` is already
+// escaped for gst_parse_launch (the segment pattern when limits are set).
+inline std::string muxer_description(OutputContainer container, const SegmentLimits& limits,
+                                     std::string_view location, bool has_isofmp4mux) {
+    const bool fragmented = container == OutputContainer::FragmentedMp4;
+    if (limits.enabled()) {
+        std::string sink = std::format("splitmuxsink name=mux location=\"{}\" start-index=1 muxer-factory=mp4mux ", location);
+        if (limits.max_minutes > 0) {
+            // Ask the encoder for the IDR that opens the next segment
+            sink += std::format("max-size-time={} send-keyframe-requests=true ",
+                                static_cast<std::uint64_t>(limits.max_minutes) * 60ULL * 1'000'000'000ULL);
+        }
+        if (limits.max_mb > 0) {
+            sink += std::format("max-size-bytes={} ", static_cast<std::uint64_t>(limits.max_mb) * 1024ULL * 1024ULL);
+        }
+        if (fragmented) sink += std::format("muxer-properties=\"properties,fragment-duration={}\" ", kFragmentDurationMs);
+        return sink;
+    }
+    if (fragmented && has_isofmp4mux) {
+        return std::format("isofmp4mux name=mux fragment-duration={} ! filesink location=\"{}\" ",
+                           static_cast<std::uint64_t>(kFragmentDurationMs) * 1'000'000ULL, location);
+    }
+    if (fragmented) {
+        return std::format("mp4mux name=mux fragment-duration={} ! filesink location=\"{}\" ", kFragmentDurationMs, location);
+    }
+    return std::format("mp4mux name=mux faststart=true ! filesink location=\"{}\" ", location);
+}
+
+// splitmuxsink's pads take any caps, so branches must name theirs;
+// the muxers' caps-typed request pads link with a bare "mux."
+constexpr const char* video_mux_pad(const SegmentLimits& limits) { return limits.enabled() ? "mux.video" : "mux."; }
+constexpr const char* audio_mux_pad(const SegmentLimits& limits) { return limits.enabled() ? "mux.audio_0" : "mux."; }
+
+}  // namespace sr::fedora
@@ -0,0 +1,66 @@
+#pragma once
+
+#include "profile_policy.h"
+
+#include <atomic>
+#include <cstdint>
+
+namespace sr::fedora {
+
+// What a power transition may change in a running recording.
+struct PowerAdaptation {
+    bool bitrate{};
+    bool fps{};
+    // The encoder is renegotiated to the new size. Only done into a new
+    // splitmuxsink segment: one MP4 track cannot change resolution.
+    bool resolution{};
+};
+
+constexpr PowerAdaptation plan_power_adaptation(const RecordingProfile& active, const RecordingProfile& updated,
+                                                bool segmented) {
+    return {updated.bitrate_kbps != active.bitrate_kbps,
+            updated.fps != active.fps,
+            segmented && (updated.width != active.width || updated.height != active.height)};
+}
+
+// Drops frames in front of the encoder down to a mutable maximum rate.
+// videorate's max-rate would renegotiate the framerate in the caps, which
+// mp4mux refuses mid-stream; dropping leaves the caps alone and the MP4
+// timestamps carry the lower rate. admit() runs on the streaming thread,
+// set_max_fps() from any thread.
+class FrameRateLimiter {
+public:
+    void set_max_fps(int fps) {
+        interval_ns_.store(fps > 0 ? 1'000'000'000ULL / static_cast<std::uint64_t>(fps) : 0,
+                           std::memory_order_relaxed);
+    }
+
+    void reset() {
+        has_next_ = false;
+        dropped_.store(0, std::memory_order_relaxed);
+    }
+
+    bool admit(std::uint64_t pts_ns) {
+        const auto interval = interval_ns_.load(std::memory_order_relaxed);
+        if (interval == 0) return true;
+        // A quarter interval of slack absorbs capture jitter
+        if (has_next_ && pts_ns + interval / 4 < next_ns_) {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        // Stay on the cadence unless the source stalled for a whole interval
+        next_ns_ = has_next_ && pts_ns < next_ns_ + interval ? next_ns_ + interval : pts_ns + interval;
+        has_next_ = true;
+        return true;
+    }
+
+    std::uint64_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<std::uint64_t> interval_ns_{0};
+    std::atomic<std::uint64_t> dropped_{0};
+    std::uint64_t next_ns_{};
+    bool has_next_{};
+};
+
+}  // namespace sr::fedora
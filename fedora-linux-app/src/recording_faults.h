@@ -26,7 +26,7 @@ constexpr RecordingFault classify_recording_fault(std::string_view source_name)
     if (source_name.starts_with("v4l2src")) {
         return {RecordingFaultKind::Camera, "camera", "Camera became unavailable. Reconnect it, then select Record."};
     }
-    if (source_name.starts_with("pulsesrc")) {
+    if (source_name.starts_with("pulsesrc") || source_name.starts_with("audio_capture")) {
         return {RecordingFaultKind::Audio, "audio", "Audio device became unavailable. Check audio settings, then select Record."};
     }
     if (source_name == "video_encoder" || source_name.ends_with("enc")) {
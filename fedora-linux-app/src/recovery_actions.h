@@ -3,6 +3,7 @@
 #include <filesystem>
 #include <string>
 #include <string_view>
+#include <vector>
 
 namespace sr::fedora {
 
@@ -15,6 +16,27 @@ inline std::filesystem::path recovered_path_for(const std::filesystem::path& par
     return value.substr(0, value.size() - suffix.size()) + ".mp4";
 }
 
+inline bool is_partial_recording_name(std::string_view name) {
+    constexpr std::string_view suffix = ".partial.mp4";
+    return name.size() > suffix.size() && name.ends_with(suffix);
+}
+
+// Every unfinished recording directly in `directory`. `cancelled()` is
+// polled per entry so a scan of a slow network folder can be abandoned.
+template <typename Cancelled>
+std::vector<std::filesystem::path> find_partial_recordings(const std::filesystem::path& directory,
+                                                           Cancelled&& cancelled) {
+    std::vector<std::filesystem::path> found;
+    std::error_code error;
+    for (std::filesystem::directory_iterator it(directory, error), end; !error && it != end; it.increment(error)) {
+        if (cancelled()) break;
+        if (it->is_regular_file(error) && is_partial_recording_name(it->path().filename().string())) {
+            found.push_back(it->path());
+        }
+    }
+    return found;
+}
+
 inline RecoveryResult recover_partial_recording(const std::filesystem::path& partial) {
     if (!std::filesystem::exists(partial)) return RecoveryResult::Missing;
     const auto final = recovered_path_for(partial);
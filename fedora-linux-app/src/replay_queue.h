@@ -0,0 +1,159 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <format>
+#include <string>
+#include <string_view>
+#include <utility>
+
+namespace sr::fedora {
+
+// Instant replay, mirroring the Windows app's ReplayRing: the encoded H.264
+// and AAC buffers of the last N seconds are held in memory instead of being
+// muxed to disk, and only a save writes them through mp4mux.
+//
+// Eviction works in whole GOPs. The queue always starts on a video keyframe,
+// and the oldest GOP is dropped only once the next keyframe is itself at
+// least `window` old, so a saved replay covers at least the window (up to
+// one GOP more). A byte cap bounds memory if the bitrate spikes.
+//
+// Not thread-safe: the caller serialises the streaming threads and the save.
+template <typename Sample>
+class ReplayQueue {
+public:
+    struct Entry {
+        Sample sample;
+        std::int64_t pts{};   // ns
+        std::int64_t dts{};   // ns; pts when the buffer has none
+        std::uint32_t bytes{};
+        bool video{};
+        bool keyframe{};
+    };
+
+    void reset(std::int64_t window_ns, std::uint64_t max_bytes) {
+        window_ = window_ns;
+        max_bytes_ = max_bytes;
+        clear();
+    }
+
+    void clear() {
+        entries_.clear();
+        keyframes_.clear();
+        bytes_ = 0;
+        newest_ = 0;
+    }
+
+    void push_video(Sample sample, std::int64_t pts, std::int64_t dts, std::uint32_t bytes, bool keyframe) {
+        // Nothing is playable before the first keyframe
+        if (keyframes_.empty() && !keyframe) return;
+        if (keyframe) keyframes_.push_back(pts);
+        append(std::move(sample), pts, dts, bytes, true, keyframe);
+        if (pts > newest_) newest_ = pts;
+        evict();
+    }
+
+    void push_audio(Sample sample, std::int64_t pts, std::uint32_t bytes) {
+        if (keyframes_.empty()) return;
+        append(std::move(sample), pts, pts, bytes, false, false);
+    }
+
+    bool empty() const { return entries_.empty(); }
+    std::size_t size() const { return entries_.size(); }
+    std::uint64_t bytes() const { return bytes_; }
+    std::int64_t duration() const { return keyframes_.empty() ? 0 : newest_ - keyframes_.front(); }
+
+    // Subtracted from every timestamp on save so the clip starts at zero;
+    // the first keyframe's DTS precedes its PTS when the encoder reorders
+    std::int64_t time_offset() const {
+        if (entries_.empty()) return 0;
+        const auto& first = entries_.front();
+        return first.dts < first.pts ? first.dts : first.pts;
+    }
+
+    const std::deque<Entry>& entries() const { return entries_; }
+
+private:
+    void append(Sample&& sample, std::int64_t pts, std::int64_t dts, std::uint32_t bytes, bool video, bool keyframe) {
+        entries_.push_back({std::move(sample), pts, dts, bytes, video, keyframe});
+        bytes_ += bytes;
+    }
+
+    // Drop the oldest GOP while the one after it still covers the window,
+    // or while over the byte cap (always keeping the newest GOP).
+    void evict() {
+        while (keyframes_.size() >= 2) {
+            const bool covered = newest_ - keyframes_[1] >= window_;
+            const bool over_cap = max_bytes_ > 0 && bytes_ > max_bytes_;
+            if (!covered && !over_cap) break;
+            keyframes_.pop_front();
+            do {
+                bytes_ -= entries_.front().bytes;
+                entries_.pop_front();
+            } while (!entries_.empty() && !(entries_.front().video && entries_.front().keyframe));
+        }
+    }
+
+    std::deque<Entry> entries_;              // arrival order, video and audio interleaved
+    std::deque<std::int64_t> keyframes_;     // PTS of every keyframe in entries_
+    std::int64_t window_{};
+    std::uint64_t max_bytes_{};
+    std::uint64_t bytes_{};
+    std::int64_t newest_{};
+};
+
+constexpr int kReplayMaxSeconds = 600;
+
+struct ReplayPreset {
+    const char* label;
+    int seconds;
+};
+
+inline constexpr std::array<ReplayPreset, 6> kReplayPresets{{
+    {"Off", 0},
+    {"Last 15 seconds", 15},
+    {"Last 30 seconds", 30},
+    {"Last minute", 60},
+    {"Last 2 minutes", 120},
+    {"Last 5 minutes", 300},
+}};
+
+// kReplayPresets.size() for a window set by hand in settings.ini
+constexpr std::size_t replay_preset_index(int seconds) {
+    for (std::size_t index = 0; index < kReplayPresets.size(); ++index) {
+        if (kReplayPresets[index].seconds == seconds) return index;
+    }
+    return kReplayPresets.size();
+}
+
+// Twice the nominal video and audio rate over the window, so a GOP of
+// slack and bitrate overshoot still fit; the floor covers a static screen.
+constexpr std::uint64_t replay_byte_cap(int seconds, int video_kbps, int audio_kbps) {
+    const auto bytes_per_second = (static_cast<std::uint64_t>(video_kbps) + static_cast<std::uint64_t>(audio_kbps)) * 1000ULL / 8ULL;
+    return 2ULL * bytes_per_second * static_cast<std::uint64_t>(seconds) + 8ULL * 1024ULL * 1024ULL;
+}
+
+// In a replay session the encoded branches end in these sinks instead of
+// "mux". An unlinked sink would never see EOS, so audio's is optional.
+inline std::string replay_sinks(bool with_audio) {
+    std::string sinks = "fakesink name=replay_video sync=false async=false ";
+    if (with_audio) sinks += "fakesink name=replay_audio sync=false async=false ";
+    return sinks;
+}
+constexpr const char* replay_video_pad() { return "replay_video."; }
+constexpr const char* replay_audio_pad() { return "replay_audio."; }
+
+// The save pipeline: the queued buffers are pushed into the appsrcs, parsed
+// back into MP4's stream format and muxed once. `location` is escaped for
+// gst_parse_launch.
+inline std::string replay_save_description(std::string_view location, bool with_audio) {
+    auto description = std::format(
+        "appsrc name=replay_video_src format=time ! h264parse ! queue ! mp4mux name=mux faststart=true "
+        "! filesink location=\"{}\" ", location);
+    if (with_audio) description += "appsrc name=replay_audio_src format=time ! aacparse ! queue ! mux. ";
+    return description;
+}
+
+}  // namespace sr::fedora
@@ -0,0 +1,43 @@
+#pragma once
+
+#include "profile_policy.h"
+
+#include <format>
+#include <string>
+
+namespace sr::fedora {
+
+// The screen preview is a branch of the recording's own pipewiresrc, teed
+// ahead of the encoder path, so no second portal session or PipeWire stream
+// (and its compositor copy) is needed. It is only a monitor: a one-buffer
+// leaky queue, a low rate and a small size keep it from ever holding back
+// the recording.
+struct ScreenPreviewProfile {
+    int width;
+    int fps;
+};
+
+constexpr int kScreenPreviewDefaultWindowWidth = 480;
+constexpr int kScreenPreviewDefaultWindowHeight = 300;
+
+constexpr ScreenPreviewProfile screen_preview_for(const RecordingProfile& recording) {
+    if (recording.battery_saver || !recording.on_ac) return {480, 5};
+    return {640, 10};
+}
+
+// The preview branch from `tee` to gtk4paintablesink. The frames stay on
+// the GPU: glupload imports PipeWire's DMA-BUFs and the sink draws the GL
+// texture. A system-memory converter here would make the tee negotiate
+// system memory for the recording as well, so without GL there is no
+// branch (empty string). The height follows the screen's aspect ratio.
+inline std::string screen_preview_branch(const ScreenPreviewProfile& preview, const char* tee, bool has_gl) {
+    if (!has_gl) return {};
+    return std::format(
+        "{}. ! queue max-size-buffers=1 max-size-bytes=0 max-size-time=0 leaky=downstream "
+        "! videorate drop-only=true max-rate={} ! glupload ! glcolorconvert ! glcolorscale "
+        "! video/x-raw(memory:GLMemory),format=RGBA,width={} "
+        "! gtk4paintablesink name=screen_preview_sink sync=false ",
+        tee, preview.fps, preview.width);
+}
+
+}  // namespace sr::fedora
@@ -1,16 +1,35 @@
 #pragma once
 
+#include <algorithm>
+#include <charconv>
+#include <cstddef>
 #include <cstdint>
 #include <format>
+#include <optional>
 #include <string>
+#include <string_view>
+#include <vector>
 
 namespace sr::fedora {
 
+// Mean/max time spent between two points of the pipeline, as reported by
+// GStreamer's latency (per element) or interlatency (source to pad) tracers.
+struct ElementLatency {
+    std::string label;
+    std::uint64_t samples{};
+    std::uint64_t total_ns{};
+    std::uint64_t max_ns{};
+
+    std::uint64_t mean_ns() const { return samples ? total_ns / samples : 0; }
+};
+
 struct TelemetrySnapshot {
     std::uint64_t captured_frames{};
     std::uint64_t encoded_frames{};
     std::uint64_t audio_buffers{};
     std::uint64_t qos_drops{};
+    // Empty unless the latency tracer mode is on; slowest first
+    std::vector<ElementLatency> latency{};
 };
 
 inline std::string format_telemetry(const TelemetrySnapshot& snapshot) {
@@ -19,4 +38,121 @@ inline std::string format_telemetry(const TelemetrySnapshot& snapshot) {
                        snapshot.audio_buffers, snapshot.qos_drops);
 }
 
+// One diagnostics line per entry: "latency <label> mean_us=.. max_us=.. samples=.."
+inline std::string format_latency_report(const std::vector<ElementLatency>& latency) {
+    std::string report;
+    for (const auto& entry : latency) {
+        report += std::format("latency {} mean_us={} max_us={} samples={}\n", entry.label,
+                              entry.mean_ns() / 1000, entry.max_ns / 1000, entry.samples);
+    }
+    return report;
+}
+
+struct TracerSample {
+    std::string label;
+    std::uint64_t ns{};
+};
+
+namespace detail {
+
+// Value of `field=(type)value` in a serialized GstStructure, quotes removed
+inline std::optional<std::string_view> tracer_field(std::string_view record, std::string_view field) {
+    for (std::size_t at = record.find(field); at != std::string_view::npos; at = record.find(field, at + 1)) {
+        const bool starts_field = at > 0 && (record[at - 1] == ' ' || record[at - 1] == ',');
+        const auto after = at + field.size();
+        if (!starts_field || after >= record.size() || record[after] != '=') continue;
+        auto value = record.substr(after + 1);
+        if (value.starts_with('(')) {
+            const auto close = value.find(')');
+            if (close == std::string_view::npos) return std::nullopt;
+            value = value.substr(close + 1);
+        }
+        if (value.starts_with('"')) {
+            const auto end = value.find('"', 1);
+            return end == std::string_view::npos ? std::nullopt : std::optional{value.substr(1, end - 1)};
+        }
+        return value.substr(0, std::min(value.find_first_of(",;"), value.size()));
+    }
+    return std::nullopt;
+}
+
+inline std::optional<std::uint64_t> parse_u64(std::string_view text) {
+    std::uint64_t value = 0;
+    const auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), value);
+    if (error != std::errc{} || end != text.data() + text.size()) return std::nullopt;
+    return value;
+}
+
+// Plain nanoseconds or GST_TIME_FORMAT ("0:00:00.012345678")
+inline std::optional<std::uint64_t> parse_tracer_time(std::string_view text) {
+    if (text.find(':') == std::string_view::npos) return parse_u64(text);
+    const auto first = text.find(':');
+    const auto second = text.find(':', first + 1);
+    const auto dot = text.find('.', second + 1);
+    if (second == std::string_view::npos || dot == std::string_view::npos) return std::nullopt;
+    const auto hours = parse_u64(text.substr(0, first));
+    const auto minutes = parse_u64(text.substr(first + 1, second - first - 1));
+    const auto seconds = parse_u64(text.substr(second + 1, dot - second - 1));
+    const auto fraction = text.substr(dot + 1);
+    if (!hours || !minutes || !seconds || fraction.empty() || fraction.size() > 9) return std::nullopt;
+    auto nanos = parse_u64(fraction);
+    if (!nanos) return std::nullopt;
+    for (auto digits = fraction.size(); digits < 9; ++digits) *nanos *= 10;
+    return ((*hours * 60 + *minutes) * 60 + *seconds) * 1'000'000'000ULL + *nanos;
+}
+
+}  // namespace detail
+
+// A GST_TRACER log record from the latency tracer (flags=element or
+// pipeline) or the interlatency tracer; nullopt for anything else.
+inline std::optional<TracerSample> parse_tracer_record(std::string_view record) {
+    std::optional<std::string_view> from, to;
+    if (record.starts_with("element-latency,")) {
+        from = detail::tracer_field(record, "element");
+    } else if (record.starts_with("latency,")) {
+        from = detail::tracer_field(record, "src-element");
+        to = detail::tracer_field(record, "sink-element");
+    } else if (record.starts_with("interlatency,")) {
+        from = detail::tracer_field(record, "from_pad");
+        to = detail::tracer_field(record, "to_pad");
+    } else {
+        return std::nullopt;
+    }
+    const auto time = detail::tracer_field(record, "time");
+    if (!from || !time) return std::nullopt;
+    const auto ns = detail::parse_tracer_time(*time);
+    if (!ns) return std::nullopt;
+    return TracerSample{to ? std::format("{}->{}", *from, *to) : std::string{*from}, *ns};
+}
+
+class LatencyTable {
+public:
+    void record(const TracerSample& sample) {
+        auto it = std::find_if(entries_.begin(), entries_.end(),
+                               [&](const ElementLatency& entry) { return entry.label == sample.label; });
+        if (it == entries_.end()) {
+            entries_.push_back({sample.label});
+            it = entries_.end() - 1;
+        }
+        ++it->samples;
+        it->total_ns += sample.ns;
+        it->max_ns = std::max(it->max_ns, sample.ns);
+    }
+
+    void clear() { entries_.clear(); }
+
+    // Slowest `limit` entries by mean
+    std::vector<ElementLatency> slowest(std::size_t limit) const {
+        auto sorted = entries_;
+        std::sort(sorted.begin(), sorted.end(), [](const ElementLatency& a, const ElementLatency& b) {
+            return a.mean_ns() > b.mean_ns();
+        });
+        if (sorted.size() > limit) sorted.resize(limit);
+        return sorted;
+    }
+
+private:
+    std::vector<ElementLatency> entries_;
+};
+
 }  // namespace sr::fedora
@@ -0,0 +1,54 @@
+#include "audio_capture_policy.h"
+
+#include <gtest/gtest.h>
+
+namespace {
+
+std::size_t count(const std::string& text, std::string_view needle) {
+    std::size_t found = 0;
+    for (auto at = text.find(needle); at != std::string::npos; at = text.find(needle, at + needle.size())) ++found;
+    return found;
+}
+
+}  // namespace
+
+TEST(AudioCapturePolicy, BackendKeysRoundTrip) {
+    using sr::fedora::AudioBackend;
+    EXPECT_EQ(sr::fedora::parse_audio_backend(sr::fedora::audio_backend_key(AudioBackend::PipeWire)), AudioBackend::PipeWire);
+    EXPECT_EQ(sr::fedora::parse_audio_backend(sr::fedora::audio_backend_key(AudioBackend::Pulse)), AudioBackend::Pulse);
+    EXPECT_EQ(sr::fedora::parse_audio_backend("alsa"), AudioBackend::Pulse);
+}
+
+TEST(AudioCapturePolicy, NoTracksNoBranch) {
+    EXPECT_TRUE(sr::fedora::audio_branch_description(sr::fedora::AudioBackend::PipeWire, {}, false, false, "mux.").empty());
+    EXPECT_TRUE(sr::fedora::audio_branch_description(sr::fedora::AudioBackend::Pulse, {}, false, false, "mux.").empty());
+}
+
+TEST(AudioCapturePolicy, PulseKeepsTheCompatibilityChain) {
+    const auto pulse = sr::fedora::audio_branch_description(sr::fedora::AudioBackend::Pulse, {}, true, true, "mux.");
+    EXPECT_EQ(count(pulse, "pulsesrc"), 2U);
+    EXPECT_NE(pulse.find("device=@DEFAULT_MONITOR@"), std::string::npos);
+    EXPECT_EQ(count(pulse, "audioresample"), 3U);
+    EXPECT_EQ(count(pulse, "max-size-time=2000000000"), 2U);
+}
+
+TEST(AudioCapturePolicy, PipeWireNegotiatesAtTheSourceAndConvertsOnce) {
+    const auto native = sr::fedora::audio_branch_description(sr::fedora::AudioBackend::PipeWire, {256, 40}, true, true,
+                                                             "mux.audio_0");
+    EXPECT_EQ(count(native, "pipewiresrc"), 2U);
+    EXPECT_EQ(count(native, "audioconvert"), 1U);
+    EXPECT_EQ(native.find("audioresample"), std::string::npos);
+    EXPECT_EQ(native.find("pulsesrc"), std::string::npos);
+    EXPECT_EQ(count(native, "node.latency=256/48000"), 2U);
+    EXPECT_EQ(count(native, "max-size-time=40000000 "), 2U);
+    EXPECT_EQ(count(native, "stream.capture.sink=true"), 1U);
+    EXPECT_NE(native.find("name=audio_capture_microphone"), std::string::npos);
+    EXPECT_NE(native.find("! queue ! mux.audio_0 "), std::string::npos);
+    EXPECT_NE(native.find("audiodynamic mode=expander"), std::string::npos);
+}
+
+TEST(AudioCapturePolicy, TuningIsClamped) {
+    const auto tuning = sr::fedora::clamp_audio_tuning({1, 99999});
+    EXPECT_EQ(tuning.quantum, 64);
+    EXPECT_EQ(tuning.latency_ms, 2000);
+}
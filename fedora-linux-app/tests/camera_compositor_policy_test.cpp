@@ -0,0 +1,22 @@
+#include "camera_compositor_policy.h"
+
+#include <gtest/gtest.h>
+
+using sr::fedora::CameraCompositor;
+
+TEST(CameraCompositorPolicy, PrefersVaCompositorForHardwareEncoders) {
+    EXPECT_EQ(sr::fedora::camera_compositor_for(true, {true, true, true}, false), CameraCompositor::VaCompositor);
+    EXPECT_EQ(sr::fedora::camera_compositor_for(true, {false, true, true}, false), CameraCompositor::GlVideoMixer);
+    EXPECT_EQ(sr::fedora::camera_compositor_for(true, {false, false, true}, false), CameraCompositor::Cpu);
+}
+
+TEST(CameraCompositorPolicy, SoftwareEncodersAndMissingPostProcessingStayOnTheCpu) {
+    EXPECT_EQ(sr::fedora::camera_compositor_for(false, {true, true, true}, false), CameraCompositor::Cpu);
+    EXPECT_EQ(sr::fedora::camera_compositor_for(true, {true, true, false}, false), CameraCompositor::Cpu);
+}
+
+TEST(CameraCompositorPolicy, FallsBackToTheCpuAfterAGpuVariantFailed) {
+    EXPECT_EQ(sr::fedora::camera_compositor_for(true, {true, true, true}, true), CameraCompositor::Cpu);
+    EXPECT_STREQ(sr::fedora::camera_compositor_name(CameraCompositor::VaCompositor), "vacompositor");
+    EXPECT_STREQ(sr::fedora::camera_compositor_name(CameraCompositor::Cpu), "compositor");
+}
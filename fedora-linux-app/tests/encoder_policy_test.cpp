@@ -22,3 +22,36 @@ TEST(EncoderPolicy, RetriesOnlyBeforeTheFirstEncodedFrame) {
     EXPECT_FALSE(sr::fedora::should_retry_encoder_startup(1, 0, 2));
     EXPECT_FALSE(sr::fedora::should_retry_encoder_startup(0, 1, 2));
 }
+
+TEST(EncoderPolicy, SkipsEncodersThatFailedTheStartupProbe) {
+    const auto available = sr::fedora::encoder_candidates({true, false, true, true});
+    sr::fedora::EncoderProbeResults probe;
+    probe.set(sr::fedora::EncoderKind::VaLowPower, sr::fedora::ProbeState::Failed);
+    probe.set(sr::fedora::EncoderKind::VaApi, sr::fedora::ProbeState::Passed);
+    const auto usable = sr::fedora::probed_encoder_candidates(available, &probe);
+    ASSERT_EQ(usable.size(), 2U);
+    EXPECT_EQ(usable[0], sr::fedora::EncoderKind::VaApi);
+    EXPECT_EQ(usable[1], sr::fedora::EncoderKind::OpenH264);   // not probed yet: kept
+    EXPECT_EQ(sr::fedora::probed_encoder_candidates(available, nullptr).size(), 3U);
+}
+
+TEST(EncoderPolicy, KeepsTheFullListWhenEveryEncoderFailedItsProbe) {
+    const auto available = sr::fedora::encoder_candidates({true, false, false, true});
+    sr::fedora::EncoderProbeResults probe;
+    probe.set(sr::fedora::EncoderKind::VaLowPower, sr::fedora::ProbeState::Failed);
+    probe.set(sr::fedora::EncoderKind::OpenH264, sr::fedora::ProbeState::Failed);
+    EXPECT_EQ(sr::fedora::probed_encoder_candidates(available, &probe), available);
+}
+
+TEST(EncoderPolicy, ProbeCacheKeysAndFingerprintsAreStable) {
+    EXPECT_EQ(sr::fedora::encoder_kind_key(sr::fedora::EncoderKind::QuickSync), "quick_sync");
+    EXPECT_STREQ(sr::fedora::encoder_kind_factory(sr::fedora::EncoderKind::VaLowPower), "vah264lpenc");
+    EXPECT_EQ(sr::fedora::parse_probe_state(sr::fedora::probe_state_key(sr::fedora::ProbeState::Passed)),
+              sr::fedora::ProbeState::Passed);
+    EXPECT_EQ(sr::fedora::parse_probe_state("fail"), sr::fedora::ProbeState::Failed);
+    EXPECT_EQ(sr::fedora::parse_probe_state("garbage"), sr::fedora::ProbeState::Unknown);
+    EXPECT_EQ(sr::fedora::compose_probe_fingerprint({"b:2:2", "a:1:1"}),
+              sr::fedora::compose_probe_fingerprint({"a:1:1", "b:2:2"}));
+    EXPECT_NE(sr::fedora::compose_probe_fingerprint({"iHD_drv_video.so:10:1"}),
+              sr::fedora::compose_probe_fingerprint({"iHD_drv_video.so:10:2"}));
+}
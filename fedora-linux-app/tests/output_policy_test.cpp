@@ -0,0 +1,50 @@
+#include "output_policy.h"
+
+#include <gtest/gtest.h>
+
+using sr::fedora::OutputContainer;
+using sr::fedora::SegmentLimits;
+
+TEST(OutputPolicy, KeepsFaststartOnlyForThePlainContainer) {
+    EXPECT_EQ(sr::fedora::muxer_description(OutputContainer::Mp4, {}, "/v/a.partial.mp4", true),
+              "mp4mux name=mux faststart=true ! filesink location=\"/v/a.partial.mp4\" ");
+    EXPECT_EQ(sr::fedora::muxer_description(OutputContainer::FragmentedMp4, {}, "/v/a.partial.mp4", true),
+              "isofmp4mux name=mux fragment-duration=2000000000 ! filesink location=\"/v/a.partial.mp4\" ");
+    EXPECT_EQ(sr::fedora::muxer_description(OutputContainer::FragmentedMp4, {}, "/v/a.partial.mp4", false),
+              "mp4mux name=mux fragment-duration=2000 ! filesink location=\"/v/a.partial.mp4\" ");
+}
+
+TEST(OutputPolicy, SegmentsThroughSplitmuxsinkWithTimeAndSizeLimits) {
+    const auto timed = sr::fedora::muxer_description(OutputContainer::Mp4, {30, 0}, "p %03d.partial.mp4", true);
+    EXPECT_NE(timed.find("splitmuxsink name=mux"), std::string::npos);
+    EXPECT_NE(timed.find("max-size-time=1800000000000 send-keyframe-requests=true"), std::string::npos);
+    EXPECT_EQ(timed.find("max-size-bytes"), std::string::npos);
+    EXPECT_EQ(timed.find("muxer-properties"), std::string::npos);
+
+    const auto sized = sr::fedora::muxer_description(OutputContainer::FragmentedMp4, {0, 2048}, "p", true);
+    EXPECT_NE(sized.find("max-size-bytes=2147483648"), std::string::npos);
+    EXPECT_NE(sized.find("muxer-properties=\"properties,fragment-duration=2000\""), std::string::npos);
+    EXPECT_STREQ(sr::fedora::video_mux_pad({0, 2048}), "mux.video");
+    EXPECT_STREQ(sr::fedora::audio_mux_pad({}), "mux.");
+}
+
+TEST(OutputPolicy, SegmentNamesStayRecognisableForRecovery) {
+    const std::string partial = "/home/u/Videos/Screen Recording 2026-10-14_10-00-00.partial.mp4";
+    EXPECT_EQ(sr::fedora::segment_location_pattern(partial),
+              "/home/u/Videos/Screen Recording 2026-10-14_10-00-00 part %03d.partial.mp4");
+    EXPECT_EQ(sr::fedora::segment_location_pattern("/tmp/100%/a.partial.mp4"), "/tmp/100%%/a part %03d.partial.mp4");
+    EXPECT_TRUE(sr::fedora::is_segment_of("/home/u/Videos/Screen Recording 2026-10-14_10-00-00 part 004.partial.mp4", partial));
+    EXPECT_TRUE(sr::fedora::is_segment_of("/home/u/Videos/Screen Recording 2026-10-14_10-00-00 part 1000.partial.mp4", partial));
+    EXPECT_FALSE(sr::fedora::is_segment_of(partial, partial));
+    EXPECT_FALSE(sr::fedora::is_segment_of("/home/u/Videos/Screen Recording 2026-10-14_10-00-00 part 004.mp4", partial));
+    EXPECT_FALSE(sr::fedora::is_segment_of("/home/u/Videos/Screen Recording 2026-10-14_10-00-00 (2) part 004.partial.mp4", partial));
+}
+
+TEST(OutputPolicy, PresetsAndSettingsKeysRoundTrip) {
+    EXPECT_EQ(sr::fedora::segment_preset_index({}), 0U);
+    EXPECT_EQ(sr::fedora::segment_preset_index({60, 0}), 3U);
+    EXPECT_EQ(sr::fedora::segment_preset_index({45, 0}), sr::fedora::kSegmentPresets.size());
+    EXPECT_EQ(sr::fedora::parse_output_container(sr::fedora::output_container_key(OutputContainer::FragmentedMp4)),
+              OutputContainer::FragmentedMp4);
+    EXPECT_EQ(sr::fedora::parse_output_container("bogus"), OutputContainer::Mp4);
+}
@@ -0,0 +1,52 @@
+#include "power_adaptation.h"
+
+#include <gtest/gtest.h>
+
+TEST(PowerAdaptation, EfficiencyModeCutsBitrateAndFpsOnBattery) {
+    const auto ac = sr::fedora::profile_for(false, false, true, 30);
+    const auto battery = sr::fedora::profile_for(false, false, false, 30);
+    const auto plan = sr::fedora::plan_power_adaptation(ac, battery, false);
+    EXPECT_TRUE(plan.bitrate);
+    EXPECT_TRUE(plan.fps);
+    EXPECT_FALSE(plan.resolution);
+}
+
+TEST(PowerAdaptation, HighQualityIsUnaffectedAndResolutionNeedsSegments) {
+    const auto hq = sr::fedora::profile_for(true, false, true, 30);
+    const auto plan = sr::fedora::plan_power_adaptation(hq, sr::fedora::profile_for(true, false, false, 30), true);
+    EXPECT_FALSE(plan.bitrate);
+    EXPECT_FALSE(plan.fps);
+    EXPECT_FALSE(plan.resolution);
+
+    auto smaller = hq;
+    smaller.width = 1280;
+    smaller.height = 720;
+    EXPECT_FALSE(sr::fedora::plan_power_adaptation(hq, smaller, false).resolution);
+    EXPECT_TRUE(sr::fedora::plan_power_adaptation(hq, smaller, true).resolution);
+}
+
+TEST(FrameRateLimiter, HalvesAThirtyFpsSourceAtFifteen) {
+    sr::fedora::FrameRateLimiter limiter;
+    limiter.set_max_fps(15);
+    int admitted = 0;
+    for (std::uint64_t frame = 0; frame < 30; ++frame) {
+        // 30 FPS with +-2 ms capture jitter
+        const std::uint64_t pts = frame * 33'333'333ULL + (frame % 2 ? 2'000'000ULL : 0);
+        if (limiter.admit(pts)) ++admitted;
+    }
+    EXPECT_EQ(admitted, 15);
+    EXPECT_EQ(limiter.dropped(), 15U);
+}
+
+TEST(FrameRateLimiter, PassesEverythingWhenUnlimitedAndRestartsAfterAStall) {
+    sr::fedora::FrameRateLimiter limiter;
+    for (std::uint64_t frame = 0; frame < 10; ++frame) EXPECT_TRUE(limiter.admit(frame * 16'666'666ULL));
+    limiter.set_max_fps(10);
+    EXPECT_TRUE(limiter.admit(1'000'000'000ULL));
+    EXPECT_FALSE(limiter.admit(1'050'000'000ULL));
+    EXPECT_TRUE(limiter.admit(5'000'000'000ULL));    // a long pause re-anchors the cadence
+    EXPECT_FALSE(limiter.admit(5'050'000'000ULL));
+    EXPECT_TRUE(limiter.admit(5'100'000'000ULL));
+    limiter.set_max_fps(0);
+    EXPECT_TRUE(limiter.admit(5'110'000'000ULL));
+}
@@ -33,4 +33,17 @@ TEST_F(RecoveryActionsTest, RefusesToOverwriteCompletedRecording) {
     EXPECT_TRUE(std::filesystem::exists(partial));
 }
 
+TEST_F(RecoveryActionsTest, FindsOnlyPartialRecordings) {
+    std::ofstream(root / "a.partial.mp4") << "a";
+    std::ofstream(root / "b.mp4") << "b";
+    std::ofstream(root / ".partial.mp4") << "c";
+    std::filesystem::create_directories(root / "d.partial.mp4");
+
+    const auto found = sr::fedora::find_partial_recordings(root, [] { return false; });
+    ASSERT_EQ(found.size(), 1U);
+    EXPECT_EQ(found.front().filename(), "a.partial.mp4");
+    EXPECT_TRUE(sr::fedora::find_partial_recordings(root, [] { return true; }).empty());
+    EXPECT_TRUE(sr::fedora::find_partial_recordings(root / "missing", [] { return false; }).empty());
+}
+
 }  // namespace
@@ -0,0 +1,77 @@
+#include "replay_queue.h"
+
+#include <gtest/gtest.h>
+
+namespace {
+
+constexpr std::int64_t kSecond = 1'000'000'000;
+
+// 30 FPS video with a keyframe every `gop` frames and an audio buffer per frame
+void feed(sr::fedora::ReplayQueue<int>& queue, int frames, int gop, std::uint32_t frame_bytes = 1000) {
+    for (int frame = 0; frame < frames; ++frame) {
+        const std::int64_t pts = frame * kSecond / 30;
+        queue.push_video(frame, pts, pts, frame_bytes, frame % gop == 0);
+        queue.push_audio(-frame, pts, 100);
+    }
+}
+
+}  // namespace
+
+TEST(ReplayQueue, StartsOnTheFirstKeyframe) {
+    sr::fedora::ReplayQueue<int> queue;
+    queue.reset(10 * kSecond, 0);
+    queue.push_audio(0, 0, 100);
+    queue.push_video(1, 0, 0, 1000, false);
+    EXPECT_TRUE(queue.empty());
+    queue.push_video(2, kSecond / 30, kSecond / 30, 1000, true);
+    queue.push_audio(3, kSecond / 30, 100);
+    ASSERT_EQ(queue.size(), 2U);
+    EXPECT_TRUE(queue.entries().front().keyframe);
+    EXPECT_EQ(queue.bytes(), 1100U);
+}
+
+TEST(ReplayQueue, KeepsAtLeastTheWindowInWholeGops) {
+    sr::fedora::ReplayQueue<int> queue;
+    queue.reset(5 * kSecond, 0);
+    feed(queue, 30 * 20, 60);   // 20 s with a 2 s GOP
+    EXPECT_GE(queue.duration(), 5 * kSecond);
+    EXPECT_LT(queue.duration(), 7 * kSecond);
+    const auto& front = queue.entries().front();
+    EXPECT_TRUE(front.video);
+    EXPECT_TRUE(front.keyframe);
+    EXPECT_EQ(queue.time_offset(), front.pts);
+}
+
+TEST(ReplayQueue, ByteCapEvictsButKeepsTheNewestGop) {
+    sr::fedora::ReplayQueue<int> queue;
+    queue.reset(60 * kSecond, 100'000);
+    feed(queue, 30 * 10, 60, 2000);
+    EXPECT_LE(queue.bytes(), 100'000U + 60U * 2100U);
+    EXPECT_LT(queue.duration(), 60 * kSecond);
+    EXPECT_TRUE(queue.entries().front().keyframe);
+}
+
+TEST(ReplayQueue, OffsetFollowsAReorderedFirstKeyframe) {
+    sr::fedora::ReplayQueue<int> queue;
+    queue.reset(kSecond, 0);
+    queue.push_video(0, 100, 40, 10, true);
+    EXPECT_EQ(queue.time_offset(), 40);
+}
+
+TEST(ReplayPresets, IndexAndCap) {
+    EXPECT_EQ(sr::fedora::replay_preset_index(0), 0U);
+    EXPECT_EQ(sr::fedora::replay_preset_index(60), 3U);
+    EXPECT_EQ(sr::fedora::replay_preset_index(45), sr::fedora::kReplayPresets.size());
+    // 30 s of 4 Mbps video and 128 kb/s audio: about 31 MB with the headroom
+    EXPECT_EQ(sr::fedora::replay_byte_cap(30, 4000, 128), 2ULL * 516'000ULL * 30ULL + 8ULL * 1024ULL * 1024ULL);
+}
+
+TEST(ReplaySaveDescription, AudioBranchIsOptional) {
+    EXPECT_EQ(sr::fedora::replay_sinks(false).find("replay_audio"), std::string::npos);
+    EXPECT_NE(sr::fedora::replay_sinks(true).find("fakesink name=replay_audio"), std::string::npos);
+    const auto video_only = sr::fedora::replay_save_description("/tmp/a.partial.mp4", false);
+    EXPECT_NE(video_only.find("mp4mux name=mux"), std::string::npos);
+    EXPECT_NE(video_only.find("location=\"/tmp/a.partial.mp4\""), std::string::npos);
+    EXPECT_EQ(video_only.find("replay_audio_src"), std::string::npos);
+    EXPECT_NE(sr::fedora::replay_save_description("x", true).find("appsrc name=replay_audio_src"), std::string::npos);
+}
@@ -0,0 +1,25 @@
+#include "screen_preview_policy.h"
+
+#include <gtest/gtest.h>
+
+TEST(ScreenPreviewPolicy, LowerRateOnBatteryAndInBatterySaver) {
+    const auto ac = sr::fedora::screen_preview_for(sr::fedora::profile_for(false, false, true, 30));
+    EXPECT_EQ(ac.width, 640);
+    EXPECT_EQ(ac.fps, 10);
+    EXPECT_EQ(sr::fedora::screen_preview_for(sr::fedora::profile_for(true, false, true, 60)).fps, 10);
+    const auto battery = sr::fedora::screen_preview_for(sr::fedora::profile_for(false, false, false, 30));
+    EXPECT_EQ(battery.width, 480);
+    EXPECT_EQ(battery.fps, 5);
+    EXPECT_EQ(sr::fedora::screen_preview_for(sr::fedora::profile_for(false, true, true, 30)).fps, 5);
+}
+
+TEST(ScreenPreviewPolicy, BranchStaysOnTheGpuOrIsOmitted) {
+    const auto branch = sr::fedora::screen_preview_branch({640, 10}, "screen_tee", true);
+    EXPECT_EQ(branch.rfind("screen_tee. ! queue max-size-buffers=1", 0), 0U);
+    EXPECT_NE(branch.find("leaky=downstream"), std::string::npos);
+    EXPECT_NE(branch.find("max-rate=10"), std::string::npos);
+    EXPECT_NE(branch.find("video/x-raw(memory:GLMemory),format=RGBA,width=640 "), std::string::npos);
+    EXPECT_NE(branch.find("gtk4paintablesink name=screen_preview_sink"), std::string::npos);
+    EXPECT_EQ(branch.find("videoconvert"), std::string::npos);
+    EXPECT_TRUE(sr::fedora::screen_preview_branch({640, 10}, "screen_tee", false).empty());
+}
@@ -6,3 +6,44 @@ TEST(Telemetry, FormatsAllCountersForTheUiAndDiagnostics) {
     const sr::fedora::TelemetrySnapshot snapshot{57, 42, 18, 3};
     EXPECT_EQ(sr::fedora::format_telemetry(snapshot), "Captured: 57  Encoded: 42  Audio: 18  QoS drops: 3");
 }
+
+TEST(Telemetry, ParsesLatencyTracerRecords) {
+    const auto element = sr::fedora::parse_tracer_record(
+        "element-latency, element-id=(string)0x55d0, element=(string)video_encoder, src=(string)src, "
+        "time=(guint64)4200000, ts=(guint64)99;");
+    ASSERT_TRUE(element);
+    EXPECT_EQ(element->label, "video_encoder");
+    EXPECT_EQ(element->ns, 4'200'000U);
+
+    const auto pipeline = sr::fedora::parse_tracer_record(
+        "latency, src-element-id=(string)0x1, src-element=(string)pipewiresrc0, src=(string)src, "
+        "sink-element-id=(string)0x2, sink-element=(string)filesink0, sink=(string)sink, time=(guint64)16000000;");
+    ASSERT_TRUE(pipeline);
+    EXPECT_EQ(pipeline->label, "pipewiresrc0->filesink0");
+
+    const auto inter = sr::fedora::parse_tracer_record(
+        "interlatency, from_pad=(string)pipewiresrc0_src, to_pad=(string)video_encoder_src, "
+        "time=(string)0:00:00.012345;");
+    ASSERT_TRUE(inter);
+    EXPECT_EQ(inter->label, "pipewiresrc0_src->video_encoder_src");
+    EXPECT_EQ(inter->ns, 12'345'000U);
+
+    EXPECT_FALSE(sr::fedora::parse_tracer_record("rusage, thread-id=(guint64)1;"));
+    EXPECT_FALSE(sr::fedora::parse_tracer_record("element-latency, element=(string)x, time=(string)bogus;"));
+}
+
+TEST(Telemetry, LatencyTableReportsTheSlowestElementsFirst) {
+    sr::fedora::LatencyTable table;
+    table.record({"videoconvert0", 6'000'000});
+    table.record({"videoconvert0", 2'000'000});
+    table.record({"video_encoder", 1'000'000});
+    table.record({"queue0", 9'000'000});
+    const auto slowest = table.slowest(2);
+    ASSERT_EQ(slowest.size(), 2U);
+    EXPECT_EQ(slowest[0].label, "queue0");
+    EXPECT_EQ(slowest[1].label, "videoconvert0");
+    EXPECT_EQ(slowest[1].mean_ns(), 4'000'000U);
+    EXPECT_EQ(slowest[1].max_ns, 6'000'000U);
+    EXPECT_EQ(sr::fedora::format_latency_report({slowest[1]}),
+              "latency videoconvert0 mean_us=4000 max_us=6000 samples=2\n");
+}
@@ -8,6 +8,7 @@
 #include <string>
 #include <filesystem>
 #include "utils/logging.h"
+#include "utils/video_codec.h"
 
 namespace sr {
 
@@ -16,12 +17,112 @@ struct AppSettings {
     uint32_t     fps         = 30;           // 30 or 60
     uint32_t     bitrate_bps = 4'000'000;    // auto-selected based on fps + high_quality
     bool         high_quality = false;       // when true, uses higher bitrate for better quality
+    CodecPreference codec    = CodecPreference::H264;  // "h264" | "hevc" | "av1" | "auto"
+    bool         adaptive_quality = true;    // lower bitrate/fps while the encoder can't keep up
+    bool         variable_frame_rate = false; // encode changed frames only; off = constant fps for editors
+    bool         adaptive_gop    = true;     // long GOPs on static content, IDRs on scene cuts
+    uint32_t     gop_max_seconds = 10;       // adaptive GOP bound for seeking, 2-60 s
 
     // Storage settings (T025)
     std::wstring output_dir;                 // empty = use Videos\Recordings default
+    bool         fragmented_mp4 = false;     // fMP4: crash-safe, no long finalize
+    uint32_t     fragment_ms    = 2000;      // fMP4 fragment duration
+    bool         unbuffered_io   = false;    // large aligned overlapped writes (network shares, HDDs)
+    uint32_t     io_chunk_mb     = 4;        // unbuffered write chunk, 4-8 MB
+    bool         preallocate     = false;    // reserve file extents ahead of the writer
+    bool         keyframe_index  = true;     // <file>.keyidx sidecar for lossless trims (--trim)
+    bool         perf_trace      = true;     // <file>.perftrace per-second timeline (sr_trace_view)
+    uint32_t     expected_minutes = 0;       // refuse to start if the volume can't hold this (0 = off)
+    uint32_t     segment_minutes = 0;        // rotate to a new file every N minutes (0 = off)
+    uint32_t     segment_mb      = 0;        // ... or every N MB (0 = off)
+    bool         proxy_output    = false;    // also write an 848x480 <name>_proxy.mp4
+    uint32_t     proxy_kbps      = 1000;     // proxy bitrate, 250-4000 kbps
+
+    // Background transcode: after each recording, re-encode it on the GPU into
+    // <name>_<height>p.mp4 (paused while recording); kbps 0 = scale the source's
+    bool         transcode_enabled = false;
+    uint32_t     transcode_height  = 720;      // 144-2160
+    uint32_t     transcode_kbps    = 0;
+    CodecPreference transcode_codec = CodecPreference::H264;
+    uint32_t     transcode_jobs    = 1;        // concurrent jobs, 1-4
+
+    // Instant replay: keep the last N seconds in memory, save on Alt+F10 (0 = off)
+    uint32_t     replay_seconds  = 0;
+
+    // Live stream: also publish the video to rtmp://host[:port]/app/key (empty = off).
+    // Queued video older than live_max_latency_ms is dropped in whole GOPs.
+    std::wstring live_url;
+    uint32_t     live_max_latency_ms = 2000;
 
     // Camera overlay settings
     bool         camera_overlay_enabled = false;
+    // Composite the camera into the recording (the preview window is then
+    // hidden from capture); corner 0-3 = TL, TR, BL, BR; size = % of width
+    bool         camera_pip      = false;
+    uint32_t     camera_pip_corner = 3;
+    uint32_t     camera_pip_size   = 25;
+
+    // Audio settings: in-process polyphase resampler (true) or the MF resampler MFT
+    bool         native_resampler = true;
+    // Mic and system audio as two AAC tracks instead of one mixed track
+    bool         separate_audio_tracks = false;
+    // Audio codec: "aac" (default) or "opus" (needs an Opus encoder MFT, else AAC).
+    // AAC snaps to 96/128/160/192 kb/s (LC) or 48-96 kb/s (HE); Opus 6-510 kb/s.
+    std::wstring audio_codec = L"aac";
+    uint32_t     aac_kbps    = 128;
+    std::wstring aac_profile = L"lc";   // "lc" | "he"
+    uint32_t     opus_kbps   = 32;
+    // WASAPI period: "auto" (batched wakeups on battery), "default", "power"
+    // (40 ms batches always) or "low" (minimum period, for monitoring)
+    std::wstring audio_latency = L"auto";
+
+    // Capture source: non-empty window_title records the first matching window,
+    // otherwise monitor_index (0 = primary, 1.. = other monitors)
+    uint32_t     monitor_index = 0;
+    std::wstring window_title;
+
+    // Keep capture, audio and the encoder initialized while idle so Start
+    // is near-instant (holds the devices open between recordings)
+    bool         prearm = true;
+
+    // Capture on its own D3D11 device; the encoder GPU-waits on a shared fence
+    // instead of sharing one immediate context with the capture thread
+    bool         isolated_capture_device = false;
+
+    // Create the device on the GPU that drives the captured monitor (avoids a
+    // per-frame cross-adapter copy on hybrid laptops); off = prefer Intel
+    bool         match_display_adapter = true;
+
+    // Encode on the GPU with the least contention (e.g. NVENC while the
+    // iGPU drives the display); capture stays on the display adapter and
+    // hands NV12 across. Overrides match_display_adapter.
+    bool         split_encode_adapter = false;
+
+    // MMCSS, GPU thread priority and EcoQoS opt-out while recording
+    bool         pipeline_boost = true;
+
+    // Composite the cursor ourselves so mouse-only motion is a tiny delta
+    // instead of a WGC whole-screen change
+    bool         cursor_overlay = false;
+
+    // Record every monitor at once, one file per display, with the same
+    // audio; hw_encoder_sessions caps concurrent hardware encoders (0 = the
+    // vendor's limit)
+    bool         all_monitors        = false;
+    uint32_t     hw_encoder_sessions = 0;
+
+    // On an HDR desktop, capture FP16 and tone-map to SDR instead of WGC's
+    // clipped BGRA rendition
+    bool         hdr_tonemap = true;
+
+    // BGRA -> NV12: "auto" (time both on the GPU, keep the faster), "vp"
+    // (D3D11 video processor) or "compute"; nv12_filter = "bilinear" | "box"
+    // is the compute path's downscale quality
+    std::wstring nv12_converter = L"auto";
+    std::wstring nv12_filter    = L"bilinear";
+
+    // Share live NV12 frames with local analysis tools (Local\ScreenRecorderFrameTap)
+    bool         frame_tap = false;
 
     // --------------------------------------------------------------------------
     // Load from %APPDATA%\ScreenRecorder\settings.ini
@@ -42,20 +143,152 @@ struct AppSettings {
         // Auto-assign bitrate based on fps + high_quality
         bitrate_bps = compute_bitrate(fps, high_quality);
 
+        wchar_t codec_buf[16]{};
+        GetPrivateProfileStringW(L"Video", L"codec", L"h264",
+                                 codec_buf, static_cast<DWORD>(_countof(codec_buf)), ini.c_str());
+        codec = parse_codec(codec_buf);
+        adaptive_quality =
+            GetPrivateProfileIntW(L"Video", L"adaptive_quality", 1, ini.c_str()) != 0;
+        variable_frame_rate =
+            GetPrivateProfileIntW(L"Video", L"variable_frame_rate", 0, ini.c_str()) != 0;
+        adaptive_gop =
+            GetPrivateProfileIntW(L"Video", L"adaptive_gop", 1, ini.c_str()) != 0;
+        gop_max_seconds = static_cast<uint32_t>(
+            GetPrivateProfileIntW(L"Video", L"gop_max_seconds", 10, ini.c_str()));
+        if (gop_max_seconds < 2 || gop_max_seconds > 60) gop_max_seconds = 10;
+
         // Output directory
         wchar_t buf[MAX_PATH]{};
         GetPrivateProfileStringW(L"Storage", L"output_dir", L"",
                                  buf, MAX_PATH, ini.c_str());
         output_dir = buf;
 
+        fragmented_mp4 =
+            GetPrivateProfileIntW(L"Storage", L"fragmented_mp4", 0, ini.c_str()) != 0;
+        fragment_ms = static_cast<uint32_t>(
+            GetPrivateProfileIntW(L"Storage", L"fragment_ms", 2000, ini.c_str()));
+        if (fragment_ms < 500 || fragment_ms > 10'000) fragment_ms = 2000;
+        unbuffered_io =
+            GetPrivateProfileIntW(L"Storage", L"unbuffered_io", 0, ini.c_str()) != 0;
+        io_chunk_mb = static_cast<uint32_t>(
+            GetPrivateProfileIntW(L"Storage", L"io_chunk_mb", 4, ini.c_str()));
+        if (io_chunk_mb < 4 || io_chunk_mb > 8) io_chunk_mb = 4;
+        preallocate =
+            GetPrivateProfileIntW(L"Storage", L"preallocate", 0, ini.c_str()) != 0;
+        keyframe_index =
+            GetPrivateProfileIntW(L"Storage", L"keyframe_index", 1, ini.c_str()) != 0;
+        perf_trace =
+            GetPrivateProfileIntW(L"Storage", L"perf_trace", 1, ini.c_str()) != 0;
+        expected_minutes = static_cast<uint32_t>(
+            GetPrivateProfileIntW(L"Storage", L"expected_minutes", 0, ini.c_str()));
+        segment_minutes = static_cast<uint32_t>(
+            GetPrivateProfileIntW(L"Storage", L"segment_minutes", 0, ini.c_str()));
+        segment_mb = static_cast<uint32_t>(
+            GetPrivateProfileIntW(L"Storage", L"segment_mb", 0, ini.c_str()));
+        proxy_output =
+            GetPrivateProfileIntW(L"Storage", L"proxy_output", 0, ini.c_str()) != 0;
+        proxy_kbps = static_cast<uint32_t>(
+            GetPrivateProfileIntW(L"Storage", L"proxy_kbps", 1000, ini.c_str()));
+        if (proxy_kbps < 250 || proxy_kbps > 4000) proxy_kbps = 1000;
+        transcode_enabled =
+            GetPrivateProfileIntW(L"Transcode", L"enabled", 0, ini.c_str()) != 0;
+        transcode_height = static_cast<uint32_t>(
+            GetPrivateProfileIntW(L"Transcode", L"height", 720, ini.c_str()));
+        if (transcode_height < 144 || transcode_height > 2160) transcode_height = 720;
+        transcode_kbps = static_cast<uint32_t>(
+            GetPrivateProfileIntW(L"Transcode", L"kbps", 0, ini.c_str()));
+        if (transcode_kbps > 100'000) transcode_kbps = 0;
+        GetPrivateProfileStringW(L"Transcode", L"codec", L"h264",
+                                 buf, MAX_PATH, ini.c_str());
+        transcode_codec = parse_codec(buf);
+        transcode_jobs = static_cast<uint32_t>(
+            GetPrivateProfileIntW(L"Transcode", L"jobs", 1, ini.c_str()));
+        if (transcode_jobs < 1 || transcode_jobs > 4) transcode_jobs = 1;
+        replay_seconds = static_cast<uint32_t>(
+            GetPrivateProfileIntW(L"Replay", L"seconds", 0, ini.c_str()));
+        if (replay_seconds > 600) replay_seconds = 600;
+        wchar_t url[1024]{};
+        GetPrivateProfileStringW(L"Stream", L"live_url", L"",
+                                 url, static_cast<DWORD>(_countof(url)), ini.c_str());
+        live_url = url;
+        live_max_latency_ms = static_cast<uint32_t>(
+            GetPrivateProfileIntW(L"Stream", L"live_max_latency_ms", 2000, ini.c_str()));
+        if (live_max_latency_ms < 500 || live_max_latency_ms > 30'000) live_max_latency_ms = 2000;
+
         camera_overlay_enabled =
             GetPrivateProfileIntW(L"Camera", L"overlay_enabled", 0, ini.c_str()) != 0;
+        camera_pip = GetPrivateProfileIntW(L"Camera", L"pip", 0, ini.c_str()) != 0;
+        camera_pip_corner = static_cast<uint32_t>(
+            GetPrivateProfileIntW(L"Camera", L"pip_corner", 3, ini.c_str()));
+        if (camera_pip_corner > 3) camera_pip_corner = 3;
+        camera_pip_size = static_cast<uint32_t>(
+            GetPrivateProfileIntW(L"Camera", L"pip_size", 25, ini.c_str()));
+        if (camera_pip_size < 5 || camera_pip_size > 50) camera_pip_size = 25;
+
+        native_resampler =
+            GetPrivateProfileIntW(L"Audio", L"native_resampler", 1, ini.c_str()) != 0;
+        separate_audio_tracks =
+            GetPrivateProfileIntW(L"Audio", L"separate_tracks", 0, ini.c_str()) != 0;
+        wchar_t codec_buf[16]{};
+        GetPrivateProfileStringW(L"Audio", L"codec", L"aac", codec_buf,
+                                 static_cast<DWORD>(_countof(codec_buf)), ini.c_str());
+        audio_codec = _wcsicmp(codec_buf, L"opus") == 0 ? L"opus" : L"aac";
+        GetPrivateProfileStringW(L"Audio", L"aac_profile", L"lc", codec_buf,
+                                 static_cast<DWORD>(_countof(codec_buf)), ini.c_str());
+        aac_profile = _wcsicmp(codec_buf, L"he") == 0 ? L"he" : L"lc";
+        aac_kbps = static_cast<uint32_t>(
+            GetPrivateProfileIntW(L"Audio", L"aac_kbps", 128, ini.c_str()));
+        if (aac_kbps < 32 || aac_kbps > 320) aac_kbps = 128;
+        opus_kbps = static_cast<uint32_t>(
+            GetPrivateProfileIntW(L"Audio", L"opus_kbps", 32, ini.c_str()));
+        if (opus_kbps < 6 || opus_kbps > 510) opus_kbps = 32;
+        GetPrivateProfileStringW(L"Audio", L"latency", L"auto", codec_buf,
+                                 static_cast<DWORD>(_countof(codec_buf)), ini.c_str());
+        audio_latency = L"auto";
+        for (const wchar_t* mode : { L"default", L"power", L"low" }) {
+            if (_wcsicmp(codec_buf, mode) == 0) audio_latency = mode;
+        }
+
+        monitor_index = static_cast<uint32_t>(
+            GetPrivateProfileIntW(L"Capture", L"monitor_index", 0, ini.c_str()));
+        wchar_t title[256]{};
+        GetPrivateProfileStringW(L"Capture", L"window_title", L"",
+                                 title, static_cast<DWORD>(_countof(title)), ini.c_str());
+        window_title = title;
+        prearm = GetPrivateProfileIntW(L"Capture", L"prearm", 1, ini.c_str()) != 0;
+        isolated_capture_device =
+            GetPrivateProfileIntW(L"Capture", L"isolated_device", 0, ini.c_str()) != 0;
+        match_display_adapter =
+            GetPrivateProfileIntW(L"Capture", L"match_display_adapter", 1, ini.c_str()) != 0;
+        split_encode_adapter =
+            GetPrivateProfileIntW(L"Capture", L"split_encode_adapter", 0, ini.c_str()) != 0;
+        pipeline_boost = GetPrivateProfileIntW(L"Capture", L"pipeline_boost", 1, ini.c_str()) != 0;
+        cursor_overlay = GetPrivateProfileIntW(L"Capture", L"cursor_overlay", 0, ini.c_str()) != 0;
+        all_monitors   = GetPrivateProfileIntW(L"Capture", L"all_monitors", 0, ini.c_str()) != 0;
+        hw_encoder_sessions = static_cast<uint32_t>(
+            GetPrivateProfileIntW(L"Capture", L"hw_encoder_sessions", 0, ini.c_str()));
+        if (hw_encoder_sessions > 64) hw_encoder_sessions = 0;
+        hdr_tonemap    = GetPrivateProfileIntW(L"Capture", L"hdr_tonemap", 1, ini.c_str()) != 0;
+        frame_tap      = GetPrivateProfileIntW(L"Capture", L"frame_tap", 0, ini.c_str()) != 0;
+        GetPrivateProfileStringW(L"Capture", L"nv12_converter", L"auto", codec_buf,
+                                 static_cast<DWORD>(_countof(codec_buf)), ini.c_str());
+        nv12_converter = L"auto";
+        for (const wchar_t* mode : { L"vp", L"compute" }) {
+            if (_wcsicmp(codec_buf, mode) == 0) nv12_converter = mode;
+        }
+        GetPrivateProfileStringW(L"Capture", L"nv12_filter", L"bilinear", codec_buf,
+                                 static_cast<DWORD>(_countof(codec_buf)), ini.c_str());
+        nv12_filter = _wcsicmp(codec_buf, L"box") == 0 ? L"box" : L"bilinear";
 
-        SR_LOG_INFO(L"Settings loaded: fps=%u, high_quality=%s, output_dir=%s, camera_overlay=%s",
+        SR_LOG_INFO(L"Settings loaded: fps=%u, high_quality=%s, output_dir=%s, camera_overlay=%s, resampler=%s, "
+                    L"capture=%s%s",
                     fps,
                     high_quality ? L"on" : L"off",
                     output_dir.empty() ? L"(default)" : output_dir.c_str(),
-                    camera_overlay_enabled ? L"on" : L"off");
+                    camera_overlay_enabled ? L"on" : L"off",
+                    native_resampler ? L"native" : L"MF",
+                    window_title.empty() ? L"monitor " : L"window ",
+                    window_title.empty() ? std::to_wstring(monitor_index).c_str() : window_title.c_str());
         return true;
     }
 
@@ -79,9 +312,90 @@ struct AppSettings {
         WritePrivateProfileStringW(L"Video",   L"fps",        buf,             ini.c_str());
         WritePrivateProfileStringW(L"Video",   L"high_quality",
                                    high_quality ? L"1" : L"0", ini.c_str());
+        WritePrivateProfileStringW(L"Video",   L"codec",      codec_key(codec), ini.c_str());
+        WritePrivateProfileStringW(L"Video",   L"adaptive_quality",
+                                   adaptive_quality ? L"1" : L"0", ini.c_str());
+        WritePrivateProfileStringW(L"Video",   L"variable_frame_rate",
+                                   variable_frame_rate ? L"1" : L"0", ini.c_str());
+        WritePrivateProfileStringW(L"Video",   L"adaptive_gop",
+                                   adaptive_gop ? L"1" : L"0", ini.c_str());
+        _snwprintf_s(buf, _countof(buf), _TRUNCATE, L"%u", gop_max_seconds);
+        WritePrivateProfileStringW(L"Video",   L"gop_max_seconds", buf, ini.c_str());
         WritePrivateProfileStringW(L"Storage", L"output_dir", output_dir.c_str(), ini.c_str());
+        WritePrivateProfileStringW(L"Storage", L"fragmented_mp4",
+                                   fragmented_mp4 ? L"1" : L"0", ini.c_str());
+        _snwprintf_s(buf, _countof(buf), _TRUNCATE, L"%u", fragment_ms);
+        WritePrivateProfileStringW(L"Storage", L"fragment_ms", buf, ini.c_str());
+        WritePrivateProfileStringW(L"Storage", L"unbuffered_io",
+                                   unbuffered_io ? L"1" : L"0", ini.c_str());
+        _snwprintf_s(buf, _countof(buf), _TRUNCATE, L"%u", io_chunk_mb);
+        WritePrivateProfileStringW(L"Storage", L"io_chunk_mb", buf, ini.c_str());
+        WritePrivateProfileStringW(L"Storage", L"preallocate",
+                                   preallocate ? L"1" : L"0", ini.c_str());
+        WritePrivateProfileStringW(L"Storage", L"keyframe_index",
+                                   keyframe_index ? L"1" : L"0", ini.c_str());
+        WritePrivateProfileStringW(L"Storage", L"perf_trace",
+                                   perf_trace ? L"1" : L"0", ini.c_str());
+        _snwprintf_s(buf, _countof(buf), _TRUNCATE, L"%u", expected_minutes);
+        WritePrivateProfileStringW(L"Storage", L"expected_minutes", buf, ini.c_str());
+        _snwprintf_s(buf, _countof(buf), _TRUNCATE, L"%u", segment_minutes);
+        WritePrivateProfileStringW(L"Storage", L"segment_minutes", buf, ini.c_str());
+        _snwprintf_s(buf, _countof(buf), _TRUNCATE, L"%u", segment_mb);
+        WritePrivateProfileStringW(L"Storage", L"segment_mb", buf, ini.c_str());
+        WritePrivateProfileStringW(L"Storage", L"proxy_output",
+                                   proxy_output ? L"1" : L"0", ini.c_str());
+        _snwprintf_s(buf, _countof(buf), _TRUNCATE, L"%u", proxy_kbps);
+        WritePrivateProfileStringW(L"Storage", L"proxy_kbps", buf, ini.c_str());
+        WritePrivateProfileStringW(L"Transcode", L"enabled", transcode_enabled ? L"1" : L"0", ini.c_str());
+        _snwprintf_s(buf, _countof(buf), _TRUNCATE, L"%u", transcode_height);
+        WritePrivateProfileStringW(L"Transcode", L"height", buf, ini.c_str());
+        _snwprintf_s(buf, _countof(buf), _TRUNCATE, L"%u", transcode_kbps);
+        WritePrivateProfileStringW(L"Transcode", L"kbps", buf, ini.c_str());
+        WritePrivateProfileStringW(L"Transcode", L"codec", codec_key(transcode_codec), ini.c_str());
+        _snwprintf_s(buf, _countof(buf), _TRUNCATE, L"%u", transcode_jobs);
+        WritePrivateProfileStringW(L"Transcode", L"jobs", buf, ini.c_str());
+        _snwprintf_s(buf, _countof(buf), _TRUNCATE, L"%u", replay_seconds);
+        WritePrivateProfileStringW(L"Replay",  L"seconds", buf, ini.c_str());
+        WritePrivateProfileStringW(L"Stream",  L"live_url", live_url.c_str(), ini.c_str());
+        _snwprintf_s(buf, _countof(buf), _TRUNCATE, L"%u", live_max_latency_ms);
+        WritePrivateProfileStringW(L"Stream",  L"live_max_latency_ms", buf, ini.c_str());
         WritePrivateProfileStringW(L"Camera",  L"overlay_enabled",
                                    camera_overlay_enabled ? L"1" : L"0", ini.c_str());
+        WritePrivateProfileStringW(L"Camera",  L"pip", camera_pip ? L"1" : L"0", ini.c_str());
+        _snwprintf_s(buf, _countof(buf), _TRUNCATE, L"%u", camera_pip_corner);
+        WritePrivateProfileStringW(L"Camera",  L"pip_corner", buf, ini.c_str());
+        _snwprintf_s(buf, _countof(buf), _TRUNCATE, L"%u", camera_pip_size);
+        WritePrivateProfileStringW(L"Camera",  L"pip_size", buf, ini.c_str());
+        WritePrivateProfileStringW(L"Audio",   L"native_resampler",
+                                   native_resampler ? L"1" : L"0", ini.c_str());
+        WritePrivateProfileStringW(L"Audio",   L"separate_tracks",
+                                   separate_audio_tracks ? L"1" : L"0", ini.c_str());
+        WritePrivateProfileStringW(L"Audio",   L"codec", audio_codec.c_str(), ini.c_str());
+        WritePrivateProfileStringW(L"Audio",   L"aac_profile", aac_profile.c_str(), ini.c_str());
+        _snwprintf_s(buf, _countof(buf), _TRUNCATE, L"%u", aac_kbps);
+        WritePrivateProfileStringW(L"Audio",   L"aac_kbps", buf, ini.c_str());
+        _snwprintf_s(buf, _countof(buf), _TRUNCATE, L"%u", opus_kbps);
+        WritePrivateProfileStringW(L"Audio",   L"opus_kbps", buf, ini.c_str());
+        WritePrivateProfileStringW(L"Audio",   L"latency", audio_latency.c_str(), ini.c_str());
+        _snwprintf_s(buf, _countof(buf), _TRUNCATE, L"%u", monitor_index);
+        WritePrivateProfileStringW(L"Capture", L"monitor_index", buf,  ini.c_str());
+        WritePrivateProfileStringW(L"Capture", L"window_title", window_title.c_str(), ini.c_str());
+        WritePrivateProfileStringW(L"Capture", L"prearm", prearm ? L"1" : L"0", ini.c_str());
+        WritePrivateProfileStringW(L"Capture", L"isolated_device",
+                                   isolated_capture_device ? L"1" : L"0", ini.c_str());
+        WritePrivateProfileStringW(L"Capture", L"match_display_adapter",
+                                   match_display_adapter ? L"1" : L"0", ini.c_str());
+        WritePrivateProfileStringW(L"Capture", L"split_encode_adapter",
+                                   split_encode_adapter ? L"1" : L"0", ini.c_str());
+        WritePrivateProfileStringW(L"Capture", L"pipeline_boost", pipeline_boost ? L"1" : L"0", ini.c_str());
+        WritePrivateProfileStringW(L"Capture", L"cursor_overlay", cursor_overlay ? L"1" : L"0", ini.c_str());
+        WritePrivateProfileStringW(L"Capture", L"all_monitors", all_monitors ? L"1" : L"0", ini.c_str());
+        _snwprintf_s(buf, _countof(buf), _TRUNCATE, L"%u", hw_encoder_sessions);
+        WritePrivateProfileStringW(L"Capture", L"hw_encoder_sessions", buf, ini.c_str());
+        WritePrivateProfileStringW(L"Capture", L"hdr_tonemap", hdr_tonemap ? L"1" : L"0", ini.c_str());
+        WritePrivateProfileStringW(L"Capture", L"frame_tap", frame_tap ? L"1" : L"0", ini.c_str());
+        WritePrivateProfileStringW(L"Capture", L"nv12_converter", nv12_converter.c_str(), ini.c_str());
+        WritePrivateProfileStringW(L"Capture", L"nv12_filter", nv12_filter.c_str(), ini.c_str());
 
         SR_LOG_INFO(L"Settings saved: fps=%u, high_quality=%s, output_dir=%s, camera_overlay=%s",
                     fps,
@@ -104,6 +418,20 @@ struct AppSettings {
         return path;
     }
 
+    // Hardware-encoder probe cache next to settings.ini
+    static std::wstring probe_cache_path() {
+        std::wstring ini = ini_path();
+        if (ini.empty()) return {};
+        return std::filesystem::path(ini).replace_filename(L"probe_cache.ini").wstring();
+    }
+
+    // Session log written by sr::Logger, next to settings.ini
+    static std::wstring log_path() {
+        std::wstring ini = ini_path();
+        if (ini.empty()) return {};
+        return std::filesystem::path(ini).replace_filename(L"screenrecorder.log").wstring();
+    }
+
     // Compute bitrate based on fps and high-quality flag.
     // Defaults target the fixed 848x480 laptop profile; HQ remains opt-in.
     static uint32_t compute_bitrate(uint32_t fps, bool hq) {
@@ -113,6 +441,24 @@ struct AppSettings {
         return (fps == 60) ? 6'000'000 : 4'000'000;
     }
 
+    // INI key <-> CodecPreference; unknown values keep the H.264 default
+    static CodecPreference parse_codec(const wchar_t* key) {
+        if (_wcsicmp(key, L"hevc") == 0) return CodecPreference::HEVC;
+        if (_wcsicmp(key, L"av1")  == 0) return CodecPreference::AV1;
+        if (_wcsicmp(key, L"auto") == 0) return CodecPreference::Auto;
+        return CodecPreference::H264;
+    }
+
+    static const wchar_t* codec_key(CodecPreference pref) {
+        switch (pref) {
+            case CodecPreference::HEVC: return L"hevc";
+            case CodecPreference::AV1:  return L"av1";
+            case CodecPreference::Auto: return L"auto";
+            case CodecPreference::H264: break;
+        }
+        return L"h264";
+    }
+
     void set_high_quality(bool enabled) {
         high_quality = enabled;
         bitrate_bps = compute_bitrate(fps, high_quality);
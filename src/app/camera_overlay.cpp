@@ -6,6 +6,7 @@
 #include <mfidl.h>
 #include <mfobjects.h>
 #include <mfreadwrite.h>
+#include <d3d11_1.h>    // ID3D10Multithread
 #include <mferror.h>
 #include <shellapi.h>
 #include <wrl/client.h>
@@ -13,6 +14,11 @@
 #include <cmath>
 #include <cstdlib>
 #include <cstring>
+#include <mutex>
+
+#ifndef WDA_EXCLUDEFROMCAPTURE
+#define WDA_EXCLUDEFROMCAPTURE 0x00000011   // Windows 10 2004 SDK
+#endif
 
 namespace sr {
 
@@ -21,6 +27,7 @@ using Microsoft::WRL::ComPtr;
 namespace {
 
 constexpr int kOverlayHeaderHeight = 36;
+constexpr UINT kMsgPresentFrame = WM_APP + 1;   // a new camera frame is in frames_
 
 struct CameraFormatChoice {
     ComPtr<IMFMediaType> native_type;
@@ -139,6 +146,36 @@ bool choose_camera_format(IMFSourceReader* reader,
     return true;
 }
 
+// Video-capable device behind an IMFDXGIDeviceManager for the source reader:
+// the MJPEG decoder MFT and the RGB32 conversion then run on the GPU instead
+// of the MF software pipeline. False -> CPU video processing.
+bool create_camera_device_manager(ComPtr<ID3D11Device>& device,
+                                  ComPtr<IMFDXGIDeviceManager>& manager) {
+    HRESULT hr = D3D11CreateDevice(nullptr, D3D_DRIVER_TYPE_HARDWARE, nullptr,
+                                   D3D11_CREATE_DEVICE_BGRA_SUPPORT | D3D11_CREATE_DEVICE_VIDEO_SUPPORT,
+                                   nullptr, 0, D3D11_SDK_VERSION, &device, nullptr, nullptr);
+    if (FAILED(hr)) {
+        SR_LOG_WARN(L"CameraOverlay: no video-capable D3D11 device (0x%08X) — CPU camera decode", hr);
+        return false;
+    }
+    // The reader's MFTs and the work-queue threads share the device
+    ComPtr<ID3D10Multithread> mt;
+    if (SUCCEEDED(device.As(&mt))) {
+        mt->SetMultithreadProtected(TRUE);
+    }
+
+    UINT reset_token = 0;
+    hr = MFCreateDXGIDeviceManager(&reset_token, &manager);
+    if (SUCCEEDED(hr)) hr = manager->ResetDevice(device.Get(), reset_token);
+    if (FAILED(hr)) {
+        SR_LOG_WARN(L"CameraOverlay: DXGI device manager failed (0x%08X) — CPU camera decode", hr);
+        manager.Reset();
+        device.Reset();
+        return false;
+    }
+    return true;
+}
+
 void draw_overlay_close_button_rect(HDC hdc, const RECT& close_rc) {
     HBRUSH fill = CreateSolidBrush(ui::kAccentPressed);
     HPEN border = CreatePen(PS_SOLID, 1, ui::kAccentBorder);
@@ -264,7 +301,16 @@ LRESULT CALLBACK CameraOverlay::HostWndProc(HWND hwnd, UINT msg, WPARAM wp, LPAR
         return 0;
     }
     case WM_SIZE:
-        if (self) self->resize_capture_to_client();
+        if (self) {
+            self->resize_capture_to_client();
+            self->present_latest_frame();
+        }
+        return 0;
+    case kMsgPresentFrame:
+        if (self) {
+            self->present_pending_.store(false, std::memory_order_release);
+            self->present_latest_frame();
+        }
         return 0;
     case WM_PAINT: {
         PAINTSTRUCT ps{};
@@ -328,18 +374,49 @@ void CameraOverlay::apply_preview_tuning() {
                 interval > 0 ? static_cast<unsigned>(1000 / interval) : 0u);
 }
 
+RECT CameraOverlay::content_rect() const {
+    RECT rc{};
+    if (host_hwnd_) GetClientRect(host_hwnd_, &rc);
+    rc.top = (std::min)(rc.top + kOverlayHeaderHeight, rc.bottom);
+    return rc;
+}
+
+void CameraOverlay::present_latest_frame() {
+    if (!gpu_preview_.load(std::memory_order_relaxed)) return;
+    frames_.update();
+    const CameraFrame& frame = frames_.front();
+    const RECT content = content_rect();
+    if (frame.pixels.empty() || frame.width == 0 || frame.height == 0 ||
+        content.right <= content.left || content.bottom <= content.top) {
+        if (presenter_.showing()) {
+            presenter_.hide();
+            InvalidateRect(host_hwnd_, nullptr, FALSE);   // GDI placeholder
+        }
+        return;
+    }
+
+    const bool was_showing = presenter_.showing();
+    const RECT crop = preview_source_crop(frame.width, frame.height,
+                                          content.right - content.left, content.bottom - content.top);
+    if (!presenter_.present(frame.pixels.data(), frame.width, frame.height, content, crop)) {
+        SR_LOG_WARN(L"CameraOverlay: GPU preview failed — falling back to GDI");
+        presenter_.release();
+        gpu_preview_.store(false, std::memory_order_relaxed);
+        InvalidateRect(host_hwnd_, nullptr, FALSE);
+        return;
+    }
+    // Placeholder -> live: repaint the chrome without the placeholder text
+    if (!was_showing) InvalidateRect(host_hwnd_, nullptr, FALSE);
+}
+
 void CameraOverlay::draw_latest_frame(HDC hdc, const RECT& rc) {
-    HBRUSH bg = CreateSolidBrush(ui::kOverlayChrome);
-    FillRect(hdc, &rc, bg);
-    DeleteObject(bg);
+    FillRect(hdc, &rc, chrome_brush_);
 
     RECT header_rc{rc.left, rc.top, rc.right, rc.top + kOverlayHeaderHeight};
     if (header_rc.bottom > rc.bottom) {
         header_rc.bottom = rc.bottom;
     }
-    HBRUSH header_bg = CreateSolidBrush(ui::kHeaderBackground);
-    FillRect(hdc, &header_rc, header_bg);
-    DeleteObject(header_bg);
+    FillRect(hdc, &header_rc, header_brush_);
     draw_overlay_close_button(hdc, rc);
 
     RECT content_rc = rc;
@@ -347,9 +424,16 @@ void CameraOverlay::draw_latest_frame(HDC hdc, const RECT& rc) {
     if (content_rc.bottom <= content_rc.top) {
         return;
     }
+    // The swap chain's visual covers the content area
+    if (presenter_.showing()) {
+        return;
+    }
 
-    std::lock_guard<std::mutex> lock(frame_mutex_);
-    if (latest_frame_.empty() || frame_width_ == 0 || frame_height_ == 0) {
+    frames_.update();
+    const CameraFrame& frame = frames_.front();
+    const UINT32 frame_width  = frame.width;
+    const UINT32 frame_height = frame.height;
+    if (frame.pixels.empty() || frame_width == 0 || frame_height == 0) {
         SetBkMode(hdc, TRANSPARENT);
         SetTextColor(hdc, ui::kTextMuted);
         RECT txt = content_rc;
@@ -368,56 +452,40 @@ void CameraOverlay::draw_latest_frame(HDC hdc, const RECT& rc) {
 
     BITMAPINFO bmi{};
     bmi.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
-    bmi.bmiHeader.biWidth = static_cast<LONG>(frame_width_);
-    bmi.bmiHeader.biHeight = -static_cast<LONG>(frame_height_); // top-down
+    bmi.bmiHeader.biWidth = static_cast<LONG>(frame_width);
+    bmi.bmiHeader.biHeight = -static_cast<LONG>(frame_height); // top-down
     bmi.bmiHeader.biPlanes = 1;
     bmi.bmiHeader.biBitCount = 32;
     bmi.bmiHeader.biCompression = BI_RGB;
 
     const int dst_w = content_rc.right - content_rc.left;
     const int dst_h = content_rc.bottom - content_rc.top;
-    const double src_ar = frame_height_ ? (static_cast<double>(frame_width_) / static_cast<double>(frame_height_)) : 1.0;
-    const double dst_ar = dst_h > 0 ? (static_cast<double>(dst_w) / static_cast<double>(dst_h)) : src_ar;
-
-    int src_x = 0;
-    int src_y = 0;
-    int src_w = static_cast<int>(frame_width_);
-    int src_h = static_cast<int>(frame_height_);
-    if (src_ar > dst_ar) {
-        src_w = static_cast<int>(static_cast<double>(frame_height_) * dst_ar);
-        if (src_w < 1) src_w = 1;
-        src_x = (static_cast<int>(frame_width_) - src_w) / 2;
-    } else if (src_ar < dst_ar) {
-        src_h = static_cast<int>(static_cast<double>(frame_width_) / dst_ar);
-        if (src_h < 1) src_h = 1;
-        src_y = (static_cast<int>(frame_height_) - src_h) / 2;
-    }
+    const RECT crop = preview_source_crop(frame_width, frame_height, dst_w, dst_h);
 
     // COLORONCOLOR keeps motion edges crisper in the small PiP window than HALFTONE.
     SetStretchBltMode(hdc, COLORONCOLOR);
     StretchDIBits(
         hdc,
         content_rc.right, content_rc.top, -dst_w, dst_h,
-        src_x, src_y, src_w, src_h,
-        latest_frame_.data(),
+        crop.left, crop.top, crop.right - crop.left, crop.bottom - crop.top,
+        frame.pixels.data(),
         &bmi,
         DIB_RGB_COLORS,
         SRCCOPY);
 
-    HPEN frame_pen = CreatePen(PS_SOLID, 1, ui::kBorderStrong);
-    HGDIOBJ old_pen = SelectObject(hdc, frame_pen);
+    HGDIOBJ old_pen = SelectObject(hdc, border_pen_);
     HGDIOBJ old_brush = SelectObject(hdc, GetStockObject(HOLLOW_BRUSH));
     Rectangle(hdc, rc.left, rc.top, rc.right, rc.bottom);
     SelectObject(hdc, old_brush);
     SelectObject(hdc, old_pen);
-    DeleteObject(frame_pen);
 
     draw_overlay_close_button(hdc, rc);
 }
 
 bool CameraOverlay::has_latest_frame() {
-    std::lock_guard<std::mutex> lock(frame_mutex_);
-    return !latest_frame_.empty() && frame_width_ > 0 && frame_height_ > 0;
+    frames_.update();
+    const CameraFrame& frame = frames_.front();
+    return !frame.pixels.empty() && frame.width > 0 && frame.height > 0;
 }
 
 void CameraOverlay::open_camera_privacy_settings() {
@@ -435,6 +503,62 @@ void CameraOverlay::open_camera_privacy_settings() {
     }
 }
 
+// IMFSourceReaderCallback forwarding completed reads to the overlay. MF keeps
+// a reference while a read is pending, so the callback is ref-counted and
+// detach() cuts it off from the owner before the reader is torn down.
+class CameraReadCallback : public IMFSourceReaderCallback {
+public:
+    explicit CameraReadCallback(CameraOverlay* owner)
+        : owner_(owner), flushed_(CreateEventW(nullptr, TRUE, FALSE, nullptr)) {}
+
+    void detach() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        owner_ = nullptr;
+    }
+    bool wait_flushed(DWORD timeout_ms) {
+        return flushed_ && WaitForSingleObject(flushed_, timeout_ms) == WAIT_OBJECT_0;
+    }
+
+    // IUnknown
+    ULONG STDMETHODCALLTYPE AddRef() override { return ++ref_; }
+    ULONG STDMETHODCALLTYPE Release() override {
+        const ULONG n = --ref_;
+        if (n == 0) delete this;
+        return n;
+    }
+    HRESULT STDMETHODCALLTYPE QueryInterface(REFIID riid, void** ppv) override {
+        if (!ppv) return E_POINTER;
+        if (riid == __uuidof(IUnknown) || riid == __uuidof(IMFSourceReaderCallback)) {
+            *ppv = static_cast<IMFSourceReaderCallback*>(this);
+            AddRef();
+            return S_OK;
+        }
+        *ppv = nullptr;
+        return E_NOINTERFACE;
+    }
+
+    // IMFSourceReaderCallback
+    HRESULT STDMETHODCALLTYPE OnReadSample(HRESULT hr, DWORD, DWORD flags, LONGLONG,
+                                           IMFSample* sample) override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (owner_) owner_->on_camera_sample(hr, flags, sample);
+        return S_OK;
+    }
+    HRESULT STDMETHODCALLTYPE OnFlush(DWORD) override {
+        if (flushed_) SetEvent(flushed_);
+        return S_OK;
+    }
+    HRESULT STDMETHODCALLTYPE OnEvent(DWORD, IMFMediaEvent*) override { return S_OK; }
+
+private:
+    ~CameraReadCallback() { if (flushed_) CloseHandle(flushed_); }
+
+    std::atomic<ULONG> ref_{ 1 };
+    std::mutex         mutex_;     // serializes detach() with a running callback
+    CameraOverlay*     owner_;
+    HANDLE             flushed_;
+};
+
 void CameraOverlay::capture_loop() {
     HRESULT hr = CoInitializeEx(nullptr, COINIT_MULTITHREADED);
     bool coinit_ok = SUCCEEDED(hr) || hr == RPC_E_CHANGED_MODE;
@@ -487,15 +611,46 @@ void CameraOverlay::capture_loop() {
         return;
     }
 
-    ComPtr<IMFAttributes> reader_attrs;
-    MFCreateAttributes(&reader_attrs, 1);
-    reader_attrs->SetUINT32(MF_SOURCE_READER_ENABLE_VIDEO_PROCESSING, TRUE);
-    reader_attrs->SetUINT32(MF_LOW_LATENCY, TRUE);
+    // Samples complete on an MF work-queue thread instead of blocking this one
+    ComPtr<CameraReadCallback> callback;
+    callback.Attach(new CameraReadCallback(this));
+
+    // MJPEG / YUY2 decode and conversion on the GPU when a device manager is
+    // available; samples then carry DXGI buffers and publish_sample reads
+    // them back once. Advanced and plain video processing are exclusive.
+    ComPtr<ID3D11Device> decode_device;
+    ComPtr<IMFDXGIDeviceManager> device_manager;
+    const bool gpu_decode = create_camera_device_manager(decode_device, device_manager);
 
     ComPtr<IMFSourceReader> reader;
-    hr = MFCreateSourceReaderFromMediaSource(source.Get(), reader_attrs.Get(), &reader);
+    bool gpu_reader = false;
+    for (int attempt = gpu_decode ? 0 : 1; attempt < 2 && !reader; ++attempt) {
+        ComPtr<IMFAttributes> reader_attrs;
+        MFCreateAttributes(&reader_attrs, 4);
+        if (attempt == 0) {
+            reader_attrs->SetUnknown(MF_SOURCE_READER_D3D_MANAGER, device_manager.Get());
+            reader_attrs->SetUINT32(MF_SOURCE_READER_ENABLE_ADVANCED_VIDEO_PROCESSING, TRUE);
+        } else {
+            reader_attrs->SetUINT32(MF_SOURCE_READER_ENABLE_VIDEO_PROCESSING, TRUE);
+        }
+        reader_attrs->SetUINT32(MF_LOW_LATENCY, TRUE);
+        reader_attrs->SetUnknown(MF_SOURCE_READER_ASYNC_CALLBACK, callback.Get());
+
+        hr = MFCreateSourceReaderFromMediaSource(source.Get(), reader_attrs.Get(), &reader);
+        if (attempt == 0) {
+            gpu_reader = SUCCEEDED(hr) && reader;
+            if (!gpu_reader) {
+                SR_LOG_WARN(L"CameraOverlay: GPU source reader failed (0x%08X) — CPU camera decode", hr);
+                reader.Reset();
+                device_manager.Reset();
+                decode_device.Reset();
+            }
+        }
+    }
     if (FAILED(hr) || !reader) {
         SR_LOG_ERROR(L"CameraOverlay: MFCreateSourceReaderFromMediaSource failed: 0x%08X", hr);
+        callback->detach();
+        source->Shutdown();
         MFShutdown();
         if (coinit_ok) CoUninitialize();
         return;
@@ -518,9 +673,9 @@ void CameraOverlay::capture_loop() {
         }
     } else {
         const double chosen_fps = static_cast<double>(chosen_fps_num) / static_cast<double>(chosen_fps_den ? chosen_fps_den : 1);
-        SR_LOG_INFO(L"CameraOverlay: %s preview format %ux%u @ %.2f fps (RGB32)",
+        SR_LOG_INFO(L"CameraOverlay: %s preview format %ux%u @ %.2f fps (RGB32, %s decode)",
                     use_high_quality_preview(on_battery_, high_quality) ? L"HQ" : L"efficiency",
-                    chosen_w, chosen_h, chosen_fps);
+                    chosen_w, chosen_h, chosen_fps, gpu_reader ? L"GPU" : L"CPU");
     }
 
     // Query the actual output type to get correct dimensions and stride
@@ -542,140 +697,179 @@ void CameraOverlay::capture_loop() {
         }
     }
 
-    if (chosen_w > 0 && chosen_h > 0) {
-        frame_width_ = chosen_w;
-        frame_height_ = chosen_h;
-    }
+    stream_width_  = chosen_w;
+    stream_height_ = chosen_h;
     // If stride unknown, default to width * 4 (RGB32 top-down)
     if (default_stride == 0 && chosen_w > 0) {
         default_stride = static_cast<LONG>(chosen_w) * 4;
     }
+    default_stride_    = default_stride;
+    last_processed_ms_ = 0;
+    read_failures_     = 0;
+    retry_backoff_ms_.store(0, std::memory_order_relaxed);
 
-    capture_running_.store(true, std::memory_order_release);
-    ULONGLONG last_processed_ms = 0;
-    UINT32 consecutive_read_failures = 0;
-    std::vector<uint8_t> tight_rgba;
+    // From here on samples arrive in on_camera_sample. This thread only
+    // reissues reads after a failure backoff and waits for stop.
+    reader_ = reader.Get();
+    request_sample();
     while (capture_running_.load(std::memory_order_acquire)) {
-        DWORD stream_index = 0, flags = 0;
-        LONGLONG ts = 0;
-        ComPtr<IMFSample> sample;
-        hr = reader->ReadSample(static_cast<DWORD>(MF_SOURCE_READER_FIRST_VIDEO_STREAM), 0,
-                                &stream_index, &flags, &ts, &sample);
-        if (FAILED(hr)) {
-            ++consecutive_read_failures;
-            if (consecutive_read_failures == 1 ||
-                should_stop_after_read_failures(consecutive_read_failures) ||
-                consecutive_read_failures % 10u == 0u) {
-                SR_LOG_WARN(L"CameraOverlay: ReadSample failed: 0x%08X (consecutive=%u)",
-                            hr, consecutive_read_failures);
-            }
-            if (should_stop_after_read_failures(consecutive_read_failures)) {
-                SR_LOG_ERROR(L"CameraOverlay: stopping camera capture after repeated ReadSample failures");
-                capture_running_.store(false, std::memory_order_release);
-                if (host_hwnd_) {
-                    PostMessageW(host_hwnd_, WM_CLOSE, 0, 0);
+        WaitForSingleObject(wake_event_, INFINITE);
+        const UINT32 backoff = retry_backoff_ms_.exchange(0, std::memory_order_acq_rel);
+        if (backoff == 0 || !capture_running_.load(std::memory_order_acquire)) continue;
+        // No read is outstanding during the backoff, so only stop signals the event
+        WaitForSingleObject(wake_event_, backoff);
+        if (capture_running_.load(std::memory_order_acquire)) request_sample();
+    }
+
+    // No owner calls after detach; Flush completes a pending read (OnFlush)
+    callback->detach();
+    if (SUCCEEDED(reader->Flush(static_cast<DWORD>(MF_SOURCE_READER_FIRST_VIDEO_STREAM)))) {
+        callback->wait_flushed(1000);
+    }
+    reader_ = nullptr;
+    reader.Reset();
+    device_manager.Reset();
+    decode_device.Reset();
+    source->Shutdown();
+    MFShutdown();
+    if (coinit_ok) CoUninitialize();
+}
+
+void CameraOverlay::request_sample() {
+    const HRESULT hr = reader_->ReadSample(static_cast<DWORD>(MF_SOURCE_READER_FIRST_VIDEO_STREAM), 0,
+                                           nullptr, nullptr, nullptr, nullptr);
+    if (FAILED(hr)) schedule_retry(hr);
+}
+
+// Count a failed read and hand the retry to the camera thread, or give up
+void CameraOverlay::schedule_retry(HRESULT hr) {
+    ++read_failures_;
+    if (read_failures_ == 1 ||
+        should_stop_after_read_failures(read_failures_) ||
+        read_failures_ % 10u == 0u) {
+        SR_LOG_WARN(L"CameraOverlay: ReadSample failed: 0x%08X (consecutive=%u)", hr, read_failures_);
+    }
+    if (should_stop_after_read_failures(read_failures_)) {
+        SR_LOG_ERROR(L"CameraOverlay: stopping camera capture after repeated ReadSample failures");
+        capture_running_.store(false, std::memory_order_release);
+        if (host_hwnd_) {
+            PostMessageW(host_hwnd_, WM_CLOSE, 0, 0);
+        }
+    } else {
+        retry_backoff_ms_.store((std::max)(read_failure_backoff_ms(read_failures_), 1u),
+                                std::memory_order_release);
+    }
+    SetEvent(wake_event_);
+}
+
+void CameraOverlay::on_camera_sample(HRESULT hr, DWORD flags, IMFSample* sample) {
+    if (!capture_running_.load(std::memory_order_acquire)) return;
+    if (FAILED(hr)) {
+        schedule_retry(hr);
+        return;
+    }
+    read_failures_ = 0;
+
+    if (sample && !(flags & MF_SOURCE_READERF_STREAMTICK)) {
+        const int present_interval_ms = capture_interval_ms_.load(std::memory_order_relaxed);
+        const ULONGLONG now_ms = GetTickCount64();
+        if (should_process_preview_frame(now_ms, last_processed_ms_, present_interval_ms) &&
+            publish_sample(sample)) {
+            if (host_hwnd_) {
+                if (!gpu_preview_.load(std::memory_order_relaxed)) {
+                    InvalidateRect(host_hwnd_, nullptr, FALSE);
+                } else if (!present_pending_.exchange(true, std::memory_order_acq_rel)) {
+                    PostMessageW(host_hwnd_, kMsgPresentFrame, 0, 0);
                 }
-                break;
             }
-            Sleep(read_failure_backoff_ms(consecutive_read_failures));
-            continue;
+            last_processed_ms_ = now_ms;
         }
-        consecutive_read_failures = 0;
+    }
+    request_sample();
+}
 
-        if (flags & MF_SOURCE_READERF_STREAMTICK) {
-            Sleep(1);
-            continue;
+// Copy the sample once, top-down and tightly packed, into the back frame
+bool CameraOverlay::publish_sample(IMFSample* sample) {
+    ComPtr<IMFMediaBuffer> buf;
+    if (FAILED(sample->ConvertToContiguousBuffer(&buf)) || !buf) return false;
+
+    UINT32 w = stream_width_;
+    UINT32 h = stream_height_;
+    if (w == 0 || h == 0) {
+        ComPtr<IMFMediaType> current_type;
+        if (SUCCEEDED(reader_->GetCurrentMediaType(static_cast<DWORD>(MF_SOURCE_READER_FIRST_VIDEO_STREAM), &current_type)) && current_type) {
+            MFGetAttributeSize(current_type.Get(), MF_MT_FRAME_SIZE, &w, &h);
         }
+        stream_width_  = w;
+        stream_height_ = h;
+    }
+    if (w == 0 || h == 0) {
+        return false;
+    }
 
-        if (sample) {
-            const int present_interval_ms = capture_interval_ms_.load(std::memory_order_relaxed);
-            const ULONGLONG now_ms = GetTickCount64();
-            if (!should_process_preview_frame(now_ms, last_processed_ms, present_interval_ms)) {
-                continue;
+    CameraFrame& frame = frames_.back();
+    const size_t row_bytes = static_cast<size_t>(w) * 4;
+    const size_t tight_size = row_bytes * static_cast<size_t>(h);
+    bool copied = false;
+
+    // Try IMF2DBuffer first — this gives us the real stride and
+    // avoids conflicting with a 1D Lock(). On a GPU-decoded (DXGI) buffer a
+    // read-only Lock2DSize skips the upload Lock2D would do on unlock.
+    ComPtr<IMF2DBuffer> buf2d;
+    if (SUCCEEDED(buf.As(&buf2d)) && buf2d) {
+        BYTE* scan0 = nullptr;
+        LONG stride = 0;
+        HRESULT lock_hr = E_FAIL;
+        ComPtr<IMF2DBuffer2> buf2d2;
+        if (SUCCEEDED(buf2d.As(&buf2d2)) && buf2d2) {
+            BYTE* start = nullptr;
+            DWORD length = 0;
+            lock_hr = buf2d2->Lock2DSize(MF2DBuffer_LockFlags_Read, &scan0, &stride, &start, &length);
+        }
+        if (FAILED(lock_hr)) lock_hr = buf2d->Lock2D(&scan0, &stride);
+        if (SUCCEEDED(lock_hr) && scan0 && tight_size > 0) {
+            frame.pixels.resize(tight_size);
+            // Lock2D contract: scan0 = pointer to first scanline (top row).
+            // stride may be negative for bottom-up DIBs — use it directly,
+            // as scan0 + row*stride correctly walks through the image.
+            for (UINT32 row = 0; row < h; ++row) {
+                const BYTE* src_row = scan0 + static_cast<ptrdiff_t>(row) * static_cast<ptrdiff_t>(stride);
+                std::memcpy(frame.pixels.data() + static_cast<size_t>(row) * row_bytes, src_row, row_bytes);
             }
+            buf2d->Unlock2D();
+            copied = true;
+        }
+    }
 
-            ComPtr<IMFMediaBuffer> buf;
-            if (SUCCEEDED(sample->ConvertToContiguousBuffer(&buf)) && buf) {
-                UINT32 w = frame_width_;
-                UINT32 h = frame_height_;
-                if (w == 0 || h == 0) {
-                    ComPtr<IMFMediaType> current_type;
-                    if (SUCCEEDED(reader->GetCurrentMediaType(static_cast<DWORD>(MF_SOURCE_READER_FIRST_VIDEO_STREAM), &current_type)) && current_type) {
-                        MFGetAttributeSize(current_type.Get(), MF_MT_FRAME_SIZE, &w, &h);
-                    }
-                }
-
-                if (w == 0 || h == 0) {
-                    continue;
-                }
-
-                const size_t row_bytes = static_cast<size_t>(w) * 4;
-                const size_t tight_size = row_bytes * static_cast<size_t>(h);
-                bool copied = false;
-
-                // Try IMF2DBuffer first — this gives us the real stride and
-                // avoids conflicting with a 1D Lock().
-                ComPtr<IMF2DBuffer> buf2d;
-                if (SUCCEEDED(buf.As(&buf2d)) && buf2d) {
-                    BYTE* scan0 = nullptr;
-                    LONG stride = 0;
-                    if (SUCCEEDED(buf2d->Lock2D(&scan0, &stride)) && scan0 && tight_size > 0) {
-                        tight_rgba.resize(tight_size);
-                        // Lock2D contract: scan0 = pointer to first scanline (top row).
-                        // stride may be negative for bottom-up DIBs — use it directly,
-                        // as scan0 + row*stride correctly walks through the image.
-                        for (UINT32 row = 0; row < h; ++row) {
-                            const BYTE* src_row = scan0 + static_cast<ptrdiff_t>(row) * static_cast<ptrdiff_t>(stride);
-                            std::memcpy(tight_rgba.data() + static_cast<size_t>(row) * row_bytes, src_row, row_bytes);
-                        }
-                        buf2d->Unlock2D();
-                        copied = true;
-                    }
-                }
-
-                // Fallback: 1D Lock — use MF_MT_DEFAULT_STRIDE for row pitch.
-                if (!copied) {
-                    BYTE* data = nullptr;
-                    DWORD max_len = 0, cur_len = 0;
-                    if (SUCCEEDED(buf->Lock(&data, &max_len, &cur_len)) && data && cur_len > 0) {
-                        const LONG stride = (default_stride != 0) ? default_stride : static_cast<LONG>(row_bytes);
-                        const LONG abs_stride = stride < 0 ? -stride : stride;
-                        // For bottom-up (negative stride), the first byte in 'data'
-                        // is the bottom row. We need to read rows in reverse.
-                        const bool bottom_up = stride < 0;
-
-                        tight_rgba.resize(tight_size);
-                        for (UINT32 row = 0; row < h; ++row) {
-                            const UINT32 src_row_idx = bottom_up ? (h - 1 - row) : row;
-                            const BYTE* src_row = data + static_cast<size_t>(src_row_idx) * static_cast<size_t>(abs_stride);
-                            if (static_cast<DWORD>(src_row - data + row_bytes) > cur_len) break;
-                            std::memcpy(tight_rgba.data() + static_cast<size_t>(row) * row_bytes, src_row, row_bytes);
-                        }
-                        buf->Unlock();
-                        copied = true;
-                    }
-                }
-
-                if (copied) {
-                    {
-                        std::lock_guard<std::mutex> lock(frame_mutex_);
-                        latest_frame_.swap(tight_rgba);
-                        frame_width_ = w;
-                        frame_height_ = h;
-                    }
-
-                    if (host_hwnd_) {
-                        InvalidateRect(host_hwnd_, nullptr, FALSE);
-                    }
-                    last_processed_ms = now_ms;
-                }
+    // Fallback: 1D Lock — use MF_MT_DEFAULT_STRIDE for row pitch.
+    if (!copied) {
+        BYTE* data = nullptr;
+        DWORD max_len = 0, cur_len = 0;
+        if (SUCCEEDED(buf->Lock(&data, &max_len, &cur_len)) && data && cur_len > 0) {
+            const LONG stride = (default_stride_ != 0) ? default_stride_ : static_cast<LONG>(row_bytes);
+            const LONG abs_stride = stride < 0 ? -stride : stride;
+            // For bottom-up (negative stride), the first byte in 'data'
+            // is the bottom row. We need to read rows in reverse.
+            const bool bottom_up = stride < 0;
+
+            frame.pixels.resize(tight_size);
+            for (UINT32 row = 0; row < h; ++row) {
+                const UINT32 src_row_idx = bottom_up ? (h - 1 - row) : row;
+                const BYTE* src_row = data + static_cast<size_t>(src_row_idx) * static_cast<size_t>(abs_stride);
+                if (static_cast<DWORD>(src_row - data + row_bytes) > cur_len) break;
+                std::memcpy(frame.pixels.data() + static_cast<size_t>(row) * row_bytes, src_row, row_bytes);
             }
+            buf->Unlock();
+            copied = true;
         }
     }
+    if (!copied) return false;
 
-    source->Shutdown();
-    MFShutdown();
-    if (coinit_ok) CoUninitialize();
+    frame.width  = w;
+    frame.height = h;
+    if (frame_sink_) frame_sink_(frame.pixels.data(), w, h);
+    frames_.publish();
+    return true;
 }
 
 bool CameraOverlay::start(HWND owner) {
@@ -732,8 +926,15 @@ bool CameraOverlay::start(HWND owner) {
             SR_LOG_ERROR(L"CameraOverlay: host window create failed: %u", GetLastError());
             return false;
         }
-
+        if (capture_excluded_) set_capture_excluded(true);
+    }
+    if (!chrome_brush_) chrome_brush_ = CreateSolidBrush(ui::kOverlayChrome);
+    if (!header_brush_) header_brush_ = CreateSolidBrush(ui::kHeaderBackground);
+    if (!border_pen_)   border_pen_   = CreatePen(PS_SOLID, 1, ui::kBorderStrong);
+    if (!presenter_.ready()) {
+        gpu_preview_.store(presenter_.initialize(host_hwnd_), std::memory_order_relaxed);
     }
+    present_pending_.store(false, std::memory_order_relaxed);
 
     SetWindowPos(host_hwnd_, HWND_TOPMOST, x, y, host_w, host_h,
                  SWP_SHOWWINDOW | SWP_NOACTIVATE);
@@ -742,6 +943,9 @@ bool CameraOverlay::start(HWND owner) {
     on_battery_ = detect_on_battery();
     preview_tuning_applied_ = false;
     apply_preview_tuning();
+    if (!wake_event_) wake_event_ = CreateEventW(nullptr, FALSE, FALSE, nullptr);
+    // Set before the thread exists so an early stop() can't be overwritten
+    capture_running_.store(true, std::memory_order_release);
     capture_thread_ = std::thread(&CameraOverlay::capture_loop, this);
 
     running_ = true;
@@ -756,6 +960,15 @@ void CameraOverlay::set_high_quality(bool enabled) {
     }
 }
 
+void CameraOverlay::set_capture_excluded(bool excluded) {
+    capture_excluded_ = excluded;
+    if (!host_hwnd_) return;
+    // WDA_EXCLUDEFROMCAPTURE needs Windows 10 2004; older builds keep the window visible
+    if (!SetWindowDisplayAffinity(host_hwnd_, excluded ? WDA_EXCLUDEFROMCAPTURE : WDA_NONE)) {
+        SR_LOG_WARN(L"CameraOverlay: SetWindowDisplayAffinity failed: %u", GetLastError());
+    }
+}
+
 void CameraOverlay::refresh_power_profile() {
     if (!running_) return;
     on_battery_ = detect_on_battery();
@@ -764,6 +977,7 @@ void CameraOverlay::refresh_power_profile() {
 
 void CameraOverlay::stop_capture_thread() {
     capture_running_.store(false, std::memory_order_release);
+    if (wake_event_) SetEvent(wake_event_);
     if (capture_thread_.joinable()) {
         capture_thread_.join();
     }
@@ -772,16 +986,26 @@ void CameraOverlay::stop_capture_thread() {
 void CameraOverlay::stop() {
     stop_capture_thread();
 
+    presenter_.release();
+    gpu_preview_.store(false, std::memory_order_relaxed);
     if (host_hwnd_) {
         DestroyWindow(host_hwnd_);
         host_hwnd_ = nullptr;
     }
 
-    {
-        std::lock_guard<std::mutex> lock(frame_mutex_);
-        latest_frame_.clear();
-        frame_width_ = 0;
-        frame_height_ = 0;
+    // Neither the callback nor the UI touches the frames now
+    frames_.reset();
+    if (wake_event_) {
+        CloseHandle(wake_event_);
+        wake_event_ = nullptr;
+    }
+    for (HGDIOBJ* obj : { reinterpret_cast<HGDIOBJ*>(&chrome_brush_),
+                          reinterpret_cast<HGDIOBJ*>(&header_brush_),
+                          reinterpret_cast<HGDIOBJ*>(&border_pen_) }) {
+        if (*obj) {
+            DeleteObject(*obj);
+            *obj = nullptr;
+        }
     }
 
     if (running_) {
@@ -1,13 +1,30 @@
 #pragma once
+// camera_overlay.h — Camera preview window fed by an asynchronous MF source reader
+//
+// The camera thread opens the device and keeps one ReadSample outstanding
+// (MF_SOURCE_READER_ASYNC_CALLBACK); samples are copied once on the MF
+// callback thread into a TripleBuffer the UI paints from without a lock.
+// The thread itself only wakes to retry after read failures or to shut down.
+// With a DXGI device manager the reader decodes MJPEG and converts to RGB32
+// on the GPU (advanced video processing); otherwise MF does it on the CPU.
+// The UI presents frames through CameraPresenter (GPU swap chain) and falls
+// back to GDI StretchDIBits on WM_PAINT when that is unavailable.
 
 #include <windows.h>
 #include <atomic>
+#include <functional>
 #include <thread>
-#include <mutex>
 #include <vector>
+#include "app/camera_presenter.h"
+#include "utils/triple_buffer.h"
+
+struct IMFSample;
+struct IMFSourceReader;
 
 namespace sr {
 
+class CameraReadCallback;
+
 class CameraOverlay {
 public:
     CameraOverlay() = default;
@@ -18,6 +35,14 @@ public:
     void refresh_power_profile();
     void set_high_quality(bool enabled);
 
+    // Receives each processed camera frame (top-down BGRX) on the camera
+    // thread, e.g. for compositing into the recording — set before start()
+    using FrameSink = std::function<void(const uint8_t* bgrx, UINT32 width, UINT32 height)>;
+    void set_frame_sink(FrameSink sink) { frame_sink_ = std::move(sink); }
+    // Keep the preview window out of screen capture (when the camera is
+    // composited into the recording instead)
+    void set_capture_excluded(bool excluded);
+
     bool is_running() const { return running_; }
 
     static constexpr UINT32 kEfficiencyPreviewMaxWidth = 640;
@@ -85,6 +110,27 @@ public:
                preview_preferred_height_for_profile(previous_on_battery, previous_high_quality) !=
                    preview_preferred_height_for_profile(current_on_battery, current_high_quality);
     }
+    // Part of a frame_w x frame_h image shown in a dst_w x dst_h area:
+    // centered, aspect-filling crop (the preview never letterboxes)
+    static RECT preview_source_crop(UINT32 frame_w, UINT32 frame_h, int dst_w, int dst_h) {
+        RECT crop{ 0, 0, static_cast<LONG>(frame_w), static_cast<LONG>(frame_h) };
+        if (frame_w == 0 || frame_h == 0 || dst_w <= 0 || dst_h <= 0) return crop;
+        const double src_ar = static_cast<double>(frame_w) / static_cast<double>(frame_h);
+        const double dst_ar = static_cast<double>(dst_w) / static_cast<double>(dst_h);
+        if (src_ar > dst_ar) {
+            LONG w = static_cast<LONG>(static_cast<double>(frame_h) * dst_ar);
+            if (w < 1) w = 1;
+            crop.left  = (static_cast<LONG>(frame_w) - w) / 2;
+            crop.right = crop.left + w;
+        } else if (src_ar < dst_ar) {
+            LONG h = static_cast<LONG>(static_cast<double>(frame_w) / dst_ar);
+            if (h < 1) h = 1;
+            crop.top    = (static_cast<LONG>(frame_h) - h) / 2;
+            crop.bottom = crop.top + h;
+        }
+        return crop;
+    }
+
     static constexpr UINT32 kMaxReadFailuresBeforeStop = 50;
     static UINT32 read_failure_backoff_ms(UINT32 consecutive_failures) {
         if (consecutive_failures == 0) return 0;
@@ -96,8 +142,24 @@ public:
     }
 
 private:
+    friend class CameraReadCallback;
+
+    struct CameraFrame {
+        std::vector<uint8_t> pixels;   // top-down BGRX
+        UINT32 width  = 0;
+        UINT32 height = 0;
+    };
+
     static LRESULT CALLBACK HostWndProc(HWND hwnd, UINT msg, WPARAM wp, LPARAM lp);
     void capture_loop();
+    // UI thread: put the newest frame on the GPU preview (or fall back to GDI)
+    void present_latest_frame();
+    RECT content_rect() const;
+    // MF callback thread: one completed ReadSample
+    void on_camera_sample(HRESULT hr, DWORD flags, IMFSample* sample);
+    void request_sample();
+    void schedule_retry(HRESULT hr);
+    bool publish_sample(IMFSample* sample);
     void draw_latest_frame(HDC hdc, const RECT& rc);
     bool has_latest_frame();
     void open_camera_privacy_settings();
@@ -115,10 +177,33 @@ private:
     std::atomic<int>  capture_interval_ms_{ 16 };
     std::atomic<bool> high_quality_{ false };
 
-    std::mutex frame_mutex_;
-    std::vector<uint8_t> latest_frame_;
-    UINT32 frame_width_  = 0;
-    UINT32 frame_height_ = 0;
+    FrameSink frame_sink_;
+    bool      capture_excluded_ = false;
+
+    // Reader state: camera thread during setup/teardown, MF callback thread
+    // while reading (one request outstanding, so callbacks never overlap)
+    IMFSourceReader*     reader_         = nullptr;
+    HANDLE               wake_event_     = nullptr;  // retry or stop
+    std::atomic<UINT32>  retry_backoff_ms_{ 0 };
+    UINT32               read_failures_  = 0;
+    UINT32               stream_width_   = 0;
+    UINT32               stream_height_  = 0;
+    LONG                 default_stride_ = 0;
+    ULONGLONG            last_processed_ms_ = 0;
+
+    // Callback thread publishes, UI thread paints the front frame
+    TripleBuffer<CameraFrame> frames_;
+
+    // GPU preview; present_pending_ coalesces frame notifications so a slow
+    // UI thread never builds a message backlog
+    CameraPresenter   presenter_;
+    std::atomic<bool> gpu_preview_{ false };
+    std::atomic<bool> present_pending_{ false };
+
+    // GDI objects for the chrome, created once per start()
+    HBRUSH chrome_brush_ = nullptr;
+    HBRUSH header_brush_ = nullptr;
+    HPEN   border_pen_   = nullptr;
 
     bool running_   = false;
     bool on_battery_ = false;
@@ -0,0 +1,154 @@
+#include "app/camera_presenter.h"
+#include "utils/logging.h"
+#include <algorithm>
+
+#pragma comment(lib, "dcomp.lib")
+
+namespace sr {
+
+using Microsoft::WRL::ComPtr;
+
+bool CameraPresenter::initialize(HWND host) {
+    release();
+    if (!host) return false;
+
+    // Own device: the preview never touches the recording's immediate context
+    D3D_FEATURE_LEVEL level{};
+    HRESULT hr = D3D11CreateDevice(nullptr, D3D_DRIVER_TYPE_HARDWARE, nullptr,
+                                   D3D11_CREATE_DEVICE_BGRA_SUPPORT, nullptr, 0,
+                                   D3D11_SDK_VERSION, &device_, &level, &context_);
+    if (FAILED(hr)) {
+        SR_LOG_WARN(L"CameraPresenter: D3D11CreateDevice failed: 0x%08X — GDI preview", hr);
+        release();
+        return false;
+    }
+
+    ComPtr<IDXGIDevice> dxgi_device;
+    ComPtr<IDXGIAdapter> adapter;
+    if (FAILED(device_.As(&dxgi_device)) || FAILED(dxgi_device->GetAdapter(&adapter)) ||
+        FAILED(adapter->GetParent(IID_PPV_ARGS(&factory_)))) {
+        SR_LOG_WARN(L"CameraPresenter: no IDXGIFactory2 — GDI preview");
+        release();
+        return false;
+    }
+
+    hr = DCompositionCreateDevice(dxgi_device.Get(), IID_PPV_ARGS(&dcomp_));
+    if (SUCCEEDED(hr)) hr = dcomp_->CreateTargetForHwnd(host, TRUE, &target_);
+    if (SUCCEEDED(hr)) hr = dcomp_->CreateVisual(&visual_);
+    if (SUCCEEDED(hr)) hr = target_->SetRoot(visual_.Get());
+    if (SUCCEEDED(hr)) hr = dcomp_->Commit();
+    if (FAILED(hr)) {
+        SR_LOG_WARN(L"CameraPresenter: DirectComposition setup failed: 0x%08X — GDI preview", hr);
+        release();
+        return false;
+    }
+    SR_LOG_INFO(L"CameraPresenter: GPU preview (flip-model composition swap chain)");
+    return true;
+}
+
+void CameraPresenter::release() {
+    if (visual_) visual_->SetContent(nullptr);
+    if (dcomp_) dcomp_->Commit();
+    visual_     = nullptr;
+    target_     = nullptr;
+    dcomp_      = nullptr;
+    swap_chain_ = nullptr;
+    factory_    = nullptr;
+    context_    = nullptr;
+    device_     = nullptr;
+    width_ = height_ = 0;
+    content_ = {};
+    crop_    = {};
+    showing_ = false;
+}
+
+bool CameraPresenter::ensure_swap_chain(UINT32 width, UINT32 height) {
+    if (swap_chain_ && width == width_ && height == height_) return true;
+
+    HRESULT hr = S_OK;
+    if (swap_chain_) {
+        hr = swap_chain_->ResizeBuffers(0, width, height, DXGI_FORMAT_UNKNOWN, 0);
+    } else {
+        DXGI_SWAP_CHAIN_DESC1 desc{};
+        desc.Width            = width;
+        desc.Height           = height;
+        desc.Format           = DXGI_FORMAT_B8G8R8A8_UNORM;
+        desc.SampleDesc.Count = 1;
+        desc.BufferUsage      = DXGI_USAGE_RENDER_TARGET_OUTPUT;
+        desc.BufferCount      = 2;
+        desc.Scaling          = DXGI_SCALING_STRETCH;
+        desc.SwapEffect       = DXGI_SWAP_EFFECT_FLIP_SEQUENTIAL;
+        desc.AlphaMode        = DXGI_ALPHA_MODE_IGNORE;
+        hr = factory_->CreateSwapChainForComposition(device_.Get(), &desc, nullptr, &swap_chain_);
+    }
+    if (FAILED(hr)) {
+        SR_LOG_WARN(L"CameraPresenter: swap chain %ux%u failed: 0x%08X", width, height, hr);
+        swap_chain_ = nullptr;
+        return false;
+    }
+    width_  = width;
+    height_ = height;
+    content_ = {};   // force a new transform for the new frame size
+    return true;
+}
+
+// Mirror and scale `crop` onto `content`; the clip (in frame pixels, before
+// the transform) trims the center-cropped overhang
+void CameraPresenter::update_layout(const RECT& content, const RECT& crop) {
+    if (EqualRect(&content, &content_) && EqualRect(&crop, &crop_)) return;
+    content_ = content;
+    crop_    = crop;
+
+    const float sx = static_cast<float>(content.right - content.left) /
+                     static_cast<float>((std::max)(crop.right - crop.left, 1L));
+    const float sy = static_cast<float>(content.bottom - content.top) /
+                     static_cast<float>((std::max)(crop.bottom - crop.top, 1L));
+    const D2D_MATRIX_3X2_F transform{
+        -sx, 0.0f,
+        0.0f, sy,
+        static_cast<float>(content.right) + static_cast<float>(crop.left) * sx,
+        static_cast<float>(content.top) - static_cast<float>(crop.top) * sy };
+    const D2D_RECT_F clip{ static_cast<float>(crop.left),  static_cast<float>(crop.top),
+                           static_cast<float>(crop.right), static_cast<float>(crop.bottom) };
+    visual_->SetTransform(transform);
+    visual_->SetClip(clip);
+    dcomp_->Commit();
+}
+
+bool CameraPresenter::present(const uint8_t* bgrx, UINT32 width, UINT32 height,
+                              const RECT& content, const RECT& crop) {
+    if (!ready() || !bgrx || width == 0 || height == 0) return false;
+    if (!ensure_swap_chain(width, height)) return false;
+
+    ComPtr<ID3D11Texture2D> back;
+    HRESULT hr = swap_chain_->GetBuffer(0, IID_PPV_ARGS(&back));
+    if (FAILED(hr)) {
+        SR_LOG_WARN(L"CameraPresenter: GetBuffer failed: 0x%08X", hr);
+        return false;
+    }
+    context_->UpdateSubresource(back.Get(), 0, nullptr, bgrx, width * 4, 0);
+
+    // Interval 0: the UI thread never waits for vblank; DWM picks up the
+    // latest buffer at its next composition
+    hr = swap_chain_->Present(0, 0);
+    if (FAILED(hr)) {
+        SR_LOG_WARN(L"CameraPresenter: Present failed: 0x%08X", hr);
+        return false;
+    }
+    if (!showing_) {
+        visual_->SetContent(swap_chain_.Get());
+        showing_ = true;
+        content_ = {};
+    }
+    update_layout(content, crop);
+    return true;
+}
+
+void CameraPresenter::hide() {
+    if (!showing_) return;
+    visual_->SetContent(nullptr);
+    dcomp_->Commit();
+    showing_ = false;
+}
+
+} // namespace sr
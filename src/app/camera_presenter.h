@@ -0,0 +1,58 @@
+#pragma once
+// camera_presenter.h — GPU present path for the camera preview window
+//
+// A flip-model composition swap chain shown through DirectComposition on the
+// overlay's host window. Each camera frame is uploaded once into the back
+// buffer and presented; DWM scales, mirrors and crops it through the visual's
+// transform and clip, so no CPU scaling happens at all. The host keeps
+// painting its header and close button with GDI (the visual only covers the
+// content rect) and falls back to StretchDIBits when initialize() fails.
+//
+// UI thread only.
+
+#include <windows.h>
+#include <d3d11.h>
+#include <dxgi1_2.h>
+#include <dcomp.h>
+#include <wrl/client.h>
+#include <cstdint>
+
+namespace sr {
+
+class CameraPresenter {
+public:
+    // Own D3D11 device + DirectComposition target on `host`; false -> GDI
+    bool initialize(HWND host);
+    void release();
+    bool ready() const { return visual_ != nullptr; }
+    // A frame is on screen (the GDI path should skip the image)
+    bool showing() const { return showing_; }
+
+    // Upload and present a top-down BGRX frame: `crop` of the frame (source
+    // pixels) fills `content` (host client coordinates), mirrored like a
+    // selfie view. False on any D3D / DXGI failure.
+    bool present(const uint8_t* bgrx, UINT32 width, UINT32 height,
+                 const RECT& content, const RECT& crop);
+    // Nothing to show: take the swap chain off the visual
+    void hide();
+
+private:
+    bool ensure_swap_chain(UINT32 width, UINT32 height);
+    void update_layout(const RECT& content, const RECT& crop);
+
+    Microsoft::WRL::ComPtr<ID3D11Device>        device_;
+    Microsoft::WRL::ComPtr<ID3D11DeviceContext> context_;
+    Microsoft::WRL::ComPtr<IDXGIFactory2>       factory_;
+    Microsoft::WRL::ComPtr<IDXGISwapChain1>     swap_chain_;
+    Microsoft::WRL::ComPtr<IDCompositionDevice> dcomp_;
+    Microsoft::WRL::ComPtr<IDCompositionTarget> target_;
+    Microsoft::WRL::ComPtr<IDCompositionVisual> visual_;
+
+    UINT32 width_   = 0;   // swap chain buffer size = camera frame size
+    UINT32 height_  = 0;
+    RECT   content_{};
+    RECT   crop_{};
+    bool   showing_ = false;
+};
+
+} // namespace sr
@@ -0,0 +1,120 @@
+#pragma once
+// headless_options.h — Command line of the headless recording mode
+//
+//   ScreenRecorder.exe --headless [--profile base|hq] [--duration <s>]
+//                      [--output <dir | file.mp4>] [--segment-minutes <n>]
+//                      [--segment-mb <n>] [--summary <file.json>]
+//
+// Everything not given comes from ScreenRecorder.ini, as in the UI. The
+// recording runs for --duration seconds (0 = until Ctrl+C / Ctrl+Break) and
+// the process exits with SessionDiagnostics::exit_code().
+
+#include <cstdint>
+#include <cwchar>
+#include <cwctype>
+#include <string>
+#include <vector>
+
+namespace sr {
+
+struct HeadlessOptions {
+    enum class Profile { Settings, Base, HighQuality };
+
+    Profile      profile         = Profile::Settings;
+    double       duration_s      = 0.0;   // 0 = until interrupted
+    std::wstring output_dir;              // empty = settings / default directory
+    std::wstring output_stem;             // file name without .mp4; empty = timestamped
+    bool         segments_given  = false;
+    uint32_t     segment_minutes = 0;
+    uint32_t     segment_mb      = 0;
+    std::wstring summary_path;            // also write the JSON summary here
+    std::wstring error;                   // parse failure, for the usage message
+};
+
+inline const wchar_t* headless_usage() {
+    return L"usage: ScreenRecorder.exe --headless [--profile base|hq] [--duration <seconds>]\n"
+           L"       [--output <dir | file.mp4>] [--segment-minutes <n>] [--segment-mb <n>]\n"
+           L"       [--summary <file.json>]\n";
+}
+
+namespace detail {
+
+inline bool parse_headless_uint(const std::wstring& text, uint32_t& out) {
+    if (text.empty() || !std::iswdigit(static_cast<wint_t>(text[0]))) return false;
+    wchar_t* end = nullptr;
+    const unsigned long value = std::wcstoul(text.c_str(), &end, 10);
+    if (*end != L'\0' || value > 0xFFFFFFFFul) return false;
+    out = static_cast<uint32_t>(value);
+    return true;
+}
+
+// `path` names a file when it ends in .mp4 (any case); anything else is a directory
+inline void split_headless_output(const std::wstring& path, std::wstring& dir, std::wstring& stem) {
+    std::wstring lower = path;
+    for (auto& c : lower) c = static_cast<wchar_t>(std::towlower(static_cast<wint_t>(c)));
+    if (lower.size() <= 4 || lower.compare(lower.size() - 4, 4, L".mp4") != 0) {
+        dir = path;
+        stem.clear();
+        return;
+    }
+    const size_t slash = path.find_last_of(L"\\/");
+    dir  = slash == std::wstring::npos ? std::wstring(L".") : path.substr(0, slash);
+    stem = path.substr(slash == std::wstring::npos ? 0 : slash + 1);
+    stem.resize(stem.size() - 4);
+    if (dir.empty()) dir = path.substr(0, 1);   // "\\name.mp4": the drive root
+}
+
+} // namespace detail
+
+// `args`: the arguments after --headless. False (with out.error) on an
+// unknown option or a bad value.
+inline bool parse_headless_options(const std::vector<std::wstring>& args, HeadlessOptions& out) {
+    out = HeadlessOptions{};
+    for (size_t i = 0; i < args.size(); ++i) {
+        const std::wstring& opt = args[i];
+        if (i + 1 >= args.size()) {
+            out.error = L"missing value for " + opt;
+            return false;
+        }
+        const std::wstring& value = args[++i];
+        if (opt == L"--profile") {
+            if (value == L"base") {
+                out.profile = HeadlessOptions::Profile::Base;
+            } else if (value == L"hq") {
+                out.profile = HeadlessOptions::Profile::HighQuality;
+            } else {
+                out.error = L"--profile must be base or hq";
+                return false;
+            }
+        } else if (opt == L"--duration") {
+            wchar_t* end = nullptr;
+            out.duration_s = std::wcstod(value.c_str(), &end);
+            if (value.empty() || *end != L'\0' || !(out.duration_s >= 0.0)) {
+                out.error = L"--duration must be a number of seconds";
+                return false;
+            }
+        } else if (opt == L"--output") {
+            if (value.empty()) {
+                out.error = L"--output must not be empty";
+                return false;
+            }
+            detail::split_headless_output(value, out.output_dir, out.output_stem);
+        } else if (opt == L"--segment-minutes" || opt == L"--segment-mb") {
+            uint32_t n = 0;
+            if (!detail::parse_headless_uint(value, n)) {
+                out.error = opt + L" must be a whole number";
+                return false;
+            }
+            (opt == L"--segment-mb" ? out.segment_mb : out.segment_minutes) = n;
+            out.segments_given = true;
+        } else if (opt == L"--summary") {
+            out.summary_path = value;
+        } else {
+            out.error = L"unknown option " + opt;
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace sr
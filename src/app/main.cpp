@@ -7,15 +7,27 @@
 #include <processthreadsapi.h>
 #include <commctrl.h>
 #include <dwmapi.h>
+#include <shellapi.h>
+#include <algorithm>
 #include <string>
 #include <cstdio>
+#include <memory>
+#include <mutex>
 #include <thread>
+#include <vector>
 #include "utils/logging.h"
 #include "utils/qpc_clock.h"
+#include "utils/trace_events.h"
+#include "utils/wide_path.h"
 #include "storage/storage_manager.h"
+#include "storage/mp4_trim.h"
+#include "storage/mp4_recovery.h"
+#include "storage/orphan_scanner.h"
 #include "controller/session_controller.h"
+#include "controller/transcode_queue.h"
 #include "capture/capture_engine.h"   // T043: is_wgc_supported()
 #include "app/app_settings.h"
+#include "app/headless_options.h"
 #include "app/settings_dialog.h"
 #include "app/telemetry.h"             // T037: TelemetrySnapshot
 #include "app/camera_overlay.h"
@@ -42,16 +54,29 @@
 #define ID_LABEL_PROFILE 1011
 #define ID_BTN_HQ        1012
 #define ID_TIMER_UPDATE  1
+#define ID_HOTKEY_SAVE_REPLAY 1
 
 // Custom messages for marshalling background thread callbacks to UI thread
 #define WM_SR_STATUS  (WM_USER + 1)
 #define WM_SR_ERROR   (WM_USER + 2)
 #define WM_SR_STOP_COMPLETE (WM_USER + 3)
+#define WM_SR_TELEMETRY     (WM_USER + 4)   // counters changed (coalesced push)
+#define WM_SR_RECOVERY_DONE (WM_USER + 5)   // lParam: heap sr::Mp4RecoveryResult
+#define WM_SR_ORPHANS_FOUND (WM_USER + 6)   // lParam: heap std::vector<std::wstring>
+
+// UI refresh: counters are pushed at most every kTelemetryPushMs; the timer
+// only keeps the clock and the recording pulse going, and stops while the
+// window is hidden or minimized
+static constexpr UINT kTelemetryPushMs  = 250;
+static constexpr UINT kUiTimerPulseMs   = 250;
+static constexpr UINT kUiTimerClockMs   = 1000;
 
 // Global state
 static sr::AppSettings       g_settings;
 static sr::StorageManager    g_storage;
+static sr::OrphanScanner     g_orphan_scanner;
 static sr::SessionController g_controller;
+static sr::TranscodeQueue    g_transcodes;
 static sr::CameraOverlay     g_camera_overlay;
 static sr::StopFlow          g_stop_flow;
 static std::thread           g_stop_thread;
@@ -80,6 +105,8 @@ static HFONT  g_font_metric = nullptr;
 static HWND   g_hot_button  = nullptr;
 static bool   g_motion_enabled = true;
 static sr::SessionState g_last_ui_state = sr::SessionState::Idle;
+static bool   g_ui_visible  = false;
+static UINT   g_ui_timer_ms = 0;      // 0 = timer not running
 
 static constexpr COLORREF kBgColor     = sr::ui::kWindowBackground;
 static constexpr COLORREF kTextColor   = sr::ui::kText;
@@ -110,7 +137,8 @@ static sr::ui::StatusTone StatusToneForState(sr::SessionState state) noexcept
         case sr::SessionState::Recording: return sr::ui::StatusTone::Recording;
         case sr::SessionState::Paused:    return sr::ui::StatusTone::Paused;
         case sr::SessionState::Stopping:  return sr::ui::StatusTone::Stopping;
-        case sr::SessionState::Idle:      break;
+        case sr::SessionState::Idle:
+        case sr::SessionState::Armed:     break;
     }
     return sr::ui::StatusTone::Idle;
 }
@@ -121,7 +149,8 @@ static const wchar_t* StatusPillLabel(sr::SessionState state) noexcept
         case sr::SessionState::Recording: return L"REC";
         case sr::SessionState::Paused:    return L"PAUSED";
         case sr::SessionState::Stopping:  return L"STOPPING";
-        case sr::SessionState::Idle:      break;
+        case sr::SessionState::Idle:
+        case sr::SessionState::Armed:     break;
     }
     return L"READY";
 }
@@ -140,15 +169,107 @@ static void ApplyEncoderProfileFromSettings()
     sr::EncoderProfile profile;
     profile.fps         = g_settings.fps;
     profile.bitrate_bps = g_settings.bitrate_bps;
+    profile.codec       = g_settings.codec;
     const auto resolution = sr::recording_resolution_for_quality(g_settings.high_quality);
     profile.width       = resolution.width;
     profile.height      = resolution.height;
     g_controller.set_encoder_profile(profile, g_settings.high_quality);
+    g_controller.set_adaptive_quality(g_settings.adaptive_quality);
+    g_controller.set_variable_frame_rate(g_settings.variable_frame_rate);
+    g_controller.set_adaptive_gop(g_settings.adaptive_gop, g_settings.gop_max_seconds);
+}
+
+static void ApplyAudioSettings()
+{
+    g_controller.set_audio_resampler_backend(g_settings.native_resampler
+        ? sr::ResamplerBackend::Native : sr::ResamplerBackend::MediaFoundation);
+    g_controller.set_separate_audio_tracks(g_settings.separate_audio_tracks);
+    g_controller.set_audio_latency(g_settings.audio_latency == L"default" ? sr::AudioLatencyMode::Default
+                                 : g_settings.audio_latency == L"power"   ? sr::AudioLatencyMode::PowerSaving
+                                 : g_settings.audio_latency == L"low"     ? sr::AudioLatencyMode::LowLatency
+                                 : sr::AudioLatencyMode::Auto);
+    if (g_settings.audio_codec == L"opus") {
+        g_controller.set_audio_encoding(sr::AudioCodec::Opus, g_settings.opus_kbps * 1000);
+    } else {
+        g_controller.set_audio_encoding(sr::AudioCodec::AAC, g_settings.aac_kbps * 1000,
+            g_settings.aac_profile == L"he" ? sr::AacProfile::HE : sr::AacProfile::LC);
+    }
+}
+
+static void ApplyCaptureSettings()
+{
+    g_controller.set_capture_source(g_settings.window_title.empty()
+        ? sr::CaptureSource::monitor_at(g_settings.monitor_index)
+        : sr::CaptureSource::window_titled(g_settings.window_title));
+    g_controller.set_capture_device_isolation(g_settings.isolated_capture_device);
+    g_controller.set_adapter_policy(g_settings.split_encode_adapter ? sr::AdapterPolicy::LowestContention
+        : g_settings.match_display_adapter ? sr::AdapterPolicy::CapturedDisplay
+        : sr::AdapterPolicy::PreferIntel);
+    g_controller.set_pipeline_boost(g_settings.pipeline_boost);
+    g_controller.set_cursor_overlay(g_settings.cursor_overlay);
+    g_controller.set_multi_monitor(g_settings.all_monitors, g_settings.hw_encoder_sessions);
+    g_controller.set_frame_tap(g_settings.frame_tap);
+    g_controller.set_hdr_tone_mapping(g_settings.hdr_tonemap);
+    g_controller.set_nv12_converter(g_settings.nv12_converter == L"vp"      ? sr::Nv12ConverterMode::VideoProcessor
+                                  : g_settings.nv12_converter == L"compute" ? sr::Nv12ConverterMode::Compute
+                                  : sr::Nv12ConverterMode::Auto,
+                                    g_settings.nv12_filter == L"box" ? sr::Nv12ScaleFilter::Box
+                                                                      : sr::Nv12ScaleFilter::Bilinear);
+}
+
+static void ApplyOutputSettings()
+{
+    g_controller.set_output_container(g_settings.fragmented_mp4
+        ? sr::MuxContainer::FragmentedMp4 : sr::MuxContainer::Mp4, g_settings.fragment_ms);
+    g_controller.set_unbuffered_io(g_settings.unbuffered_io, g_settings.io_chunk_mb);
+    g_controller.set_preallocation(g_settings.preallocate, g_settings.expected_minutes);
+    g_controller.set_keyframe_index(g_settings.keyframe_index);
+    g_controller.set_perf_trace(g_settings.perf_trace);
+    g_controller.set_segment_limits({ g_settings.segment_minutes, g_settings.segment_mb });
+    g_controller.set_replay_buffer(g_settings.replay_seconds);
+    sr::NetworkSinkConfig live;
+    live.url            = g_settings.live_url;
+    live.max_latency_ms = g_settings.live_max_latency_ms;
+    g_controller.set_live_stream(live);
+    g_controller.set_proxy_output(g_settings.proxy_output, sr::kEfficiencyRecordingResolution,
+                                  g_settings.proxy_kbps * 1000);
+}
+
+// Renditions of finished recordings, re-encoded while no session records.
+// Started once at launch; the [Transcode] keys are read from the INI only.
+static void StartTranscodeQueue()
+{
+    if (!g_settings.transcode_enabled) return;
+    g_transcodes.set_pause_condition([] { return !g_controller.state_is_idle(); });
+    g_transcodes.set_done_callback([](const sr::TranscodeJob& job, bool ok) {
+        if (!ok) SR_LOG_WARN(L"No %s rendition of '%s' was written", job.rendition.tag.c_str(), job.source.c_str());
+    });
+    if (!g_transcodes.start(g_settings.transcode_jobs, sr::AppSettings::probe_cache_path())) return;
+
+    sr::TranscodeRendition rendition;
+    rendition.tag         = std::to_wstring(g_settings.transcode_height) + L"p";
+    rendition.max_width   = 0;   // the height decides, the aspect ratio is kept
+    rendition.max_height  = g_settings.transcode_height;
+    rendition.bitrate_bps = g_settings.transcode_kbps * 1000;
+    rendition.codec       = g_settings.transcode_codec;
+    g_controller.set_finalized_callback([rendition](const std::wstring& path, bool ok) {
+        if (!ok) return;   // a partial file is for recovery, not for upload
+        sr::TranscodeJob job;
+        job.source       = path;
+        job.partial_path = sr::StorageManager::transcodeFilename(path, rendition.tag);
+        job.rendition    = rendition;
+        g_transcodes.enqueue(std::move(job));
+    });
 }
 
 static void ApplyCameraProfileFromSettings()
 {
     g_camera_overlay.set_high_quality(g_settings.high_quality);
+    g_camera_overlay.set_capture_excluded(g_settings.camera_pip);
+    sr::PipLayout layout;
+    layout.corner    = static_cast<sr::PipCorner>(g_settings.camera_pip_corner);
+    layout.width_pct = g_settings.camera_pip_size;
+    g_controller.set_camera_pip(g_settings.camera_pip, layout);
 }
 
 static void UpdateProfileLabel()
@@ -221,6 +342,31 @@ static void BeginStopAsync(HWND hwnd, bool exit_after_stop)
     });
 }
 
+// (Re)start or kill the UI timer for the current visibility and state
+static void SyncUiTimer(HWND hwnd, bool animated)
+{
+    const UINT want = !g_ui_visible ? 0 : (animated ? kUiTimerPulseMs : kUiTimerClockMs);
+    if (want == g_ui_timer_ms || !hwnd) return;
+    if (want == 0) {
+        KillTimer(hwnd, ID_TIMER_UPDATE);
+    } else {
+        SetTimer(hwnd, ID_TIMER_UPDATE, want, nullptr);
+    }
+    g_ui_timer_ms = want;
+}
+
+static void SetUiVisible(HWND hwnd, bool visible)
+{
+    if (visible == g_ui_visible) return;
+    g_ui_visible = visible;
+    g_controller.set_telemetry_notify(visible);
+    if (visible) {
+        UpdateUI();   // catch up on everything missed while hidden
+    } else {
+        SyncUiTimer(hwnd, false);
+    }
+}
+
 void UpdateUI()
 {
     const auto state = g_controller.state();
@@ -231,12 +377,14 @@ void UpdateUI()
 
     switch (display_state) {
         case sr::SessionState::Idle:      SetWindowTextW(g_lbl_status, L"Idle");      break;
+        case sr::SessionState::Armed:     SetWindowTextW(g_lbl_status, L"Ready");     break;
         case sr::SessionState::Recording: SetWindowTextW(g_lbl_status, L"Recording"); break;
         case sr::SessionState::Paused:    SetWindowTextW(g_lbl_status, L"Paused");    break;
         case sr::SessionState::Stopping:  SetWindowTextW(g_lbl_status, L"Stopping");  break;
     }
 
-    bool can_start = (state == sr::SessionState::Idle) && !stop_in_progress;
+    bool can_start = (state == sr::SessionState::Idle || state == sr::SessionState::Armed) &&
+                     !stop_in_progress;
     bool can_stop  = (state == sr::SessionState::Recording || state == sr::SessionState::Paused) &&
                      !stop_in_progress;
 
@@ -275,23 +423,27 @@ void UpdateUI()
         display_state == sr::SessionState::Paused ||
         display_state == sr::SessionState::Stopping) {
         auto ts = g_controller.telemetry_snapshot();
+        static const wchar_t* const kQualityLabel[] = { L"", L"  Q-1", L"  Q-2", L"  Q-3", L"  Q-4" };
         wchar_t fps_buf[120];
         _snwprintf_s(fps_buf, _countof(fps_buf), _TRUNCATE,
-            L"Cap:%u  Enc:%u  Drop:%u  Queue:%u  Enc:%s%s",
+            L"Cap:%u  Enc:%u  Drop:%u  Queue:%u  Enc:%s %s%s%s",
             ts.frames_captured, ts.frames_encoded, ts.frames_dropped,
             ts.frames_backlogged,
-            ts.encoder_mode_label(),
+            ts.encoder_mode_label(), ts.video_codec,
+            kQualityLabel[(std::min)(ts.quality_level, 4u)],
             ts.is_on_ac ? L"" : L"  Battery");
         SetWindowTextW(g_lbl_fps, fps_buf);
 
-        wchar_t drp_buf[64];
+        wchar_t drp_buf[128];
         _snwprintf_s(drp_buf, _countof(drp_buf), _TRUNCATE,
-            L"Dup:%u  AudioPkts:%u",
-            ts.dup_frames, ts.audio_packets);
+            L"Dup:%u  Static:%u  AudioPkts:%u  AudioDrop:%u  Mux:%u/%u  Lat p95:%.1fms",
+            ts.dup_frames, ts.unchanged_skipped, ts.audio_packets, ts.audio_dropped,
+            ts.mux_video_backlog, ts.mux_audio_backlog,
+            ts.stage_latency(sr::LatencyStage::EndToEnd).p95_us / 1000.0);
         SetWindowTextW(g_lbl_dropped, drp_buf);
     } else {
         SetWindowTextW(g_lbl_fps,     L"Cap:0  Enc:0  Drop:0  Queue:0");
-        SetWindowTextW(g_lbl_dropped, L"Dup:0  AudioPkts:0");
+        SetWindowTextW(g_lbl_dropped, L"Dup:0  Static:0  AudioPkts:0  AudioDrop:0  Mux:0/0");
     }
 
     // Output path
@@ -305,6 +457,7 @@ void UpdateUI()
     if (state_changed || status.animated) {
         InvalidateStatusChrome(g_hwnd);
     }
+    SyncUiTimer(g_hwnd, status.animated);
 }
 
 static void ApplyUIFont(HWND hwnd) {
@@ -479,6 +632,82 @@ static void DrawStatusPill(HDC hdc, const RECT& client_rc, sr::SessionState stat
 }
 
 // ----------------------------------------------------------------------------
+// T030: prompt for each *.partial.mp4 a previous crash left behind. Called
+// with OrphanScanner's first result; anything recovered, deleted or opened
+// for writing since then is skipped.
+static void PromptForOrphans(const std::vector<std::wstring>& orphans)
+{
+    static bool prompting = false;   // the message boxes pump messages
+    if (prompting) return;
+    prompting = true;
+    for (const auto& orphan : orphans) {
+        if (!g_orphan_scanner.contains(orphan) || sr::is_partial_in_use(orphan)) continue;
+        std::wstring msg =
+            L"An incomplete recording was found:\n\n" + orphan +
+            L"\n\nWhat would you like to do?\n\n"
+            L"Yes     \u2192 Recover (rebuild the index in the background)\n"
+            L"No      \u2192 Delete the incomplete file\n"
+            L"Cancel  \u2192 Ignore (keep as-is)";
+        int choice = MessageBoxW(g_hwnd, msg.c_str(),
+                                 L"Incomplete Recording Found",
+                                 MB_YESNOCANCEL | MB_ICONQUESTION);
+        if (choice == IDYES) {
+            // The sidecar MuxWriter left normally has the exact parameters;
+            // the current settings only fill in when it is missing
+            sr::RecoveryInfo fallback;
+            fallback.params.width   = static_cast<uint32_t>(GetSystemMetrics(SM_CXSCREEN));
+            fallback.params.height  = static_cast<uint32_t>(GetSystemMetrics(SM_CYSCREEN));
+            fallback.params.fps_num = g_settings.fps;
+            const HWND hwnd = g_hwnd;
+            const bool queued = sr::recover_partial_async(orphan, fallback,
+                [hwnd](const sr::Mp4RecoveryResult& result) {
+                    auto* copy = new sr::Mp4RecoveryResult(result);
+                    if (!PostMessageW(hwnd, WM_SR_RECOVERY_DONE, 0, reinterpret_cast<LPARAM>(copy))) {
+                        delete copy;
+                    }
+                });
+            if (!queued) {
+                // No pool thread: the plain rename still keeps the data
+                const auto recovery = sr::recover_orphan_partial(orphan);
+                auto* copy = new sr::Mp4RecoveryResult{};
+                copy->succeeded  = recovery.succeeded;
+                copy->error_code = recovery.error_code;
+                copy->final_path = recovery.final_path;
+                copy->message    = orphan;
+                if (!PostMessageW(g_hwnd, WM_SR_RECOVERY_DONE, 0, reinterpret_cast<LPARAM>(copy))) {
+                    delete copy;
+                }
+            }
+        } else if (choice == IDNO) {
+            const auto deletion = sr::delete_orphan_partial(orphan);
+            if (deletion.succeeded) {
+                sr::RecoveryInfo::remove(orphan);
+                SR_LOG_INFO(L"Orphan deleted: %s", orphan.c_str());
+            } else {
+                SR_LOG_ERROR(L"Orphan delete failed: %u", deletion.error_code);
+                wchar_t err[512]{};
+                _snwprintf_s(err, _countof(err), _TRUNCATE,
+                             L"Could not delete this incomplete recording:\n\n%s\n\nError: %u",
+                             orphan.c_str(),
+                             deletion.error_code);
+                MessageBoxW(g_hwnd, err, L"Delete Failed", MB_ICONERROR | MB_OK);
+            }
+        }
+        // IDCANCEL = ignore, leave file as-is
+    }
+    prompting = false;
+}
+
+static void StartOrphanScan()
+{
+    const HWND hwnd = g_hwnd;
+    g_orphan_scanner.start(g_storage.outputDirectory(), [hwnd](const std::vector<std::wstring>& orphans) {
+        if (orphans.empty()) return;
+        auto* copy = new std::vector<std::wstring>(orphans);
+        if (!PostMessageW(hwnd, WM_SR_ORPHANS_FOUND, 0, reinterpret_cast<LPARAM>(copy))) delete copy;
+    });
+}
+
 LRESULT CALLBACK WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam)
 {
     switch (msg) {
@@ -575,11 +804,25 @@ LRESULT CALLBACK WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam)
         ApplyUIFont(hwnd);
         LayoutMainWindow(hwnd);
 
-        SetTimer(hwnd, ID_TIMER_UPDATE, 250, nullptr);
+        // Timer starts with the first WM_SHOWWINDOW; counters arrive as WM_SR_TELEMETRY
+        g_controller.set_telemetry_listener([hwnd]() {
+            PostMessageW(hwnd, WM_SR_TELEMETRY, 0, 0);
+        }, kTelemetryPushMs);
+        // Instant replay: Alt+F10 saves the buffer, even while another app has focus
+        if (g_settings.replay_seconds > 0 &&
+            !RegisterHotKey(hwnd, ID_HOTKEY_SAVE_REPLAY, MOD_ALT | MOD_NOREPEAT, VK_F10)) {
+            SR_LOG_WARN(L"Save-replay hotkey Alt+F10 unavailable: %u", GetLastError());
+        }
         UpdateUI();
         break;
     }
 
+    case WM_HOTKEY:
+        if (wParam == ID_HOTKEY_SAVE_REPLAY && !g_controller.save_replay()) {
+            SR_LOG_INFO(L"Save replay: no replay session running");
+        }
+        break;
+
     case WM_DRAWITEM: {
         auto* dis = reinterpret_cast<LPDRAWITEMSTRUCT>(lParam);
         if (!dis || dis->CtlType != ODT_BUTTON) break;
@@ -659,10 +902,24 @@ LRESULT CALLBACK WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam)
     case WM_TIMER:
         if (wParam == ID_TIMER_UPDATE) {
             UpdateUI();
-            g_camera_overlay.refresh_power_profile();
         }
         break;
 
+    case WM_SR_TELEMETRY:
+        if (g_ui_visible) UpdateUI();
+        g_controller.acknowledge_telemetry();
+        return 0;
+
+    case WM_SHOWWINDOW:
+        SetUiVisible(hwnd, wParam != FALSE && !IsIconic(hwnd));
+        break;
+
+    case WM_POWERBROADCAST:
+        if (wParam == PBT_APMPOWERSTATUSCHANGE) {
+            g_camera_overlay.refresh_power_profile();
+        }
+        return TRUE;
+
     case WM_SETTINGCHANGE:
         g_motion_enabled = IsClientAreaAnimationEnabled();
         InvalidateStatusChrome(hwnd);
@@ -678,6 +935,7 @@ LRESULT CALLBACK WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam)
     }
 
     case WM_SIZE:
+        SetUiVisible(hwnd, wParam != SIZE_MINIMIZED && IsWindowVisible(hwnd));
         if (wParam != SIZE_MINIMIZED) {
             LayoutMainWindow(hwnd);
         }
@@ -697,6 +955,32 @@ LRESULT CALLBACK WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam)
         UpdateUI();
         break;
     }
+    case WM_SR_ORPHANS_FOUND: {
+        std::unique_ptr<std::vector<std::wstring>> orphans(reinterpret_cast<std::vector<std::wstring>*>(lParam));
+        if (orphans) PromptForOrphans(*orphans);
+        return 0;
+    }
+
+    case WM_SR_RECOVERY_DONE: {
+        std::unique_ptr<sr::Mp4RecoveryResult> recovery(reinterpret_cast<sr::Mp4RecoveryResult*>(lParam));
+        if (!recovery) return 0;
+        if (recovery->succeeded) {
+            SR_LOG_INFO(L"Orphan recovered: %s", recovery->final_path.c_str());
+            std::wstring msg = L"Recording recovered:\n" + recovery->final_path;
+            if (recovery->rebuilt) {
+                msg += L"\n\nThe file index was rebuilt; audio could not be recovered.";
+            }
+            MessageBoxW(hwnd, msg.c_str(), L"Recovery Complete", MB_ICONINFORMATION | MB_OK);
+        } else {
+            wchar_t err[512]{};
+            _snwprintf_s(err, _countof(err), _TRUNCATE,
+                         L"Could not recover this recording:\n\n%s\n\nError: %u",
+                         recovery->message.c_str(), recovery->error_code);
+            MessageBoxW(hwnd, err, L"Recovery Failed", MB_ICONERROR | MB_OK);
+        }
+        return 0;
+    }
+
     case WM_SR_STOP_COMPLETE: {
         JoinStopThreadIfFinished();
         const bool exit_after_stop = g_stop_flow.complete_stop();
@@ -756,17 +1040,22 @@ LRESULT CALLBACK WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam)
                 break;
             }
             if (sr::ShowSettingsDialog(hwnd, g_settings)) {
+                g_controller.disarm();  // engines were set up with the old profile
                 const bool camera_was_running = g_camera_overlay.is_running();
                 if (camera_was_running) {
                     g_camera_overlay.stop();
                 }
 
                 // Apply output directory
+                const std::wstring previous_dir = g_storage.outputDirectory();
                 if (!g_settings.output_dir.empty()) {
                     g_storage.setOutputDirectory(g_settings.output_dir);
                 } else {
                     g_storage.resolveDefaultDirectory();
                 }
+                if (g_storage.outputDirectory() != previous_dir) {
+                    StartOrphanScan();   // the cache follows the output directory
+                }
                 ApplyEncoderProfileFromSettings();
                 ApplyCameraProfileFromSettings();
                 // Persist
@@ -777,6 +1066,8 @@ LRESULT CALLBACK WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam)
                     g_camera_overlay.start(g_hwnd);
                 }
 
+                if (g_settings.prearm) g_controller.arm_async();
+
                 UpdateProfileLabel();
                 // Refresh path display
                 SetWindowTextW(g_lbl_path, g_storage.outputDirectory().c_str());
@@ -794,6 +1085,7 @@ LRESULT CALLBACK WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam)
                     L"High Quality", MB_ICONINFORMATION | MB_OK);
                 break;
             }
+            g_controller.disarm();
             g_settings.set_high_quality(!g_settings.high_quality);
             ApplyEncoderProfileFromSettings();
             if (g_settings.camera_overlay_enabled && g_camera_overlay.is_running()) {
@@ -804,6 +1096,7 @@ LRESULT CALLBACK WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam)
                 ApplyCameraProfileFromSettings();
             }
             g_settings.save();
+            if (g_settings.prearm) g_controller.arm_async();
             UpdateProfileLabel();
             SR_LOG_INFO(L"High Quality toggled: %s (%u bps)",
                         g_settings.high_quality ? L"on" : L"off",
@@ -814,6 +1107,7 @@ LRESULT CALLBACK WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam)
         break;
 
     case WM_CLOSE:
+        g_controller.set_auto_arm(false);  // don't re-arm after the closing stop
         if (!g_controller.state_is_idle() || g_stop_flow.stop_in_progress()) {
             BeginStopAsync(hwnd, true);
             return 0;
@@ -822,10 +1116,18 @@ LRESULT CALLBACK WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam)
         return 0;
 
     case WM_DESTROY:
-        KillTimer(hwnd, ID_TIMER_UPDATE);
+        SetUiVisible(hwnd, false);
+        g_controller.set_telemetry_notify(false);
+        UnregisterHotKey(hwnd, ID_HOTKEY_SAVE_REPLAY);
         JoinStopThreadIfFinished();
         if (!g_controller.state_is_idle()) g_controller.stop();
+        if (g_transcodes.running()) {
+            g_controller.wait_for_finalize();   // the callback enqueues into the queue stopped below
+            g_controller.set_finalized_callback(nullptr);
+        }
+        g_transcodes.stop();   // cancels a running job; its output is removed
         g_camera_overlay.stop();
+        g_orphan_scanner.stop();
         if (g_font_ui) {
             DeleteObject(g_font_ui);
             g_font_ui = nullptr;
@@ -859,11 +1161,175 @@ LRESULT CALLBACK WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam)
     return 0;
 }
 
+// ----------------------------------------------------------------------------
+// Headless mode — ScreenRecorder.exe --headless [options] (app/headless_options.h).
+// ScreenRecorder.ini configures the session as in the UI; the command line
+// overrides profile, duration, output and segments. No window, camera
+// overlay, UI timer or pre-arm: the session starts from cold, a one-line
+// JSON summary goes to stdout (and --summary), and the exit code is
+// SessionDiagnostics::exit_code().
+// ----------------------------------------------------------------------------
+static HANDLE g_headless_stop = nullptr;
+static HANDLE g_headless_done = nullptr;   // set once the file is finalized and the summary written
+
+static BOOL WINAPI HeadlessCtrlHandler(DWORD type)
+{
+    // Ctrl+C / Ctrl+Break / console closed: stop and finalize, then exit
+    if (g_headless_stop) SetEvent(g_headless_stop);
+    switch (type) {
+    case CTRL_CLOSE_EVENT:
+    case CTRL_LOGOFF_EVENT:
+    case CTRL_SHUTDOWN_EVENT:
+        // The process ends as soon as this returns: hold it until RunHeadless
+        // is done (the system still enforces its own close / shutdown limit)
+        if (g_headless_done) WaitForSingleObject(g_headless_done, INFINITE);
+        break;
+    default:
+        break;
+    }
+    return TRUE;
+}
+
+static void HeadlessAttachConsole()
+{
+    // Redirected handles (a CI runner's pipes or files) are inherited as is;
+    // otherwise write to the console of the shell that started us
+    if (GetFileType(GetStdHandle(STD_OUTPUT_HANDLE)) != FILE_TYPE_UNKNOWN) return;
+    if (AttachConsole(ATTACH_PARENT_PROCESS)) {
+        FILE* fp = nullptr;
+        _wfreopen_s(&fp, L"CONOUT$", L"w", stdout);
+        _wfreopen_s(&fp, L"CONOUT$", L"w", stderr);
+    }
+}
+
+static int RunHeadless(const std::vector<std::wstring>& args)
+{
+    HeadlessAttachConsole();
+    sr::HeadlessOptions opt;
+    if (!sr::parse_headless_options(args, opt)) {
+        fwprintf(stderr, L"%ls\n%ls", opt.error.c_str(), sr::headless_usage());
+        return sr::SessionDiagnostics::kExitUsage;
+    }
+
+    sr::Logger::instance().start(sr::AppSettings::log_path());
+    sr::trace::register_provider();
+    SR_LOG_INFO(L"ScreenRecorder starting headless...");
+
+    // Overrides stay in memory: this mode never saves the settings
+    g_settings.load();
+    if (opt.profile != sr::HeadlessOptions::Profile::Settings) {
+        g_settings.high_quality = opt.profile == sr::HeadlessOptions::Profile::HighQuality;
+    }
+    if (opt.segments_given) {
+        g_settings.segment_minutes = opt.segment_minutes;
+        g_settings.segment_mb      = opt.segment_mb;
+    }
+    const std::wstring& output_dir = opt.output_dir.empty() ? g_settings.output_dir : opt.output_dir;
+    if (!output_dir.empty()) g_storage.setOutputDirectory(output_dir);
+    g_storage.setFileStem(opt.output_stem);
+    ApplyEncoderProfileFromSettings();
+    ApplyAudioSettings();
+    ApplyCaptureSettings();
+    ApplyOutputSettings();
+    g_controller.set_replay_buffer(0);    // a headless run always writes its file
+    g_controller.set_camera_pip(false);   // there is no camera overlay to feed it
+
+    std::mutex                  result_mutex;
+    sr::SessionDiagnostics::Summary summary;
+    bool                        have_summary = false;
+    std::vector<std::wstring>   files;
+    g_controller.set_finalized_callback([&](const std::wstring& path, bool ok) {
+        std::lock_guard<std::mutex> lock(result_mutex);
+        if (ok) files.push_back(path);
+    });
+    g_controller.set_summary_callback([&](const sr::SessionDiagnostics::Summary& s) {
+        std::lock_guard<std::mutex> lock(result_mutex);
+        summary      = s;
+        have_summary = true;
+    });
+
+    g_controller.set_probe_cache_path(sr::AppSettings::probe_cache_path());
+    const bool ready = sr::CaptureEngine::is_wgc_supported() && g_controller.initialize(
+        &g_storage,
+        [](const std::wstring& status) { SR_LOG_INFO(L"[Headless] %s", status.c_str()); },
+        [](const std::wstring& error)  { fwprintf(stderr, L"%ls\n", error.c_str()); });
+
+    if (!ready) {
+        summary.failure = sr::CaptureEngine::is_wgc_supported() ? L"controller_initialization_failed"
+                                                                : L"screen_capture_not_supported";
+    } else if (g_controller.start()) {
+        g_headless_stop = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+        g_headless_done = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+        SetConsoleCtrlHandler(HeadlessCtrlHandler, TRUE);
+        const ULONGLONG deadline = opt.duration_s > 0.0
+            ? GetTickCount64() + static_cast<ULONGLONG>(opt.duration_s * 1000.0) : 0;
+        // Also ends when the session stops itself (device lost, disk full, source closed)
+        while (!g_controller.state_is_idle()) {
+            DWORD wait_ms = 200;
+            if (deadline) {
+                const ULONGLONG now = GetTickCount64();
+                if (now >= deadline) break;
+                wait_ms = static_cast<DWORD>((std::min<ULONGLONG>)(wait_ms, deadline - now));
+            }
+            if (WaitForSingleObject(g_headless_stop, wait_ms) == WAIT_OBJECT_0) break;
+        }
+        g_controller.stop();
+        g_controller.wait_for_finalize();
+    }
+
+    std::string json;
+    int exit_code = sr::SessionDiagnostics::kExitStartFailed;
+    {
+        std::lock_guard<std::mutex> lock(result_mutex);
+        if (ready && !have_summary) summary = g_controller.session_summary();   // start() failed
+        json      = sr::SessionDiagnostics::format_json_summary(summary, files);
+        exit_code = sr::SessionDiagnostics::exit_code(summary);
+    }
+    g_controller.set_finalized_callback(nullptr);   // they capture this frame's locals
+    g_controller.set_summary_callback(nullptr);
+    std::fwrite(json.data(), 1, json.size(), stdout);
+    std::fputc('\n', stdout);
+    std::fflush(stdout);
+    if (!opt.summary_path.empty()) {
+        if (FILE* file = sr::open_wide(opt.summary_path, "wb")) {
+            std::fwrite(json.data(), 1, json.size(), file);
+            std::fclose(file);
+        } else {
+            fwprintf(stderr, L"Summary file could not be written: %ls\n", opt.summary_path.c_str());
+        }
+    }
+    SR_LOG_INFO(L"Headless session ended with exit code %d", exit_code);
+    if (g_headless_done) {
+        // Both events stay open: a handler blocked on close / shutdown may
+        // still be waiting on `done`, and the process is about to exit
+        SetConsoleCtrlHandler(HeadlessCtrlHandler, FALSE);
+        SetEvent(g_headless_done);
+    }
+
+    sr::trace::unregister_provider();
+    sr::Logger::instance().stop();
+    return exit_code;
+}
+
 // ----------------------------------------------------------------------------
 int WINAPI wWinMain(HINSTANCE hInstance, HINSTANCE, LPWSTR, int nCmdShow)
 {
     CoInitializeEx(nullptr, COINIT_MULTITHREADED);
 
+    // Headless recording for scripts, before any UI resource is created
+    {
+        int argc = 0;
+        LPWSTR* argv = CommandLineToArgvW(GetCommandLineW(), &argc);
+        if (argv && argc >= 2 && wcscmp(argv[1], L"--headless") == 0) {
+            const std::vector<std::wstring> args(argv + 2, argv + argc);
+            LocalFree(argv);
+            const int code = RunHeadless(args);
+            CoUninitialize();
+            return code;
+        }
+        if (argv) LocalFree(argv);
+    }
+
     if (!g_brush_bg) {
         g_brush_bg = CreateSolidBrush(kBgColor);
     }
@@ -880,11 +1346,33 @@ int WINAPI wWinMain(HINSTANCE hInstance, HINSTANCE, LPWSTR, int nCmdShow)
     }
 #endif
 
+    // Lossless cut without the UI:  ScreenRecorder.exe --trim <in.mp4> <out.mp4> <start_s> [end_s]
+    {
+        int argc = 0;
+        LPWSTR* argv = CommandLineToArgvW(GetCommandLineW(), &argc);
+        if (argv && argc >= 5 && wcscmp(argv[1], L"--trim") == 0) {
+            sr::Logger::instance().start();   // debugger output; keeps the app log intact
+            sr::TrimRange range;
+            range.start_100ns = static_cast<int64_t>(_wtof(argv[4]) * 1e7);
+            if (argc >= 6) range.end_100ns = static_cast<int64_t>(_wtof(argv[5]) * 1e7);
+            sr::TrimResult result;
+            const bool ok = sr::trim_recording(argv[2], argv[3], range, result);
+            LocalFree(argv);
+            sr::Logger::instance().stop();
+            CoUninitialize();
+            return ok ? 0 : 1;
+        }
+        if (argv) LocalFree(argv);
+    }
+
     // T033: Process priority is managed dynamically:
     // - NORMAL_PRIORITY_CLASS when idle (saves battery)
     // - ABOVE_NORMAL_PRIORITY_CLASS during recording (set by SessionController::start())
     SetPriorityClass(GetCurrentProcess(), NORMAL_PRIORITY_CLASS);
 
+    // Log lines are queued from here on; the flush thread owns debugger/file output
+    sr::Logger::instance().start(sr::AppSettings::log_path());
+    sr::trace::register_provider();  // ETW pipeline events; free until a session enables it
     SR_LOG_INFO(L"ScreenRecorder starting...");
 
     // Load persisted settings and apply to storage + encoder profile
@@ -895,8 +1383,12 @@ int WINAPI wWinMain(HINSTANCE hInstance, HINSTANCE, LPWSTR, int nCmdShow)
     {
         ApplyEncoderProfileFromSettings();
         ApplyCameraProfileFromSettings();
+        ApplyAudioSettings();
+        ApplyCaptureSettings();
+        ApplyOutputSettings();
     }
 
+    g_controller.set_probe_cache_path(sr::AppSettings::probe_cache_path());
     g_controller.initialize(
         &g_storage,
         [](const std::wstring& status) {
@@ -948,57 +1440,22 @@ int WINAPI wWinMain(HINSTANCE hInstance, HINSTANCE, LPWSTR, int nCmdShow)
             L"Recording is disabled.",
             L"Screen Capture Unavailable", MB_ICONERROR | MB_OK);
         EnableWindow(g_btn_start, FALSE);
+    } else if (g_settings.prearm) {
+        // Initialize capture/audio/encoder now so Start only opens the file
+        g_controller.set_auto_arm(true);
+        g_controller.arm_async();
     }
 
-    // T030: Orphan detection — scan for *.partial.mp4 left by a previous crash
-    {
-        auto orphans = g_storage.findOrphanedFiles();
-        for (const auto& orphan : orphans) {
-            std::wstring msg =
-                L"An incomplete recording was found:\n\n" + orphan +
-                L"\n\nWhat would you like to do?\n\n"
-                L"Yes     \u2192 Recover (rename to .mp4 for playback)\n"
-                L"No      \u2192 Delete the incomplete file\n"
-                L"Cancel  \u2192 Ignore (keep as-is)";
-            int choice = MessageBoxW(g_hwnd, msg.c_str(),
-                                     L"Incomplete Recording Found",
-                                     MB_YESNOCANCEL | MB_ICONQUESTION);
-            if (choice == IDYES) {
-                const auto recovery = sr::recover_orphan_partial(orphan);
-                if (recovery.succeeded) {
-                    SR_LOG_INFO(L"Orphan recovered: %s", recovery.final_path.c_str());
-                    MessageBoxW(g_hwnd,
-                        (L"Recording recovered:\n" + recovery.final_path).c_str(),
-                        L"Recovery Complete", MB_ICONINFORMATION | MB_OK);
-                } else {
-                    SR_LOG_ERROR(L"Orphan recovery failed: %u", recovery.error_code);
-                    wchar_t err[512]{};
-                    _snwprintf_s(err, _countof(err), _TRUNCATE,
-                                 L"Could not recover this recording:\n\n%s\n\nError: %u",
-                                 orphan.c_str(),
-                                 recovery.error_code);
-                    MessageBoxW(g_hwnd, err, L"Recovery Failed", MB_ICONERROR | MB_OK);
-                }
-            } else if (choice == IDNO) {
-                const auto deletion = sr::delete_orphan_partial(orphan);
-                if (deletion.succeeded) {
-                    SR_LOG_INFO(L"Orphan deleted: %s", orphan.c_str());
-                } else {
-                    SR_LOG_ERROR(L"Orphan delete failed: %u", deletion.error_code);
-                    wchar_t err[512]{};
-                    _snwprintf_s(err, _countof(err), _TRUNCATE,
-                                 L"Could not delete this incomplete recording:\n\n%s\n\nError: %u",
-                                 orphan.c_str(),
-                                 deletion.error_code);
-                    MessageBoxW(g_hwnd, err, L"Delete Failed", MB_ICONERROR | MB_OK);
-                }
-            }
-            // IDCANCEL = ignore, leave file as-is
-        }
-    }
+    // T030: Orphan detection runs in the background; the window is usable meanwhile
+    StartOrphanScan();
+    StartTranscodeQueue();
 
     UpdateProfileLabel();
 
+    // Camera frames also feed the recording's PiP (ignored unless recording with it)
+    g_camera_overlay.set_frame_sink([](const uint8_t* bgrx, UINT32 width, UINT32 height) {
+        g_controller.post_camera_frame(bgrx, width, height);
+    });
     if (g_settings.camera_overlay_enabled) {
         g_camera_overlay.start(g_hwnd);
     }
@@ -1009,6 +1466,8 @@ int WINAPI wWinMain(HINSTANCE hInstance, HINSTANCE, LPWSTR, int nCmdShow)
         DispatchMessageW(&msg_loop);
     }
 
+    sr::trace::unregister_provider();
+    sr::Logger::instance().stop();
     CoUninitialize();
     if (g_brush_bg) {
         DeleteObject(g_brush_bg);
@@ -2,13 +2,52 @@
 // telemetry.h — T037: Runtime telemetry counters for debug overlay
 // Provides a plain snapshot struct that can be filled from session counters and
 // displayed in the UI overlay without any locks (all reads are relaxed atomics).
+// Per-stage frame latency is kept in LatencyHistograms and reported as
+// p50/p95/p99 so drops can be attributed to capture, VP, encoder or muxer.
+// Counter changes can push a coalesced change notification to the UI (at most
+// one outstanding, at most one per interval) instead of the UI polling.
 
+#include <array>
 #include <cstdint>
 #include <string>
 #include <atomic>
+#include <chrono>
+#include <functional>
+#include "utils/latency_histogram.h"
 
 namespace sr {
 
+// Video pipeline stages, timed per frame from RenderFrame::stamps
+enum class LatencyStage : uint32_t {
+    Convert,    // WGC frame arrival -> VideoProcessorBlt submitted
+    Queue,      // Blt submitted -> dequeued by the encode stage
+    Encode,     // dequeued -> encode_frame() returned
+    Mux,        // encode_frame() returned -> written to the sink writer
+    EndToEnd,   // WGC frame arrival -> written to the sink writer
+    Count,
+};
+
+inline const wchar_t* latency_stage_label(LatencyStage stage) {
+    switch (stage) {
+        case LatencyStage::Convert:  return L"convert";
+        case LatencyStage::Queue:    return L"queue";
+        case LatencyStage::Encode:   return L"encode";
+        case LatencyStage::Mux:      return L"mux";
+        case LatencyStage::EndToEnd: return L"total";
+        default:                     return L"?";
+    }
+}
+
+constexpr size_t kLatencyStageCount = static_cast<size_t>(LatencyStage::Count);
+
+struct LatencyPercentiles {
+    uint32_t samples = 0;
+    uint32_t p50_us  = 0;
+    uint32_t p95_us  = 0;
+    uint32_t p99_us  = 0;
+    uint32_t max_us  = 0;
+};
+
 // -------------------------------------------------------------------
 // TelemetrySnapshot — plain-old-data copy of all live counters.
 // Filled by SessionController::telemetry_snapshot() and read by UI.
@@ -20,8 +59,20 @@ struct TelemetrySnapshot {
     uint32_t frames_backlogged = 0;  // frames currently sitting in the queue
     uint32_t audio_packets     = 0;  // audio packets muxed
     uint32_t dup_frames        = 0;  // synthetic duplicates inserted by FramePacer
+    uint32_t unchanged_skipped = 0;  // unchanged (is_duplicate) frames not encoded
+    uint32_t audio_dropped     = 0;  // audio packets lost (AudioQueue full at push)
+    uint32_t mux_video_backlog = 0;  // encoded video samples waiting for the mux stage
+    uint32_t mux_audio_backlog = 0;  // packed audio samples waiting for the mux stage
+    uint32_t mux_stalls        = 0;  // times an encode stage waited on a full mux queue
     uint32_t encoder_mode      = 0;  // 0 = HW, 1 = SW, 2 = SW 720p
+    uint32_t quality_level     = 0;  // QualityGovernor step-down level (0 = nominal)
+    const wchar_t* video_codec = L"H.264";  // static label of the active codec
     bool     is_on_ac          = true;
+    std::array<LatencyPercentiles, kLatencyStageCount> latency{};
+
+    const LatencyPercentiles& stage_latency(LatencyStage stage) const {
+        return latency[static_cast<size_t>(stage)];
+    }
 
     // Human-readable encoder mode label
     const wchar_t* encoder_mode_label() const {
@@ -40,17 +91,64 @@ struct TelemetrySnapshot {
 // -------------------------------------------------------------------
 class TelemetryStore {
 public:
+    using ChangeListener = std::function<void()>;
+
     // Called from capture thread
-    void on_frame_captured()               { frames_captured_.fetch_add(1, std::memory_order_relaxed); }
-    void on_frame_dropped()                { frames_dropped_.fetch_add(1, std::memory_order_relaxed); }
+    void on_frame_captured()               { frames_captured_.fetch_add(1, std::memory_order_relaxed); changed(); }
+    void on_frame_dropped()                { frames_dropped_.fetch_add(1, std::memory_order_relaxed); changed(); }
 
     // Called from encode thread
-    void on_frame_encoded()                { frames_encoded_.fetch_add(1, std::memory_order_relaxed); }
-    void on_audio_written()                { audio_written_.fetch_add(1, std::memory_order_relaxed); }
-    void on_duplicate_inserted()           { dup_frames_.fetch_add(1, std::memory_order_relaxed); }
+    void on_frame_encoded()                { frames_encoded_.fetch_add(1, std::memory_order_relaxed); changed(); }
+    void on_audio_written()                { audio_written_.fetch_add(1, std::memory_order_relaxed); changed(); }
+    void on_duplicate_inserted()           { dup_frames_.fetch_add(1, std::memory_order_relaxed); changed(); }
+    void on_unchanged_skipped()            { unchanged_skipped_.fetch_add(1, std::memory_order_relaxed); changed(); }
 
-    // Called from UI thread (250ms timer) — approximate queue depth
+    // Change notification — listener before any counter update (it runs on
+    // the updating thread, so it should only post a message). Fires at most
+    // once per `min_interval_ms` and not again until acknowledge_change().
+    void set_change_listener(ChangeListener listener, uint32_t min_interval_ms) {
+        listener_        = std::move(listener);
+        notify_interval_ = min_interval_ms;
+    }
+    // UI thread: only notify while somebody looks (window visible)
+    void set_notify_enabled(bool enabled) {
+        notify_enabled_.store(enabled, std::memory_order_relaxed);
+        if (enabled) acknowledge_change();
+    }
+    // UI thread, after reading the snapshot: the next change may notify again
+    void acknowledge_change() { notify_pending_.store(false, std::memory_order_release); }
+
+    // A counter changed at `now_ms`; true when the listener was called
+    bool note_change(uint64_t now_ms) {
+        if (!listener_ || !notify_enabled_.load(std::memory_order_relaxed) ||
+            notify_pending_.load(std::memory_order_relaxed)) {
+            return false;
+        }
+        const uint64_t last = last_notify_ms_.load(std::memory_order_relaxed);
+        if (last != 0 && now_ms - last < notify_interval_) return false;
+        if (notify_pending_.exchange(true, std::memory_order_acq_rel)) return false;
+        last_notify_ms_.store(now_ms, std::memory_order_relaxed);
+        listener_();
+        return true;
+    }
+
+    // Called from capture-side stamps on the video-encode and mux stages
+    void record_latency(LatencyStage stage, int64_t us) {
+        if (stage < LatencyStage::Count) latency_[static_cast<size_t>(stage)].record(us);
+    }
+
+    // Called from video-encode / audio-mix stages when the mux queue is full
+    void on_mux_stall()                    { mux_stalls_.fetch_add(1, std::memory_order_relaxed); }
+
+    // Called from video-encode stage when QualityGovernor changes level
+    void set_quality_level(uint32_t level) { quality_level_.store(level, std::memory_order_relaxed); }
+
+    // Called from UI thread (with each snapshot) — approximate queue depth
     void set_backlog(uint32_t n)           { frames_backlogged_.store(n, std::memory_order_relaxed); }
+    void set_mux_backlog(uint32_t video, uint32_t audio) {
+        mux_video_backlog_.store(video, std::memory_order_relaxed);
+        mux_audio_backlog_.store(audio, std::memory_order_relaxed);
+    }
 
     void reset() {
         frames_captured_.store(0,   std::memory_order_relaxed);
@@ -59,6 +157,12 @@ public:
         frames_backlogged_.store(0, std::memory_order_relaxed);
         audio_written_.store(0,     std::memory_order_relaxed);
         dup_frames_.store(0,        std::memory_order_relaxed);
+        unchanged_skipped_.store(0, std::memory_order_relaxed);
+        mux_video_backlog_.store(0, std::memory_order_relaxed);
+        mux_audio_backlog_.store(0, std::memory_order_relaxed);
+        mux_stalls_.store(0,        std::memory_order_relaxed);
+        quality_level_.store(0,     std::memory_order_relaxed);
+        for (auto& h : latency_) h.reset();
     }
 
     TelemetrySnapshot snapshot(uint32_t encoder_mode, bool on_ac) const {
@@ -69,18 +173,54 @@ public:
         s.frames_backlogged = frames_backlogged_.load(std::memory_order_relaxed);
         s.audio_packets     = audio_written_.load(std::memory_order_relaxed);
         s.dup_frames        = dup_frames_.load(std::memory_order_relaxed);
+        s.unchanged_skipped = unchanged_skipped_.load(std::memory_order_relaxed);
+        s.mux_video_backlog = mux_video_backlog_.load(std::memory_order_relaxed);
+        s.mux_audio_backlog = mux_audio_backlog_.load(std::memory_order_relaxed);
+        s.mux_stalls        = mux_stalls_.load(std::memory_order_relaxed);
+        s.quality_level     = quality_level_.load(std::memory_order_relaxed);
         s.encoder_mode      = encoder_mode;
         s.is_on_ac          = on_ac;
+        for (size_t i = 0; i < kLatencyStageCount; ++i) {
+            const LatencyHistogram& h = latency_[i];
+            auto& out  = s.latency[i];
+            out.samples = clamp_u32(h.count());
+            out.p50_us  = clamp_u32(h.percentile(50.0));
+            out.p95_us  = clamp_u32(h.percentile(95.0));
+            out.p99_us  = clamp_u32(h.percentile(99.0));
+            out.max_us  = clamp_u32(h.max());
+        }
         return s;
     }
 
 private:
+    void changed() {
+        if (!notify_enabled_.load(std::memory_order_relaxed)) return;
+        note_change(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count()));
+    }
+
+    static uint32_t clamp_u32(uint64_t v) {
+        return v > UINT32_MAX ? UINT32_MAX : static_cast<uint32_t>(v);
+    }
+
+    std::array<LatencyHistogram, kLatencyStageCount> latency_;
     std::atomic<uint32_t> frames_captured_  { 0 };
     std::atomic<uint32_t> frames_encoded_   { 0 };
     std::atomic<uint32_t> frames_dropped_   { 0 };
     std::atomic<uint32_t> frames_backlogged_{ 0 };
     std::atomic<uint32_t> audio_written_    { 0 };
     std::atomic<uint32_t> dup_frames_       { 0 };
+    std::atomic<uint32_t> unchanged_skipped_{ 0 };
+    std::atomic<uint32_t> mux_video_backlog_{ 0 };
+    std::atomic<uint32_t> mux_audio_backlog_{ 0 };
+    std::atomic<uint32_t> mux_stalls_       { 0 };
+    std::atomic<uint32_t> quality_level_    { 0 };
+
+    ChangeListener        listener_;
+    uint32_t              notify_interval_ = 250;
+    std::atomic<bool>     notify_enabled_{ false };
+    std::atomic<bool>     notify_pending_{ false };
+    std::atomic<uint64_t> last_notify_ms_{ 0 };
 };
 
 } // namespace sr
@@ -5,12 +5,14 @@
 // Supports Microphone (eCapture) and Loopback (eRender) capture modes.
 
 #include "audio/audio_engine.h"
+#include "audio/audio_mixer.h"
 #include "utils/logging.h"
+#include "utils/qpc_clock.h"
+#include "utils/trace_events.h"
 
 #include <avrt.h>
 #include <audiopolicy.h>
 #include <cstring>
-#include <cmath>
 #pragma comment(lib, "avrt.lib")
 
 namespace sr {
@@ -68,34 +70,48 @@ bool AudioEngine::initialize(AudioQueue* queue, AudioCaptureMode mode) {
     SR_LOG_INFO(L"[%s] Audio device: %u Hz, %u ch, %u-bit", mode_name,
                 sample_rate_, channels_, bits_per_sample_);
 
-    // T032: Initialize MF Resampler if device rate differs from 48 kHz
+    // T032: Initialize resampler if device rate differs from 48 kHz
     if (!resampler_.initialize(sample_rate_, static_cast<uint16_t>(channels_),
-                                bits_per_sample_, 48000)) {
+                                bits_per_sample_, 48000, resampler_backend_)) {
         SR_LOG_WARN(L"AudioResampler init failed — continuing at native rate %u Hz", sample_rate_);
     } else if (!resampler_.is_passthrough()) {
-        SR_LOG_INFO(L"AudioResampler active: %u Hz -> 48000 Hz", sample_rate_);
+        SR_LOG_INFO(L"AudioResampler active (%s): %u Hz -> 48000 Hz",
+                    resampler_backend_label(resampler_.backend()), sample_rate_);
     }
 
-    // Initialize shared mode — 100ms buffer, event-driven
+    // Initialize shared mode. Default: 100ms buffer, event-driven. PowerSaving
+    // polls a larger buffer; LowLatency (mic only: loopback streams cannot use
+    // IAudioClient3 periods) goes through InitializeSharedAudioStream.
     // Loopback requires AUDCLNT_STREAMFLAGS_LOOPBACK on the render endpoint
-    REFERENCE_TIME buf_duration = 1'000'000; // 100ms in 100ns units
+    plan_ = plan_audio_period(latency_mode_ == AudioLatencyMode::LowLatency && is_loopback
+                                  ? AudioLatencyMode::Default : latency_mode_, 0);
     DWORD stream_flags = AUDCLNT_STREAMFLAGS_EVENTCALLBACK |
                          AUDCLNT_STREAMFLAGS_AUTOCONVERTPCM |
                          AUDCLNT_STREAMFLAGS_SRC_DEFAULT_QUALITY;
     if (is_loopback) {
         stream_flags |= AUDCLNT_STREAMFLAGS_LOOPBACK;
     }
-    hr = audio_client_->Initialize(
-        AUDCLNT_SHAREMODE_SHARED,
-        stream_flags,
-        buf_duration, 0, mix_fmt, nullptr
-    );
+    bool opened = latency_mode_ == AudioLatencyMode::LowLatency && !is_loopback &&
+                  initialize_low_latency(mix_fmt, AUDCLNT_STREAMFLAGS_EVENTCALLBACK);
+    if (!opened) {
+        if (!plan_.event_driven) stream_flags &= ~AUDCLNT_STREAMFLAGS_EVENTCALLBACK;
+        hr = !audio_client_ ? E_NOINTERFACE : audio_client_->Initialize(
+            AUDCLNT_SHAREMODE_SHARED,
+            stream_flags,
+            plan_.buffer_100ns, 0, mix_fmt, nullptr
+        );
+        opened = SUCCEEDED(hr);
+    }
     CoTaskMemFree(mix_fmt);
 
-    if (FAILED(hr)) {
+    if (!opened) {
         SR_LOG_ERROR(L"IAudioClient::Initialize failed: 0x%08X", hr);
         return false;
     }
+    REFERENCE_TIME default_period = 0;
+    audio_client_->GetDevicePeriod(&default_period, nullptr);
+    SR_LOG_INFO(L"[%s] Audio period: %s, ~%u wakeups/s", mode_name, audio_latency_label(plan_.mode),
+                audio_wakeups_per_second(plan_, default_period, sample_rate_));
 
     // Opt-out of Windows communications ducking.
     // When any app opens an eCommunications stream, Windows can auto-duck
@@ -111,13 +127,14 @@ bool AudioEngine::initialize(AudioQueue* queue, AudioCaptureMode mode) {
         }
     }
 
-    // Create event handle + register it
+    // Create event handle + register it. A polled stream only uses it to
+    // wake the capture thread for stop().
     event_handle_ = CreateEventW(nullptr, FALSE, FALSE, nullptr);
     if (!event_handle_) {
         SR_LOG_ERROR(L"CreateEvent for audio failed");
         return false;
     }
-    hr = audio_client_->SetEventHandle(event_handle_);
+    hr = plan_.event_driven ? audio_client_->SetEventHandle(event_handle_) : S_OK;
     if (FAILED(hr)) {
         SR_LOG_ERROR(L"SetEventHandle failed: 0x%08X", hr);
         return false;
@@ -145,8 +162,41 @@ bool AudioEngine::initialize(AudioQueue* queue, AudioCaptureMode mode) {
     return true;
 }
 
+bool AudioEngine::initialize_low_latency(const WAVEFORMATEX* format, DWORD stream_flags) {
+    ComPtr<IAudioClient3> client3;
+    UINT32 default_frames = 0, fundamental = 0, min_frames = 0, max_frames = 0;
+    if (FAILED(audio_client_.As(&client3)) ||
+        FAILED(client3->GetSharedModeEnginePeriod(format, &default_frames, &fundamental,
+                                                 &min_frames, &max_frames))) {
+        SR_LOG_WARN(L"IAudioClient3 unavailable — low-latency audio falls back to the default period");
+        return false;
+    }
+    const AudioPeriodPlan plan = plan_audio_period(AudioLatencyMode::LowLatency, min_frames);
+    const HRESULT hr = client3->InitializeSharedAudioStream(stream_flags, plan.period_frames, format, nullptr);
+    if (SUCCEEDED(hr)) {
+        plan_ = plan;
+        SR_LOG_INFO(L"Low-latency audio: %u-frame period (default %u)", min_frames, default_frames);
+        return true;
+    }
+    SR_LOG_WARN(L"InitializeSharedAudioStream(%u frames) failed: 0x%08X — using the default period",
+                min_frames, hr);
+    // A failed initialize can leave the client unusable: start from a fresh one
+    client3.Reset();
+    audio_client_.Reset();
+    if (FAILED(device_->Activate(__uuidof(IAudioClient), CLSCTX_ALL, nullptr,
+                                 reinterpret_cast<void**>(audio_client_.GetAddressOf())))) {
+        SR_LOG_ERROR(L"IAudioClient re-activate failed");
+    }
+    return false;
+}
+
 bool AudioEngine::start() {
     sample_count_ = 0;
+    suspend_requested_.store(false, std::memory_order_relaxed);
+    suspended_ = false;
+    packets_dropped_.store(0, std::memory_order_relaxed);
+    wakeups_.store(0, std::memory_order_relaxed);
+    started_ms_ = GetTickCount64();
     running_.store(true, std::memory_order_release);
 
     HRESULT hr = audio_client_->Start();
@@ -167,6 +217,12 @@ void AudioEngine::stop() {
     }
     if (thread_.joinable()) {
         thread_.join();
+        const ULONGLONG ms = GetTickCount64() - started_ms_;
+        if (ms > 0) {
+            SR_LOG_INFO(L"[%s] %u capture wakeups in %.1f s (%.0f/s, %s)",
+                        mode_ == AudioCaptureMode::Loopback ? L"Loopback" : L"Microphone",
+                        wakeups(), ms / 1000.0, wakeups() * 1000.0 / ms, audio_latency_label(plan_.mode));
+        }
     }
     if (audio_client_) {
         audio_client_->Stop();
@@ -186,6 +242,31 @@ void AudioEngine::stop() {
     }
 }
 
+void AudioEngine::set_suspended(bool suspended) {
+    if (suspend_requested_.exchange(suspended, std::memory_order_acq_rel) == suspended) return;
+    // The capture thread owns the client; wake it to stop or restart the stream
+    if (event_handle_) SetEvent(event_handle_);
+}
+
+bool AudioEngine::apply_suspend_request() {
+    const bool want = suspend_requested_.load(std::memory_order_acquire);
+    if (want == suspended_) return suspended_;
+    if (want) {
+        // No buffer is held between GetBuffer/ReleaseBuffer here, so Reset is legal
+        audio_client_->Stop();
+        audio_client_->Reset();
+        suspended_ticks_ = QPCClock::ticks();
+    } else {
+        pts_anchor_100ns_ += QPCClock::instance().ticks_to_hns(QPCClock::ticks() - suspended_ticks_);
+        const HRESULT hr = audio_client_->Start();
+        if (FAILED(hr)) SR_LOG_WARN(L"IAudioClient::Start after pause failed: 0x%08X", hr);
+    }
+    suspended_ = want;
+    SR_LOG_INFO(L"[%s] capture %s", mode_ == AudioCaptureMode::Loopback ? L"Loopback" : L"Microphone",
+                want ? L"suspended" : L"resumed");
+    return suspended_;
+}
+
 void AudioEngine::capture_loop() {
     // Register with MMCSS for audio-class priority
     DWORD task_idx = 0;
@@ -204,11 +285,21 @@ void AudioEngine::capture_loop() {
 
     std::vector<uint8_t> resampled_buf;
     while (running_.load(std::memory_order_acquire)) {
-        DWORD wait_result = WaitForSingleObject(event_handle_, 200 /*ms timeout*/);
-        if (wait_result != WAIT_OBJECT_0) {
+        // Suspended: nothing signals the event but set_suspended() and stop()
+        if (apply_suspend_request()) {
+            WaitForSingleObject(event_handle_, INFINITE);
+            continue;
+        }
+        // Event-driven: the event is the buffer-ready signal (plan_.wait_ms is
+        // only a watchdog). Polled: the timeout is the wakeup and the event
+        // is stop().
+        DWORD wait_result = WaitForSingleObject(event_handle_, plan_.wait_ms);
+        if (plan_.event_driven ? wait_result != WAIT_OBJECT_0
+                               : wait_result != WAIT_TIMEOUT && wait_result != WAIT_OBJECT_0) {
             continue;
         }
         if (!running_.load(std::memory_order_acquire)) break;
+        wakeups_.fetch_add(1, std::memory_order_relaxed);
 
         // Drain all available packets
         UINT32 frames_available = 0;
@@ -230,68 +321,56 @@ void AudioEngine::capture_loop() {
 
             // Noise gate for microphone: compute RMS and gate if below threshold
             if (apply_noise_gate && !silence && data && byte_count > 0) {
+                const AudioLevels levels = measure_pcm_levels(data, byte_count, bits_per_sample_);
                 if (bits_per_sample_ == 32) {
-                    const float* samples = reinterpret_cast<const float*>(data);
-                    const size_t count = byte_count / sizeof(float);
-                    double sum_sq = 0.0;
-                    for (size_t i = 0; i < count; ++i) {
-                        sum_sq += static_cast<double>(samples[i]) * static_cast<double>(samples[i]);
-                    }
-                    float rms = count > 0 ? static_cast<float>(std::sqrt(sum_sq / static_cast<double>(count))) : 0.0f;
-                    if (rms < kNoiseGateThresholdFloat) {
-                        silence = true;
-                    }
+                    silence = levels.rms < kNoiseGateThresholdFloat;
                 } else if (bits_per_sample_ == 16) {
-                    const int16_t* samples = reinterpret_cast<const int16_t*>(data);
-                    const size_t count = byte_count / sizeof(int16_t);
-                    int64_t sum_sq = 0;
-                    for (size_t i = 0; i < count; ++i) {
-                        sum_sq += static_cast<int64_t>(samples[i]) * static_cast<int64_t>(samples[i]);
-                    }
-                    double rms = count > 0 ? std::sqrt(static_cast<double>(sum_sq) / static_cast<double>(count)) : 0.0;
-                    if (rms < static_cast<double>(kNoiseGateThresholdInt16)) {
-                        silence = true;
-                    }
+                    silence = levels.rms * mixer::kInt16FullScale
+                              < static_cast<float>(kNoiseGateThresholdInt16);
                 }
             }
 
             // T032: resample if native rate != 48 kHz
-            const uint8_t* pkt_data = nullptr;
+            const uint8_t* pkt_data = data;
             uint32_t       pkt_bytes = byte_count;
+            uint32_t       resampled_frames = frames_available;
 
-            if (!resampler_.is_passthrough() && !silence) {
-                resampled_buf.clear();
-                resampler_.process(data, byte_count, resampled_buf);
-                pkt_data  = resampled_buf.data();
-                pkt_bytes = static_cast<uint32_t>(resampled_buf.size());
+            if (silence) {
+                // Duration only: no PCM is stored, copied or mixed downstream
+                pkt_bytes = 0;
+                resampled_frames = static_cast<uint32_t>(
+                    static_cast<uint64_t>(frames_available) * sample_rate() / sample_rate_);
             } else {
-                pkt_data = data;
+                if (!resampler_.is_passthrough()) {
+                    resampled_buf.clear();
+                    resampler_.process(data, byte_count, resampled_buf);
+                    pkt_data  = resampled_buf.data();
+                    pkt_bytes = static_cast<uint32_t>(resampled_buf.size());
+                }
+                resampled_frames = block_align_ > 0 ? pkt_bytes / block_align_ : frames_available;
             }
 
-            uint32_t resampled_frames = (block_align_ > 0)
-                ? (pkt_bytes / block_align_)
-                : frames_available;
-
             AudioPacket pkt;
             pkt.frame_count  = resampled_frames;
             pkt.pts          = pts;
             pkt.sample_rate  = sample_rate();
             pkt.channels     = channels_;
-
-            pkt.buffer.resize(pkt_bytes);
-            if (silence) {
-                std::memset(pkt.buffer.data(), 0, pkt_bytes);
-                pkt.is_silence = true;
-            } else {
+            pkt.is_silence   = silence;
+            if (!silence) {
+                pkt.buffer.resize(pkt_bytes, &buffer_pool_);
                 std::memcpy(pkt.buffer.data(), pkt_data, pkt_bytes);
-                pkt.is_silence = false;
             }
 
             capture_client_->ReleaseBuffer(frames_available);
             sample_count_ += static_cast<int64_t>(frames_available);
 
-            if (queue_) {
-                queue_->try_push(std::move(pkt));
+            const trace::Track source = mode_ == AudioCaptureMode::Loopback
+                                            ? trace::Track::Loopback : trace::Track::Microphone;
+            if (queue_ && !queue_->try_push(std::move(pkt))) {
+                packets_dropped_.fetch_add(1, std::memory_order_relaxed);
+                trace::audio_dropped(source, pts, queue_->size());
+            } else if (queue_) {
+                trace::audio_packet(source, pts, resampled_frames, queue_->size(), silence);
             }
         }
     }
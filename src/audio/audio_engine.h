@@ -4,6 +4,7 @@
 // T032: Integrates AudioResampler for native-rate → 48 kHz conversion;
 //       IMMNotificationClient handles device invalidation/removal.
 // Supports both Microphone (eCapture) and System/Loopback (eRender) capture modes.
+// The buffer period and wakeup cadence follow an AudioLatencyMode (audio_latency.h).
 
 #include <windows.h>
 #include <mmdeviceapi.h>
@@ -14,6 +15,7 @@
 #include <functional>
 #include "utils/render_frame.h"
 #include "utils/bounded_queue.h"
+#include "audio/audio_latency.h"
 #include "audio/audio_resampler.h"
 
 namespace sr {
@@ -27,7 +29,7 @@ enum class AudioCaptureMode {
 };
 
 // 16-slot audio queue (audio runs at ~10ms packets, needs more headroom than video)
-using AudioQueue = BoundedQueue<AudioPacket, 16>;
+using AudioQueue = BoundedQueue<AudioPacket, 16, SingleProducer>;  // one capture thread per engine
 
 // Device-invalidation callback type — called when the audio device is removed
 // or invalidated (e.g., USB mic unplugged). If set, engine signals the caller
@@ -103,7 +105,15 @@ public:
     // Signal stop and join the capture thread
     void stop();
 
-    // Toggle mute: when muted, zeroed PCM is pushed instead of real audio
+    // Pause: the capture thread stops the WASAPI stream (and drops what it
+    // buffered) instead of capturing packets nobody keeps; resume restarts
+    // it. The sample clock skips the suspended time, so PTS keep the pause
+    // gap like the video session clock. Any thread; cleared by start().
+    void set_suspended(bool suspended);
+    bool is_suspended() const { return suspend_requested_.load(std::memory_order_relaxed); }
+
+    // Toggle mute: when muted, packets carry only their duration (no PCM),
+    // as for silent capture; the timeline stays continuous downstream
     void set_muted(bool muted) { muted_.store(muted, std::memory_order_relaxed); }
     bool is_muted()    const   { return muted_.load(std::memory_order_relaxed); }
 
@@ -113,6 +123,18 @@ public:
         device_invalid_cb_ = std::move(cb);
     }
 
+    // Resampler used when the device rate isn't 48 kHz; call before initialize()
+    void set_resampler_backend(ResamplerBackend backend) { resampler_backend_ = backend; }
+
+    // Buffer period / wakeup batching; call before initialize(). Auto must be
+    // resolved by the caller (PowerModeDetector) and is treated as Default.
+    void set_latency_mode(AudioLatencyMode mode) { latency_mode_ = mode; }
+    // Mode the stream was opened with (LowLatency falls back to Default)
+    AudioLatencyMode latency_mode() const { return plan_.mode; }
+
+    // Capture-thread wakeups since start()
+    uint32_t wakeups() const { return wakeups_.load(std::memory_order_relaxed); }
+
     // Audio format — always returns 48 kHz (resampled if device differs)
     uint32_t sample_rate()     const {
         return resampler_.is_passthrough() ? sample_rate_ : resampler_.output_rate();
@@ -123,11 +145,22 @@ public:
     // Native device rate (before resampling) — for diagnostics
     uint32_t native_sample_rate() const { return sample_rate_; }
 
+    // Packets discarded because the output queue was full
+    uint32_t packets_dropped() const { return packets_dropped_.load(std::memory_order_relaxed); }
+
+    // Packets that could not borrow a PCM block and used the heap instead
+    uint32_t buffer_pool_fallbacks() const { return buffer_pool_.fallbacks(); }
+
     // Set QPC anchor for PTS calculation (call just before start())
     void set_sync_anchor_100ns(int64_t anchor) { pts_anchor_100ns_ = anchor; }
 
 private:
     void capture_loop();
+    // Capture thread: apply a pending set_suspended(); true while suspended
+    bool apply_suspend_request();
+    // IAudioClient3 at the minimum shared period; false leaves the client to
+    // be re-activated for the IAudioClient::Initialize path
+    bool initialize_low_latency(const WAVEFORMATEX* format, DWORD stream_flags);
 
     ComPtr<IMMDeviceEnumerator>  enumerator_;
     ComPtr<IMMDevice>            device_;
@@ -141,8 +174,16 @@ private:
     uint32_t    bits_per_sample_= 16;
     uint32_t    block_align_    = 4;
 
-    // T032: MF Resampler for native-rate → 48 kHz conversion
+    // T032: resampler for native-rate → 48 kHz conversion
     AudioResampler             resampler_;
+    ResamplerBackend           resampler_backend_ = ResamplerBackend::Native;
+
+    AudioLatencyMode           latency_mode_ = AudioLatencyMode::Default;
+    AudioPeriodPlan            plan_;
+
+    // Slab that queued AudioPackets borrow their PCM storage from.
+    // Must outlive the packets — SessionController destroys its queues first.
+    PcmBlockPool               buffer_pool_;
 
     // T032: device-invalidation notification
     AudioDeviceInvalidCallback device_invalid_cb_;
@@ -151,6 +192,12 @@ private:
     AudioCaptureMode           mode_ = AudioCaptureMode::Microphone;
     std::atomic<bool> running_{ false };
     std::atomic<bool> muted_  { false };
+    std::atomic<uint32_t> packets_dropped_{ 0 };
+    std::atomic<uint32_t> wakeups_{ 0 };
+    std::atomic<bool> suspend_requested_{ false };
+    bool              suspended_       = false;   // capture thread only
+    int64_t           suspended_ticks_ = 0;       // QPC at the stream stop
+    ULONGLONG         started_ms_ = 0;
     std::thread       thread_;
 
     int64_t  pts_anchor_100ns_ = 0;   // 100ns epoch offset
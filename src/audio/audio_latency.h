@@ -0,0 +1,76 @@
+#pragma once
+// audio_latency.h — WASAPI buffer period / wakeup plan for AudioEngine
+//
+// Shared-mode event delivery wakes the capture thread once per engine period
+// (10 ms on most devices, ~100 wakeups/s per engine). PowerSaving drops the
+// event callback and drains the buffer on a kPowerSavingWakeMs timer instead,
+// which takes several periods per wakeup: ~25 wakeups/s, a 4x cut for laptop
+// sessions. LowLatency asks IAudioClient3 for the engine's minimum shared
+// period (e.g. 2.67 ms at 48 kHz) for live monitoring. Auto is resolved by
+// PowerModeDetector: Default on AC, PowerSaving on battery.
+//
+// Sample timestamps come from the frame count, so none of the modes changes
+// A/V sync; they only trade wakeups against capture latency.
+
+#include <cstdint>
+
+namespace sr {
+
+enum class AudioLatencyMode : uint8_t {
+    Default,      // event-driven at the default period, 100 ms buffer
+    PowerSaving,  // polled every kPowerSavingWakeMs
+    LowLatency,   // IAudioClient3 minimum period (microphone only), event-driven
+    Auto,         // PowerModeDetector: Default on AC, PowerSaving on battery
+};
+
+inline const wchar_t* audio_latency_label(AudioLatencyMode mode) {
+    switch (mode) {
+        case AudioLatencyMode::Default:     return L"default";
+        case AudioLatencyMode::PowerSaving: return L"power-saving";
+        case AudioLatencyMode::LowLatency:  return L"low-latency";
+        case AudioLatencyMode::Auto:        return L"auto";
+    }
+    return L"?";
+}
+
+constexpr uint32_t kPowerSavingWakeMs = 40;
+
+struct AudioPeriodPlan {
+    AudioLatencyMode mode = AudioLatencyMode::Default;  // what was actually planned
+    bool     event_driven  = true;        // AUDCLNT_STREAMFLAGS_EVENTCALLBACK
+    bool     shared_stream = false;       // IAudioClient3::InitializeSharedAudioStream
+    int64_t  buffer_100ns  = 1'000'000;   // IAudioClient::Initialize buffer
+    uint32_t period_frames = 0;           // shared_stream only
+    uint32_t wait_ms       = 200;         // event watchdog, or the poll interval
+};
+
+// `min_period_frames` = IAudioClient3::GetSharedModeEnginePeriod minimum
+// (0 when the device or OS has no IAudioClient3); LowLatency without it and
+// an unresolved Auto plan as Default
+inline AudioPeriodPlan plan_audio_period(AudioLatencyMode mode, uint32_t min_period_frames) {
+    AudioPeriodPlan plan;
+    if (mode == AudioLatencyMode::PowerSaving) {
+        plan.mode         = mode;
+        plan.event_driven = false;
+        // Room for five wakeups' worth: a late timer never overruns the buffer
+        plan.buffer_100ns = int64_t{ kPowerSavingWakeMs } * 5 * 10'000;
+        plan.wait_ms      = kPowerSavingWakeMs;
+    } else if (mode == AudioLatencyMode::LowLatency && min_period_frames > 0) {
+        plan.mode          = mode;
+        plan.shared_stream = true;
+        plan.period_frames = min_period_frames;
+    }
+    return plan;
+}
+
+// Capture thread wakeups per second the plan targets at `device_period_100ns`
+inline uint32_t audio_wakeups_per_second(const AudioPeriodPlan& plan, int64_t device_period_100ns,
+                                         uint32_t sample_rate) {
+    if (!plan.event_driven) return 1000 / plan.wait_ms;
+    if (plan.shared_stream && sample_rate > 0) {
+        return plan.period_frames > 0 ? sample_rate / plan.period_frames : 0;
+    }
+    return device_period_100ns > 0 ? static_cast<uint32_t>(10'000'000 / device_period_100ns) : 0;
+}
+
+} // namespace sr
@@ -1,40 +1,597 @@
 #pragma once
+// audio_mixer.h — PCM mixing and level-measurement kernels
+//
+// Used by the audio-mix stage (mic + loopback, or any number of sources) and
+// by the microphone noise gate. Every kernel has a scalar reference
+// implementation plus SSE2 and AVX2 variants; the public entry points pick the
+// widest instruction set the CPU supports once, at first use.
+//
+//   mix_add_float  : dst = clamp(dst + src * gain, -1, 1)
+//   mix_add_int16  : dst = sat16(dst + sat16(src * gain))
+//   apply_gain_*   : dst = clamp/sat(dst * gain)
+//   measure_*      : RMS and peak, normalized to full scale [0, 1]
+//
+// Gains are expected in [0, 8]. Mixing is sequential and clips after every
+// source, matching the previous two-source behaviour.
 
-#include "utils/render_frame.h"
-
-#include <cstdint>
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
 #include <cstdlib>
-#include <limits>
-#include <optional>
-#include <vector>
+#include <cstdint>
+#include <cstring>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define SR_MIXER_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define SR_MIXER_TARGET_SSE2
+#define SR_MIXER_TARGET_AVX2
+#else
+#include <cpuid.h>
+#define SR_MIXER_TARGET_SSE2 __attribute__((target("sse2")))
+#define SR_MIXER_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
 
 namespace sr {
 
-inline std::optional<size_t> find_loopback_mix_candidate(
-    const AudioPacket& mic,
-    const std::vector<AudioPacket>& loopback_packets,
-    int64_t tolerance_100ns) {
-
-    std::optional<size_t> best_index;
-    int64_t best_delta = std::numeric_limits<int64_t>::max();
-
-    for (size_t i = 0; i < loopback_packets.size(); ++i) {
-        const auto& candidate = loopback_packets[i];
-        if (candidate.is_silence ||
-            candidate.buffer.size() != mic.buffer.size() ||
-            candidate.sample_rate != mic.sample_rate ||
-            candidate.channels != mic.channels) {
-            continue;
+// RMS and peak of a block, both relative to full scale
+struct AudioLevels {
+    float rms  = 0.0f;
+    float peak = 0.0f;
+};
+
+enum class MixerIsa { Scalar, Sse2, Avx2 };
+
+namespace mixer {
+
+constexpr float kInt16FullScale = 32768.0f;
+
+// -------------------------------------------------------------------
+// Scalar reference kernels — also handle the tails of the SIMD loops
+// -------------------------------------------------------------------
+namespace scalar {
+
+inline int16_t sat16(int32_t v) {
+    return static_cast<int16_t>(std::clamp<int32_t>(v, -32768, 32767));
+}
+
+// Round-to-nearest-even, matching cvtps2dq under the default MXCSR
+inline int16_t scale16(int16_t v, float gain) {
+    const float scaled = static_cast<float>(v) * gain;
+    return sat16(static_cast<int32_t>(std::nearbyint(scaled)));
+}
+
+inline void mix_add_float(float* dst, const float* src, size_t count, float gain) {
+    for (size_t i = 0; i < count; ++i) {
+        dst[i] = std::min(std::max(dst[i] + src[i] * gain, -1.0f), 1.0f);
+    }
+}
+
+inline void mix_add_int16(int16_t* dst, const int16_t* src, size_t count, float gain) {
+    if (gain == 1.0f) {
+        for (size_t i = 0; i < count; ++i) {
+            dst[i] = sat16(static_cast<int32_t>(dst[i]) + static_cast<int32_t>(src[i]));
         }
+        return;
+    }
+    for (size_t i = 0; i < count; ++i) {
+        dst[i] = sat16(static_cast<int32_t>(dst[i]) + static_cast<int32_t>(scale16(src[i], gain)));
+    }
+}
+
+inline void apply_gain_float(float* dst, size_t count, float gain) {
+    for (size_t i = 0; i < count; ++i) {
+        dst[i] = std::min(std::max(dst[i] * gain, -1.0f), 1.0f);
+    }
+}
+
+inline void apply_gain_int16(int16_t* dst, size_t count, float gain) {
+    for (size_t i = 0; i < count; ++i) dst[i] = scale16(dst[i], gain);
+}
+
+inline AudioLevels measure_float(const float* src, size_t count) {
+    AudioLevels out;
+    if (count == 0) return out;
+    double sum_sq = 0.0;
+    float peak = 0.0f;
+    for (size_t i = 0; i < count; ++i) {
+        sum_sq += static_cast<double>(src[i]) * static_cast<double>(src[i]);
+        peak = std::max(peak, std::fabs(src[i]));
+    }
+    out.rms  = static_cast<float>(std::sqrt(sum_sq / static_cast<double>(count)));
+    out.peak = peak;
+    return out;
+}
+
+inline AudioLevels measure_int16(const int16_t* src, size_t count) {
+    AudioLevels out;
+    if (count == 0) return out;
+    uint64_t sum_sq = 0;
+    int32_t peak = 0;
+    for (size_t i = 0; i < count; ++i) {
+        const int32_t v = src[i];
+        sum_sq += static_cast<uint64_t>(v * v);
+        peak = std::max(peak, std::abs(v));
+    }
+    out.rms  = static_cast<float>(std::sqrt(static_cast<double>(sum_sq) / static_cast<double>(count))
+                                  / kInt16FullScale);
+    out.peak = static_cast<float>(peak) / kInt16FullScale;
+    return out;
+}
+
+} // namespace scalar
 
-        const int64_t delta = std::llabs(candidate.pts - mic.pts);
-        if (delta <= tolerance_100ns && delta < best_delta) {
-            best_delta = delta;
-            best_index = i;
+#if defined(SR_MIXER_X86)
+
+// -------------------------------------------------------------------
+// SSE2 — baseline on every x64 CPU
+// -------------------------------------------------------------------
+namespace sse2 {
+
+SR_MIXER_TARGET_SSE2
+inline void mix_add_float(float* dst, const float* src, size_t count, float gain) {
+    const __m128 g  = _mm_set1_ps(gain);
+    const __m128 lo = _mm_set1_ps(-1.0f);
+    const __m128 hi = _mm_set1_ps(1.0f);
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128 v = _mm_add_ps(_mm_loadu_ps(dst + i), _mm_mul_ps(_mm_loadu_ps(src + i), g));
+        _mm_storeu_ps(dst + i, _mm_min_ps(_mm_max_ps(v, lo), hi));
+    }
+    scalar::mix_add_float(dst + i, src + i, count - i, gain);
+}
+
+// Scale 8 int16 lanes by gain with int16 saturation
+SR_MIXER_TARGET_SSE2
+inline __m128i scale16(__m128i v, __m128 g) {
+    const __m128i lo32 = _mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16);
+    const __m128i hi32 = _mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16);
+    const __m128i lo = _mm_cvtps_epi32(_mm_mul_ps(_mm_cvtepi32_ps(lo32), g));
+    const __m128i hi = _mm_cvtps_epi32(_mm_mul_ps(_mm_cvtepi32_ps(hi32), g));
+    return _mm_packs_epi32(lo, hi);
+}
+
+SR_MIXER_TARGET_SSE2
+inline void mix_add_int16(int16_t* dst, const int16_t* src, size_t count, float gain) {
+    size_t i = 0;
+    if (gain == 1.0f) {
+        for (; i + 8 <= count; i += 8) {
+            const __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + i));
+            const __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_adds_epi16(d, s));
+        }
+    } else {
+        const __m128 g = _mm_set1_ps(gain);
+        for (; i + 8 <= count; i += 8) {
+            const __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + i));
+            const __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_adds_epi16(d, scale16(s, g)));
         }
     }
+    scalar::mix_add_int16(dst + i, src + i, count - i, gain);
+}
+
+SR_MIXER_TARGET_SSE2
+inline void apply_gain_float(float* dst, size_t count, float gain) {
+    const __m128 g  = _mm_set1_ps(gain);
+    const __m128 lo = _mm_set1_ps(-1.0f);
+    const __m128 hi = _mm_set1_ps(1.0f);
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const __m128 v = _mm_mul_ps(_mm_loadu_ps(dst + i), g);
+        _mm_storeu_ps(dst + i, _mm_min_ps(_mm_max_ps(v, lo), hi));
+    }
+    scalar::apply_gain_float(dst + i, count - i, gain);
+}
+
+SR_MIXER_TARGET_SSE2
+inline void apply_gain_int16(int16_t* dst, size_t count, float gain) {
+    const __m128 g = _mm_set1_ps(gain);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), scale16(d, g));
+    }
+    scalar::apply_gain_int16(dst + i, count - i, gain);
+}
+
+SR_MIXER_TARGET_SSE2
+inline AudioLevels measure_float(const float* src, size_t count) {
+    if (count < 4) return scalar::measure_float(src, count);
+    const __m128 abs_mask = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+    __m128d sum_lo = _mm_setzero_pd();
+    __m128d sum_hi = _mm_setzero_pd();
+    __m128  peak   = _mm_setzero_ps();
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const __m128 v = _mm_loadu_ps(src + i);
+        const __m128d vlo = _mm_cvtps_pd(v);
+        const __m128d vhi = _mm_cvtps_pd(_mm_movehl_ps(v, v));
+        sum_lo = _mm_add_pd(sum_lo, _mm_mul_pd(vlo, vlo));
+        sum_hi = _mm_add_pd(sum_hi, _mm_mul_pd(vhi, vhi));
+        peak   = _mm_max_ps(peak, _mm_and_ps(v, abs_mask));
+    }
+    alignas(16) double sums[2];
+    alignas(16) float  peaks[4];
+    _mm_store_pd(sums, _mm_add_pd(sum_lo, sum_hi));
+    _mm_store_ps(peaks, peak);
+    double sum_sq = sums[0] + sums[1];
+    float  pk = std::max(std::max(peaks[0], peaks[1]), std::max(peaks[2], peaks[3]));
+    for (; i < count; ++i) {
+        sum_sq += static_cast<double>(src[i]) * static_cast<double>(src[i]);
+        pk = std::max(pk, std::fabs(src[i]));
+    }
+    AudioLevels out;
+    out.rms  = static_cast<float>(std::sqrt(sum_sq / static_cast<double>(count)));
+    out.peak = pk;
+    return out;
+}
+
+SR_MIXER_TARGET_SSE2
+inline AudioLevels measure_int16(const int16_t* src, size_t count) {
+    if (count < 8) return scalar::measure_int16(src, count);
+    // madd yields pairwise sums of squares; (-32768)^2 * 2 == 2^31 only fits
+    // unsigned, so the lanes are widened to 64 bits as unsigned values.
+    const __m128i zero = _mm_setzero_si128();
+    __m128i sum  = _mm_setzero_si128();
+    __m128i vmax = _mm_set1_epi16(0);
+    __m128i vmin = _mm_set1_epi16(0);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const __m128i v  = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        const __m128i sq = _mm_madd_epi16(v, v);
+        sum  = _mm_add_epi64(sum, _mm_unpacklo_epi32(sq, zero));
+        sum  = _mm_add_epi64(sum, _mm_unpackhi_epi32(sq, zero));
+        vmax = _mm_max_epi16(vmax, v);
+        vmin = _mm_min_epi16(vmin, v);
+    }
+    alignas(16) uint64_t sums[2];
+    alignas(16) int16_t  maxs[8];
+    alignas(16) int16_t  mins[8];
+    _mm_store_si128(reinterpret_cast<__m128i*>(sums), sum);
+    _mm_store_si128(reinterpret_cast<__m128i*>(maxs), vmax);
+    _mm_store_si128(reinterpret_cast<__m128i*>(mins), vmin);
+    uint64_t sum_sq = sums[0] + sums[1];
+    int32_t  pk = 0;
+    for (int k = 0; k < 8; ++k) {
+        pk = std::max(pk, std::max<int32_t>(maxs[k], -static_cast<int32_t>(mins[k])));
+    }
+    for (; i < count; ++i) {
+        const int32_t v = src[i];
+        sum_sq += static_cast<uint64_t>(v * v);
+        pk = std::max(pk, std::abs(v));
+    }
+    AudioLevels out;
+    out.rms  = static_cast<float>(std::sqrt(static_cast<double>(sum_sq) / static_cast<double>(count))
+                                  / kInt16FullScale);
+    out.peak = static_cast<float>(pk) / kInt16FullScale;
+    return out;
+}
+
+} // namespace sse2
+
+// -------------------------------------------------------------------
+// AVX2 — selected at runtime when the CPU and OS support it
+// -------------------------------------------------------------------
+namespace avx2 {
+
+SR_MIXER_TARGET_AVX2
+inline void mix_add_float(float* dst, const float* src, size_t count, float gain) {
+    const __m256 g  = _mm256_set1_ps(gain);
+    const __m256 lo = _mm256_set1_ps(-1.0f);
+    const __m256 hi = _mm256_set1_ps(1.0f);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256 v = _mm256_add_ps(_mm256_loadu_ps(dst + i), _mm256_mul_ps(_mm256_loadu_ps(src + i), g));
+        _mm256_storeu_ps(dst + i, _mm256_min_ps(_mm256_max_ps(v, lo), hi));
+    }
+    scalar::mix_add_float(dst + i, src + i, count - i, gain);
+}
+
+// Scale 16 int16 lanes by gain with int16 saturation
+SR_MIXER_TARGET_AVX2
+inline __m256i scale16(__m256i v, __m256 g) {
+    const __m256i lo32 = _mm256_cvtepi16_epi32(_mm256_castsi256_si128(v));
+    const __m256i hi32 = _mm256_cvtepi16_epi32(_mm256_extracti128_si256(v, 1));
+    const __m256i lo = _mm256_cvtps_epi32(_mm256_mul_ps(_mm256_cvtepi32_ps(lo32), g));
+    const __m256i hi = _mm256_cvtps_epi32(_mm256_mul_ps(_mm256_cvtepi32_ps(hi32), g));
+    // packs works per 128-bit lane; restore sequential order
+    return _mm256_permute4x64_epi64(_mm256_packs_epi32(lo, hi), _MM_SHUFFLE(3, 1, 2, 0));
+}
 
-    return best_index;
+SR_MIXER_TARGET_AVX2
+inline void mix_add_int16(int16_t* dst, const int16_t* src, size_t count, float gain) {
+    size_t i = 0;
+    if (gain == 1.0f) {
+        for (; i + 16 <= count; i += 16) {
+            const __m256i d = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(dst + i));
+            const __m256i s = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_adds_epi16(d, s));
+        }
+    } else {
+        const __m256 g = _mm256_set1_ps(gain);
+        for (; i + 16 <= count; i += 16) {
+            const __m256i d = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(dst + i));
+            const __m256i s = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_adds_epi16(d, scale16(s, g)));
+        }
+    }
+    scalar::mix_add_int16(dst + i, src + i, count - i, gain);
+}
+
+SR_MIXER_TARGET_AVX2
+inline void apply_gain_float(float* dst, size_t count, float gain) {
+    const __m256 g  = _mm256_set1_ps(gain);
+    const __m256 lo = _mm256_set1_ps(-1.0f);
+    const __m256 hi = _mm256_set1_ps(1.0f);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const __m256 v = _mm256_mul_ps(_mm256_loadu_ps(dst + i), g);
+        _mm256_storeu_ps(dst + i, _mm256_min_ps(_mm256_max_ps(v, lo), hi));
+    }
+    scalar::apply_gain_float(dst + i, count - i, gain);
+}
+
+SR_MIXER_TARGET_AVX2
+inline void apply_gain_int16(int16_t* dst, size_t count, float gain) {
+    const __m256 g = _mm256_set1_ps(gain);
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        const __m256i d = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(dst + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), scale16(d, g));
+    }
+    scalar::apply_gain_int16(dst + i, count - i, gain);
+}
+
+SR_MIXER_TARGET_AVX2
+inline AudioLevels measure_float(const float* src, size_t count) {
+    if (count < 8) return scalar::measure_float(src, count);
+    const __m256 abs_mask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7FFFFFFF));
+    __m256d sum_lo = _mm256_setzero_pd();
+    __m256d sum_hi = _mm256_setzero_pd();
+    __m256  peak   = _mm256_setzero_ps();
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const __m256 v = _mm256_loadu_ps(src + i);
+        const __m256d vlo = _mm256_cvtps_pd(_mm256_castps256_ps128(v));
+        const __m256d vhi = _mm256_cvtps_pd(_mm256_extractf128_ps(v, 1));
+        sum_lo = _mm256_add_pd(sum_lo, _mm256_mul_pd(vlo, vlo));
+        sum_hi = _mm256_add_pd(sum_hi, _mm256_mul_pd(vhi, vhi));
+        peak   = _mm256_max_ps(peak, _mm256_and_ps(v, abs_mask));
+    }
+    alignas(32) double sums[4];
+    alignas(32) float  peaks[8];
+    _mm256_store_pd(sums, _mm256_add_pd(sum_lo, sum_hi));
+    _mm256_store_ps(peaks, peak);
+    double sum_sq = (sums[0] + sums[1]) + (sums[2] + sums[3]);
+    float  pk = 0.0f;
+    for (int k = 0; k < 8; ++k) pk = std::max(pk, peaks[k]);
+    for (; i < count; ++i) {
+        sum_sq += static_cast<double>(src[i]) * static_cast<double>(src[i]);
+        pk = std::max(pk, std::fabs(src[i]));
+    }
+    AudioLevels out;
+    out.rms  = static_cast<float>(std::sqrt(sum_sq / static_cast<double>(count)));
+    out.peak = pk;
+    return out;
+}
+
+SR_MIXER_TARGET_AVX2
+inline AudioLevels measure_int16(const int16_t* src, size_t count) {
+    if (count < 16) return scalar::measure_int16(src, count);
+    const __m256i zero = _mm256_setzero_si256();
+    __m256i sum  = _mm256_setzero_si256();
+    __m256i vmax = _mm256_setzero_si256();
+    __m256i vmin = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        const __m256i v  = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+        const __m256i sq = _mm256_madd_epi16(v, v);
+        sum  = _mm256_add_epi64(sum, _mm256_unpacklo_epi32(sq, zero));
+        sum  = _mm256_add_epi64(sum, _mm256_unpackhi_epi32(sq, zero));
+        vmax = _mm256_max_epi16(vmax, v);
+        vmin = _mm256_min_epi16(vmin, v);
+    }
+    alignas(32) uint64_t sums[4];
+    alignas(32) int16_t  maxs[16];
+    alignas(32) int16_t  mins[16];
+    _mm256_store_si256(reinterpret_cast<__m256i*>(sums), sum);
+    _mm256_store_si256(reinterpret_cast<__m256i*>(maxs), vmax);
+    _mm256_store_si256(reinterpret_cast<__m256i*>(mins), vmin);
+    uint64_t sum_sq = sums[0] + sums[1] + sums[2] + sums[3];
+    int32_t  pk = 0;
+    for (int k = 0; k < 16; ++k) {
+        pk = std::max(pk, std::max<int32_t>(maxs[k], -static_cast<int32_t>(mins[k])));
+    }
+    for (; i < count; ++i) {
+        const int32_t v = src[i];
+        sum_sq += static_cast<uint64_t>(v * v);
+        pk = std::max(pk, std::abs(v));
+    }
+    AudioLevels out;
+    out.rms  = static_cast<float>(std::sqrt(static_cast<double>(sum_sq) / static_cast<double>(count))
+                                  / kInt16FullScale);
+    out.peak = static_cast<float>(pk) / kInt16FullScale;
+    return out;
+}
+
+} // namespace avx2
+
+// AVX2 needs CPU support plus OS-enabled YMM state (XCR0 bits 1 and 2)
+inline bool cpu_has_avx2() {
+#if defined(_MSC_VER)
+    int regs[4] = {};
+    __cpuid(regs, 0);
+    if (regs[0] < 7) return false;
+    __cpuid(regs, 1);
+    const bool osxsave = (regs[2] & (1 << 27)) != 0;
+    const bool avx     = (regs[2] & (1 << 28)) != 0;
+    if (!osxsave || !avx) return false;
+    if ((_xgetbv(0) & 0x6) != 0x6) return false;
+    __cpuidex(regs, 7, 0);
+    return (regs[1] & (1 << 5)) != 0;
+#else
+    unsigned int eax = 0, ebx = 0, ecx = 0, edx = 0;
+    if (__get_cpuid_max(0, nullptr) < 7) return false;
+    __get_cpuid(1, &eax, &ebx, &ecx, &edx);
+    const bool osxsave = (ecx & (1u << 27)) != 0;
+    const bool avx     = (ecx & (1u << 28)) != 0;
+    if (!osxsave || !avx) return false;
+    unsigned int xcr0_lo = 0, xcr0_hi = 0;
+    __asm__ volatile("xgetbv" : "=a"(xcr0_lo), "=d"(xcr0_hi) : "c"(0));
+    if ((xcr0_lo & 0x6) != 0x6) return false;
+    __get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx);
+    return (ebx & (1u << 5)) != 0;
+#endif
+}
+
+#endif // SR_MIXER_X86
+
+inline MixerIsa detect_isa() {
+#if defined(SR_MIXER_X86)
+    return cpu_has_avx2() ? MixerIsa::Avx2 : MixerIsa::Sse2;
+#else
+    return MixerIsa::Scalar;
+#endif
+}
+
+} // namespace mixer
+
+// Instruction set used by the dispatching kernels below (resolved once)
+inline MixerIsa mixer_isa() {
+    static const MixerIsa isa = mixer::detect_isa();
+    return isa;
+}
+
+inline void mix_add_float(float* dst, const float* src, size_t count, float gain = 1.0f) {
+#if defined(SR_MIXER_X86)
+    switch (mixer_isa()) {
+    case MixerIsa::Avx2: mixer::avx2::mix_add_float(dst, src, count, gain); return;
+    case MixerIsa::Sse2: mixer::sse2::mix_add_float(dst, src, count, gain); return;
+    default: break;
+    }
+#endif
+    mixer::scalar::mix_add_float(dst, src, count, gain);
+}
+
+inline void mix_add_int16(int16_t* dst, const int16_t* src, size_t count, float gain = 1.0f) {
+#if defined(SR_MIXER_X86)
+    switch (mixer_isa()) {
+    case MixerIsa::Avx2: mixer::avx2::mix_add_int16(dst, src, count, gain); return;
+    case MixerIsa::Sse2: mixer::sse2::mix_add_int16(dst, src, count, gain); return;
+    default: break;
+    }
+#endif
+    mixer::scalar::mix_add_int16(dst, src, count, gain);
+}
+
+inline void apply_gain_float(float* dst, size_t count, float gain) {
+#if defined(SR_MIXER_X86)
+    switch (mixer_isa()) {
+    case MixerIsa::Avx2: mixer::avx2::apply_gain_float(dst, count, gain); return;
+    case MixerIsa::Sse2: mixer::sse2::apply_gain_float(dst, count, gain); return;
+    default: break;
+    }
+#endif
+    mixer::scalar::apply_gain_float(dst, count, gain);
+}
+
+inline void apply_gain_int16(int16_t* dst, size_t count, float gain) {
+#if defined(SR_MIXER_X86)
+    switch (mixer_isa()) {
+    case MixerIsa::Avx2: mixer::avx2::apply_gain_int16(dst, count, gain); return;
+    case MixerIsa::Sse2: mixer::sse2::apply_gain_int16(dst, count, gain); return;
+    default: break;
+    }
+#endif
+    mixer::scalar::apply_gain_int16(dst, count, gain);
+}
+
+inline AudioLevels measure_levels_float(const float* src, size_t count) {
+#if defined(SR_MIXER_X86)
+    switch (mixer_isa()) {
+    case MixerIsa::Avx2: return mixer::avx2::measure_float(src, count);
+    case MixerIsa::Sse2: return mixer::sse2::measure_float(src, count);
+    default: break;
+    }
+#endif
+    return mixer::scalar::measure_float(src, count);
+}
+
+inline AudioLevels measure_levels_int16(const int16_t* src, size_t count) {
+#if defined(SR_MIXER_X86)
+    switch (mixer_isa()) {
+    case MixerIsa::Avx2: return mixer::avx2::measure_int16(src, count);
+    case MixerIsa::Sse2: return mixer::sse2::measure_int16(src, count);
+    default: break;
+    }
+#endif
+    return mixer::scalar::measure_int16(src, count);
+}
+
+// -------------------------------------------------------------------
+// Byte-buffer helpers for the pipeline: PCM is float32 when
+// bits_per_sample == 32, otherwise int16.
+// -------------------------------------------------------------------
+
+// Levels of a raw PCM block (zeroed for unsupported sample formats)
+inline AudioLevels measure_pcm_levels(const uint8_t* data, size_t bytes, uint32_t bits_per_sample) {
+    if (!data || bytes == 0) return {};
+    if (bits_per_sample == 32) {
+        return measure_levels_float(reinterpret_cast<const float*>(data), bytes / sizeof(float));
+    }
+    if (bits_per_sample == 16) {
+        return measure_levels_int16(reinterpret_cast<const int16_t*>(data), bytes / sizeof(int16_t));
+    }
+    return {};
+}
+
+// dst += src * gain over `bytes` bytes of PCM
+inline void mix_pcm_into(uint8_t* dst, const uint8_t* src, size_t bytes,
+                         uint32_t bits_per_sample, float gain = 1.0f) {
+    if (bits_per_sample == 32) {
+        mix_add_float(reinterpret_cast<float*>(dst), reinterpret_cast<const float*>(src),
+                      bytes / sizeof(float), gain);
+    } else {
+        mix_add_int16(reinterpret_cast<int16_t*>(dst), reinterpret_cast<const int16_t*>(src),
+                      bytes / sizeof(int16_t), gain);
+    }
+}
+
+inline void apply_pcm_gain(uint8_t* dst, size_t bytes, uint32_t bits_per_sample, float gain) {
+    if (gain == 1.0f) return;
+    if (bits_per_sample == 32) {
+        apply_gain_float(reinterpret_cast<float*>(dst), bytes / sizeof(float), gain);
+    } else {
+        apply_gain_int16(reinterpret_cast<int16_t*>(dst), bytes / sizeof(int16_t), gain);
+    }
+}
+
+// One input to mix_pcm_sources; data must hold at least the mixed byte count
+struct PcmMixSource {
+    const uint8_t* data = nullptr;
+    float          gain = 1.0f;
+};
+
+// dst = sum of sources[i] * gain[i]. Null sources are skipped; with no
+// usable sources dst is zeroed.
+inline void mix_pcm_sources(uint8_t* dst, size_t bytes, uint32_t bits_per_sample,
+                            const PcmMixSource* sources, size_t source_count) {
+    bool first = true;
+    for (size_t i = 0; i < source_count; ++i) {
+        if (!sources[i].data) continue;
+        if (first) {
+            if (dst != sources[i].data) std::memmove(dst, sources[i].data, bytes);
+            apply_pcm_gain(dst, bytes, bits_per_sample, sources[i].gain);
+            first = false;
+        } else {
+            mix_pcm_into(dst, sources[i].data, bytes, bits_per_sample, sources[i].gain);
+        }
+    }
+    if (first && bytes > 0) std::memset(dst, 0, bytes);
 }
 
 } // namespace sr
@@ -1,7 +1,9 @@
 #pragma once
-// audio_resampler.h — MF Resampler MFT wrapper for sample-rate conversion
+// audio_resampler.h — Sample-rate conversion for the capture path
 // T032: Converts device native rate (e.g., 44.1 kHz) to 48 kHz AAC pipeline rate.
-// Uses CLSID_CResamplerMediaObject (wmcodecdsp) — high-quality SOXR-like resampler.
+// Two backends: the in-process PolyphaseResampler (default) and the
+// CLSID_CResamplerMediaObject MFT (wmcodecdsp), kept selectable for comparison
+// and as the fallback for ratios the native filter doesn't cover.
 
 #include <windows.h>
 #include <mfapi.h>
@@ -12,6 +14,7 @@
 #include <wrl/client.h>
 #include <vector>
 #include <cstdint>
+#include "audio/polyphase_resampler.h"
 #include "utils/logging.h"
 
 #pragma comment(lib, "mfplat.lib")
@@ -22,12 +25,20 @@ namespace sr {
 
 using Microsoft::WRL::ComPtr;
 
+enum class ResamplerBackend {
+    Native,          // PolyphaseResampler — no COM, no per-call allocation
+    MediaFoundation  // CLSID_CResamplerMediaObject
+};
+
+inline const wchar_t* resampler_backend_label(ResamplerBackend backend) {
+    return backend == ResamplerBackend::Native ? L"native" : L"MF";
+}
+
 // ---------------------------------------------------------------------------
 // AudioResampler
 // ---------------------------------------------------------------------------
-// Wraps the Windows Media Foundation Resampler MFT to perform PCM sample-rate
-// conversion from any native device rate to the 48 kHz required by the AAC
-// encoder pipeline.
+// Performs PCM sample-rate conversion from any native device rate to the
+// 48 kHz required by the AAC encoder pipeline, using either backend above.
 //
 // Usage:
 //   AudioResampler rs;
@@ -49,17 +60,21 @@ public:
     //   channels     — channel count (1 or 2)
     //   bits         — bits per sample (16 or 32)
     //   out_rate     — output sample rate (default 48000)
+    //   backend      — Native falls back to the MFT if the ratio is unsupported
     // Returns false if the device already runs at out_rate (no-op pass-through
     // is indicated by is_passthrough() == true).
     bool initialize(uint32_t in_rate,
                     uint16_t channels,
                     uint32_t bits,
-                    uint32_t out_rate = 48000)
+                    uint32_t out_rate = 48000,
+                    ResamplerBackend backend = ResamplerBackend::Native)
     {
+        shutdown();
         in_rate_  = in_rate;
         out_rate_ = out_rate;
         channels_ = channels;
         bits_     = bits;
+        backend_  = backend;
 
         // If rates match, operate as passthrough — no MFT needed.
         if (in_rate == out_rate) {
@@ -70,6 +85,16 @@ public:
 
         passthrough_ = false;
 
+        if (backend_ == ResamplerBackend::Native) {
+            if (native_.initialize(in_rate, out_rate, channels, bits)) {
+                SR_LOG_INFO(L"AudioResampler: native polyphase %u Hz -> %u Hz (L=%u, M=%u), %u ch, %u-bit",
+                            in_rate, out_rate, native_.phases(), native_.decimation(), channels, bits);
+                return true;
+            }
+            SR_LOG_WARN(L"AudioResampler: native resampler can't do %u -> %u Hz, using MF", in_rate, out_rate);
+            backend_ = ResamplerBackend::MediaFoundation;
+        }
+
         // --- Create Resampler MFT (CLSID_CResamplerMediaObject) ---
         HRESULT hr = CoCreateInstance(
             CLSID_CResamplerMediaObject,
@@ -133,6 +158,9 @@ public:
             out_pcm.insert(out_pcm.end(), in_data, in_data + in_bytes);
             return true;
         }
+        if (backend_ == ResamplerBackend::Native) {
+            return native_.process(in_data, in_bytes, out_pcm);
+        }
         if (!mft_) return false;
 
         // --- Wrap input in IMFMediaBuffer / IMFSample ---
@@ -163,7 +191,9 @@ public:
 
     // Drain remaining samples (call at end of recording or on device change)
     bool flush(std::vector<uint8_t>& out_pcm) {
-        if (passthrough_ || !mft_) return true;
+        if (passthrough_) return true;
+        if (backend_ == ResamplerBackend::Native) return native_.flush(out_pcm);
+        if (!mft_) return true;
 
         HRESULT hr = mft_->ProcessMessage(MFT_MESSAGE_COMMAND_DRAIN, 0);
         (void)hr;
@@ -180,6 +210,7 @@ public:
 
     // Accessors
     bool     is_passthrough() const { return passthrough_; }
+    ResamplerBackend backend() const { return backend_; }
     uint32_t input_rate()     const { return in_rate_; }
     uint32_t output_rate()    const { return out_rate_; }
     uint16_t channels()       const { return channels_; }
@@ -244,6 +275,8 @@ private:
     }
 
     ComPtr<IMFTransform> mft_;
+    PolyphaseResampler   native_;
+    ResamplerBackend     backend_ = ResamplerBackend::Native;
     uint32_t in_rate_          = 44100;
     uint32_t out_rate_         = 48000;
     uint16_t channels_         = 2;
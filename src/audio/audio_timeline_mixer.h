@@ -0,0 +1,310 @@
+#pragma once
+// audio_timeline_mixer.h — Sample-indexed ring mixer for mic + loopback audio
+//
+// With separate audio tracks each source gets its own single-source mixer;
+// advance_clock() keeps the system track on the mic track's timeline.
+//
+// Each source's packets are placed on a shared timeline keyed on sample
+// frame index (pts * sample_rate / 10^7) and accumulated into a ring buffer
+// with the audio_mixer.h kernels. Output is emitted as fixed-size blocks
+// (20 ms by default) regardless of how each device sizes its WASAPI packets.
+//
+// A block is emitted once every source seen so far has written past its end,
+// or once the newest data is `latency` ahead of it (a stalled or idle source
+// is then treated as silence). Placement rules per packet:
+//   - within kSnapFrames of the source's previous end: snapped contiguous
+//   - overlapping the source's own earlier data: the overlap is trimmed
+//   - behind the read head by <= latency: the late part is trimmed
+//   - behind by more (e.g. loopback resuming after WASAPI delivered nothing
+//     during silence): the source is re-timed to the read head
+//   - beyond the ring capacity: treated as a discontinuity and re-anchored
+//
+// Silence packets (mute, AUDCLNT_BUFFERFLAGS_SILENT, the noise gate) carry
+// no payload — only pts and frame_count — and just advance their source.
+// A block nothing audible was written into is emitted with `silent` set, so
+// the consumer can hand out a shared zero buffer instead of copying it; the
+// ring only clears blocks that were written.
+//
+// Not thread-safe — owned by the audio-mix stage.
+
+#include "audio/audio_mixer.h"
+#include "utils/render_frame.h"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace sr {
+
+class AudioTimelineMixer {
+public:
+    static constexpr size_t  kMaxSources = 4;
+    // Absorbs ±1 frame rounding jitter in pts -> frame conversion
+    static constexpr int64_t kSnapFrames = 2;
+
+    struct Format {
+        uint32_t sample_rate     = 48000;
+        uint16_t channels        = 2;
+        uint32_t bits_per_sample = 32;   // 32 = float32, 16 = int16
+    };
+
+    // View of one output block; data is only valid inside the drain() callback
+    struct Block {
+        const uint8_t* data     = nullptr;
+        size_t         bytes    = 0;
+        uint32_t       frames   = 0;
+        int64_t        pts      = 0;     // 100ns units
+        int64_t        duration = 0;     // 100ns units
+        bool           silent   = false; // all zeros: no source wrote into it
+    };
+
+    struct Stats {
+        uint64_t blocks_emitted   = 0;
+        uint64_t trimmed_frames   = 0;   // late or self-overlapping input discarded
+        uint32_t retimed          = 0;   // source shifted forward to the read head
+        uint32_t discontinuities  = 0;   // timeline re-anchored
+        uint32_t format_rejects   = 0;   // packets whose rate/channels didn't match
+    };
+
+    // Allocates the ring. capacity_ms is rounded up to whole blocks and must
+    // exceed latency_ms + block_ms.
+    bool configure(const Format& format, uint32_t block_ms = 20,
+                   uint32_t latency_ms = 100, uint32_t capacity_ms = 500) {
+        if (format.sample_rate == 0 || format.channels == 0 ||
+            (format.bits_per_sample != 32 && format.bits_per_sample != 16) ||
+            block_ms == 0 || capacity_ms <= latency_ms + block_ms) {
+            return false;
+        }
+        format_         = format;
+        block_align_    = static_cast<size_t>(format.channels) * (format.bits_per_sample / 8);
+        block_frames_   = static_cast<int64_t>(format.sample_rate) * block_ms / 1000;
+        latency_frames_ = static_cast<int64_t>(format.sample_rate) * latency_ms / 1000;
+        const int64_t wanted = static_cast<int64_t>(format.sample_rate) * capacity_ms / 1000;
+        capacity_frames_ = ((wanted + block_frames_ - 1) / block_frames_) * block_frames_;
+        ring_.assign(static_cast<size_t>(capacity_frames_) * block_align_, 0);
+        written_.assign(block_frames_ > 0 ? static_cast<size_t>(capacity_frames_ / block_frames_) : 0, 0);
+        stats_ = {};
+        reset();
+        return block_frames_ > 0;
+    }
+
+    // Accumulate a packet from `source` (0 .. kMaxSources-1). Returns false if
+    // the packet was rejected outright.
+    bool add(size_t source, const AudioPacket& pkt, float gain = 1.0f) {
+        if (source >= kMaxSources || ring_.empty()) return false;
+        if (pkt.sample_rate != format_.sample_rate || pkt.channels != format_.channels) {
+            ++stats_.format_rejects;
+            return false;
+        }
+        const int64_t frames = pkt.is_silence ? static_cast<int64_t>(pkt.frame_count)
+                                              : static_cast<int64_t>(pkt.buffer.size() / block_align_);
+        if (frames == 0) return true;
+
+        SourceState& src = sources_[source];
+        int64_t frame = pts_to_frame(pkt.pts) + src.offset;
+
+        if (!anchored_) anchor(frame);
+        if (src.seen && std::llabs(frame - src.written_end) <= kSnapFrames) {
+            frame = src.written_end;
+        }
+        if (frame + frames > read_frame_ + capacity_frames_) {
+            // Far ahead of everything buffered (e.g. resume) — start over here
+            ++stats_.discontinuities;
+            anchor(frame);
+        }
+
+        int64_t skip = 0;
+        if (frame < read_frame_) {
+            const int64_t late = read_frame_ - frame;
+            if (late > latency_frames_) {
+                src.offset += late;
+                frame = read_frame_;
+                ++stats_.retimed;
+            } else {
+                skip = late;
+            }
+        }
+        if (src.seen && frame + skip < src.written_end) {
+            skip = src.written_end - frame;
+        }
+        skip = std::min(skip, frames);
+        stats_.trimmed_frames += static_cast<uint64_t>(skip);
+
+        const int64_t start = frame + skip;
+        const int64_t count = frames - skip;
+        if (count > 0 && !pkt.is_silence) {
+            write(start, pkt.buffer.data() + static_cast<size_t>(skip) * block_align_, count, gain);
+        }
+
+        src.seen = true;
+        src.written_end = std::max(src.written_end, start + count);
+        newest_end_ = std::max(newest_end_, src.written_end);
+        return true;
+    }
+
+    // Follow an external clock (e.g. the mic track when system audio is muxed
+    // as its own track): frames before `pts` count as written, so an idle
+    // source reads as silence instead of stalling or compressing the
+    // timeline. Anchors an empty mixer at `pts`.
+    void advance_clock(int64_t pts) {
+        if (ring_.empty()) return;
+        const int64_t frame = pts_to_frame(pts);
+        if (!anchored_) {
+            anchor(frame);
+            return;
+        }
+        if (frame > read_frame_ + capacity_frames_) {
+            ++stats_.discontinuities;
+            anchor(frame);
+            return;
+        }
+        newest_end_ = std::max(newest_end_, frame);
+    }
+
+    // Emit every ready block through emit(const Block&); returns the count.
+    // flush = true emits everything buffered (the last block may be short)
+    // and leaves the mixer empty.
+    template <typename Emit>
+    size_t drain(Emit&& emit, bool flush = false) {
+        size_t emitted = 0;
+        while (anchored_ && read_frame_ < newest_end_) {
+            const int64_t block_end = read_frame_ + block_frames_;
+            int64_t frames = block_frames_;
+            if (flush) {
+                frames = std::min(block_frames_, newest_end_ - read_frame_);
+            } else if (!block_ready(block_end)) {
+                break;
+            }
+
+            const size_t offset = ring_offset(read_frame_);
+            Block block;
+            block.data     = ring_.data() + offset;
+            block.frames   = static_cast<uint32_t>(frames);
+            block.bytes    = static_cast<size_t>(frames) * block_align_;
+            block.pts      = frame_to_pts(read_frame_);
+            block.duration = frame_to_pts(read_frame_ + frames) - block.pts;
+            const size_t index = offset / block_align_ / static_cast<size_t>(block_frames_);
+            block.silent   = !written_[index];
+            emit(block);
+
+            if (written_[index]) {
+                std::memset(ring_.data() + offset, 0, block.bytes);
+                written_[index] = 0;
+            }
+            read_frame_ += frames;
+            ++stats_.blocks_emitted;
+            ++emitted;
+        }
+        if (flush) {
+            anchored_ = false;
+            for (auto& s : sources_) s.seen = false;
+        }
+        return emitted;
+    }
+
+    // Drop everything buffered and forget per-source timing
+    void reset() {
+        if (anchored_ && newest_end_ > read_frame_) clear_ring();
+        anchored_ = false;
+        read_frame_ = newest_end_ = anchor_frame_ = 0;
+        sources_ = {};
+    }
+
+    bool empty() const { return !anchored_ || newest_end_ <= read_frame_; }
+
+    // Frames buffered ahead of the read head
+    int64_t buffered_frames() const { return anchored_ ? newest_end_ - read_frame_ : 0; }
+
+    const Format& format()       const { return format_; }
+    uint32_t      block_frames() const { return static_cast<uint32_t>(block_frames_); }
+    const Stats&  stats()        const { return stats_; }
+
+private:
+    struct SourceState {
+        bool    seen        = false;
+        int64_t written_end = 0;   // one past the last frame this source wrote
+        int64_t offset      = 0;   // frames added to pts-derived positions (re-timing)
+    };
+
+    int64_t pts_to_frame(int64_t pts) const {
+        const int64_t rate = format_.sample_rate;
+        const int64_t num  = pts * rate;
+        return (num >= 0 ? num + 5'000'000 : num - 5'000'000) / 10'000'000;
+    }
+    int64_t frame_to_pts(int64_t frame) const {
+        return frame * 10'000'000 / static_cast<int64_t>(format_.sample_rate);
+    }
+
+    // Ring byte offset of a frame; blocks never straddle the wrap because the
+    // capacity is a whole number of blocks and the read head stays block-aligned.
+    size_t ring_offset(int64_t frame) const {
+        return static_cast<size_t>((frame - anchor_frame_) % capacity_frames_) * block_align_;
+    }
+
+    void anchor(int64_t frame) {
+        if (anchored_ && newest_end_ > read_frame_) clear_ring();
+        anchored_ = true;
+        anchor_frame_ = read_frame_ = newest_end_ = frame;
+        for (auto& s : sources_) {
+            s.seen = false;
+            s.written_end = frame;
+        }
+    }
+
+    bool block_ready(int64_t block_end) const {
+        if (newest_end_ >= block_end + latency_frames_) return true;
+        bool any = false;
+        for (const auto& s : sources_) {
+            if (!s.seen) continue;
+            if (s.written_end < block_end) return false;
+            any = true;
+        }
+        return any;
+    }
+
+    // Zero only the blocks something was written into
+    void clear_ring() {
+        const size_t block_bytes = static_cast<size_t>(block_frames_) * block_align_;
+        for (size_t i = 0; i < written_.size(); ++i) {
+            if (!written_[i]) continue;
+            std::memset(ring_.data() + i * block_bytes, 0, block_bytes);
+            written_[i] = 0;
+        }
+    }
+
+    void write(int64_t start, const uint8_t* data, int64_t count, float gain) {
+        while (count > 0) {
+            const int64_t ring_pos = (start - anchor_frame_) % capacity_frames_;
+            const int64_t run = std::min(count, capacity_frames_ - ring_pos);
+            for (int64_t b = ring_pos / block_frames_; b <= (ring_pos + run - 1) / block_frames_; ++b) {
+                written_[static_cast<size_t>(b)] = 1;
+            }
+            const size_t bytes = static_cast<size_t>(run) * block_align_;
+            mix_pcm_into(ring_.data() + static_cast<size_t>(ring_pos) * block_align_,
+                         data, bytes, format_.bits_per_sample, gain);
+            data  += bytes;
+            start += run;
+            count -= run;
+        }
+    }
+
+    Format  format_;
+    size_t  block_align_     = 0;
+    int64_t block_frames_    = 0;
+    int64_t latency_frames_  = 0;
+    int64_t capacity_frames_ = 0;
+    std::vector<uint8_t> ring_;
+    std::vector<uint8_t> written_;   // per ring block: holds mixed-in data
+
+    bool    anchored_     = false;
+    int64_t anchor_frame_ = 0;
+    int64_t read_frame_   = 0;   // next frame to emit
+    int64_t newest_end_   = 0;   // furthest frame written by any source
+    std::array<SourceState, kMaxSources> sources_{};
+    Stats   stats_;
+};
+
+} // namespace sr
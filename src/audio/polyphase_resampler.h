@@ -0,0 +1,275 @@
+#pragma once
+// polyphase_resampler.h — In-process windowed-sinc polyphase sample-rate converter
+//
+// Rational L/M resampler (44.1 -> 48 kHz is 160/147, 16 -> 48 kHz is 3/1).
+// A Kaiser-windowed sinc prototype is split into L phases of kTaps
+// coefficients when initialize() runs; each output sample is then a single
+// kTaps-long dot product per channel, vectorized with the audio_mixer.h ISA
+// dispatch (SSE2 / AVX2).
+//
+// Input is interleaved int16 or float32 PCM; output is the same format. The
+// filter is centred (no group delay): kTaps/2 input frames are held back for
+// lookahead until flush() pads the stream with silence.
+//
+// No COM / Media Foundation dependency — usable from unit tests directly.
+// Steady-state processing does not allocate once the internal buffers and the
+// caller's output vector have grown to their working size.
+
+#include "audio/audio_mixer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <numeric>
+#include <vector>
+
+namespace sr {
+
+namespace resample {
+
+// Dot product of kTaps-aligned float vectors (count must be a multiple of 8)
+inline float dot_scalar(const float* a, const float* b, size_t count) {
+    float acc[8] = {};
+    for (size_t i = 0; i < count; i += 8) {
+        for (size_t k = 0; k < 8; ++k) acc[k] += a[i + k] * b[i + k];
+    }
+    return ((acc[0] + acc[4]) + (acc[1] + acc[5])) + ((acc[2] + acc[6]) + (acc[3] + acc[7]));
+}
+
+#if defined(SR_MIXER_X86)
+
+SR_MIXER_TARGET_SSE2
+inline float dot_sse2(const float* a, const float* b, size_t count) {
+    __m128 acc0 = _mm_setzero_ps();
+    __m128 acc1 = _mm_setzero_ps();
+    for (size_t i = 0; i < count; i += 8) {
+        acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_loadu_ps(a + i),     _mm_loadu_ps(b + i)));
+        acc1 = _mm_add_ps(acc1, _mm_mul_ps(_mm_loadu_ps(a + i + 4), _mm_loadu_ps(b + i + 4)));
+    }
+    alignas(16) float lanes[4];
+    _mm_store_ps(lanes, _mm_add_ps(acc0, acc1));
+    return (lanes[0] + lanes[2]) + (lanes[1] + lanes[3]);
+}
+
+SR_MIXER_TARGET_AVX2
+inline float dot_avx2(const float* a, const float* b, size_t count) {
+    __m256 acc0 = _mm256_setzero_ps();
+    __m256 acc1 = _mm256_setzero_ps();
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        acc0 = _mm256_add_ps(acc0, _mm256_mul_ps(_mm256_loadu_ps(a + i),     _mm256_loadu_ps(b + i)));
+        acc1 = _mm256_add_ps(acc1, _mm256_mul_ps(_mm256_loadu_ps(a + i + 8), _mm256_loadu_ps(b + i + 8)));
+    }
+    for (; i < count; i += 8) {
+        acc0 = _mm256_add_ps(acc0, _mm256_mul_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i)));
+    }
+    const __m256 acc = _mm256_add_ps(acc0, acc1);
+    const __m128 sum4 = _mm_add_ps(_mm256_castps256_ps128(acc), _mm256_extractf128_ps(acc, 1));
+    alignas(16) float lanes[4];
+    _mm_store_ps(lanes, sum4);
+    return (lanes[0] + lanes[2]) + (lanes[1] + lanes[3]);
+}
+
+#endif // SR_MIXER_X86
+
+using DotFn = float (*)(const float*, const float*, size_t);
+
+inline DotFn select_dot(MixerIsa isa) {
+#if defined(SR_MIXER_X86)
+    if (isa == MixerIsa::Avx2) return &dot_avx2;
+    if (isa == MixerIsa::Sse2) return &dot_sse2;
+#else
+    (void)isa;
+#endif
+    return &dot_scalar;
+}
+
+// Zeroth-order modified Bessel function of the first kind (Kaiser window)
+inline double bessel_i0(double x) {
+    double sum = 1.0, term = 1.0;
+    const double half_sq = (x * 0.5) * (x * 0.5);
+    for (int k = 1; k < 64; ++k) {
+        term *= half_sq / (static_cast<double>(k) * static_cast<double>(k));
+        sum += term;
+        if (term < sum * 1e-12) break;
+    }
+    return sum;
+}
+
+} // namespace resample
+
+class PolyphaseResampler {
+public:
+    static constexpr size_t   kTaps      = 64;    // coefficients per phase
+    static constexpr uint32_t kMaxPhases = 1024;  // covers 8/11.025/22.05/44.1/88.2 kHz -> 48 kHz
+    static constexpr double   kKaiserBeta = 7.0;  // ~70 dB stopband
+    static constexpr double   kCutoff     = 0.91; // fraction of the lower Nyquist
+
+    // Returns false for unsupported formats, ratios needing > kMaxPhases
+    // phases, or decimation beyond 8:1.
+    bool initialize(uint32_t in_rate, uint32_t out_rate, uint16_t channels, uint32_t bits,
+                    MixerIsa isa = mixer_isa()) {
+        initialized_ = false;
+        if (in_rate == 0 || out_rate == 0 || channels == 0 || (bits != 16 && bits != 32)) {
+            return false;
+        }
+        const uint32_t g = std::gcd(in_rate, out_rate);
+        up_   = out_rate / g;
+        down_ = in_rate / g;
+        if (up_ > kMaxPhases || down_ > up_ * 8) return false;
+
+        in_rate_  = in_rate;
+        out_rate_ = out_rate;
+        channels_ = channels;
+        bits_     = bits;
+        dot_      = resample::select_dot(isa);
+        build_filter();
+
+        history_.assign(channels_, {});
+        for (auto& h : history_) h.reserve(kTaps * 4);
+        reset_stream();
+        initialized_ = true;
+        return true;
+    }
+
+    // Resample interleaved PCM; output frames are appended to out_pcm.
+    bool process(const uint8_t* in_data, size_t in_bytes, std::vector<uint8_t>& out_pcm) {
+        if (!initialized_) return false;
+        const size_t align = block_align();
+        const size_t frames = in_bytes / align;
+        if (frames == 0) return true;
+        append_input(in_data, frames);
+        produce(out_pcm);
+        return true;
+    }
+
+    // Emit the held-back tail and restart the stream
+    bool flush(std::vector<uint8_t>& out_pcm) {
+        if (!initialized_) return false;
+        for (auto& h : history_) h.insert(h.end(), kTaps / 2, 0.0f);
+        produce(out_pcm);
+        reset_stream();
+        return true;
+    }
+
+    bool     initialized()   const { return initialized_; }
+    uint32_t input_rate()    const { return in_rate_; }
+    uint32_t output_rate()   const { return out_rate_; }
+    uint32_t phases()        const { return up_; }
+    uint32_t decimation()    const { return down_; }
+    size_t   block_align()   const { return static_cast<size_t>(channels_) * (bits_ / 8); }
+
+private:
+    void build_filter() {
+        // Output n sits at input time t = n*M/L = i + p/L. Tap k of phase p
+        // multiplies x[i - kTaps/2 + 1 + k], i.e. offset u = p/L + kTaps/2 - 1 - k.
+        const double fc   = kCutoff * std::min(1.0, static_cast<double>(up_) / static_cast<double>(down_));
+        const double half = static_cast<double>(kTaps) / 2.0;
+        const double norm = resample::bessel_i0(kKaiserBeta);
+        constexpr double kPi = 3.14159265358979323846;
+
+        coeffs_.assign(static_cast<size_t>(up_) * kTaps, 0.0f);
+        for (uint32_t p = 0; p < up_; ++p) {
+            double sum = 0.0;
+            double taps[kTaps];
+            for (size_t k = 0; k < kTaps; ++k) {
+                const double u = static_cast<double>(p) / static_cast<double>(up_) + half - 1.0
+                               - static_cast<double>(k);
+                const double x = fc * u;
+                const double sinc = (std::fabs(x) < 1e-12) ? 1.0 : std::sin(kPi * x) / (kPi * x);
+                const double r = u / half;
+                const double window = (std::fabs(r) >= 1.0)
+                    ? 0.0
+                    : resample::bessel_i0(kKaiserBeta * std::sqrt(1.0 - r * r)) / norm;
+                taps[k] = fc * sinc * window;
+                sum += taps[k];
+            }
+            // Unity DC gain per phase avoids a fixed-pattern ripple at rate L
+            float* dst = coeffs_.data() + static_cast<size_t>(p) * kTaps;
+            for (size_t k = 0; k < kTaps; ++k) {
+                dst[k] = static_cast<float>(sum != 0.0 ? taps[k] / sum : 0.0);
+            }
+        }
+    }
+
+    void reset_stream() {
+        // kTaps/2 - 1 frames of leading silence centre the first output on input frame 0
+        for (auto& h : history_) h.assign(kTaps / 2 - 1, 0.0f);
+        pos_   = 0;
+        phase_ = 0;
+    }
+
+    void append_input(const uint8_t* data, size_t frames) {
+        for (size_t c = 0; c < channels_; ++c) {
+            auto& h = history_[c];
+            const size_t base = h.size();
+            h.resize(base + frames);
+            float* dst = h.data() + base;
+            if (bits_ == 32) {
+                const float* src = reinterpret_cast<const float*>(data) + c;
+                for (size_t i = 0; i < frames; ++i) dst[i] = src[i * channels_];
+            } else {
+                const int16_t* src = reinterpret_cast<const int16_t*>(data) + c;
+                for (size_t i = 0; i < frames; ++i) {
+                    dst[i] = static_cast<float>(src[i * channels_]) * (1.0f / mixer::kInt16FullScale);
+                }
+            }
+        }
+    }
+
+    void produce(std::vector<uint8_t>& out_pcm) {
+        const size_t size = history_[0].size();
+        if (size < pos_ + kTaps) return;
+
+        // Outputs whose window fits: pos_ + floor((phase_ + n*M) / L) <= size - kTaps
+        const uint64_t avail = size - kTaps - pos_;
+        const uint64_t count = ((avail + 1) * up_ - 1 - phase_) / down_ + 1;
+
+        const size_t align = block_align();
+        const size_t base  = out_pcm.size();
+        out_pcm.resize(base + static_cast<size_t>(count) * align);
+        uint8_t* out = out_pcm.data() + base;
+
+        for (uint64_t n = 0; n < count; ++n) {
+            const float* h = coeffs_.data() + static_cast<size_t>(phase_) * kTaps;
+            for (size_t c = 0; c < channels_; ++c) {
+                const float y = dot_(h, history_[c].data() + pos_, kTaps);
+                if (bits_ == 32) {
+                    reinterpret_cast<float*>(out)[c] = y;
+                } else {
+                    const float scaled = std::nearbyint(y * mixer::kInt16FullScale);
+                    reinterpret_cast<int16_t*>(out)[c] =
+                        static_cast<int16_t>(std::clamp(scaled, -32768.0f, 32767.0f));
+                }
+            }
+            out   += align;
+            phase_ += down_;
+            pos_   += phase_ / up_;
+            phase_ %= up_;
+        }
+
+        // Drop consumed input; keeps capacity so later calls don't allocate
+        for (auto& h : history_) {
+            h.erase(h.begin(), h.begin() + static_cast<std::ptrdiff_t>(pos_));
+        }
+        pos_ = 0;
+    }
+
+    bool     initialized_ = false;
+    uint32_t in_rate_  = 0;
+    uint32_t out_rate_ = 0;
+    uint16_t channels_ = 0;
+    uint32_t bits_     = 16;
+    uint32_t up_       = 1;   // L: interpolation factor / phase count
+    uint32_t down_     = 1;   // M: decimation factor
+    resample::DotFn dot_ = &resample::dot_scalar;
+
+    std::vector<float>              coeffs_;   // up_ x kTaps
+    std::vector<std::vector<float>> history_;  // planar input per channel
+    size_t   pos_   = 0;   // first tap's input index for the next output
+    uint32_t phase_ = 0;   // next output's phase (0 .. up_-1)
+};
+
+} // namespace sr
@@ -0,0 +1,121 @@
+#pragma once
+// camera_pip.h — Camera picture-in-picture composited into the NV12 output
+//
+// The camera preview thread posts each BGRX frame into a CameraMailbox
+// (latest wins, one copy). The capture engine uploads a new frame at most
+// once per conversion into a D3D11 texture and blends it as a second
+// D3D11_VIDEO_PROCESSOR_STREAM at pip_dest_rect, so the camera shows in the
+// recording whatever the preview window's z-order and costs no CPU scaling.
+//
+// pip_dest_rect is pure and the mailbox has no D3D dependency, so both are
+// unit-testable.
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <vector>
+#include "utils/dirty_region.h"
+
+namespace sr {
+
+enum class PipCorner : uint32_t { TopLeft = 0, TopRight = 1, BottomLeft = 2, BottomRight = 3 };
+
+struct PipLayout {
+    PipCorner corner     = PipCorner::BottomRight;
+    uint32_t  width_pct  = 25;  // PiP width, percent of the output width (5-50)
+    uint32_t  margin_pct = 2;   // gap to the edges, percent of the output width
+};
+
+// Where a cam_w x cam_h camera goes in an out_w x out_h output: aspect kept,
+// at most the full output height, even-aligned for NV12 chroma. Relative to
+// the output size, so the main and proxy outputs show the same layout.
+inline FrameRect pip_dest_rect(uint32_t cam_w, uint32_t cam_h, uint32_t out_w, uint32_t out_h,
+                               const PipLayout& layout) {
+    if (cam_w == 0 || cam_h == 0 || out_w < 2 || out_h < 2) return {};
+    const uint32_t pct = (std::clamp)(layout.width_pct, 5u, 50u);
+    uint32_t w = static_cast<uint32_t>(static_cast<uint64_t>(out_w) * pct / 100);
+    uint32_t h = static_cast<uint32_t>(static_cast<uint64_t>(w) * cam_h / cam_w);
+    if (h > out_h) {
+        h = out_h;
+        w = static_cast<uint32_t>(static_cast<uint64_t>(h) * cam_w / cam_h);
+    }
+    w &= ~1u;
+    h &= ~1u;
+    if (w == 0 || h == 0) return {};
+
+    const uint32_t margin = (static_cast<uint32_t>(static_cast<uint64_t>(out_w) * layout.margin_pct / 100)) & ~1u;
+    const bool right  = layout.corner == PipCorner::TopRight || layout.corner == PipCorner::BottomRight;
+    const bool bottom = layout.corner == PipCorner::BottomLeft || layout.corner == PipCorner::BottomRight;
+    const uint32_t mx = (std::min)(margin, (out_w - w) / 2 & ~1u);
+    const uint32_t my = (std::min)(margin, (out_h - h) / 2 & ~1u);
+    const uint32_t x  = right  ? ((out_w - w - mx) & ~1u) : mx;
+    const uint32_t y  = bottom ? ((out_h - h - my) & ~1u) : my;
+    return { x, y, x + w, y + h };
+}
+
+// Single-slot, latest-wins hand-off of camera frames between the camera
+// thread (post) and the capture thread (take). Buffers are swapped, so the
+// steady state allocates nothing.
+class CameraMailbox {
+public:
+    // Copy a top-down 32-bit BGRX frame; the X byte is forced opaque so the
+    // video processor never sees camera alpha. Any thread.
+    void post(const uint8_t* bgrx, uint32_t width, uint32_t height, size_t stride) {
+        if (!bgrx || width == 0 || height == 0 || stride < size_t{ width } * 4) return;
+        std::lock_guard<std::mutex> lock(mutex_);
+        const size_t row_bytes = size_t{ width } * 4;
+        pixels_.resize(row_bytes * height);
+        for (uint32_t row = 0; row < height; ++row) {
+            uint8_t* dst = pixels_.data() + row * row_bytes;
+            std::memcpy(dst, bgrx + row * stride, row_bytes);
+            for (size_t a = 3; a < row_bytes; a += 4) dst[a] = 0xFF;
+        }
+        width_  = width;
+        height_ = height;
+        ready_.store(true, std::memory_order_relaxed);
+        seq_.fetch_add(1, std::memory_order_release);
+    }
+
+    // Newest frame, when it is newer than `seq` (updated on success). The
+    // caller's previous buffer becomes the next post's storage.
+    bool take(std::vector<uint8_t>& pixels, uint32_t& width, uint32_t& height, uint64_t& seq) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        const uint64_t current = seq_.load(std::memory_order_relaxed);
+        if (current == seq || pixels_.empty()) return false;
+        pixels.swap(pixels_);
+        width  = width_;
+        height = height_;
+        seq    = current;
+        ready_.store(false, std::memory_order_relaxed);
+        return true;
+    }
+
+    uint64_t sequence() const { return seq_.load(std::memory_order_acquire); }
+
+    // take() would succeed: a frame newer than `seq` is waiting. Lock-free,
+    // for the capture thread's per-frame "anything to draw?" check.
+    bool pending(uint64_t seq) const {
+        return seq_.load(std::memory_order_acquire) != seq && ready_.load(std::memory_order_relaxed);
+    }
+
+    // Back to the initial state (sequence 0) for a new session's consumer
+    void clear() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        pixels_.clear();
+        width_ = height_ = 0;
+        ready_.store(false, std::memory_order_relaxed);
+        seq_.store(0, std::memory_order_release);
+    }
+
+private:
+    std::mutex            mutex_;
+    std::vector<uint8_t>  pixels_;
+    uint32_t              width_  = 0;
+    uint32_t              height_ = 0;
+    std::atomic<uint64_t> seq_{ 0 };
+    std::atomic<bool>     ready_{ false };  // pixels_ holds a frame not yet taken
+};
+
+} // namespace sr
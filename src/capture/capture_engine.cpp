@@ -2,22 +2,64 @@
 // T010/T011: WGC free-threaded frame pool, BGRA->NV12 conversion, push to BoundedQueue
 // T034: Dynamic resolution change detection — GPU scaler maintains fixed 1920x1080 output
 //        without resetting the encoder. VP is recreated on resolution change.
+// NV12 output textures form a SurfaceRing: a slot is only rewritten once every
+// RenderFrame / MF sample referencing it has been released.
+// Frames whose WGC dirty-region report is empty skip the VP blit, reuse the
+// last NV12 surface and are flagged RenderFrame::is_duplicate.
+// The capture item comes from a CaptureSource (monitor or window); window items
+// resize with the window, so the frame pool is recreated to follow them.
+// An optional source crop is applied via VideoProcessorSetStreamSourceRect so
+// cropping and scaling happen in one GPU pass.
+// A proxy target (second VP + NV12 ring) can take a low-res copy of every
+// frame from the same WGC surface for a lightweight review file.
+// With the cursor overlay, WGC captures without the cursor and CursorOverlay
+// draws it into each NV12 slot; a poll thread re-blits the held last frame
+// when only the cursor moved (RenderFrame::overlay_only).
+// Camera picture-in-picture: posted camera frames are uploaded to a texture
+// and blended as a second VP stream; a new camera frame alone also triggers
+// an overlay-only re-blit.
+// On an HDR monitor the pool delivers FP16 scRGB and HdrToneMapper replaces
+// the VideoProcessorBlt, tone-mapping straight into the NV12 planes.
+// With the frame tap on, each delivered main frame is also GPU-copied into a
+// shared keyed-mutex slot for external readers (FrameTap).
 
 // WinRT / WGC includes (kept in .cpp to isolate from header via PIMPL)
 #include <winrt/base.h>
 #include <winrt/Windows.Foundation.h>
+#include <winrt/Windows.Foundation.Collections.h>
+#include <winrt/Windows.Foundation.Metadata.h>
 #include <winrt/Windows.Graphics.Capture.h>
 #include <winrt/Windows.Graphics.DirectX.Direct3D11.h>
 #include <windows.graphics.capture.interop.h>
 #include <windows.graphics.directx.direct3d11.interop.h>
 
 #include "capture/capture_engine.h"
+#include "capture/surface_ring.h"
+#include "capture/camera_pip.h"
+#include "capture/capture_rate_gate.h"
+#include "capture/cursor_overlay.h"
+#include "capture/frame_tap.h"
+#include "capture/hdr_tonemap.h"
+#include "capture/nv12_compute.h"
 #include "utils/logging.h"
+#include "utils/qpc_clock.h"
+#include "utils/trace_events.h"
 
 #include <d3d11_1.h>
+#include <d3d11_4.h>   // ID3D11Fence, ID3D11DeviceContext4
 #include <dxgi1_2.h>
 #include <algorithm>
 #include <array>
+#include <mutex>
+#include <utility>
+
+// GraphicsCaptureSession::DirtyRegionMode / MinUpdateInterval and
+// Direct3D11CaptureFrame::DirtyRegions ship in the Windows 11 24H2 SDK
+// (10.0.26100); older SDKs build without them.
+#if defined(NTDDI_WIN11_GE) && defined(WDK_NTDDI_VERSION) && (WDK_NTDDI_VERSION >= NTDDI_WIN11_GE)
+#define SR_WGC_DIRTY_REGIONS 1
+#define SR_WGC_MIN_UPDATE_INTERVAL 1
+#endif
 
 namespace wgc  = winrt::Windows::Graphics::Capture;
 namespace wdx  = winrt::Windows::Graphics::DirectX;
@@ -26,14 +68,91 @@ using Microsoft::WRL::ComPtr;
 
 namespace sr {
 
+// ---------------------------------------------------------------------------
+// One NV12 output: its own video processor (fixed output size), texture ring
+// and frame queue. The primary target feeds the main encoder; the optional
+// proxy target is blitted from the same WGC surface at a lower resolution.
+// ---------------------------------------------------------------------------
+struct Nv12Target {
+    winrt::com_ptr<ID3D11VideoProcessorEnumerator> vp_enum;
+    winrt::com_ptr<ID3D11VideoProcessor>           vp;
+    // NV12 output ring; a slot is reused only after downstream released it.
+    std::array<winrt::com_ptr<ID3D11Texture2D>, SurfaceRing::kMaxSlots>                nv12_tex{};
+    std::array<winrt::com_ptr<ID3D11VideoProcessorOutputView>, SurfaceRing::kMaxSlots> vp_out_view{};
+    // Texture handed downstream: nv12_tex itself, or with an isolated capture
+    // device the consumer device's handle to the same shared surface
+    std::array<winrt::com_ptr<ID3D11Texture2D>, SurfaceRing::kMaxSlots> consumer_tex{};
+    std::array<ULONG, SurfaceRing::kMaxSlots> idle_refs{};  // consumer_tex refcount with no consumer holding the slot
+    std::array<uint64_t, SurfaceRing::kMaxSlots> fence_values{};  // fence value signalled after the slot's last blit
+    // Isolated device: the consumer's "reads done" fence (see GpuReleaseFence)
+    // and, per released slot, the acknowledgement it waits for (0 = none yet)
+    std::shared_ptr<GpuReleaseFence>             release;
+    winrt::com_ptr<ID3D11Fence>                  release_fence;   // own_device side of release->fence
+    std::array<uint64_t, SurfaceRing::kMaxSlots> release_needed{};
+    // Render target views of each slot's planes (cursor overlay / HDR pass)
+    std::array<Nv12PlaneViews, SurfaceRing::kMaxSlots> planes{};
+    // Unordered-access views of the same planes (compute converter)
+    std::array<Nv12PlaneUavs, SurfaceRing::kMaxSlots> uavs{};
+    CursorQuad  drawn_cursor;   // cursor drawn into the latest slot
+    UINT        vp_streams = 1; // MaxInputStreams: 2+ blends the camera in the main blit
+    FrameRect   camera_rect;    // camera PiP in output pixels
+    winrt::com_ptr<ID3D11VideoProcessorInputView> camera_in_view;
+    SurfaceRing ring;
+
+    // Cache VP input views for rotating frame-pool textures (usually 2).
+    // Input views are bound to the enumerator, so each target keeps its own.
+    std::array<winrt::com_ptr<ID3D11Texture2D>, 2>                cached_in_tex{};
+    std::array<winrt::com_ptr<ID3D11VideoProcessorInputView>, 2> cached_in_view{};
+    uint32_t next_in_cache_slot = 0;
+
+    uint32_t    out_width  = 0;   // fixed output width
+    uint32_t    out_height = 0;   // fixed output height
+    FrameQueue* queue      = nullptr;
+    bool        primary    = true;
+
+    void release() {
+        for (auto& view : vp_out_view)    { view = nullptr; }
+        for (auto& view : planes)         { view.reset(); }
+        for (auto& view : uavs)           { view.reset(); }
+        drawn_cursor = {};
+        camera_in_view = nullptr;
+        for (auto& tex  : consumer_tex)   { tex  = nullptr; }
+        for (auto& tex  : nv12_tex)       { tex  = nullptr; }
+        fence_values.fill(0);
+        release_needed.fill(0);
+        for (auto& tex  : cached_in_tex)  { tex  = nullptr; }
+        for (auto& view : cached_in_view) { view = nullptr; }
+        next_in_cache_slot = 0;
+        vp      = nullptr;
+        vp_enum = nullptr;
+    }
+};
+
 // ---------------------------------------------------------------------------
 // PIMPL implementation struct: holds all WinRT/D3D objects
 // ---------------------------------------------------------------------------
 struct CaptureEngineImpl {
-    // D3D objects (borrowed — not owned)
+    // D3D objects used for capture and conversion: the consumer's (borrowed)
+    // or, when isolated, own_device's
     ID3D11Device*        d3d_device  = nullptr;
     ID3D11DeviceContext* d3d_context = nullptr;
 
+    // Isolated capture device: WGC and the VideoProcessorBlt run on their own
+    // device and immediate context, so the capture thread never takes the
+    // encoder context's lock. NV12 slots are shared surfaces; a shared fence
+    // signalled after each blit lets the consumer wait on the GPU, and each
+    // target's release fence tells capture the consumer's reads have finished.
+    winrt::com_ptr<ID3D11Device>         own_device;
+    winrt::com_ptr<ID3D11DeviceContext>  own_context;
+    winrt::com_ptr<ID3D11DeviceContext4> own_context4;
+    winrt::com_ptr<ID3D11Fence>          fence;            // own_device side
+    winrt::com_ptr<ID3D11Fence>          consumer_fence;   // same fence, consumer device
+    winrt::com_ptr<ID3D11Device1>        consumer_device;  // opens the shared slots
+    uint64_t                             fence_value = 0;
+    bool                                 cross_adapter = false;  // own_device on another GPU
+
+    bool isolated() const { return own_device != nullptr; }
+
     // WinRT device wrapper
     wdx3::IDirect3DDevice winrt_device{ nullptr };
 
@@ -42,49 +161,100 @@ struct CaptureEngineImpl {
     wgc::Direct3D11CaptureFramePool frame_pool{ nullptr };
     wgc::GraphicsCaptureSession     session   { nullptr };
     winrt::event_token              frame_token{};
+    winrt::event_token              closed_token{};
+    winrt::Windows::Graphics::SizeInt32 pool_size{};  // frame-pool buffer size
+    std::atomic<bool>               source_closed{ false };
 
     // D3D11 Video Processor for BGRA->NV12
     winrt::com_ptr<ID3D11VideoDevice>              video_device;
     winrt::com_ptr<ID3D11VideoContext>             video_context;
-    winrt::com_ptr<ID3D11VideoProcessorEnumerator> vp_enum;
-    winrt::com_ptr<ID3D11VideoProcessor>           vp;
-    // Double-buffer NV12 output to reduce capture/encode contention.
-    std::array<winrt::com_ptr<ID3D11Texture2D>, 2>                nv12_tex{};
-    std::array<winrt::com_ptr<ID3D11VideoProcessorOutputView>, 2> vp_out_view{};
-    uint32_t write_idx_ = 0;
+    Nv12Target main_;              // full-quality output (encoder feed)
+    Nv12Target proxy_;             // optional low-res proxy (queue == nullptr: off)
+    uint32_t nv12_slots_   = 5;
+    uint32_t pool_buffers_ = 2;
+    bool     dirty_regions_ = false; // session reports per-frame dirty regions
+
+    // Cursor overlay. frame_mutex serializes the WGC callback with the cursor
+    // poll thread: both blit into the rings on the same context.
+    CursorOverlay cursor;
+    bool          want_cursor  = false;  // requested via set_cursor_overlay
+    bool          cursor_drawn = false;  // WGC cursor off, we draw it
+    HMONITOR      cursor_monitor = nullptr;
+    HWND          cursor_window  = nullptr;
+    std::mutex    frame_mutex;
+    wgc::Direct3D11CaptureFrame     last_frame{ nullptr };  // held for overlay-only re-blits
+    winrt::com_ptr<ID3D11Texture2D> last_bgra;
+    int64_t       last_pts = 0;
+    // Suspended: last_frame is the newest unconverted WGC frame (held even
+    // without overlays); the resume converts it
+    bool          parked   = false;
+
+    // Source-side rate limit: frames the encoder won't take are held, not
+    // converted (parked); flush_timer converts the newest one at the next
+    // grid slot unless a newer frame takes it. The turned-away frames'
+    // dirty regions join the next conversion's.
+    CaptureRateGate rate_gate;
+    PTP_TIMER       flush_timer     = nullptr;
+    DirtyRegion     skipped_dirty;
+    bool            skipped_changes = false;
+    bool            min_update_interval = false;  // WGC skips refreshes itself
+
+    // Camera PiP: frames from the parent's mailbox, uploaded under frame_mutex
+    bool                            camera_pip = false;
+    PipLayout                       pip_layout;
+    winrt::com_ptr<ID3D11Texture2D> camera_tex;
+    std::vector<uint8_t>            camera_pixels;
+    uint32_t                        camera_w   = 0;
+    uint32_t                        camera_h   = 0;
+    uint64_t                        camera_seq = 0;
+
+    // External frame tap (main output size; re-opened when it changes)
+    FrameTap tap;
+    bool     want_tap = false;
+
+    // The last WGC frame is kept for overlay-only re-blits
+    bool holds_last_frame() const { return cursor_drawn || camera_pip; }
+
+    // HDR monitor: FP16 frame pool, shader tone mapping instead of the VP
+    HdrToneMapper  tonemap;
+    HdrDisplayInfo hdr_display;
+    bool           want_hdr = false;
+    wdx::DirectXPixelFormat pool_format = wdx::DirectXPixelFormat::B8G8R8A8UIntNormalized;
+
+    wdx::DirectXPixelFormat wanted_pool_format() const {
+        return tonemap.ready() ? wdx::DirectXPixelFormat::R16G16B16A16Float
+                               : wdx::DirectXPixelFormat::B8G8R8A8UIntNormalized;
+    }
 
-    // Cache VP input views for rotating frame-pool textures (usually 2).
-    std::array<winrt::com_ptr<ID3D11Texture2D>, 2>                cached_in_tex{};
-    std::array<winrt::com_ptr<ID3D11VideoProcessorInputView>, 2> cached_in_view{};
-    uint32_t next_in_cache_slot_ = 0;
+    // BGRA -> NV12 through compute dispatches instead of the VP blit
+    // (nv12_converter.h); decided once per session by the first main-target
+    // setup. Tone mapping, when active, replaces both.
+    Nv12ComputeConverter nv12_compute;
+    Nv12ConverterMode    converter_mode     = Nv12ConverterMode::Auto;
+    Nv12ScaleFilter      scale_filter       = Nv12ScaleFilter::Bilinear;
+    bool                 converter_measured = false;
+    bool                 use_compute        = false;
+
+    bool compute_path() const { return use_compute && nv12_compute.ready() && !tonemap.ready(); }
 
     uint32_t vp_width    = 0;  // current VP input width
     uint32_t vp_height   = 0;  // current VP input height
-    uint32_t out_width_  = 0;  // fixed output width  (1920 or capture size)
-    uint32_t out_height_ = 0;  // fixed output height (1080 or capture size)
+    FrameRect crop_;           // requested source crop (empty = full surface)
+    FrameRect src_rect_;       // crop resolved against vp_width x vp_height
 
     // Back-pointer to parent
     CaptureEngine* parent          = nullptr;
-    FrameQueue*    queue           = nullptr;
-    int64_t        start_100ns     = 0;   // absolute 100ns at session start
-    LARGE_INTEGER  qpc_freq        = {};
+    int64_t        start_ticks     = 0;   // QPC ticks at session start
 
-    // -----------------------------------------------------------------------
-    // setup_video_processor — create D3D11 VP from in_w x in_h (BGRA) to
-    // out_w x out_h (NV12). Handles aspect-ratio-preserving GPU scaling
-    // when the source resolution differs from the target.
-    bool setup_video_processor(uint32_t in_w, uint32_t in_h,
-                               uint32_t out_w, uint32_t out_h) {
-        // Release old GPU objects so they can be recreated
-        for (auto& view : vp_out_view) { view = nullptr; }
-        for (auto& tex  : nv12_tex)    { tex  = nullptr; }
-        for (auto& tex  : cached_in_tex)  { tex  = nullptr; }
-        for (auto& view : cached_in_view) { view = nullptr; }
-        write_idx_ = 0;
-        next_in_cache_slot_ = 0;
-        vp.put();          vp          = nullptr;
-        vp_enum.put();     vp_enum     = nullptr;
+    bool proxy_enabled() const {
+        return proxy_.queue != nullptr && !parent->proxy_stopped_.load(std::memory_order_acquire);
+    }
 
+    // -----------------------------------------------------------------------
+    // setup_video_processor — create the D3D11 VP(s) from in_w x in_h (BGRA)
+    // to each target's fixed NV12 size. Handles aspect-ratio-preserving GPU
+    // scaling when the source resolution differs from the target.
+    bool setup_video_processor(uint32_t in_w, uint32_t in_h) {
         HRESULT hr;
         if (!video_device) {
             hr = d3d_device->QueryInterface(IID_PPV_ARGS(video_device.put()));
@@ -93,64 +263,409 @@ struct CaptureEngineImpl {
             if (FAILED(hr)) { SR_LOG_ERROR(L"QueryInterface(ID3D11VideoContext) failed: 0x%08X", hr); return false; }
         }
 
+        if (want_cursor && !cursor.ready() && !cursor.initialize(d3d_device)) {
+            SR_LOG_WARN(L"Cursor overlay unavailable — WGC draws the cursor");
+            want_cursor = false;
+        }
+        if (want_hdr && !tonemap.ready() && !tonemap.initialize(d3d_device, hdr_display)) {
+            SR_LOG_WARN(L"HDR tone mapping unavailable — capturing SDR BGRA");
+            want_hdr = false;
+        }
+        if (!converter_measured && converter_mode != Nv12ConverterMode::VideoProcessor &&
+            !tonemap.ready() && !nv12_compute.ready()) {
+            nv12_compute.initialize(d3d_device, scale_filter);
+        }
+
+        vp_width  = in_w;
+        vp_height = in_h;
+        src_rect_ = effective_source_rect(crop_, in_w, in_h);
+        if (!setup_target(main_, in_w, in_h)) return false;
+        if (proxy_enabled() && !setup_target(proxy_, in_w, in_h)) {
+            // The proxy is best effort: keep recording the main output
+            SR_LOG_WARN(L"Proxy video processor unavailable — proxy output disabled");
+            proxy_.release();
+            proxy_.queue = nullptr;
+        }
+        return true;
+    }
+
+    bool setup_target(Nv12Target& t, uint32_t in_w, uint32_t in_h) {
+        // Release old GPU objects so they can be recreated
+        t.release();
+
         D3D11_VIDEO_PROCESSOR_CONTENT_DESC vpcd{};
         vpcd.InputFrameFormat  = D3D11_VIDEO_FRAME_FORMAT_PROGRESSIVE;
         vpcd.InputWidth        = in_w;
         vpcd.InputHeight       = in_h;
-        vpcd.OutputWidth       = out_w;
-        vpcd.OutputHeight      = out_h;
+        vpcd.OutputWidth       = t.out_width;
+        vpcd.OutputHeight      = t.out_height;
         vpcd.Usage             = D3D11_VIDEO_USAGE_PLAYBACK_NORMAL;
 
-        hr = video_device->CreateVideoProcessorEnumerator(&vpcd, vp_enum.put());
+        HRESULT hr = video_device->CreateVideoProcessorEnumerator(&vpcd, t.vp_enum.put());
         if (FAILED(hr)) { SR_LOG_ERROR(L"CreateVideoProcessorEnumerator failed: 0x%08X", hr); return false; }
 
-        hr = video_device->CreateVideoProcessor(vp_enum.get(), 0, vp.put());
+        hr = video_device->CreateVideoProcessor(t.vp_enum.get(), 0, t.vp.put());
         if (FAILED(hr)) { SR_LOG_ERROR(L"CreateVideoProcessor failed: 0x%08X", hr); return false; }
+        D3D11_VIDEO_PROCESSOR_CAPS caps{};
+        t.vp_streams = SUCCEEDED(t.vp_enum->GetVideoProcessorCaps(&caps)) ? caps.MaxInputStreams : 1;
+        layout_camera(t);
+
+        // Full-range RGB in, BT.709 limited-range YCbCr out (the HDR pass and
+        // the cursor overlay use the same matrix)
+        D3D11_VIDEO_PROCESSOR_COLOR_SPACE in_cs{};
+        in_cs.RGB_Range = 0;
+        video_context->VideoProcessorSetStreamColorSpace(t.vp.get(), 0, &in_cs);
+        if (t.vp_streams >= 2) video_context->VideoProcessorSetStreamColorSpace(t.vp.get(), 1, &in_cs);
+        D3D11_VIDEO_PROCESSOR_COLOR_SPACE out_cs{};
+        out_cs.YCbCr_Matrix  = 1;
+        out_cs.Nominal_Range = D3D11_VIDEO_PROCESSOR_NOMINAL_RANGE_16_235;
+        video_context->VideoProcessorSetOutputColorSpace(t.vp.get(), &out_cs);
 
         // NV12 output texture — always at fixed output resolution
         D3D11_TEXTURE2D_DESC td{};
-        td.Width            = out_w;
-        td.Height           = out_h;
+        td.Width            = t.out_width;
+        td.Height           = t.out_height;
         td.MipLevels        = 1;
         td.ArraySize        = 1;
         td.Format           = DXGI_FORMAT_NV12;
         td.SampleDesc.Count = 1;
         td.Usage            = D3D11_USAGE_DEFAULT;
         td.BindFlags        = D3D11_BIND_RENDER_TARGET | D3D11_BIND_VIDEO_ENCODER;
+        if (isolated()) td.MiscFlags = D3D11_RESOURCE_MISC_SHARED | D3D11_RESOURCE_MISC_SHARED_NTHANDLE;
+        // Encoder binding is the consumer adapter's business: its MFT copies
+        // the cross-adapter surface into its own input
+        if (cross_adapter) td.BindFlags = D3D11_BIND_RENDER_TARGET;
+        if (nv12_compute.ready()) td.BindFlags |= D3D11_BIND_UNORDERED_ACCESS;
 
         D3D11_VIDEO_PROCESSOR_OUTPUT_VIEW_DESC ovd{};
         ovd.ViewDimension = D3D11_VPOV_DIMENSION_TEXTURE2D;
-        for (size_t i = 0; i < nv12_tex.size(); ++i) {
-            hr = d3d_device->CreateTexture2D(&td, nullptr, nv12_tex[i].put());
+        t.ring.reset(nv12_slots_);
+        for (size_t i = 0; i < t.ring.size(); ++i) {
+            hr = d3d_device->CreateTexture2D(&td, nullptr, t.nv12_tex[i].put());
+            if (FAILED(hr) && (td.BindFlags & D3D11_BIND_UNORDERED_ACCESS)) {
+                SR_LOG_WARN(L"NV12 ring refused UAV binding (0x%08X) — converting with the VP", hr);
+                drop_compute_converter();
+                td.BindFlags &= ~D3D11_BIND_UNORDERED_ACCESS;
+                hr = d3d_device->CreateTexture2D(&td, nullptr, t.nv12_tex[i].put());
+            }
             if (FAILED(hr)) {
                 SR_LOG_ERROR(L"CreateTexture2D(NV12[%zu]) failed: 0x%08X", i, hr);
                 return false;
             }
 
             hr = video_device->CreateVideoProcessorOutputView(
-                nv12_tex[i].get(), vp_enum.get(), &ovd, vp_out_view[i].put());
+                t.nv12_tex[i].get(), t.vp_enum.get(), &ovd, t.vp_out_view[i].put());
             if (FAILED(hr)) {
                 SR_LOG_ERROR(L"CreateVideoProcessorOutputView[%zu] failed: 0x%08X", i, hr);
                 return false;
             }
+            if ((cursor.ready() || tonemap.ready()) &&
+                !create_nv12_plane_views(d3d_device, t.nv12_tex[i].get(), t.planes[i])) {
+                // The next frame recreates the pool as BGRA for the VP path
+                tonemap.release();
+                want_hdr = false;
+                drop_cursor_overlay();
+            }
+            if (nv12_compute.ready() && !create_nv12_plane_uavs(d3d_device, t.nv12_tex[i].get(), t.uavs[i])) {
+                drop_compute_converter();
+            }
+            if (!open_for_consumer(t.nv12_tex[i].get(), t.consumer_tex[i])) {
+                SR_LOG_ERROR(L"Sharing NV12[%zu] with the encoder device failed", i);
+                return false;
+            }
+            t.idle_refs[i] = ref_count(t.consumer_tex[i].get());
+        }
+        if (t.primary && want_tap && !tap.open(d3d_device, t.out_width, t.out_height)) {
+            SR_LOG_WARN(L"Frame tap unavailable — capturing without it");
+            want_tap = false;
+        }
+        if (t.primary && !converter_measured) choose_converter(t, in_w, in_h);
+
+        SR_LOG_INFO(L"D3D11 Video Processor ready%s: %ux%u [%u,%u %ux%u] -> %ux%u BGRA->NV12 (%zu-slot ring)",
+                    t.primary ? L"" : L" (proxy)",
+                    in_w, in_h, src_rect_.left, src_rect_.top, src_rect_.width(), src_rect_.height(),
+                    t.out_width, t.out_height, t.ring.size());
+        return true;
+    }
+
+    // Auto: time both converters once per session on a scratch surface of
+    // the source size, converting into slot 0 (nothing is published yet)
+    void choose_converter(Nv12Target& t, uint32_t in_w, uint32_t in_h) {
+        converter_measured = true;
+        use_compute        = false;
+        if (!nv12_compute.ready() || tonemap.ready()) {
+            nv12_compute.release();
+            return;
+        }
+        double vp_ms = -1.0, compute_ms = -1.0;
+        if (converter_mode == Nv12ConverterMode::Auto) {
+            D3D11_TEXTURE2D_DESC td{};
+            td.Width            = in_w;
+            td.Height           = in_h;
+            td.MipLevels        = 1;
+            td.ArraySize        = 1;
+            td.Format           = DXGI_FORMAT_B8G8R8A8_UNORM;
+            td.SampleDesc.Count = 1;
+            td.Usage            = D3D11_USAGE_DEFAULT;
+            td.BindFlags        = D3D11_BIND_SHADER_RESOURCE | D3D11_BIND_RENDER_TARGET;
+            winrt::com_ptr<ID3D11Texture2D>                scratch;
+            winrt::com_ptr<ID3D11VideoProcessorInputView> in_view;
+            D3D11_VIDEO_PROCESSOR_INPUT_VIEW_DESC ivd{};
+            ivd.ViewDimension = D3D11_VPIV_DIMENSION_TEXTURE2D;
+            if (SUCCEEDED(d3d_device->CreateTexture2D(&td, nullptr, scratch.put()))) {
+                if (SUCCEEDED(video_device->CreateVideoProcessorInputView(
+                        scratch.get(), t.vp_enum.get(), &ivd, in_view.put()))) {
+                    vp_ms = gpu_ms([&] { return vp_blit(t, in_view.get(), scratch.get(), 0); });
+                }
+                compute_ms = gpu_ms([&] {
+                    return nv12_compute.dispatch(d3d_context, scratch.get(), src_rect_, t.uavs[0],
+                                                 t.out_width, t.out_height);
+                });
+            }
+        }
+        use_compute = use_compute_converter(converter_mode, true, vp_ms, compute_ms);
+        SR_LOG_INFO(L"NV12 converter (%s): VP %.2f ms, compute/%s %.2f ms -> %s",
+                    nv12_converter_label(converter_mode), vp_ms,
+                    nv12_scale_filter_label(nv12_compute.filter()), compute_ms,
+                    use_compute ? L"compute" : L"video processor");
+        if (!use_compute) nv12_compute.release();
+    }
+
+    // Mean GPU milliseconds of one `run` over several back-to-back
+    // submissions (after a warm-up that creates views); < 0 on failure
+    template <typename Run>
+    double gpu_ms(Run&& run) {
+        constexpr int kRuns = 8;
+        D3D11_QUERY_DESC qd{ D3D11_QUERY_TIMESTAMP_DISJOINT, 0 };
+        winrt::com_ptr<ID3D11Query> disjoint, begin, end;
+        if (FAILED(d3d_device->CreateQuery(&qd, disjoint.put()))) return -1.0;
+        qd.Query = D3D11_QUERY_TIMESTAMP;
+        if (FAILED(d3d_device->CreateQuery(&qd, begin.put())) ||
+            FAILED(d3d_device->CreateQuery(&qd, end.put())) || !run()) {
+            return -1.0;
+        }
+        bool ok = true;
+        d3d_context->Begin(disjoint.get());
+        d3d_context->End(begin.get());
+        for (int i = 0; i < kRuns && ok; ++i) ok = run();
+        d3d_context->End(end.get());
+        d3d_context->End(disjoint.get());
+
+        D3D11_QUERY_DATA_TIMESTAMP_DISJOINT dj{};
+        const ULONGLONG deadline = GetTickCount64() + 500;
+        while (d3d_context->GetData(disjoint.get(), &dj, sizeof(dj), 0) == S_FALSE) {
+            if (GetTickCount64() > deadline) return -1.0;
+            Sleep(1);
+        }
+        UINT64 t0 = 0, t1 = 0;
+        if (!ok || dj.Disjoint || dj.Frequency == 0 ||
+            d3d_context->GetData(begin.get(), &t0, sizeof(t0), 0) != S_OK ||
+            d3d_context->GetData(end.get(), &t1, sizeof(t1), 0) != S_OK || t1 < t0) {
+            return -1.0;
+        }
+        return static_cast<double>(t1 - t0) * 1000.0 / static_cast<double>(dj.Frequency) / kRuns;
+    }
+
+    // Convert with the video processor from now on (the ring could not be
+    // bound for compute on this device)
+    void drop_compute_converter() {
+        nv12_compute.release();
+        use_compute = false;
+        for (Nv12Target* t : { &main_, &proxy_ }) {
+            for (auto& view : t->uavs) { view.reset(); }
+        }
+    }
+
+    // Give the cursor back to WGC (overlay could not be set up on this device)
+    void drop_cursor_overlay() {
+        cursor.release();
+        want_cursor = false;
+        if (!tonemap.ready()) {
+            for (Nv12Target* t : { &main_, &proxy_ }) {
+                for (auto& view : t->planes) { view.reset(); }
+            }
+        }
+        if (!camera_pip) {
+            last_frame = nullptr;
+            last_bgra  = nullptr;
+        }
+        if (cursor_drawn) {
+            cursor_drawn = false;
+            try { session.IsCursorCaptureEnabled(true); } catch (...) {}
+        }
+    }
+
+    // Screen position of the capture content's top-left (physical pixels
+    // on a per-monitor-aware thread)
+    POINT content_origin() const {
+        if (cursor_window) {
+            RECT r{};
+            if (SUCCEEDED(DwmGetWindowAttribute(cursor_window, DWMWA_EXTENDED_FRAME_BOUNDS, &r, sizeof(r)))) {
+                return { r.left, r.top };
+            }
+            return {};
+        }
+        MONITORINFO mi{};
+        mi.cbSize = sizeof(mi);
+        if (cursor_monitor && GetMonitorInfoW(cursor_monitor, &mi)) return { mi.rcMonitor.left, mi.rcMonitor.top };
+        return {};
+    }
+
+    // The consumer's handle to an NV12 slot (the texture itself when shared)
+    bool open_for_consumer(ID3D11Texture2D* tex, winrt::com_ptr<ID3D11Texture2D>& out) {
+        if (!isolated()) {
+            out.copy_from(tex);
+            return true;
+        }
+        winrt::com_ptr<IDXGIResource1> res;
+        HANDLE handle = nullptr;
+        HRESULT hr = tex->QueryInterface(IID_PPV_ARGS(res.put()));
+        if (SUCCEEDED(hr)) {
+            hr = res->CreateSharedHandle(nullptr, DXGI_SHARED_RESOURCE_READ | DXGI_SHARED_RESOURCE_WRITE,
+                                         nullptr, &handle);
+        }
+        if (SUCCEEDED(hr)) {
+            hr = consumer_device->OpenSharedResource1(handle, IID_PPV_ARGS(out.put()));
+            CloseHandle(handle);
+        }
+        if (FAILED(hr)) SR_LOG_ERROR(L"Shared NV12 surface: 0x%08X", hr);
+        return SUCCEEDED(hr);
+    }
+
+    // A fence made on `creator` and opened on `opener`
+    static HRESULT share_fence(ID3D11Device5* creator, ID3D11Device5* opener, D3D11_FENCE_FLAG flags,
+                               winrt::com_ptr<ID3D11Fence>& created, winrt::com_ptr<ID3D11Fence>& opened) {
+        HRESULT hr = creator->CreateFence(0, flags, IID_PPV_ARGS(created.put()));
+        HANDLE handle = nullptr;
+        if (SUCCEEDED(hr)) hr = created->CreateSharedHandle(nullptr, GENERIC_ALL, nullptr, &handle);
+        if (SUCCEEDED(hr)) {
+            hr = opener->OpenSharedFence(handle, IID_PPV_ARGS(opened.put()));
+            CloseHandle(handle);
         }
+        return hr;
+    }
 
-        vp_width   = in_w;
-        vp_height  = in_h;
-        out_width_ = out_w;
-        out_height_= out_h;
-        SR_LOG_INFO(L"D3D11 Video Processor ready: %ux%u -> %ux%u BGRA->NV12 (double-buffered)",
-                    in_w, in_h, out_w, out_h);
+    // Own device on the consumer's adapter (or on `on_adapter`, cross-adapter
+    // encode) plus fences shared with the consumer device in both directions
+    // (needs D3D11.4 fences on both devices and a consumer context that can
+    // wait and signal; false = stay shared)
+    bool create_isolated_device(ID3D11Device* consumer, ID3D11DeviceContext* consumer_context,
+                                IDXGIAdapter* on_adapter) {
+        winrt::com_ptr<ID3D11Device5>        consumer5;
+        winrt::com_ptr<ID3D11DeviceContext4> consumer_context4;
+        winrt::com_ptr<IDXGIDevice>          dxgi_dev;
+        winrt::com_ptr<IDXGIAdapter>         adapter;
+        HRESULT hr = consumer->QueryInterface(IID_PPV_ARGS(consumer5.put()));
+        if (SUCCEEDED(hr)) hr = consumer_context->QueryInterface(IID_PPV_ARGS(consumer_context4.put()));
+        if (SUCCEEDED(hr)) hr = consumer->QueryInterface(IID_PPV_ARGS(consumer_device.put()));
+        if (SUCCEEDED(hr)) hr = consumer->QueryInterface(IID_PPV_ARGS(dxgi_dev.put()));
+        if (SUCCEEDED(hr)) hr = dxgi_dev->GetAdapter(adapter.put());
+        if (FAILED(hr)) {
+            SR_LOG_WARN(L"Isolated capture device: encoder device or context lacks D3D11.4 fences (0x%08X)", hr);
+            consumer_device = nullptr;
+            return false;
+        }
+        cross_adapter = false;
+        if (on_adapter) {
+            DXGI_ADAPTER_DESC own_desc{}, consumer_desc{};
+            on_adapter->GetDesc(&own_desc);
+            adapter->GetDesc(&consumer_desc);
+            cross_adapter = own_desc.AdapterLuid.LowPart != consumer_desc.AdapterLuid.LowPart ||
+                            own_desc.AdapterLuid.HighPart != consumer_desc.AdapterLuid.HighPart;
+            adapter.copy_from(on_adapter);
+        }
+
+        const D3D_FEATURE_LEVEL levels[] = { D3D_FEATURE_LEVEL_11_1, D3D_FEATURE_LEVEL_11_0 };
+        hr = D3D11CreateDevice(adapter.get(), D3D_DRIVER_TYPE_UNKNOWN, nullptr,
+                               D3D11_CREATE_DEVICE_BGRA_SUPPORT | D3D11_CREATE_DEVICE_VIDEO_SUPPORT,
+                               levels, static_cast<UINT>(std::size(levels)), D3D11_SDK_VERSION,
+                               own_device.put(), nullptr, own_context.put());
+        winrt::com_ptr<ID3D11Device5> own5;
+        if (SUCCEEDED(hr)) hr = own_device->QueryInterface(IID_PPV_ARGS(own5.put()));
+        if (SUCCEEDED(hr)) hr = own_context->QueryInterface(IID_PPV_ARGS(own_context4.put()));
+        const D3D11_FENCE_FLAG fence_flags = cross_adapter
+            ? static_cast<D3D11_FENCE_FLAG>(D3D11_FENCE_FLAG_SHARED | D3D11_FENCE_FLAG_SHARED_CROSS_ADAPTER)
+            : D3D11_FENCE_FLAG_SHARED;
+        if (SUCCEEDED(hr)) hr = share_fence(own5.get(), consumer5.get(), fence_flags, fence, consumer_fence);
+        for (Nv12Target* t : { &main_, &proxy_ }) {
+            winrt::com_ptr<ID3D11Fence> consumer_side;
+            if (SUCCEEDED(hr)) hr = share_fence(consumer5.get(), own5.get(), fence_flags, consumer_side, t->release_fence);
+            if (SUCCEEDED(hr)) {
+                t->release = std::make_shared<GpuReleaseFence>();
+                t->release->fence = consumer_side.get();
+                t->release_needed.fill(0);
+            }
+        }
+        if (FAILED(hr)) {
+            SR_LOG_WARN(L"Isolated capture device unavailable: 0x%08X — sharing the encoder device", hr);
+            drop_isolated_device();
+            return false;
+        }
+
+        // WGC delivers frames on its own thread pool threads
+        winrt::com_ptr<ID3D10Multithread> mt;
+        if (SUCCEEDED(own_device->QueryInterface(IID_PPV_ARGS(mt.put())))) mt->SetMultithreadProtected(TRUE);
+
+        d3d_device  = own_device.get();
+        d3d_context = own_context.get();
+        fence_value = 0;
         return true;
     }
 
+    void drop_isolated_device() {
+        for (Nv12Target* t : { &main_, &proxy_ }) {
+            t->release       = nullptr;
+            t->release_fence = nullptr;
+        }
+        consumer_fence  = nullptr;
+        fence           = nullptr;
+        own_context4    = nullptr;
+        own_context     = nullptr;
+        own_device      = nullptr;
+        consumer_device = nullptr;
+        cross_adapter   = false;
+    }
+
+    // Stamp a frame with the fence value its slot's blit signalled
+    void attach_fence(const Nv12Target& t, uint32_t idx, RenderFrame& f) const {
+        if (!isolated()) return;
+        f.fence       = consumer_fence.get();
+        f.fence_value = t.fence_values[idx];
+        f.release     = t.release;
+    }
+
+    // Ring reclaim test: a consumer still references slot i, or (isolated)
+    // has not yet acknowledged, after the reference went away, that its GPU
+    // reads are done. The acknowledgement needed is recorded the first time
+    // the slot is seen unreferenced: any later consumer signal covers it.
+    static bool slot_in_use(Nv12Target& t, uint32_t i) {
+        if (ref_count(t.consumer_tex[i].get()) > t.idle_refs[i]) {
+            t.release_needed[i] = 0;
+            return true;
+        }
+        if (!t.release_fence) return false;
+        if (t.release_needed[i] == 0) {
+            t.release_needed[i] = t.release->issued.load(std::memory_order_acquire) + 1;
+        }
+        if (t.release_fence->GetCompletedValue() < t.release_needed[i]) return true;
+        t.release_needed[i] = 0;
+        return false;
+    }
+
+    // Current COM refcount; stable when only the ring and its view hold the texture
+    static ULONG ref_count(IUnknown* obj) {
+        obj->AddRef();
+        return obj->Release();
+    }
+
     // -----------------------------------------------------------------------
-    winrt::com_ptr<ID3D11VideoProcessorInputView> get_or_create_input_view(ID3D11Texture2D* bgra_tex) {
+    winrt::com_ptr<ID3D11VideoProcessorInputView> get_or_create_input_view(Nv12Target& t,
+                                                                           ID3D11Texture2D* bgra_tex) {
         if (!bgra_tex) return {};
 
-        for (size_t i = 0; i < cached_in_tex.size(); ++i) {
-            if (cached_in_tex[i].get() == bgra_tex && cached_in_view[i]) {
-                return cached_in_view[i];
+        for (size_t i = 0; i < t.cached_in_tex.size(); ++i) {
+            if (t.cached_in_tex[i].get() == bgra_tex && t.cached_in_view[i]) {
+                return t.cached_in_view[i];
             }
         }
 
@@ -158,7 +673,7 @@ struct CaptureEngineImpl {
         ivd.ViewDimension = D3D11_VPIV_DIMENSION_TEXTURE2D;
         winrt::com_ptr<ID3D11VideoProcessorInputView> in_view;
         const HRESULT hr = video_device->CreateVideoProcessorInputView(
-            bgra_tex, vp_enum.get(), &ivd, in_view.put());
+            bgra_tex, t.vp_enum.get(), &ivd, in_view.put());
         if (FAILED(hr)) {
             if (hr == DXGI_ERROR_DEVICE_REMOVED || hr == DXGI_ERROR_DEVICE_RESET) {
                 SR_LOG_ERROR(L"[T039] D3D11 device lost (CreateInputView): 0x%08X — signalling recovery", hr);
@@ -169,27 +684,100 @@ struct CaptureEngineImpl {
             return {};
         }
 
-        const size_t slot = next_in_cache_slot_ % cached_in_tex.size();
-        cached_in_tex[slot].copy_from(bgra_tex);
-        cached_in_view[slot] = in_view;
-        ++next_in_cache_slot_;
+        const size_t slot = t.next_in_cache_slot % t.cached_in_tex.size();
+        t.cached_in_tex[slot].copy_from(bgra_tex);
+        t.cached_in_view[slot] = in_view;
+        ++t.next_in_cache_slot;
         return in_view;
     }
 
-    bool convert_bgra_to_nv12(ID3D11Texture2D* bgra_tex, uint32_t& out_idx) {
-        auto in_view = get_or_create_input_view(bgra_tex);
-        if (!in_view) return false;
+    bool convert_bgra_to_nv12(Nv12Target& t, ID3D11Texture2D* bgra_tex, uint32_t& out_idx) {
+        if (t.primary) update_camera();   // the proxy reuses the same upload
+        winrt::com_ptr<ID3D11VideoProcessorInputView> in_view;
+        const bool compute = compute_path();
+        if (!tonemap.ready() && !compute) {
+            in_view = get_or_create_input_view(t, bgra_tex);
+            if (!in_view) return false;
+        }
 
-        out_idx = write_idx_;
-        auto out_view = vp_out_view[out_idx];
+        const auto slot = t.ring.acquire([&t](uint32_t i) { return slot_in_use(t, i); });
+        if (!slot) {
+            // Every texture is still queued or inside the encoder: drop rather
+            // than overwrite a surface a consumer is reading.
+            if (!t.primary) {
+                parent->frames_proxy_dropped_.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+            parent->frames_dropped_.fetch_add(1, std::memory_order_relaxed);
+            trace::frame_dropped(-1, t.queue ? t.queue->size() : 0, "ring_full");
+            const uint32_t n = parent->frames_ring_full_.fetch_add(1, std::memory_order_relaxed) + 1;
+            if (n == 1 || (n % 300) == 0) {
+                SR_LOG_WARN(L"NV12 ring exhausted (%zu slots) — dropping frame (count=%u)",
+                            t.ring.size(), n);
+            }
+            return false;
+        }
+        out_idx = *slot;
+        const bool converted = tonemap.ready()
+            ? tonemap.draw(d3d_context, bgra_tex, src_rect_, t.planes[out_idx], t.out_width, t.out_height)
+            : compute
+            ? nv12_compute.dispatch(d3d_context, bgra_tex, src_rect_, t.uavs[out_idx], t.out_width, t.out_height)
+            : vp_blit(t, in_view.get(), bgra_tex, out_idx);
+        if (!converted) {
+            t.ring.abandon(out_idx);
+            return false;
+        }
+        if (camera_tex && (tonemap.ready() || compute || t.vp_streams < 2)) blit_camera(t, out_idx);
+        if (cursor_drawn) {
+            t.drawn_cursor = cursor.quad(src_rect_, t.out_width, t.out_height);
+            cursor.draw(d3d_context, t.planes[out_idx], t.drawn_cursor);
+        }
+        if (isolated()) {
+            // Flush so the signal reaches the GPU before a consumer waits on it
+            own_context4->Signal(fence.get(), ++fence_value);
+            own_context->Flush();
+            t.fence_values[out_idx] = fence_value;
+        }
+        t.ring.publish(out_idx);
+        return true;
+    }
+
+    // BGRA -> NV12 through the target's video processor into slot out_idx
+    bool vp_blit(Nv12Target& t, ID3D11VideoProcessorInputView* in_view, ID3D11Texture2D* bgra_tex,
+                 uint32_t out_idx) {
+        auto out_view = t.vp_out_view[out_idx];
         if (!out_view) return false;
 
-        D3D11_VIDEO_PROCESSOR_STREAM stream{};
-        stream.Enable        = TRUE;
-        stream.pInputSurface = in_view.get();
+        // Blit only the source rect: the crop, and for window items the valid
+        // content area (the pool surface can be larger than the content and,
+        // right after a resize, smaller).
+        D3D11_TEXTURE2D_DESC in_desc{};
+        bgra_tex->GetDesc(&in_desc);
+        const FrameRect surface{ 0, 0, in_desc.Width, in_desc.Height };
+        const FrameRect src_rect = src_rect_.intersected(surface);
+        if (!src_rect.empty() && src_rect != surface) {
+            const RECT src{ static_cast<LONG>(src_rect.left),  static_cast<LONG>(src_rect.top),
+                            static_cast<LONG>(src_rect.right), static_cast<LONG>(src_rect.bottom) };
+            video_context->VideoProcessorSetStreamSourceRect(t.vp.get(), 0, TRUE, &src);
+        } else {
+            video_context->VideoProcessorSetStreamSourceRect(t.vp.get(), 0, FALSE, nullptr);
+        }
+
+        // Stream 1 (on top): the camera at t.camera_rect
+        std::array<D3D11_VIDEO_PROCESSOR_STREAM, 2> streams{};
+        streams[0].Enable        = TRUE;
+        streams[0].pInputSurface = in_view;
+        UINT stream_count = 1;
+        if (t.vp_streams >= 2) {
+            if (ID3D11VideoProcessorInputView* camera = camera_view(t, 1)) {
+                streams[1].Enable        = TRUE;
+                streams[1].pInputSurface = camera;
+                stream_count = 2;
+            }
+        }
 
         HRESULT hr = video_context->VideoProcessorBlt(
-            vp.get(), out_view.get(), 0, 1, &stream);
+            t.vp.get(), out_view.get(), 0, stream_count, streams.data());
         if (FAILED(hr)) {
             // T039: device-lost detection on VideoProcessorBlt
             if (hr == DXGI_ERROR_DEVICE_REMOVED || hr == DXGI_ERROR_DEVICE_RESET) {
@@ -200,10 +788,118 @@ struct CaptureEngineImpl {
             }
             return false;
         }
-        write_idx_ ^= 1u;
         return true;
     }
 
+    // Upload the newest posted camera frame. Capture / poll thread with
+    // frame_mutex held; a no-op when nothing new was posted.
+    void update_camera() {
+        if (!camera_pip) return;
+        uint32_t w = 0, h = 0;
+        if (!parent->camera_mailbox_.take(camera_pixels, w, h, camera_seq)) return;
+        if (!camera_tex || w != camera_w || h != camera_h) {
+            camera_tex = nullptr;
+            D3D11_TEXTURE2D_DESC td{};
+            td.Width            = w;
+            td.Height           = h;
+            td.MipLevels        = 1;
+            td.ArraySize        = 1;
+            td.Format           = DXGI_FORMAT_B8G8R8A8_UNORM;
+            td.SampleDesc.Count = 1;
+            td.Usage            = D3D11_USAGE_DEFAULT;
+            td.BindFlags        = D3D11_BIND_SHADER_RESOURCE;
+            const HRESULT hr = d3d_device->CreateTexture2D(&td, nullptr, camera_tex.put());
+            camera_w = SUCCEEDED(hr) ? w : 0;
+            camera_h = SUCCEEDED(hr) ? h : 0;
+            layout_camera(main_);
+            layout_camera(proxy_);
+            if (FAILED(hr)) {
+                SR_LOG_WARN(L"Camera PiP texture %ux%u failed: 0x%08X", w, h, hr);
+                return;
+            }
+            SR_LOG_INFO(L"Camera PiP: %ux%u -> [%u,%u %ux%u]", w, h, main_.camera_rect.left,
+                        main_.camera_rect.top, main_.camera_rect.width(), main_.camera_rect.height());
+        }
+        d3d_context->UpdateSubresource(camera_tex.get(), 0, nullptr, camera_pixels.data(), w * 4, 0);
+    }
+
+    bool camera_pending() const {
+        return camera_pip && parent->camera_mailbox_.pending(camera_seq);
+    }
+
+    // Camera size or output size changed: new PiP rect, new input view
+    void layout_camera(Nv12Target& t) {
+        t.camera_rect    = pip_dest_rect(camera_w, camera_h, t.out_width, t.out_height, pip_layout);
+        t.camera_in_view = nullptr;
+    }
+
+    // The camera texture as VP input on t's enumerator, placed at
+    // t.camera_rect on `stream`
+    ID3D11VideoProcessorInputView* camera_view(Nv12Target& t, UINT stream) {
+        if (!camera_tex || t.camera_rect.empty()) return nullptr;
+        if (!t.camera_in_view) {
+            D3D11_VIDEO_PROCESSOR_INPUT_VIEW_DESC ivd{};
+            ivd.FourCC        = 0;
+            ivd.ViewDimension = D3D11_VPIV_DIMENSION_TEXTURE2D;
+            const HRESULT hr = video_device->CreateVideoProcessorInputView(
+                camera_tex.get(), t.vp_enum.get(), &ivd, t.camera_in_view.put());
+            if (FAILED(hr)) {
+                SR_LOG_WARN(L"Camera PiP input view failed: 0x%08X — camera left out", hr);
+                t.camera_rect = {};
+                return nullptr;
+            }
+        }
+        const RECT dst{ static_cast<LONG>(t.camera_rect.left),  static_cast<LONG>(t.camera_rect.top),
+                        static_cast<LONG>(t.camera_rect.right), static_cast<LONG>(t.camera_rect.bottom) };
+        video_context->VideoProcessorSetStreamDestRect(t.vp.get(), stream, TRUE, &dst);
+        return t.camera_in_view.get();
+    }
+
+    // Camera as its own blit, for the HDR shader path and single-stream VPs:
+    // the output target rect keeps every pixel outside the PiP untouched
+    void blit_camera(Nv12Target& t, uint32_t out_idx) {
+        ID3D11VideoProcessorInputView* camera = camera_view(t, 0);
+        if (!camera || !t.vp_out_view[out_idx]) return;
+        const RECT dst{ static_cast<LONG>(t.camera_rect.left),  static_cast<LONG>(t.camera_rect.top),
+                        static_cast<LONG>(t.camera_rect.right), static_cast<LONG>(t.camera_rect.bottom) };
+        video_context->VideoProcessorSetOutputTargetRect(t.vp.get(), TRUE, &dst);
+        video_context->VideoProcessorSetStreamSourceRect(t.vp.get(), 0, FALSE, nullptr);
+
+        D3D11_VIDEO_PROCESSOR_STREAM stream{};
+        stream.Enable        = TRUE;
+        stream.pInputSurface = camera;
+        const HRESULT hr = video_context->VideoProcessorBlt(
+            t.vp.get(), t.vp_out_view[out_idx].get(), 0, 1, &stream);
+        video_context->VideoProcessorSetStreamDestRect(t.vp.get(), 0, FALSE, nullptr);
+        video_context->VideoProcessorSetOutputTargetRect(t.vp.get(), FALSE, nullptr);
+        if (FAILED(hr)) SR_LOG_WARN(L"Camera PiP blit failed: 0x%08X", hr);
+    }
+
+    // Collect the frame's dirty regions in output coordinates. Leaves
+    // `dirty` unknown when the session doesn't report them.
+    void read_dirty_regions(wgc::Direct3D11CaptureFrame const& frame,
+                            uint32_t frame_w, uint32_t frame_h, DirtyRegion& dirty) {
+        dirty.clear_unknown();
+#if defined(SR_WGC_DIRTY_REGIONS)
+        if (!dirty_regions_) return;
+        try {
+            DirtyRegion content;
+            content.reset(frame_w, frame_h);
+            for (auto const& r : frame.DirtyRegions()) {
+                if (r.Width <= 0 || r.Height <= 0) continue;
+                const uint32_t x = static_cast<uint32_t>((std::max)(r.X, 0));
+                const uint32_t y = static_cast<uint32_t>((std::max)(r.Y, 0));
+                content.add({ x, y, x + static_cast<uint32_t>(r.Width), y + static_cast<uint32_t>(r.Height) });
+            }
+            dirty = content.cropped(src_rect_).scaled(main_.out_width, main_.out_height);
+        } catch (...) {
+            dirty.clear_unknown();
+        }
+#else
+        (void)frame; (void)frame_w; (void)frame_h;
+#endif
+    }
+
     // T039: Fire the device-lost callback once (idempotent via atomic flag)
     void signal_device_lost() {
         bool already = parent->device_lost_.exchange(true, std::memory_order_acq_rel);
@@ -212,27 +908,105 @@ struct CaptureEngineImpl {
         }
     }
 
+    void signal_source_closed() {
+        bool already = source_closed.exchange(true, std::memory_order_acq_rel);
+        if (!already && parent->source_closed_cb_) {
+            parent->source_closed_cb_();
+        }
+    }
+
+    // Blit the same WGC surface into the proxy ring and queue it with the
+    // main frame's timestamps. Proxy drops never affect the main output.
+    void emit_proxy(ID3D11Texture2D* bgra_tex, const RenderFrame& main_frame) {
+        RenderFrame pf;
+        pf.stamps = main_frame.stamps;
+        uint32_t idx = 0;
+        if (main_frame.is_duplicate && proxy_.ring.latest()) {
+            idx = *proxy_.ring.latest();
+            pf.is_duplicate = true;
+        } else if (!convert_bgra_to_nv12(proxy_, bgra_tex, idx)) {
+            return;
+        }
+        pf.texture = proxy_.consumer_tex[idx].get();
+        attach_fence(proxy_, idx, pf);
+        pf.width   = proxy_.out_width;
+        pf.height  = proxy_.out_height;
+        pf.pts     = main_frame.pts;
+        pf.dirty   = main_frame.dirty.scaled(proxy_.out_width, proxy_.out_height);
+
+        if (!proxy_.queue->try_push(std::move(pf))) {
+            parent->frames_proxy_dropped_.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
     // -----------------------------------------------------------------------
     void on_frame_arrived(wgc::Direct3D11CaptureFramePool const& pool,
                           winrt::Windows::Foundation::IInspectable const&)
     {
+        const QPCClock& clock = QPCClock::instance();
+        const int64_t arrival_ticks = QPCClock::ticks();
+        const int64_t arrival_us    = qpc_ticks_to(arrival_ticks, clock.frequency(), 1'000'000);
         auto frame = pool.TryGetNextFrame();
         if (!frame) return;
+        std::lock_guard<std::mutex> lock(frame_mutex);
+        // DWM compose time, QPC time base in 100ns units
+        const int64_t compose_100ns = frame.SystemRelativeTime().count();
+        trace::frame_arrived(arrival_us, main_.queue ? main_.queue->size() : 0);
 
         // T034: Detect resolution change — compare WGC content size to VP input
         auto content_size = frame.ContentSize();
         uint32_t frame_w = static_cast<uint32_t>(content_size.Width);
         uint32_t frame_h = static_cast<uint32_t>(content_size.Height);
 
-        if (frame_w != vp_width || frame_h != vp_height) {
+        if ((frame_w != vp_width || frame_h != vp_height) && compute_path()) {
+            // The compute converter takes crop and scale from its constants:
+            // the ring and the VP (camera blits only) stay as they are
+            SR_LOG_INFO(L"WGC resolution changed: %ux%u -> %ux%u", vp_width, vp_height, frame_w, frame_h);
+            vp_width  = frame_w;
+            vp_height = frame_h;
+            src_rect_ = effective_source_rect(crop_, frame_w, frame_h);
+        } else if (frame_w != vp_width || frame_h != vp_height) {
             SR_LOG_INFO(L"WGC resolution changed: %ux%u -> %ux%u — recreating VP",
                         vp_width, vp_height, frame_w, frame_h);
             // Keep fixed output dimensions; only input changes
-            if (!setup_video_processor(frame_w, frame_h, out_width_, out_height_)) {
+            if (!setup_video_processor(frame_w, frame_h)) {
                 SR_LOG_ERROR(L"VP resize failed — dropping frame");
                 return;
             }
         }
+        // Power-profile switch: new main output size (src_rect_ is current here)
+        if (const uint64_t req = parent->pending_output_.exchange(0, std::memory_order_acq_rel)) {
+            const auto res = clamp_recording_resolution(
+                src_rect_.width(), src_rect_.height(),
+                { static_cast<uint32_t>(req >> 32), static_cast<uint32_t>(req & 0xFFFFFFFFu) });
+            if (res.width != main_.out_width || res.height != main_.out_height) {
+                SR_LOG_INFO(L"Output resolution change: %ux%u -> %ux%u",
+                            main_.out_width, main_.out_height, res.width, res.height);
+                const uint32_t old_w = main_.out_width, old_h = main_.out_height;
+                main_.out_width  = res.width;
+                main_.out_height = res.height;
+                if (!setup_target(main_, vp_width, vp_height)) {
+                    SR_LOG_ERROR(L"VP output resize failed — keeping %ux%u", old_w, old_h);
+                    main_.out_width  = old_w;
+                    main_.out_height = old_h;
+                    if (!setup_target(main_, vp_width, vp_height)) return;
+                }
+            }
+        }
+        // Window items keep delivering pool-sized surfaces until the pool is
+        // recreated; resize it so later frames carry the whole content.
+        if (content_size.Width  != pool_size.Width ||
+            content_size.Height != pool_size.Height || pool_format != wanted_pool_format()) {
+            try {
+                pool.Recreate(winrt_device, wanted_pool_format(),
+                              static_cast<int32_t>(pool_buffers_), content_size);
+                pool_size   = content_size;
+                pool_format = wanted_pool_format();
+            } catch (winrt::hresult_error const& e) {
+                SR_LOG_WARN(L"WGC frame pool resize failed: 0x%08X",
+                            static_cast<uint32_t>(e.code().value));
+            }
+        }
 
         auto surface = frame.Surface();
         auto access  = surface.as<::Windows::Graphics::DirectX::Direct3D11::IDirect3DDxgiInterfaceAccess>();
@@ -244,31 +1018,265 @@ struct CaptureEngineImpl {
             return;
         }
 
-        uint32_t out_idx = 0;
-        if (!convert_bgra_to_nv12(bgra_tex.get(), out_idx)) return;
+        // Paused: park the newest frame, replacing the previous one, so at
+        // most one pool buffer is held. A one-buffer pool would stall WGC on
+        // a parked frame; its frames are let go (the resume shows the
+        // pre-pause picture until the next change).
+        if (parent->suspended_.load(std::memory_order_acquire)) {
+            if (holds_last_frame() || pool_buffers_ > 1) {
+                last_frame = frame;
+                last_bgra  = bgra_tex;
+                parked     = true;
+            }
+            note_skipped(DirtyRegion{});
+            return;
+        }
+
+        // Rate limit: ahead of the next encoder slot, hold the frame instead
+        // of converting it (same pool-buffer rule as the pause above)
+        rate_gate.set_fps(parent->frame_rate_limit_.load(std::memory_order_relaxed));
+        const int64_t gate_pts = compose_100ns > 0 ? compose_100ns : clock.ticks_to_hns(arrival_ticks);
+        if (!rate_gate.admit(gate_pts)) {
+            parent->frames_throttled_.fetch_add(1, std::memory_order_relaxed);
+            DirtyRegion dirty;
+            read_dirty_regions(frame, frame_w, frame_h, dirty);
+            note_skipped(dirty);
+            if (holds_last_frame() || pool_buffers_ > 1) {
+                last_frame = frame;
+                last_bgra  = bgra_tex;
+                parked     = true;
+                arm_flush(rate_gate.next_due() - gate_pts);
+            }
+            return;
+        }
+        if (parked && !holds_last_frame()) {
+            last_frame = nullptr;
+            last_bgra  = nullptr;
+        }
+        parked = false;
 
         // Build RenderFrame
         RenderFrame rf;
-        // ComPtr copy AddRefs the selected ping-pong texture.
-        rf.texture = nv12_tex[out_idx].get();
-        rf.width   = out_width_;   // T034: always report fixed output dimensions
-        rf.height  = out_height_;
-
-        // PTS: relative to session start in 100ns units
-        LARGE_INTEGER now{};
-        QueryPerformanceCounter(&now);
-        int64_t now_100ns = static_cast<int64_t>(
-            static_cast<double>(now.QuadPart) * 10'000'000.0 /
-            static_cast<double>(qpc_freq.QuadPart));
-        rf.pts = now_100ns - start_100ns;
+        rf.stamps.arrival_us = arrival_us;
+        read_dirty_regions(frame, frame_w, frame_h, rf.dirty);
+        merge_skipped(rf.dirty);
+
+        uint32_t out_idx = 0;
+        const CursorQuad prev_cursor = main_.drawn_cursor;
+        const bool camera_new = camera_pending();
+        if (rf.dirty.known() && rf.dirty.empty() && !camera_new && main_.ring.latest()) {
+            // Nothing changed since the last conversion: skip the blit and
+            // hand out the previous NV12 slot again.
+            out_idx = *main_.ring.latest();
+            rf.is_duplicate = true;
+            parent->frames_unchanged_.fetch_add(1, std::memory_order_relaxed);
+        } else if (!convert_bgra_to_nv12(main_, bgra_tex.get(), out_idx)) {
+            return;
+        }
+        rf.stamps.converted_us = clock.now_us();
+        if (!rf.is_duplicate) trace::vp_blt(arrival_us, rf.stamps.converted_us - arrival_us, out_idx);
+        if (cursor_drawn && !rf.is_duplicate && rf.dirty.known()) {
+            add_cursor_damage(rf.dirty, prev_cursor);
+        }
+        if (camera_new && rf.dirty.known()) rf.dirty.add(main_.camera_rect);
+
+        // PTS: compose time on the session clock. Callback time runs late by
+        // the dispatch delay and the VP blit, jitter the pacer would otherwise
+        // turn into duplicates and skips under CPU load.
+        const SyncManager* sync = parent->sync_;
+        if (sync && compose_100ns > 0) {
+            rf.pts = sync->session_time(compose_100ns);
+        } else {
+            rf.pts = clock.ticks_to_hns(arrival_ticks - start_ticks);
+        }
         if (rf.pts < 0) rf.pts = 0;
 
         parent->frames_captured_.fetch_add(1, std::memory_order_relaxed);
+        if (holds_last_frame()) {
+            // Keep the surface out of the pool for overlay-only re-blits
+            last_frame = frame;
+            last_bgra  = bgra_tex;
+        }
+        deliver(std::move(rf), out_idx, bgra_tex.get());
+    }
+
+    // Frames the gate (or a pause) turned away: their changes are still owed
+    // to the encoder. An unknown region on either side makes the sum unknown.
+    void note_skipped(const DirtyRegion& dirty) {
+        if (!skipped_changes) {
+            skipped_dirty   = dirty;
+            skipped_changes = true;
+            return;
+        }
+        if (!dirty.known() || !skipped_dirty.known()) {
+            skipped_dirty.clear_unknown();
+            return;
+        }
+        for (const FrameRect& r : dirty) skipped_dirty.add(r);
+    }
+
+    void merge_skipped(DirtyRegion& dirty) {
+        if (!skipped_changes) return;
+        skipped_changes = false;
+        if (!dirty.known() || !skipped_dirty.known()) {
+            dirty.clear_unknown();
+            return;
+        }
+        for (const FrameRect& r : skipped_dirty) dirty.add(r);
+    }
+
+    // One-shot flush of the held frame `delay_100ns` from now. frame_mutex
+    // held: stop() takes the timer away under it.
+    void arm_flush(int64_t delay_100ns) {
+        if (!flush_timer || !parent->running_.load(std::memory_order_acquire)) return;
+        ULARGE_INTEGER due{};
+        due.QuadPart = static_cast<ULONGLONG>(-(std::max)(delay_100ns, int64_t{ 10'000 }));  // relative
+        FILETIME ft{ due.LowPart, due.HighPart };
+        SetThreadpoolTimer(flush_timer, &ft, 0, 0);
+    }
+
+    static void CALLBACK on_flush_timer(PTP_CALLBACK_INSTANCE, PVOID ctx, PTP_TIMER) {
+        auto* self = static_cast<CaptureEngineImpl*>(ctx);
+        if (self->parent->running_.load(std::memory_order_acquire)) self->flush_throttled();
+    }
 
-        if (queue && !queue->try_push(std::move(rf))) {
+    // Timer callback: the slot the held frame missed has come
+    void flush_throttled() {
+        if (parent->suspended_.load(std::memory_order_acquire)) return;   // the resume converts it
+        {
+            std::lock_guard<std::mutex> lock(frame_mutex);
+            if (!parked) return;
+            const int64_t now = QPCClock::instance().ticks_to_hns(QPCClock::ticks());
+            if (!rate_gate.admit(now)) {
+                arm_flush(rate_gate.next_due() - now);
+                return;
+            }
+        }
+        convert_parked();
+    }
+
+    // Win11 24H2+: WGC skips refreshes itself, capped at 4/3 of the target
+    // rate so refresh-aligned deliveries never fall below it; the gate trims
+    // the rest onto the exact grid
+    void apply_min_update_interval(uint32_t fps) {
+#if defined(SR_WGC_MIN_UPDATE_INTERVAL)
+        if (!min_update_interval) return;
+        try {
+            session.MinUpdateInterval(winrt::Windows::Foundation::TimeSpan{
+                fps > 0 ? 10'000'000LL * 3 / (4 * static_cast<int64_t>(fps)) : 0 });
+        } catch (...) {
+            min_update_interval = false;
+        }
+#else
+        (void)fps;
+#endif
+    }
+
+    // Old and new cursor rectangles of the main output join a known region
+    void add_cursor_damage(DirtyRegion& dirty, const CursorQuad& prev) const {
+        dirty.add(visible_rect(prev, main_.out_width, main_.out_height));
+        dirty.add(visible_rect(main_.drawn_cursor, main_.out_width, main_.out_height));
+    }
+
+    // Finish a main frame in slot out_idx: proxy copy, then the queue
+    void deliver(RenderFrame&& rf, uint32_t out_idx, ID3D11Texture2D* bgra_tex) {
+        // ComPtr copy AddRefs the selected ping-pong texture.
+        rf.texture = main_.consumer_tex[out_idx].get();
+        attach_fence(main_, out_idx, rf);
+        rf.width   = main_.out_width;   // T034: always report fixed output dimensions
+        rf.height  = main_.out_height;
+        // Overlay frames are stamped on arrival, WGC frames at compose time:
+        // keep the interleaved sequence monotonic
+        if (holds_last_frame() && rf.pts < last_pts) rf.pts = last_pts;
+        last_pts = rf.pts;
+        if (tap.ready() && !rf.is_duplicate) tap.publish(d3d_context, main_.nv12_tex[out_idx].get(), rf.pts);
+
+        // Second VideoProcessorBlt from the same surface, before the main
+        // frame is handed off
+        if (proxy_enabled()) emit_proxy(bgra_tex, rf);
+
+        const int64_t pts       = rf.pts;
+        const bool    unchanged = rf.is_duplicate;
+        if (main_.queue && !main_.queue->try_push(std::move(rf))) {
             parent->frames_dropped_.fetch_add(1, std::memory_order_relaxed);
+            trace::frame_dropped(pts, main_.queue->size(), "queue_full");
+        } else if (main_.queue) {
+            trace::frame_enqueued(pts, main_.queue->size(), unchanged);
         }
     }
+
+    // Overlay poll thread: when only the cursor moved or a camera frame was
+    // posted, re-blit the held WGC surface. Nothing else changed, so the
+    // dirty region is just the old and new cursor rectangles and the PiP.
+    void on_overlay_poll() {
+        if (parent->suspended_.load(std::memory_order_acquire)) return;
+        std::lock_guard<std::mutex> lock(frame_mutex);
+        if (parked) return;   // a newer WGC frame is held for the flush timer
+        const bool cursor_moved = cursor_drawn && cursor.poll(content_origin());
+        const bool camera_new   = camera_pending();
+        if ((!cursor_moved && !camera_new) || !last_bgra) return;
+
+        const QPCClock& clock = QPCClock::instance();
+        const int64_t ticks = QPCClock::ticks();
+        RenderFrame rf;
+        rf.stamps.arrival_us = qpc_ticks_to(ticks, clock.frequency(), 1'000'000);
+        rf.overlay_only = true;
+
+        const CursorQuad prev_cursor = main_.drawn_cursor;
+        uint32_t out_idx = 0;
+        if (!convert_bgra_to_nv12(main_, last_bgra.get(), out_idx)) return;
+        rf.stamps.converted_us = clock.now_us();
+        rf.dirty.reset(main_.out_width, main_.out_height);
+        if (cursor_drawn) add_cursor_damage(rf.dirty, prev_cursor);
+        if (camera_new) rf.dirty.add(main_.camera_rect);
+
+        const SyncManager* sync = parent->sync_;
+        rf.pts = sync ? sync->session_time(clock.ticks_to_hns(ticks))
+                      : clock.ticks_to_hns(ticks - start_ticks);
+        if (rf.pts < 0) rf.pts = 0;
+
+        parent->frames_overlay_only_.fetch_add(1, std::memory_order_relaxed);
+        deliver(std::move(rf), out_idx, last_bgra.get());
+    }
+
+    // Resume, or the rate gate's flush: convert the parked frame. After a
+    // pause it counts as a full change; after the gate, as the changes of
+    // every frame turned away since the last conversion.
+    void convert_parked() {
+        std::lock_guard<std::mutex> lock(frame_mutex);
+        if (!parked) return;
+        parked = false;
+        winrt::com_ptr<ID3D11Texture2D> bgra = last_bgra;
+        if (!holds_last_frame()) {
+            last_frame = nullptr;   // back to the pool once converted
+            last_bgra  = nullptr;
+        }
+        if (!bgra) return;
+
+        const QPCClock& clock = QPCClock::instance();
+        const int64_t ticks = QPCClock::ticks();
+        RenderFrame rf;
+        rf.stamps.arrival_us = qpc_ticks_to(ticks, clock.frequency(), 1'000'000);
+        if (skipped_changes) {
+            rf.dirty        = skipped_dirty;
+            skipped_changes = false;
+        }
+        const CursorQuad prev_cursor = main_.drawn_cursor;
+        const bool camera_new = camera_pending();
+        uint32_t out_idx = 0;
+        if (!convert_bgra_to_nv12(main_, bgra.get(), out_idx)) return;
+        rf.stamps.converted_us = clock.now_us();
+        if (cursor_drawn && rf.dirty.known()) add_cursor_damage(rf.dirty, prev_cursor);
+        if (camera_new && rf.dirty.known()) rf.dirty.add(main_.camera_rect);
+
+        const SyncManager* sync = parent->sync_;
+        rf.pts = sync ? sync->session_time(clock.ticks_to_hns(ticks))
+                      : clock.ticks_to_hns(ticks - start_ticks);
+        if (rf.pts < 0) rf.pts = 0;
+
+        parent->frames_captured_.fetch_add(1, std::memory_order_relaxed);
+        deliver(std::move(rf), out_idx, bgra.get());
+    }
 };
 
 // ---------------------------------------------------------------------------
@@ -294,7 +1302,8 @@ CaptureEngine::~CaptureEngine() { stop(); }
 bool CaptureEngine::initialize(ID3D11Device* device,
                                 ID3D11DeviceContext* context,
                                 FrameQueue* queue,
-                                RecordingResolution max_resolution)
+                                RecordingResolution max_resolution,
+                                const CaptureSource& source)
 {
     // WinRT apartment: multi-threaded (matches COM init in wWinMain)
     try { winrt::init_apartment(winrt::apartment_type::multi_threaded); }
@@ -302,36 +1311,70 @@ bool CaptureEngine::initialize(ID3D11Device* device,
 
     // T039: reset device-lost flag for fresh session
     device_lost_.store(false, std::memory_order_relaxed);
+    suspended_.store(false, std::memory_order_relaxed);
+    device_isolated_ = false;
+    cross_adapter_   = false;
 
     impl_ = std::make_unique<CaptureEngineImpl>();
     impl_->d3d_device  = device;
     impl_->d3d_context = context;
-    impl_->queue       = queue;
+    impl_->main_.queue = queue;
     impl_->parent      = this;
-    QueryPerformanceFrequency(&impl_->qpc_freq);
-
-    // --- Build WinRT IDirect3DDevice wrapper from DXGI device ---
-    ComPtr<IDXGIDevice> dxgi_dev;
-    device->QueryInterface(IID_PPV_ARGS(&dxgi_dev));
-
-    winrt::com_ptr<::IInspectable> insp;
-    HRESULT hr = CreateDirect3D11DeviceFromDXGIDevice(dxgi_dev.Get(), insp.put());
-    if (FAILED(hr)) {
-        SR_LOG_ERROR(L"CreateDirect3D11DeviceFromDXGIDevice failed: 0x%08X", hr);
-        return false;
+    impl_->crop_       = source.crop;
+    impl_->nv12_slots_ = buffering_.nv12_slots;
+    impl_->pool_buffers_ = (std::clamp)(buffering_.pool_buffers, 1u, 4u);
+    impl_->want_cursor   = cursor_overlay_;
+    impl_->camera_pip    = camera_pip_;
+    impl_->pip_layout    = pip_layout_;
+    camera_mailbox_.clear();
+    cursor_overlay_active_ = false;
+    frames_overlay_only_.store(0, std::memory_order_relaxed);
+    if ((isolate_device_ || capture_adapter_) &&
+        impl_->create_isolated_device(device, context, capture_adapter_.Get())) {
+        SR_LOG_INFO(impl_->cross_adapter
+            ? L"Capture runs on the display adapter, encode on another (cross-adapter NV12 + shared fence)"
+            : L"Capture runs on its own D3D11 device (fence-synchronized NV12 hand-off)");
     }
-    impl_->winrt_device = insp.as<wdx3::IDirect3DDevice>();
+    HRESULT hr = S_OK;
 
-    // --- Primary monitor -> GraphicsCaptureItem ---
-    HMONITOR hmon = MonitorFromPoint({ 0, 0 }, MONITOR_DEFAULTTOPRIMARY);
+    // --- Capture source (monitor or window) -> GraphicsCaptureItem ---
     auto factory = winrt::get_activation_factory<
         wgc::GraphicsCaptureItem, IGraphicsCaptureItemInterop>();
 
-    hr = factory->CreateForMonitor(
-        hmon,
-        winrt::guid_of<wgc::GraphicsCaptureItem>(),
-        winrt::put_abi(impl_->item)
-    );
+    impl_->hdr_display = {};
+    const wchar_t* create_call = L"CreateForMonitor";
+    if (source.is_window()) {
+        HWND hwnd = resolve_window(source);
+        if (!hwnd) {
+            SR_LOG_ERROR(L"Capture window not found (title=\"%s\")", source.window_title.c_str());
+            return false;
+        }
+        wchar_t title[256]{};
+        GetWindowTextW(hwnd, title, static_cast<int>(_countof(title)));
+        SR_LOG_INFO(L"Capture source: window 0x%p \"%s\"", static_cast<void*>(hwnd), title);
+        create_call = L"CreateForWindow";
+        impl_->cursor_window = hwnd;
+        if (hdr_tonemap_) impl_->hdr_display = query_hdr_display(MonitorFromWindow(hwnd, MONITOR_DEFAULTTONEAREST));
+        hr = factory->CreateForWindow(
+            hwnd,
+            winrt::guid_of<wgc::GraphicsCaptureItem>(),
+            winrt::put_abi(impl_->item)
+        );
+    } else {
+        HMONITOR hmon = resolve_monitor(source);
+        impl_->cursor_monitor = hmon;
+        if (hdr_tonemap_) impl_->hdr_display = query_hdr_display(hmon);
+        MONITORINFOEXW mi{};
+        mi.cbSize = sizeof(mi);
+        GetMonitorInfoW(hmon, &mi);
+        SR_LOG_INFO(L"Capture source: monitor %u %s%s", source.monitor_index, mi.szDevice,
+                    (mi.dwFlags & MONITORINFOF_PRIMARY) ? L" (primary)" : L"");
+        hr = factory->CreateForMonitor(
+            hmon,
+            winrt::guid_of<wgc::GraphicsCaptureItem>(),
+            winrt::put_abi(impl_->item)
+        );
+    }
     if (FAILED(hr)) {
         // T043: Distinguish consent / permission denial from other WGC errors.
         // E_ACCESSDENIED means the user or policy blocked screen capture.
@@ -339,8 +1382,8 @@ bool CaptureEngine::initialize(ID3D11Device* device,
             SR_LOG_ERROR(L"[T043] WGC screen capture permission denied (E_ACCESSDENIED). "
                          L"Check Privacy Settings > Screen capture.");
         } else {
-            SR_LOG_ERROR(L"[T043] WGC CreateForMonitor failed: 0x%08X. "
-                         L"Ensure Windows 10 1903+ and screen capture is permitted.", hr);
+            SR_LOG_ERROR(L"[T043] WGC %s failed: 0x%08X. "
+                         L"Ensure Windows 10 1903+ and screen capture is permitted.", create_call, hr);
         }
         return false;
     }
@@ -352,41 +1395,177 @@ bool CaptureEngine::initialize(ID3D11Device* device,
     capture_height_ = source_height;
     SR_LOG_INFO(L"WGC item: %ux%u", capture_width_, capture_height_);
 
-    // T034: fix output resolution so encoder is never reset on runtime changes.
+    // Encode only the cropped region: output size derives from the crop
+    const FrameRect src_rect = effective_source_rect(source.crop, source_width, source_height);
+    if (!source.crop.empty()) {
+        SR_LOG_INFO(L"Capture crop: requested [%u,%u %ux%u] -> [%u,%u %ux%u]",
+                    source.crop.left, source.crop.top, source.crop.width(), source.crop.height(),
+                    src_rect.left, src_rect.top, src_rect.width(), src_rect.height());
+    }
+
+    // T034: fix output resolution so encoder is never reset on source changes
+    // (only an explicit request_output_resolution() changes it).
     // The controller passes the effective profile:
     // efficiency/default stays 848x480; HQ can request up to 1920x1080.
     const auto output_resolution =
-        clamp_recording_resolution(source_width, source_height, max_resolution);
-    impl_->out_width_ = output_resolution.width;
-    impl_->out_height_ = output_resolution.height;
+        clamp_recording_resolution(src_rect.width(), src_rect.height(), max_resolution);
+    impl_->main_.out_width  = output_resolution.width;
+    impl_->main_.out_height = output_resolution.height;
     SR_LOG_INFO(L"Recording output profile: source=%ux%u cap=%ux%u selected=%ux%u",
                 source_width, source_height,
                 max_resolution.width, max_resolution.height,
-                impl_->out_width_, impl_->out_height_);
+                impl_->main_.out_width, impl_->main_.out_height);
 
     // Expose actual encoder-feed dimensions (post-cap) to controller/profile setup.
-    capture_width_ = impl_->out_width_;
-    capture_height_ = impl_->out_height_;
+    capture_width_ = impl_->main_.out_width;
+    capture_height_ = impl_->main_.out_height;
+
+    // Proxy output: same source rect, never larger than the main output
+    proxy_width_ = proxy_height_ = 0;
+    proxy_stopped_.store(false, std::memory_order_relaxed);
+    pending_output_.store(0, std::memory_order_relaxed);
+    frames_proxy_dropped_.store(0, std::memory_order_relaxed);
+    frames_throttled_.store(0, std::memory_order_relaxed);
+    if (proxy_queue_) {
+        const auto proxy_resolution = clamp_recording_resolution(
+            capture_width_, capture_height_, proxy_resolution_);
+        impl_->proxy_.queue      = proxy_queue_;
+        impl_->proxy_.primary    = false;
+        impl_->proxy_.out_width  = proxy_resolution.width;
+        impl_->proxy_.out_height = proxy_resolution.height;
+    }
+
+    // --- BGRA -> NV12 Video Processor(s) or compute; FP16 tone mapping on HDR ---
+    impl_->want_hdr = impl_->hdr_display.hdr;
+    impl_->converter_mode     = nv12_converter_;
+    impl_->scale_filter       = nv12_filter_;
+    impl_->converter_measured = false;
+    impl_->use_compute        = false;
+    impl_->want_tap = frame_tap_;
+    hdr_active_ = false;
+    if (!impl_->setup_video_processor(source_width, source_height)) {
+        if (!impl_->isolated()) return false;
+        // Shared NV12 surfaces can be refused (e.g. with VIDEO_ENCODER binding)
+        SR_LOG_WARN(L"Isolated capture device setup failed — sharing the encoder device");
+        impl_->main_.release();
+        impl_->proxy_.release();
+        impl_->proxy_.queue  = proxy_queue_;
+        impl_->video_context = nullptr;
+        impl_->video_device  = nullptr;
+        impl_->cursor.release();
+        impl_->want_cursor   = cursor_overlay_;
+        impl_->tonemap.release();
+        impl_->want_hdr      = impl_->hdr_display.hdr;
+        impl_->nv12_compute.release();
+        impl_->converter_measured = false;
+        impl_->use_compute   = false;
+        impl_->tap.close();
+        impl_->want_tap      = frame_tap_;
+        impl_->drop_isolated_device();
+        impl_->d3d_device  = device;
+        impl_->d3d_context = context;
+        if (!impl_->setup_video_processor(source_width, source_height)) return false;
+    }
+    device_isolated_ = impl_->isolated();
+    cross_adapter_   = impl_->cross_adapter;
+    compute_converter_active_ = impl_->compute_path();
+    frame_tap_active_ = impl_->tap.ready();
+
+    // --- WinRT IDirect3DDevice wrapper for the frame pool (capture device) ---
+    ComPtr<IDXGIDevice> dxgi_dev;
+    impl_->d3d_device->QueryInterface(IID_PPV_ARGS(&dxgi_dev));
 
-    // --- BGRA -> NV12 Video Processor ---
-    if (!impl_->setup_video_processor(source_width, source_height,
-                                      impl_->out_width_, impl_->out_height_)) {
+    winrt::com_ptr<::IInspectable> insp;
+    hr = CreateDirect3D11DeviceFromDXGIDevice(dxgi_dev.Get(), insp.put());
+    if (FAILED(hr)) {
+        SR_LOG_ERROR(L"CreateDirect3D11DeviceFromDXGIDevice failed: 0x%08X", hr);
         return false;
     }
+    impl_->winrt_device = insp.as<wdx3::IDirect3DDevice>();
+    if (impl_->proxy_enabled()) {
+        proxy_width_  = impl_->proxy_.out_width;
+        proxy_height_ = impl_->proxy_.out_height;
+        SR_LOG_INFO(L"Proxy output: %ux%u", proxy_width_, proxy_height_);
+    }
+
+    // The cursor / camera overlay keeps the last frame's surface: one more pool buffer
+    if (impl_->cursor.ready() || impl_->camera_pip) ++impl_->pool_buffers_;
 
     // --- Free-threaded WGC frame pool ---
     impl_->frame_pool = wgc::Direct3D11CaptureFramePool::CreateFreeThreaded(
         impl_->winrt_device,
-        wdx::DirectXPixelFormat::B8G8R8A8UIntNormalized,
-        2,
+        impl_->wanted_pool_format(),
+        static_cast<int32_t>(impl_->pool_buffers_),
         size
     );
+    impl_->pool_format = impl_->wanted_pool_format();
+    hdr_active_ = impl_->tonemap.ready();
+    SR_LOG_INFO(L"WGC frame pool: %u buffers, %s", impl_->pool_buffers_,
+                hdr_active_ ? L"FP16 scRGB (HDR tone-mapped)" : L"BGRA8");
+    impl_->pool_size = size;
 
     impl_->session = impl_->frame_pool.CreateCaptureSession(impl_->item);
 
     // Disable yellow border (Win11 22H2+, non-fatal if unavailable)
     try { impl_->session.IsBorderRequired(false); } catch (...) {}
 
+    // Cursor overlay: WGC leaves the cursor out (Win10 2004+), we draw it
+    if (impl_->cursor.ready()) {
+        try {
+            impl_->session.IsCursorCaptureEnabled(false);
+            impl_->cursor_drawn = true;
+        } catch (...) {
+            impl_->drop_cursor_overlay();
+        }
+    }
+    cursor_overlay_active_ = impl_->cursor_drawn;
+    if (cursor_overlay_) {
+        SR_LOG_INFO(L"Cursor: %s", cursor_overlay_active_ ? L"drawn into NV12 (overlay-only deltas)" : L"WGC");
+    }
+    if (camera_pip_) {
+        SR_LOG_INFO(L"Camera PiP: composited into NV12 (%s)",
+                    impl_->tonemap.ready() || impl_->compute_path() || impl_->main_.vp_streams < 2
+                        ? L"separate blit" : L"second VP stream");
+    }
+
+    // Dirty-region reporting (Win11 24H2+) lets unchanged frames skip conversion and encode
+#if defined(SR_WGC_DIRTY_REGIONS)
+    try {
+        if (winrt::Windows::Foundation::Metadata::ApiInformation::IsPropertyPresent(
+                L"Windows.Graphics.Capture.GraphicsCaptureSession", L"DirtyRegionMode")) {
+            impl_->session.DirtyRegionMode(wgc::GraphicsCaptureDirtyRegionMode::ReportOnly);
+            impl_->dirty_regions_ = true;
+        }
+    } catch (...) {
+        impl_->dirty_regions_ = false;
+    }
+#endif
+    SR_LOG_INFO(L"WGC dirty regions: %s", impl_->dirty_regions_ ? L"reported" : L"unavailable");
+
+    // High-refresh monitors: WGC throttles itself where it can (24H2+); the
+    // arrival gate does the rest
+#if defined(SR_WGC_MIN_UPDATE_INTERVAL)
+    try {
+        impl_->min_update_interval = winrt::Windows::Foundation::Metadata::ApiInformation::IsPropertyPresent(
+            L"Windows.Graphics.Capture.GraphicsCaptureSession", L"MinUpdateInterval");
+    } catch (...) {
+        impl_->min_update_interval = false;
+    }
+#endif
+    const uint32_t rate_limit = frame_rate_limit_.load(std::memory_order_relaxed);
+    impl_->apply_min_update_interval(rate_limit);
+    SR_LOG_INFO(L"WGC rate limit: %u fps (%s)", rate_limit,
+                rate_limit == 0 ? L"off" : impl_->min_update_interval ? L"MinUpdateInterval + arrival gate"
+                                                                     : L"arrival gate");
+
+    // Captured window closed / monitor removed: the session stops delivering frames
+    impl_->closed_token = impl_->item.Closed(
+        [this](wgc::GraphicsCaptureItem const&, winrt::Windows::Foundation::IInspectable const&) {
+            SR_LOG_WARN(L"WGC capture item closed");
+            impl_->signal_source_closed();
+        }
+    );
+
     // Subscribe to frame-arrived events
     impl_->frame_token = impl_->frame_pool.FrameArrived(
         [this](wgc::Direct3D11CaptureFramePool const& pool,
@@ -403,27 +1582,70 @@ bool CaptureEngine::initialize(ID3D11Device* device,
 bool CaptureEngine::start() {
     if (!impl_) return false;
 
-    // Record absolute start time for PTS calculation
-    LARGE_INTEGER now{};
-    QueryPerformanceCounter(&now);
-    impl_->start_100ns = static_cast<int64_t>(
-        static_cast<double>(now.QuadPart) * 10'000'000.0 /
-        static_cast<double>(impl_->qpc_freq.QuadPart));
+    // Record the start tick; frame PTS is converted from the tick delta
+    impl_->start_ticks = QPCClock::ticks();
+
+    // Converts a frame the rate gate held back once its slot comes
+    impl_->flush_timer = CreateThreadpoolTimer(&CaptureEngineImpl::on_flush_timer, impl_.get(), nullptr);
 
     running_.store(true, std::memory_order_release);
     impl_->session.StartCapture();
+    camera_pip_active_.store(impl_->camera_pip, std::memory_order_release);
+    if (cursor_overlay_active_ || impl_->camera_pip) {
+        overlay_thread_ = std::thread([this]() {
+            // Cursor and monitor/window positions in physical pixels,
+            // whatever the process DPI awareness
+            SetThreadDpiAwarenessContext(DPI_AWARENESS_CONTEXT_PER_MONITOR_AWARE_V2);
+            const DWORD interval_ms = 1000 / (std::max)(cursor_poll_hz_, 1u);
+            while (running_.load(std::memory_order_acquire)) {
+                Sleep(interval_ms);
+                if (running_.load(std::memory_order_acquire)) impl_->on_overlay_poll();
+            }
+        });
+    }
     SR_LOG_INFO(L"WGC capture started");
     return true;
 }
 
+void CaptureEngine::set_frame_rate_limit(uint32_t fps) {
+    if (frame_rate_limit_.exchange(fps, std::memory_order_relaxed) == fps) return;
+    if (impl_ && impl_->session) impl_->apply_min_update_interval(fps);
+}
+
+void CaptureEngine::set_suspended(bool suspended) {
+    if (suspended_.exchange(suspended, std::memory_order_acq_rel) == suspended) return;
+    SR_LOG_INFO(L"WGC capture %s", suspended ? L"suspended (frames parked, no conversion)" : L"resumed");
+    if (!suspended && impl_ && running_.load(std::memory_order_acquire)) impl_->convert_parked();
+}
+
 void CaptureEngine::stop() {
     if (!impl_) return;
     running_.store(false, std::memory_order_release);
+    camera_pip_active_.store(false, std::memory_order_release);
+    if (overlay_thread_.joinable()) overlay_thread_.join();
+    // No new FrameArrived callbacks before the timer goes away
     try {
         impl_->frame_pool.FrameArrived(impl_->frame_token);
+        impl_->item.Closed(impl_->closed_token);
         impl_->session.Close();
         impl_->frame_pool.Close();
     } catch (...) {}
+    // A callback already running re-arms only under frame_mutex, and finds
+    // no timer after this; waiting outside the lock lets a running flush finish
+    PTP_TIMER flush_timer = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(impl_->frame_mutex);
+        flush_timer = std::exchange(impl_->flush_timer, nullptr);
+    }
+    if (flush_timer) {
+        SetThreadpoolTimer(flush_timer, nullptr, 0, 0);
+        WaitForThreadpoolTimerCallbacks(flush_timer, TRUE);
+        CloseThreadpoolTimer(flush_timer);
+    }
+    if (impl_->tap.ready()) {
+        SR_LOG_INFO(L"Frame tap: %llu frames published, %llu skipped (all slots held)",
+                    impl_->tap.published(), impl_->tap.skipped());
+    }
     impl_.reset();
     SR_LOG_INFO(L"WGC capture stopped");
 }
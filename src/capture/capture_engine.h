@@ -3,14 +3,23 @@
 // T010/T011: Captured frames converted to NV12 and pushed to BoundedQueue
 // T039: Device-lost callback for DXGI_ERROR_DEVICE_REMOVED recovery
 // T043: WGC availability check + consent error reporting
+// CaptureSource selects the monitor or window the WGC item is created for
+// Optional proxy output: a second, low-res NV12 stream from the same WGC frame
+// Optional frame tap: main-output NV12 frames shared with other processes
 // Uses PIMPL to keep WinRT types out of the header
 
 #include <windows.h>
 #include <d3d11.h>
+#include <dxgi.h>
 #include <wrl/client.h>
 #include <atomic>
 #include <functional>
 #include <memory>
+#include <thread>
+#include "capture/camera_pip.h"
+#include "capture/capture_source.h"
+#include "capture/nv12_converter.h"
+#include "sync/sync_manager.h"
 #include "utils/render_frame.h"
 #include "utils/bounded_queue.h"
 
@@ -19,7 +28,15 @@ namespace sr {
 using Microsoft::WRL::ComPtr;
 
 // Video frame queue — intentionally small for laptop RAM and latency
-using FrameQueue = BoundedQueue<RenderFrame, 3>;
+using FrameQueue = BoundedQueue<RenderFrame, 3, SingleProducer>;  // WGC frame-arrived callback only
+
+// GPU buffering for capture. Defaults track FrameQueue depth: every queued
+// frame, the one being encoded and the latest conversion (duplicate source)
+// each keep their own NV12 texture, plus one slot for the next blit.
+struct CaptureBuffering {
+    uint32_t nv12_slots   = static_cast<uint32_t>(FrameQueue::capacity()) + 2;  // clamped to [2, 8]
+    uint32_t pool_buffers = 2;   // WGC frame-pool buffers, clamped to [1, 4]
+};
 
 // Forward declare the PIMPL impl class (defined in capture_engine.cpp)
 struct CaptureEngineImpl;
@@ -28,6 +45,10 @@ struct CaptureEngineImpl;
 // Invoked from the WGC frame-arrived callback thread — must be thread-safe.
 using DeviceLostCallback = std::function<void()>;
 
+// Callback fired when the capture item goes away (captured window closed,
+// monitor detached). Invoked from a WGC thread — must be thread-safe.
+using SourceClosedCallback = std::function<void()>;
+
 class CaptureEngine {
     friend struct CaptureEngineImpl;  // allows PIMPL to access private counters
 public:
@@ -41,28 +62,169 @@ public:
     // Initialize:
     //   device/context — the D3D11 device to borrow for WGC interop and NV12 conversion
     //   queue          — output queue (owned by caller)
+    //   source         — monitor or window to capture (default: primary monitor)
     bool initialize(ID3D11Device* device,
                     ID3D11DeviceContext* context,
                     FrameQueue* queue,
-                    RecordingResolution max_resolution = kEfficiencyRecordingResolution);
+                    RecordingResolution max_resolution = kEfficiencyRecordingResolution,
+                    const CaptureSource& source = {});
 
     bool start();
     void stop();
 
+    // NV12 ring depth / WGC frame-pool size — call before initialize().
+    // More slots trade VRAM for fewer drops when the encoder falls behind.
+    void set_buffering(const CaptureBuffering& buffering) { buffering_ = buffering; }
+
+    // Run WGC and the BGRA->NV12 conversion on a separate D3D11 device on the
+    // same adapter — call before initialize(). The capture thread then never
+    // contends for the encoder's immediate-context lock; frames carry a shared
+    // fence the consumer must GPU-wait on (wait_for_gpu_producer) before
+    // reading the texture, and a release fence it signals once per pass
+    // (release_gpu_reads) so a slot is rewritten only after those reads.
+    // Falls back to the shared device when D3D11.4 fences, a consumer
+    // ID3D11DeviceContext4 or shared NV12 surfaces are unavailable.
+    void set_isolated_device(bool enabled) { isolate_device_ = enabled; }
+    // True when the last initialize() set up an isolated device (frames are fenced)
+    bool device_isolated() const { return device_isolated_; }
+
+    // Cross-adapter encode (AdapterPolicy::LowestContention) — call before
+    // initialize(). Non-null: the isolated device is created on `adapter`
+    // (the one scanning out the captured monitor) while the encoder device
+    // passed to initialize() lives on another GPU. NV12 slots are then
+    // cross-adapter shared surfaces and both fences are shared across adapters.
+    // Drivers that refuse either fall back to the encoder device, i.e. WGC
+    // copies every frame across adapters as without the split.
+    void set_capture_adapter(IDXGIAdapter* adapter) { capture_adapter_ = adapter; }
+    // True when the last initialize() split capture and encode across adapters
+    bool cross_adapter() const { return cross_adapter_; }
+
+    // Draw the cursor ourselves — call before initialize(). WGC then captures
+    // without it (IsCursorCaptureEnabled(false)), so mouse moves stop
+    // producing whole-screen changes; a poll thread reads GetCursorInfo at
+    // poll_hz and, when only the cursor changed, re-blits the last frame with
+    // the cursor moved. Those frames carry RenderFrame::overlay_only and a
+    // dirty region of just the old and new cursor rectangles. Falls back to
+    // WGC's cursor when the device can't render to NV12.
+    void set_cursor_overlay(bool enabled, uint32_t poll_hz = 120) {
+        cursor_overlay_ = enabled;
+        cursor_poll_hz_ = poll_hz;
+    }
+    // True when the last initialize() took the cursor off WGC
+    bool cursor_overlay_active() const { return cursor_overlay_active_; }
+
+    // Blend camera frames into the NV12 output at `layout` — call before
+    // initialize(). While recording, post_camera_frame frames are uploaded
+    // once and composited by the video processor (a second input stream),
+    // so the camera no longer depends on the preview window being captured.
+    void set_camera_pip(bool enabled, const PipLayout& layout = {}) {
+        camera_pip_ = enabled;
+        pip_layout_ = layout;
+    }
+    // Top-down 32-bit BGRX camera frame, any thread; ignored unless a PiP
+    // session is running. A new frame re-composites even a static desktop.
+    void post_camera_frame(const uint8_t* bgrx, uint32_t width, uint32_t height, size_t stride) {
+        if (camera_pip_active_.load(std::memory_order_acquire)) {
+            camera_mailbox_.post(bgrx, width, height, stride);
+        }
+    }
+
+    // On an HDR monitor, capture FP16 scRGB and tone-map it to SDR BT.709
+    // NV12 in one GPU pass (default on) — call before initialize(). Off, or
+    // when the device can't do it, WGC's BGRA8 rendition is recorded.
+    void set_hdr_tone_mapping(bool enabled) { hdr_tonemap_ = enabled; }
+    // True when the last initialize() set up the FP16 tone-mapping path
+    bool hdr_active() const { return hdr_active_; }
+
+    // BGRA -> NV12 converter — call before initialize(). Auto times the
+    // video processor against the compute-shader path on the capture
+    // adapter and keeps the faster one; `filter` is the compute path's
+    // downscale quality. HDR tone mapping replaces either.
+    void set_nv12_converter(Nv12ConverterMode mode, Nv12ScaleFilter filter = Nv12ScaleFilter::Bilinear) {
+        nv12_converter_ = mode;
+        nv12_filter_    = filter;
+    }
+    // True when the last initialize() chose the compute-shader path
+    bool compute_converter_active() const { return compute_converter_active_; }
+
+    // Dual output — call before initialize(). Every captured frame is also
+    // blitted (second VideoProcessorBlt, same pts) at up to `max_resolution`
+    // into its own NV12 ring and pushed to `queue`. Proxy drops are counted
+    // separately and never cost the main output a frame. nullptr disables.
+    void set_proxy_output(FrameQueue* queue, RecordingResolution max_resolution) {
+        proxy_queue_      = queue;
+        proxy_resolution_ = max_resolution;
+    }
+
+    // Publish every main-output frame to external consumers through shared
+    // keyed-mutex NV12 textures and a named header (frame_tap_layout.h) —
+    // call before initialize(). Costs one GPU copy per frame; a consumer
+    // holding every slot only makes frames go untapped.
+    void set_frame_tap(bool enabled) { frame_tap_ = enabled; }
+    // True when the last initialize() opened the tap
+    bool frame_tap_active() const { return frame_tap_active_; }
+
+    // Stop feeding the proxy queue after initialize() (e.g. its encoder could
+    // not be opened) — saves the second blit. Thread-safe.
+    void stop_proxy_output() { proxy_stopped_.store(true, std::memory_order_release); }
+
+    // Change the main NV12 output size while capturing (power-profile switch).
+    // The capture thread rebuilds the main video processor on the next frame;
+    // frames report the new size from then on. Source resizes still keep the
+    // output fixed. The proxy output is unaffected. Thread-safe.
+    void request_output_resolution(RecordingResolution max_resolution) {
+        pending_output_.store((static_cast<uint64_t>(max_resolution.width) << 32) | max_resolution.height,
+                              std::memory_order_release);
+    }
+
+    // Convert at most `fps` WGC frames per second (0 = every delivery):
+    // the target encoder rate, so a 144 Hz monitor doesn't cost 144 VP blits
+    // a second for a 30 fps recording. Frames ahead of the next slot are held
+    // unconverted; the newest one is converted when the slot comes unless a
+    // newer frame takes it. Windows 11 24H2+ also sets the session's
+    // MinUpdateInterval. Before initialize() or while capturing, any thread.
+    void set_frame_rate_limit(uint32_t fps);
+
+    // Pause: WGC frames are no longer converted or queued (no VP blit, no
+    // cursor / camera re-blits, proxy or tap); the newest surface is parked
+    // instead. Resuming converts it once, so the first frame after a pause
+    // shows the screen as it is then. Thread-safe.
+    void set_suspended(bool suspended);
+    bool suspended() const { return suspended_.load(std::memory_order_relaxed); }
+
     // T039: Register a callback fired when the D3D11 device is lost.
     // The controller should stop capture and optionally attempt re-initialization.
     void set_device_lost_callback(DeviceLostCallback cb) { device_lost_cb_ = std::move(cb); }
 
+    // Register a callback fired once when the captured window/monitor closes
+    void set_source_closed_callback(SourceClosedCallback cb) { source_closed_cb_ = std::move(cb); }
+
     // Live counters (thread-safe reads)
     uint32_t frames_captured() const { return frames_captured_.load(std::memory_order_relaxed); }
     uint32_t frames_dropped()  const { return frames_dropped_.load(std::memory_order_relaxed); }
+    // Frames dropped because every NV12 slot was still held downstream
+    uint32_t frames_ring_full() const { return frames_ring_full_.load(std::memory_order_relaxed); }
+    // Frames flagged is_duplicate from an empty WGC dirty-region report
+    uint32_t frames_unchanged() const { return frames_unchanged_.load(std::memory_order_relaxed); }
+    // Frames re-composited by the overlay poll thread (overlay_only)
+    uint32_t frames_overlay_only() const { return frames_overlay_only_.load(std::memory_order_relaxed); }
+    // WGC frames the rate limit held back (not converted)
+    uint32_t frames_throttled() const { return frames_throttled_.load(std::memory_order_relaxed); }
+    // Proxy frames lost to a full proxy ring or queue
+    uint32_t frames_proxy_dropped() const { return frames_proxy_dropped_.load(std::memory_order_relaxed); }
 
-    // Set QPC-based PTS anchor (call between initialize and start)
-    void set_sync_anchor_100ns(int64_t anchor) { pts_anchor_100ns_ = anchor; }
+    // Session clock for frame PTS (call between initialize and start; the
+    // manager must be started before start()). Frames are stamped with their
+    // WGC compose time (SystemRelativeTime) mapped through it; without one,
+    // PTS is callback time relative to start().
+    void set_sync_manager(const SyncManager* sync) { sync_ = sync; }
 
     // Capture dimensions (valid after initialize)
     uint32_t width()  const { return capture_width_; }
     uint32_t height() const { return capture_height_; }
+    // Proxy dimensions; 0x0 when no proxy output is active (valid after initialize)
+    uint32_t proxy_width()  const { return proxy_width_; }
+    uint32_t proxy_height() const { return proxy_height_; }
 
 private:
     std::unique_ptr<CaptureEngineImpl> impl_;
@@ -71,10 +233,44 @@ private:
     std::atomic<bool>     device_lost_      { false }; // T039: set when DXGI device removed
     std::atomic<uint32_t> frames_captured_  { 0 };
     std::atomic<uint32_t> frames_dropped_   { 0 };
-    int64_t               pts_anchor_100ns_ = 0;
+    std::atomic<uint32_t> frames_unchanged_ { 0 };
+    std::atomic<uint32_t> frames_ring_full_ { 0 };
+    std::atomic<uint32_t> frames_proxy_dropped_ { 0 };
+    std::atomic<uint32_t> frames_overlay_only_ { 0 };
+    std::atomic<uint32_t> frames_throttled_ { 0 };
+    std::atomic<uint32_t> frame_rate_limit_ { 0 };      // fps; 0 = off
+    std::atomic<bool>     proxy_stopped_    { false };
+    std::atomic<bool>     suspended_        { false };
+    std::atomic<uint64_t> pending_output_   { 0 };     // width << 32 | height; 0 = none
+    CaptureBuffering      buffering_;
+    bool                  isolate_device_   = false;
+    bool                  device_isolated_  = false;
+    ComPtr<IDXGIAdapter>  capture_adapter_;
+    bool                  cross_adapter_    = false;
+    bool                  cursor_overlay_   = false;
+    bool                  cursor_overlay_active_ = false;
+    bool                  hdr_tonemap_      = true;
+    bool                  hdr_active_       = false;
+    Nv12ConverterMode     nv12_converter_   = Nv12ConverterMode::Auto;
+    Nv12ScaleFilter       nv12_filter_      = Nv12ScaleFilter::Bilinear;
+    bool                  compute_converter_active_ = false;
+    bool                  frame_tap_        = false;
+    bool                  frame_tap_active_ = false;
+    uint32_t              cursor_poll_hz_   = 120;
+    std::thread           overlay_thread_;  // cursor / camera overlay poll
+    bool                  camera_pip_       = false;
+    PipLayout             pip_layout_;
+    std::atomic<bool>     camera_pip_active_{ false };
+    CameraMailbox         camera_mailbox_;  // outlives impl_: the camera thread posts into it
+    FrameQueue*           proxy_queue_      = nullptr;
+    RecordingResolution   proxy_resolution_ = kEfficiencyRecordingResolution;
+    uint32_t              proxy_width_      = 0;
+    uint32_t              proxy_height_     = 0;
+    const SyncManager*    sync_             = nullptr;
     uint32_t              capture_width_    = 0;
     uint32_t              capture_height_   = 0;
     DeviceLostCallback    device_lost_cb_;  // T039
+    SourceClosedCallback  source_closed_cb_;
 };
 
 } // namespace sr
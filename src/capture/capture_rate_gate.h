@@ -0,0 +1,51 @@
+#pragma once
+// capture_rate_gate.h — Source-side frame-rate limit for WGC deliveries
+//
+// WGC fires FrameArrived at the monitor's refresh rate (120/144 Hz) whenever
+// the content changes; a 30 fps recording keeps one frame in four or five.
+// The gate decides on arrival, before the BGRA->NV12 conversion, which
+// frames the encoder will want: one per slot of a fixed grid at the target
+// interval. A frame up to a quarter interval early takes its slot, so
+// refresh-aligned arrivals (34.7 ms apart at 144 Hz for a 33.3 ms target)
+// don't beat against the grid and halve the rate.
+//
+// A turned-away frame is not lost: the caller holds it and converts it at
+// next_due() unless a newer frame takes the slot first, so the last change
+// before the screen goes static is still recorded.
+
+#include <cstdint>
+
+namespace sr {
+
+class CaptureRateGate {
+public:
+    // 0 = no limit; the grid restarts at the next admitted frame
+    void set_fps(uint32_t fps) {
+        const int64_t interval = fps > 0 ? 10'000'000LL / fps : 0;
+        if (interval == interval_) return;
+        interval_ = interval;
+        next_due_ = -1;
+    }
+    uint32_t fps() const { return interval_ > 0 ? static_cast<uint32_t>(10'000'000LL / interval_) : 0; }
+
+    void reset() { next_due_ = -1; }
+
+    // `pts` in 100 ns on any monotonic clock. True: convert this frame.
+    bool admit(int64_t pts) {
+        if (interval_ <= 0) return true;
+        if (next_due_ >= 0 && pts < next_due_ - interval_ / 4) return false;
+        // After a gap (static screen) the grid restarts at this frame
+        next_due_ = next_due_ >= 0 && pts < next_due_ + interval_ ? next_due_ + interval_
+                                                                  : pts + interval_;
+        return true;
+    }
+
+    // Grid time of the next slot (-1 before the first admitted frame)
+    int64_t next_due() const { return next_due_; }
+
+private:
+    int64_t interval_ = 0;    // 100 ns; 0 = off
+    int64_t next_due_ = -1;
+};
+
+} // namespace sr
@@ -0,0 +1,170 @@
+#pragma once
+// capture_source.h — What the capture engine records: a monitor or a single window
+//
+// WGC creates its capture item with IGraphicsCaptureItemInterop::CreateForMonitor
+// or CreateForWindow. Capturing only the wanted monitor/window keeps the frame
+// pool, VP input and dirty-region work proportional to that surface instead of
+// always grabbing (and downscaling) the primary desktop.
+//
+// Monitors are addressed by HMONITOR or by index: index 0 is always the primary
+// monitor, 1.. are the remaining monitors in EnumDisplayMonitors order.
+// Windows are addressed by HWND or by a case-insensitive title substring which
+// is resolved when the session starts.
+//
+// An optional crop rectangle (source pixels) limits capture to a sub-region;
+// the VideoProcessor crops and scales in the same blit, so the encoder never
+// sees the discarded pixels.
+
+#include <windows.h>
+#include <dwmapi.h>
+#include <cstdint>
+#include <cwctype>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "utils/dirty_region.h"
+#pragma comment(lib, "dwmapi.lib")
+
+namespace sr {
+
+struct CaptureSource {
+    enum class Kind { PrimaryMonitor, Monitor, Window };
+
+    Kind         kind          = Kind::PrimaryMonitor;
+    HMONITOR     monitor       = nullptr;  // Monitor: explicit handle ...
+    uint32_t     monitor_index = 0;        // ... or index when monitor == nullptr
+    HWND         window        = nullptr;  // Window: explicit handle ...
+    std::wstring window_title;             // ... or title substring when window == nullptr
+    FrameRect    crop;                     // source sub-rect; empty = whole surface
+
+    static CaptureSource primary() { return {}; }
+
+    static CaptureSource monitor_at(uint32_t index) {
+        CaptureSource s;
+        s.kind = index == 0 ? Kind::PrimaryMonitor : Kind::Monitor;
+        s.monitor_index = index;
+        return s;
+    }
+
+    static CaptureSource from_monitor(HMONITOR hmon) {
+        CaptureSource s;
+        s.kind = Kind::Monitor;
+        s.monitor = hmon;
+        return s;
+    }
+
+    static CaptureSource from_window(HWND hwnd) {
+        CaptureSource s;
+        s.kind = Kind::Window;
+        s.window = hwnd;
+        return s;
+    }
+
+    static CaptureSource window_titled(std::wstring title) {
+        CaptureSource s;
+        s.kind = Kind::Window;
+        s.window_title = std::move(title);
+        return s;
+    }
+
+    bool is_window() const { return kind == Kind::Window; }
+};
+
+// Source rectangle actually blitted for a width x height surface: the crop
+// clipped to the surface and snapped to even coordinates (NV12 chroma is 2x2
+// subsampled). Falls back to the whole surface when no usable crop remains,
+// e.g. a window shrank below the requested region.
+inline FrameRect effective_source_rect(const FrameRect& crop, uint32_t width, uint32_t height) {
+    const FrameRect full{ 0, 0, width, height };
+    if (crop.empty()) return full;
+    FrameRect r = crop.intersected(full);
+    r.left   &= ~1u;
+    r.top    &= ~1u;
+    r.right  &= ~1u;
+    r.bottom &= ~1u;
+    return r.empty() ? full : r;
+}
+
+// Case-insensitive substring match used for window lookup by title
+inline bool title_matches(std::wstring_view title, std::wstring_view needle) {
+    if (needle.empty()) return false;
+    if (needle.size() > title.size()) return false;
+    for (size_t i = 0; i + needle.size() <= title.size(); ++i) {
+        size_t j = 0;
+        while (j < needle.size() &&
+               std::towlower(title[i + j]) == std::towlower(needle[j])) {
+            ++j;
+        }
+        if (j == needle.size()) return true;
+    }
+    return false;
+}
+
+// All attached monitors, primary first
+inline std::vector<HMONITOR> enumerate_monitors() {
+    std::vector<HMONITOR> monitors;
+    const HMONITOR primary = MonitorFromPoint({ 0, 0 }, MONITOR_DEFAULTTOPRIMARY);
+    if (primary) monitors.push_back(primary);
+    EnumDisplayMonitors(nullptr, nullptr,
+        [](HMONITOR hmon, HDC, LPRECT, LPARAM param) -> BOOL {
+            auto* list = reinterpret_cast<std::vector<HMONITOR>*>(param);
+            if (list->empty() || hmon != list->front()) list->push_back(hmon);
+            return TRUE;
+        },
+        reinterpret_cast<LPARAM>(&monitors));
+    return monitors;
+}
+
+// Visible, uncloaked top-level window of another process whose title contains `needle`
+inline HWND find_window_by_title(const std::wstring& needle) {
+    struct Search { const std::wstring* needle; HWND found; };
+    Search search{ &needle, nullptr };
+    EnumWindows(
+        [](HWND hwnd, LPARAM param) -> BOOL {
+            auto* s = reinterpret_cast<Search*>(param);
+            if (!IsWindowVisible(hwnd) || IsIconic(hwnd)) return TRUE;
+            DWORD pid = 0;
+            GetWindowThreadProcessId(hwnd, &pid);
+            if (pid == GetCurrentProcessId()) return TRUE;
+            BOOL cloaked = FALSE;
+            if (SUCCEEDED(DwmGetWindowAttribute(hwnd, DWMWA_CLOAKED, &cloaked, sizeof(cloaked))) &&
+                cloaked) {
+                return TRUE;
+            }
+            wchar_t title[256]{};
+            if (GetWindowTextW(hwnd, title, static_cast<int>(_countof(title))) <= 0) return TRUE;
+            if (!title_matches(title, *s->needle)) return TRUE;
+            s->found = hwnd;
+            return FALSE;
+        },
+        reinterpret_cast<LPARAM>(&search));
+    return search.found;
+}
+
+// Monitor handle for a monitor source; falls back to the primary monitor when
+// the index no longer exists (monitor unplugged since settings were saved).
+inline HMONITOR resolve_monitor(const CaptureSource& source) {
+    if (source.monitor) return source.monitor;
+    if (source.kind == CaptureSource::Kind::Monitor && source.monitor_index > 0) {
+        const auto monitors = enumerate_monitors();
+        if (source.monitor_index < monitors.size()) return monitors[source.monitor_index];
+    }
+    return MonitorFromPoint({ 0, 0 }, MONITOR_DEFAULTTOPRIMARY);
+}
+
+// Window handle for a window source, or nullptr if no such window exists
+inline HWND resolve_window(const CaptureSource& source) {
+    if (source.window) return IsWindow(source.window) ? source.window : nullptr;
+    return find_window_by_title(source.window_title);
+}
+
+// Monitor the source is shown on: the monitor itself, or the one holding most
+// of the window (primary if the window is gone)
+inline HMONITOR resolve_display_monitor(const CaptureSource& source) {
+    if (source.kind != CaptureSource::Kind::Window) return resolve_monitor(source);
+    const HWND hwnd = resolve_window(source);
+    return hwnd ? MonitorFromWindow(hwnd, MONITOR_DEFAULTTOPRIMARY)
+                : MonitorFromPoint({ 0, 0 }, MONITOR_DEFAULTTOPRIMARY);
+}
+
+} // namespace sr
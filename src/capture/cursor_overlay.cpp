@@ -0,0 +1,280 @@
+// cursor_overlay.cpp — GDI cursor shape -> BGRA texture, blended into NV12 planes
+#include "capture/cursor_overlay.h"
+#include "utils/logging.h"
+
+#include <d3dcompiler.h>
+#include <cstring>
+#include <vector>
+#pragma comment(lib, "d3dcompiler.lib")
+
+using Microsoft::WRL::ComPtr;
+
+namespace sr {
+
+namespace {
+
+// Full-viewport triangle; the viewport is the cursor quad. The image is
+// premultiplied, so premultiplied Y/Cb/Cr = M * rgb + alpha * offset.
+constexpr char kShaderSource[] = R"(
+Texture2D    cursor_tex : register(t0);
+SamplerState cursor_smp : register(s0);
+
+struct VsOut { float4 pos : SV_Position; float2 uv : TEXCOORD0; };
+
+VsOut vs_main(uint id : SV_VertexID) {
+    VsOut o;
+    o.uv  = float2((id << 1) & 2, id & 2);
+    o.pos = float4(o.uv * float2(2, -2) + float2(-1, 1), 0, 1);
+    return o;
+}
+
+float4 ps_luma(VsOut i) : SV_Target {
+    float4 c = cursor_tex.Sample(cursor_smp, i.uv);
+    float  y = dot(c.rgb, float3(0.1826, 0.6142, 0.0620)) + 0.0627 * c.a;
+    return float4(y, 0, 0, c.a);
+}
+
+float4 ps_chroma(VsOut i) : SV_Target {
+    float4 c = cursor_tex.Sample(cursor_smp, i.uv);
+    float  u = dot(c.rgb, float3(-0.1007, -0.3386,  0.4392)) + 0.5020 * c.a;
+    float  v = dot(c.rgb, float3( 0.4392, -0.3990, -0.0403)) + 0.5020 * c.a;
+    return float4(u, v, 0, c.a);
+}
+)";
+
+bool compile(const char* entry, const char* target, ComPtr<ID3DBlob>& code) {
+    ComPtr<ID3DBlob> errors;
+    const HRESULT hr = D3DCompile(kShaderSource, sizeof(kShaderSource) - 1, "cursor_overlay",
+                                  nullptr, nullptr, entry, target,
+                                  D3DCOMPILE_OPTIMIZATION_LEVEL3, 0, &code, &errors);
+    if (FAILED(hr)) {
+        SR_LOG_ERROR(L"Cursor shader %S failed: 0x%08X %S", entry, hr,
+                     errors ? static_cast<const char*>(errors->GetBufferPointer()) : "");
+        return false;
+    }
+    return true;
+}
+
+// 32bpp top-down DIB the cursor is drawn into
+struct CursorCanvas {
+    HDC     dc   = nullptr;
+    HBITMAP bmp  = nullptr;
+    HGDIOBJ old  = nullptr;
+    uint32_t* px = nullptr;
+
+    CursorCanvas(HDC screen, uint32_t w, uint32_t h) {
+        BITMAPINFO bi{};
+        bi.bmiHeader.biSize     = sizeof(bi.bmiHeader);
+        bi.bmiHeader.biWidth    = static_cast<LONG>(w);
+        bi.bmiHeader.biHeight   = -static_cast<LONG>(h);
+        bi.bmiHeader.biPlanes   = 1;
+        bi.bmiHeader.biBitCount = 32;
+        dc  = CreateCompatibleDC(screen);
+        bmp = CreateDIBSection(screen, &bi, DIB_RGB_COLORS, reinterpret_cast<void**>(&px), nullptr, 0);
+        if (dc && bmp) old = SelectObject(dc, bmp);
+    }
+    ~CursorCanvas() {
+        if (old) SelectObject(dc, old);
+        if (bmp) DeleteObject(bmp);
+        if (dc)  DeleteDC(dc);
+    }
+    bool ok() const { return dc && bmp && px; }
+};
+
+} // namespace
+
+bool CursorOverlay::initialize(ID3D11Device* device) {
+    release();
+    if (!nv12_render_target_supported(device)) {
+        SR_LOG_WARN(L"Cursor overlay: device cannot render to NV12");
+        return false;
+    }
+
+    ComPtr<ID3DBlob> vs, ps_y, ps_uv;
+    if (!compile("vs_main", "vs_5_0", vs) || !compile("ps_luma", "ps_5_0", ps_y) ||
+        !compile("ps_chroma", "ps_5_0", ps_uv)) {
+        return false;
+    }
+    HRESULT hr = device->CreateVertexShader(vs->GetBufferPointer(), vs->GetBufferSize(), nullptr, &vs_);
+    if (SUCCEEDED(hr)) hr = device->CreatePixelShader(ps_y->GetBufferPointer(), ps_y->GetBufferSize(),
+                                                      nullptr, &ps_luma_);
+    if (SUCCEEDED(hr)) hr = device->CreatePixelShader(ps_uv->GetBufferPointer(), ps_uv->GetBufferSize(),
+                                                      nullptr, &ps_chroma_);
+
+    D3D11_BLEND_DESC bd{};
+    bd.RenderTarget[0].BlendEnable           = TRUE;
+    bd.RenderTarget[0].SrcBlend              = D3D11_BLEND_ONE;
+    bd.RenderTarget[0].DestBlend             = D3D11_BLEND_INV_SRC_ALPHA;
+    bd.RenderTarget[0].BlendOp               = D3D11_BLEND_OP_ADD;
+    bd.RenderTarget[0].SrcBlendAlpha         = D3D11_BLEND_ONE;
+    bd.RenderTarget[0].DestBlendAlpha        = D3D11_BLEND_INV_SRC_ALPHA;
+    bd.RenderTarget[0].BlendOpAlpha          = D3D11_BLEND_OP_ADD;
+    bd.RenderTarget[0].RenderTargetWriteMask = D3D11_COLOR_WRITE_ENABLE_ALL;
+    if (SUCCEEDED(hr)) hr = device->CreateBlendState(&bd, &blend_);
+
+    D3D11_SAMPLER_DESC sd{};
+    sd.Filter   = D3D11_FILTER_MIN_MAG_MIP_LINEAR;
+    sd.AddressU = sd.AddressV = sd.AddressW = D3D11_TEXTURE_ADDRESS_CLAMP;
+    sd.MaxLOD   = D3D11_FLOAT32_MAX;
+    if (SUCCEEDED(hr)) hr = device->CreateSamplerState(&sd, &sampler_);
+
+    D3D11_RASTERIZER_DESC rd{};
+    rd.FillMode        = D3D11_FILL_SOLID;
+    rd.CullMode        = D3D11_CULL_NONE;
+    rd.DepthClipEnable = TRUE;
+    if (SUCCEEDED(hr)) hr = device->CreateRasterizerState(&rd, &raster_);
+
+    if (FAILED(hr)) {
+        SR_LOG_ERROR(L"Cursor overlay pipeline state failed: 0x%08X", hr);
+        release();
+        return false;
+    }
+    device_ = device;
+    return true;
+}
+
+void CursorOverlay::release() {
+    shape_srv_.Reset();
+    raster_.Reset();
+    sampler_.Reset();
+    blend_.Reset();
+    ps_chroma_.Reset();
+    ps_luma_.Reset();
+    vs_.Reset();
+    device_.Reset();
+    shape_   = nullptr;
+    shape_w_ = shape_h_ = 0;
+    visible_ = false;
+}
+
+bool CursorOverlay::poll(POINT content_origin) {
+    CURSORINFO ci{};
+    ci.cbSize = sizeof(ci);
+    const bool showing = GetCursorInfo(&ci) && (ci.flags & CURSOR_SHOWING) && ci.hCursor;
+    if (!showing) {
+        const bool changed = visible_;
+        visible_ = false;
+        return changed;
+    }
+
+    bool changed = !visible_;
+    if (ci.hCursor != shape_) {
+        if (!update_shape(ci.hCursor)) {
+            visible_ = false;
+            return changed;
+        }
+        changed = true;
+    }
+    const int32_t x = ci.ptScreenPos.x - hotspot_.x - content_origin.x;
+    const int32_t y = ci.ptScreenPos.y - hotspot_.y - content_origin.y;
+    changed = changed || x != x_ || y != y_;
+    x_ = x;
+    y_ = y;
+    visible_ = true;
+    return changed;
+}
+
+bool CursorOverlay::update_shape(HCURSOR cursor) {
+    shape_ = cursor;
+    shape_srv_.Reset();
+
+    ICONINFO ii{};
+    if (!GetIconInfo(cursor, &ii)) return false;
+    BITMAP bm{};
+    GetObjectW(ii.hbmColor ? ii.hbmColor : ii.hbmMask, sizeof(bm), &bm);
+    const uint32_t w = static_cast<uint32_t>(bm.bmWidth);
+    // Monochrome cursors stack the AND and XOR masks in one bitmap
+    const uint32_t h = static_cast<uint32_t>(ii.hbmColor ? bm.bmHeight : bm.bmHeight / 2);
+    hotspot_ = { static_cast<LONG>(ii.xHotspot), static_cast<LONG>(ii.yHotspot) };
+    if (ii.hbmColor) DeleteObject(ii.hbmColor);
+    if (ii.hbmMask)  DeleteObject(ii.hbmMask);
+    if (w == 0 || h == 0 || w > 256 || h > 256) return false;
+
+    // Same cursor over black and over white: alpha = 1 - (white - black),
+    // black result = colour * alpha (already premultiplied)
+    HDC screen = GetDC(nullptr);
+    CursorCanvas on_black(screen, w, h), on_white(screen, w, h);
+    ReleaseDC(nullptr, screen);
+    if (!on_black.ok() || !on_white.ok()) return false;
+    std::memset(on_black.px, 0x00, size_t{ w } * h * 4);
+    std::memset(on_white.px, 0xFF, size_t{ w } * h * 4);
+    DrawIconEx(on_black.dc, 0, 0, cursor, static_cast<int>(w), static_cast<int>(h), 0, nullptr, DI_NORMAL);
+    DrawIconEx(on_white.dc, 0, 0, cursor, static_cast<int>(w), static_cast<int>(h), 0, nullptr, DI_NORMAL);
+    GdiFlush();
+
+    std::vector<uint32_t> bgra(size_t{ w } * h);
+    for (size_t i = 0; i < bgra.size(); ++i) {
+        const uint32_t b = on_black.px[i], wt = on_white.px[i];
+        int diff = -256;            // largest per-channel white - black
+        for (int shift = 0; shift < 24; shift += 8) {
+            diff = (std::max)(diff, static_cast<int>((wt >> shift) & 0xFF) -
+                                    static_cast<int>((b >> shift) & 0xFF));
+        }
+        uint32_t alpha = static_cast<uint32_t>(255 - diff);
+        uint32_t color = b & 0x00FFFFFFu;
+        if (diff < 0) {             // inverting pixel: white over black, black over white
+            alpha = 255;
+            color = 0x00FFFFFFu;
+        }
+        bgra[i] = color | (alpha << 24);
+    }
+
+    D3D11_TEXTURE2D_DESC td{};
+    td.Width            = w;
+    td.Height           = h;
+    td.MipLevels        = 1;
+    td.ArraySize        = 1;
+    td.Format           = DXGI_FORMAT_B8G8R8A8_UNORM;
+    td.SampleDesc.Count = 1;
+    td.Usage            = D3D11_USAGE_IMMUTABLE;
+    td.BindFlags        = D3D11_BIND_SHADER_RESOURCE;
+    D3D11_SUBRESOURCE_DATA init{ bgra.data(), w * 4, 0 };
+    ComPtr<ID3D11Texture2D> tex;
+    HRESULT hr = device_->CreateTexture2D(&td, &init, &tex);
+    if (SUCCEEDED(hr)) hr = device_->CreateShaderResourceView(tex.Get(), nullptr, &shape_srv_);
+    if (FAILED(hr)) {
+        SR_LOG_WARN(L"Cursor shape texture failed: 0x%08X", hr);
+        return false;
+    }
+    shape_w_ = w;
+    shape_h_ = h;
+    return true;
+}
+
+void CursorOverlay::draw(ID3D11DeviceContext* ctx, const Nv12PlaneViews& views, const CursorQuad& q) const {
+    if (!ready() || !visible() || !views || q.empty()) return;
+    ID3D11RenderTargetView* luma   = views.luma.Get();
+    ID3D11RenderTargetView* chroma = views.chroma.Get();
+
+    ID3D11ShaderResourceView* srv = shape_srv_.Get();
+    ID3D11SamplerState*       smp = sampler_.Get();
+    ctx->IASetInputLayout(nullptr);
+    ctx->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+    ctx->VSSetShader(vs_.Get(), nullptr, 0);
+    ctx->PSSetShaderResources(0, 1, &srv);
+    ctx->PSSetSamplers(0, 1, &smp);
+    ctx->RSSetState(raster_.Get());
+    ctx->OMSetBlendState(blend_.Get(), nullptr, 0xFFFFFFFFu);
+    ctx->OMSetDepthStencilState(nullptr, 0);
+
+    const float w = static_cast<float>(q.right - q.left);
+    const float h = static_cast<float>(q.bottom - q.top);
+    const D3D11_VIEWPORT vp_luma{ static_cast<float>(q.left), static_cast<float>(q.top), w, h, 0.0f, 1.0f };
+    ctx->OMSetRenderTargets(1, &luma, nullptr);
+    ctx->RSSetViewports(1, &vp_luma);
+    ctx->PSSetShader(ps_luma_.Get(), nullptr, 0);
+    ctx->Draw(3, 0);
+
+    const D3D11_VIEWPORT vp_chroma{ q.left * 0.5f, q.top * 0.5f, w * 0.5f, h * 0.5f, 0.0f, 1.0f };
+    ctx->OMSetRenderTargets(1, &chroma, nullptr);
+    ctx->RSSetViewports(1, &vp_chroma);
+    ctx->PSSetShader(ps_chroma_.Get(), nullptr, 0);
+    ctx->Draw(3, 0);
+
+    // The encoder reads this surface next: unbind it
+    ID3D11ShaderResourceView* no_srv = nullptr;
+    ctx->PSSetShaderResources(0, 1, &no_srv);
+    ctx->OMSetRenderTargets(0, nullptr, nullptr);
+}
+
+} // namespace sr
@@ -0,0 +1,117 @@
+#pragma once
+// cursor_overlay.h — Cursor drawn by us into the NV12 output instead of by WGC
+//
+// With GraphicsCaptureSession::IsCursorCaptureEnabled(false), DWM no longer
+// reports a new frame (and a whole-screen change) on every mouse move. The
+// capture engine polls the cursor instead and draws it as a small quad
+// straight into the NV12 slot after the VideoProcessorBlt: luma into an R8
+// view of plane 0, chroma into an R8G8 view of plane 1 at half size, with
+// premultiplied-alpha blending (BT.709 limited range, like the VP output).
+//
+// The cursor image is rendered once per shape change with DrawIconEx over a
+// black and a white background; the difference gives per-pixel alpha, so
+// colour, alpha and monochrome cursors all go through one path. Inverting
+// pixels (I-beam on some themes) come out white.
+//
+// map_cursor_quad / visible_rect are pure so placement is unit-testable.
+
+#include <windows.h>
+#include <d3d11.h>
+#include <wrl/client.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include "capture/nv12_planes.h"
+#include "utils/dirty_region.h"
+
+namespace sr {
+
+// Signed output-pixel rectangle: the cursor may hang off any edge
+struct CursorQuad {
+    int32_t left   = 0;
+    int32_t top    = 0;
+    int32_t right  = 0;
+    int32_t bottom = 0;
+
+    bool empty() const { return right <= left || bottom <= top; }
+    bool operator==(const CursorQuad&) const = default;
+};
+
+// Cursor image of w x h at content position (x, y) — already hotspot-adjusted —
+// mapped into an out_w x out_h output showing `src` of the content
+inline CursorQuad map_cursor_quad(int32_t x, int32_t y, uint32_t w, uint32_t h,
+                                  const FrameRect& src, uint32_t out_w, uint32_t out_h) {
+    if (src.empty() || w == 0 || h == 0 || out_w == 0 || out_h == 0) return {};
+    const double sx = static_cast<double>(out_w) / src.width();
+    const double sy = static_cast<double>(out_h) / src.height();
+    const double l = (static_cast<double>(x) - src.left) * sx;
+    const double t = (static_cast<double>(y) - src.top) * sy;
+    return { static_cast<int32_t>(std::floor(l)),
+             static_cast<int32_t>(std::floor(t)),
+             static_cast<int32_t>(std::ceil(l + w * sx)),
+             static_cast<int32_t>(std::ceil(t + h * sy)) };
+}
+
+// Part of a quad inside the output, as a dirty rectangle
+inline FrameRect visible_rect(const CursorQuad& q, uint32_t out_w, uint32_t out_h) {
+    if (q.empty()) return {};
+    auto clamp_to = [](int32_t v, uint32_t hi) {
+        return static_cast<uint32_t>((std::clamp)(v, 0, static_cast<int32_t>(hi)));
+    };
+    FrameRect r{ clamp_to(q.left, out_w), clamp_to(q.top, out_h),
+                 clamp_to(q.right, out_w), clamp_to(q.bottom, out_h) };
+    return r.empty() ? FrameRect{} : r;
+}
+
+class CursorOverlay {
+public:
+    CursorOverlay() = default;
+    ~CursorOverlay() { release(); }
+
+    CursorOverlay(const CursorOverlay&)            = delete;
+    CursorOverlay& operator=(const CursorOverlay&) = delete;
+
+    // Compile the shaders and create pipeline state on `device`. False when
+    // the device can't render to NV12 (caller keeps WGC's own cursor).
+    bool initialize(ID3D11Device* device);
+    void release();
+    bool ready() const { return ps_luma_ != nullptr; }
+
+    // Read the cursor (GetCursorInfo, screen coordinates) relative to the
+    // capture content's top-left `content_origin`. True when its position,
+    // shape or visibility changed since the previous poll.
+    bool poll(POINT content_origin);
+    bool visible() const { return visible_ && shape_srv_ != nullptr; }
+
+    // Current cursor in output pixels for a target showing `src`
+    CursorQuad quad(const FrameRect& src, uint32_t out_w, uint32_t out_h) const {
+        if (!visible()) return {};
+        return map_cursor_quad(x_, y_, shape_w_, shape_h_, src, out_w, out_h);
+    }
+
+    // Blend the cursor into the NV12 surface behind `views` at `q`. Leaves
+    // no render target or shader resource bound.
+    void draw(ID3D11DeviceContext* ctx, const Nv12PlaneViews& views, const CursorQuad& q) const;
+
+private:
+    bool update_shape(HCURSOR cursor);
+
+    Microsoft::WRL::ComPtr<ID3D11Device>             device_;
+    Microsoft::WRL::ComPtr<ID3D11VertexShader>       vs_;
+    Microsoft::WRL::ComPtr<ID3D11PixelShader>        ps_luma_;
+    Microsoft::WRL::ComPtr<ID3D11PixelShader>        ps_chroma_;
+    Microsoft::WRL::ComPtr<ID3D11BlendState>         blend_;
+    Microsoft::WRL::ComPtr<ID3D11SamplerState>       sampler_;
+    Microsoft::WRL::ComPtr<ID3D11RasterizerState>    raster_;
+    Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> shape_srv_;
+
+    HCURSOR  shape_     = nullptr;
+    uint32_t shape_w_   = 0;
+    uint32_t shape_h_   = 0;
+    POINT    hotspot_{};
+    bool     visible_   = false;
+    int32_t  x_         = 0;   // image top-left in content coordinates
+    int32_t  y_         = 0;
+};
+
+} // namespace sr
@@ -0,0 +1,144 @@
+// frame_tap.cpp — Shared keyed-mutex NV12 slots + file-mapped header (see frame_tap.h)
+
+#include "capture/frame_tap.h"
+#include "utils/logging.h"
+
+#include <dxgi1_2.h>
+#include <new>
+
+namespace sr {
+
+using Microsoft::WRL::ComPtr;
+
+bool FrameTap::open(ID3D11Device* device, uint32_t width, uint32_t height, uint32_t slots) {
+    if (!device || width == 0 || height == 0) return false;
+    if (ready() && width == width_ && height == height_) return true;
+
+    if (!mapping_) {
+        mapping_ = CreateFileMappingW(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE, 0,
+                                      sizeof(FrameTapHeader), kFrameTapMappingName);
+        if (!mapping_) {
+            SR_LOG_WARN(L"Frame tap: CreateFileMapping failed (%lu)", GetLastError());
+            return false;
+        }
+        if (GetLastError() == ERROR_ALREADY_EXISTS) {
+            // A consumer kept the last session's header open; it sees
+            // producer_alive go back to 1 and a new generation
+            SR_LOG_INFO(L"Frame tap: reusing a mapping kept open by a consumer");
+        }
+        void* view = MapViewOfFile(mapping_, FILE_MAP_ALL_ACCESS, 0, 0, sizeof(FrameTapHeader));
+        if (!view) {
+            SR_LOG_WARN(L"Frame tap: MapViewOfFile failed (%lu)", GetLastError());
+            close();
+            return false;
+        }
+        header_ = new (view) FrameTapHeader();
+        header_->producer_pid = GetCurrentProcessId();
+        // Texture names must not collide with a previous session's slots a
+        // consumer may still hold open
+        generation_ = static_cast<uint32_t>(GetTickCount64() & 0x3FFFFFFF) | 1;
+    }
+
+    header_->generation.store(0, std::memory_order_release);
+    release_slots();
+    ++generation_;
+    if (generation_ == 0) generation_ = 1;
+    if (!create_slots(device, width, height, slots)) {
+        close();
+        return false;
+    }
+    width_  = width;
+    height_ = height;
+    header_->slot_count = slot_count_;
+    header_->width.store(width, std::memory_order_release);
+    header_->height.store(height, std::memory_order_release);
+    header_->latest_sequence.store(0, std::memory_order_release);
+    for (auto& s : header_->slots) s.sequence.store(0, std::memory_order_relaxed);
+    header_->producer_alive.store(1, std::memory_order_release);
+    header_->generation.store(generation_, std::memory_order_release);
+    SR_LOG_INFO(L"Frame tap: %ux%u NV12, %u keyed-mutex slots (generation %u)",
+                width, height, slot_count_, generation_);
+    return true;
+}
+
+bool FrameTap::create_slots(ID3D11Device* device, uint32_t width, uint32_t height, uint32_t slots) {
+    const uint32_t count = slots < 2 ? 2 : (slots > kFrameTapMaxSlots ? kFrameTapMaxSlots : slots);
+    D3D11_TEXTURE2D_DESC td{};
+    td.Width            = width;
+    td.Height           = height;
+    td.MipLevels        = 1;
+    td.ArraySize        = 1;
+    td.Format           = DXGI_FORMAT_NV12;
+    td.SampleDesc.Count = 1;
+    td.Usage            = D3D11_USAGE_DEFAULT;
+    td.BindFlags        = D3D11_BIND_SHADER_RESOURCE;   // consumers sample the planes
+    td.MiscFlags        = D3D11_RESOURCE_MISC_SHARED_KEYEDMUTEX | D3D11_RESOURCE_MISC_SHARED_NTHANDLE;
+
+    for (uint32_t i = 0; i < count; ++i) {
+        Slot& s = slots_[i];
+        HRESULT hr = device->CreateTexture2D(&td, nullptr, &s.texture);
+        if (FAILED(hr) && td.BindFlags != 0) {
+            // NV12 SRVs need D3D11.1 video formats; a copy-only slot still works
+            td.BindFlags = 0;
+            hr = device->CreateTexture2D(&td, nullptr, &s.texture);
+        }
+        ComPtr<IDXGIResource1> res;
+        if (SUCCEEDED(hr)) hr = s.texture.As(&s.mutex);
+        if (SUCCEEDED(hr)) hr = s.texture.As(&res);
+        if (SUCCEEDED(hr)) {
+            const std::wstring name = frame_tap_texture_name(generation_, i);
+            hr = res->CreateSharedHandle(nullptr, DXGI_SHARED_RESOURCE_READ | DXGI_SHARED_RESOURCE_WRITE,
+                                         name.c_str(), &s.handle);
+        }
+        if (FAILED(hr)) {
+            SR_LOG_WARN(L"Frame tap: shared NV12 slot %u unavailable: 0x%08X", i, hr);
+            release_slots();
+            return false;
+        }
+        ++slot_count_;
+    }
+    return true;
+}
+
+void FrameTap::release_slots() {
+    for (Slot& s : slots_) {
+        if (s.handle) CloseHandle(s.handle);
+        s = {};
+    }
+    slot_count_ = 0;
+}
+
+void FrameTap::close() {
+    if (header_) {
+        header_->producer_alive.store(0, std::memory_order_release);
+        header_->generation.store(0, std::memory_order_release);
+        UnmapViewOfFile(header_);
+        header_ = nullptr;
+    }
+    if (mapping_) {
+        CloseHandle(mapping_);
+        mapping_ = nullptr;
+    }
+    release_slots();
+    width_ = height_ = 0;
+}
+
+void FrameTap::publish(ID3D11DeviceContext* context, ID3D11Texture2D* nv12, int64_t pts) {
+    if (!ready() || !context || !nv12) return;
+    const uint32_t latest = header_->latest_slot.load(std::memory_order_relaxed);
+    const uint32_t slot = pick_frame_tap_slot(latest, slot_count_, [&](uint32_t i) {
+        // WAIT_TIMEOUT: a consumer holds it. WAIT_ABANDONED (consumer died
+        // holding it) leaves the slot unusable until the next generation.
+        return slots_[i].mutex->AcquireSync(0, 0) == S_OK;
+    });
+    if (slot == kFrameTapMaxSlots) {
+        header_->skipped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    context->CopyResource(slots_[slot].texture.Get(), nv12);
+    // ReleaseSync flushes the copy; the consumer's AcquireSync waits on the GPU for it
+    publish_frame_tap_slot(*header_, slot, ++sequence_, pts);
+    slots_[slot].mutex->ReleaseSync(0);
+}
+
+} // namespace sr
@@ -0,0 +1,63 @@
+#pragma once
+// frame_tap.h — Opt-in zero-copy NV12 feed for external consumers
+//
+// Producer half of frame_tap_layout.h. The capture engine calls publish()
+// with each converted main-output slot; one GPU CopyResource puts it into
+// the next free shared slot texture (keyed mutex taken with a zero timeout)
+// and the file-mapped header gets its sequence number and PTS. Nothing
+// waits on a consumer: when every slot is held the frame is just counted
+// as skipped. open() again with a new size bumps the generation.
+//
+// Used from the capture thread only (under the engine's frame mutex).
+
+#include <windows.h>
+#include <d3d11.h>
+#include <wrl/client.h>
+#include <array>
+#include <cstdint>
+#include "capture/frame_tap_layout.h"
+
+namespace sr {
+
+class FrameTap {
+public:
+    FrameTap() = default;
+    ~FrameTap() { close(); }
+
+    FrameTap(const FrameTap&)            = delete;
+    FrameTap& operator=(const FrameTap&) = delete;
+
+    // Create (or re-create at a new size) the shared slots on `device`.
+    // False when the mapping or the keyed-mutex NV12 textures are refused;
+    // the tap is then closed and capture carries on without it.
+    bool open(ID3D11Device* device, uint32_t width, uint32_t height, uint32_t slots = 3);
+    void close();
+    bool ready() const { return header_ != nullptr && slot_count_ > 0; }
+
+    // Copy `nv12` (width x height from open()) into a free slot
+    void publish(ID3D11DeviceContext* context, ID3D11Texture2D* nv12, int64_t pts);
+
+    uint64_t published() const { return sequence_; }
+    uint64_t skipped()   const { return header_ ? header_->skipped.load(std::memory_order_relaxed) : 0; }
+
+private:
+    struct Slot {
+        Microsoft::WRL::ComPtr<ID3D11Texture2D> texture;
+        Microsoft::WRL::ComPtr<IDXGIKeyedMutex> mutex;
+        HANDLE handle = nullptr;   // named NT handle; keeps the name alive
+    };
+
+    bool create_slots(ID3D11Device* device, uint32_t width, uint32_t height, uint32_t slots);
+    void release_slots();
+
+    HANDLE          mapping_    = nullptr;
+    FrameTapHeader* header_     = nullptr;
+    std::array<Slot, kFrameTapMaxSlots> slots_{};
+    uint32_t        slot_count_ = 0;
+    uint32_t        generation_ = 0;
+    uint32_t        width_      = 0;
+    uint32_t        height_     = 0;
+    uint64_t        sequence_   = 0;
+};
+
+} // namespace sr
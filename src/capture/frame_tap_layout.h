@@ -0,0 +1,108 @@
+#pragma once
+// frame_tap_layout.h — Shared-memory ABI of the capture frame tap (frame_tap.h)
+//
+// External tools (OCR, PII detection) read the recorder's live NV12 frames
+// straight from the GPU. The recorder publishes:
+//
+//   Local\ScreenRecorderFrameTap        file mapping holding FrameTapHeader
+//   Local\ScreenRecorderFrameTap_G_S    shared NV12 texture for generation G,
+//                                       slot S (OpenSharedResourceByName)
+//
+// Every slot texture carries a keyed mutex; both sides use key 0. The
+// producer only ever tries AcquireSync(0, 0): a slot a consumer still holds
+// is skipped for the next one, or the frame is not tapped, so consumers can
+// never stall capture. A consumer:
+//
+//   1. read_frame_tap_format(): generation, width, height (retry while 0)
+//   2. open the generation's slot textures by name
+//   3. poll latest_sequence; when it moves, AcquireSync(0, timeout) on
+//      latest_slot, read slots[latest_slot] (sequence/pts of the pixels it
+//      now holds), copy or process, ReleaseSync(0) — quickly
+//   4. reopen when the generation changes (output resize); stop when
+//      producer_alive drops to 0
+//
+// Plain header so consumers can include it without the recorder's sources.
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+namespace sr {
+
+inline constexpr wchar_t kFrameTapMappingName[] = L"Local\\ScreenRecorderFrameTap";
+inline constexpr uint32_t kFrameTapMagic   = 0x54465253;   // "SRFT"
+inline constexpr uint32_t kFrameTapVersion = 1;
+inline constexpr uint32_t kFrameTapMaxSlots = 4;
+
+struct FrameTapSlot {
+    std::atomic<uint64_t> sequence{ 0 };   // frame written into this slot (0 = none yet)
+    std::atomic<int64_t>  pts{ 0 };        // 100ns, session clock
+};
+
+struct FrameTapHeader {
+    uint32_t magic       = kFrameTapMagic;
+    uint32_t version     = kFrameTapVersion;
+    uint32_t header_size = sizeof(FrameTapHeader);
+    uint32_t slot_count  = 0;
+    uint32_t dxgi_format = 103;            // DXGI_FORMAT_NV12
+    uint32_t producer_pid = 0;
+
+    // Seqlock-style: 0 while the producer re-creates the slots
+    std::atomic<uint32_t> generation{ 0 };
+    std::atomic<uint32_t> width{ 0 };
+    std::atomic<uint32_t> height{ 0 };
+    std::atomic<uint32_t> producer_alive{ 0 };
+
+    std::atomic<uint64_t> latest_sequence{ 0 };   // newest published frame
+    std::atomic<uint32_t> latest_slot{ 0 };       // ...and the slot holding it
+    std::atomic<uint32_t> reserved{ 0 };
+    std::atomic<uint64_t> skipped{ 0 };           // frames not tapped: every slot held by consumers
+
+    FrameTapSlot slots[kFrameTapMaxSlots];
+};
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "frame tap header needs lock-free 64-bit atomics");
+
+inline std::wstring frame_tap_texture_name(uint32_t generation, uint32_t slot) {
+    return std::wstring(kFrameTapMappingName) + L"_" + std::to_wstring(generation) + L"_" + std::to_wstring(slot);
+}
+
+struct FrameTapFormat {
+    uint32_t generation = 0;
+    uint32_t width      = 0;
+    uint32_t height     = 0;
+};
+
+// Consumer side: a consistent (generation, size); false while the producer
+// is between generations or gone
+inline bool read_frame_tap_format(const FrameTapHeader& h, FrameTapFormat& out) {
+    if (h.magic != kFrameTapMagic || h.version != kFrameTapVersion) return false;
+    if (h.producer_alive.load(std::memory_order_acquire) == 0) return false;
+    const uint32_t g = h.generation.load(std::memory_order_acquire);
+    if (g == 0) return false;
+    out.width  = h.width.load(std::memory_order_acquire);
+    out.height = h.height.load(std::memory_order_acquire);
+    out.generation = g;
+    return h.generation.load(std::memory_order_acquire) == g;
+}
+
+// Producer side: the slot to write next, starting after the latest one so a
+// consumer still reading the latest frame keeps it. `try_lock(slot)` is the
+// zero-timeout AcquireSync; kFrameTapMaxSlots when every slot is held.
+template <typename TryLock>
+uint32_t pick_frame_tap_slot(uint32_t latest, uint32_t slot_count, TryLock&& try_lock) {
+    for (uint32_t i = 1; i <= slot_count; ++i) {
+        const uint32_t slot = (latest + i) % slot_count;
+        if (try_lock(slot)) return slot;
+    }
+    return kFrameTapMaxSlots;
+}
+
+// Producer side: record a frame written into `slot` (caller still holds its keyed mutex)
+inline void publish_frame_tap_slot(FrameTapHeader& h, uint32_t slot, uint64_t sequence, int64_t pts) {
+    h.slots[slot].pts.store(pts, std::memory_order_relaxed);
+    h.slots[slot].sequence.store(sequence, std::memory_order_release);
+    h.latest_slot.store(slot, std::memory_order_release);
+    h.latest_sequence.store(sequence, std::memory_order_release);
+}
+
+} // namespace sr
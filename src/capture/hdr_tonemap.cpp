@@ -0,0 +1,294 @@
+// hdr_tonemap.cpp — HDR display query and the scRGB -> NV12 tone-mapping pass
+#include "capture/hdr_tonemap.h"
+#include "utils/logging.h"
+
+#include <d3dcompiler.h>
+#include <dxgi1_6.h>
+#include <algorithm>
+#include <cwchar>
+#include <vector>
+#pragma comment(lib, "d3dcompiler.lib")
+#pragma comment(lib, "dxgi.lib")
+
+using Microsoft::WRL::ComPtr;
+
+namespace sr {
+
+namespace {
+
+// Full-viewport triangle over the whole plane; uv is mapped into src_box.
+// The shoulder in sdr_rgb() must match hdr_shoulder().
+constexpr char kShaderSource[] = R"(
+cbuffer Params : register(b0) {
+    float4 src_box;     // left, top, width, height in texture uv
+    float  exposure;    // scRGB -> SDR-relative linear
+    float  knee;
+    float  peak;        // display peak, SDR-relative
+    float  pad;
+};
+Texture2D<float4> src_tex : register(t0);
+SamplerState      src_smp : register(s0);
+
+struct VsOut { float4 pos : SV_Position; float2 uv : TEXCOORD0; };
+
+VsOut vs_main(uint id : SV_VertexID) {
+    VsOut o;
+    float2 uv = float2((id << 1) & 2, id & 2);
+    o.pos = float4(uv * float2(2, -2) + float2(-1, 1), 0, 1);
+    o.uv  = src_box.xy + uv * src_box.zw;
+    return o;
+}
+
+float3 sdr_rgb(float2 uv) {
+    float3 c = max(src_tex.SampleLevel(src_smp, uv, 0).rgb * exposure, 0);
+    float  m = max(max(c.r, c.g), c.b);
+    if (m > knee) {
+        float y = min(m, 1);
+        if (peak > 1) {
+            float t  = (m - knee) / (1 - knee);
+            float tp = (peak - knee) / (1 - knee);
+            y = min(knee + (1 - knee) * t * (1 + t / (tp * tp)) / (1 + t), 1);
+        }
+        c *= y / m;
+    }
+    c = min(c, 1);
+    return c <= 0.0031308 ? c * 12.92 : 1.055 * pow(c, 1 / 2.4) - 0.055;
+}
+
+float4 ps_luma(VsOut i) : SV_Target {
+    float3 c = sdr_rgb(i.uv);
+    return float4(dot(c, float3(0.1826, 0.6142, 0.0620)) + 0.0627, 0, 0, 1);
+}
+
+float4 ps_chroma(VsOut i) : SV_Target {
+    float3 c = sdr_rgb(i.uv);
+    return float4(dot(c, float3(-0.1007, -0.3386,  0.4392)) + 0.5020,
+                  dot(c, float3( 0.4392, -0.3990, -0.0403)) + 0.5020, 0, 1);
+}
+)";
+
+struct Params {
+    float src_box[4];
+    float exposure;
+    float knee;
+    float peak;
+    float pad;
+};
+
+bool compile(const char* entry, const char* target, ComPtr<ID3DBlob>& code) {
+    ComPtr<ID3DBlob> errors;
+    const HRESULT hr = D3DCompile(kShaderSource, sizeof(kShaderSource) - 1, "hdr_tonemap",
+                                  nullptr, nullptr, entry, target,
+                                  D3DCOMPILE_OPTIMIZATION_LEVEL3, 0, &code, &errors);
+    if (FAILED(hr)) {
+        SR_LOG_ERROR(L"Tone-map shader %S failed: 0x%08X %S", entry, hr,
+                     errors ? static_cast<const char*>(errors->GetBufferPointer()) : "");
+        return false;
+    }
+    return true;
+}
+
+// "SDR content brightness" of the display showing `device_name` (\\.\DISPLAYn)
+bool sdr_white_level(const wchar_t* device_name, float& nits) {
+    UINT32 path_count = 0, mode_count = 0;
+    if (GetDisplayConfigBufferSizes(QDC_ONLY_ACTIVE_PATHS, &path_count, &mode_count) != ERROR_SUCCESS) {
+        return false;
+    }
+    std::vector<DISPLAYCONFIG_PATH_INFO> paths(path_count);
+    std::vector<DISPLAYCONFIG_MODE_INFO> modes(mode_count);
+    if (QueryDisplayConfig(QDC_ONLY_ACTIVE_PATHS, &path_count, paths.data(),
+                           &mode_count, modes.data(), nullptr) != ERROR_SUCCESS) {
+        return false;
+    }
+    for (UINT32 i = 0; i < path_count; ++i) {
+        DISPLAYCONFIG_SOURCE_DEVICE_NAME source{};
+        source.header.type      = DISPLAYCONFIG_DEVICE_INFO_GET_SOURCE_NAME;
+        source.header.size      = sizeof(source);
+        source.header.adapterId = paths[i].sourceInfo.adapterId;
+        source.header.id        = paths[i].sourceInfo.id;
+        if (DisplayConfigGetDeviceInfo(&source.header) != ERROR_SUCCESS ||
+            wcscmp(source.viewGdiDeviceName, device_name) != 0) {
+            continue;
+        }
+        DISPLAYCONFIG_SDR_WHITE_LEVEL white{};
+        white.header.type      = DISPLAYCONFIG_DEVICE_INFO_GET_SDR_WHITE_LEVEL;
+        white.header.size      = sizeof(white);
+        white.header.adapterId = paths[i].targetInfo.adapterId;
+        white.header.id        = paths[i].targetInfo.id;
+        if (DisplayConfigGetDeviceInfo(&white.header) != ERROR_SUCCESS) return false;
+        nits = static_cast<float>(white.SDRWhiteLevel) / 1000.0f * 80.0f;  // 1000 = 80 nits
+        return true;
+    }
+    return false;
+}
+
+} // namespace
+
+HdrDisplayInfo query_hdr_display(HMONITOR monitor) {
+    HdrDisplayInfo info;
+    ComPtr<IDXGIFactory1> factory;
+    if (!monitor || FAILED(CreateDXGIFactory1(IID_PPV_ARGS(&factory)))) return info;
+
+    bool found = false;
+    for (UINT a = 0; !found; ++a) {
+        ComPtr<IDXGIAdapter1> adapter;
+        if (factory->EnumAdapters1(a, &adapter) == DXGI_ERROR_NOT_FOUND) break;
+        for (UINT o = 0; !found; ++o) {
+            ComPtr<IDXGIOutput> output;
+            if (adapter->EnumOutputs(o, &output) == DXGI_ERROR_NOT_FOUND) break;
+            DXGI_OUTPUT_DESC desc{};
+            if (FAILED(output->GetDesc(&desc)) || desc.Monitor != monitor) continue;
+            found = true;
+            ComPtr<IDXGIOutput6> output6;
+            DXGI_OUTPUT_DESC1 desc1{};
+            if (SUCCEEDED(output.As(&output6)) && SUCCEEDED(output6->GetDesc1(&desc1))) {
+                info.hdr       = desc1.ColorSpace == DXGI_COLOR_SPACE_RGB_FULL_G2084_NONE_P2020;
+                info.peak_nits = desc1.MaxLuminance > 0.0f ? desc1.MaxLuminance : 1000.0f;
+            }
+        }
+    }
+    if (!info.hdr) return info;
+
+    MONITORINFOEXW mi{};
+    mi.cbSize = sizeof(mi);
+    float nits = 0.0f;
+    if (GetMonitorInfoW(monitor, &mi) && sdr_white_level(mi.szDevice, nits) && nits > 0.0f) {
+        info.sdr_white_nits = nits;
+    } else {
+        info.sdr_white_nits = 200.0f;  // typical default slider position
+    }
+    return info;
+}
+
+bool HdrToneMapper::initialize(ID3D11Device* device, const HdrDisplayInfo& display) {
+    release();
+    UINT fp16 = 0;
+    if (!nv12_render_target_supported(device) ||
+        FAILED(device->CheckFormatSupport(DXGI_FORMAT_R16G16B16A16_FLOAT, &fp16)) ||
+        !(fp16 & D3D11_FORMAT_SUPPORT_SHADER_SAMPLE)) {
+        SR_LOG_WARN(L"HDR tone mapping: device lacks FP16 sampling or NV12 render targets");
+        return false;
+    }
+
+    ComPtr<ID3DBlob> vs, ps_y, ps_uv;
+    if (!compile("vs_main", "vs_5_0", vs) || !compile("ps_luma", "ps_5_0", ps_y) ||
+        !compile("ps_chroma", "ps_5_0", ps_uv)) {
+        return false;
+    }
+    HRESULT hr = device->CreateVertexShader(vs->GetBufferPointer(), vs->GetBufferSize(), nullptr, &vs_);
+    if (SUCCEEDED(hr)) hr = device->CreatePixelShader(ps_y->GetBufferPointer(), ps_y->GetBufferSize(),
+                                                      nullptr, &ps_luma_);
+    if (SUCCEEDED(hr)) hr = device->CreatePixelShader(ps_uv->GetBufferPointer(), ps_uv->GetBufferSize(),
+                                                      nullptr, &ps_chroma_);
+
+    D3D11_SAMPLER_DESC sd{};
+    sd.Filter   = D3D11_FILTER_MIN_MAG_MIP_LINEAR;
+    sd.AddressU = sd.AddressV = sd.AddressW = D3D11_TEXTURE_ADDRESS_CLAMP;
+    sd.MaxLOD   = D3D11_FLOAT32_MAX;
+    if (SUCCEEDED(hr)) hr = device->CreateSamplerState(&sd, &sampler_);
+
+    D3D11_RASTERIZER_DESC rd{};
+    rd.FillMode        = D3D11_FILL_SOLID;
+    rd.CullMode        = D3D11_CULL_NONE;
+    rd.DepthClipEnable = TRUE;
+    if (SUCCEEDED(hr)) hr = device->CreateRasterizerState(&rd, &raster_);
+
+    D3D11_BUFFER_DESC bd{};
+    bd.ByteWidth = sizeof(Params);
+    bd.Usage     = D3D11_USAGE_DEFAULT;
+    bd.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
+    if (SUCCEEDED(hr)) hr = device->CreateBuffer(&bd, nullptr, &params_);
+
+    if (FAILED(hr)) {
+        SR_LOG_ERROR(L"HDR tone-map pipeline state failed: 0x%08X", hr);
+        release();
+        return false;
+    }
+    device_   = device;
+    exposure_ = 80.0f / display.sdr_white_nits;
+    peak_     = (std::max)(display.peak_nits / display.sdr_white_nits, 1.0f);
+    SR_LOG_INFO(L"HDR tone mapping: SDR white %.0f nits, peak %.0f nits (%.2fx white)",
+                display.sdr_white_nits, display.peak_nits, peak_);
+    return true;
+}
+
+void HdrToneMapper::release() {
+    for (auto& v : srv_)     v.Reset();
+    for (auto& t : srv_tex_) t.Reset();
+    next_srv_ = 0;
+    params_.Reset();
+    raster_.Reset();
+    sampler_.Reset();
+    ps_chroma_.Reset();
+    ps_luma_.Reset();
+    vs_.Reset();
+    device_.Reset();
+}
+
+ID3D11ShaderResourceView* HdrToneMapper::view_for(ID3D11Texture2D* src) {
+    for (size_t i = 0; i < srv_tex_.size(); ++i) {
+        if (srv_tex_[i].Get() == src && srv_[i]) return srv_[i].Get();
+    }
+    ComPtr<ID3D11ShaderResourceView> view;
+    const HRESULT hr = device_->CreateShaderResourceView(src, nullptr, &view);
+    if (FAILED(hr)) {
+        SR_LOG_ERROR(L"HDR source view failed: 0x%08X", hr);
+        return nullptr;
+    }
+    const size_t slot = next_srv_++ % srv_tex_.size();
+    srv_tex_[slot] = src;
+    srv_[slot]     = view;
+    return view.Get();
+}
+
+bool HdrToneMapper::draw(ID3D11DeviceContext* ctx, ID3D11Texture2D* src, const FrameRect& src_rect,
+                         const Nv12PlaneViews& views, uint32_t out_w, uint32_t out_h) {
+    if (!ready() || !views || !src) return false;
+    ID3D11ShaderResourceView* srv = view_for(src);
+    if (!srv) return false;
+
+    D3D11_TEXTURE2D_DESC desc{};
+    src->GetDesc(&desc);
+    const FrameRect surface{ 0, 0, desc.Width, desc.Height };
+    FrameRect box = src_rect.intersected(surface);
+    if (box.empty()) box = surface;
+    const Params params{
+        { static_cast<float>(box.left) / desc.Width, static_cast<float>(box.top) / desc.Height,
+          static_cast<float>(box.width()) / desc.Width, static_cast<float>(box.height()) / desc.Height },
+        exposure_, kKnee, peak_, 0.0f };
+    ctx->UpdateSubresource(params_.Get(), 0, nullptr, &params, 0, 0);
+
+    ID3D11Buffer*       cb  = params_.Get();
+    ID3D11SamplerState* smp = sampler_.Get();
+    ctx->IASetInputLayout(nullptr);
+    ctx->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+    ctx->VSSetShader(vs_.Get(), nullptr, 0);
+    ctx->VSSetConstantBuffers(0, 1, &cb);
+    ctx->PSSetConstantBuffers(0, 1, &cb);
+    ctx->PSSetShaderResources(0, 1, &srv);
+    ctx->PSSetSamplers(0, 1, &smp);
+    ctx->RSSetState(raster_.Get());
+    ctx->OMSetBlendState(nullptr, nullptr, 0xFFFFFFFFu);
+    ctx->OMSetDepthStencilState(nullptr, 0);
+
+    ID3D11RenderTargetView* luma   = views.luma.Get();
+    ID3D11RenderTargetView* chroma = views.chroma.Get();
+    const D3D11_VIEWPORT vp_luma{ 0.0f, 0.0f, static_cast<float>(out_w), static_cast<float>(out_h), 0.0f, 1.0f };
+    ctx->OMSetRenderTargets(1, &luma, nullptr);
+    ctx->RSSetViewports(1, &vp_luma);
+    ctx->PSSetShader(ps_luma_.Get(), nullptr, 0);
+    ctx->Draw(3, 0);
+
+    const D3D11_VIEWPORT vp_chroma{ 0.0f, 0.0f, out_w * 0.5f, out_h * 0.5f, 0.0f, 1.0f };
+    ctx->OMSetRenderTargets(1, &chroma, nullptr);
+    ctx->RSSetViewports(1, &vp_chroma);
+    ctx->PSSetShader(ps_chroma_.Get(), nullptr, 0);
+    ctx->Draw(3, 0);
+
+    ID3D11ShaderResourceView* no_srv = nullptr;
+    ctx->PSSetShaderResources(0, 1, &no_srv);
+    ctx->OMSetRenderTargets(0, nullptr, nullptr);
+    return true;
+}
+
+} // namespace sr
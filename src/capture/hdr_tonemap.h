@@ -0,0 +1,89 @@
+#pragma once
+// hdr_tonemap.h — scRGB (FP16) capture tone-mapped to SDR BT.709 NV12 on the GPU
+//
+// On an HDR desktop WGC's B8G8R8A8 frames are a clipped, washed-out SDR
+// rendition. The capture engine instead asks for R16G16B16A16Float (scRGB:
+// linear, BT.709 primaries, 1.0 = 80 nits) and this pass replaces the
+// VideoProcessorBlt for that target, with one draw per NV12 plane:
+//
+//   crop + scale (bilinear) -> exposure 80 / sdr_white -> highlight shoulder
+//   -> sRGB transfer -> BT.709 limited-range Y / CbCr
+//
+// SDR content (<= the Windows "SDR content brightness" white) stays untouched
+// below the knee; highlights up to the display peak roll off into [knee, 1].
+//
+// query_hdr_display reads the monitor's DXGI colour space / peak luminance
+// and the SDR white level from DisplayConfig.
+
+#include <windows.h>
+#include <d3d11.h>
+#include <wrl/client.h>
+#include <array>
+#include <cstdint>
+#include "capture/nv12_planes.h"
+#include "utils/dirty_region.h"
+
+namespace sr {
+
+struct HdrDisplayInfo {
+    bool  hdr            = false;  // advanced colour on (G2084 / P2020 output)
+    float sdr_white_nits = 80.0f;  // "SDR content brightness"
+    float peak_nits      = 80.0f;  // display MaxLuminance (0 reported -> 1000)
+};
+
+HdrDisplayInfo query_hdr_display(HMONITOR monitor);
+
+// Shoulder applied to the largest channel (SDR-relative, 1.0 = SDR white):
+// identity up to `knee`, then an extended-Reinhard roll-off reaching 1.0 at
+// `peak`. Mirrored by the pixel shader; kept here for tests.
+inline float hdr_shoulder(float x, float knee, float peak) {
+    if (x <= knee) return x;
+    if (peak <= 1.0f) return x < 1.0f ? x : 1.0f;
+    const float t  = (x - knee) / (1.0f - knee);
+    const float tp = (peak - knee) / (1.0f - knee);
+    const float y  = knee + (1.0f - knee) * t * (1.0f + t / (tp * tp)) / (1.0f + t);
+    return y < 1.0f ? y : 1.0f;
+}
+
+class HdrToneMapper {
+public:
+    static constexpr float kKnee = 0.75f;
+
+    HdrToneMapper() = default;
+    ~HdrToneMapper() { release(); }
+
+    HdrToneMapper(const HdrToneMapper&)            = delete;
+    HdrToneMapper& operator=(const HdrToneMapper&) = delete;
+
+    // Shaders + state on `device`; false when the device can't sample FP16
+    // or render NV12 (caller stays on the BGRA8 path)
+    bool initialize(ID3D11Device* device, const HdrDisplayInfo& display);
+    void release();
+    bool ready() const { return ps_luma_ != nullptr; }
+
+    // Tone-map `src` (R16G16B16A16_FLOAT) restricted to src_rect into the
+    // out_w x out_h NV12 surface behind `views`. Leaves nothing bound.
+    bool draw(ID3D11DeviceContext* ctx, ID3D11Texture2D* src, const FrameRect& src_rect,
+              const Nv12PlaneViews& views, uint32_t out_w, uint32_t out_h);
+
+private:
+    ID3D11ShaderResourceView* view_for(ID3D11Texture2D* src);
+
+    Microsoft::WRL::ComPtr<ID3D11Device>          device_;
+    Microsoft::WRL::ComPtr<ID3D11VertexShader>    vs_;
+    Microsoft::WRL::ComPtr<ID3D11PixelShader>     ps_luma_;
+    Microsoft::WRL::ComPtr<ID3D11PixelShader>     ps_chroma_;
+    Microsoft::WRL::ComPtr<ID3D11SamplerState>    sampler_;
+    Microsoft::WRL::ComPtr<ID3D11RasterizerState> raster_;
+    Microsoft::WRL::ComPtr<ID3D11Buffer>          params_;
+
+    // SRVs for the rotating frame-pool surfaces
+    std::array<Microsoft::WRL::ComPtr<ID3D11Texture2D>, 4>          srv_tex_{};
+    std::array<Microsoft::WRL::ComPtr<ID3D11ShaderResourceView>, 4> srv_{};
+    uint32_t next_srv_ = 0;
+
+    float exposure_ = 1.0f;   // scRGB -> SDR-relative
+    float peak_     = 1.0f;   // display peak, SDR-relative
+};
+
+} // namespace sr
@@ -0,0 +1,204 @@
+// nv12_compute.cpp — Compute-shader BGRA -> NV12 conversion
+#include "capture/nv12_compute.h"
+#include "utils/logging.h"
+
+#include <d3dcompiler.h>
+#include <algorithm>
+#pragma comment(lib, "d3dcompiler.lib")
+
+using Microsoft::WRL::ComPtr;
+
+namespace sr {
+
+namespace {
+
+constexpr uint32_t kGroupSize = 8;   // numthreads(8, 8, 1)
+
+// Same BT.709 limited-range matrix as the tone mapper and the VP output
+constexpr char kShaderSource[] = R"(
+cbuffer Params : register(b0) {
+    float4 src_box;       // left, top, width, height in texture uv
+    uint2  out_size;      // luma plane size
+    uint2  chroma_size;   // CbCr plane size
+    uint2  luma_taps;     // bilinear taps per axis per luma sample
+    uint2  chroma_taps;
+};
+Texture2D<float4>         src_tex    : register(t0);
+SamplerState              src_smp    : register(s0);
+RWTexture2D<unorm float>  luma_out   : register(u0);
+RWTexture2D<unorm float2> chroma_out : register(u1);
+
+// Mean of taps.x * taps.y bilinear samples over the footprint of output
+// sample `pos` on a plane of `size` samples
+float3 footprint(uint2 pos, uint2 size, uint2 taps) {
+    float2 cell   = src_box.zw / float2(size);
+    float2 origin = src_box.xy + float2(pos) * cell;
+    float2 step   = cell / float2(taps);
+    float3 sum = 0;
+    for (uint y = 0; y < taps.y; ++y) {
+        for (uint x = 0; x < taps.x; ++x) {
+            sum += src_tex.SampleLevel(src_smp, origin + (float2(x, y) + 0.5) * step, 0).rgb;
+        }
+    }
+    return sum / float(taps.x * taps.y);
+}
+
+[numthreads(8, 8, 1)]
+void cs_luma(uint3 id : SV_DispatchThreadID) {
+    if (any(id.xy >= out_size)) return;
+    float3 c = footprint(id.xy, out_size, luma_taps);
+    luma_out[id.xy] = dot(c, float3(0.1826, 0.6142, 0.0620)) + 0.0627;
+}
+
+[numthreads(8, 8, 1)]
+void cs_chroma(uint3 id : SV_DispatchThreadID) {
+    if (any(id.xy >= chroma_size)) return;
+    float3 c = footprint(id.xy, chroma_size, chroma_taps);
+    chroma_out[id.xy] = float2(dot(c, float3(-0.1007, -0.3386,  0.4392)) + 0.5020,
+                               dot(c, float3( 0.4392, -0.3990, -0.0403)) + 0.5020);
+}
+)";
+
+struct Params {
+    float    src_box[4];
+    uint32_t out_size[2];
+    uint32_t chroma_size[2];
+    uint32_t luma_taps[2];
+    uint32_t chroma_taps[2];
+};
+static_assert(sizeof(Params) % 16 == 0, "constant buffer size");
+
+bool compile(const char* entry, ComPtr<ID3DBlob>& code) {
+    ComPtr<ID3DBlob> errors;
+    const HRESULT hr = D3DCompile(kShaderSource, sizeof(kShaderSource) - 1, "nv12_compute",
+                                  nullptr, nullptr, entry, "cs_5_0",
+                                  D3DCOMPILE_OPTIMIZATION_LEVEL3, 0, &code, &errors);
+    if (FAILED(hr)) {
+        SR_LOG_ERROR(L"NV12 compute shader %S failed: 0x%08X %S", entry, hr,
+                     errors ? static_cast<const char*>(errors->GetBufferPointer()) : "");
+        return false;
+    }
+    return true;
+}
+
+uint32_t groups(uint32_t n) { return (n + kGroupSize - 1) / kGroupSize; }
+
+} // namespace
+
+bool Nv12ComputeConverter::initialize(ID3D11Device* device, Nv12ScaleFilter filter) {
+    release();
+    if (!nv12_uav_supported(device)) {
+        SR_LOG_INFO(L"NV12 compute converter: device can't write NV12 through UAVs");
+        return false;
+    }
+
+    ComPtr<ID3DBlob> cs_y, cs_uv;
+    if (!compile("cs_luma", cs_y) || !compile("cs_chroma", cs_uv)) return false;
+    HRESULT hr = device->CreateComputeShader(cs_y->GetBufferPointer(), cs_y->GetBufferSize(),
+                                             nullptr, &cs_luma_);
+    if (SUCCEEDED(hr)) hr = device->CreateComputeShader(cs_uv->GetBufferPointer(), cs_uv->GetBufferSize(),
+                                                        nullptr, &cs_chroma_);
+
+    D3D11_SAMPLER_DESC sd{};
+    sd.Filter   = D3D11_FILTER_MIN_MAG_MIP_LINEAR;
+    sd.AddressU = sd.AddressV = sd.AddressW = D3D11_TEXTURE_ADDRESS_CLAMP;
+    sd.MaxLOD   = D3D11_FLOAT32_MAX;
+    if (SUCCEEDED(hr)) hr = device->CreateSamplerState(&sd, &sampler_);
+
+    D3D11_BUFFER_DESC bd{};
+    bd.ByteWidth = sizeof(Params);
+    bd.Usage     = D3D11_USAGE_DEFAULT;
+    bd.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
+    if (SUCCEEDED(hr)) hr = device->CreateBuffer(&bd, nullptr, &params_);
+
+    if (FAILED(hr)) {
+        SR_LOG_ERROR(L"NV12 compute pipeline state failed: 0x%08X", hr);
+        release();
+        return false;
+    }
+    device_ = device;
+    filter_ = filter;
+    return true;
+}
+
+void Nv12ComputeConverter::release() {
+    for (auto& v : srv_)     v.Reset();
+    for (auto& t : srv_tex_) t.Reset();
+    next_srv_ = 0;
+    params_.Reset();
+    sampler_.Reset();
+    cs_chroma_.Reset();
+    cs_luma_.Reset();
+    device_.Reset();
+}
+
+ID3D11ShaderResourceView* Nv12ComputeConverter::view_for(ID3D11Texture2D* src) {
+    for (size_t i = 0; i < srv_tex_.size(); ++i) {
+        if (srv_tex_[i].Get() == src && srv_[i]) return srv_[i].Get();
+    }
+    ComPtr<ID3D11ShaderResourceView> view;
+    const HRESULT hr = device_->CreateShaderResourceView(src, nullptr, &view);
+    if (FAILED(hr)) {
+        SR_LOG_ERROR(L"NV12 compute source view failed: 0x%08X", hr);
+        return nullptr;
+    }
+    const size_t slot = next_srv_++ % srv_tex_.size();
+    srv_tex_[slot] = src;
+    srv_[slot]     = view;
+    return view.Get();
+}
+
+bool Nv12ComputeConverter::dispatch(ID3D11DeviceContext* ctx, ID3D11Texture2D* src,
+                                    const FrameRect& src_rect, const Nv12PlaneUavs& uavs,
+                                    uint32_t out_w, uint32_t out_h) {
+    if (!ready() || !uavs || !src || out_w == 0 || out_h == 0) return false;
+    ID3D11ShaderResourceView* srv = view_for(src);
+    if (!srv) return false;
+
+    D3D11_TEXTURE2D_DESC desc{};
+    src->GetDesc(&desc);
+    const FrameRect surface{ 0, 0, desc.Width, desc.Height };
+    FrameRect box = src_rect.intersected(surface);
+    if (box.empty()) box = surface;
+
+    const uint32_t chroma_w = (out_w + 1) / 2, chroma_h = (out_h + 1) / 2;
+    const bool     use_box  = filter_ == Nv12ScaleFilter::Box;
+    const uint32_t luma_tx  = use_box ? nv12_box_taps(box.width(), out_w) : 1;
+    const uint32_t luma_ty  = use_box ? nv12_box_taps(box.height(), out_h) : 1;
+    const uint32_t chroma_tx = use_box ? (std::max)(nv12_box_taps(box.width(), chroma_w), 2u) : 2;
+    const uint32_t chroma_ty = use_box ? (std::max)(nv12_box_taps(box.height(), chroma_h), 2u) : 2;
+    const Params params{
+        { static_cast<float>(box.left) / desc.Width, static_cast<float>(box.top) / desc.Height,
+          static_cast<float>(box.width()) / desc.Width, static_cast<float>(box.height()) / desc.Height },
+        { out_w, out_h }, { chroma_w, chroma_h },
+        { luma_tx, luma_ty }, { chroma_tx, chroma_ty } };
+    ctx->UpdateSubresource(params_.Get(), 0, nullptr, &params, 0, 0);
+
+    ID3D11Buffer*       cb  = params_.Get();
+    ID3D11SamplerState* smp = sampler_.Get();
+    ctx->CSSetConstantBuffers(0, 1, &cb);
+    ctx->CSSetShaderResources(0, 1, &srv);
+    ctx->CSSetSamplers(0, 1, &smp);
+
+    // One UAV slot per plane: the two views alias the same resource, so
+    // they are never bound together
+    ID3D11UnorderedAccessView* luma = uavs.luma.Get();
+    ctx->CSSetUnorderedAccessViews(0, 1, &luma, nullptr);
+    ctx->CSSetShader(cs_luma_.Get(), nullptr, 0);
+    ctx->Dispatch(groups(out_w), groups(out_h), 1);
+
+    ID3D11UnorderedAccessView* no_uav = nullptr;
+    ID3D11UnorderedAccessView* chroma = uavs.chroma.Get();
+    ctx->CSSetUnorderedAccessViews(0, 1, &no_uav, nullptr);
+    ctx->CSSetUnorderedAccessViews(1, 1, &chroma, nullptr);
+    ctx->CSSetShader(cs_chroma_.Get(), nullptr, 0);
+    ctx->Dispatch(groups(chroma_w), groups(chroma_h), 1);
+
+    ID3D11ShaderResourceView* no_srv = nullptr;
+    ctx->CSSetUnorderedAccessViews(1, 1, &no_uav, nullptr);
+    ctx->CSSetShaderResources(0, 1, &no_srv);
+    ctx->CSSetShader(nullptr, nullptr, 0);
+    return true;
+}
+
+} // namespace sr
@@ -0,0 +1,61 @@
+#pragma once
+// nv12_compute.h — BGRA -> BT.709 limited-range NV12 with two compute dispatches
+//
+// The alternative to the VideoProcessorBlt (see nv12_converter.h for when
+// it is used): cs_luma writes the full-size Y plane, cs_chroma the half-size
+// interleaved CbCr plane, both straight into the NV12 ring slot through
+// R8 / R8G8 UAVs (nv12_planes.h). Crop and scale come from the constant
+// buffer, so a source resize needs no new state.
+//
+// Every output sample averages taps x taps bilinear samples spread over its
+// source footprint: one tap is plain bilinear, Box uses nv12_box_taps. A
+// chroma sample covers 2x2 luma samples and always takes at least 2x2 taps.
+
+#include <d3d11.h>
+#include <wrl/client.h>
+#include <array>
+#include <cstdint>
+#include "capture/nv12_converter.h"
+#include "capture/nv12_planes.h"
+#include "utils/dirty_region.h"
+
+namespace sr {
+
+class Nv12ComputeConverter {
+public:
+    Nv12ComputeConverter() = default;
+    ~Nv12ComputeConverter() { release(); }
+
+    Nv12ComputeConverter(const Nv12ComputeConverter&)            = delete;
+    Nv12ComputeConverter& operator=(const Nv12ComputeConverter&) = delete;
+
+    // Shaders + state on `device`; false when NV12 can't be a typed UAV
+    // (caller stays on the video processor)
+    bool initialize(ID3D11Device* device, Nv12ScaleFilter filter);
+    void release();
+    bool ready() const { return cs_luma_ != nullptr; }
+    Nv12ScaleFilter filter() const { return filter_; }
+
+    // Convert `src` (B8G8R8A8) restricted to src_rect into the out_w x out_h
+    // NV12 surface behind `uavs`. Leaves nothing bound.
+    bool dispatch(ID3D11DeviceContext* ctx, ID3D11Texture2D* src, const FrameRect& src_rect,
+                  const Nv12PlaneUavs& uavs, uint32_t out_w, uint32_t out_h);
+
+private:
+    ID3D11ShaderResourceView* view_for(ID3D11Texture2D* src);
+
+    Microsoft::WRL::ComPtr<ID3D11Device>        device_;
+    Microsoft::WRL::ComPtr<ID3D11ComputeShader> cs_luma_;
+    Microsoft::WRL::ComPtr<ID3D11ComputeShader> cs_chroma_;
+    Microsoft::WRL::ComPtr<ID3D11SamplerState>  sampler_;
+    Microsoft::WRL::ComPtr<ID3D11Buffer>        params_;
+
+    // SRVs for the rotating frame-pool surfaces (plus the setup benchmark's)
+    std::array<Microsoft::WRL::ComPtr<ID3D11Texture2D>, 4>          srv_tex_{};
+    std::array<Microsoft::WRL::ComPtr<ID3D11ShaderResourceView>, 4> srv_{};
+    uint32_t next_srv_ = 0;
+
+    Nv12ScaleFilter filter_ = Nv12ScaleFilter::Bilinear;
+};
+
+} // namespace sr
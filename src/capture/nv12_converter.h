@@ -0,0 +1,71 @@
+#pragma once
+// nv12_converter.h — Which BGRA->NV12 path a capture target uses
+//
+// Two converters produce the same BT.709 limited-range NV12 ring:
+//   VideoProcessor  ID3D11VideoProcessor blit (fixed-function on most GPUs,
+//                   but driver-dependent: >6 ms for 1440p -> 1080p on some
+//                   Intel UHD parts) and recreated on every source resize
+//   Compute         Nv12ComputeConverter: two compute dispatches writing the
+//                   Y and CbCr planes through UAVs; a source resize only
+//                   changes its constants
+// Auto times both on the capture adapter when the ring is set up and keeps
+// the compute path only when it is clearly faster; the VP stays the default
+// because its scaler is the driver's own.
+
+#include <cstdint>
+
+namespace sr {
+
+enum class Nv12ConverterMode : uint8_t {
+    Auto,            // measure both, pick the faster
+    VideoProcessor,
+    Compute,         // falls back to the VP when the device lacks NV12 UAVs
+};
+
+// Compute-path minification filter
+enum class Nv12ScaleFilter : uint8_t {
+    Bilinear,        // one bilinear tap per output sample (VP-like, cheapest)
+    Box,             // averages the whole source footprint (no aliasing on text)
+};
+
+inline const wchar_t* nv12_converter_label(Nv12ConverterMode mode) {
+    switch (mode) {
+        case Nv12ConverterMode::Auto:           return L"auto";
+        case Nv12ConverterMode::VideoProcessor: return L"vp";
+        case Nv12ConverterMode::Compute:        return L"compute";
+    }
+    return L"?";
+}
+
+inline const wchar_t* nv12_scale_filter_label(Nv12ScaleFilter filter) {
+    return filter == Nv12ScaleFilter::Box ? L"box" : L"bilinear";
+}
+
+// Bilinear taps per axis the box filter spreads over one output sample:
+// ceil(src / dst), so each tap covers at most 2x2 source texels. Capped, so
+// a tiny proxy from a 4K source stays a bounded dispatch.
+constexpr uint32_t kNv12MaxBoxTaps = 4;
+
+inline uint32_t nv12_box_taps(uint32_t src, uint32_t dst) {
+    if (dst == 0 || src <= dst) return 1;
+    const uint32_t taps = (src + dst - 1) / dst;
+    return taps < kNv12MaxBoxTaps ? taps : kNv12MaxBoxTaps;
+}
+
+// Auto keeps the compute path only when it beats the VP by this factor:
+// close timings aren't worth leaving the driver's scaler for
+constexpr double kNv12ComputeMinGain = 0.9;
+
+// Timings are GPU milliseconds per conversion, < 0 when the measurement
+// failed. `compute_ready` = the compute converter initialised and the ring
+// textures have UAV binding.
+inline bool use_compute_converter(Nv12ConverterMode mode, bool compute_ready,
+                                  double vp_ms, double compute_ms) {
+    if (!compute_ready || mode == Nv12ConverterMode::VideoProcessor) return false;
+    if (mode == Nv12ConverterMode::Compute) return true;
+    if (compute_ms < 0.0) return false;
+    if (vp_ms < 0.0) return true;
+    return compute_ms < vp_ms * kNv12ComputeMinGain;
+}
+
+} // namespace sr
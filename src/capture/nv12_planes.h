@@ -0,0 +1,81 @@
+#pragma once
+// nv12_planes.h — Render-target views of an NV12 texture's two planes
+//
+// D3D11.1 lets a shader write NV12 directly: an R8_UNORM view addresses the
+// luma plane (full size), an R8G8_UNORM view the interleaved CbCr plane
+// (half size). The cursor overlay and the HDR tone mapper draw through these
+// instead of going via a BGRA intermediate; the compute converter writes the
+// same two planes through unordered-access views.
+//
+// Shaders use BT.709 limited range, the colour space the capture video
+// processors are configured to output.
+
+#include <d3d11.h>
+#include <wrl/client.h>
+#include "utils/logging.h"
+
+namespace sr {
+
+struct Nv12PlaneViews {
+    Microsoft::WRL::ComPtr<ID3D11RenderTargetView> luma;
+    Microsoft::WRL::ComPtr<ID3D11RenderTargetView> chroma;
+
+    explicit operator bool() const { return luma && chroma; }
+    void reset() { luma.Reset(); chroma.Reset(); }
+};
+
+// True if `device` can render to NV12 (needed for the plane views)
+inline bool nv12_render_target_supported(ID3D11Device* device) {
+    UINT support = 0;
+    return SUCCEEDED(device->CheckFormatSupport(DXGI_FORMAT_NV12, &support)) &&
+           (support & D3D11_FORMAT_SUPPORT_RENDER_TARGET) != 0;
+}
+
+// `nv12` needs D3D11_BIND_RENDER_TARGET
+inline bool create_nv12_plane_views(ID3D11Device* device, ID3D11Texture2D* nv12, Nv12PlaneViews& views) {
+    D3D11_RENDER_TARGET_VIEW_DESC rd{};
+    rd.ViewDimension = D3D11_RTV_DIMENSION_TEXTURE2D;
+    rd.Format        = DXGI_FORMAT_R8_UNORM;
+    HRESULT hr = device->CreateRenderTargetView(nv12, &rd, &views.luma);
+    rd.Format = DXGI_FORMAT_R8G8_UNORM;
+    if (SUCCEEDED(hr)) hr = device->CreateRenderTargetView(nv12, &rd, &views.chroma);
+    if (FAILED(hr)) {
+        SR_LOG_WARN(L"NV12 plane render target views failed: 0x%08X", hr);
+        views.reset();
+        return false;
+    }
+    return true;
+}
+
+struct Nv12PlaneUavs {
+    Microsoft::WRL::ComPtr<ID3D11UnorderedAccessView> luma;
+    Microsoft::WRL::ComPtr<ID3D11UnorderedAccessView> chroma;
+
+    explicit operator bool() const { return luma && chroma; }
+    void reset() { luma.Reset(); chroma.Reset(); }
+};
+
+// True if `device` can bind NV12 for typed UAV writes (compute converter)
+inline bool nv12_uav_supported(ID3D11Device* device) {
+    UINT support = 0;
+    return SUCCEEDED(device->CheckFormatSupport(DXGI_FORMAT_NV12, &support)) &&
+           (support & D3D11_FORMAT_SUPPORT_TYPED_UNORDERED_ACCESS_VIEW) != 0;
+}
+
+// `nv12` needs D3D11_BIND_UNORDERED_ACCESS
+inline bool create_nv12_plane_uavs(ID3D11Device* device, ID3D11Texture2D* nv12, Nv12PlaneUavs& uavs) {
+    D3D11_UNORDERED_ACCESS_VIEW_DESC ud{};
+    ud.ViewDimension = D3D11_UAV_DIMENSION_TEXTURE2D;
+    ud.Format        = DXGI_FORMAT_R8_UNORM;
+    HRESULT hr = device->CreateUnorderedAccessView(nv12, &ud, &uavs.luma);
+    ud.Format = DXGI_FORMAT_R8G8_UNORM;
+    if (SUCCEEDED(hr)) hr = device->CreateUnorderedAccessView(nv12, &ud, &uavs.chroma);
+    if (FAILED(hr)) {
+        SR_LOG_WARN(L"NV12 plane unordered-access views failed: 0x%08X", hr);
+        uavs.reset();
+        return false;
+    }
+    return true;
+}
+
+} // namespace sr
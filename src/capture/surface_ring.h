@@ -0,0 +1,98 @@
+#pragma once
+// surface_ring.h — Slot bookkeeping for the capture engine's NV12 output textures
+//
+// Each converted frame is written into a slot that no consumer still holds:
+//   acquire()  -> reclaim handed-out slots whose texture the consumer released
+//                 (encoder / MF sample dropped its reference), then claim the
+//                 least recently freed slot for the next VideoProcessorBlt
+//   publish()  -> the slot now holds the latest conversion
+//   abandon()  -> the blit failed; the slot goes straight back to the free list
+// The latest slot is never reclaimed: duplicate frames hand it out again.
+//
+// A queued or in-encode RenderFrame therefore never aliases the texture the VP
+// is writing. The caller decides "still referenced" (the capture engine
+// compares COM refcounts) and owns the textures. Not thread-safe — used from
+// the WGC frame-arrived callback, and by each TranscodeQueue job for its
+// encoder input textures.
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+
+namespace sr {
+
+class SurfaceRing {
+public:
+    static constexpr size_t kMinSlots = 2;
+    static constexpr size_t kMaxSlots = 8;
+
+    // All slots free, no latest conversion. `slots` is clamped to [kMinSlots, kMaxSlots].
+    void reset(size_t slots) {
+        size_ = slots < kMinSlots ? kMinSlots : (slots > kMaxSlots ? kMaxSlots : slots);
+        free_head_ = 0;
+        free_count_ = 0;
+        latest_ = kNone;
+        for (size_t i = 0; i < size_; ++i) {
+            state_[i] = State::Free;
+            push_free(static_cast<uint32_t>(i));
+        }
+    }
+
+    template <typename StillReferenced>
+    std::optional<uint32_t> acquire(StillReferenced&& still_referenced) {
+        for (uint32_t i = 0; i < size_; ++i) {
+            if (state_[i] == State::Out && i != latest_ && !still_referenced(i)) {
+                state_[i] = State::Free;
+                push_free(i);
+            }
+        }
+        if (free_count_ == 0) {
+            ++exhausted_;
+            return std::nullopt;
+        }
+        const uint32_t slot = free_[free_head_];
+        free_head_ = (free_head_ + 1) % kMaxSlots;
+        --free_count_;
+        state_[slot] = State::Writing;
+        return slot;
+    }
+
+    void publish(uint32_t slot) {
+        state_[slot] = State::Out;
+        latest_ = slot;
+    }
+
+    void abandon(uint32_t slot) {
+        state_[slot] = State::Free;
+        push_free(slot);
+    }
+
+    std::optional<uint32_t> latest() const {
+        if (latest_ == kNone) return std::nullopt;
+        return latest_;
+    }
+
+    size_t   size()       const { return size_; }
+    size_t   free_count() const { return free_count_; }
+    uint32_t exhausted()  const { return exhausted_; }   // acquire() calls that found no slot
+
+private:
+    enum class State : uint8_t { Free, Writing, Out };
+    static constexpr uint32_t kNone = UINT32_MAX;
+
+    void push_free(uint32_t slot) {
+        free_[(free_head_ + free_count_) % kMaxSlots] = slot;
+        ++free_count_;
+    }
+
+    std::array<State, kMaxSlots>    state_{};
+    std::array<uint32_t, kMaxSlots> free_{};    // FIFO of free slot indices
+    size_t   size_       = 0;
+    size_t   free_head_  = 0;
+    size_t   free_count_ = 0;
+    uint32_t latest_     = kNone;
+    uint32_t exhausted_  = 0;
+};
+
+} // namespace sr
@@ -0,0 +1,222 @@
+// display_pipeline.cpp — One additional monitor of a multi-monitor session
+// See display_pipeline.h for the stage layout and lifecycle.
+
+#include "controller/display_pipeline.h"
+#include "encoder/video_encoder.h"
+#include "storage/storage_manager.h"
+#include "sync/sync_manager.h"
+#include "utils/logging.h"
+#include "utils/qpc_clock.h"
+#include "utils/thread_qos.h"
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+namespace sr {
+
+DisplayPipeline::DisplayPipeline()
+    : capture_(std::make_unique<CaptureEngine>())
+    , encoder_(std::make_unique<VideoEncoder>())
+    , muxer_  (std::make_unique<MuxWriter>())
+{}
+
+DisplayPipeline::~DisplayPipeline() {
+    stop_capture();
+    join_encoder();
+}
+
+bool DisplayPipeline::open_capture(const ProbeResult& probe, const SyncManager* sync,
+                                   const CaptureSource& source, RecordingResolution max_resolution,
+                                   DeviceLostCallback on_device_lost) {
+    if (!capture_->initialize(probe.d3d_device.Get(), probe.d3d_context.Get(),
+                              &frame_queue_, max_resolution, source)) {
+        return false;
+    }
+    capture_->set_sync_manager(sync);  // every display on the session clock
+    capture_->set_device_lost_callback(std::move(on_device_lost));
+    capture_->set_source_closed_callback([]() {
+        // The session keeps recording its other displays; this file just ends here
+        SR_LOG_WARN(L"Additional display was disconnected; its recording stops receiving frames");
+    });
+    return true;
+}
+
+bool DisplayPipeline::open_encoder(const ProbeResult& probe, const DisplayPipelineConfig& cfg,
+                                   const EncoderStreamPlan& plan, const std::atomic<bool>* mux_running) {
+    EncoderProfile prof = cfg.profile;
+    prof.width  = capture_->width()  ? capture_->width()  : 1920;
+    prof.height = capture_->height() ? capture_->height() : 1080;
+    if (prof.gop_frames > 0) {
+        prof.gop_frames = (std::max)(1u, prof.gop_frames * plan.fps / (std::max)(1u, prof.fps));
+    }
+    // Fewer frames, same quality per frame
+    prof.bitrate_bps = static_cast<uint32_t>(uint64_t{ prof.bitrate_bps } * plan.fps / (std::max)(1u, prof.fps));
+    prof.fps = plan.fps;
+
+    encoder_->set_power_tuning(cfg.on_ac, cfg.high_quality);
+    const bool opened = plan.hardware
+        ? encoder_->initialize(prof, probe.dxgi_device_manager.Get(), probe.d3d_device.Get(),
+                               probe.d3d_context.Get())
+        : encoder_->initialize_mode(EncoderMode::SoftwareMFT, prof, probe.dxgi_device_manager.Get(),
+                                    probe.d3d_device.Get(), probe.d3d_context.Get());
+    if (!opened) return false;
+
+    MuxConfig mux = cfg.mux;
+    mux.video_width   = encoder_->output_width();
+    mux.video_height  = encoder_->output_height();
+    mux.video_fps_num = encoder_->output_fps();
+    mux.video_bitrate = encoder_->output_bitrate();
+    mux.video_codec   = encoder_->codec();
+    mux.variable_frame_rate = cfg.variable_frame_rate;
+    mux.video_sequence_header.clear();
+    encoder_->sequence_header(mux.video_sequence_header);
+    if (!muxer_->initialize(cfg.partial_path, StorageManager::partialToFinal(cfg.partial_path), mux)) {
+        encoder_->shutdown();
+        return false;
+    }
+
+    fps_ = encoder_->output_fps();
+    capture_->set_frame_rate_limit(fps_);
+    pacer_.set_variable_rate(cfg.variable_frame_rate);
+    pacer_.initialize(fps_);
+    governor_.reset(encoder_->output_bitrate(), fps_);
+    adaptive_quality_ = cfg.adaptive_quality;
+    high_quality_     = cfg.high_quality;
+    pipeline_boost_   = cfg.pipeline_boost;
+    on_ac_.store(cfg.on_ac, std::memory_order_relaxed);
+    mux_running_      = mux_running;
+    frames_written_.store(0, std::memory_order_relaxed);
+    pacer_drops_.store(0, std::memory_order_relaxed);
+    return true;
+}
+
+bool DisplayPipeline::start() {
+    running_.store(true, std::memory_order_release);
+    thread_ = std::thread(&DisplayPipeline::encode_loop, this);
+    return capture_->start();
+}
+
+void DisplayPipeline::set_suspended(bool suspended) {
+    suspended_.store(suspended, std::memory_order_release);
+    if (!suspended) resumed_.store(true, std::memory_order_release);
+    // Last on resume: the parked frame is queued behind the IDR request
+    capture_->set_suspended(suspended);
+}
+
+void DisplayPipeline::stop_capture() {
+    capture_->stop();
+}
+
+void DisplayPipeline::join_encoder() {
+    running_.store(false, std::memory_order_release);
+    if (thread_.joinable()) thread_.join();
+}
+
+EncoderMode DisplayPipeline::mode() const {
+    return encoder_->mode();
+}
+
+void DisplayPipeline::push(ComPtr<IMFSample>&& sample) {
+    // Same rule as the session's stages: never drop encoded video, wait for the mux stage
+    while (!encoded_queue_.try_push(std::move(sample))) {
+        if (mux_running_ && !mux_running_->load(std::memory_order_acquire)) return;
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Encode stage — runs on thread_. video_encode_loop without the session-only
+// parts (profile switching, segment formats, latency telemetry): pace, let
+// the governor decimate under overload, encode, hand to the mux stage. A
+// power switch only retunes the encoder; the scheduler owns size and rate.
+// ---------------------------------------------------------------------------
+void DisplayPipeline::encode_loop() {
+    SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_ABOVE_NORMAL);
+    MmcssScope mmcss(pipeline_boost_ ? L"Capture" : nullptr);
+    if (pipeline_boost_) set_thread_eco_qos_opt_out(true);
+    const QPCClock& clock = QPCClock::instance();
+    bool tuned_on_ac = on_ac_.load(std::memory_order_acquire);
+    const auto wait_interval = std::chrono::milliseconds(500 / (std::max)(1u, fps_));
+    ComPtr<ID3D11Texture2D> last_texture;
+    int64_t  last_paced_pts     = 0;
+    uint32_t last_capture_drops = capture_->frames_dropped();
+
+    while (running_.load(std::memory_order_acquire) || !frame_queue_.empty()) {
+        if (resumed_.exchange(false, std::memory_order_acq_rel)) {
+            pacer_.reset();
+            last_texture.Reset();
+            encoder_->request_keyframe();
+        }
+        if (const bool on_ac = on_ac_.load(std::memory_order_acquire); on_ac != tuned_on_ac) {
+            encoder_->set_power_tuning(on_ac, high_quality_);
+            tuned_on_ac = on_ac;
+        }
+        if (auto opt_frame = frame_queue_.wait_pop(wait_interval)) {
+            auto& frame = *opt_frame;
+            if (suspended_.load(std::memory_order_acquire)) continue;
+            const int64_t dequeued_us = clock.now_us();
+
+            int64_t paced_pts = frame.pts;
+            const PaceAction action = pacer_.pace_frame(frame.pts, false, &paced_pts, frame.is_duplicate);
+            if (action == PaceAction::Drop) {
+                pacer_drops_.fetch_add(1, std::memory_order_relaxed);
+                governor_.on_drop();
+                continue;
+            }
+            if (action == PaceAction::Skip) continue;
+            if (adaptive_quality_ && !governor_.admit(paced_pts)) continue;
+
+            if (action == PaceAction::Duplicate && last_texture && governor_.level() == 0) {
+                ComPtr<IMFSample> dup;
+                if (encoder_->encode_frame(last_texture.Get(), last_paced_pts + (paced_pts - last_paced_pts) / 2, dup)) {
+                    push(std::move(dup));
+                }
+            }
+
+            last_texture = frame.texture;
+            ComPtr<IMFSample> encoded;
+            if (encoder_->encode_frame(frame.texture.Get(), paced_pts, encoded, &frame.dirty)) {
+                governor_.on_frame(clock.now_us() - dequeued_us, frame_queue_.size());
+                push(std::move(encoded));
+            }
+            last_paced_pts = paced_pts;
+        }
+
+        for (ComPtr<IMFSample> ready; encoder_->take_output(ready); ready.Reset()) {
+            push(std::move(ready));
+        }
+
+        const uint32_t capture_drops = capture_->frames_dropped();
+        if (adaptive_quality_ && !suspended_.load(std::memory_order_acquire)) {
+            governor_.on_drop(capture_drops - last_capture_drops);
+            if (governor_.evaluate(clock.now_us())) {
+                SR_LOG_INFO(L"[Quality] display %ux%u level %u: %u bps, %u fps", width(), height(),
+                            governor_.level(), governor_.bitrate_bps(), governor_.fps());
+                encoder_->set_bitrate(governor_.bitrate_bps());
+            }
+        }
+        last_capture_drops = capture_drops;
+    }
+}
+
+void DisplayPipeline::write_ready() {
+    while (auto opt = encoded_queue_.try_pop()) {
+        if (muxer_->write_video(opt->Get())) frames_written_.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void DisplayPipeline::write_audio(IMFSample* sample, AudioTrack track) {
+    muxer_->write_audio(sample, track);
+}
+
+void DisplayPipeline::finish() {
+    write_ready();
+    std::vector<ComPtr<IMFSample>> leftover;
+    encoder_->flush(leftover);
+    for (auto& s : leftover) {
+        if (muxer_->write_video(s.Get())) frames_written_.fetch_add(1, std::memory_order_relaxed);
+    }
+    encoder_->shutdown();
+}
+
+} // namespace sr
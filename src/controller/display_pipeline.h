@@ -0,0 +1,128 @@
+#pragma once
+// display_pipeline.h — One additional monitor of a multi-monitor session
+//
+// SessionController records its capture source through its own engines;
+// with set_multi_monitor() every other monitor gets a DisplayPipeline:
+//
+//   CaptureEngine -> FrameQueue -> encode thread (FramePacer, QualityGovernor,
+//   VideoEncoder) -> encoded queue -> MuxWriter (<name>_displayN.mp4)
+//
+// All pipelines borrow the session's D3D11 device and DXGI device manager.
+// The session's mux stage is the only writer of each MuxWriter: it takes the
+// encoded video with write_ready() and hands every sample of the session's
+// audio mix to write_audio(), so audio is captured and mixed once.
+//
+// Lifecycle (SessionController):
+//   open_capture() -> schedule_encoder_streams() -> open_encoder() -> start()
+//   stop_capture() -> join_encoder() -> [mux stage exits] -> finish() -> take_muxer()
+//
+// The encode thread gets the session's scheduling treatment (MMCSS, EcoQoS
+// opt-out with pipeline_boost) and follows its power state (set_power_state).
+
+#include <windows.h>
+#include <mfobjects.h>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <utility>
+#include "capture/capture_engine.h"   // FrameQueue, CaptureSource
+#include "encoder/encoder_probe.h"
+#include "encoder/encoder_scheduler.h"
+#include "storage/mux_writer.h"
+#include "sync/frame_pacer.h"
+#include "sync/quality_governor.h"
+#include "utils/bounded_queue.h"
+
+namespace sr {
+
+class SyncManager;
+class VideoEncoder;
+
+struct DisplayPipelineConfig {
+    EncoderProfile profile;               // bitrate / GOP / codec; size and fps are the pipeline's
+    bool           high_quality = false;
+    bool           on_ac        = true;
+    bool           variable_frame_rate = false;
+    bool           adaptive_quality    = false;
+    bool           pipeline_boost      = true;    // MMCSS + EcoQoS opt-out on the encode thread
+    std::wstring   partial_path;
+    MuxConfig      mux;                   // audio and container fields; video is filled in
+};
+
+class DisplayPipeline {
+public:
+    DisplayPipeline();
+    ~DisplayPipeline();
+
+    DisplayPipeline(const DisplayPipeline&)            = delete;
+    DisplayPipeline& operator=(const DisplayPipeline&) = delete;
+
+    // Capture first: width()/height() feed the encoder scheduler. The shared
+    // device is the session's, so `on_device_lost` (capture thread) should
+    // end the whole session.
+    bool open_capture(const ProbeResult& probe, const SyncManager* sync,
+                      const CaptureSource& source, RecordingResolution max_resolution,
+                      DeviceLostCallback on_device_lost);
+
+    // Encoder (hardware chain or software only, at plan.fps) and output file.
+    // `mux_running`: the session's mux stage flag, for encode backpressure.
+    bool open_encoder(const ProbeResult& probe, const DisplayPipelineConfig& cfg,
+                      const EncoderStreamPlan& plan, const std::atomic<bool>* mux_running);
+
+    bool start();                          // encode thread, then capture
+    void set_suspended(bool suspended);    // pause / resume; resume opens on an IDR
+    // Any thread: AC / battery switch; the encode thread retunes the encoder
+    void set_power_state(bool on_ac) { on_ac_.store(on_ac, std::memory_order_release); }
+    void stop_capture();
+    void join_encoder();                   // drains the frame queue first
+
+    // Mux stage only
+    bool mux_pending() const { return !encoded_queue_.empty(); }
+    void write_ready();
+    void write_audio(IMFSample* sample, AudioTrack track);
+    uint64_t bytes_written() const { return muxer_->bytes_written(); }
+
+    // After the mux stage has exited: write the encoder's tail, then hand
+    // the muxer to the finalizer
+    void finish();
+    std::unique_ptr<MuxWriter> take_muxer() { return std::exchange(muxer_, std::make_unique<MuxWriter>()); }
+
+    uint32_t    width()  const { return capture_->width(); }
+    uint32_t    height() const { return capture_->height(); }
+    uint32_t    fps()    const { return fps_; }
+    EncoderMode mode()   const;
+    uint32_t    frames_captured() const { return capture_->frames_captured(); }
+    uint32_t    frames_dropped()  const { return capture_->frames_dropped() + pacer_drops_.load(std::memory_order_relaxed); }
+    uint32_t    frames_written()  const { return frames_written_.load(std::memory_order_relaxed); }
+    uint32_t    quality_level()   const { return governor_.level(); }
+
+private:
+    using EncodedQueue = BoundedQueue<ComPtr<IMFSample>, 16, SingleProducer>;
+
+    void encode_loop();
+    void push(ComPtr<IMFSample>&& sample);
+
+    std::unique_ptr<CaptureEngine> capture_;
+    std::unique_ptr<VideoEncoder>  encoder_;
+    std::unique_ptr<MuxWriter>     muxer_;
+    FrameQueue                     frame_queue_;
+    EncodedQueue                   encoded_queue_;
+    FramePacer                     pacer_;       // encode thread
+    QualityGovernor                governor_;    // encode thread
+    bool                           adaptive_quality_ = false;
+    bool                           high_quality_     = false;
+    bool                           pipeline_boost_   = true;
+    uint32_t                       fps_ = 0;
+    const std::atomic<bool>*       mux_running_ = nullptr;
+
+    std::thread                    thread_;
+    std::atomic<bool>              running_{ false };
+    std::atomic<bool>              suspended_{ false };
+    std::atomic<bool>              resumed_{ false };   // encode thread: reset pacing, request an IDR
+    std::atomic<bool>              on_ac_{ true };
+    std::atomic<uint32_t>          frames_written_{ 0 };
+    std::atomic<uint32_t>          pacer_drops_{ 0 };
+};
+
+} // namespace sr
@@ -1,20 +1,29 @@
 // session_controller.cpp — Wires all engines together into the recording pipeline
-// T016: Start -> init engines -> run capture->encode->mux loop -> Stop -> finalize
+// T016: Start -> init engines -> run capture->encode->mux stages -> Stop -> finalize
 
 #include "controller/session_controller.h"
+#include "controller/display_pipeline.h"
 #include "capture/capture_engine.h"
 #include "audio/audio_engine.h"
-#include "audio/audio_mixer.h"
+#include "audio/audio_timeline_mixer.h"
+#include "encoder/sample_pool.h"
 #include "encoder/video_encoder.h"
 #include "storage/mux_writer.h"
+#include "storage/mdat_scan.h"
 #include "storage/storage_manager.h"
 #include "utils/logging.h"
+#include "utils/perf_trace.h"
+#include "utils/qpc_clock.h"
+#include "utils/thread_qos.h"
+#include "utils/trace_events.h"
 
 #include <mfapi.h>
 #include <thread>
 #include <chrono>
+#include <utility>
 #include <algorithm>
 #include <array>
+#include <cstring>
 #include <dxgi1_4.h>
 #include <psapi.h>
 
@@ -22,13 +31,104 @@ namespace sr {
 
 namespace {
 
-const wchar_t* encoder_mode_label(EncoderMode mode) {
-    switch (mode) {
-        case EncoderMode::HardwareMFT: return L"HW";
-        case EncoderMode::SoftwareMFT: return L"SW";
-        case EncoderMode::SoftwareMFT720p: return L"SW 720p";
-        default: return L"?";
+bool is_clean_point(IMFSample* sample) {
+    UINT32 clean = 0;
+    return SUCCEEDED(sample->GetUINT32(MFSampleExtension_CleanPoint, &clean)) && clean != 0;
+}
+
+// Deep copy of `src` into a plain memory sample (payload, attributes, times).
+// The replay ring keeps samples for minutes; holding the encoder's pooled
+// output (SamplePool) that long would starve the pool.
+HRESULT copy_sample_payload(IMFSample* src, ComPtr<IMFSample>& out) {
+    ComPtr<IMFMediaBuffer> in_buf;
+    HRESULT hr = src->ConvertToContiguousBuffer(&in_buf);
+    BYTE* in = nullptr;
+    DWORD len = 0;
+    if (SUCCEEDED(hr)) hr = in_buf->Lock(&in, nullptr, &len);
+    if (FAILED(hr)) return hr;
+    ComPtr<IMFMediaBuffer> out_buf;
+    BYTE* dst = nullptr;
+    hr = MFCreateMemoryBuffer((std::max)(len, DWORD{ 1 }), &out_buf);
+    if (SUCCEEDED(hr)) hr = out_buf->Lock(&dst, nullptr, nullptr);
+    if (SUCCEEDED(hr)) {
+        memcpy(dst, in, len);
+        out_buf->Unlock();
+        out_buf->SetCurrentLength(len);
+    }
+    in_buf->Unlock();
+    if (SUCCEEDED(hr)) hr = MFCreateSample(out.ReleaseAndGetAddressOf());
+    if (FAILED(hr)) return hr;
+    src->CopyAllItems(out.Get());
+    LONGLONG t = 0, dur = 0;
+    if (SUCCEEDED(src->GetSampleTime(&t)))     out->SetSampleTime(t);
+    if (SUCCEEDED(src->GetSampleDuration(&dur))) out->SetSampleDuration(dur);
+    return out->AddBuffer(out_buf.Get());
+}
+
+LiveVideoFormat live_format(uint32_t width, uint32_t height, uint32_t fps, uint32_t bitrate_bps,
+                            const std::vector<uint8_t>& sequence_header) {
+    LiveVideoFormat f;
+    f.width       = width;
+    f.height      = height;
+    f.fps         = fps;
+    f.bitrate_bps = bitrate_bps;
+    split_annexb_parameter_sets(sequence_header, f.sps, f.pps);
+    return f;
+}
+
+// Process and adapter memory, shared by the 5 s [Perf] log and the perf trace
+struct MemorySample {
+    bool     process = false;
+    uint64_t private_mb = 0;
+    uint64_t working_set_mb = 0;
+    bool     gpu = false;
+    uint64_t local_mb = 0, local_budget_mb = 0;
+    uint64_t shared_mb = 0, shared_budget_mb = 0;
+};
+
+MemorySample sample_memory(IDXGIAdapter3* adapter) {
+    MemorySample m;
+    PROCESS_MEMORY_COUNTERS_EX mem{};
+    mem.cb = sizeof(mem);
+    if (GetProcessMemoryInfo(GetCurrentProcess(), reinterpret_cast<PROCESS_MEMORY_COUNTERS*>(&mem), sizeof(mem))) {
+        m.process        = true;
+        m.working_set_mb = static_cast<uint64_t>(mem.WorkingSetSize / (1024ull * 1024ull));
+        m.private_mb     = static_cast<uint64_t>(mem.PrivateUsage / (1024ull * 1024ull));
     }
+    if (adapter) {
+        DXGI_QUERY_VIDEO_MEMORY_INFO local_info{};
+        DXGI_QUERY_VIDEO_MEMORY_INFO nonlocal_info{};
+        const HRESULT hr_local = adapter->QueryVideoMemoryInfo(
+            0, DXGI_MEMORY_SEGMENT_GROUP_LOCAL, &local_info);
+        const HRESULT hr_nonlocal = adapter->QueryVideoMemoryInfo(
+            0, DXGI_MEMORY_SEGMENT_GROUP_NON_LOCAL, &nonlocal_info);
+        if (SUCCEEDED(hr_local) && SUCCEEDED(hr_nonlocal)) {
+            m.gpu              = true;
+            m.local_mb         = local_info.CurrentUsage / (1024ull * 1024ull);
+            m.local_budget_mb  = local_info.Budget / (1024ull * 1024ull);
+            m.shared_mb        = nonlocal_info.CurrentUsage / (1024ull * 1024ull);
+            m.shared_budget_mb = nonlocal_info.Budget / (1024ull * 1024ull);
+        }
+    }
+    return m;
+}
+
+PerfTraceCounters perf_counters(const TelemetrySnapshot& t) {
+    PerfTraceCounters c;
+    c.captured   = t.frames_captured;
+    c.encoded    = t.frames_encoded;
+    c.dropped    = t.frames_dropped;
+    c.duplicated = t.dup_frames;
+    c.unchanged  = t.unchanged_skipped;
+    return c;
+}
+
+// AdaptiveGop change signal of a captured frame
+double gop_change(const RenderFrame& frame) {
+    if (frame.is_duplicate) return 0.0;
+    const uint64_t surface = uint64_t{ frame.dirty.width() } * frame.dirty.height();
+    if (!frame.dirty.known() || surface == 0) return kGopChangeUnknown;
+    return (std::min)(1.0, static_cast<double>(frame.dirty.area()) / static_cast<double>(surface));
 }
 
 } // namespace
@@ -42,17 +142,32 @@ SessionController::SessionController()
     , frame_queue_(std::make_unique<FrameQueue>())
     , audio_queue_(std::make_unique<AudioQueue>())
     , loopback_queue_(std::make_unique<AudioQueue>())
+    , encoded_video_queue_(std::make_unique<EncodedVideoQueue>())
+    , encoded_audio_queue_(std::make_unique<EncodedAudioQueue>())
+    , proxy_frame_queue_(std::make_unique<FrameQueue>())
+    , proxy_encoder_(std::make_unique<VideoEncoder>())
+    , proxy_muxer_(std::make_unique<MuxWriter>())
+    , encoded_proxy_queue_(std::make_unique<EncodedVideoQueue>())
 {}
 
 SessionController::~SessionController() {
-    if (!machine_.is_idle()) {
-        encode_running_.store(false, std::memory_order_release);
+    if (probe_validator_.joinable()) probe_validator_.join();
+    if (arm_thread_.joinable()) arm_thread_.join();
+    if (auto_stop_thread_.joinable()) auto_stop_thread_.join();
+    if (machine_.is_armed()) {
+        disarm();
+    } else if (!machine_.is_idle()) {
         capture_->stop();
         audio_->stop();
         loopback_audio_->stop();
-        if (encode_thread_.joinable()) encode_thread_.join();
+        for (auto& d : displays_) d->stop_capture();
+        join_pipeline_threads();
         muxer_->finalize();
+        if (proxy_active_) proxy_muxer_->finalize();
+        for (auto& d : displays_) d->take_muxer()->finalize();
     }
+    // Files still closing from earlier stops and segment rotations
+    finalizer_.drain();
 }
 
 bool SessionController::initialize(StorageManager* storage,
@@ -71,43 +186,41 @@ bool SessionController::initialize(StorageManager* storage,
     }
 
     // Probe D3D11 + HW encoder
-    if (!EncoderProbe::run(probe_)) {
+    if (!EncoderProbe::run(probe_, probe_cache_path_, adapter_policy_,
+                           resolve_display_monitor(capture_source_))) {
         notify_error(L"D3D11 initialization failed");
         return false;
     }
 
-    SR_LOG_INFO(L"SessionController initialized. Adapter: %s, HW encoder: %s",
+    // A cached encoder list is only a hint: VideoEncoder enumerates for real
+    // when it opens. Re-check in the background so a changed driver or codec
+    // pack corrects the cache for the next launch.
+    if (probe_.encoders_from_cache) {
+        probe_validator_ = std::thread([path = probe_cache_path_, id = probe_.adapter_id,
+                                        cached = probe_.cached_encoders()]() {
+            SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_BELOW_NORMAL);
+            const HRESULT co = CoInitializeEx(nullptr, COINIT_MULTITHREADED);
+            ProbeResult fresh;
+            EncoderProbe::enumerate_encoders(fresh);
+            if (!(fresh.cached_encoders() == cached)) {
+                SR_LOG_WARN(L"Probe cache was stale (H.264: %s) — refreshed for next launch",
+                            fresh.hw_encoder_available ? fresh.encoder_name.c_str() : L"none");
+                ProbeCache::save(path, id, fresh.cached_encoders());
+            }
+            if (SUCCEEDED(co)) CoUninitialize();
+        });
+    }
+
+    SR_LOG_INFO(L"SessionController initialized. Adapter: %s, HW encoder: %s (HEVC: %s, AV1: %s)",
         probe_.adapter_name.c_str(),
-        probe_.hw_encoder_available ? probe_.encoder_name.c_str() : L"not available"
+        probe_.hw_encoder_available ? probe_.encoder_name.c_str() : L"not available",
+        probe_.hw_hevc_available ? L"yes" : L"no",
+        probe_.hw_av1_available ? L"yes" : L"no"
     );
     return true;
 }
 
-bool SessionController::start() {
-    if (!machine_.transition(SessionEvent::Start)) return false;
-
-    // Elevate process priority during recording for smooth capture
-    SetPriorityClass(GetCurrentProcess(), ABOVE_NORMAL_PRIORITY_CLASS);
-
-    notify_status(L"Starting...");
-
-    // ---------------------------------------------------------------
-    // Determine output paths
-    // generateFilename() returns the .partial.mp4 path
-    // ---------------------------------------------------------------
-    current_partial_path_ = storage_ ? storage_->generateFilename() : L"ScreenRec.partial.mp4";
-    current_output_path_  = StorageManager::partialToFinal(current_partial_path_);
-    if (diagnostics_.open_for_output(current_output_path_)) {
-        SR_LOG_INFO(L"Diagnostics log -> %s", diagnostics_.path().c_str());
-    } else {
-        SR_LOG_WARN(L"Diagnostics log could not be opened for: %s", current_output_path_.c_str());
-    }
-
-    // ---------------------------------------------------------------
-    // Anchor sync clock
-    // ---------------------------------------------------------------
-    sync_.start();
-
+const wchar_t* SessionController::prepare_engines() {
     // ---------------------------------------------------------------
     // Resolve requested recording profile before capture initialization.
     // This lets capture allocate only the texture size the active profile needs.
@@ -129,45 +242,53 @@ bool SessionController::start() {
     }
 
     // T042: Apply base-mode power clamping before capture allocates output textures.
+    // The unclamped profile is kept so a power flip can re-clamp it mid-session.
+    requested_profile_    = enc_prof;
+    session_high_quality_ = high_quality_profile;
     last_power_ac_ = PowerModeDetector::is_on_ac_power();
     enc_prof = PowerModeDetector::clamp_for_quality_and_power_state(
         enc_prof, last_power_ac_, high_quality_profile);
 
     // ---------------------------------------------------------------
-    // Initialize CaptureEngine
+    // Initialize CaptureEngine (the profile's source crop is applied in the VP blit)
     // ---------------------------------------------------------------
+    CaptureSource capture_source = capture_source_;
+    capture_source.crop = enc_prof.source_crop;
+    // The source may have moved to another monitor since the device was made
+    EncoderProbe::update_display_adapter(probe_, resolve_display_monitor(capture_source));
+    capture_->set_capture_adapter(probe_.capture_adapter.Get());
+    const bool want_proxy = proxy_enabled_ && replay_seconds_ == 0;
+    capture_->set_proxy_output(want_proxy ? proxy_frame_queue_.get() : nullptr, proxy_resolution_);
+    capture_->set_frame_rate_limit(enc_prof.fps);   // the proxy shares the main fps
     if (!capture_->initialize(probe_.d3d_device.Get(),
                                probe_.d3d_context.Get(),
                                frame_queue_.get(),
-                               {enc_prof.width, enc_prof.height}))
+                               {enc_prof.width, enc_prof.height},
+                               capture_source))
     {
-        diagnostics_.write_failure(L"capture_engine_initialization_failed");
-        notify_error(L"Capture engine initialization failed");
-        machine_.transition(SessionEvent::Stop);
-        machine_.transition(SessionEvent::Finalized);
-        return false;
+        return L"capture_engine_initialization_failed";
     }
-    capture_->set_sync_anchor_100ns(0); // anchor is always 0; PTS computed from sync_
+    // Isolation needs a context that can wait and signal; the capture engine
+    // stays on the shared device otherwise, so this As() cannot fail there
+    gpu_wait_context_.Reset();
+    if (capture_->device_isolated()) probe_.d3d_context.As(&gpu_wait_context_);
+    capture_->set_sync_manager(&sync_);  // frame PTS = compose time on the sync_ clock
 
     // ---------------------------------------------------------------
     // Initialize AudioEngine (microphone)
     // ---------------------------------------------------------------
-    if (!audio_->initialize(audio_queue_.get(), AudioCaptureMode::Microphone)) {
-        notify_error(L"Microphone audio init failed (no microphone?)");
-        SR_LOG_WARN(L"Continuing without microphone audio");
-    } else {
-        audio_->set_sync_anchor_100ns(0);
-    }
+    const AudioLatencyMode audio_latency =
+        PowerModeDetector::audio_latency_for_power_state(audio_latency_, last_power_ac_);
+    audio_->set_latency_mode(audio_latency);
+    loopback_audio_->set_latency_mode(audio_latency);
+    have_mic_ = audio_->initialize(audio_queue_.get(), AudioCaptureMode::Microphone);
+    if (have_mic_) audio_->set_sync_anchor_100ns(0);
 
     // ---------------------------------------------------------------
     // Initialize Loopback AudioEngine (system/desktop audio)
     // ---------------------------------------------------------------
-    if (!loopback_audio_->initialize(loopback_queue_.get(), AudioCaptureMode::Loopback)) {
-        notify_error(L"System audio loopback init failed");
-        SR_LOG_WARN(L"Continuing without system audio capture");
-    } else {
-        loopback_audio_->set_sync_anchor_100ns(0);
-    }
+    have_loopback_ = loopback_audio_->initialize(loopback_queue_.get(), AudioCaptureMode::Loopback);
+    if (have_loopback_) loopback_audio_->set_sync_anchor_100ns(0);
 
     // ---------------------------------------------------------------
     // Initialize VideoEncoder with the actual capture output dimensions.
@@ -175,17 +296,150 @@ bool SessionController::start() {
     enc_prof.width  = capture_->width()  ? capture_->width()  : 1920;
     enc_prof.height = capture_->height() ? capture_->height() : 1080;
 
+    // fMP4: one fragment per GOP, so the GOP follows the fragment duration and
+    // the encode stage forces IDRs on the same cadence in wall time.
+    if (output_container_ == MuxContainer::FragmentedMp4) {
+        const uint32_t fragment_ms = (std::clamp)(fragment_ms_, 500u, 10'000u);
+        enc_prof.gop_frames = (std::max)(1u, enc_prof.fps * fragment_ms / 1000);
+    }
+
+    // Adaptive GOP: the encoder's own GOP becomes the seekability bound and
+    // the encode stage asks for the IDRs in between. Fixed cadence where the
+    // consumer needs it: fMP4 fragments, the replay ring's GOP eviction and
+    // viewers joining a live stream.
+    gop_adaptive_ = adaptive_gop_ && output_container_ != MuxContainer::FragmentedMp4 &&
+                    replay_seconds_ == 0 && live_cfg_.url.empty();
+    if (gop_adaptive_) enc_prof.gop_frames = (std::max)(1u, enc_prof.fps) * gop_max_seconds_;
+
+    encoder_->set_power_tuning(last_power_ac_, high_quality_profile);
     if (!encoder_->initialize(enc_prof,
                                probe_.dxgi_device_manager.Get(),
                                probe_.d3d_device.Get(),
                                probe_.d3d_context.Get()))
     {
-        diagnostics_.write_failure(L"video_encoder_initialization_failed");
-        notify_error(L"Video encoder initialization failed");
+        release_engines();
+        return L"video_encoder_initialization_failed";
+    }
+    active_profile_ = enc_prof;
+    feed_width_     = enc_prof.width;
+    feed_height_    = enc_prof.height;
+    pending_video_format_.reset();
+    return nullptr;
+}
+
+void SessionController::release_engines() {
+    capture_->stop();
+    audio_->stop();
+    loopback_audio_->stop();
+    encoder_->shutdown();
+}
+
+bool SessionController::arm() {
+    std::lock_guard<std::mutex> lock(arm_mutex_);
+    if (!machine_.is_idle()) return false;
+
+    const QPCClock& clock = QPCClock::instance();
+    const int64_t t0 = clock.now_us();
+    if (const wchar_t* failure = prepare_engines()) {
+        // Not fatal: start() retries the same setup and reports it properly
+        SR_LOG_WARN(L"Pre-arm failed (%s); the next start initializes from cold", failure);
+        return false;
+    }
+    machine_.transition(SessionEvent::Arm);
+    SR_LOG_INFO(L"Session armed in %lld ms: %ux%u @ %u fps, %s encoder ready",
+                (clock.now_us() - t0) / 1000, active_profile_.width, active_profile_.height,
+                active_profile_.fps, video_codec_label(encoder_->codec()));
+    return true;
+}
+
+void SessionController::arm_async() {
+    std::lock_guard<std::mutex> lock(arm_thread_mutex_);
+    if (arm_thread_.joinable()) arm_thread_.join();
+    arm_thread_ = std::thread([this]() {
+        const HRESULT co = CoInitializeEx(nullptr, COINIT_MULTITHREADED);
+        arm();
+        if (SUCCEEDED(co)) CoUninitialize();
+    });
+}
+
+void SessionController::disarm() {
+    std::lock_guard<std::mutex> lock(arm_mutex_);
+    if (!machine_.transition(SessionEvent::Disarm)) return;
+    release_engines();
+    SR_LOG_INFO(L"Session disarmed");
+}
+
+bool SessionController::start() {
+    // A previous auto-stop has finished by the time we are Idle again
+    if (auto_stop_thread_.joinable() && auto_stop_thread_.get_id() != std::this_thread::get_id()) {
+        auto_stop_thread_.join();
+    }
+    std::unique_lock<std::mutex> arm_lock(arm_mutex_);
+    const bool warm = machine_.is_armed();
+    if (!machine_.transition(SessionEvent::Start)) return false;
+
+    notify_status(L"Starting...");
+
+    // ---------------------------------------------------------------
+    // Determine output paths
+    // generateFilename() returns the .partial.mp4 path
+    // ---------------------------------------------------------------
+    current_partial_path_ = storage_ ? storage_->generateFilename() : L"ScreenRec.partial.mp4";
+    current_output_path_  = StorageManager::partialToFinal(current_partial_path_);
+    if (diagnostics_.open_for_output(current_output_path_)) {
+        SR_LOG_INFO(L"Diagnostics log -> %s", diagnostics_.path().c_str());
+    } else {
+        SR_LOG_WARN(L"Diagnostics log could not be opened for: %s", current_output_path_.c_str());
+    }
+
+    // ---------------------------------------------------------------
+    // Capture, audio and the encoder: already open when armed
+    // ---------------------------------------------------------------
+    if (warm) {
+        SR_LOG_INFO(L"Starting from armed session");
+    } else if (const wchar_t* failure = prepare_engines()) {
+        diagnostics_.write_failure(failure);
+        notify_error(wcscmp(failure, L"capture_engine_initialization_failed") == 0
+                         ? L"Capture engine initialization failed"
+                         : L"Video encoder initialization failed");
         machine_.transition(SessionEvent::Stop);
         machine_.transition(SessionEvent::Finalized);
         return false;
     }
+    arm_lock.unlock();
+
+    // From here on every early return goes through set_recording_priority(false)
+    // (or stop()); the GPU priority needs the device prepare_engines() opened
+    set_recording_priority(true);
+
+    if (!have_mic_) {
+        notify_error(L"Microphone audio init failed (no microphone?)");
+        SR_LOG_WARN(L"Continuing without microphone audio");
+    }
+    const bool have_loopback = have_loopback_;
+    if (!have_loopback) {
+        notify_error(L"System audio loopback init failed");
+        SR_LOG_WARN(L"Continuing without system audio capture");
+    }
+
+    const EncoderProfile enc_prof = active_profile_;
+    const bool high_quality_profile = session_high_quality_;
+    const bool want_proxy = proxy_enabled_ && replay_seconds_ == 0;
+    const bool fragmented = output_container_ == MuxContainer::FragmentedMp4;
+    const uint32_t fragment_ms = (std::clamp)(fragment_ms_, 500u, 10'000u);
+    // The encoder's GOP counts frames; VFR sessions skip most of them, so the
+    // IDR cadence is kept in time instead (fMP4 fragments take precedence)
+    const uint32_t gop_fps   = (std::max)(1u, enc_prof.fps);
+    const int64_t  gop_100ns = static_cast<int64_t>(enc_prof.gop_frames > 0 ? enc_prof.gop_frames : gop_fps) *
+                               10'000'000 / gop_fps;
+    timed_keyframes_.reset(fragmented ? static_cast<int64_t>(fragment_ms) * 10'000
+                           : variable_frame_rate_ && !gop_adaptive_ ? gop_100ns : 0);
+    gop_schedule_.reset(gop_adaptive_ ? static_cast<int64_t>((std::max)(1u, enc_prof.gop_seconds)) * 10'000'000 : 0,
+                        static_cast<int64_t>(gop_max_seconds_) * 10'000'000);
+    if (gop_adaptive_) {
+        SR_LOG_INFO(L"Adaptive GOP: %u s while the content moves, up to %u s while static",
+                    (std::max)(1u, enc_prof.gop_seconds), gop_max_seconds_);
+    }
 
     // ---------------------------------------------------------------
     // Initialize MuxWriter
@@ -194,26 +448,113 @@ bool SessionController::start() {
     mux_cfg.video_width  = encoder_->output_width();
     mux_cfg.video_height = encoder_->output_height();
     mux_cfg.video_fps_num= encoder_->output_fps();
+    mux_cfg.video_bitrate = encoder_->output_bitrate();
+    mux_cfg.video_codec  = encoder_->codec();
+    mux_cfg.container    = output_container_;
+    mux_cfg.fragment_ms  = fragment_ms;
+    mux_cfg.variable_frame_rate = variable_frame_rate_;
+    mux_cfg.unbuffered_io = unbuffered_io_;
+    mux_cfg.io_chunk_mb  = (std::clamp)(io_chunk_mb_, 4u, 8u);
+    mux_cfg.preallocate  = preallocate_;
+    mux_cfg.keyframe_index = keyframe_index_;
+    encoder_->sequence_header(mux_cfg.video_sequence_header);
     mux_cfg.audio_sample_rate      = audio_->sample_rate();
     mux_cfg.audio_channels         = audio_->channels();
     mux_cfg.audio_bits_per_sample  = audio_->bits_per_sample();
     mux_cfg.audio_is_float         = (audio_->bits_per_sample() == 32);
+    mux_cfg.audio_codec            = audio_codec_;
+    mux_cfg.aac_profile            = aac_profile_;
+    mux_cfg.audio_bitrate          = audio_bitrate_;
+    // Separate tracks: system audio keeps its own format and is never mixed
+    system_track_active_ = separate_audio_tracks_ && have_loopback && replay_seconds_ == 0;
+    mux_cfg.system_audio_track = system_track_active_;
+    if (system_track_active_) {
+        mux_cfg.system_audio_sample_rate     = loopback_audio_->sample_rate();
+        mux_cfg.system_audio_channels        = loopback_audio_->channels();
+        mux_cfg.system_audio_bits_per_sample = loopback_audio_->bits_per_sample();
+        mux_cfg.system_audio_is_float        = (loopback_audio_->bits_per_sample() == 32);
+    }
+    const uint32_t audio_tracks_bitrate =
+        audio_track_bitrate(audio_codec_, aac_profile_, audio_bitrate_) * (system_track_active_ ? 2 : 1);
+
+    // Fail fast when the volume cannot hold the expected session length
+    if (expected_minutes_ > 0 && storage_ && replay_seconds_ == 0) {
+        const uint64_t needed = static_cast<uint64_t>(mux_cfg.video_bitrate + audio_tracks_bitrate) / 8 *
+                                60 * expected_minutes_;
+        const uint64_t free_bytes = storage_->getFreeDiskSpace();
+        if (free_bytes > 0 && free_bytes < needed) {
+            SR_LOG_ERROR(L"Output volume has %llu MB free; %u min at this bitrate needs %llu MB",
+                         free_bytes >> 20, expected_minutes_, needed >> 20);
+            diagnostics_.write_failure(L"insufficient_space_for_expected_length");
+            notify_error(L"Not enough free disk space for the expected recording length");
+            set_recording_priority(false);
+            machine_.transition(SessionEvent::Stop);
+            machine_.transition(SessionEvent::Finalized);
+            return false;
+        }
+    }
+
+    mux_cfg_ = mux_cfg;
+    replay_active_ = replay_seconds_ > 0;
+    segments_.reset(replay_active_ ? SegmentLimits{} : segment_limits_);
+    if (segments_.enabled()) {
+        SR_LOG_INFO(L"Segmented recording: new file every %u min / %u MB (0 = unlimited)",
+                    segment_limits_.max_minutes, segment_limits_.max_mb);
+    }
 
-    if (!muxer_->initialize(current_partial_path_, current_output_path_, mux_cfg)) {
+    if (replay_active_) {
+        // Replay mode: nothing is written until save_replay(). The byte cap
+        // allows 2x the nominal bitrate before whole GOPs are evicted early.
+        const uint64_t nominal = static_cast<uint64_t>(replay_seconds_) *
+            (mux_cfg.video_bitrate + mux_cfg.audio_bitrate) / 8;
+        replay_.reset(static_cast<int64_t>(replay_seconds_) * 10'000'000, nominal * 2);
+        replay_save_requested_.store(false, std::memory_order_relaxed);
+        SR_LOG_INFO(L"Replay buffer: last %u s kept in memory (cap %llu MB)",
+                    replay_seconds_, (nominal * 2) >> 20);
+    } else if (!muxer_->initialize(current_partial_path_, current_output_path_, mux_cfg)) {
         diagnostics_.write_failure(L"mux_writer_initialization_failed");
         notify_error(L"Mux writer initialization failed");
+        set_recording_priority(false);
         machine_.transition(SessionEvent::Stop);
         machine_.transition(SessionEvent::Finalized);
         return false;
     }
 
+    // Dual output: the proxy encoder/muxer follow the main ones
+    proxy_active_ = capture_->proxy_width() > 0 && start_proxy(enc_prof);
+    if (want_proxy && !proxy_active_) capture_->stop_proxy_output();
+
+    // Multi-monitor: the other displays' pipelines follow the main file
+    displays_.clear();
+    if (multi_monitor_ && !replay_active_) start_displays();
+
+    // Live stream: same encoded frames, its own sender thread
+    if (!live_cfg_.url.empty() && !replay_active_) {
+        if (mux_cfg.video_codec != VideoCodec::H264) {
+            SR_LOG_WARN(L"Live stream needs H.264; %s session records locally only",
+                        video_codec_label(mux_cfg.video_codec));
+        } else {
+            auto sink = std::make_unique<NetworkSink>();
+            if (sink->start(live_cfg_, live_format(mux_cfg.video_width, mux_cfg.video_height,
+                                                   mux_cfg.video_fps_num, mux_cfg.video_bitrate,
+                                                   mux_cfg.video_sequence_header))) {
+                network_sink_ = std::move(sink);
+            } else {
+                notify_error(L"Live stream could not start; recording locally only");
+            }
+        }
+    }
+
     SessionDiagnostics::StartInfo diagnostics_start;
     diagnostics_start.output_path = current_output_path_;
     diagnostics_start.adapter_name = probe_.adapter_name;
     diagnostics_start.probed_encoder_name =
         probe_.hw_encoder_available ? probe_.encoder_name : L"not available";
-    diagnostics_start.encoder_mode = encoder_mode_label(encoder_->mode());
+    diagnostics_start.encoder_mode = std::wstring(encoder_mode_label(encoder_->mode())) + L" " +
+                                     video_codec_label(encoder_->codec());
     diagnostics_start.power_state = last_power_ac_ ? L"AC" : L"Battery";
+    diagnostics_start.cross_adapter = probe_.cross_adapter_capture;
+    diagnostics_start.split_encode  = capture_->cross_adapter();
     diagnostics_start.high_quality = high_quality_profile;
     diagnostics_start.width = encoder_->output_width();
     diagnostics_start.height = encoder_->output_height();
@@ -228,8 +569,27 @@ bool SessionController::start() {
     audio_written_.store(0,  std::memory_order_relaxed);
     telemetry_.reset(); // T037: clear counters for new session
 
+    perf_accum_.reset();
+    if (perf_trace_enabled_) {
+        PerfTraceHeader trace_header;
+        trace_header.start_unix_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+        trace_header.fps         = encoder_->output_fps();
+        trace_header.bitrate_bps = encoder_->output_bitrate();
+        trace_header.width       = static_cast<uint16_t>(encoder_->output_width());
+        trace_header.height      = static_cast<uint16_t>(encoder_->output_height());
+        if (perf_trace_.open(PerfTraceWriter::path_for_output(current_output_path_), trace_header)) {
+            perf_prev_ = perf_counters(telemetry_snapshot());
+            SR_LOG_INFO(L"Perf trace -> %s", perf_trace_.path().c_str());
+        } else {
+            SR_LOG_WARN(L"Perf trace could not be created next to the recording");
+        }
+    }
+
     // T038: initialise frame pacer for this session's fps
+    pacer_.set_variable_rate(variable_frame_rate_);
     pacer_.initialize(enc_prof.fps);
+    governor_.reset(enc_prof.bitrate_bps, enc_prof.fps);
 
     // T039: register device-lost callback — fires when D3D device is removed
     capture_->set_device_lost_callback([this]() {
@@ -240,29 +600,38 @@ bool SessionController::start() {
         stop();
     });
 
+    // Captured window closed (or monitor detached): finalize what we have
+    capture_->set_source_closed_callback([this]() {
+        SR_LOG_WARN(L"Capture source closed — auto-stopping recording");
+        notify_error(L"The captured window or display was closed. Recording stopped.");
+        stop();
+    });
+
+    disk_monitor_.reset(disk_thresholds_);
+    closed_segment_bytes_ = 0;
+    auto_stop_requested_.store(false, std::memory_order_relaxed);
+    mux_running_.store(true, std::memory_order_release);
     encode_running_.store(true, std::memory_order_release);
-    encode_thread_ = std::thread(&SessionController::encode_loop, this);
+    mux_thread_   = std::thread(&SessionController::mux_loop, this);
+    video_thread_ = std::thread(&SessionController::video_encode_loop, this);
+    if (proxy_active_) proxy_thread_ = std::thread(&SessionController::proxy_encode_loop, this);
+    audio_thread_ = std::thread(&SessionController::audio_mix_loop, this);
 
+    // Anchor the sync clock last, so t=0 is the first frame the capture can
+    // compose and lines up with the first audio packet
+    sync_.start();
     if (!capture_->start()) {
+        diagnostics_.write_failure(L"capture_start_failed");
         notify_error(L"Capture start failed");
         stop();
         return false;
     }
+    for (auto& d : displays_) {
+        if (!d->start()) SR_LOG_WARN(L"Additional display capture failed to start; its file stays empty");
+    }
     audio_->start();
     loopback_audio_->start();
 
-    // T031: Start async disk space polling — auto-stop on < 500 MB free
-    if (storage_) {
-        storage_->startDiskSpacePolling([this]() {
-            // Runs on poll thread — use atomic transition to safely trigger stop
-            if (!machine_.is_idle()) {
-                SR_LOG_WARN(L"Auto-stopping: disk space critically low");
-                notify_error(L"\u26A0 Disk space critically low! Recording auto-stopped.");
-                stop(); // safe: atomic state transitions; stopDiskSpacePolling detaches
-            }
-        });
-    }
-
     notify_status(L"Recording...");
     SR_LOG_INFO(L"Recording started -> %s", current_output_path_.c_str());
     return true;
@@ -274,19 +643,23 @@ bool SessionController::stop() {
     if (!machine_.transition(SessionEvent::Stop)) return false;
     notify_status(L"Stopping...");
 
-    // T031: Stop disk space polling (handles re-entrant call from poll thread)
-    if (storage_) storage_->stopDiskSpacePolling();
-
     // Stop producers first
     capture_->stop();
+    for (auto& d : displays_) d->stop_capture();
     audio_->stop();
     loopback_audio_->stop();
 
-    // Stop encode loop (it drains remaining frames)
-    encode_running_.store(false, std::memory_order_release);
-    if (encode_thread_.joinable()) encode_thread_.join();
+    // Stop pipeline stages (each drains its input queue before exiting)
+    join_pipeline_threads();
+    // Without a proxy stage (setup failed) nothing drained the proxy queue
+    while (proxy_frame_queue_->try_pop()) {}
+    // The flushed tail below is not worth a reconnect wait; the stream ends here
+    if (network_sink_) {
+        network_sink_->stop();
+        network_sink_.reset();
+    }
 
-    // Flush encoder and write remaining samples
+    // Flush encoder and write remaining samples (mux stage has exited — safe to write here)
     if (was_recording) {
         std::vector<ComPtr<IMFSample>> leftover;
         encoder_->flush(leftover);
@@ -297,37 +670,108 @@ bool SessionController::stop() {
                 telemetry_.on_frame_encoded();
             }
         }
+        if (proxy_active_) {
+            leftover.clear();
+            proxy_encoder_->flush(leftover);
+            for (auto& s : leftover) {
+                if (proxy_muxer_->write_video(s.Get())) {
+                    proxy_frames_written_.fetch_add(1, std::memory_order_relaxed);
+                }
+            }
+        }
     }
 
-    // Finalize mux (rename .partial.mp4 -> .mp4)
-    const bool finalized = muxer_->finalize();
-    if (!finalized) {
-        notify_error(L"Failed to finalize recording file. Partial file kept.");
+    if (perf_trace_.is_open()) {
+        perf_trace_.close();
+        SR_LOG_INFO(L"Perf trace: %u s written", perf_trace_.written());
     }
 
-    machine_.transition(SessionEvent::Finalized);
-    notify_status(L"Idle");
-
-    // Revert process priority to normal when not recording
-    SetPriorityClass(GetCurrentProcess(), NORMAL_PRIORITY_CLASS);
-
     SessionDiagnostics::StopInfo diagnostics_stop;
-    diagnostics_stop.status = finalized ? L"complete" : L"finalize_failed_partial_kept";
     diagnostics_stop.frames_captured = capture_->frames_captured();
     diagnostics_stop.frames_encoded = frames_encoded_.load();
     diagnostics_stop.frames_dropped = capture_->frames_dropped();
     diagnostics_stop.audio_packets = audio_written_.load();
-    diagnostics_.write_stop(diagnostics_stop);
 
-    SR_LOG_INFO(L"Recording stopped. Encoded: %u frames, audio pkts: %u",
-                frames_encoded_.load(), audio_written_.load());
+    // Finalize mux (moov + rename .partial.mp4 -> .mp4) on the finalizer
+    // queue; fresh writers let the next start() run while these close
+    const bool wrote_file = muxer_->initialized();
+    finalizer_.enqueue(std::exchange(muxer_, std::make_unique<MuxWriter>()),
+        [this, wrote_file, diagnostics = diagnostics_, stop_info = diagnostics_stop,
+         path = current_output_path_](bool ok) mutable {
+            stop_info.status = ok ? L"complete" : L"finalize_failed_partial_kept";
+            diagnostics.write_stop(stop_info);
+            if (!ok) notify_error(L"Failed to finalize recording file. Partial file kept.");
+            if (wrote_file) notify_finalized(path, ok);
+            if (on_summary_) on_summary_(diagnostics.summary());
+        });
+    if (proxy_active_) {
+        // The main file decides the session status; a failed proxy keeps its .partial
+        finalizer_.enqueue(std::exchange(proxy_muxer_, std::make_unique<MuxWriter>()), [](bool ok) {
+            if (!ok) SR_LOG_WARN(L"Proxy file could not be finalized; partial file kept");
+        });
+        SR_LOG_INFO(L"Proxy output: %u frames written, %u dropped at capture",
+                    proxy_frames_written_.load(), capture_->frames_proxy_dropped());
+        proxy_active_ = false;
+    }
+    for (size_t i = 0; i < displays_.size(); ++i) {
+        DisplayPipeline& display = *displays_[i];
+        if (was_recording) display.finish();
+        SR_LOG_INFO(L"Display %zu: %ux%u @ %u fps (%s), %u frames written, %u dropped, quality level %u",
+                    i + 2, display.width(), display.height(), display.fps(), encoder_mode_label(display.mode()),
+                    display.frames_written(), display.frames_dropped(), display.quality_level());
+        finalizer_.enqueue(display.take_muxer(), [index = i + 2](bool ok) {
+            if (!ok) SR_LOG_WARN(L"Display %zu file could not be finalized; partial file kept", index);
+        });
+    }
+    displays_.clear();
+
+    machine_.transition(SessionEvent::Finalized);
+    notify_status(L"Idle");
+
+    set_recording_priority(false);
+
+    SR_LOG_INFO(L"Recording stopped. Encoded: %u frames, audio pkts: %u, unchanged skipped: %u/%u, "
+                L"NV12 ring full: %u, overlay-only: %u, rate-limited: %u",
+                frames_encoded_.load(), audio_written_.load(),
+                pacer_.skips(), capture_->frames_unchanged(), capture_->frames_ring_full(),
+                capture_->frames_overlay_only(), capture_->frames_throttled());
+    if (gop_schedule_.enabled()) {
+        SR_LOG_INFO(L"Adaptive GOP: %u IDRs requested, %u on scene cuts",
+                    gop_schedule_.keyframes(), gop_schedule_.scene_cuts());
+    }
+    if (replay_active_) {
+        SR_LOG_INFO(L"Replay buffer closed: %u replays saved", replays_saved_.load());
+        replay_.clear();
+    }
+    if (segments_.segment_index() > 1) {
+        SR_LOG_INFO(L"Recording split into %u segment files", segments_.segment_index());
+    }
+    log_latency_summary();
+    if (adaptive_quality_ && governor_.downgrades() > 0) {
+        SR_LOG_INFO(L"[Quality] %u step-downs, %u step-ups, ended at level %u",
+                    governor_.downgrades(), governor_.upgrades(), governor_.level());
+    }
+    if (encoder_->roi_enabled()) {
+        SR_LOG_INFO(L"ROI hints attached to %u frames", encoder_->roi_frames());
+    }
+    if (auto_arm_.load(std::memory_order_relaxed)) arm_async();
     return true;
 }
 
+// Pause suspends the producers instead of discarding their output: capture
+// stops converting (the newest WGC surface is parked) and both WASAPI
+// streams stop. The stages still drop anything queued before that took
+// effect. Video PTS on resume carry the pause gap (session clock), audio
+// PTS too (the engines skip the suspended time).
 bool SessionController::pause() {
     if (!machine_.transition(SessionEvent::Pause)) return false;
+    capture_->set_suspended(true);
+    for (auto& d : displays_) d->set_suspended(true);
+    if (have_mic_) audio_->set_suspended(true);
+    if (have_loopback_) loopback_audio_->set_suspended(true);
     sync_.pause();
     pacer_.reset(); // T038: avoid treating the pause gap as a frame skip on resume
+    proxy_pacer_.reset();
     notify_status(L"Paused");
     return true;
 }
@@ -336,9 +780,16 @@ bool SessionController::resume() {
     if (!machine_.transition(SessionEvent::Resume)) return false;
     sync_.resume();
     pacer_.reset(); // T038: fresh pacing baseline after resume
+    proxy_pacer_.reset();
     // Force an IDR keyframe on the next encoded frame so the resumed segment
     // is independently decodable and seeks work correctly after pause gaps.
     encoder_->request_keyframe();
+    if (proxy_active_) proxy_encoder_->request_keyframe();
+    if (have_mic_) audio_->set_suspended(false);
+    if (have_loopback_) loopback_audio_->set_suspended(false);
+    // Last: the parked frame is converted and queued here, behind the IDR request
+    capture_->set_suspended(false);
+    for (auto& d : displays_) d->set_suspended(false);
     notify_status(L"Recording...");
     return true;
 }
@@ -368,349 +819,969 @@ TelemetrySnapshot SessionController::telemetry_snapshot() const {
     }
     // Update backlog counter from the live queue depth
     uint32_t backlog = frame_queue_ ? static_cast<uint32_t>(frame_queue_->size()) : 0;
-    const_cast<TelemetryStore&>(telemetry_).set_backlog(backlog);
+    auto& store = const_cast<TelemetryStore&>(telemetry_);
+    store.set_backlog(backlog);
+    store.set_mux_backlog(
+        encoded_video_queue_ ? static_cast<uint32_t>(encoded_video_queue_->size()) : 0,
+        encoded_audio_queue_ ? static_cast<uint32_t>(encoded_audio_queue_->size()) : 0);
     auto snapshot = telemetry_.snapshot(enc_mode, last_power_ac_);
+    if (encoder_) snapshot.video_codec = video_codec_label(encoder_->codec());
     if (capture_) {
         snapshot.frames_captured = capture_->frames_captured();
         snapshot.frames_dropped += capture_->frames_dropped();
     }
+    if (audio_)          snapshot.audio_dropped += audio_->packets_dropped();
+    if (loopback_audio_) snapshot.audio_dropped += loopback_audio_->packets_dropped();
     return snapshot;
 }
 
 // ---------------------------------------------------------------------------
-// Encode loop — runs on encode_thread_
-// Drains both frame_queue_ and audio_queue_, feeds encoder + muxer
+// Pipeline plumbing
+// ---------------------------------------------------------------------------
+template <typename Queue>
+bool SessionController::push_to_mux(Queue& queue, EncodedSample&& sample) {
+    bool stalled = false;
+    while (!queue.try_push(std::move(sample))) {
+        // Never drop encoded output: losing a compressed video sample breaks
+        // the GOP, so apply backpressure to this stage instead.
+        if (!mux_running_.load(std::memory_order_acquire)) return false;
+        if (!stalled) {
+            telemetry_.on_mux_stall();
+            stalled = true;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return true;
+}
+
+void SessionController::join_pipeline_threads() {
+    encode_running_.store(false, std::memory_order_release);
+    if (video_thread_.joinable()) video_thread_.join();
+    if (proxy_thread_.joinable()) proxy_thread_.join();
+    if (audio_thread_.joinable()) audio_thread_.join();
+    for (auto& d : displays_) d->join_encoder();
+
+    // Encode stages are done; let the mux stage drain what they produced.
+    mux_running_.store(false, std::memory_order_release);
+    if (mux_thread_.joinable()) mux_thread_.join();
+    if (replay_saver_.joinable()) replay_saver_.join();
+}
+
+// ---------------------------------------------------------------------------
+// Video-encode stage — runs on video_thread_
+// Drains frame_queue_, paces, encodes and hands samples to the mux stage.
 // T038: FramePacer normalises jittery WGC timestamps
 // ---------------------------------------------------------------------------
-void SessionController::encode_loop() {
-    // Register this thread with MMCSS for higher priority
-    // (same priority class as capture)
+void SessionController::video_encode_loop() {
     SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_ABOVE_NORMAL);
+    MmcssScope mmcss(pipeline_boost_ ? L"Capture" : nullptr);
+    if (pipeline_boost_) set_thread_eco_qos_opt_out(true);
 
     // T038: keep a copy of the last encoded frame's texture for duplicate insertion.
     // RenderFrame is move-only; store the texture ComPtr separately (AddRef on copy).
     ComPtr<ID3D11Texture2D> last_texture;
+    const QPCClock& clock = QPCClock::instance();
     bool        have_last_frame  = false;
     int64_t     last_paced_pts   = 0;
-    ULONGLONG   last_mem_sample_ms = 0;
+    uint32_t    last_capture_drops = capture_->frames_dropped();
     ULONGLONG   last_power_check_ms = 0;
     constexpr ULONGLONG kPowerCheckIntervalMs = 10'000;
-    constexpr int64_t kAudioMixTolerance100ns = 20'000; // 2 ms
-
-    struct ReusableAudioSample {
-        ComPtr<IMFSample> sample;
-        ComPtr<IMFMediaBuffer> buffer;
-        DWORD capacity = 0;
-    };
-    std::array<ReusableAudioSample, 8> audio_sample_pool{};
-    size_t audio_pool_cursor = 0;
-
-    auto has_external_refs = [](IUnknown* obj) -> bool {
-        if (!obj) return false;
-        const ULONG refs = obj->AddRef();
-        obj->Release();
-        // refs includes this temporary AddRef and the pool's ComPtr reference.
-        return refs > 2;
-    };
-
-    auto acquire_audio_sample = [&](DWORD required_bytes,
-                                    ComPtr<IMFSample>& out_sample,
-                                    ComPtr<IMFMediaBuffer>& out_buffer) -> bool {
-        const size_t pool_size = audio_sample_pool.size();
-        for (size_t attempt = 0; attempt < pool_size; ++attempt) {
-            const size_t idx = (audio_pool_cursor + attempt) % pool_size;
-            auto& slot = audio_sample_pool[idx];
-            const bool reusable = !slot.sample ||
-                (!has_external_refs(slot.sample.Get()) && !has_external_refs(slot.buffer.Get()));
-            if (!reusable) continue;
-
-            HRESULT hr = S_OK;
-            if (!slot.sample) {
-                hr = MFCreateSample(&slot.sample);
-                if (FAILED(hr)) {
-                    SR_LOG_ERROR(L"MFCreateSample (pooled audio) failed: 0x%08X", hr);
-                    return false;
-                }
-            }
-            if (!slot.buffer || slot.capacity < required_bytes) {
-                slot.buffer.Reset();
-                hr = MFCreateMemoryBuffer(required_bytes, &slot.buffer);
-                if (FAILED(hr)) {
-                    SR_LOG_ERROR(L"MFCreateMemoryBuffer (pooled audio, %u bytes) failed: 0x%08X",
-                                 required_bytes, hr);
-                    return false;
-                }
-                slot.capacity = required_bytes;
-            }
-
-            slot.sample->RemoveAllBuffers();
-            hr = slot.sample->AddBuffer(slot.buffer.Get());
-            if (FAILED(hr)) {
-                SR_LOG_ERROR(L"Audio sample AddBuffer failed: 0x%08X", hr);
-                return false;
-            }
+    std::shared_ptr<GpuReleaseFence> gpu_release;   // isolated capture: acknowledge reads
 
-            out_sample = slot.sample;
-            out_buffer = slot.buffer;
-            audio_pool_cursor = (idx + 1) % pool_size;
-            return true;
-        }
-
-        // Fallback: transient allocation when all pooled samples are in flight.
-        HRESULT hr = MFCreateSample(&out_sample);
-        if (FAILED(hr)) {
-            SR_LOG_ERROR(L"MFCreateSample (transient audio) failed: 0x%08X", hr);
-            return false;
-        }
-        hr = MFCreateMemoryBuffer(required_bytes, &out_buffer);
-        if (FAILED(hr)) {
-            SR_LOG_ERROR(L"MFCreateMemoryBuffer (transient audio, %u bytes) failed: 0x%08X",
-                         required_bytes, hr);
-            return false;
-        }
-        hr = out_sample->AddBuffer(out_buffer.Get());
-        if (FAILED(hr)) {
-            SR_LOG_ERROR(L"Audio transient AddBuffer failed: 0x%08X", hr);
-            return false;
-        }
-        return true;
-    };
-
-    ComPtr<IDXGIAdapter3> perf_adapter3;
-    if (probe_.d3d_device) {
-        ComPtr<IDXGIDevice> dxgi_device;
-        if (SUCCEEDED(probe_.d3d_device.As(&dxgi_device)) && dxgi_device) {
-            ComPtr<IDXGIAdapter> adapter;
-            if (SUCCEEDED(dxgi_device->GetAdapter(&adapter)) && adapter) {
-                adapter.As(&perf_adapter3);
-            }
-        }
-    }
-
-    // Interleave video and audio: write video first, then any pending audio
     while (encode_running_.load(std::memory_order_acquire) ||
            !frame_queue_->empty())
     {
+        release_gpu_reads(gpu_release, gpu_wait_context_.Get());
         uint32_t target_fps = encoder_ ? encoder_->output_fps() : 24;
         auto wait_interval = std::chrono::milliseconds(
             500 / (std::max)(1u, target_fps));
 
-        // --- Video ---
         if (auto opt_frame = frame_queue_->wait_pop(wait_interval)) {
             auto& frame = *opt_frame;
+            frame.stamps.dequeued_us = clock.now_us();
+            if (frame.release) gpu_release = frame.release;
 
             // Skip frames while paused
             if (machine_.is_paused()) {
                 continue;
             }
+            // Power-profile resolution switch has reached the encode stage
+            if (frame.width != feed_width_ || frame.height != feed_height_) {
+                last_texture.Reset();  // old size: not a valid duplicate source
+                have_last_frame = false;
+                if (!reopen_encoder(frame.width, frame.height)) continue;  // stopping
+            }
+            if (frame.stamps.converted_us > 0) {
+                telemetry_.record_latency(LatencyStage::Convert,
+                                          frame.stamps.converted_us - frame.stamps.arrival_us);
+                telemetry_.record_latency(LatencyStage::Queue,
+                                          frame.stamps.dequeued_us - frame.stamps.converted_us);
+            }
 
             // T038: pace the incoming PTS and decide what to do
             // We already popped one frame, so this queue cannot be full here.
             bool   queue_full = false;
             int64_t paced_pts = frame.pts;
-            PaceAction action = pacer_.pace_frame(frame.pts, queue_full, &paced_pts);
+            PaceAction action = pacer_.pace_frame(frame.pts, queue_full, &paced_pts,
+                                                  frame.is_duplicate);
 
             if (action == PaceAction::Drop) {
                 // Backpressure drop — discard this frame
+                trace::frame_dropped(frame.pts, frame_queue_->size(), "pacer_backpressure");
                 telemetry_.on_frame_dropped();
+                governor_.on_drop();
+                continue;
+            }
+            if (action == PaceAction::Skip) {
+                // Unchanged screen — the previous sample already shows this picture
+                telemetry_.on_unchanged_skipped();
+                continue;
+            }
+            // Reduced fps under overload: decimate before any encoder work
+            if (adaptive_quality_ && !governor_.admit(paced_pts)) {
                 continue;
             }
 
-            // T038: duplicate — encode the last frame again with a synthetic PTS
-            if (action == PaceAction::Duplicate && have_last_frame && last_texture) {
+            // T038: duplicate — encode the last frame again with a synthetic PTS.
+            // Not while the governor has stepped down: duplicates only add load.
+            if (action == PaceAction::Duplicate && have_last_frame && last_texture &&
+                governor_.level() == 0) {
                 // Duplicate PTS = midpoint between last and current frame.
                 int64_t dup_pts = last_paced_pts + (paced_pts - last_paced_pts) / 2;
-                ComPtr<IMFSample> dup_sample;
-                if (encoder_->encode_frame(last_texture.Get(), dup_pts, dup_sample)) {
-                    muxer_->write_video(dup_sample.Get());
-                    frames_encoded_.fetch_add(1, std::memory_order_relaxed);
-                    telemetry_.on_frame_encoded();
+                EncodedSample dup;
+                if (encoder_->encode_frame(last_texture.Get(), dup_pts, dup.sample) &&
+                    push_video(std::move(dup))) {
                     telemetry_.on_duplicate_inserted();
                 }
             }
 
             // Cache this texture (ComPtr copy AddRefs it) before encoding
+            wait_for_gpu_producer(frame, gpu_wait_context_.Get());
             last_texture = frame.texture;
 
+            // fMP4: start a new fragment on schedule (VFR: keep the GOP in time).
+            // Adaptive GOP: key on the content, bounded for seeking.
+            if (timed_keyframes_.due(paced_pts) || gop_schedule_.due(paced_pts, gop_change(frame))) {
+                encoder_->request_keyframe();
+            }
+
             // Encode current frame
-            ComPtr<IMFSample> encoded;
-            if (encoder_->encode_frame(frame.texture.Get(), paced_pts, encoded)) {
-                muxer_->write_video(encoded.Get());
-                frames_encoded_.fetch_add(1, std::memory_order_relaxed);
-                telemetry_.on_frame_encoded();
+            EncodedSample encoded;
+            trace::encode_start(paced_pts, frame_queue_->size());
+            const bool produced =
+                encoder_->encode_frame(frame.texture.Get(), paced_pts, encoded.sample, &frame.dirty);
+            trace::encode_stop(paced_pts, encoded_video_queue_->size(), produced);
+            if (produced) {
+                encoded.arrival_us = frame.stamps.arrival_us;
+                encoded.encoded_us = clock.now_us();
+                telemetry_.record_latency(LatencyStage::Encode,
+                                          encoded.encoded_us - frame.stamps.dequeued_us);
+                governor_.on_frame(encoded.encoded_us - frame.stamps.dequeued_us,
+                                   frame_queue_->size());
+                perf_accum_.on_encode(encoded.encoded_us - frame.stamps.dequeued_us,
+                                      frame_queue_->size());
+                push_video(std::move(encoded));
             }
 
             have_last_frame = true;
             last_paced_pts  = paced_pts;
         }
 
-        // --- Audio: drain mic + loopback, mix and write ---
-        // We mix mic and loopback packets into a single output stream.
-        // Both engines produce float32/int16 PCM at the same rate (48 kHz).
-        // Strategy: drain both queues; for each mic packet, mix in any
-        // overlapping loopback data. Also write pure-loopback packets.
-        {
-            // Collect all available loopback packets first
-            std::vector<AudioPacket> loopback_pkts;
-            while (auto opt_lb = loopback_queue_->try_pop()) {
-                if (!machine_.is_paused()) {
-                    loopback_pkts.push_back(std::move(*opt_lb));
-                }
+        // Async HW encoder: output for earlier frames completes on the pump
+        // thread and is collected here, also while the screen is static.
+        for (EncodedSample ready; encoder_->take_output(ready.sample); ready = EncodedSample{}) {
+            push_video(std::move(ready));
+        }
+
+        // Capture-side losses (NV12 ring / FrameQueue full) since the last pass
+        const uint32_t capture_drops = capture_->frames_dropped();
+        if (adaptive_quality_ && !machine_.is_paused()) {
+            governor_.on_drop(capture_drops - last_capture_drops);
+            if (governor_.evaluate(clock.now_us())) {
+                SR_LOG_INFO(L"[Quality] level %u: %u bps, %u fps",
+                            governor_.level(), governor_.bitrate_bps(), governor_.fps());
+                encoder_->set_bitrate(governor_.bitrate_bps());
+                telemetry_.set_quality_level(governor_.level());
             }
+        }
+        last_capture_drops = capture_drops;
 
-            // Drain mic packets
-            bool had_mic = false;
-            while (auto opt_audio = audio_queue_->try_pop()) {
-                auto& audio_pkt = *opt_audio;
-                if (machine_.is_paused()) continue;
-                had_mic = true;
-
-                // Mix loopback data into mic packet (additive mix with clamp)
-                if (!loopback_pkts.empty()) {
-                    if (auto match = find_loopback_mix_candidate(
-                            audio_pkt, loopback_pkts, kAudioMixTolerance100ns)) {
-                        auto it = loopback_pkts.begin() + static_cast<std::ptrdiff_t>(*match);
-                            // Mix: interpret as float32 or int16 based on bits_per_sample
-                            const uint32_t bps = audio_->bits_per_sample();
-                            if (bps == 32) {
-                                // IEEE float mix
-                                float* dst = reinterpret_cast<float*>(audio_pkt.buffer.data());
-                                const float* src = reinterpret_cast<const float*>(it->buffer.data());
-                                const size_t count = audio_pkt.buffer.size() / sizeof(float);
-                                for (size_t s = 0; s < count; ++s) {
-                                    float mixed = dst[s] + src[s];
-                                    if (mixed > 1.0f) mixed = 1.0f;
-                                    if (mixed < -1.0f) mixed = -1.0f;
-                                    dst[s] = mixed;
-                                }
-                            } else {
-                                // 16-bit PCM mix
-                                int16_t* dst = reinterpret_cast<int16_t*>(audio_pkt.buffer.data());
-                                const int16_t* src = reinterpret_cast<const int16_t*>(it->buffer.data());
-                                const size_t count = audio_pkt.buffer.size() / sizeof(int16_t);
-                                for (size_t s = 0; s < count; ++s) {
-                                    int32_t mixed = static_cast<int32_t>(dst[s]) + static_cast<int32_t>(src[s]);
-                                    if (mixed > 32767) mixed = 32767;
-                                    if (mixed < -32768) mixed = -32768;
-                                    dst[s] = static_cast<int16_t>(mixed);
-                                }
-                            }
-                            audio_pkt.is_silence = false;
-                            loopback_pkts.erase(it);
-                    }
-                }
+        // Dynamic power monitoring — check every 10 seconds.
+        // Lives on this stage because it re-initialises pacer_ and reconfigures
+        // encoder_, which only this thread drives.
+        const ULONGLONG now_ms = GetTickCount64();
+        if (now_ms - last_power_check_ms >= kPowerCheckIntervalMs) {
+            bool on_ac = PowerModeDetector::is_on_ac_power();
+            if (on_ac != last_power_ac_) {
+                last_power_ac_ = on_ac;
+                SR_LOG_INFO(L"[Power] Switched to %s power", on_ac ? L"AC" : L"Battery");
+                apply_power_profile(on_ac);
+            }
+            last_power_check_ms = now_ms;
+        }
+    }
+}
 
-                // Write the (possibly mixed) mic packet
-                ComPtr<IMFSample> sample;
-                ComPtr<IMFMediaBuffer> buf;
-                const DWORD packet_bytes = static_cast<DWORD>(audio_pkt.buffer.size());
-                if (!acquire_audio_sample(packet_bytes, sample, buf)) {
-                    continue;
-                }
+bool SessionController::push_video(EncodedSample&& sample) {
+    if (pending_video_format_) sample.format = std::move(pending_video_format_);
+    // Every IDR (resume, segment rotation, the encoder's GOP bound) restarts
+    // the adaptive interval
+    if (gop_schedule_.enabled() && is_clean_point(sample.sample.Get())) {
+        LONGLONG pts = 0;
+        if (SUCCEEDED(sample.sample->GetSampleTime(&pts))) gop_schedule_.on_keyframe(pts);
+    }
+    return push_to_mux(*encoded_video_queue_, std::move(sample));
+}
 
-                HRESULT hr = S_OK;
-                BYTE* data = nullptr;
-                hr = buf->Lock(&data, nullptr, nullptr);
-                if (FAILED(hr) || !data) {
-                    SR_LOG_ERROR(L"Audio buffer lock failed: 0x%08X", hr);
-                    continue;
-                }
-                std::memcpy(data, audio_pkt.buffer.data(), audio_pkt.buffer.size());
-                buf->Unlock();
-                buf->SetCurrentLength(packet_bytes);
+// ---------------------------------------------------------------------------
+// Power-state switch — video-encode stage. Bitrate, frame rate and the
+// encoder speed/power knobs change in place (ICodecAPI, FramePacer,
+// QualityGovernor nominal). A different output size is requested from
+// capture; the first frame at that size goes through reopen_encoder().
+// Replay sessions keep their size: one ring, one format.
+// ---------------------------------------------------------------------------
+void SessionController::apply_power_profile(bool on_ac) {
+    const EncoderProfile target = PowerModeDetector::clamp_for_quality_and_power_state(
+        requested_profile_, on_ac, session_high_quality_);
 
-                sample->SetSampleTime(audio_pkt.pts);
-                int64_t dur = static_cast<int64_t>(audio_pkt.frame_count) *
-                              10'000'000LL / static_cast<int64_t>(audio_pkt.sample_rate);
-                sample->SetSampleDuration(dur);
+    if (active_profile_.gop_frames > 0) {
+        active_profile_.gop_frames = (std::max)(1u, active_profile_.gop_frames * target.fps /
+                                                    (std::max)(1u, active_profile_.fps));
+    }
+    active_profile_.fps         = target.fps;
+    active_profile_.bitrate_bps = target.bitrate_bps;
+
+    encoder_->set_frame_rate(target.fps);
+    encoder_->set_bitrate(target.bitrate_bps);
+    encoder_->set_power_tuning(on_ac, session_high_quality_);
+    pacer_.initialize(target.fps);
+    governor_.reset(target.bitrate_bps, target.fps);
+    capture_->set_frame_rate_limit(target.fps);
+    telemetry_.set_quality_level(0);
+    for (auto& d : displays_) d->set_power_state(on_ac);
+
+    // Capture clamps to the source rect; an unchanged size is a no-op there
+    if (!replay_active_) {
+        capture_->request_output_resolution({ target.width, target.height });
+    }
+}
 
-                muxer_->write_audio(sample.Get());
-                audio_written_.fetch_add(1, std::memory_order_relaxed);
-                telemetry_.on_audio_written();
+// ---------------------------------------------------------------------------
+// Resolution switch — video-encode stage. The old encoder's tail goes to the
+// current segment; the re-created encoder's first sample (an IDR) carries its
+// track format and the mux stage opens a new segment on it.
+// ---------------------------------------------------------------------------
+bool SessionController::reopen_encoder(uint32_t width, uint32_t height) {
+    std::vector<ComPtr<IMFSample>> tail;
+    encoder_->flush(tail);
+    for (auto& s : tail) {
+        EncodedSample drained;
+        drained.sample = std::move(s);
+        push_video(std::move(drained));
+    }
+    encoder_->shutdown();
+
+    // Don't retry on every frame if the new size can't be encoded
+    feed_width_  = width;
+    feed_height_ = height;
+
+    EncoderProfile prof = active_profile_;
+    prof.width  = width;
+    prof.height = height;
+    if (!encoder_->initialize(prof,
+                              probe_.dxgi_device_manager.Get(),
+                              probe_.d3d_device.Get(),
+                              probe_.d3d_context.Get()))
+    {
+        SR_LOG_ERROR(L"Video encoder could not be re-created at %ux%u", width, height);
+        if (request_auto_stop()) {
+            notify_error(L"Video encoder could not be re-created after a power change. "
+                         L"Recording stopped.");
+        }
+        return false;
+    }
+    active_profile_ = prof;
+
+    auto format = std::make_shared<VideoTrackFormat>();
+    format->width       = encoder_->output_width();
+    format->height      = encoder_->output_height();
+    format->fps         = encoder_->output_fps();
+    format->bitrate_bps = encoder_->output_bitrate();
+    format->codec       = encoder_->codec();
+    encoder_->sequence_header(format->sequence_header);
+    pending_video_format_ = std::move(format);
+
+    SR_LOG_INFO(L"Video encoder re-created at %ux%u @ %u fps, %u bps — new segment follows",
+                encoder_->output_width(), encoder_->output_height(),
+                encoder_->output_fps(), encoder_->output_bitrate());
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// Proxy-encode stage — runs on proxy_thread_ (dual-output sessions only)
+// Same shape as video_encode_loop for the low-res copy of each frame. No
+// duplicate insertion or latency telemetry: the proxy is a review file, and
+// its pacer only drops unchanged frames.
+// ---------------------------------------------------------------------------
+void SessionController::proxy_encode_loop() {
+    const uint32_t fps = (std::max)(1u, proxy_encoder_->output_fps());
+    const auto wait_interval = std::chrono::milliseconds(500 / fps);
+    std::shared_ptr<GpuReleaseFence> gpu_release;
+
+    while (encode_running_.load(std::memory_order_acquire) ||
+           !proxy_frame_queue_->empty())
+    {
+        release_gpu_reads(gpu_release, gpu_wait_context_.Get());
+        if (auto opt_frame = proxy_frame_queue_->wait_pop(wait_interval)) {
+            auto& frame = *opt_frame;
+            if (frame.release) gpu_release = frame.release;
+            if (machine_.is_paused()) continue;
+
+            int64_t paced_pts = frame.pts;
+            const PaceAction action = proxy_pacer_.pace_frame(frame.pts, false, &paced_pts,
+                                                              frame.is_duplicate);
+            if (action == PaceAction::Drop || action == PaceAction::Skip) continue;
+
+            EncodedSample encoded;
+            wait_for_gpu_producer(frame, gpu_wait_context_.Get());
+            if (proxy_encoder_->encode_frame(frame.texture.Get(), paced_pts, encoded.sample, &frame.dirty)) {
+                push_to_mux(*encoded_proxy_queue_, std::move(encoded));
             }
+        }
 
-            // Any remaining loopback packets (no mic data to mix with)
-            // Write them directly as system-only audio
-            for (auto& lb_pkt : loopback_pkts) {
-                if (lb_pkt.is_silence) continue;
+        for (EncodedSample ready; proxy_encoder_->take_output(ready.sample); ready = EncodedSample{}) {
+            push_to_mux(*encoded_proxy_queue_, std::move(ready));
+        }
+    }
+}
 
-                ComPtr<IMFSample> sample;
-                ComPtr<IMFMediaBuffer> buf;
-                const DWORD packet_bytes = static_cast<DWORD>(lb_pkt.buffer.size());
-                if (!acquire_audio_sample(packet_bytes, sample, buf)) {
-                    continue;
-                }
+// ---------------------------------------------------------------------------
+// Audio-mix stage — runs on audio_thread_
+// Drains mic + loopback queues on a fixed cadence into an AudioTimelineMixer
+// and packs each emitted 20 ms block into an IMFSample for the mux stage.
+// ---------------------------------------------------------------------------
+void SessionController::audio_mix_loop() {
+    SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_ABOVE_NORMAL);
+    MmcssScope mmcss(pipeline_boost_ ? L"Audio" : nullptr);
+    if (pipeline_boost_) set_thread_eco_qos_opt_out(true);
+
+    // Mix cadence matches the output block size; short enough that the
+    // 16-slot AudioQueues (~10 ms packets) never fill.
+    constexpr uint32_t kMixBlockMs = 20;
+    constexpr auto kMixInterval = std::chrono::milliseconds(kMixBlockMs);
+
+    // Recycled mux-bound samples; sized to cover the mux queue plus what the
+    // sink writer holds, so steady state never falls back to transient allocs
+    ComPtr<SamplePool> audio_samples;
+    audio_samples.Attach(SamplePool::create(L"Audio", EncodedAudioQueue::capacity() + 8));
+
+    // Silent blocks (muted or gated mic, idle loopback) all share one zeroed
+    // buffer per block size instead of each copying zeros; the sink writer
+    // and encoders only read it. Usually one size, plus a short flush tail.
+    std::vector<std::pair<DWORD, ComPtr<IMFMediaBuffer>>> silence_buffers;
+    uint32_t silent_blocks = 0;
+    auto silence_buffer = [&](DWORD bytes) -> IMFMediaBuffer* {
+        for (const auto& [size, buffer] : silence_buffers) {
+            if (size == bytes) return buffer.Get();
+        }
+        ComPtr<IMFMediaBuffer> buffer;
+        BYTE* data = nullptr;
+        if (FAILED(MFCreateMemoryBuffer(bytes, &buffer)) || FAILED(buffer->Lock(&data, nullptr, nullptr))) {
+            return nullptr;
+        }
+        std::memset(data, 0, bytes);
+        buffer->Unlock();
+        buffer->SetCurrentLength(bytes);
+        silence_buffers.emplace_back(bytes, buffer);
+        return buffer.Get();
+    };
+
+    // Copy one mixed PCM block into a pooled IMFSample and queue it for the mux stage
+    auto pack_and_queue = [&](const AudioTimelineMixer::Block& block, AudioTrack track) {
+        ComPtr<IMFSample> sample;
+        const DWORD block_bytes = static_cast<DWORD>(block.bytes);
+        IMFMediaBuffer* silence = block.silent ? silence_buffer(block_bytes) : nullptr;
+        if (silence) {
+            if (!audio_samples->acquire_shared(silence, sample)) return;
+            ++silent_blocks;
+        } else {
+            ComPtr<IMFMediaBuffer> buf;
+            if (!audio_samples->acquire(block_bytes, sample, buf)) {
+                return;
+            }
 
-                HRESULT hr = S_OK;
-                BYTE* data = nullptr;
-                hr = buf->Lock(&data, nullptr, nullptr);
-                if (FAILED(hr) || !data) continue;
-                std::memcpy(data, lb_pkt.buffer.data(), lb_pkt.buffer.size());
-                buf->Unlock();
-                buf->SetCurrentLength(packet_bytes);
+            BYTE* data = nullptr;
+            HRESULT hr = buf->Lock(&data, nullptr, nullptr);
+            if (FAILED(hr) || !data) {
+                SR_LOG_ERROR(L"Audio buffer lock failed: 0x%08X", hr);
+                return;
+            }
+            std::memcpy(data, block.data, block.bytes);
+            buf->Unlock();
+            buf->SetCurrentLength(block_bytes);
+        }
 
-                sample->SetSampleTime(lb_pkt.pts);
-                int64_t dur = static_cast<int64_t>(lb_pkt.frame_count) *
-                              10'000'000LL / static_cast<int64_t>(lb_pkt.sample_rate);
-                sample->SetSampleDuration(dur);
+        sample->SetSampleTime(block.pts);
+        sample->SetSampleDuration(block.duration);
 
-                muxer_->write_audio(sample.Get());
-                audio_written_.fetch_add(1, std::memory_order_relaxed);
-                telemetry_.on_audio_written();
+        EncodedSample packed;
+        packed.sample = std::move(sample);
+        packed.track  = track;
+        push_to_mux(*encoded_audio_queue_, std::move(packed));
+    };
+    auto queue_main   = [&](const AudioTimelineMixer::Block& b) { pack_and_queue(b, AudioTrack::Main); };
+    auto queue_system = [&](const AudioTimelineMixer::Block& b) { pack_and_queue(b, AudioTrack::System); };
+
+    // Mic and loopback are accumulated on one sample-indexed timeline in the
+    // mux's audio format (the mic's). Loopback in a different sample format
+    // can't be summed sample-for-sample and is left out of the mix.
+    enum : size_t { kMicSource = 0, kLoopbackSource = 1 };
+    AudioTimelineMixer::Format mix_format;
+    mix_format.sample_rate     = audio_->sample_rate();
+    mix_format.channels        = audio_->channels();
+    mix_format.bits_per_sample = audio_->bits_per_sample();
+    AudioTimelineMixer timeline;
+    if (!timeline.configure(mix_format, kMixBlockMs)) {
+        SR_LOG_ERROR(L"Audio timeline configure failed (%u Hz, %u ch, %u bit)",
+                     mix_format.sample_rate, mix_format.channels, mix_format.bits_per_sample);
+    }
+    // Separate tracks: system audio runs through its own single-source timeline
+    // in its own format, following the mic timeline's clock; nothing is summed.
+    const bool separate = system_track_active_;
+    AudioTimelineMixer system_timeline;
+    if (separate) {
+        AudioTimelineMixer::Format system_format;
+        system_format.sample_rate     = loopback_audio_->sample_rate();
+        system_format.channels        = loopback_audio_->channels();
+        system_format.bits_per_sample = loopback_audio_->bits_per_sample();
+        if (!system_timeline.configure(system_format, kMixBlockMs)) {
+            SR_LOG_ERROR(L"System audio timeline configure failed (%u Hz, %u ch, %u bit)",
+                         system_format.sample_rate, system_format.channels,
+                         system_format.bits_per_sample);
+        }
+    }
+    const bool mix_loopback = !separate &&
+                              loopback_audio_->bits_per_sample() == mix_format.bits_per_sample;
+    if (!separate && !mix_loopback) {
+        SR_LOG_WARN(L"Loopback format (%u bit) differs from mic (%u bit) — system audio not mixed",
+                    loopback_audio_->bits_per_sample(), mix_format.bits_per_sample);
+    }
+
+    auto next_tick = std::chrono::steady_clock::now();
+
+    while (encode_running_.load(std::memory_order_acquire) ||
+           !audio_queue_->empty() || !loopback_queue_->empty())
+    {
+        next_tick += kMixInterval;
+        if (encode_running_.load(std::memory_order_acquire)) {
+            std::this_thread::sleep_until(next_tick);
+        }
+
+        const bool paused = machine_.is_paused();
+        while (auto opt_lb = loopback_queue_->try_pop()) {
+            if (paused) continue;
+            if (separate)          system_timeline.add(0, *opt_lb);
+            else if (mix_loopback) timeline.add(kLoopbackSource, *opt_lb);
+        }
+        while (auto opt_audio = audio_queue_->try_pop()) {
+            if (paused) continue;
+            timeline.add(kMicSource, *opt_audio);
+            if (separate && opt_audio->sample_rate > 0) {
+                system_timeline.advance_clock(opt_audio->pts);
+                system_timeline.advance_clock(opt_audio->pts +
+                    static_cast<int64_t>(opt_audio->frame_count) * 10'000'000 / opt_audio->sample_rate);
             }
         }
 
-        const ULONGLONG now_ms = GetTickCount64();
+        // Paused audio is discarded; the timeline re-anchors on resume
+        if (paused) {
+            if (!timeline.empty()) timeline.reset();
+            if (!system_timeline.empty()) system_timeline.reset();
+            continue;
+        }
+        timeline.drain(queue_main);
+        if (separate) system_timeline.drain(queue_system);
+    }
+    timeline.drain(queue_main, /*flush=*/true);
+    if (separate) system_timeline.drain(queue_system, /*flush=*/true);
+
+    const auto& mix_stats = timeline.stats();
+    SR_LOG_INFO(L"[Audio] Mixer: %llu blocks (%u silent, shared), %llu frames trimmed, %u retimed, "
+                L"%u discontinuities, %u format rejects",
+                mix_stats.blocks_emitted, silent_blocks, mix_stats.trimmed_frames, mix_stats.retimed,
+                mix_stats.discontinuities, mix_stats.format_rejects);
+    SR_LOG_INFO(L"[Audio] sample pool: %u created, %u recycled, %u transient",
+                audio_samples->created(), audio_samples->recycled(), audio_samples->transient());
+    audio_samples->shutdown();
+}
 
-        // Dynamic power monitoring — check every 10 seconds.
-        // Keep this timestamp session-local so each recording starts fresh.
-        if (now_ms - last_power_check_ms >= kPowerCheckIntervalMs) {
-            bool on_ac = PowerModeDetector::is_on_ac_power();
-            if (on_ac != last_power_ac_) {
-                last_power_ac_ = on_ac;
-                SR_LOG_INFO(L"[Power] Switched to %s power", on_ac ? L"AC" : L"Battery");
-                // Adjust pacing with power mode changes.
-                uint32_t new_fps = on_ac ? encoder_->output_fps() : 15;
-                pacer_.initialize(new_fps);
+// ---------------------------------------------------------------------------
+// Dual output — the proxy is always H.264 at the reduced size so it plays
+// anywhere; it shares fps and GOP with the main profile.
+// ---------------------------------------------------------------------------
+bool SessionController::start_proxy(const EncoderProfile& main_profile) {
+    EncoderProfile prof = main_profile;
+    prof.width       = capture_->proxy_width();
+    prof.height      = capture_->proxy_height();
+    prof.bitrate_bps = (std::min)(proxy_bitrate_, main_profile.bitrate_bps);
+    prof.codec       = CodecPreference::H264;
+    if (gop_adaptive_) prof.gop_frames = 0;  // the schedule drives only the main encoder
+    proxy_encoder_->set_power_tuning(last_power_ac_, false);
+    if (!proxy_encoder_->initialize(prof,
+                                    probe_.dxgi_device_manager.Get(),
+                                    probe_.d3d_device.Get(),
+                                    probe_.d3d_context.Get()))
+    {
+        SR_LOG_WARN(L"Proxy encoder initialization failed; recording without proxy");
+        return false;
+    }
+
+    MuxConfig cfg = mux_cfg_;
+    cfg.video_width   = proxy_encoder_->output_width();
+    cfg.video_height  = proxy_encoder_->output_height();
+    cfg.video_fps_num = proxy_encoder_->output_fps();
+    cfg.video_bitrate = proxy_encoder_->output_bitrate();
+    cfg.video_codec   = proxy_encoder_->codec();
+    cfg.preallocate   = false;
+    cfg.video_sequence_header.clear();
+    proxy_encoder_->sequence_header(cfg.video_sequence_header);
+
+    const std::wstring partial = StorageManager::proxyFilename(current_partial_path_);
+    if (!proxy_muxer_->initialize(partial, StorageManager::partialToFinal(partial), cfg)) {
+        SR_LOG_WARN(L"Proxy file could not be opened; recording without proxy");
+        proxy_encoder_->shutdown();
+        return false;
+    }
+
+    proxy_pacer_.initialize(prof.fps);
+    proxy_frames_written_.store(0, std::memory_order_relaxed);
+    SR_LOG_INFO(L"Proxy output: %ux%u %s %u bps -> %s",
+                cfg.video_width, cfg.video_height, video_codec_label(cfg.video_codec),
+                cfg.video_bitrate, partial.c_str());
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// Multi-monitor — one DisplayPipeline per other monitor. Captures open first
+// so the scheduler sees the real output sizes; the main encoder is already
+// running and keeps its placement and rate (stream 0 of the plan), the
+// others get what is left of the hardware sessions and pixel-rate budgets.
+// ---------------------------------------------------------------------------
+void SessionController::start_displays() {
+    if (capture_source_.kind == CaptureSource::Kind::Window) {
+        SR_LOG_WARN(L"Multi-monitor recording needs a monitor source; recording the window only");
+        return;
+    }
+    const HMONITOR main_monitor = resolve_monitor(capture_source_);
+    const EncoderProfile cap = PowerModeDetector::clamp_for_quality_and_power_state(
+        requested_profile_, last_power_ac_, session_high_quality_);
+
+    // The main encoder is already open: it stays where it runs
+    const bool main_hw = encoder_->mode() == EncoderMode::HardwareMFT;
+    std::vector<EncoderStreamRequest> streams{
+        { encoder_->output_width(), encoder_->output_height(), encoder_->output_fps(), main_hw } };
+    for (HMONITOR monitor : enumerate_monitors()) {
+        if (monitor == main_monitor) continue;
+        auto display = std::make_unique<DisplayPipeline>();
+        // Same device as the main capture: losing it ends the session. stop()
+        // joins this display's capture, so it runs on auto_stop_thread_.
+        auto on_device_lost = [this]() {
+            SR_LOG_ERROR(L"[T039] Device lost on an additional display — auto-stopping recording");
+            if (request_auto_stop()) {
+                notify_error(L"\u26A0 Graphics device was reset or removed. Recording stopped.");
             }
-            last_power_check_ms = now_ms;
+        };
+        if (!display->open_capture(probe_, &sync_, CaptureSource::from_monitor(monitor), { cap.width, cap.height },
+                                   on_device_lost)) {
+            SR_LOG_WARN(L"Display %zu capture could not be initialized; skipped", displays_.size() + 2);
+            continue;
         }
+        streams.push_back({ display->width(), display->height(), active_profile_.fps });
+        displays_.push_back(std::move(display));
+    }
+    if (displays_.empty()) return;
+
+    // A main encoder that fell back to software leaves no hardware to share
+    EncoderCapacity capacity;
+    capacity.hw_sessions = !main_hw ? 0
+                         : hw_session_limit_ > 0 ? hw_session_limit_
+                         : hw_encoder_session_limit(probe_.adapter_id.vendor_id);
+    capacity.hw_pixel_rate = kHwEncoderPixelRate;
+    capacity.sw_pixel_rate = sw_encoder_pixel_rate(std::thread::hardware_concurrency());
+    const std::vector<EncoderStreamPlan> plan = schedule_encoder_streams(streams, capacity);
+
+    DisplayPipelineConfig cfg;
+    cfg.profile      = active_profile_;
+    cfg.high_quality = session_high_quality_;
+    cfg.on_ac        = last_power_ac_;
+    cfg.variable_frame_rate = variable_frame_rate_;
+    cfg.adaptive_quality    = adaptive_quality_;
+    cfg.pipeline_boost      = pipeline_boost_;
+    if (gop_adaptive_) cfg.profile.gop_frames = 0;  // the schedule drives only the main encoder
+    cfg.mux = mux_cfg_;
+    cfg.mux.preallocate = false;
+
+    std::vector<std::unique_ptr<DisplayPipeline>> opened;
+    for (size_t i = 0; i < displays_.size(); ++i) {
+        cfg.partial_path = StorageManager::displayFilename(current_partial_path_, static_cast<uint32_t>(i + 2));
+        if (!displays_[i]->open_encoder(probe_, cfg, plan[i + 1], &mux_running_)) {
+            SR_LOG_WARN(L"Display %zu encoder or file could not be opened; skipped", i + 2);
+            continue;
+        }
+        SR_LOG_INFO(L"Display %zu: %ux%u @ %u fps, %s -> %s", i + 2, displays_[i]->width(),
+                    displays_[i]->height(), displays_[i]->fps(), encoder_mode_label(displays_[i]->mode()),
+                    cfg.partial_path.c_str());
+        opened.push_back(std::move(displays_[i]));
+    }
+    if (plan[0].fps < streams[0].fps) {
+        SR_LOG_WARN(L"Encoder budget exceeded: the main display keeps %u fps, the others run at the floor",
+                    streams[0].fps);
+    }
+    displays_ = std::move(opened);
+}
 
-        if (now_ms - last_mem_sample_ms >= 5000) {
-            PROCESS_MEMORY_COUNTERS_EX mem{};
-            mem.cb = sizeof(mem);
-            if (GetProcessMemoryInfo(GetCurrentProcess(), reinterpret_cast<PROCESS_MEMORY_COUNTERS*>(&mem), sizeof(mem))) {
-                const uint64_t ws_mb = static_cast<uint64_t>(mem.WorkingSetSize / (1024ull * 1024ull));
-                const uint64_t private_mb = static_cast<uint64_t>(mem.PrivateUsage / (1024ull * 1024ull));
-                if (private_mb >= 700) {
-                    SR_LOG_WARN(L"[Perf] High process memory: private=%llu MB, working_set=%llu MB", private_mb, ws_mb);
-                } else {
-                    SR_LOG_INFO(L"[Perf] Process memory: private=%llu MB, working_set=%llu MB", private_mb, ws_mb);
+bool SessionController::save_replay() {
+    if (!replay_active_ || !(machine_.is_recording() || machine_.is_paused())) return false;
+    replay_save_requested_.store(true, std::memory_order_release);
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// Replay save — mux stage only. The ring is snapshotted by reference (ComPtr
+// copies) and written to disk on replay_saver_, so buffering never pauses.
+// ---------------------------------------------------------------------------
+void SessionController::save_replay_snapshot() {
+    if (replay_saving_.load(std::memory_order_acquire)) {
+        SR_LOG_WARN(L"Save replay ignored: previous replay is still being written");
+        return;
+    }
+    if (replay_.empty()) {
+        SR_LOG_WARN(L"Save replay ignored: buffer is empty");
+        return;
+    }
+
+    std::vector<std::pair<ComPtr<IMFSample>, bool>> samples;  // (sample, is_video)
+    samples.reserve(replay_.size());
+    for (const auto& e : replay_.entries()) samples.emplace_back(e.sample, e.video);
+    const int64_t base = replay_.start_pts();
+    const double seconds = static_cast<double>(replay_.duration()) / 1e7;
+
+    const std::wstring partial = storage_ ? storage_->generateFilename(L"replay") : L"Replay.partial.mp4";
+    if (replay_saver_.joinable()) replay_saver_.join();
+    replay_saving_.store(true, std::memory_order_release);
+    SR_LOG_INFO(L"Saving replay (%.1f s, %zu samples) -> %s", seconds, samples.size(), partial.c_str());
+
+    replay_saver_ = std::thread([this, partial, base, cfg = mux_cfg_,
+                                 samples = std::move(samples)]() {
+        MuxWriter writer;
+        bool ok = writer.initialize(partial, StorageManager::partialToFinal(partial), cfg);
+        if (ok) {
+            writer.set_time_base(base);
+            for (const auto& [sample, video] : samples) {
+                if (video) writer.write_video(sample.Get());
+                else       writer.write_audio(sample.Get());
+            }
+            ok = writer.finalize();
+        }
+        if (ok) {
+            replays_saved_.fetch_add(1, std::memory_order_relaxed);
+            notify_status(L"Replay saved");
+        } else {
+            notify_error(L"Failed to save replay.");
+        }
+        replay_saving_.store(false, std::memory_order_release);
+    });
+}
+
+// ---------------------------------------------------------------------------
+// Segment rotation — mux stage only. Audio already queued is split at the IDR:
+// older packets close the old file, the rest open the new one. Audio the mixer
+// has not yet delivered for the old segment is dropped by the new muxer's time
+// base (a few ms at the end of the old file).
+// ---------------------------------------------------------------------------
+void SessionController::rotate_segment(int64_t base_pts) {
+    const uint32_t index = segments_.segment_index() + 1;
+    const std::wstring partial = StorageManager::segmentFilename(current_partial_path_, index);
+
+    auto next = std::make_unique<MuxWriter>();
+    if (!next->initialize(partial, StorageManager::partialToFinal(partial), mux_cfg_)) {
+        SR_LOG_ERROR(L"Segment %u could not be opened; continuing in the current file", index);
+        segments_.disable();
+        return;
+    }
+    next->set_time_base(base_pts);
+
+    std::vector<EncodedSample> carried;
+    while (auto opt_audio = encoded_audio_queue_->try_pop()) {
+        LONGLONG t = 0;
+        opt_audio->sample->GetSampleTime(&t);
+        if (t < base_pts) {
+            mux_audio(opt_audio->sample.Get(), opt_audio->track);
+        } else {
+            carried.push_back(std::move(*opt_audio));
+        }
+    }
+
+    // Finalize (moov write + rename) off the mux thread, behind any file
+    // still closing
+    closed_segment_bytes_ += muxer_->bytes_written();
+    const std::wstring closed = muxer_->final_path();
+    finalizer_.enqueue(std::exchange(muxer_, std::move(next)),
+                       [this, closed](bool ok) { notify_finalized(closed, ok); });
+    segments_.start_segment(base_pts);
+    SR_LOG_INFO(L"Segment %u started -> %s", index, partial.c_str());
+
+    for (auto& s : carried) mux_audio(s.sample.Get(), s.track);
+}
+
+// The PCM sample is shared read-only by both sink writers
+void SessionController::mux_audio(IMFSample* sample, AudioTrack track) {
+    muxer_->write_audio(sample, track);
+    if (trace::enabled(trace::kKeywordMux)) {
+        LONGLONG pts = 0;
+        DWORD len = 0;
+        sample->GetSampleTime(&pts);
+        sample->GetTotalLength(&len);
+        trace::sink_write(track == AudioTrack::System ? trace::Track::SystemAudio : trace::Track::Audio,
+                          pts, len, encoded_audio_queue_->size());
+    }
+    if (proxy_active_) proxy_muxer_->write_audio(sample, track);
+    for (auto& d : displays_) d->write_audio(sample, track);
+    audio_written_.fetch_add(1, std::memory_order_relaxed);
+    telemetry_.on_audio_written();
+}
+
+// ---------------------------------------------------------------------------
+// Mux stage — runs on mux_thread_; the only thread that touches muxer_
+// until stop() flushes the encoder after this stage has exited.
+// ---------------------------------------------------------------------------
+void SessionController::mux_loop() {
+    ULONGLONG last_mem_sample_ms = 0;
+    const ULONGLONG trace_start_ms = GetTickCount64();
+    uint64_t trace_seconds = 0;  // seconds already sampled
+    const QPCClock& clock = QPCClock::instance();
+
+    ComPtr<IDXGIAdapter3> perf_adapter3;
+    if (probe_.d3d_device) {
+        ComPtr<IDXGIDevice> dxgi_device;
+        if (SUCCEEDED(probe_.d3d_device.As(&dxgi_device)) && dxgi_device) {
+            ComPtr<IDXGIAdapter> adapter;
+            if (SUCCEEDED(dxgi_device->GetAdapter(&adapter)) && adapter) {
+                adapter.As(&perf_adapter3);
+            }
+        }
+    }
+
+    while (mux_running_.load(std::memory_order_acquire) ||
+           !encoded_video_queue_->empty() || !encoded_audio_queue_->empty() ||
+           !encoded_proxy_queue_->empty() ||
+           std::any_of(displays_.begin(), displays_.end(), [](const auto& d) { return d->mux_pending(); }))
+    {
+        if (auto opt_video = encoded_video_queue_->wait_pop(std::chrono::milliseconds(10))) {
+            IMFSample* sample = opt_video->sample.Get();
+            LONGLONG pts = 0;
+            sample->GetSampleTime(&pts);
+            if (replay_active_) {
+                DWORD len = 0;
+                sample->GetTotalLength(&len);
+                ComPtr<IMFSample> copy;
+                if (SUCCEEDED(copy_sample_payload(sample, copy))) {
+                    replay_.push_video(std::move(copy), pts, len, is_clean_point(sample));
+                }
+            } else {
+                if (opt_video->format) {
+                    // Re-created encoder (resolution switch): its IDR opens a new file
+                    const VideoTrackFormat& f = *opt_video->format;
+                    mux_cfg_.video_width           = f.width;
+                    mux_cfg_.video_height          = f.height;
+                    mux_cfg_.video_fps_num         = f.fps;
+                    mux_cfg_.video_bitrate         = f.bitrate_bps;
+                    mux_cfg_.video_codec           = f.codec;
+                    mux_cfg_.video_sequence_header = f.sequence_header;
+                    if (network_sink_) {
+                        network_sink_->set_format(live_format(f.width, f.height, f.fps, f.bitrate_bps,
+                                                              f.sequence_header));
+                    }
+                    rotate_segment(pts);
+                } else if (segments_.opens_segment(is_clean_point(sample))) {
+                    rotate_segment(pts);
+                }
+                muxer_->write_video(sample);
+                if (network_sink_) network_sink_->push_video(sample, pts, is_clean_point(sample));
+                if (trace::enabled(trace::kKeywordMux)) {
+                    DWORD len = 0;
+                    sample->GetTotalLength(&len);
+                    trace::sink_write(trace::Track::Video, pts, len, encoded_video_queue_->size());
+                }
+                if (segments_.check(pts, muxer_->bytes_written())) {
+                    encoder_->request_keyframe();  // the next segment opens on this IDR
+                }
+            }
+            if (opt_video->encoded_us > 0) {
+                const int64_t written_us = clock.now_us();
+                telemetry_.record_latency(LatencyStage::Mux, written_us - opt_video->encoded_us);
+                telemetry_.record_latency(LatencyStage::EndToEnd, written_us - opt_video->arrival_us);
+            }
+            frames_encoded_.fetch_add(1, std::memory_order_relaxed);
+            telemetry_.on_frame_encoded();
+        }
+
+        // Proxy video never blocks the main file: take whatever is ready
+        while (auto opt_proxy = encoded_proxy_queue_->try_pop()) {
+            if (proxy_muxer_->write_video(opt_proxy->sample.Get())) {
+                if (trace::enabled(trace::kKeywordMux)) {
+                    LONGLONG pts = 0;
+                    DWORD len = 0;
+                    opt_proxy->sample->GetSampleTime(&pts);
+                    opt_proxy->sample->GetTotalLength(&len);
+                    trace::sink_write(trace::Track::Proxy, pts, len, encoded_proxy_queue_->size());
+                }
+                proxy_frames_written_.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+        for (auto& d : displays_) d->write_ready();
+
+        while (auto opt_audio = encoded_audio_queue_->try_pop()) {
+            if (replay_active_) {
+                LONGLONG pts = 0;
+                DWORD len = 0;
+                opt_audio->sample->GetSampleTime(&pts);
+                opt_audio->sample->GetTotalLength(&len);
+                ComPtr<IMFSample> copy;
+                if (SUCCEEDED(copy_sample_payload(opt_audio->sample.Get(), copy))) {
+                    replay_.push_audio(std::move(copy), pts, len);
                 }
+                audio_written_.fetch_add(1, std::memory_order_relaxed);
+                telemetry_.on_audio_written();
+            } else {
+                mux_audio(opt_audio->sample.Get(), opt_audio->track);
             }
-            if (perf_adapter3) {
-                DXGI_QUERY_VIDEO_MEMORY_INFO local_info{};
-                DXGI_QUERY_VIDEO_MEMORY_INFO nonlocal_info{};
-                const HRESULT hr_local = perf_adapter3->QueryVideoMemoryInfo(
-                    0, DXGI_MEMORY_SEGMENT_GROUP_LOCAL, &local_info);
-                const HRESULT hr_nonlocal = perf_adapter3->QueryVideoMemoryInfo(
-                    0, DXGI_MEMORY_SEGMENT_GROUP_NON_LOCAL, &nonlocal_info);
-                if (SUCCEEDED(hr_local) && SUCCEEDED(hr_nonlocal)) {
-                    const uint64_t local_current_mb = local_info.CurrentUsage / (1024ull * 1024ull);
-                    const uint64_t local_budget_mb  = local_info.Budget / (1024ull * 1024ull);
-                    const uint64_t shared_current_mb = nonlocal_info.CurrentUsage / (1024ull * 1024ull);
-                    const uint64_t shared_budget_mb  = nonlocal_info.Budget / (1024ull * 1024ull);
-                    SR_LOG_INFO(
-                        L"[Perf] GPU memory: local=%llu/%llu MB, shared=%llu/%llu MB",
-                        local_current_mb, local_budget_mb, shared_current_mb, shared_budget_mb);
+        }
+
+        if (replay_active_ && replay_save_requested_.exchange(false, std::memory_order_acq_rel)) {
+            save_replay_snapshot();
+        }
+
+        const ULONGLONG now_ms = GetTickCount64();
+        check_disk_space(static_cast<int64_t>(now_ms));
+        const bool log_memory   = now_ms - last_mem_sample_ms >= 5000;
+        const uint64_t elapsed_s = (now_ms - trace_start_ms) / 1000;
+        const bool trace_second  = perf_trace_.is_open() && elapsed_s > trace_seconds;
+        if (!log_memory && !trace_second) continue;
+        const MemorySample mem = sample_memory(perf_adapter3.Get());
+        if (log_memory) {
+            if (mem.process) {
+                if (mem.private_mb >= 700) {
+                    SR_LOG_WARN(L"[Perf] High process memory: private=%llu MB, working_set=%llu MB",
+                                mem.private_mb, mem.working_set_mb);
+                } else {
+                    SR_LOG_INFO(L"[Perf] Process memory: private=%llu MB, working_set=%llu MB",
+                                mem.private_mb, mem.working_set_mb);
                 }
             }
+            if (mem.gpu) {
+                SR_LOG_INFO(
+                    L"[Perf] GPU memory: local=%llu/%llu MB, shared=%llu/%llu MB",
+                    mem.local_mb, mem.local_budget_mb, mem.shared_mb, mem.shared_budget_mb);
+            }
             last_mem_sample_ms = now_ms;
         }
+        if (trace_second) {
+            // A stalled loop's late sample covers every second it missed
+            const TelemetrySnapshot t = telemetry_snapshot();
+            PerfTraceSample sample;
+            sample.t_s = static_cast<uint32_t>(elapsed_s - 1);
+            perf_trace_deltas(perf_counters(t), perf_prev_, sample);
+            perf_accum_.take(sample);
+            sample.quality_level        = static_cast<uint8_t>((std::min)(t.quality_level, 255u));
+            sample.encoder_mode         = static_cast<uint8_t>(t.encoder_mode);
+            sample.private_mb           = static_cast<uint32_t>(mem.private_mb);
+            sample.working_set_mb       = static_cast<uint32_t>(mem.working_set_mb);
+            sample.gpu_local_mb         = static_cast<uint32_t>(mem.local_mb);
+            sample.gpu_local_budget_mb  = static_cast<uint32_t>(mem.local_budget_mb);
+            sample.gpu_shared_mb        = static_cast<uint32_t>(mem.shared_mb);
+            sample.gpu_shared_budget_mb = static_cast<uint32_t>(mem.shared_budget_mb);
+            sample.flags = static_cast<uint8_t>((machine_.is_paused() ? kPerfTracePaused : 0) |
+                                                (t.is_on_ac ? kPerfTraceOnAc : 0) |
+                                                (mem.process ? kPerfTraceMemory : 0) |
+                                                (mem.gpu ? kPerfTraceGpuMemory : 0));
+            for (const PerfTraceSample& one :
+                 spread_perf_sample(sample, static_cast<uint32_t>(elapsed_s - trace_seconds))) {
+                perf_trace_.append(one);
+            }
+            trace_seconds = elapsed_s;
+        }
     }
 }
 
 // ---------------------------------------------------------------------------
+// Per-stage video latency percentiles for the session log
+void SessionController::log_latency_summary() const {
+    const auto snapshot = telemetry_.snapshot(0, last_power_ac_);
+    for (size_t i = 0; i < kLatencyStageCount; ++i) {
+        const auto& l = snapshot.latency[i];
+        if (l.samples == 0) continue;
+        SR_LOG_INFO(L"[Latency] %-7s n=%u p50=%.2f ms p95=%.2f ms p99=%.2f ms max=%.2f ms",
+                    latency_stage_label(static_cast<LatencyStage>(i)), l.samples,
+                    l.p50_us / 1000.0, l.p95_us / 1000.0, l.p99_us / 1000.0, l.max_us / 1000.0);
+    }
+}
+
+void SessionController::check_disk_space(int64_t now_ms) {
+    if (!storage_ || auto_stop_requested_.load(std::memory_order_relaxed)) return;
+    uint64_t written = closed_segment_bytes_ + muxer_->bytes_written() + proxy_muxer_->bytes_written();
+    for (const auto& d : displays_) written += d->bytes_written();
+    if (!disk_monitor_.update(now_ms, written, [this] { return storage_->getFreeDiskSpace(); })) return;
+
+    const DiskSpaceStatus& disk = disk_monitor_.status();
+    const long long minutes = (disk.remaining_s + 59) / 60;
+    wchar_t msg[160];
+    switch (disk.level) {
+        case DiskSpaceLevel::Ok:
+            SR_LOG_INFO(L"Disk space OK again: %llu MB free", disk.free_bytes >> 20);
+            notify_status(L"Recording...");
+            break;
+        case DiskSpaceLevel::Low:
+            SR_LOG_WARN(L"Disk space low: %llu MB free, ~%lld min left at %llu KB/s",
+                        disk.free_bytes >> 20, minutes, disk.bytes_per_sec >> 10);
+            _snwprintf_s(msg, _countof(msg), _TRUNCATE,
+                         L"\u26A0 Low disk space: about %lld min of recording left", minutes);
+            notify_status(msg);
+            break;
+        case DiskSpaceLevel::Critical:
+            _snwprintf_s(msg, _countof(msg), _TRUNCATE,
+                         L"\u26A0 Disk almost full: about %lld min of recording left. "
+                         L"The recording stops automatically before the disk fills up.", minutes);
+            notify_status(L"\u26A0 Disk almost full");
+            notify_error(msg);
+            break;
+        case DiskSpaceLevel::Exhausted:
+            if (!request_auto_stop()) break;
+            SR_LOG_WARN(L"Auto-stopping: %llu MB free", disk.free_bytes >> 20);
+            notify_error(L"\u26A0 Disk space critically low! Recording auto-stopped.");
+            break;
+    }
+}
+
+// Process priority and, with pipeline_boost_, EcoQoS opt-out and GPU priority
+// for the duration of a recording
+void SessionController::set_recording_priority(bool recording) {
+    SetPriorityClass(GetCurrentProcess(), recording ? ABOVE_NORMAL_PRIORITY_CLASS : NORMAL_PRIORITY_CLASS);
+    if (pipeline_boost_) {
+        set_process_eco_qos_opt_out(recording);
+        set_gpu_thread_priority(probe_.d3d_device.Get(), recording ? kRecordingGpuPriority : 0);
+    }
+}
+
+// stop() joins the pipeline threads, so one of them hands it to
+// auto_stop_thread_; false = a stop is already on its way
+bool SessionController::request_auto_stop() {
+    if (auto_stop_requested_.exchange(true)) return false;
+    if (auto_stop_thread_.joinable()) auto_stop_thread_.join();
+    auto_stop_thread_ = std::thread([this] { stop(); });
+    return true;
+}
+
 void SessionController::notify_status(const std::wstring& msg) {
     if (on_status_) on_status_(msg);
 }
@@ -719,4 +1790,10 @@ void SessionController::notify_error(const std::wstring& msg) {
     if (on_error_) on_error_(msg);
 }
 
+// Finalizer worker thread
+void SessionController::notify_finalized(const std::wstring& path, bool ok) {
+    if (ok) SR_LOG_INFO(L"Recording file closed -> %s", path.c_str());
+    if (on_finalized_) on_finalized_(path, ok);
+}
+
 } // namespace sr
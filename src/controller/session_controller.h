@@ -3,26 +3,52 @@
 // T016: Start initializes all engines, runs capture->preprocess->encode->mux pipeline,
 //       Stop finalizes and renames file, Pause/Resume propagates to sync manager.
 // T037: TelemetryStore integration for live counter snapshot
-// T038: FramePacer for jitter absorption in encode_loop
+// T038: FramePacer for jitter absorption in video_encode_loop
 // T039: Device-lost callback routing
 // T042: PowerModeDetector applied at session start
+//
+// Pipeline stages (each on its own thread):
+//   video_encode_loop: FrameQueue -> FramePacer -> VideoEncoder -> EncodedVideoQueue
+//   audio_mix_loop:    mic + loopback AudioQueues -> AudioTimelineMixer -> EncodedAudioQueue
+//                      (separate tracks: one single-source timeline per track, no mixing)
+//   proxy_encode_loop: proxy FrameQueue -> FramePacer -> proxy VideoEncoder -> proxy EncodedVideoQueue
+//                      (dual-output sessions only)
+//   DisplayPipeline:   one capture + encode thread per additional monitor
+//                      (multi-monitor sessions only; see display_pipeline.h)
+//   mux_loop:          EncodedVideoQueue + EncodedAudioQueue -> MuxWriter (sole writer)
+// A slow encode_frame() therefore only backs up the frame queue; audio keeps draining.
 
 #include <windows.h>
+#include <mfobjects.h>
+#include <algorithm>
 #include <atomic>
 #include <thread>
 #include <functional>
 #include <string>
+#include <memory>
+#include <mutex>
+#include <vector>
 #include "controller/session_machine.h"
 #include "encoder/encoder_probe.h"
 #include "encoder/power_mode.h"      // T042
+#include "sync/adaptive_gop.h"
 #include "sync/sync_manager.h"
 #include "sync/frame_pacer.h"        // T038
+#include "sync/keyframe_schedule.h"
+#include "sync/quality_governor.h"
 #include "app/telemetry.h"           // T037
 #include "utils/render_frame.h"
 #include "utils/bounded_queue.h"
+#include "utils/perf_trace.h"
 #include "utils/session_diagnostics.h"
 #include "capture/capture_engine.h"  // for FrameQueue typedef
 #include "audio/audio_engine.h"     // for AudioQueue typedef
+#include "storage/mux_writer.h"     // for MuxContainer
+#include "storage/mux_finalizer.h"
+#include "storage/segment_policy.h"
+#include "storage/replay_ring.h"
+#include "storage/disk_space_monitor.h"
+#include "storage/network_sink.h"
 
 namespace sr {
 
@@ -32,40 +58,259 @@ class AudioEngine;
 class VideoEncoder;
 class MuxWriter;
 class StorageManager;
+class DisplayPipeline;
+
+// Video track of a re-created encoder (mid-session resolution change). Rides
+// on the encoder's first sample so the mux stage opens the next segment with it.
+struct VideoTrackFormat {
+    uint32_t   width       = 0;
+    uint32_t   height      = 0;
+    uint32_t   fps         = 0;
+    uint32_t   bitrate_bps = 0;
+    VideoCodec codec       = VideoCodec::H264;
+    std::vector<uint8_t> sequence_header;
+};
+
+// Encoded output handed from an encode stage to the mux stage
+struct EncodedSample {
+    ComPtr<IMFSample> sample;
+    int64_t arrival_us = 0;   // video: source frame's WGC arrival (0 for audio)
+    int64_t encoded_us = 0;   // video: encode_frame() returned
+    AudioTrack track   = AudioTrack::Main;  // audio only
+    std::shared_ptr<const VideoTrackFormat> format;  // video: first sample of a new encoder
+};
+using EncodedVideoQueue = BoundedQueue<EncodedSample, 16, SingleProducer>;
+using EncodedAudioQueue = BoundedQueue<EncodedSample, 32, SingleProducer>;
 
 // Callback for UI status updates
 using StatusCallback = std::function<void(const std::wstring& status)>;
 using ErrorCallback  = std::function<void(const std::wstring& error)>;
+// A recording (or segment) file finished closing: `ok` = renamed to `path`,
+// false = the .partial was kept
+using FinalizedCallback = std::function<void(const std::wstring& path, bool ok)>;
+// A session's main file closed; what its diagnostics file recorded
+using SummaryCallback = std::function<void(const SessionDiagnostics::Summary& summary)>;
 
 class SessionController {
 public:
     SessionController();
     ~SessionController();
 
+    // Persist the hardware-encoder probe here (ProbeCache) — before initialize().
+    // Empty = enumerate on every launch.
+    void set_probe_cache_path(const std::wstring& path) { probe_cache_path_ = path; }
+
+    // Device adapter choice — before initialize(). CapturedDisplay uses the
+    // adapter driving the capture source's monitor (set_capture_source first);
+    // LowestContention may put the encoder on another GPU and capture on an
+    // isolated device on the display adapter.
+    void set_adapter_policy(AdapterPolicy policy) { adapter_policy_ = policy; }
+
     // One-time setup; must be called before any Start
     bool initialize(StorageManager* storage,
                     StatusCallback on_status = nullptr,
                     ErrorCallback  on_error  = nullptr);
 
-    // Start recording — transitions state machine Idle->Recording
+    // Start recording — transitions state machine Idle/Armed->Recording.
+    // From Armed only the output file is opened and the engines started.
     bool start();
 
-    // Stop recording — transitions Recording/Paused->Stopping->Idle
+    // Pre-warm: initialize capture, audio and the encoder while idle
+    // (Idle->Armed) so the next start() skips that setup. A failed arm is
+    // only logged; start() then initializes from cold. Call disarm() before
+    // changing any before-start() setting, then arm again.
+    bool arm();
+    void arm_async();          // arm() on a worker thread (COM MTA)
+    void disarm();             // Armed->Idle, releasing the engines
+
+    // Re-arm in the background after every stop()
+    void set_auto_arm(bool enabled) { auto_arm_.store(enabled, std::memory_order_relaxed); }
+
+    // Stop recording — transitions Recording/Paused->Stopping->Idle. The
+    // file is finalized and renamed in the background afterwards, so start()
+    // may run again at once; set_finalized_callback reports when it is done.
     bool stop();
 
+    // Runs on the finalizer thread for every file closed — before start()
+    void set_finalized_callback(FinalizedCallback on_finalized) { on_finalized_ = std::move(on_finalized); }
+    // Runs on the finalizer thread after each session's main file — before start()
+    void set_summary_callback(SummaryCallback on_summary) { on_summary_ = std::move(on_summary); }
+    // The current / last session's diagnostics so far, e.g. after start() failed
+    SessionDiagnostics::Summary session_summary() const { return diagnostics_.summary(); }
+    // Files from earlier stops / segment rotations still closing
+    size_t files_finalizing() const { return finalizer_.pending(); }
+    // Block until those are closed (e.g. before reading the last file)
+    void wait_for_finalize() { finalizer_.drain(); }
+
     // Pause — Recording->Paused
     bool pause();
 
     // Resume — Paused->Recording
     bool resume();
 
-    // Override encoder profile (fps/bitrate/resolution) — must be called before start()
+    // Override encoder profile (fps/bitrate/resolution/source crop) — must be called before start()
     void set_encoder_profile(const EncoderProfile& profile, bool high_quality = false) {
         pending_profile_ = profile;
         pending_profile_high_quality_ = high_quality;
         has_pending_profile_ = true;
     }
 
+    // Monitor or window to record — before start(); defaults to the primary monitor
+    void set_capture_source(const CaptureSource& source) { capture_source_ = source; }
+
+    // Classic or fragmented MP4 output — before start(). In fragmented mode an
+    // IDR (and so a new fragment) is forced every fragment_ms.
+    void set_output_container(MuxContainer container, uint32_t fragment_ms = 2000) {
+        output_container_ = container;
+        fragment_ms_      = fragment_ms;
+    }
+
+    // Unbuffered overlapped file writes in chunk_mb chunks (4-8) — before start()
+    void set_unbuffered_io(bool enabled, uint32_t chunk_mb = 4) {
+        unbuffered_io_ = enabled;
+        io_chunk_mb_   = chunk_mb;
+    }
+
+    // Reserve output extents ahead of the writer — before start(). With
+    // expected_minutes > 0, start() fails if the volume cannot hold that long.
+    void set_preallocation(bool enabled, uint32_t expected_minutes = 0) {
+        preallocate_      = enabled;
+        expected_minutes_ = expected_minutes;
+    }
+
+    // Remaining-time tiers for low-disk warnings and the auto-stop reserve — before start()
+    void set_disk_space_thresholds(const DiskSpaceThresholds& thresholds) { disk_thresholds_ = thresholds; }
+
+    // Also publish the encoded video live over RTMP — before start(). An
+    // empty URL turns it off. Best effort: a sink that cannot start, or a
+    // server that drops, never affects the recording. H.264 only; ignored
+    // in replay mode.
+    void set_live_stream(const NetworkSinkConfig& config) { live_cfg_ = config; }
+
+    // Save a keyframe index sidecar (<file>.keyidx) with every file — before start()
+    void set_keyframe_index(bool enabled) { keyframe_index_ = enabled; }
+
+    // Write a per-second <file>.perftrace beside every recording (see
+    // utils/perf_trace.h; tools/sr_trace_view prints it) — before start()
+    void set_perf_trace(bool enabled) { perf_trace_enabled_ = enabled; }
+
+    // Rotate to a new file every N minutes / N MB (0 = unlimited) — before start().
+    // Each segment opens on a forced IDR; capture and the encoder keep running.
+    void set_segment_limits(const SegmentLimits& limits) { segment_limits_ = limits; }
+
+    // Instant-replay mode — before start(). With seconds > 0 the session keeps
+    // the last `seconds` of encoded audio/video in memory and writes nothing
+    // until save_replay(). 0 = normal recording.
+    void set_replay_buffer(uint32_t seconds) { replay_seconds_ = seconds; }
+    bool replay_mode() const { return replay_seconds_ > 0; }
+
+    // Write the current replay buffer to a new file (in the background).
+    // Returns false when no replay session is running. Safe from any thread.
+    bool save_replay();
+
+    // Dual output — before start(). Also writes a low-res H.264 proxy
+    // (<name>_proxy.mp4, up to `resolution` at `bitrate_bps`) converted from
+    // the same captured frames and carrying the same audio. Best effort: a
+    // proxy that cannot be set up is skipped and the main recording continues.
+    // Ignored in replay mode; segmented sessions keep one proxy file.
+    void set_proxy_output(bool enabled,
+                          RecordingResolution resolution = kEfficiencyRecordingResolution,
+                          uint32_t bitrate_bps = 1'000'000) {
+        proxy_enabled_    = enabled;
+        proxy_resolution_ = resolution;
+        proxy_bitrate_    = bitrate_bps;
+    }
+
+    // Multi-monitor — before start(). A monitor capture source also records
+    // every other monitor, each to <name>_displayN.mp4 with the session's
+    // audio, on the session's D3D11 device. schedule_encoder_streams()
+    // (encoder/encoder_scheduler.h) puts each display on the hardware
+    // encoder or in software and lowers the additional displays' fps when
+    // the budget is short. hw_sessions overrides the vendor's session limit
+    // (0 = auto). Best effort; ignored for window sources and in replay mode.
+    // Segment rotation and power-profile resizing apply to the main file only.
+    void set_multi_monitor(bool enabled, uint32_t hw_sessions = 0) {
+        multi_monitor_    = enabled;
+        hw_session_limit_ = hw_sessions;
+    }
+
+    // Mux system audio as its own AAC track instead of mixing it into the
+    // mic track — before start(). Ignored in replay mode.
+    void set_separate_audio_tracks(bool enabled) { separate_audio_tracks_ = enabled; }
+
+    // Audio track codec and bitrate — before start(). AAC bitrates snap to
+    // the encoder's fixed rates; Opus falls back to AAC without an encoder MFT.
+    void set_audio_encoding(AudioCodec codec, uint32_t bitrate_bps, AacProfile profile = AacProfile::LC) {
+        audio_codec_   = codec;
+        audio_bitrate_ = bitrate_bps;
+        aac_profile_   = profile;
+    }
+
+    // Closed-loop quality: step bitrate (then fps) down while the encode stage
+    // is overloaded and back up once it recovers — before start()
+    void set_adaptive_quality(bool enabled) { adaptive_quality_ = enabled; }
+
+    // Variable frame rate — before start(). Only changed frames are encoded
+    // (no pacer duplicates, no static refresh) and the MP4 carries real
+    // sample durations; IDRs follow the profile GOP in time, not frames.
+    // The proxy file stays constant-rate for editors.
+    void set_variable_frame_rate(bool enabled) { variable_frame_rate_ = enabled; }
+
+    // Adaptive GOP — before start(). IDRs every profile gop_seconds while the
+    // content moves, up to every max_seconds while it is static, and at once
+    // on a scene cut (sync/adaptive_gop.h). Ignored for fMP4, replay and live
+    // streaming, which need a fixed cadence.
+    void set_adaptive_gop(bool enabled, uint32_t max_seconds) {
+        adaptive_gop_    = enabled;
+        gop_max_seconds_ = (std::clamp)(max_seconds, 2u, 60u);
+    }
+
+    // NV12 ring depth / WGC frame-pool size — before start()
+    void set_capture_buffering(const CaptureBuffering& buffering) { capture_->set_buffering(buffering); }
+
+    // Capture and BGRA->NV12 on a separate D3D11 device, fence-synchronized
+    // with the encoders — before start() / arm()
+    void set_capture_device_isolation(bool enabled) { capture_->set_isolated_device(enabled); }
+
+    // Draw the cursor into the NV12 output instead of WGC; mouse-only motion
+    // becomes small overlay_only deltas — before start() / arm()
+    void set_cursor_overlay(bool enabled) { capture_->set_cursor_overlay(enabled); }
+
+    // Share the main NV12 frames with external readers (frame_tap_layout.h)
+    // — before start() / arm()
+    void set_frame_tap(bool enabled) { capture_->set_frame_tap(enabled); }
+
+    // Camera picture-in-picture composited by the capture engine — before
+    // start() / arm(). Feed it with post_camera_frame from the camera thread.
+    void set_camera_pip(bool enabled, const PipLayout& layout = {}) { capture_->set_camera_pip(enabled, layout); }
+    void post_camera_frame(const uint8_t* bgrx, uint32_t width, uint32_t height) {
+        capture_->post_camera_frame(bgrx, width, height, size_t{ width } * 4);
+    }
+
+    // Tone-map FP16 captures of an HDR monitor to SDR NV12 — before start() / arm()
+    void set_hdr_tone_mapping(bool enabled) { capture_->set_hdr_tone_mapping(enabled); }
+
+    // BGRA -> NV12 through the video processor or compute shaders (Auto:
+    // whichever measures faster on the adapter) — before start() / arm()
+    void set_nv12_converter(Nv12ConverterMode mode, Nv12ScaleFilter filter) {
+        capture_->set_nv12_converter(mode, filter);
+    }
+
+    // While recording: GPU thread priority on the device, MMCSS for the video
+    // ("Capture") and audio-mix ("Audio") stages, and no EcoQoS / efficiency-
+    // core throttling for the process — before start()
+    void set_pipeline_boost(bool enabled) { pipeline_boost_ = enabled; }
+
+    // Resampler backend for audio devices not running at 48 kHz — before start()
+    void set_audio_resampler_backend(ResamplerBackend backend) {
+        audio_->set_resampler_backend(backend);
+        loopback_audio_->set_resampler_backend(backend);
+    }
+
+    // WASAPI buffer period / wakeup batching — before start() / arm(). Auto
+    // picks PowerSaving on battery and Default on AC when the engines open.
+    void set_audio_latency(AudioLatencyMode mode) { audio_latency_ = mode; }
+
     // Mute/Unmute audio
     void set_muted(bool muted);
     bool is_muted() const;
@@ -74,7 +319,8 @@ public:
     SessionState state() const { return machine_.state(); }
     bool is_recording()   const { return machine_.is_recording(); }
     bool is_paused()      const { return machine_.is_paused(); }
-    bool state_is_idle()  const { return machine_.is_idle(); }
+    bool is_armed()       const { return machine_.is_armed(); }
+    bool state_is_idle()  const { return machine_.is_idle() || machine_.is_armed(); }
 
     // Live stats (safe to read from UI thread)
     uint32_t frames_captured()  const;
@@ -84,18 +330,82 @@ public:
 
     // T037: Rich telemetry snapshot for debug overlay
     TelemetrySnapshot telemetry_snapshot() const;
+    // Coalesced "counters changed" push (see TelemetryStore) — listener
+    // before start(); enable only while the UI is visible and acknowledge
+    // after each snapshot
+    void set_telemetry_listener(TelemetryStore::ChangeListener listener, uint32_t min_interval_ms) {
+        telemetry_.set_change_listener(std::move(listener), min_interval_ms);
+    }
+    void set_telemetry_notify(bool enabled) { telemetry_.set_notify_enabled(enabled); }
+    void acknowledge_telemetry() { telemetry_.acknowledge_change(); }
 
     std::wstring output_path() const { return current_output_path_; }
 
 private:
-    // Encode/mux pipeline — runs on encode_thread_
-    void encode_loop();
+    // Pipeline stages — see header comment
+    void video_encode_loop();
+    void proxy_encode_loop();
+    void audio_mix_loop();
+    void mux_loop();
+
+    // Hand an encoded sample to the mux stage, waiting while its queue is full.
+    // Returns false only if the mux stage has already exited.
+    template <typename Queue>
+    bool push_to_mux(Queue& queue, EncodedSample&& sample);
+
+    // Video-encode stage: push_to_mux for the main video queue; tags the first
+    // sample after reopen_encoder() with the new track format
+    bool push_video(EncodedSample&& sample);
+
+    // Video-encode stage: re-clamp the session profile after an AC/battery
+    // flip — bitrate and fps in place, output size via the capture engine
+    void apply_power_profile(bool on_ac);
+
+    // Video-encode stage: capture now delivers width x height; drain and
+    // re-create the encoder at that size (the mux stage starts a new segment)
+    bool reopen_encoder(uint32_t width, uint32_t height);
+
+    // Resolve + clamp the profile and initialize capture, audio and the
+    // encoder (not started). Returns a diagnostics failure code, or nullptr.
+    const wchar_t* prepare_engines();
+    void release_engines();
+
+    // Stop and join the encode stages first (they drain their inputs), then the mux stage
+    void join_pipeline_threads();
+
+    // Mux stage: switch muxer_ to the next segment file, with the IDR at
+    // base_pts as its first sample. The old file finalizes in the background.
+    void rotate_segment(int64_t base_pts);
+
+    // Mux stage: write one audio sample to the main (and proxy) file
+    void mux_audio(IMFSample* sample, AudioTrack track);
+
+    // Mux stage: feed the session's bytes written to disk_monitor_ and act
+    // on a level change (status warning, error, auto-stop)
+    void check_disk_space(int64_t now_ms);
+
+    // From a pipeline thread: run stop() on auto_stop_thread_ (once)
+    bool request_auto_stop();
+
+    // Raise (start) or restore (stop, failed start) the session's scheduling priority
+    void set_recording_priority(bool recording);
+
+    // Open the proxy encoder + muxer after the main ones; false = no proxy
+    bool start_proxy(const EncoderProfile& main_profile);
+
+    // Open a DisplayPipeline for every other monitor after the main muxer
+    void start_displays();
+
+    // Mux stage: snapshot the replay ring and write it out on replay_saver_
+    void save_replay_snapshot();
 
     // Shared state
     SessionMachine  machine_;
     SyncManager     sync_;
     ProbeResult     probe_;
     FramePacer      pacer_;      // T038: frame pacing
+    QualityGovernor governor_;   // video-encode stage only
+    bool            adaptive_quality_ = false;
     TelemetryStore  telemetry_;  // T037: live counters
     bool            last_power_ac_ = true; // T042: last known power state
 
@@ -112,9 +422,35 @@ private:
     std::unique_ptr<AudioQueue> audio_queue_;      // microphone
     std::unique_ptr<AudioQueue> loopback_queue_;   // system audio
 
-    // Encode thread
-    std::thread       encode_thread_;
-    std::atomic<bool> encode_running_{ false };
+    // Queues between the encode stages and the mux stage
+    std::unique_ptr<EncodedVideoQueue> encoded_video_queue_;
+    std::unique_ptr<EncodedAudioQueue> encoded_audio_queue_;
+
+    // Dual output (set via set_proxy_output before start)
+    bool                 proxy_enabled_    = false;
+    bool                 proxy_active_     = false;
+    RecordingResolution  proxy_resolution_ = kEfficiencyRecordingResolution;
+    uint32_t             proxy_bitrate_    = 1'000'000;
+    FramePacer           proxy_pacer_;
+    std::unique_ptr<FrameQueue>        proxy_frame_queue_;
+    std::unique_ptr<VideoEncoder>      proxy_encoder_;
+    std::unique_ptr<MuxWriter>         proxy_muxer_;
+    std::unique_ptr<EncodedVideoQueue> encoded_proxy_queue_;
+    std::thread                        proxy_thread_;
+    std::atomic<uint32_t>              proxy_frames_written_{ 0 };
+
+    // Multi-monitor (set via set_multi_monitor before start). Filled by
+    // start() before the stage threads run; the mux stage writes their files.
+    bool     multi_monitor_    = false;
+    uint32_t hw_session_limit_ = 0;
+    std::vector<std::unique_ptr<DisplayPipeline>> displays_;
+
+    // Stage threads
+    std::thread       video_thread_;
+    std::thread       audio_thread_;
+    std::thread       mux_thread_;
+    std::atomic<bool> encode_running_{ false };  // video/audio stages
+    std::atomic<bool> mux_running_   { false };  // mux stage
 
     // Counters (legacy — kept for backwards-compat; TelemetryStore is canonical)
     std::atomic<uint32_t> frames_encoded_{ 0 };
@@ -125,17 +461,109 @@ private:
     std::wstring current_partial_path_;
     SessionDiagnostics diagnostics_;
 
+    // Per-second perf trace: encode stats from the video stage, sampled and
+    // handed to the writer's thread by the mux stage
+    bool                 perf_trace_enabled_ = true;
+    PerfTraceWriter      perf_trace_;
+    PerfTraceAccumulator perf_accum_;
+    PerfTraceCounters    perf_prev_;
+
     // Optional encoder profile override (set via set_encoder_profile before start)
     EncoderProfile pending_profile_;
     bool           pending_profile_high_quality_ = false;
     bool           has_pending_profile_ = false;
 
+    // Live power-profile switching (video-encode stage after start)
+    EncoderProfile requested_profile_;       // session profile before the power clamp
+    EncoderProfile active_profile_;          // what the encoder is running now
+    bool           session_high_quality_ = false;
+    uint32_t       feed_width_  = 0;         // NV12 size the encoder was opened for
+    uint32_t       feed_height_ = 0;
+    std::shared_ptr<const VideoTrackFormat> pending_video_format_;
+    // Encoder device context that GPU-waits on fenced frames (isolated capture only)
+    ComPtr<ID3D11DeviceContext4> gpu_wait_context_;
+
+    CaptureSource  capture_source_;  // set via set_capture_source before start
+
+    // Output container (set via set_output_container before start)
+    MuxContainer   output_container_ = MuxContainer::Mp4;
+    uint32_t       fragment_ms_      = 2000;
+    KeyframeSchedule timed_keyframes_;  // fMP4 fragment / VFR GOP IDR cadence (encode stage)
+    AdaptiveGop    gop_schedule_;         // content-driven IDRs (encode stage)
+    bool           adaptive_gop_     = true;
+    uint32_t       gop_max_seconds_  = 10;
+    bool           gop_adaptive_     = false;  // this session
+    bool           variable_frame_rate_ = false;
+
+    bool           separate_audio_tracks_ = false;
+    AudioCodec     audio_codec_   = AudioCodec::AAC;
+    uint32_t       audio_bitrate_ = 128'000;
+    AacProfile     aac_profile_   = AacProfile::LC;
+    bool           system_track_active_   = false;  // this session muxes system audio separately
+    AudioLatencyMode audio_latency_ = AudioLatencyMode::Auto;
+
+    bool           unbuffered_io_    = false;
+    uint32_t       io_chunk_mb_      = 4;
+    bool           preallocate_      = false;
+    bool           keyframe_index_   = true;
+    uint32_t       expected_minutes_ = 0;
+
+    // Segment rotation (set via set_segment_limits before start; mux stage)
+    SegmentLimits  segment_limits_;
+    SegmentPolicy  segments_;
+    MuxConfig      mux_cfg_;              // reused for every segment
+
+    // Disk space (mux stage). Auto-stops (low disk, encoder lost on a power
+    // switch) cannot join a pipeline thread from itself, so they run stop()
+    // on auto_stop_thread_.
+    DiskSpaceThresholds disk_thresholds_;
+    DiskSpaceMonitor    disk_monitor_;
+    uint64_t            closed_segment_bytes_ = 0;
+    std::atomic<bool>   auto_stop_requested_{ false };
+    std::thread         auto_stop_thread_;
+
+    // Live stream (set via set_live_stream before start; fed by the mux stage)
+    NetworkSinkConfig            live_cfg_;
+    std::unique_ptr<NetworkSink> network_sink_;
+
+    // Pre-armed session: arm_mutex_ serializes arm/disarm/start's setup
+    std::mutex        arm_mutex_;
+    std::mutex        arm_thread_mutex_;
+    std::thread       arm_thread_;
+    std::atomic<bool> auto_arm_{ false };
+    bool              have_mic_      = false;
+    bool              have_loopback_ = false;
+
+    // Probe cache: re-validates a cached encoder list off the startup path
+    std::wstring   probe_cache_path_;
+    AdapterPolicy  adapter_policy_ = AdapterPolicy::CapturedDisplay;
+    bool           pipeline_boost_ = true;
+    static constexpr INT kRecordingGpuPriority = 7;  // IDXGIDevice range -7..7
+    std::thread    probe_validator_;
+
+    // Instant replay (set via set_replay_buffer before start; ring owned by the mux stage)
+    uint32_t       replay_seconds_ = 0;
+    bool           replay_active_  = false;
+    ReplayRing<ComPtr<IMFSample>> replay_;
+    std::thread    replay_saver_;
+    std::atomic<bool>     replay_save_requested_{ false };
+    std::atomic<bool>     replay_saving_{ false };
+    std::atomic<uint32_t> replays_saved_{ 0 };
+
     // Callbacks
     StatusCallback on_status_;
     ErrorCallback  on_error_;
+    FinalizedCallback on_finalized_;
+    SummaryCallback   on_summary_;
+
+    // Closes finished MuxWriters (stop, segment rotation) in the background.
+    // Last member: its jobs call back into the ones above.
+    MuxFinalizer   finalizer_;
 
     void notify_status(const std::wstring& msg);
     void notify_error (const std::wstring& msg);
+    void notify_finalized(const std::wstring& path, bool ok);
+    void log_latency_summary() const;
 };
 
 } // namespace sr
@@ -1,6 +1,8 @@
 #pragma once
 // session_machine.h — State machine for recording session
 // States: Idle -> Recording -> Paused -> Stopping -> Idle
+// Armed: engines pre-initialized while idle (Idle <-> Armed); Start from
+// Armed only opens the file and begins streaming.
 
 #include <cstdint>
 #include <functional>
@@ -11,6 +13,7 @@ namespace sr {
 
 enum class SessionState : uint8_t {
     Idle,
+    Armed,
     Recording,
     Paused,
     Stopping
@@ -19,6 +22,7 @@ enum class SessionState : uint8_t {
 inline const wchar_t* state_name(SessionState s) {
     switch (s) {
         case SessionState::Idle:      return L"Idle";
+        case SessionState::Armed:     return L"Armed";
         case SessionState::Recording: return L"Recording";
         case SessionState::Paused:    return L"Paused";
         case SessionState::Stopping:  return L"Stopping";
@@ -31,7 +35,9 @@ enum class SessionEvent : uint8_t {
     Stop,
     Pause,
     Resume,
-    Finalized  // Stopping -> Idle (after flush completes)
+    Finalized, // Stopping -> Idle (after flush completes)
+    Arm,       // Idle -> Armed (engines initialized)
+    Disarm     // Armed -> Idle (engines released)
 };
 
 inline const wchar_t* event_name(SessionEvent e) {
@@ -41,6 +47,8 @@ inline const wchar_t* event_name(SessionEvent e) {
         case SessionEvent::Pause:     return L"Pause";
         case SessionEvent::Resume:    return L"Resume";
         case SessionEvent::Finalized: return L"Finalized";
+        case SessionEvent::Arm:       return L"Arm";
+        case SessionEvent::Disarm:    return L"Disarm";
         default:                      return L"Unknown";
     }
 }
@@ -68,11 +76,23 @@ public:
             case SessionState::Idle:
                 if (event == SessionEvent::Start) {
                     new_state = SessionState::Recording;
+                } else if (event == SessionEvent::Arm) {
+                    new_state = SessionState::Armed;
                 } else {
                     return false; // Invalid
                 }
                 break;
 
+            case SessionState::Armed:
+                if (event == SessionEvent::Start) {
+                    new_state = SessionState::Recording;
+                } else if (event == SessionEvent::Disarm) {
+                    new_state = SessionState::Idle;
+                } else {
+                    return false;
+                }
+                break;
+
             case SessionState::Recording:
                 if (event == SessionEvent::Stop) {
                     new_state = SessionState::Stopping;
@@ -122,6 +142,7 @@ public:
     }
 
     bool is_idle()      const { return state() == SessionState::Idle; }
+    bool is_armed()     const { return state() == SessionState::Armed; }
     bool is_recording() const { return state() == SessionState::Recording; }
     bool is_paused()    const { return state() == SessionState::Paused; }
     bool is_stopping()  const { return state() == SessionState::Stopping; }
@@ -0,0 +1,461 @@
+// transcode_queue.cpp — Background re-encode of finished recordings
+// See transcode_queue.h for the job pipeline and scheduling rules.
+
+#include "controller/transcode_queue.h"
+#include "capture/surface_ring.h"
+#include "encoder/encoder_scheduler.h"
+#include "encoder/transcode_plan.h"
+#include "encoder/video_encoder.h"
+#include "storage/keyframe_index.h"
+#include "storage/mux_writer.h"
+#include "storage/storage_manager.h"
+#include "utils/logging.h"
+#include "utils/thread_qos.h"
+
+#include <mfapi.h>
+#include <mfidl.h>
+#include <mfreadwrite.h>
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <optional>
+#include <thread>
+#include <utility>
+
+#pragma comment(lib, "mfplat.lib")
+#pragma comment(lib, "mfreadwrite.lib")
+#pragma comment(lib, "mfuuid.lib")
+
+namespace sr {
+
+namespace {
+
+constexpr INT    kTranscodeGpuPriority = -7;   // IDXGIDevice range -7..7: behind everything
+constexpr size_t kTranscodeRingSize    = SurfaceRing::kMaxSlots;   // encoder input textures in flight
+constexpr auto   kTranscodeSlotWait    = std::chrono::seconds(2);  // encoder holding every slot = stuck
+
+enum class StreamRole : uint8_t { Ignored, Video, MainAudio, SystemAudio };
+
+struct JobStream {
+    DWORD      index = 0;
+    StreamRole role  = StreamRole::Ignored;
+    bool       done  = false;
+};
+
+struct JobAudio {
+    uint32_t sample_rate = 48000;
+    uint16_t channels    = 2;
+};
+
+// PCM 16-bit at the stream's own rate and channel count; the muxer's AAC
+// encoder takes 44.1 / 48 kHz mono or stereo, which is what we record
+bool select_pcm_audio(IMFSourceReader* reader, DWORD stream, JobAudio& out) {
+    ComPtr<IMFMediaType> pcm;
+    HRESULT hr = MFCreateMediaType(&pcm);
+    if (SUCCEEDED(hr)) hr = pcm->SetGUID(MF_MT_MAJOR_TYPE, MFMediaType_Audio);
+    if (SUCCEEDED(hr)) hr = pcm->SetGUID(MF_MT_SUBTYPE, MFAudioFormat_PCM);
+    if (SUCCEEDED(hr)) hr = pcm->SetUINT32(MF_MT_AUDIO_BITS_PER_SAMPLE, 16);
+    if (SUCCEEDED(hr)) hr = reader->SetStreamSelection(stream, TRUE);
+    if (SUCCEEDED(hr)) hr = reader->SetCurrentMediaType(stream, nullptr, pcm.Get());
+    ComPtr<IMFMediaType> actual;
+    if (SUCCEEDED(hr)) hr = reader->GetCurrentMediaType(stream, &actual);
+    if (FAILED(hr)) {
+        SR_LOG_WARN(L"Transcode: audio stream %u cannot be decoded to PCM (0x%08X); skipped", stream, hr);
+        reader->SetStreamSelection(stream, FALSE);
+        return false;
+    }
+    out.sample_rate = MFGetAttributeUINT32(actual.Get(), MF_MT_AUDIO_SAMPLES_PER_SECOND, 48000);
+    out.channels    = static_cast<uint16_t>(MFGetAttributeUINT32(actual.Get(), MF_MT_AUDIO_NUM_CHANNELS, 2));
+    return true;
+}
+
+// Advanced video processing on the decoder's device: scaling and the
+// conversion to NV12 happen on the GPU, samples carry DXGI buffers
+bool select_nv12_video(IMFSourceReader* reader, DWORD stream, uint32_t width, uint32_t height) {
+    ComPtr<IMFMediaType> nv12;
+    HRESULT hr = MFCreateMediaType(&nv12);
+    if (SUCCEEDED(hr)) hr = nv12->SetGUID(MF_MT_MAJOR_TYPE, MFMediaType_Video);
+    if (SUCCEEDED(hr)) hr = nv12->SetGUID(MF_MT_SUBTYPE, MFVideoFormat_NV12);
+    if (SUCCEEDED(hr)) hr = MFSetAttributeSize(nv12.Get(), MF_MT_FRAME_SIZE, width, height);
+    if (SUCCEEDED(hr)) hr = reader->SetStreamSelection(stream, TRUE);
+    if (SUCCEEDED(hr)) hr = reader->SetCurrentMediaType(stream, nullptr, nv12.Get());
+    if (FAILED(hr)) {
+        SR_LOG_ERROR(L"Transcode: NV12 %ux%u decoder output refused: 0x%08X", width, height, hr);
+        return false;
+    }
+    return true;
+}
+
+// Current COM refcount; stable when only the ring holds the texture
+ULONG ref_count(IUnknown* obj) {
+    obj->AddRef();
+    return obj->Release();
+}
+
+// Best effort: a cancelled or failed job leaves no rendition behind
+void remove_rendition(const std::wstring& partial_path) {
+    const std::wstring final_path = StorageManager::partialToFinal(partial_path);
+    DeleteFileW(partial_path.c_str());
+    DeleteFileW(final_path.c_str());
+    DeleteFileW(KeyframeIndex::sidecar_path(final_path).c_str());
+}
+
+} // namespace
+
+bool TranscodeQueue::start(uint32_t concurrent_jobs, const std::wstring& probe_cache_path) {
+    if (running()) return true;
+    const HRESULT hr = MFStartup(MF_VERSION);
+    if (FAILED(hr)) {
+        SR_LOG_ERROR(L"Transcode: MFStartup failed: 0x%08X", hr);
+        return false;
+    }
+    probe_cache_path_ = probe_cache_path;
+    workers_allowed_  = transcode_worker_count(concurrent_jobs, 0);
+    stopping_.store(false, std::memory_order_release);
+    for (uint32_t i = 0; i < workers_allowed_; ++i) {
+        workers_.emplace_back(&TranscodeQueue::worker_loop, this, i);
+    }
+    return true;
+}
+
+void TranscodeQueue::stop() {
+    if (!running()) return;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_.store(true, std::memory_order_release);
+        if (!jobs_.empty()) SR_LOG_INFO(L"Transcode: %zu queued job(s) dropped", jobs_.size());
+        jobs_.clear();
+    }
+    cv_.notify_all();
+    for (auto& t : workers_) {
+        if (t.joinable()) t.join();
+    }
+    workers_.clear();
+    {
+        std::lock_guard<std::mutex> lock(device_mutex_);
+        probe_        = ProbeResult{};
+        device_ready_ = device_failed_ = false;
+    }
+    MFShutdown();
+}
+
+void TranscodeQueue::enqueue(TranscodeJob job) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        SR_LOG_INFO(L"Transcode: queued '%s' -> %s", job.source.c_str(), job.rendition.tag.c_str());
+        jobs_.push_back(std::move(job));
+    }
+    cv_.notify_one();
+}
+
+size_t TranscodeQueue::pending() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return jobs_.size();
+}
+
+bool TranscodeQueue::ensure_device() {
+    std::lock_guard<std::mutex> lock(device_mutex_);
+    if (device_ready_ || device_failed_) return device_ready_;
+    // No monitor to follow: the adapter with the cheapest media engines
+    if (!EncoderProbe::run(probe_, probe_cache_path_, AdapterPolicy::PreferIntel)) {
+        SR_LOG_ERROR(L"Transcode: D3D11 device creation failed; jobs will fail");
+        device_failed_ = true;
+        return false;
+    }
+    set_gpu_thread_priority(probe_.d3d_device.Get(), kTranscodeGpuPriority);
+    workers_allowed_ = transcode_worker_count(workers_allowed_,
+                                              hw_encoder_session_limit(probe_.adapter_id.vendor_id));
+    device_ready_ = true;
+    SR_LOG_INFO(L"Transcode: device on %s (%s encoder), %u concurrent job(s)",
+                probe_.adapter_name.c_str(), probe_.hw_encoder_available ? L"hardware" : L"software",
+                workers_allowed_);
+    return true;
+}
+
+bool TranscodeQueue::wait_while_paused() {
+    bool logged = false;
+    while (paused_ && paused_()) {
+        if (!logged) {
+            SR_LOG_INFO(L"Transcode: waiting while a recording is active");
+            logged = true;
+        }
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (cv_.wait_for(lock, std::chrono::milliseconds(250),
+                         [this] { return stopping_.load(std::memory_order_acquire); })) {
+            return false;
+        }
+    }
+    return !stopping_.load(std::memory_order_acquire);
+}
+
+// ---------------------------------------------------------------------------
+// Worker — background CPU and I/O priority for its whole life. The device is
+// created when the first job arrives; workers above the adapter's allowance
+// exit then.
+// ---------------------------------------------------------------------------
+void TranscodeQueue::worker_loop(uint32_t index) {
+    SetThreadPriority(GetCurrentThread(), THREAD_MODE_BACKGROUND_BEGIN);
+    const HRESULT co = CoInitializeEx(nullptr, COINIT_MULTITHREADED);
+    bool device_checked = false;
+
+    for (;;) {
+        TranscodeJob job;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            cv_.wait(lock, [this] { return stopping_.load(std::memory_order_acquire) || !jobs_.empty(); });
+            if (stopping_.load(std::memory_order_acquire)) break;
+            if (!device_checked) {
+                lock.unlock();
+                ensure_device();
+                device_checked = true;
+                if (index >= workers_allowed_) break;
+                continue;
+            }
+            job = std::move(jobs_.front());
+            jobs_.pop_front();
+        }
+        const bool ok = run_job(job);
+        if (stopping_.load(std::memory_order_acquire)) break;   // cancelled, not failed
+        if (on_done_) on_done_(job, ok);
+    }
+
+    if (SUCCEEDED(co)) CoUninitialize();
+}
+
+bool TranscodeQueue::run_job(const TranscodeJob& job) {
+    if (!wait_while_paused()) return false;
+    if (!ensure_device()) return false;
+    const auto started = std::chrono::steady_clock::now();
+
+    ComPtr<IMFAttributes> reader_attrs;
+    HRESULT hr = MFCreateAttributes(&reader_attrs, 3);
+    if (SUCCEEDED(hr)) {
+        reader_attrs->SetUnknown(MF_SOURCE_READER_D3D_MANAGER, probe_.dxgi_device_manager.Get());
+        reader_attrs->SetUINT32(MF_SOURCE_READER_ENABLE_ADVANCED_VIDEO_PROCESSING, TRUE);
+        reader_attrs->SetUINT32(MF_READWRITE_ENABLE_HARDWARE_TRANSFORMS, TRUE);
+    }
+    ComPtr<IMFSourceReader> reader;
+    if (SUCCEEDED(hr)) hr = MFCreateSourceReaderFromURL(job.source.c_str(), reader_attrs.Get(), &reader);
+    if (FAILED(hr)) {
+        SR_LOG_ERROR(L"Transcode: cannot open '%s': 0x%08X", job.source.c_str(), hr);
+        return false;
+    }
+
+    // Streams: the first video stream, up to two audio tracks (main, system)
+    std::vector<JobStream> streams;
+    ComPtr<IMFMediaType> native_video;
+    size_t video_slot = SIZE_MAX;
+    std::array<JobAudio, 2> audio{};
+    uint32_t audio_tracks = 0;
+    for (DWORD i = 0;; ++i) {
+        ComPtr<IMFMediaType> native;
+        hr = reader->GetNativeMediaType(i, 0, &native);
+        if (hr == MF_E_INVALIDSTREAMNUMBER) break;
+        if (FAILED(hr)) {
+            SR_LOG_ERROR(L"Transcode: GetNativeMediaType(%u) failed: 0x%08X", i, hr);
+            return false;
+        }
+        GUID major{};
+        native->GetGUID(MF_MT_MAJOR_TYPE, &major);
+        JobStream s;
+        s.index = i;
+        if (major == MFMediaType_Video && !native_video) {
+            s.role = StreamRole::Video;
+            native_video = native;
+            video_slot = streams.size();
+        } else if (major == MFMediaType_Audio && audio_tracks < 2 &&
+                   select_pcm_audio(reader.Get(), i, audio[audio_tracks])) {
+            s.role = audio_tracks++ == 0 ? StreamRole::MainAudio : StreamRole::SystemAudio;
+        } else {
+            reader->SetStreamSelection(i, FALSE);
+            s.done = true;
+        }
+        streams.push_back(s);
+    }
+    if (!native_video) {
+        SR_LOG_ERROR(L"Transcode: '%s' has no video stream", job.source.c_str());
+        return false;
+    }
+
+    UINT32 src_width = 0, src_height = 0, fps_num = 30, fps_den = 1;
+    MFGetAttributeSize(native_video.Get(), MF_MT_FRAME_SIZE, &src_width, &src_height);
+    MFGetAttributeRatio(native_video.Get(), MF_MT_FRAME_RATE, &fps_num, &fps_den);
+    const uint32_t src_bitrate = MFGetAttributeUINT32(native_video.Get(), MF_MT_AVG_BITRATE, 0);
+    const TranscodeSize src_size{ src_width, src_height };
+    const TranscodeSize out_size = transcode_frame_size(src_width, src_height,
+                                                        job.rendition.max_width, job.rendition.max_height);
+    if (out_size.width == 0) {
+        SR_LOG_ERROR(L"Transcode: '%s' reports no frame size", job.source.c_str());
+        return false;
+    }
+
+    // Encoder first: the software fallback may settle on another size
+    EncoderProfile prof;
+    prof.width       = out_size.width;
+    prof.height      = out_size.height;
+    prof.fps         = (std::max)(1u, (fps_num + (std::max)(1u, fps_den) / 2) / (std::max)(1u, fps_den));
+    prof.bitrate_bps = transcode_bitrate(job.rendition.bitrate_bps, src_bitrate, src_size, out_size);
+    prof.gop_frames  = prof.fps * 2;   // seekable uploads: an IDR every two seconds
+    prof.low_latency = false;
+    prof.codec       = job.rendition.codec;
+    VideoEncoder encoder;
+    encoder.set_power_tuning(true, true);   // offline: the quality presets, not the fast ones
+    if (!encoder.initialize(prof, probe_.dxgi_device_manager.Get(), probe_.d3d_device.Get(),
+                            probe_.d3d_context.Get())) {
+        SR_LOG_ERROR(L"Transcode: no encoder for %ux%u", prof.width, prof.height);
+        return false;
+    }
+    const uint32_t width  = encoder.output_width();
+    const uint32_t height = encoder.output_height();
+    if (!select_nv12_video(reader.Get(), streams[video_slot].index, width, height)) return false;
+
+    D3D11_TEXTURE2D_DESC td{};
+    td.Width            = width;
+    td.Height           = height;
+    td.MipLevels        = 1;
+    td.ArraySize        = 1;
+    td.Format           = DXGI_FORMAT_NV12;
+    td.SampleDesc.Count = 1;
+    td.Usage            = D3D11_USAGE_DEFAULT;
+    td.BindFlags        = D3D11_BIND_RENDER_TARGET | D3D11_BIND_VIDEO_ENCODER;
+    // Slots come back once the encoder's input sample lets go of the texture
+    // (SamplePool drops its DXGI buffer); the MFT may hold several at once
+    std::array<ComPtr<ID3D11Texture2D>, kTranscodeRingSize> ring;
+    std::array<ULONG, kTranscodeRingSize> idle_refs{};
+    for (size_t i = 0; i < ring.size(); ++i) {
+        hr = probe_.d3d_device->CreateTexture2D(&td, nullptr, &ring[i]);
+        if (FAILED(hr)) {
+            SR_LOG_ERROR(L"Transcode: CreateTexture2D(NV12 %ux%u) failed: 0x%08X", width, height, hr);
+            return false;
+        }
+        idle_refs[i] = ref_count(ring[i].Get());
+    }
+    SurfaceRing slots;
+    slots.reset(ring.size());
+    auto held = [&](uint32_t i) { return ref_count(ring[i].Get()) > idle_refs[i]; };
+
+    MuxConfig mux;
+    mux.video_width    = width;
+    mux.video_height   = height;
+    mux.video_fps_num  = encoder.output_fps();
+    mux.video_bitrate  = encoder.output_bitrate();
+    mux.video_codec    = encoder.codec();
+    mux.variable_frame_rate = true;   // durations follow the source's timestamps
+    encoder.sequence_header(mux.video_sequence_header);
+    mux.audio_sample_rate = audio[0].sample_rate;
+    mux.audio_channels    = audio[0].channels;
+    mux.system_audio_track       = audio_tracks > 1;
+    mux.system_audio_sample_rate = audio[1].sample_rate;
+    mux.system_audio_channels    = audio[1].channels;
+    MuxWriter muxer;
+    if (!muxer.initialize(job.partial_path, StorageManager::partialToFinal(job.partial_path), mux)) {
+        SR_LOG_ERROR(L"Transcode: cannot create '%s'", job.partial_path.c_str());
+        return false;
+    }
+
+    uint32_t frames = 0;
+    auto write = [&](ComPtr<IMFSample>& encoded) {
+        if (encoded && muxer.write_video(encoded.Get())) ++frames;
+        encoded.Reset();
+    };
+
+    bool ok = true, cancelled = false;
+    for (;;) {
+        bool all_done = true;
+        for (const JobStream& s : streams) all_done = all_done && s.done;
+        if (all_done) break;
+        if (!wait_while_paused()) {
+            cancelled = true;
+            break;
+        }
+
+        DWORD stream = 0, flags = 0;
+        LONGLONG ts = 0;
+        ComPtr<IMFSample> sample;
+        hr = reader->ReadSample(static_cast<DWORD>(MF_SOURCE_READER_ANY_STREAM), 0,
+                                &stream, &flags, &ts, &sample);
+        if (FAILED(hr) || (flags & MF_SOURCE_READERF_ERROR)) {
+            SR_LOG_ERROR(L"Transcode: ReadSample failed: 0x%08X (flags 0x%X)", hr, flags);
+            ok = false;
+            break;
+        }
+        JobStream* js = nullptr;
+        for (JobStream& s : streams) {
+            if (s.index == stream) js = &s;
+        }
+        if (js && sample && js->role == StreamRole::Video) {
+            ComPtr<IMFMediaBuffer> buffer;
+            ComPtr<IMFDXGIBuffer>  dxgi;
+            ComPtr<ID3D11Texture2D> frame;
+            UINT subresource = 0;
+            hr = sample->GetBufferByIndex(0, &buffer);
+            if (SUCCEEDED(hr)) hr = buffer.As(&dxgi);
+            if (SUCCEEDED(hr)) hr = dxgi->GetResource(IID_PPV_ARGS(&frame));
+            if (SUCCEEDED(hr)) hr = dxgi->GetSubresourceIndex(&subresource);
+            if (FAILED(hr)) {
+                // Only reachable without a hardware decoder for the codec
+                SR_LOG_ERROR(L"Transcode: decoder did not return GPU frames (0x%08X)", hr);
+                ok = false;
+                break;
+            }
+            // Decoder surfaces are often padded (1088 lines) or array slices
+            const D3D11_BOX box{ 0, 0, 0, width, height, 1 };
+            // Every slot still in the encoder: drain its output until one returns
+            std::optional<uint32_t> slot = slots.acquire(held);
+            const auto give_up = std::chrono::steady_clock::now() + kTranscodeSlotWait;
+            while (!slot && !stopping_.load() && std::chrono::steady_clock::now() < give_up) {
+                bool drained = false;
+                for (ComPtr<IMFSample> ready; encoder.take_output(ready);) {
+                    write(ready);
+                    drained = true;
+                }
+                if (!drained) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                slot = slots.acquire(held);
+            }
+            if (!slot) {
+                if (stopping_.load()) {
+                    cancelled = true;
+                } else {
+                    SR_LOG_ERROR(L"Transcode: encoder kept all %zu input textures", ring.size());
+                    ok = false;
+                }
+                break;
+            }
+            ID3D11Texture2D* input = ring[*slot].Get();
+            probe_.d3d_context->CopySubresourceRegion(input, 0, 0, 0, 0, frame.Get(), subresource, &box);
+            ComPtr<IMFSample> encoded;
+            const bool sent = encoder.encode_frame(input, ts, encoded);
+            slots.publish(*slot);
+            if (sent) write(encoded);
+            for (ComPtr<IMFSample> ready; encoder.take_output(ready);) write(ready);
+        } else if (js && sample && js->role != StreamRole::Ignored) {
+            muxer.write_audio(sample.Get(), js->role == StreamRole::SystemAudio ? AudioTrack::System
+                                                                                : AudioTrack::Main);
+        }
+        if (js && (flags & MF_SOURCE_READERF_ENDOFSTREAM)) js->done = true;
+    }
+
+    if (ok && !cancelled) {
+        std::vector<ComPtr<IMFSample>> leftover;
+        encoder.flush(leftover);
+        for (auto& s : leftover) write(s);
+    }
+    encoder.shutdown();
+    ok = muxer.finalize() && ok && !cancelled && frames > 0;
+    if (!ok) {
+        remove_rendition(job.partial_path);
+        if (cancelled) {
+            SR_LOG_INFO(L"Transcode of '%s' cancelled", job.source.c_str());
+        } else {
+            SR_LOG_ERROR(L"Transcode of '%s' failed after %u frames", job.source.c_str(), frames);
+        }
+        return false;
+    }
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+    SR_LOG_INFO(L"Transcode: '%s' -> %ux%u %s @ %u kbps, %u frames in %.1f s",
+                StorageManager::partialToFinal(job.partial_path).c_str(), width, height,
+                video_codec_label(encoder.codec()), encoder.output_bitrate() / 1000, frames, seconds);
+    return true;
+}
+
+} // namespace sr
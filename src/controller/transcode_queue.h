@@ -0,0 +1,97 @@
+#pragma once
+// transcode_queue.h — Background re-encode of finished recordings
+//
+// Each job turns a finished .mp4 into a second rendition (smaller and/or
+// another codec) next to it, e.g. <name>_720p.mp4:
+//
+//   IMFSourceReader (hardware decoder + video processor on the queue's
+//   D3D11 device: decode, scale, NV12) -> texture ring -> VideoEncoder ->
+//   MuxWriter; audio is decoded to PCM and re-encoded by the muxer
+//
+// Frames stay GPU textures from decoder to encoder. The queue creates its
+// own device (first job, via EncoderProbe) so it never shares an immediate
+// context with a recording, and runs at the lowest CPU, I/O and GPU priority.
+// Workers check the pause condition (set_pause_condition, e.g. "a session is
+// recording") between samples and wait while it holds, so a running job only
+// keeps its decoder and encoder open.
+
+#include <windows.h>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "encoder/encoder_probe.h"
+#include "utils/video_codec.h"
+
+namespace sr {
+
+struct TranscodeRendition {
+    std::wstring    tag         = L"720p";   // file name suffix
+    uint32_t        max_width   = 1280;      // fit box, 0 = unconstrained; never upscales
+    uint32_t        max_height  = 720;
+    uint32_t        bitrate_bps = 0;         // H.264-equivalent; 0 = the source's bits per pixel
+    CodecPreference codec       = CodecPreference::H264;
+};
+
+struct TranscodeJob {
+    std::wstring       source;        // finished recording
+    std::wstring       partial_path;  // StorageManager::transcodeFilename(source, rendition.tag)
+    TranscodeRendition rendition;
+};
+
+class TranscodeQueue {
+public:
+    using PauseCondition = std::function<bool()>;
+    using DoneCallback   = std::function<void(const TranscodeJob& job, bool ok)>;
+
+    TranscodeQueue() = default;
+    ~TranscodeQueue() { stop(); }
+
+    TranscodeQueue(const TranscodeQueue&)            = delete;
+    TranscodeQueue& operator=(const TranscodeQueue&) = delete;
+
+    // Before start(): polled by the workers; true = wait
+    void set_pause_condition(PauseCondition paused) { paused_ = std::move(paused); }
+    // Worker thread; ok = the rendition was finalized at its .mp4 path
+    void set_done_callback(DoneCallback on_done) { on_done_ = std::move(on_done); }
+
+    // `concurrent_jobs` is capped by transcode_worker_count once the device
+    // is known. `probe_cache_path` as for SessionController.
+    bool start(uint32_t concurrent_jobs, const std::wstring& probe_cache_path = {});
+
+    // Cancels running jobs (their output is removed) and drops queued ones
+    void stop();
+
+    void   enqueue(TranscodeJob job);
+    size_t pending() const;
+    bool   running() const { return !workers_.empty(); }
+
+private:
+    void worker_loop(uint32_t index);
+    bool ensure_device();
+    bool run_job(const TranscodeJob& job);
+    bool wait_while_paused();              // false once stopping
+
+    PauseCondition            paused_;
+    DoneCallback              on_done_;
+    std::wstring              probe_cache_path_;
+    uint32_t                  workers_allowed_ = 1;
+
+    std::mutex                device_mutex_;
+    ProbeResult               probe_;
+    bool                      device_ready_  = false;
+    bool                      device_failed_ = false;
+
+    mutable std::mutex        mutex_;
+    std::condition_variable   cv_;
+    std::deque<TranscodeJob>  jobs_;
+    std::vector<std::thread>  workers_;
+    std::atomic<bool>         stopping_{ false };
+};
+
+} // namespace sr
@@ -0,0 +1,72 @@
+#pragma once
+// adapter_pairing.h — Capture/encode adapter pairing for AdapterPolicy::LowestContention
+//
+// On a hybrid machine the adapter that scans out the captured monitor also
+// runs DWM composition and the foreground app, so its video engines are the
+// busiest. Encoding elsewhere costs one NV12 transfer per frame across
+// adapters (shared surface + shared fence, see CaptureEngine), which is
+// cheaper than queueing behind the compositor. Each pairing gets a
+// contention cost; the cheapest wins, ties go to the vendor preference
+// (EncoderProbe::adapter_preference_score).
+//
+// Contention is estimated from topology (who drives a display, who has a HW
+// encoder), not from live engine utilisation.
+
+#include <cstdint>
+#include <vector>
+
+namespace sr {
+
+struct AdapterPairingCandidate {
+    uint32_t vendor_id         = 0;
+    bool     is_software       = false;
+    bool     drives_display    = false;  // scans out the captured monitor
+    bool     drives_any_output = false;  // has any output (composition load)
+    bool     hw_encoder        = false;  // HW H.264 MFT bound to this adapter
+    int      preference        = 0;      // adapter_preference_score, tie-break
+};
+
+constexpr uint32_t kPairingNoEncoderCost    = 1000;  // encode falls back to the SW MFT
+constexpr uint32_t kPairingDisplayCost      = 3;     // encodes next to composition / scan-out
+constexpr uint32_t kPairingCrossAdapterCost = 2;     // per-frame NV12 transfer + fence
+
+struct AdapterPairing {
+    int      capture = -1;   // WGC + conversion; == encode unless split()
+    int      encode  = -1;   // encoder device; -1 = no hardware adapter
+    uint32_t cost    = 0;
+
+    bool split() const { return capture >= 0 && encode >= 0 && capture != encode; }
+};
+
+// Capture stays on the display adapter (WGC's own; no copy before we see the
+// frame); the encode adapter is the cheapest hardware adapter for it. With
+// no known display adapter, capture follows the encoder.
+inline AdapterPairing choose_adapter_pairing(const std::vector<AdapterPairingCandidate>& adapters) {
+    int display = -1;
+    for (size_t i = 0; i < adapters.size(); ++i) {
+        if (!adapters[i].is_software && adapters[i].drives_display) {
+            display = static_cast<int>(i);
+            break;
+        }
+    }
+
+    AdapterPairing best;
+    for (size_t i = 0; i < adapters.size(); ++i) {
+        const AdapterPairingCandidate& a = adapters[i];
+        if (a.is_software) continue;
+        const int idx = static_cast<int>(i);
+        uint32_t cost = a.hw_encoder ? 0 : kPairingNoEncoderCost;
+        if (a.drives_display || a.drives_any_output) cost += kPairingDisplayCost;
+        if (display >= 0 && idx != display) cost += kPairingCrossAdapterCost;
+
+        if (best.encode < 0 || cost < best.cost ||
+            (cost == best.cost && a.preference > adapters[best.encode].preference)) {
+            best.encode = idx;
+            best.cost   = cost;
+        }
+    }
+    best.capture = best.encode >= 0 && display >= 0 ? display : best.encode;
+    return best;
+}
+
+} // namespace sr
@@ -0,0 +1,242 @@
+// async_mft_pump.cpp — BeginGetEvent-driven NeedInput/HaveOutput handling for async MFTs
+
+#include "encoder/async_mft_pump.h"
+#include "encoder/sample_pool.h"
+#include "utils/logging.h"
+
+#include <mferror.h>
+#include <chrono>
+
+namespace sr {
+
+AsyncMftPump* AsyncMftPump::start(IMFTransform* mft, bool mft_provides_samples,
+                                  uint32_t output_sample_size, SamplePool* output_pool)
+{
+    if (!mft) return nullptr;
+
+    auto* pump = new AsyncMftPump();
+    pump->mft_ = mft;
+    pump->provides_samples_ = mft_provides_samples;
+    pump->output_size_ = output_sample_size > 0 ? output_sample_size : (1u << 20);
+    if (output_pool) {
+        output_pool->AddRef();
+        pump->output_pool_ = output_pool;
+    }
+    if (FAILED(mft->QueryInterface(IID_PPV_ARGS(&pump->events_))) || !pump->events_) {
+        pump->Release();
+        return nullptr;
+    }
+
+    // A private queue gives the pump its own thread instead of sharing the
+    // MF multithreaded pool with the sink writer and audio resampler.
+    if (SUCCEEDED(MFAllocateWorkQueue(&pump->work_queue_))) {
+        pump->own_queue_ = true;
+    }
+
+    const HRESULT hr = pump->events_->BeginGetEvent(pump, nullptr);
+    if (FAILED(hr)) {
+        SR_LOG_WARN(L"Async MFT BeginGetEvent failed: 0x%08X", hr);
+        pump->stop();
+        pump->Release();
+        return nullptr;
+    }
+    return pump;
+}
+
+AsyncMftPump::~AsyncMftPump() {
+    if (own_queue_) MFUnlockWorkQueue(work_queue_);
+    if (output_pool_) output_pool_->Release();
+}
+
+void AsyncMftPump::stop() {
+    {
+        std::lock_guard<std::mutex> lock(state_mutex_);
+        if (stopping_) return;
+        stopping_ = true;
+    }
+    state_cv_.notify_all();
+
+    ComPtr<IMFTransform> mft;
+    {
+        std::lock_guard<std::mutex> lock(mft_mutex_);
+        mft.Swap(mft_);
+    }
+    // Async MFTs must implement IMFShutdown; it completes the pending
+    // BeginGetEvent with MF_E_SHUTDOWN, which releases MF's reference to us.
+    ComPtr<IMFShutdown> shutdown;
+    if (mft && SUCCEEDED(mft.As(&shutdown)) && shutdown) {
+        shutdown->Shutdown();
+    }
+}
+
+bool AsyncMftPump::wait_for_input(uint32_t timeout_ms) {
+    std::unique_lock<std::mutex> lock(state_mutex_);
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+    if (!state_cv_.wait_until(lock, deadline, [this] { return stopping_ || need_input_ > 0; })) {
+        return false;
+    }
+    // Prefer to keep at most kMaxInFlight frames queued, but an MFT with a
+    // deeper lookahead still gets its input once the deadline passes.
+    state_cv_.wait_until(lock, deadline, [this] { return stopping_ || in_flight() < kMaxInFlight; });
+    if (stopping_) return false;
+    --need_input_;
+    return true;
+}
+
+HRESULT AsyncMftPump::process_input(IMFSample* sample) {
+    std::lock_guard<std::mutex> lock(mft_mutex_);
+    if (!mft_) return MF_E_SHUTDOWN;
+    const HRESULT hr = mft_->ProcessInput(0, sample, 0);
+    if (SUCCEEDED(hr)) in_flight_.fetch_add(1, std::memory_order_relaxed);
+    return hr;
+}
+
+bool AsyncMftPump::pop_output(ComPtr<IMFSample>& out) {
+    std::lock_guard<std::mutex> lock(state_mutex_);
+    if (outputs_.empty()) return false;
+    out = std::move(outputs_.front());
+    outputs_.pop_front();
+    return true;
+}
+
+void AsyncMftPump::begin_drain() {
+    std::lock_guard<std::mutex> lock(state_mutex_);
+    drain_complete_ = false;
+}
+
+bool AsyncMftPump::wait_drained(uint32_t timeout_ms) {
+    std::unique_lock<std::mutex> lock(state_mutex_);
+    state_cv_.wait_for(lock, std::chrono::milliseconds(timeout_ms),
+                       [this] { return drain_complete_ || stopping_; });
+    return drain_complete_;
+}
+
+// Pull one encoded sample in response to METransformHaveOutput
+void AsyncMftPump::process_one_output() {
+    std::lock_guard<std::mutex> lock(mft_mutex_);
+    if (!mft_) return;
+
+    MFT_OUTPUT_DATA_BUFFER out_buf{};
+    DWORD status = 0;
+    if (!provides_samples_) {
+        ComPtr<IMFSample> sample;
+        ComPtr<IMFMediaBuffer> buffer;
+        const bool ok = output_pool_
+            ? output_pool_->acquire(output_size_, sample)
+            : SUCCEEDED(MFCreateSample(&sample)) &&
+              SUCCEEDED(MFCreateMemoryBuffer(output_size_, &buffer)) &&
+              SUCCEEDED(sample->AddBuffer(buffer.Get()));
+        if (!ok) {
+            SR_LOG_ERROR(L"Async MFT: failed to allocate output sample");
+            return;
+        }
+        out_buf.pSample = sample.Detach();
+    }
+
+    const HRESULT hr = mft_->ProcessOutput(0, 1, &out_buf, &status);
+    if (out_buf.pEvents) out_buf.pEvents->Release();
+
+    if (SUCCEEDED(hr) && out_buf.pSample) {
+        ComPtr<IMFSample> sample;
+        sample.Attach(out_buf.pSample);
+        uint32_t pending = in_flight_.load(std::memory_order_relaxed);
+        while (pending > 0 &&
+               !in_flight_.compare_exchange_weak(pending, pending - 1, std::memory_order_relaxed)) {}
+        output_failures_.store(0, std::memory_order_relaxed);
+        {
+            std::lock_guard<std::mutex> state_lock(state_mutex_);
+            outputs_.push_back(std::move(sample));
+        }
+        state_cv_.notify_all();
+        return;
+    }
+
+    if (out_buf.pSample) out_buf.pSample->Release();
+    if (FAILED(hr) && hr != MF_E_TRANSFORM_NEED_MORE_INPUT) {
+        const uint32_t failures = output_failures_.fetch_add(1, std::memory_order_relaxed) + 1;
+        last_failure_.store(hr, std::memory_order_relaxed);
+        if (failures == 1 || (failures % 120) == 0) {
+            SR_LOG_ERROR(L"Async MFT ProcessOutput failed: 0x%08X (count=%u)", hr, failures);
+        }
+    }
+}
+
+HRESULT STDMETHODCALLTYPE AsyncMftPump::Invoke(IMFAsyncResult* result) {
+    ComPtr<IMFMediaEvent> event;
+    HRESULT hr = events_->EndGetEvent(result, &event);
+    if (FAILED(hr)) {
+        if (hr != MF_E_SHUTDOWN) SR_LOG_WARN(L"Async MFT EndGetEvent failed: 0x%08X", hr);
+        {
+            std::lock_guard<std::mutex> lock(state_mutex_);
+            stopping_ = true;
+        }
+        state_cv_.notify_all();
+        return S_OK;
+    }
+
+    MediaEventType type = MEUnknown;
+    event->GetType(&type);
+    HRESULT status = S_OK;
+    event->GetStatus(&status);
+    if (FAILED(status)) {
+        SR_LOG_WARN(L"Async MFT event %u status failed: 0x%08X", static_cast<unsigned>(type), status);
+    }
+
+    switch (type) {
+        case METransformNeedInput: {
+            std::lock_guard<std::mutex> lock(state_mutex_);
+            ++need_input_;
+            break;
+        }
+        case METransformHaveOutput:
+            process_one_output();
+            break;
+        case METransformDrainComplete: {
+            std::lock_guard<std::mutex> lock(state_mutex_);
+            drain_complete_ = true;
+            break;
+        }
+        default:
+            break;
+    }
+    state_cv_.notify_all();
+
+    {
+        std::lock_guard<std::mutex> lock(state_mutex_);
+        if (stopping_) return S_OK;
+    }
+    hr = events_->BeginGetEvent(this, nullptr);
+    if (FAILED(hr) && hr != MF_E_SHUTDOWN) {
+        SR_LOG_ERROR(L"Async MFT BeginGetEvent re-arm failed: 0x%08X", hr);
+    }
+    return S_OK;
+}
+
+HRESULT STDMETHODCALLTYPE AsyncMftPump::GetParameters(DWORD* flags, DWORD* queue) {
+    *flags = 0;
+    *queue = own_queue_ ? work_queue_ : MFASYNC_CALLBACK_QUEUE_MULTITHREADED;
+    return S_OK;
+}
+
+ULONG STDMETHODCALLTYPE AsyncMftPump::AddRef() {
+    return ref_.fetch_add(1, std::memory_order_relaxed) + 1;
+}
+
+ULONG STDMETHODCALLTYPE AsyncMftPump::Release() {
+    const ULONG refs = ref_.fetch_sub(1, std::memory_order_acq_rel) - 1;
+    if (refs == 0) delete this;
+    return refs;
+}
+
+HRESULT STDMETHODCALLTYPE AsyncMftPump::QueryInterface(REFIID riid, void** ppv) {
+    if (!ppv) return E_POINTER;
+    if (riid == __uuidof(IUnknown) || riid == __uuidof(IMFAsyncCallback)) {
+        *ppv = static_cast<IMFAsyncCallback*>(this);
+        AddRef();
+        return S_OK;
+    }
+    *ppv = nullptr;
+    return E_NOINTERFACE;
+}
+
+} // namespace sr
@@ -0,0 +1,109 @@
+#pragma once
+// async_mft_pump.h — Event-driven driver for asynchronous (hardware) MFTs
+//
+// Async MFTs signal METransformNeedInput / METransformHaveOutput through
+// IMFMediaEventGenerator. Instead of polling GetEvent, AsyncMftPump keeps one
+// BeginGetEvent outstanding on a private MF work queue (one dedicated thread):
+//   - NeedInput   -> adds an input credit and wakes wait_for_input()
+//   - HaveOutput  -> calls ProcessOutput on the pump thread and queues the sample
+//   - DrainComplete -> wakes wait_drained()
+// The encode stage therefore submits a frame and returns without waiting for
+// its output; up to kMaxInFlight frames are pipelined inside the encoder.
+//
+// When the MFT wants caller-allocated output, the samples come from the
+// encoder's SamplePool.
+//
+// COM lifetime: MF holds a reference while a BeginGetEvent is pending, so the
+// pump is heap-allocated and ref-counted. Call stop() before releasing it.
+
+#include <windows.h>
+#include <mfapi.h>
+#include <mfidl.h>
+#include <mftransform.h>
+#include <wrl/client.h>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+
+namespace sr {
+
+using Microsoft::WRL::ComPtr;
+
+class SamplePool;
+
+class AsyncMftPump : public IMFAsyncCallback {
+public:
+    static constexpr uint32_t kMaxInFlight = 3;   // inputs submitted without output yet
+
+    // Creates the pump (refcount 1) and arms the first BeginGetEvent.
+    // Returns nullptr if the MFT exposes no event generator. `output_pool`
+    // (kept referenced) supplies output samples when the MFT does not.
+    static AsyncMftPump* start(IMFTransform* mft, bool mft_provides_samples,
+                               uint32_t output_sample_size, SamplePool* output_pool);
+
+    // Cancel the pending event request, shut down the MFT's event queue and
+    // drop references to the MFT. Outputs already queued stay available.
+    void stop();
+
+    // Block until the MFT requested input (and, within the timeout, fewer than
+    // kMaxInFlight frames are pending). Consumes one input credit on success.
+    bool wait_for_input(uint32_t timeout_ms);
+
+    // Serialised ProcessInput against the pump's ProcessOutput calls
+    HRESULT process_input(IMFSample* sample);
+
+    // Pop the oldest encoded sample if one is ready (non-blocking)
+    bool pop_output(ComPtr<IMFSample>& out);
+
+    // After MFT_MESSAGE_COMMAND_DRAIN: wait until METransformDrainComplete
+    bool wait_drained(uint32_t timeout_ms);
+    void begin_drain();
+
+    uint32_t in_flight()       const { return in_flight_.load(std::memory_order_relaxed); }
+    uint32_t output_failures() const { return output_failures_.load(std::memory_order_relaxed); }
+    HRESULT  last_failure()    const { return last_failure_.load(std::memory_order_relaxed); }
+    void     clear_output_failures() { output_failures_.store(0, std::memory_order_relaxed); }
+
+    // IUnknown
+    ULONG   STDMETHODCALLTYPE AddRef() override;
+    ULONG   STDMETHODCALLTYPE Release() override;
+    HRESULT STDMETHODCALLTYPE QueryInterface(REFIID riid, void** ppv) override;
+
+    // IMFAsyncCallback
+    HRESULT STDMETHODCALLTYPE GetParameters(DWORD* flags, DWORD* queue) override;
+    HRESULT STDMETHODCALLTYPE Invoke(IMFAsyncResult* result) override;
+
+private:
+    AsyncMftPump() = default;
+    ~AsyncMftPump();
+
+    void process_one_output();
+
+    std::atomic<ULONG> ref_{ 1 };
+    DWORD              work_queue_ = 0;
+    bool               own_queue_  = false;
+
+    // Guards mft_/events_ and serialises ProcessInput/ProcessOutput
+    std::mutex                     mft_mutex_;
+    ComPtr<IMFTransform>           mft_;
+    ComPtr<IMFMediaEventGenerator> events_;
+    bool                           provides_samples_ = true;
+    uint32_t                       output_size_      = 1 << 20;
+    SamplePool*                    output_pool_      = nullptr;   // owned reference
+
+    // Guards the credit / output state below
+    std::mutex                     state_mutex_;
+    std::condition_variable        state_cv_;
+    uint32_t                       need_input_     = 0;
+    bool                           drain_complete_ = false;
+    bool                           stopping_       = false;
+    std::deque<ComPtr<IMFSample>>  outputs_;
+
+    std::atomic<uint32_t>          in_flight_{ 0 };
+    std::atomic<uint32_t>          output_failures_{ 0 };
+    std::atomic<HRESULT>           last_failure_{ S_OK };
+};
+
+} // namespace sr
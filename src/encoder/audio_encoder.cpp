@@ -0,0 +1,236 @@
+// audio_encoder.cpp — Batched PCM -> Opus (or other) encoder MFT (see audio_encoder.h)
+
+#include "encoder/audio_encoder.h"
+#include "utils/logging.h"
+
+#include <mferror.h>
+#include <algorithm>
+#include <cmath>
+
+namespace sr {
+
+namespace {
+
+HRESULT make_pcm_type(const AudioEncoderConfig& cfg, bool is_float, uint32_t bits, IMFMediaType** out) {
+    ComPtr<IMFMediaType> t;
+    HRESULT hr = MFCreateMediaType(&t);
+    if (FAILED(hr)) return hr;
+    const uint32_t block = cfg.channels * (bits / 8);
+    t->SetGUID(MF_MT_MAJOR_TYPE, MFMediaType_Audio);
+    t->SetGUID(MF_MT_SUBTYPE, is_float ? MFAudioFormat_Float : MFAudioFormat_PCM);
+    t->SetUINT32(MF_MT_AUDIO_SAMPLES_PER_SECOND, cfg.sample_rate);
+    t->SetUINT32(MF_MT_AUDIO_NUM_CHANNELS, cfg.channels);
+    t->SetUINT32(MF_MT_AUDIO_BITS_PER_SAMPLE, bits);
+    t->SetUINT32(MF_MT_AUDIO_BLOCK_ALIGNMENT, block);
+    t->SetUINT32(MF_MT_AUDIO_AVG_BYTES_PER_SECOND, cfg.sample_rate * block);
+    t->SetUINT32(MF_MT_ALL_SAMPLES_INDEPENDENT, TRUE);
+    *out = t.Detach();
+    return S_OK;
+}
+
+} // namespace
+
+bool AudioEncoderMft::initialize(const AudioEncoderConfig& cfg) {
+    release();
+    MFT_REGISTER_TYPE_INFO out_info{ MFMediaType_Audio, audio_codec_subtype(cfg.codec) };
+    IMFActivate** activates = nullptr;
+    UINT32 count = 0;
+    HRESULT hr = MFTEnumEx(MFT_CATEGORY_AUDIO_ENCODER,
+                           MFT_ENUM_FLAG_SYNCMFT | MFT_ENUM_FLAG_LOCALMFT | MFT_ENUM_FLAG_SORTANDFILTER,
+                           nullptr, &out_info, &activates, &count);
+    if (FAILED(hr) || count == 0) {
+        SR_LOG_WARN(L"No %s encoder MFT registered", audio_codec_label(cfg.codec));
+        if (activates) CoTaskMemFree(activates);
+        return false;
+    }
+
+    for (UINT32 i = 0; i < count && !mft_; ++i) {
+        ComPtr<IMFTransform> mft;
+        if (FAILED(activates[i]->ActivateObject(IID_PPV_ARGS(&mft)))) continue;
+        WCHAR name[256]{};
+        activates[i]->GetString(MFT_FRIENDLY_NAME_Attribute, name, 256, nullptr);
+        if (!negotiate(mft.Get(), cfg)) {
+            SR_LOG_WARN(L"%s encoder '%s' rejected %u Hz / %u ch", audio_codec_label(cfg.codec),
+                        name, cfg.sample_rate, cfg.channels);
+            activates[i]->ShutdownObject();
+            continue;
+        }
+        mft_  = mft;
+        name_ = name;
+    }
+    for (UINT32 i = 0; i < count; ++i) activates[i]->Release();
+    CoTaskMemFree(activates);
+    if (!mft_) return false;
+
+    MFT_OUTPUT_STREAM_INFO info{};
+    if (SUCCEEDED(mft_->GetOutputStreamInfo(0, &info))) {
+        provides_samples_ = (info.dwFlags & MFT_OUTPUT_STREAM_PROVIDES_SAMPLES) != 0;
+        output_size_ = info.cbSize > 0 ? info.cbSize : 64 * 1024;
+    } else {
+        provides_samples_ = true;
+    }
+    mft_->ProcessMessage(MFT_MESSAGE_NOTIFY_BEGIN_STREAMING, 0);
+    mft_->ProcessMessage(MFT_MESSAGE_NOTIFY_START_OF_STREAM, 0);
+
+    samples_.Attach(SamplePool::create(L"Audio encoder", 16));
+    sample_rate_ = cfg.sample_rate;
+    in_block_    = cfg.channels * (float_to_s16_ ? 2u : cfg.bits_per_sample / 8);
+    const uint32_t batch_ms = std::clamp(cfg.batch_ms, 10u, 500u);
+    batch_bytes_ = static_cast<size_t>(cfg.sample_rate) * batch_ms / 1000 * in_block_;
+    batch_.reserve(batch_bytes_ + 4096);
+    SR_LOG_INFO(L"Audio encoder stage: %s (%s) %u kb/s, %u ms batches%s", audio_codec_label(cfg.codec),
+                name_.c_str(), cfg.bitrate_bps / 1000, batch_ms,
+                float_to_s16_ ? L", float converted to 16-bit" : L"");
+    return true;
+}
+
+bool AudioEncoderMft::negotiate(IMFTransform* mft, const AudioEncoderConfig& cfg) {
+    ComPtr<IMFMediaType> out;
+    if (FAILED(MFCreateMediaType(&out))) return false;
+    out->SetGUID(MF_MT_MAJOR_TYPE, MFMediaType_Audio);
+    out->SetGUID(MF_MT_SUBTYPE, audio_codec_subtype(cfg.codec));
+    out->SetUINT32(MF_MT_AUDIO_SAMPLES_PER_SECOND, cfg.sample_rate);
+    out->SetUINT32(MF_MT_AUDIO_NUM_CHANNELS, cfg.channels);
+    out->SetUINT32(MF_MT_AUDIO_AVG_BYTES_PER_SECOND, cfg.bitrate_bps / 8);
+    if (FAILED(mft->SetOutputType(0, out.Get(), 0))) return false;
+
+    // The capture format first; 16-bit PCM (converted here) as the fallback
+    ComPtr<IMFMediaType> in;
+    bool accepted = SUCCEEDED(make_pcm_type(cfg, cfg.is_float, cfg.bits_per_sample, &in)) &&
+                    SUCCEEDED(mft->SetInputType(0, in.Get(), 0));
+    float_to_s16_ = false;
+    if (!accepted && cfg.is_float) {
+        accepted = SUCCEEDED(make_pcm_type(cfg, false, 16, in.ReleaseAndGetAddressOf())) &&
+                   SUCCEEDED(mft->SetInputType(0, in.Get(), 0));
+        float_to_s16_ = accepted;
+    }
+    if (!accepted) return false;
+    output_type_.Reset();
+    return SUCCEEDED(mft->GetOutputCurrentType(0, &output_type_));
+}
+
+void AudioEncoderMft::release() {
+    if (mft_) {
+        mft_->ProcessMessage(MFT_MESSAGE_NOTIFY_END_STREAMING, 0);
+        mft_.Reset();
+    }
+    output_type_.Reset();
+    if (samples_) {
+        samples_->shutdown();
+        samples_.Reset();
+    }
+    name_.clear();
+    batch_.clear();
+    batch_start_ = -1;
+}
+
+bool AudioEncoderMft::encode(IMFSample* pcm, std::vector<ComPtr<IMFSample>>& out) {
+    if (!mft_ || !pcm) return false;
+    ComPtr<IMFMediaBuffer> buffer;
+    if (FAILED(pcm->ConvertToContiguousBuffer(&buffer))) return false;
+    BYTE* data = nullptr;
+    DWORD len = 0;
+    if (FAILED(buffer->Lock(&data, nullptr, &len))) return false;
+    LONGLONG t = 0;
+    pcm->GetSampleTime(&t);
+    if (batch_start_ >= 0) {
+        // A gap (pause, device restart) ends the batch: its timestamps are
+        // derived from the byte count
+        const LONGLONG batch_end = batch_start_ + static_cast<LONGLONG>(batch_.size() / in_block_) *
+                                   10'000'000 / sample_rate_;
+        if (t > batch_end + 200'000 && !submit_batch(out)) {
+            buffer->Unlock();
+            return false;
+        }
+    }
+    if (batch_start_ < 0 || batch_.empty()) batch_start_ = t;
+    if (float_to_s16_) {
+        const float* f = reinterpret_cast<const float*>(data);
+        const size_t n = len / sizeof(float);
+        const size_t at = batch_.size();
+        batch_.resize(at + n * 2);
+        int16_t* s = reinterpret_cast<int16_t*>(batch_.data() + at);
+        for (size_t i = 0; i < n; ++i) {
+            const float v = std::clamp(f[i], -1.0f, 1.0f);
+            s[i] = static_cast<int16_t>(std::lrintf(v * 32767.0f));
+        }
+    } else {
+        batch_.insert(batch_.end(), data, data + len);
+    }
+    buffer->Unlock();
+    return batch_.size() < batch_bytes_ || submit_batch(out);
+}
+
+bool AudioEncoderMft::drain(std::vector<ComPtr<IMFSample>>& out) {
+    if (!mft_) return false;
+    bool ok = batch_.empty() || submit_batch(out);
+    mft_->ProcessMessage(MFT_MESSAGE_NOTIFY_END_OF_STREAM, 0);
+    mft_->ProcessMessage(MFT_MESSAGE_COMMAND_DRAIN, 0);
+    ok = pull_output(out) && ok;
+    return ok;
+}
+
+bool AudioEncoderMft::submit_batch(std::vector<ComPtr<IMFSample>>& out) {
+    const DWORD size = static_cast<DWORD>(batch_.size() - batch_.size() % in_block_);
+    if (size == 0) return true;
+    ComPtr<IMFMediaBuffer> buffer;
+    ComPtr<IMFSample> sample;
+    if (!samples_->acquire(size, sample, buffer)) return false;
+    BYTE* dst = nullptr;
+    HRESULT hr = buffer->Lock(&dst, nullptr, nullptr);
+    if (FAILED(hr)) return false;
+    memcpy(dst, batch_.data(), size);
+    buffer->Unlock();
+    buffer->SetCurrentLength(size);
+    const LONGLONG frames = size / in_block_;
+    sample->SetSampleTime(batch_start_);
+    sample->SetSampleDuration(frames * 10'000'000 / sample_rate_);
+    // A partial frame stays for the next batch
+    batch_.erase(batch_.begin(), batch_.begin() + size);
+    batch_start_ = batch_.empty() ? -1 : batch_start_ + frames * 10'000'000 / sample_rate_;
+
+    hr = mft_->ProcessInput(0, sample.Get(), 0);
+    if (hr == MF_E_NOTACCEPTING) {
+        if (!pull_output(out)) return false;
+        hr = mft_->ProcessInput(0, sample.Get(), 0);
+    }
+    if (FAILED(hr)) {
+        SR_LOG_ERROR(L"Audio encoder ProcessInput failed: 0x%08X", hr);
+        return false;
+    }
+    return pull_output(out);
+}
+
+bool AudioEncoderMft::pull_output(std::vector<ComPtr<IMFSample>>& out) {
+    for (;;) {
+        MFT_OUTPUT_DATA_BUFFER ob{};
+        ComPtr<IMFSample> own;
+        if (!provides_samples_) {
+            if (!samples_->acquire(output_size_, own)) return false;
+            ob.pSample = own.Get();
+        }
+        DWORD status = 0;
+        const HRESULT hr = mft_->ProcessOutput(0, 1, &ob, &status);
+        if (ob.pEvents) ob.pEvents->Release();
+        if (hr == MF_E_TRANSFORM_NEED_MORE_INPUT) return true;
+        if (hr == MF_E_TRANSFORM_STREAM_CHANGE) {
+            ComPtr<IMFMediaType> type;
+            if (FAILED(mft_->GetOutputAvailableType(0, 0, &type)) || FAILED(mft_->SetOutputType(0, type.Get(), 0))) {
+                return false;
+            }
+            continue;
+        }
+        if (FAILED(hr)) {
+            SR_LOG_ERROR(L"Audio encoder ProcessOutput failed: 0x%08X", hr);
+            return false;
+        }
+        if (provides_samples_) {
+            out.emplace_back();
+            out.back().Attach(ob.pSample);
+        } else {
+            out.push_back(own);
+        }
+    }
+}
+
+} // namespace sr
@@ -0,0 +1,82 @@
+#pragma once
+// audio_encoder.h — Explicit PCM -> compressed audio encoder MFT stage
+//
+// The sink writer only inserts encoders it knows (AAC); for Opus the muxer
+// runs this stage itself and writes the packets as a pass-through stream.
+// PCM packets are coalesced into batches of batch_ms before each
+// ProcessInput, so the MFT is entered ~10x less often than with WASAPI's
+// 10 ms packets. An encoder that accepts only 16-bit PCM gets float input
+// converted while the batch is assembled. Batch inputs and caller-allocated
+// outputs are recycled through a SamplePool.
+//
+// Used from the mux thread only.
+
+#include <windows.h>
+#include <mfapi.h>
+#include <mftransform.h>
+#include <wrl/client.h>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "encoder/sample_pool.h"
+#include "utils/audio_codec.h"
+
+namespace sr {
+
+using Microsoft::WRL::ComPtr;
+
+struct AudioEncoderConfig {
+    AudioCodec codec           = AudioCodec::Opus;
+    uint32_t   sample_rate     = 48000;
+    uint16_t   channels        = 2;
+    uint32_t   bits_per_sample = 16;   // 16 = PCM int, 32 = IEEE float
+    bool       is_float        = false;
+    uint32_t   bitrate_bps     = 32'000;
+    uint32_t   batch_ms        = 100;  // PCM coalesced per ProcessInput
+};
+
+class AudioEncoderMft {
+public:
+    AudioEncoderMft() = default;
+    ~AudioEncoderMft() { release(); }
+
+    AudioEncoderMft(const AudioEncoderMft&)            = delete;
+    AudioEncoderMft& operator=(const AudioEncoderMft&) = delete;
+
+    // First registered encoder MFT for cfg.codec that takes the PCM format.
+    // False when none exists or none accepts it.
+    bool initialize(const AudioEncoderConfig& cfg);
+    void release();
+    bool ready() const { return mft_ != nullptr; }
+
+    // Negotiated compressed type (with codec private data) for AddStream
+    IMFMediaType* output_type() const { return output_type_.Get(); }
+    const std::wstring& name() const { return name_; }
+
+    // Queue a PCM sample; appends any packets the encoder produced
+    bool encode(IMFSample* pcm, std::vector<ComPtr<IMFSample>>& out);
+    // End of stream: the last partial batch and the encoder's tail
+    bool drain(std::vector<ComPtr<IMFSample>>& out);
+
+private:
+    bool negotiate(IMFTransform* mft, const AudioEncoderConfig& cfg);
+    bool submit_batch(std::vector<ComPtr<IMFSample>>& out);
+    bool pull_output(std::vector<ComPtr<IMFSample>>& out);
+
+    ComPtr<IMFTransform> mft_;
+    ComPtr<IMFMediaType> output_type_;
+    ComPtr<SamplePool>   samples_;
+    std::wstring         name_;
+    bool                 provides_samples_ = false;
+    DWORD                output_size_      = 0;
+
+    // Batching
+    std::vector<uint8_t> batch_;           // encoder input format
+    LONGLONG             batch_start_ = -1;
+    size_t               batch_bytes_ = 0; // target size
+    uint32_t             in_block_    = 0; // encoder-side bytes per frame
+    uint32_t             sample_rate_ = 0;
+    bool                 float_to_s16_ = false;
+};
+
+} // namespace sr
@@ -1,10 +1,13 @@
 // encoder_probe.cpp — D3D11 device creation and HW encoder enumeration
 #include "encoder/encoder_probe.h"
+#include "encoder/adapter_pairing.h"
 #include "utils/logging.h"
+#include "utils/video_codec.h"
 
 #include <d3d11_1.h>    // ID3D11Multithread
 #include <codecapi.h>
 #include <algorithm>
+#include <limits>
 #include <vector>
 #pragma comment(lib, "mfplat.lib")
 #pragma comment(lib, "mfuuid.lib")
@@ -20,8 +23,63 @@ struct AdapterCandidate {
     DXGI_ADAPTER_DESC1 desc{};
     int score = 0;
     UINT ordinal = 0;
+    bool drives_display = false;
 };
 
+// True if one of the adapter's outputs is the given monitor
+bool adapter_drives_monitor(IDXGIAdapter* adapter, HMONITOR monitor) {
+    if (!adapter || !monitor) return false;
+    for (UINT i = 0;; ++i) {
+        ComPtr<IDXGIOutput> output;
+        if (adapter->EnumOutputs(i, &output) == DXGI_ERROR_NOT_FOUND) return false;
+        DXGI_OUTPUT_DESC desc{};
+        if (output && SUCCEEDED(output->GetDesc(&desc)) && desc.Monitor == monitor) return true;
+    }
+}
+
+// True if the adapter scans out any monitor (DWM composes on it)
+bool adapter_has_output(IDXGIAdapter* adapter) {
+    ComPtr<IDXGIOutput> output;
+    return adapter && adapter->EnumOutputs(0, &output) != DXGI_ERROR_NOT_FOUND;
+}
+
+// A hardware H.264 encoder MFT bound to the adapter with `luid` (MFTEnum2
+// filters by MFT_ENUM_ADAPTER_LUID; MFTEnumEx lists every adapter's MFTs)
+bool adapter_has_hw_encoder(const LUID& luid) {
+    ComPtr<IMFAttributes> attrs;
+    if (FAILED(MFCreateAttributes(&attrs, 1)) ||
+        FAILED(attrs->SetBlob(MFT_ENUM_ADAPTER_LUID, reinterpret_cast<const UINT8*>(&luid), sizeof(luid)))) {
+        return false;
+    }
+    MFT_REGISTER_TYPE_INFO output_type{ MFMediaType_Video, MFVideoFormat_H264 };
+    IMFActivate** activates = nullptr;
+    UINT32 count = 0;
+    const HRESULT hr = MFTEnum2(MFT_CATEGORY_VIDEO_ENCODER,
+                                MFT_ENUM_FLAG_HARDWARE | MFT_ENUM_FLAG_SORTANDFILTER,
+                                nullptr, &output_type, attrs.Get(), &activates, &count);
+    if (activates) {
+        for (UINT32 i = 0; i < count; ++i) activates[i]->Release();
+        CoTaskMemFree(activates);
+    }
+    return SUCCEEDED(hr) && count > 0;
+}
+
+// Adapter scanning out `monitor`; false if no enumerated adapter owns it
+bool find_display_adapter(HMONITOR monitor, DXGI_ADAPTER_DESC1& desc,
+                          ComPtr<IDXGIAdapter1>* out = nullptr) {
+    ComPtr<IDXGIFactory1> factory;
+    if (!monitor || FAILED(CreateDXGIFactory1(IID_PPV_ARGS(&factory)))) return false;
+    for (UINT i = 0;; ++i) {
+        ComPtr<IDXGIAdapter1> adapter;
+        if (factory->EnumAdapters1(i, &adapter) == DXGI_ERROR_NOT_FOUND) return false;
+        if (adapter && adapter_drives_monitor(adapter.Get(), monitor) &&
+            SUCCEEDED(adapter->GetDesc1(&desc))) {
+            if (out) *out = adapter;
+            return true;
+        }
+    }
+}
+
 HRESULT create_device(IDXGIAdapter* adapter,
                       UINT flags,
                       ID3D11Device** device,
@@ -68,7 +126,32 @@ HRESULT create_device_with_debug_fallback(IDXGIAdapter* adapter,
     return hr;
 }
 
-bool create_preferred_d3d_device(ProbeResult& result, UINT flags) {
+// LowestContention: move the pairing's encode adapter to the front. The
+// capture side is the display adapter, set by update_display_adapter.
+void apply_lowest_contention(std::vector<AdapterCandidate>& candidates) {
+    std::vector<AdapterPairingCandidate> info;
+    info.reserve(candidates.size());
+    for (const auto& c : candidates) {
+        AdapterPairingCandidate a;
+        a.vendor_id         = c.desc.VendorId;
+        a.is_software       = (c.desc.Flags & DXGI_ADAPTER_FLAG_SOFTWARE) != 0;
+        a.drives_display    = c.drives_display;
+        a.drives_any_output = adapter_has_output(c.adapter.Get());
+        a.hw_encoder        = !a.is_software && adapter_has_hw_encoder(c.desc.AdapterLuid);
+        a.preference        = EncoderProbe::adapter_preference_score(c.desc.VendorId, a.is_software);
+        info.push_back(a);
+    }
+    const AdapterPairing pairing = choose_adapter_pairing(info);
+    if (pairing.encode < 0) return;
+
+    SR_LOG_INFO(L"Adapter pairing: capture on %s, encode on %s (contention cost %u)",
+                candidates[pairing.capture].desc.Description,
+                candidates[pairing.encode].desc.Description, pairing.cost);
+    candidates[pairing.encode].score = (std::numeric_limits<int>::max)();
+}
+
+bool create_preferred_d3d_device(ProbeResult& result, UINT flags, HMONITOR display,
+                                 bool lowest_contention) {
     ComPtr<IDXGIFactory1> factory;
     HRESULT hr = CreateDXGIFactory1(IID_PPV_ARGS(&factory));
     if (FAILED(hr)) {
@@ -96,14 +179,18 @@ bool create_preferred_d3d_device(ProbeResult& result, UINT flags) {
         }
 
         const bool is_software = (desc.Flags & DXGI_ADAPTER_FLAG_SOFTWARE) != 0;
+        const bool drives_display = adapter_drives_monitor(adapter.Get(), display);
         candidates.push_back(AdapterCandidate{
             adapter,
             desc,
-            EncoderProbe::adapter_preference_score(desc.VendorId, is_software),
-            i
+            EncoderProbe::adapter_preference_score(desc.VendorId, is_software, drives_display),
+            i,
+            drives_display
         });
     }
 
+    if (lowest_contention) apply_lowest_contention(candidates);
+
     std::stable_sort(candidates.begin(), candidates.end(),
         [](const AdapterCandidate& lhs, const AdapterCandidate& rhs) {
             if (lhs.score != rhs.score) {
@@ -125,7 +212,9 @@ bool create_preferred_d3d_device(ProbeResult& result, UINT flags) {
             SR_LOG_INFO(L"D3D11 adapter selected for HW encoding: %s (vendor=0x%04X%s)",
                         candidate.desc.Description,
                         candidate.desc.VendorId,
-                        candidate.desc.VendorId == kIntelVendorId ? L", Intel preferred" : L"");
+                        candidate.score == (std::numeric_limits<int>::max)() ? L", lowest contention"
+                        : candidate.drives_display ? L", drives captured display"
+                        : candidate.desc.VendorId == kIntelVendorId ? L", Intel preferred" : L"");
             return true;
         }
 
@@ -139,16 +228,88 @@ bool create_preferred_d3d_device(ProbeResult& result, UINT flags) {
     return SUCCEEDED(hr);
 }
 
+// First hardware encoder MFT producing `codec`; fills its friendly name
+bool find_hw_encoder(VideoCodec codec, std::wstring& name) {
+    MFT_REGISTER_TYPE_INFO output_type{ MFMediaType_Video, video_codec_subtype(codec) };
+    IMFActivate** activates = nullptr;
+    UINT32 count = 0;
+
+    const HRESULT hr = MFTEnumEx(
+        MFT_CATEGORY_VIDEO_ENCODER,
+        MFT_ENUM_FLAG_HARDWARE | MFT_ENUM_FLAG_SORTANDFILTER,
+        nullptr,
+        &output_type,
+        &activates,
+        &count
+    );
+
+    const bool found = SUCCEEDED(hr) && count > 0;
+    if (found) {
+        WCHAR name_buf[256]{};
+        activates[0]->GetString(MFT_FRIENDLY_NAME_Attribute, name_buf, 256, nullptr);
+        name = name_buf;
+        SR_LOG_INFO(L"HW %s encoder found: %s", video_codec_label(codec), name_buf);
+    }
+
+    if (activates) {
+        for (UINT32 i = 0; i < count; ++i) activates[i]->Release();
+        CoTaskMemFree(activates);
+    }
+    return found;
+}
+
 } // namespace
 
-int EncoderProbe::adapter_preference_score(UINT vendor_id, bool is_software) noexcept {
+int EncoderProbe::adapter_preference_score(UINT vendor_id, bool is_software,
+                                           bool drives_display) noexcept {
     if (is_software) {
         return -1;
     }
-    return vendor_id == kIntelVendorId ? 100 : 10;
+    return (drives_display ? 1000 : 0) + (vendor_id == kIntelVendorId ? 100 : 10);
 }
 
-bool EncoderProbe::run(ProbeResult& result) {
+void EncoderProbe::update_display_adapter(ProbeResult& result, HMONITOR monitor) {
+    result.display_adapter_name.clear();
+    result.cross_adapter_capture = false;
+    DXGI_ADAPTER_DESC1 display{};
+    ComPtr<IDXGIAdapter1> display_adapter;
+    if (!result.adapter || !find_display_adapter(monitor, display, &display_adapter)) {
+        if (result.split_adapters) result.capture_adapter.Reset();
+        return;
+    }
+
+    DXGI_ADAPTER_DESC device{};
+    result.adapter->GetDesc(&device);
+    result.display_adapter_name = display.Description;
+    const bool other_adapter = display.AdapterLuid.LowPart != device.AdapterLuid.LowPart ||
+                               display.AdapterLuid.HighPart != device.AdapterLuid.HighPart;
+    // LowestContention: capture follows the monitor to its adapter, so WGC
+    // frames stay local and only the converted NV12 crosses to the encoder
+    if (result.split_adapters) {
+        result.capture_adapter.Reset();
+        if (other_adapter) {
+            display_adapter.As(&result.capture_adapter);
+            SR_LOG_INFO(L"Split adapters: capture on %s, encode on %s (shared NV12 + fence)",
+                        display.Description, device.Description);
+        }
+        return;
+    }
+    result.cross_adapter_capture = other_adapter;
+    if (result.cross_adapter_capture) {
+        SR_LOG_WARN(L"Captured monitor is driven by %s, device is on %s — "
+                    L"WGC will copy every frame across adapters",
+                    display.Description, device.Description);
+    }
+}
+
+void EncoderProbe::enumerate_encoders(ProbeResult& result) {
+    result.hw_encoder_available = find_hw_encoder(VideoCodec::H264, result.encoder_name);
+    result.hw_hevc_available    = find_hw_encoder(VideoCodec::HEVC, result.hevc_encoder_name);
+    result.hw_av1_available     = find_hw_encoder(VideoCodec::AV1,  result.av1_encoder_name);
+}
+
+bool EncoderProbe::run(ProbeResult& result, const std::wstring& cache_path,
+                       AdapterPolicy policy, HMONITOR monitor) {
     // --- D3D11 Device Creation ---
     UINT flags = D3D11_CREATE_DEVICE_BGRA_SUPPORT | D3D11_CREATE_DEVICE_VIDEO_SUPPORT;
 
@@ -156,7 +317,9 @@ bool EncoderProbe::run(ProbeResult& result) {
     flags |= D3D11_CREATE_DEVICE_DEBUG;
 #endif
 
-    if (!create_preferred_d3d_device(result, flags)) {
+    const HMONITOR display = policy != AdapterPolicy::PreferIntel ? monitor : nullptr;
+    result.split_adapters = policy == AdapterPolicy::LowestContention;
+    if (!create_preferred_d3d_device(result, flags, display, result.split_adapters)) {
         SR_LOG_ERROR(L"D3D11CreateDevice failed on all adapter candidates");
         return false;
     }
@@ -177,6 +340,16 @@ bool EncoderProbe::run(ProbeResult& result) {
     result.adapter_name = adapter_desc.Description;
     SR_LOG_INFO(L"D3D11 adapter: %s", adapter_desc.Description);
 
+    result.adapter_id.vendor_id = adapter_desc.VendorId;
+    result.adapter_id.device_id = adapter_desc.DeviceId;
+    result.adapter_id.subsys_id = adapter_desc.SubSysId;
+    result.adapter_id.revision  = adapter_desc.Revision;
+    LARGE_INTEGER umd_version{};
+    if (SUCCEEDED(result.adapter->CheckInterfaceSupport(__uuidof(IDXGIDevice), &umd_version))) {
+        result.adapter_id.driver_version = static_cast<uint64_t>(umd_version.QuadPart);
+    }
+    update_display_adapter(result, monitor);
+
     // --- DXGI Device Manager (for sharing D3D device with MFTs) ---
     HRESULT hr = MFCreateDXGIDeviceManager(&result.reset_token, &result.dxgi_device_manager);
     if (FAILED(hr)) {
@@ -190,34 +363,27 @@ bool EncoderProbe::run(ProbeResult& result) {
         return false;
     }
 
-    // --- Hardware H.264 Encoder Enumeration ---
-    MFT_REGISTER_TYPE_INFO output_type{ MFMediaType_Video, MFVideoFormat_H264 };
-    IMFActivate** activates = nullptr;
-    UINT32 count = 0;
-
-    hr = MFTEnumEx(
-        MFT_CATEGORY_VIDEO_ENCODER,
-        MFT_ENUM_FLAG_HARDWARE | MFT_ENUM_FLAG_SORTANDFILTER,
-        nullptr,
-        &output_type,
-        &activates,
-        &count
-    );
-
-    if (SUCCEEDED(hr) && count > 0) {
-        WCHAR name_buf[256]{};
-        activates[0]->GetString(MFT_FRIENDLY_NAME_Attribute, name_buf, 256, nullptr);
-        result.encoder_name        = name_buf;
-        result.hw_encoder_available = true;
-        SR_LOG_INFO(L"HW encoder found: %s", name_buf);
+    // --- Hardware encoder enumeration (H.264 always; HEVC/AV1 for the efficient modes) ---
+    CachedEncoders cached;
+    result.encoders_from_cache = ProbeCache::load(cache_path, result.adapter_id, cached);
+    if (result.encoders_from_cache) {
+        result.encoder_name         = cached.h264_name;
+        result.hevc_encoder_name    = cached.hevc_name;
+        result.av1_encoder_name     = cached.av1_name;
+        result.hw_encoder_available = !cached.h264_name.empty();
+        result.hw_hevc_available    = !cached.hevc_name.empty();
+        result.hw_av1_available     = !cached.av1_name.empty();
+        SR_LOG_INFO(L"HW encoders from probe cache (driver %llX)",
+                    static_cast<unsigned long long>(result.adapter_id.driver_version));
     } else {
-        result.hw_encoder_available = false;
-        SR_LOG_INFO(L"No hardware H.264 encoder — will use software fallback");
+        enumerate_encoders(result);
+        if (!cache_path.empty() &&
+            !ProbeCache::save(cache_path, result.adapter_id, result.cached_encoders())) {
+            SR_LOG_WARN(L"Probe cache could not be written: %s", cache_path.c_str());
+        }
     }
-
-    if (activates) {
-        for (UINT32 i = 0; i < count; ++i) activates[i]->Release();
-        CoTaskMemFree(activates);
+    if (!result.hw_encoder_available) {
+        SR_LOG_INFO(L"No hardware H.264 encoder — will use software fallback");
     }
 
     return true;
@@ -1,5 +1,5 @@
 #pragma once
-// encoder_probe.h — D3D11 device creation and hardware H.264 encoder enumeration
+// encoder_probe.h — D3D11 device creation and hardware H.264/HEVC/AV1 encoder enumeration
 // T008: Setup D3D11 device and HW Encoder enumeration
 
 #include <d3d11.h>
@@ -9,31 +9,80 @@
 #include <mfidl.h>
 #include <wrl/client.h>
 #include <string>
+#include "encoder/probe_cache.h"
 
 namespace sr {
 
 using Microsoft::WRL::ComPtr;
 
+// Which adapter the shared D3D11 device (capture VP + encoders) is created on
+enum class AdapterPolicy {
+    PreferIntel,      // vendor score only: Quick Sync first
+    CapturedDisplay,  // adapter scanning out the captured monitor, then vendor score
+    // Encoder device on the cheapest adapter by choose_adapter_pairing; when
+    // that is not the display adapter, capture and conversion run on an
+    // isolated device there (ProbeResult::capture_adapter)
+    LowestContention,
+};
+
 struct ProbeResult {
     ComPtr<ID3D11Device>         d3d_device;
     ComPtr<ID3D11DeviceContext>  d3d_context;
     ComPtr<IDXGIAdapter>         adapter;
     ComPtr<IMFDXGIDeviceManager> dxgi_device_manager;
     UINT                         reset_token = 0;
-    bool                         hw_encoder_available = false;
+    bool                         hw_encoder_available = false;  // H.264
     std::wstring                 encoder_name;
+    bool                         hw_hevc_available = false;
+    std::wstring                 hevc_encoder_name;
+    bool                         hw_av1_available  = false;
+    std::wstring                 av1_encoder_name;
     std::wstring                 adapter_name;
+    AdapterIdentity              adapter_id;               // probe cache key
+    bool                         encoders_from_cache = false;  // encoder fields not re-enumerated yet
+    // Adapter whose output scans out the captured monitor. When it is not the
+    // device adapter, WGC copies every frame across adapters before we see it.
+    std::wstring                 display_adapter_name;
+    bool                         cross_adapter_capture = false;
+    // LowestContention split: adapter for the capture device (the display
+    // adapter) when the encoder device is on another GPU; null otherwise
+    ComPtr<IDXGIAdapter>         capture_adapter;
+    bool                         split_adapters = false;   // policy was LowestContention
+
+    CachedEncoders cached_encoders() const {
+        return { hw_encoder_available ? encoder_name : std::wstring{},
+                 hw_hevc_available ? hevc_encoder_name : std::wstring{},
+                 hw_av1_available ? av1_encoder_name : std::wstring{} };
+    }
 };
 
 class EncoderProbe {
 public:
-    // Create D3D11 device + enumerate hardware H.264 encoders
+    // Create D3D11 device + enumerate hardware H.264 / HEVC / AV1 encoders
     // Returns false if D3D11 device creation fails
-    static bool run(ProbeResult& result);
+    // With a cache_path, encoder fields come from ProbeCache when it matches
+    // this adapter + driver (encoders_from_cache = true); otherwise they are
+    // enumerated and the cache is rewritten.
+    // With CapturedDisplay and a monitor, the adapter driving that monitor is
+    // tried first so WGC frames stay on one GPU (hybrid laptops).
+    static bool run(ProbeResult& result, const std::wstring& cache_path = {},
+                    AdapterPolicy policy = AdapterPolicy::CapturedDisplay,
+                    HMONITOR monitor = nullptr);
+
+    // Refresh display_adapter_name / cross_adapter_capture (and, for
+    // LowestContention, capture_adapter) for `monitor` against the already
+    // created device (the source can change after run).
+    static void update_display_adapter(ProbeResult& result, HMONITOR monitor);
+
+    // Hardware H.264 / HEVC / AV1 MFT enumeration only (the slow part of run).
+    // Fills the hw_*_available / *_name fields. Needs COM on the calling thread.
+    static void enumerate_encoders(ProbeResult& result);
 
     // Adapter selection policy used before D3D11 device creation.
     // Higher score wins; software adapters are always below hardware adapters.
-    static int adapter_preference_score(UINT vendor_id, bool is_software) noexcept;
+    // drives_display (CapturedDisplay policy) outranks the vendor preference.
+    static int adapter_preference_score(UINT vendor_id, bool is_software,
+                                        bool drives_display = false) noexcept;
 };
 
 } // namespace sr
@@ -0,0 +1,137 @@
+#pragma once
+// encoder_scheduler.h — Hardware / software placement and frame rates for concurrent encoders
+//
+// Recording several monitors at once opens one encoder per display. The
+// hardware encoder has a session limit (GeForce drivers cap NVENC) and a
+// shared throughput; software encoding costs CPU per pixel. Before the
+// streams open, schedule_encoder_streams() decides for each one:
+//
+//   - placement: hardware while sessions remain, unless the hardware budget
+//     is full and software still has room for the stream at its full rate
+//   - frame rate: a pool over its pixel-rate budget lowers the fps of its
+//     secondary streams first (never below min_fps), the primary last
+//
+// Stream 0 is the primary display (the one carrying the session's own
+// encoder and audio); the others are placed largest first. A stream whose
+// encoder is already open on hardware is pinned there (fixed_hardware): it
+// takes a session and its pixel rate whatever the budget. Live overload is
+// still handled per stream by its QualityGovernor.
+
+#include <algorithm>
+#include <cstdint>
+#include <numeric>
+#include <vector>
+
+namespace sr {
+
+struct EncoderStreamRequest {
+    uint32_t width  = 0;
+    uint32_t height = 0;
+    uint32_t fps    = 30;
+    bool     fixed_hardware = false;   // already encoding on hardware; not moved
+
+    uint64_t pixel_rate() const { return uint64_t{ width } * height * fps; }
+};
+
+struct EncoderCapacity {
+    uint32_t hw_sessions   = 0;   // concurrent hardware sessions; 0 = no hardware encoder
+    uint64_t hw_pixel_rate = 0;   // pixels/s the hardware sustains across its sessions
+    uint64_t sw_pixel_rate = 0;   // pixels/s software encoding may take
+    uint32_t min_fps       = 15;
+};
+
+struct EncoderStreamPlan {
+    bool     hardware = false;
+    uint32_t fps      = 0;
+};
+
+// About one 4K60 (or four 1080p60) low-latency stream per adapter
+constexpr uint64_t kHwEncoderPixelRate = 3840ull * 2160 * 60;
+
+// Concurrent hardware encode sessions the vendor's driver allows. GeForce
+// drivers cap NVENC (8 since the R550 drivers); Quick Sync and VCN have no
+// fixed cap, so bandwidth is the limit there.
+inline uint32_t hw_encoder_session_limit(uint32_t vendor_id) {
+    switch (vendor_id) {
+        case 0x10DE: return 8;    // NVIDIA
+        default:     return 16;   // Intel, AMD, others
+    }
+}
+
+// Software H.264 at low-latency settings: roughly 1080p30 per four logical
+// cores; two cores stay for capture, audio and the UI
+inline uint64_t sw_encoder_pixel_rate(uint32_t logical_cores) {
+    const uint32_t usable = logical_cores > 2 ? logical_cores - 2 : 1;
+    return uint64_t{ 1920 } * 1080 * 30 * usable / 4;
+}
+
+namespace detail {
+
+// Lower the fps of `pool` until it fits `budget`: secondaries first, then stream 0
+inline void fit_encoder_pool(const std::vector<EncoderStreamRequest>& streams,
+                             std::vector<EncoderStreamPlan>& plan, const std::vector<size_t>& pool,
+                             uint64_t budget, uint32_t min_fps) {
+    auto rate = [&](size_t i) { return uint64_t{ streams[i].width } * streams[i].height * plan[i].fps; };
+    auto total = [&] {
+        return std::accumulate(pool.begin(), pool.end(), uint64_t{ 0 },
+                               [&](uint64_t sum, size_t i) { return sum + rate(i); });
+    };
+    auto scale = [&](size_t i, double factor) {
+        const uint32_t floor_fps = (std::min)(min_fps, streams[i].fps);
+        const auto scaled = static_cast<uint32_t>(plan[i].fps * factor);
+        plan[i].fps = (std::clamp)(scaled, floor_fps, plan[i].fps);
+    };
+    if (total() <= budget) return;
+
+    const bool has_primary = std::find(pool.begin(), pool.end(), size_t{ 0 }) != pool.end();
+    const uint64_t primary = has_primary ? rate(0) : 0;
+    const uint64_t others  = total() - primary;
+    if (others > 0) {
+        const double factor = budget > primary ? static_cast<double>(budget - primary) / others : 0.0;
+        for (size_t i : pool) {
+            if (i != 0) scale(i, factor);
+        }
+    }
+    const uint64_t now = total();
+    if (has_primary && now > budget) {
+        const uint64_t rest = now - rate(0);
+        scale(0, budget > rest ? static_cast<double>(budget - rest) / rate(0) : 0.0);
+    }
+}
+
+} // namespace detail
+
+inline std::vector<EncoderStreamPlan> schedule_encoder_streams(const std::vector<EncoderStreamRequest>& streams,
+                                                               const EncoderCapacity& capacity) {
+    std::vector<EncoderStreamPlan> plan(streams.size());
+    std::vector<size_t> order(streams.size());
+    std::iota(order.begin(), order.end(), size_t{ 0 });
+    if (!order.empty()) {
+        std::stable_sort(order.begin() + 1, order.end(), [&](size_t a, size_t b) {
+            return streams[a].pixel_rate() > streams[b].pixel_rate();
+        });
+    }
+
+    std::vector<size_t> hw_pool, sw_pool;
+    uint64_t hw_used = 0, sw_used = 0;
+    for (size_t i : order) {
+        const uint64_t r = streams[i].pixel_rate();
+        plan[i].fps = streams[i].fps;
+        const bool sessions_left = hw_pool.size() < capacity.hw_sessions;
+        const bool fits_hw = hw_used + r <= capacity.hw_pixel_rate;
+        const bool fits_sw = sw_used + r <= capacity.sw_pixel_rate;
+        if (streams[i].fixed_hardware || (sessions_left && (fits_hw || !fits_sw))) {
+            plan[i].hardware = true;
+            hw_pool.push_back(i);
+            hw_used += r;
+        } else {
+            sw_pool.push_back(i);
+            sw_used += r;
+        }
+    }
+    detail::fit_encoder_pool(streams, plan, hw_pool, capacity.hw_pixel_rate, capacity.min_fps);
+    detail::fit_encoder_pool(streams, plan, sw_pool, capacity.sw_pixel_rate, capacity.min_fps);
+    return plan;
+}
+
+} // namespace sr
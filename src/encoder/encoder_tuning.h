@@ -0,0 +1,66 @@
+#pragma once
+// encoder_tuning.h — Per-power-state speed/power knobs for each EncoderMode
+//
+// Besides the PowerModeDetector clamps (size, fps, bitrate) the encoder has
+// two ICodecAPI knobs that trade quality for power:
+//   CODECAPI_AVEncCommonQualityVsSpeed  0 = fastest .. 100 = best quality
+//   CODECAPI_AVEncLowPowerEncoder       fixed-function path (Quick Sync
+//                                       VDEnc) instead of shader-assisted
+//                                       motion search
+// On battery the HW encoder moves to the low-power path with a faster
+// preset; the SW encoders only have the preset and go to the fastest one.
+// High-quality sessions keep the full path and step down one notch less.
+// VideoEncoder applies each knob only where the MFT reports it supported.
+
+#include <cstdint>
+
+namespace sr {
+
+enum class EncoderMode {
+    HardwareMFT,        // Intel Quick Sync or other HW MFT
+    SoftwareMFT,        // SW MFT, original resolution
+    SoftwareMFT720p,    // SW MFT, 720p30 degraded fallback
+};
+
+inline const wchar_t* encoder_mode_label(EncoderMode mode) {
+    switch (mode) {
+        case EncoderMode::HardwareMFT: return L"HW";
+        case EncoderMode::SoftwareMFT: return L"SW";
+        case EncoderMode::SoftwareMFT720p: return L"SW 720p";
+        default: return L"?";
+    }
+}
+
+struct EncoderTuning {
+    uint32_t quality_vs_speed = 50;     // the MFTs' own default
+    bool     low_power        = false;
+
+    bool operator==(const EncoderTuning&) const = default;
+};
+
+// AC values restore the MFT defaults, so an AC -> battery -> AC session ends
+// where a plain AC session would have been
+inline EncoderTuning encoder_tuning_for(EncoderMode mode, bool on_ac, bool high_quality) {
+    switch (mode) {
+        case EncoderMode::HardwareMFT:
+            if (high_quality) return on_ac ? EncoderTuning{ 70, false } : EncoderTuning{ 50, false };
+            return on_ac ? EncoderTuning{ 50, false } : EncoderTuning{ 33, true };
+        case EncoderMode::SoftwareMFT:
+            if (high_quality) return on_ac ? EncoderTuning{ 70, false } : EncoderTuning{ 50, false };
+            return on_ac ? EncoderTuning{ 50, false } : EncoderTuning{ 0, false };
+        case EncoderMode::SoftwareMFT720p:
+            // Already the degraded fallback: the CPU budget matters more than detail
+            if (high_quality) return on_ac ? EncoderTuning{ 50, false } : EncoderTuning{ 33, false };
+            return EncoderTuning{ 0, false };
+    }
+    return {};
+}
+
+inline const wchar_t* encoder_tuning_label(const EncoderTuning& tuning) {
+    if (tuning.low_power) return L"low-power";
+    if (tuning.quality_vs_speed >= 70) return L"quality";
+    if (tuning.quality_vs_speed <= 33) return L"speed";
+    return L"balanced";
+}
+
+} // namespace sr
@@ -0,0 +1,39 @@
+#pragma once
+// nv12_copy.h — Pack a pitched NV12 surface into a tight (stride = width) buffer
+//
+// The software-encoder path maps a staging texture whose RowPitch is padded
+// by the driver, while the MFT input type declares stride == width. Y rows
+// are followed by the interleaved UV plane (height / 2 rows), both starting
+// at the same pitch in the mapped surface.
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace sr {
+
+// Bytes a tight NV12 frame of width x height occupies
+constexpr size_t nv12_tight_size(uint32_t width, uint32_t height) {
+    return static_cast<size_t>(width) * height + static_cast<size_t>(width) * (height / 2);
+}
+
+// dst must hold nv12_tight_size(width, height) bytes; src_pitch >= width
+inline void copy_nv12_tight(uint8_t* dst, const uint8_t* src, size_t src_pitch,
+                            uint32_t width, uint32_t height) {
+    if (src_pitch == width) {
+        std::memcpy(dst, src, nv12_tight_size(width, height));
+        return;
+    }
+    // Y plane
+    for (uint32_t row = 0; row < height; ++row) {
+        std::memcpy(dst + static_cast<size_t>(row) * width, src + row * src_pitch, width);
+    }
+    // UV plane
+    const uint8_t* src_uv = src + src_pitch * height;
+    uint8_t*       dst_uv = dst + static_cast<size_t>(width) * height;
+    for (uint32_t row = 0; row < height / 2; ++row) {
+        std::memcpy(dst_uv + static_cast<size_t>(row) * width, src_uv + row * src_pitch, width);
+    }
+}
+
+} // namespace sr
@@ -2,9 +2,11 @@
 // power_mode.h — T042: Dynamic power-mode encoder adjustment
 // Reads GetSystemPowerStatus; base mode on battery clamps to 15fps/1.5Mbps/480p.
 // High Quality mode keeps the requested profile unchanged on AC and battery.
+// Auto audio latency resolves to PowerSaving (batched WASAPI wakeups) on battery.
 
 #include <windows.h>
 #include <algorithm>
+#include "audio/audio_latency.h"
 #include "utils/render_frame.h"     // EncoderProfile
 #include "utils/logging.h"
 
@@ -70,6 +72,13 @@ public:
         return clamp_for_power_state(requested, on_ac);
     }
 
+    // AudioLatencyMode::Auto -> Default on AC, PowerSaving on battery; an
+    // explicit mode is kept
+    static AudioLatencyMode audio_latency_for_power_state(AudioLatencyMode requested, bool on_ac) {
+        if (requested != AudioLatencyMode::Auto) return requested;
+        return on_ac ? AudioLatencyMode::Default : AudioLatencyMode::PowerSaving;
+    }
+
     // Clamp the requested EncoderProfile for the current power state.
     //   AC power  → unchanged (use requested profile)
     //   Battery   → aggressive: 15fps / 1.5Mbps / 848x480
@@ -0,0 +1,111 @@
+#pragma once
+// probe_cache.h — Persisted hardware-encoder enumeration, keyed by adapter and driver
+//
+// MFTEnumEx for three codecs loads every vendor encoder DLL and is most of
+// EncoderProbe::run's cold-start cost. The result only changes with the GPU
+// or its driver, so it is kept in %APPDATA%\ScreenRecorder\probe_cache.ini:
+//
+//   [Adapter]  vendor / device / subsys / revision (PCI ids), driver (UMD version)
+//   [Encoders] h264 / hevc / av1 = MFT friendly name (empty = none)
+//
+// The key uses PCI ids rather than the adapter LUID: LUIDs are reassigned on
+// every boot, so a LUID key would miss on exactly the cold starts it is for.
+// A hit is only a hint; SessionController re-runs the enumeration in the
+// background and rewrites the file when it disagrees.
+
+#include <windows.h>
+#include <cstdint>
+#include <cwchar>
+#include <filesystem>
+#include <string>
+
+namespace sr {
+
+struct AdapterIdentity {
+    uint32_t vendor_id      = 0;
+    uint32_t device_id      = 0;
+    uint32_t subsys_id      = 0;
+    uint32_t revision       = 0;
+    uint64_t driver_version = 0;   // IDXGIAdapter::CheckInterfaceSupport UMD version
+
+    bool valid() const { return vendor_id != 0 || device_id != 0; }
+    bool operator==(const AdapterIdentity&) const = default;
+};
+
+struct CachedEncoders {
+    std::wstring h264_name;   // empty = no hardware encoder for that codec
+    std::wstring hevc_name;
+    std::wstring av1_name;
+
+    bool operator==(const CachedEncoders&) const = default;
+};
+
+class ProbeCache {
+public:
+    static constexpr uint32_t kFormatVersion = 1;
+
+    // True when `path` holds a cache written for exactly this adapter + driver
+    static bool load(const std::wstring& path, const AdapterIdentity& id, CachedEncoders& out) {
+        if (path.empty() || !id.valid()) return false;
+        const wchar_t* ini = path.c_str();
+        if (GetPrivateProfileIntW(L"Cache", L"format", 0, ini) != static_cast<int>(kFormatVersion)) {
+            return false;
+        }
+
+        AdapterIdentity stored;
+        stored.vendor_id      = read_u32(ini, L"vendor");
+        stored.device_id      = read_u32(ini, L"device");
+        stored.subsys_id      = read_u32(ini, L"subsys");
+        stored.revision       = read_u32(ini, L"revision");
+        stored.driver_version = read_u64(ini, L"driver");
+        if (!(stored == id)) return false;
+
+        out.h264_name = read_name(ini, L"h264");
+        out.hevc_name = read_name(ini, L"hevc");
+        out.av1_name  = read_name(ini, L"av1");
+        return true;
+    }
+
+    static bool save(const std::wstring& path, const AdapterIdentity& id, const CachedEncoders& enc) {
+        if (path.empty() || !id.valid()) return false;
+        std::error_code ec;
+        std::filesystem::create_directories(std::filesystem::path(path).parent_path(), ec);
+        if (ec) return false;
+
+        const wchar_t* ini = path.c_str();
+        wchar_t buf[32];
+        _snwprintf_s(buf, _countof(buf), _TRUNCATE, L"%u", kFormatVersion);
+        bool ok = WritePrivateProfileStringW(L"Cache", L"format", buf, ini) != FALSE;
+        ok &= write_hex(ini, L"vendor",   id.vendor_id);
+        ok &= write_hex(ini, L"device",   id.device_id);
+        ok &= write_hex(ini, L"subsys",   id.subsys_id);
+        ok &= write_hex(ini, L"revision", id.revision);
+        ok &= write_hex(ini, L"driver",   id.driver_version);
+        ok &= WritePrivateProfileStringW(L"Encoders", L"h264", enc.h264_name.c_str(), ini) != FALSE;
+        ok &= WritePrivateProfileStringW(L"Encoders", L"hevc", enc.hevc_name.c_str(), ini) != FALSE;
+        ok &= WritePrivateProfileStringW(L"Encoders", L"av1",  enc.av1_name.c_str(),  ini) != FALSE;
+        return ok;
+    }
+
+private:
+    static uint64_t read_u64(const wchar_t* ini, const wchar_t* key) {
+        wchar_t buf[32]{};
+        GetPrivateProfileStringW(L"Adapter", key, L"", buf, static_cast<DWORD>(_countof(buf)), ini);
+        return buf[0] ? wcstoull(buf, nullptr, 16) : 0;
+    }
+    static uint32_t read_u32(const wchar_t* ini, const wchar_t* key) {
+        return static_cast<uint32_t>(read_u64(ini, key));
+    }
+    static std::wstring read_name(const wchar_t* ini, const wchar_t* key) {
+        wchar_t buf[256]{};
+        GetPrivateProfileStringW(L"Encoders", key, L"", buf, static_cast<DWORD>(_countof(buf)), ini);
+        return buf;
+    }
+    static bool write_hex(const wchar_t* ini, const wchar_t* key, uint64_t value) {
+        wchar_t buf[32];
+        _snwprintf_s(buf, _countof(buf), _TRUNCATE, L"%llX", static_cast<unsigned long long>(value));
+        return WritePrivateProfileStringW(L"Adapter", key, buf, ini) != FALSE;
+    }
+};
+
+} // namespace sr
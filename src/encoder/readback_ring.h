@@ -0,0 +1,74 @@
+#pragma once
+// readback_ring.h — Slot bookkeeping for the SW encoder's deferred GPU->CPU readback
+//
+// The SW encode path copies each NV12 frame into a staging texture and only
+// Map()s that texture Size-1 frames later, so the GPU copy has long finished
+// and Map never stalls the immediate context:
+//   frame N   : CopyResource -> slot[N % Size]
+//   frame N   : Map + read back the oldest pending slot (frame N - (Size-1))
+//
+// This class only tracks indices and per-slot metadata; the caller owns the
+// textures. Not thread-safe — used from the video-encode stage only.
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+
+namespace sr {
+
+template <size_t Size>
+class ReadbackRing {
+    static_assert(Size >= 2 && Size <= 8, "ReadbackRing Size must be in [2, 8]");
+
+public:
+    struct Slot {
+        int64_t pts            = 0;
+        bool    force_keyframe = false;
+    };
+
+    // Claim the next slot for a new copy. Returns nullopt when every slot is
+    // still waiting for readback (caller must read_oldest() first).
+    std::optional<size_t> stage(int64_t pts, bool force_keyframe) {
+        if (pending_ == Size) return std::nullopt;
+        const size_t idx = write_idx_;
+        slots_[idx].pts = pts;
+        slots_[idx].force_keyframe = force_keyframe;
+        write_idx_ = (write_idx_ + 1) % Size;
+        ++pending_;
+        return idx;
+    }
+
+    // True once the ring is full, i.e. the oldest copy is Size-1 frames old.
+    bool ready() const { return pending_ == Size; }
+
+    // Index of the oldest slot awaiting readback (only valid when pending() > 0)
+    size_t oldest() const { return read_idx_; }
+    const Slot& slot(size_t idx) const { return slots_[idx]; }
+
+    // Mark the oldest slot as read back and free it for reuse
+    void release_oldest() {
+        if (pending_ == 0) return;
+        read_idx_ = (read_idx_ + 1) % Size;
+        --pending_;
+    }
+
+    size_t pending() const { return pending_; }
+    bool   empty()   const { return pending_ == 0; }
+
+    void reset() {
+        write_idx_ = 0;
+        read_idx_  = 0;
+        pending_   = 0;
+    }
+
+    static constexpr size_t size() { return Size; }
+
+private:
+    std::array<Slot, Size> slots_{};
+    size_t write_idx_ = 0;
+    size_t read_idx_  = 0;
+    size_t pending_   = 0;
+};
+
+} // namespace sr
@@ -0,0 +1,95 @@
+#pragma once
+// roi_map.h — Dirty-rect -> encoder region-of-interest (QP delta) mapping
+//
+// Screen content is mostly static: the capture engine reports which areas
+// changed (DirtyRegion), and the HW encoder is asked to spend bits there
+// (negative QP delta) while the rest of the frame codes at the base QP.
+// Under CBR that shifts the budget from static background to the changes.
+//
+// Rects are expanded to kMacroblock alignment (ROI granularity on every MFT
+// that supports it) and merged down to kMaxAreas. Frames where the changed
+// area is unknown, empty or covers most of the picture produce no ROI — the
+// encoder's own rate control handles those better than a flat delta.
+//
+// Plain data only; video_encoder.cpp converts to ROI_AREA.
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include "utils/dirty_region.h"
+
+namespace sr {
+
+struct RoiArea {
+    FrameRect rect;
+    int32_t   qp_delta = 0;
+};
+
+struct RoiParams {
+    int32_t  qp_delta          = -4;   // applied to changed areas
+    uint32_t max_coverage_pct  = 60;   // above this, skip ROI for the frame
+};
+
+class RoiMap {
+public:
+    static constexpr uint32_t kMacroblock = 16;
+    static constexpr size_t   kMaxAreas   = 8;
+
+    // Rebuild from a frame's dirty region; returns the number of areas.
+    size_t build(const DirtyRegion& dirty, uint32_t width, uint32_t height,
+                 const RoiParams& params = {}) {
+        count_ = 0;
+        if (!dirty.known() || dirty.empty() || width == 0 || height == 0 ||
+            params.qp_delta == 0) {
+            return 0;
+        }
+
+        DirtyRegion aligned;
+        aligned.reset(width, height);
+        for (const FrameRect& r : dirty) {
+            aligned.add({ align_down(r.left), align_down(r.top),
+                          align_up(r.right), align_up(r.bottom) });
+        }
+        // Fold into kMaxAreas by least bounding-box growth, then drop any
+        // area the merge made redundant
+        size_t n = 0;
+        std::array<FrameRect, kMaxAreas> areas{};
+        for (const FrameRect& r : aligned) {
+            if (n < kMaxAreas) { areas[n++] = r; continue; }
+            size_t best = 0;
+            uint64_t best_growth = UINT64_MAX;
+            for (size_t i = 0; i < n; ++i) {
+                const uint64_t growth = areas[i].united(r).area() - areas[i].area();
+                if (growth < best_growth) { best_growth = growth; best = i; }
+            }
+            areas[best] = areas[best].united(r);
+        }
+        DirtyRegion merged;
+        merged.reset(width, height);
+        for (size_t i = 0; i < n; ++i) merged.add(areas[i]);
+
+        const uint64_t frame_area = static_cast<uint64_t>(width) * height;
+        if (merged.area() * 100 > frame_area * params.max_coverage_pct) return 0;
+
+        for (const FrameRect& r : merged) {
+            if (count_ == kMaxAreas) break;
+            areas_[count_++] = { r, params.qp_delta };
+        }
+        return count_;
+    }
+
+    size_t size()  const { return count_; }
+    bool   empty() const { return count_ == 0; }
+    const RoiArea& operator[](size_t i) const { return areas_[i]; }
+    const RoiArea* begin() const { return areas_.data(); }
+    const RoiArea* end()   const { return areas_.data() + count_; }
+
+private:
+    static uint32_t align_down(uint32_t v) { return v / kMacroblock * kMacroblock; }
+    static uint32_t align_up(uint32_t v)   { return (v + kMacroblock - 1) / kMacroblock * kMacroblock; }
+
+    std::array<RoiArea, kMaxAreas> areas_{};
+    size_t count_ = 0;
+};
+
+} // namespace sr
@@ -0,0 +1,250 @@
+// sample_pool.cpp — IMFTrackedSample recycling (see sample_pool.h)
+
+#include "encoder/sample_pool.h"
+#include "utils/logging.h"
+
+namespace sr {
+
+namespace {
+
+// References beyond the pool's own two (its ComPtr and the sample's): a
+// shallow copy of the sample — MuxWriter's rebased samples — still holds it
+bool buffer_shared(IMFMediaBuffer* buffer) {
+    const ULONG refs = buffer->AddRef();
+    buffer->Release();
+    return refs > 3;   // includes the probe's own AddRef
+}
+
+} // namespace
+
+SamplePool* SamplePool::create(const wchar_t* name, uint32_t max_samples) {
+    auto* pool = new SamplePool();
+    pool->name_ = name ? name : L"";
+    pool->max_samples_ = max_samples > 0 ? max_samples : 1;
+    pool->entries_.reserve(pool->max_samples_);
+    return pool;
+}
+
+SamplePool::Entry* SamplePool::take_entry(DWORD bytes, bool bare) {
+    Entry* any_free = nullptr;
+    for (Entry& e : entries_) {
+        if (e.lent) continue;
+        const bool fits = bare ? !e.buffer
+                               : (!e.borrowed && e.buffer && e.capacity >= bytes);
+        if (fits) return &e;
+        if (!any_free) any_free = &e;
+    }
+    // A new entry before re-purposing a free one: memory entries keep their buffer
+    if (entries_.size() < max_samples_) return &entries_.emplace_back();
+    return any_free;
+}
+
+bool SamplePool::lend(Entry& e, ComPtr<IMFSample>& sample) {
+    if (!e.sample) {
+        ComPtr<IMFTrackedSample> tracked;
+        HRESULT hr = MFCreateTrackedSample(&tracked);
+        if (SUCCEEDED(hr)) hr = tracked.As(&e.sample);
+        if (FAILED(hr)) {
+            SR_LOG_ERROR(L"%s sample pool: MFCreateTrackedSample failed: 0x%08X", name_, hr);
+            return false;
+        }
+        created_.fetch_add(1, std::memory_order_relaxed);
+    } else {
+        recycled_.fetch_add(1, std::memory_order_relaxed);
+    }
+    if (e.buffer) {
+        e.sample->RemoveAllBuffers();
+        e.sample->AddBuffer(e.buffer.Get());
+    }
+
+    ComPtr<IMFTrackedSample> tracked;
+    HRESULT hr = e.sample.As(&tracked);
+    if (SUCCEEDED(hr)) hr = tracked->SetAllocator(this, nullptr);
+    if (FAILED(hr)) {
+        SR_LOG_ERROR(L"%s sample pool: SetAllocator failed: 0x%08X", name_, hr);
+        return false;
+    }
+    // No leftovers from the previous use (ROI blob, CleanPoint, discontinuity)
+    e.sample->DeleteAllItems();
+    e.sample->SetSampleFlags(0);
+
+    e.key  = e.sample.Get();
+    e.lent = true;
+    sample = std::move(e.sample);   // the pool holds no reference while lent
+    return true;
+}
+
+bool SamplePool::acquire(DWORD bytes, ComPtr<IMFSample>& sample, ComPtr<IMFMediaBuffer>& buffer) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        Entry* e = shutdown_ ? nullptr : take_entry(bytes);
+        if (e) {
+            if (e->borrowed || !e->buffer || e->capacity < bytes) {
+                e->buffer.Reset();
+                e->borrowed = false;
+                e->capacity = 0;
+                const HRESULT hr = MFCreateMemoryBuffer(bytes, &e->buffer);
+                if (FAILED(hr)) {
+                    SR_LOG_ERROR(L"%s sample pool: MFCreateMemoryBuffer(%u) failed: 0x%08X",
+                                 name_, bytes, hr);
+                    return false;
+                }
+                e->capacity = bytes;
+            }
+            e->buffer->SetCurrentLength(0);
+            buffer = e->buffer;
+            return lend(*e, sample);
+        }
+    }
+
+    // Every sample is in flight (or shutting down): one transient sample
+    transient_warning();
+    HRESULT hr = MFCreateSample(sample.ReleaseAndGetAddressOf());
+    if (SUCCEEDED(hr)) hr = MFCreateMemoryBuffer(bytes, buffer.ReleaseAndGetAddressOf());
+    if (SUCCEEDED(hr)) hr = sample->AddBuffer(buffer.Get());
+    return SUCCEEDED(hr);
+}
+
+bool SamplePool::acquire_surface(ID3D11Texture2D* surface, DWORD length, ComPtr<IMFSample>& sample) {
+    if (!surface) return false;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        Entry* e = shutdown_ ? nullptr : take_entry(0, /*bare=*/true);
+        if (e) {
+            // The wrapper references the texture, so it lives only while the
+            // sample is lent (dropped again in Invoke)
+            e->buffer.Reset();
+            e->borrowed = false;
+            e->capacity = 0;
+            const HRESULT hr = MFCreateDXGISurfaceBuffer(__uuidof(ID3D11Texture2D), surface, 0,
+                                                         FALSE, &e->buffer);
+            if (FAILED(hr)) {
+                SR_LOG_ERROR(L"%s sample pool: MFCreateDXGISurfaceBuffer failed: 0x%08X", name_, hr);
+                return false;
+            }
+            e->surface = true;
+            e->buffer->SetCurrentLength(length);
+            return lend(*e, sample);
+        }
+    }
+
+    transient_warning();
+    ComPtr<IMFMediaBuffer> buffer;
+    HRESULT hr = MFCreateSample(sample.ReleaseAndGetAddressOf());
+    if (SUCCEEDED(hr)) hr = MFCreateDXGISurfaceBuffer(__uuidof(ID3D11Texture2D), surface, 0, FALSE, &buffer);
+    if (SUCCEEDED(hr)) hr = buffer->SetCurrentLength(length);
+    if (SUCCEEDED(hr)) hr = sample->AddBuffer(buffer.Get());
+    return SUCCEEDED(hr);
+}
+
+bool SamplePool::acquire_shared(IMFMediaBuffer* buffer, ComPtr<IMFSample>& sample) {
+    if (!buffer) return false;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        Entry* e = shutdown_ ? nullptr : take_entry(0, /*bare=*/true);
+        if (e) {
+            // Gives up whatever the entry cached: shared samples come in runs
+            // (a muted stretch), so that is rare
+            e->buffer   = buffer;
+            e->capacity = 0;
+            e->borrowed = true;
+            return lend(*e, sample);
+        }
+    }
+
+    transient_warning();
+    HRESULT hr = MFCreateSample(sample.ReleaseAndGetAddressOf());
+    if (SUCCEEDED(hr)) hr = sample->AddBuffer(buffer);
+    return SUCCEEDED(hr);
+}
+
+void SamplePool::transient_warning() {
+    const uint32_t n = transient_.fetch_add(1, std::memory_order_relaxed) + 1;
+    if (n == 1 || (n % 1000) == 0) {
+        SR_LOG_WARN(L"%s sample pool: all %u samples in flight, transient sample (count=%u)",
+                    name_, max_samples_, n);
+    }
+}
+
+void SamplePool::shutdown() {
+    std::vector<Entry> released;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        shutdown_ = true;
+        for (Entry& e : entries_) {
+            if (e.lent) continue;
+            released.push_back(std::move(e));
+            e = Entry{};
+        }
+    }
+    // Free samples are not armed, so releasing them here just destroys them
+}
+
+uint32_t SamplePool::free_samples() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    uint32_t n = 0;
+    for (const Entry& e : entries_) n += (!e.lent && e.sample) ? 1 : 0;
+    return n;
+}
+
+HRESULT STDMETHODCALLTYPE SamplePool::Invoke(IMFAsyncResult* result) {
+    ComPtr<IUnknown>  object;
+    ComPtr<IMFSample> sample;
+    if (!result || FAILED(result->GetObject(&object)) || FAILED(object.As(&sample))) return S_OK;
+
+    Entry dropped;   // released after the lock
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (Entry& e : entries_) {
+        if (!e.lent || e.key != sample.Get()) continue;
+        e.lent = false;
+        e.key  = nullptr;
+        if (shutdown_) {
+            dropped = std::move(e);
+            e = Entry{};
+            break;
+        }
+        e.sample = sample;
+        if (e.borrowed || e.surface) {
+            // Not ours to recycle / holds a texture its owner reclaims by
+            // refcount (the NV12 rings): only the bare sample stays cached
+            e.sample->RemoveAllBuffers();
+            dropped.buffer = std::move(e.buffer);
+            e.borrowed = false;
+            e.surface  = false;
+        } else if (e.buffer && buffer_shared(e.buffer.Get())) {
+            // Someone still reads this buffer: the next use gets a fresh one
+            e.sample->RemoveAllBuffers();
+            dropped.buffer = std::move(e.buffer);
+            e.capacity = 0;
+        }
+        break;
+    }
+    return S_OK;
+}
+
+HRESULT STDMETHODCALLTYPE SamplePool::GetParameters(DWORD*, DWORD*) {
+    return E_NOTIMPL;
+}
+
+ULONG STDMETHODCALLTYPE SamplePool::AddRef() {
+    return ref_.fetch_add(1, std::memory_order_relaxed) + 1;
+}
+
+ULONG STDMETHODCALLTYPE SamplePool::Release() {
+    const ULONG refs = ref_.fetch_sub(1, std::memory_order_acq_rel) - 1;
+    if (refs == 0) delete this;
+    return refs;
+}
+
+HRESULT STDMETHODCALLTYPE SamplePool::QueryInterface(REFIID riid, void** ppv) {
+    if (!ppv) return E_POINTER;
+    if (riid == __uuidof(IUnknown) || riid == __uuidof(IMFAsyncCallback)) {
+        *ppv = static_cast<IMFAsyncCallback*>(this);
+        AddRef();
+        return S_OK;
+    }
+    *ppv = nullptr;
+    return E_NOINTERFACE;
+}
+
+} // namespace sr
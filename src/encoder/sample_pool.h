@@ -0,0 +1,114 @@
+#pragma once
+// sample_pool.h — Recycling pool of IMFTrackedSamples for the encode/mux path
+//
+// Every sample the pool hands out is an IMFTrackedSample armed with the pool
+// as its allocator: when the last reference goes away — the MFT finished
+// with an input, ProcessOutput returned NEED_MORE_INPUT, the sink writer wrote
+// the sample — Media Foundation calls Invoke() and the sample (with its
+// buffer) goes back on the free list. Steady-state encoding therefore
+// creates no MF samples or memory buffers:
+//   acquire()          memory-backed sample, buffer of at least `bytes`
+//                      (SW encoder input, MFT-allocated-by-us output, audio)
+//   acquire_surface()  sample wrapping a D3D11 texture. The DXGI surface
+//                      buffer is dropped on return: it references the
+//                      texture, and the NV12 rings treat any reference
+//                      beyond their own as "still in use"
+//   acquire_shared()   sample carrying a caller-owned, read-only buffer
+//                      (the audio stage's cached silence); it is detached
+//                      again on return
+// A returned sample whose buffer is still referenced elsewhere (a shallow
+// copy sharing it) keeps the sample but gives up the buffer.
+// Past max_samples in flight the pool falls back to a transient, untracked
+// sample and counts it. Media Foundation may run the release callback on one
+// of its work-queue threads, so a sample can take a moment to become free.
+//
+// COM lifetime: outstanding samples hold a reference to the pool (their
+// allocator), so it is heap-allocated and ref-counted like AsyncMftPump.
+// Call shutdown() before releasing it; samples returned afterwards are freed.
+
+#include <windows.h>
+#include <mfapi.h>
+#include <mfidl.h>
+#include <d3d11.h>
+#include <wrl/client.h>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace sr {
+
+using Microsoft::WRL::ComPtr;
+
+class SamplePool : public IMFAsyncCallback {
+public:
+    // `name` labels log lines; refcount 1 on return
+    static SamplePool* create(const wchar_t* name, uint32_t max_samples);
+
+    // Sample with one memory buffer of capacity >= bytes, attributes cleared
+    bool acquire(DWORD bytes, ComPtr<IMFSample>& sample, ComPtr<IMFMediaBuffer>& buffer);
+    bool acquire(DWORD bytes, ComPtr<IMFSample>& sample) {
+        ComPtr<IMFMediaBuffer> buffer;
+        return acquire(bytes, sample, buffer);
+    }
+
+    // Sample whose buffer wraps `surface` with current length `length`
+    bool acquire_surface(ID3D11Texture2D* surface, DWORD length, ComPtr<IMFSample>& sample);
+
+    // Sample carrying `buffer` as-is. Every sample sharing it sees the same
+    // contents and current length, so it must not change while any is in flight.
+    bool acquire_shared(IMFMediaBuffer* buffer, ComPtr<IMFSample>& sample);
+
+    // Drop the free list and stop recycling; outstanding samples are freed on release
+    void shutdown();
+
+    const wchar_t* name() const { return name_; }
+    uint32_t created()   const { return created_.load(std::memory_order_relaxed); }    // tracked samples
+    uint32_t transient() const { return transient_.load(std::memory_order_relaxed); }  // pool-full fallbacks
+    uint32_t recycled()  const { return recycled_.load(std::memory_order_relaxed); }
+    uint32_t free_samples() const;
+
+    // IUnknown
+    ULONG   STDMETHODCALLTYPE AddRef() override;
+    ULONG   STDMETHODCALLTYPE Release() override;
+    HRESULT STDMETHODCALLTYPE QueryInterface(REFIID riid, void** ppv) override;
+
+    // IMFAsyncCallback — a lent sample's last reference was released
+    HRESULT STDMETHODCALLTYPE GetParameters(DWORD* flags, DWORD* queue) override;
+    HRESULT STDMETHODCALLTYPE Invoke(IMFAsyncResult* result) override;
+
+private:
+    SamplePool() = default;
+    ~SamplePool() = default;
+
+    struct Entry {
+        IMFSample*             key = nullptr;      // identity while lent (no reference)
+        ComPtr<IMFSample>      sample;             // held only while free
+        ComPtr<IMFMediaBuffer> buffer;
+        DWORD                  capacity = 0;       // memory buffers
+        bool                   surface  = false;   // `buffer` wraps a texture (acquire_surface)
+        bool                   borrowed = false;   // `buffer` is the caller's (acquire_shared)
+        bool                   lent     = false;
+    };
+
+    // Under mutex_: a free entry matching the request, else a new one while
+    // under max_samples_, else any free entry. Nullptr when all are lent.
+    // bare = the caller brings its own buffer: prefer entries without one.
+    Entry* take_entry(DWORD bytes, bool bare = false);
+    void   transient_warning();
+    bool   lend(Entry& e, ComPtr<IMFSample>& sample);
+
+    std::atomic<ULONG>    ref_{ 1 };
+    const wchar_t*        name_        = L"";
+    uint32_t              max_samples_ = 0;
+
+    mutable std::mutex    mutex_;
+    std::vector<Entry>    entries_;     // reserved up front: Entry pointers stay valid
+    bool                  shutdown_    = false;
+
+    std::atomic<uint32_t> created_{ 0 };
+    std::atomic<uint32_t> transient_{ 0 };
+    std::atomic<uint32_t> recycled_{ 0 };
+};
+
+} // namespace sr
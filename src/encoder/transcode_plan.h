@@ -0,0 +1,57 @@
+#pragma once
+// transcode_plan.h — Output size, bitrate and worker count of a background transcode
+//
+// TranscodeQueue re-encodes finished recordings into a second rendition
+// (smaller, or another codec). The decoder's video processor scales on the
+// GPU, so the plan only decides the numbers:
+//
+//   - size: fit inside the rendition's box, keep the aspect ratio, never
+//     upscale, even dimensions (NV12 chroma is subsampled 2x2)
+//   - bitrate: the rendition's, or the source's scaled by the pixel count
+//   - workers: concurrent jobs, capped so the queue never holds more
+//     hardware encode sessions than a live recording would need free
+
+#include <algorithm>
+#include <cstdint>
+
+namespace sr {
+
+struct TranscodeSize {
+    uint32_t width  = 0;
+    uint32_t height = 0;
+};
+
+constexpr uint32_t kTranscodeMinBitrate = 250'000;
+constexpr uint32_t kTranscodeMaxWorkers = 4;
+
+// `max_width` / `max_height` 0 = unconstrained on that axis
+inline TranscodeSize transcode_frame_size(uint32_t src_width, uint32_t src_height,
+                                          uint32_t max_width, uint32_t max_height) {
+    if (src_width == 0 || src_height == 0) return {};
+    double scale = 1.0;
+    if (max_width  > 0) scale = (std::min)(scale, static_cast<double>(max_width)  / src_width);
+    if (max_height > 0) scale = (std::min)(scale, static_cast<double>(max_height) / src_height);
+    auto even = [](double v) { return (std::max)(2u, static_cast<uint32_t>(v + 0.5) & ~1u); };
+    return { even(src_width * scale), even(src_height * scale) };
+}
+
+// `requested_bps` 0 = keep the source's bits per pixel
+inline uint32_t transcode_bitrate(uint32_t requested_bps, uint32_t source_bps,
+                                  TranscodeSize source, TranscodeSize output) {
+    if (requested_bps > 0) return (std::max)(requested_bps, kTranscodeMinBitrate);
+    const uint64_t src_pixels = uint64_t{ source.width } * source.height;
+    const uint64_t out_pixels = uint64_t{ output.width } * output.height;
+    if (source_bps == 0 || src_pixels == 0) return 4'000'000;
+    const uint64_t bps = uint64_t{ source_bps } * out_pixels / src_pixels;
+    return static_cast<uint32_t>((std::clamp)(bps, uint64_t{ kTranscodeMinBitrate }, uint64_t{ source_bps }));
+}
+
+// `hw_sessions`: the adapter's concurrent hardware encoder limit; one stays
+// free for the recording that pauses the queue
+inline uint32_t transcode_worker_count(uint32_t requested, uint32_t hw_sessions) {
+    uint32_t workers = (std::clamp)(requested, 1u, kTranscodeMaxWorkers);
+    if (hw_sessions > 1) workers = (std::min)(workers, hw_sessions - 1);
+    return workers;
+}
+
+} // namespace sr
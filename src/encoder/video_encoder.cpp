@@ -3,6 +3,9 @@
 // Chain: HW MFT -> SW MFT (1080p) -> SW MFT (720p30)
 
 #include "encoder/video_encoder.h"
+#include "encoder/async_mft_pump.h"
+#include "encoder/nv12_copy.h"
+#include "encoder/sample_pool.h"
 #include "utils/logging.h"
 
 #include <mfapi.h>
@@ -13,7 +16,9 @@
 #include <wmcodecdsp.h>
 #include <d3d11.h>
 #include <d3d11_1.h>
+#include <algorithm>
 #include <cstdlib>
+#include <cstring>
 #include <atomic>
 
 #pragma comment(lib, "mfplat.lib")
@@ -31,26 +36,6 @@ static HRESULT SetUINT64Attr(IMFAttributes* a, REFGUID k, UINT64 v) {
     return a->SetUINT64(k, v);
 }
 
-static HRESULT CreateMftOutputSample(uint32_t sample_size, IMFSample** sample_out) {
-    if (!sample_out) return E_POINTER;
-    *sample_out = nullptr;
-
-    ComPtr<IMFSample> sample;
-    ComPtr<IMFMediaBuffer> buffer;
-
-    HRESULT hr = MFCreateSample(&sample);
-    if (FAILED(hr)) return hr;
-
-    hr = MFCreateMemoryBuffer(sample_size, &buffer);
-    if (FAILED(hr)) return hr;
-
-    hr = sample->AddBuffer(buffer.Get());
-    if (FAILED(hr)) return hr;
-
-    *sample_out = sample.Detach();
-    return S_OK;
-}
-
 static void LogProcessOutputFailureRateLimited(HRESULT hr) {
     static std::atomic<uint32_t> fail_count{ 0 };
     static std::atomic<long> last_hr{ S_OK };
@@ -68,60 +53,8 @@ static void LogProcessOutputFailureRateLimited(HRESULT hr) {
     }
 }
 
-bool VideoEncoder::pump_hw_events(uint32_t wait_ms) {
-    if (!hw_async_mft_ || !hw_events_) {
-        return true;
-    }
-
-    const ULONGLONG deadline = GetTickCount64() + wait_ms;
-    bool saw_event = false;
-
-    while (true) {
-        ComPtr<IMFMediaEvent> event;
-        const HRESULT hr = hw_events_->GetEvent(MF_EVENT_FLAG_NO_WAIT, &event);
-        if (hr == MF_E_NO_EVENTS_AVAILABLE) {
-            if (wait_ms == 0 || saw_event || GetTickCount64() >= deadline) {
-                return true;
-            }
-            Sleep(1);
-            continue;
-        }
-        if (FAILED(hr)) {
-            SR_LOG_WARN(L"HW MFT GetEvent failed: 0x%08X", hr);
-            return false;
-        }
-
-        saw_event = true;
-
-        HRESULT status = S_OK;
-        event->GetStatus(&status);
-        if (FAILED(status)) {
-            SR_LOG_WARN(L"HW MFT event status failed: 0x%08X", status);
-        }
-
-        MediaEventType type = MEUnknown;
-        if (FAILED(event->GetType(&type))) {
-            continue;
-        }
-
-        switch (type) {
-            case METransformNeedInput:
-                ++hw_need_input_events_;
-                break;
-            case METransformHaveOutput:
-                ++hw_have_output_events_;
-                break;
-            case METransformDrainComplete:
-                hw_drain_complete_ = true;
-                break;
-            default:
-                break;
-        }
-    }
-}
-
-// Configure output H.264 media type on the MFT
-static HRESULT ConfigureOutputType(IMFTransform* mft,
+// Configure the compressed output media type (H.264 / HEVC / AV1) on the MFT
+static HRESULT ConfigureOutputType(IMFTransform* mft, VideoCodec codec,
                                    uint32_t w, uint32_t h,
                                    uint32_t fps_num, uint32_t fps_den,
                                    uint32_t bitrate)
@@ -131,13 +64,13 @@ static HRESULT ConfigureOutputType(IMFTransform* mft,
     if (FAILED(hr)) return hr;
 
     out_type->SetGUID(MF_MT_MAJOR_TYPE, MFMediaType_Video);
-    out_type->SetGUID(MF_MT_SUBTYPE,    MFVideoFormat_H264);
+    out_type->SetGUID(MF_MT_SUBTYPE,    video_codec_subtype(codec));
     MFSetAttributeSize(out_type.Get(), MF_MT_FRAME_SIZE, w, h);
     MFSetAttributeRatio(out_type.Get(), MF_MT_FRAME_RATE, fps_num, fps_den);
     MFSetAttributeRatio(out_type.Get(), MF_MT_PIXEL_ASPECT_RATIO, 1, 1);
     out_type->SetUINT32(MF_MT_AVG_BITRATE,            bitrate);
     out_type->SetUINT32(MF_MT_INTERLACE_MODE,         MFVideoInterlace_Progressive);
-    out_type->SetUINT32(MF_MT_MPEG2_PROFILE,          eAVEncH264VProfile_Main);
+    out_type->SetUINT32(MF_MT_MPEG2_PROFILE,          video_codec_profile(codec));
     out_type->SetUINT32(MF_MT_VIDEO_NOMINAL_RANGE,    MFNominalRange_16_235);
 
     return mft->SetOutputType(0, out_type.Get(), 0);
@@ -164,8 +97,9 @@ static HRESULT ConfigureInputType(IMFTransform* mft,
     return mft->SetInputType(0, in_type.Get(), 0);
 }
 
-// Apply encoder codec attributes (CBR, low-latency, no B-frames, ~1s GOP)
-static void ApplyEncoderAttributes(IMFTransform* mft, uint32_t fps,
+// Apply encoder codec attributes (CBR, low-latency, no B-frames, GOP of
+// gop_frames or ~1s when 0)
+static void ApplyEncoderAttributes(IMFTransform* mft, uint32_t fps, uint32_t gop_frames,
                                    uint32_t bitrate, bool is_hw)
 {
     ComPtr<ICodecAPI> codec_api;
@@ -192,28 +126,60 @@ static void ApplyEncoderAttributes(IMFTransform* mft, uint32_t fps,
     v.ulVal = 0;
     codec_api->SetValue(&CODECAPI_AVEncMPVDefaultBPictureCount, &v);
 
-    // GOP size = 1 * fps (about 1 second)
+    // GOP size = 1 * fps (about 1 second) unless the profile overrides it
     v.vt   = VT_UI4;
-    v.ulVal = fps;
+    v.ulVal = gop_frames > 0 ? gop_frames : fps;
     codec_api->SetValue(&CODECAPI_AVEncMPVGOPSize, &v);
 
     (void)is_hw;
 }
 
+// CODECAPI_AVEncLowPowerEncoder (codecapi.h in newer SDKs): VT_UI4,
+// 1 = battery-optimized fixed-function path, 0 = quality
+static constexpr GUID kAVEncLowPowerEncoder =
+    { 0xb668d582, 0x8bad, 0x4f6a, { 0x91, 0x41, 0x37, 0x5a, 0x95, 0x35, 0x8b, 0x6d } };
+
+// Turn on per-sample ROI (MFSampleExtension_ROIRectangle) where the MFT supports it
+static bool EnableRegionOfInterest(IMFTransform* mft) {
+    ComPtr<ICodecAPI> codec_api;
+    if (FAILED(mft->QueryInterface(IID_PPV_ARGS(&codec_api)))) return false;
+    if (codec_api->IsSupported(&CODECAPI_AVEncVideoROIEnabled) != S_OK) return false;
+
+    VARIANT v{};
+    v.vt    = VT_UI4;
+    v.ulVal = 1;
+    return SUCCEEDED(codec_api->SetValue(&CODECAPI_AVEncVideoROIEnabled, &v));
+}
+
 // ---------------------------------------------------------------------------
-// VideoEncoder::try_init_hw
+// VideoEncoder::try_init_hw — HW codecs in preference order (H.264 last)
 // ---------------------------------------------------------------------------
 bool VideoEncoder::try_init_hw(const EncoderProfile& profile,
                                 IMFDXGIDeviceManager* dxgi_mgr)
 {
     if (!dxgi_mgr) return false;
-    hw_events_.Reset();
-    hw_async_mft_ = false;
-    hw_need_input_events_ = 0;
-    hw_have_output_events_ = 0;
-    hw_drain_complete_ = false;
 
-    MFT_REGISTER_TYPE_INFO out_info{ MFMediaType_Video, MFVideoFormat_H264 };
+    std::array<VideoCodec, 3> order{};
+    const size_t n = codec_try_order(profile.codec, order);
+    for (size_t i = 0; i < n; ++i) {
+        if (try_init_hw_codec(profile, dxgi_mgr, order[i])) return true;
+        if (i + 1 < n) {
+            SR_LOG_INFO(L"HW %s encoder unavailable — trying %s",
+                        video_codec_label(order[i]), video_codec_label(order[i + 1]));
+        }
+    }
+    return false;
+}
+
+bool VideoEncoder::try_init_hw_codec(const EncoderProfile& profile,
+                                      IMFDXGIDeviceManager* dxgi_mgr,
+                                      VideoCodec codec)
+{
+    roi_enabled_ = false;
+    stop_hw_pump();
+
+    const uint32_t bitrate_bps = codec_bitrate(profile.bitrate_bps, codec);
+    MFT_REGISTER_TYPE_INFO out_info{ MFMediaType_Video, video_codec_subtype(codec) };
     IMFActivate** activates = nullptr;
     UINT32 count = 0;
 
@@ -224,7 +190,7 @@ bool VideoEncoder::try_init_hw(const EncoderProfile& profile,
         &activates, &count);
 
     if (FAILED(hr) || count == 0) {
-        SR_LOG_INFO(L"No hardware H.264 encoder found");
+        SR_LOG_INFO(L"No hardware %s encoder found", video_codec_label(codec));
         if (activates) { for (UINT32 i = 0; i < count; ++i) activates[i]->Release(); CoTaskMemFree(activates); }
         return false;
     }
@@ -257,11 +223,15 @@ bool VideoEncoder::try_init_hw(const EncoderProfile& profile,
         WCHAR name[256]{};
         activates[i]->GetString(MFT_FRIENDLY_NAME_Attribute, name, 256, nullptr);
 
+        UINT32 is_async = FALSE;
+        if (attrs) attrs->GetUINT32(MF_TRANSFORM_ASYNC, &is_async);
+
         // Configure output then input types
-        hr = ConfigureOutputType(mft.Get(), profile.width, profile.height,
-                                  profile.fps, 1, profile.bitrate_bps);
+        hr = ConfigureOutputType(mft.Get(), codec, profile.width, profile.height,
+                                  profile.fps, 1, bitrate_bps);
         if (FAILED(hr)) {
-            SR_LOG_WARN(L"HW MFT '%s': SetOutputType failed (0x%08X)", name, hr);
+            SR_LOG_WARN(L"HW MFT '%s': SetOutputType(%s) failed (0x%08X)",
+                        name, video_codec_label(codec), hr);
             activates[i]->ShutdownObject();
             continue;
         }
@@ -273,7 +243,9 @@ bool VideoEncoder::try_init_hw(const EncoderProfile& profile,
             continue;
         }
 
-        ApplyEncoderAttributes(mft.Get(), profile.fps, profile.bitrate_bps, true);
+        ApplyEncoderAttributes(mft.Get(), profile.fps, profile.gop_frames, bitrate_bps, true);
+        roi_enabled_ = EnableRegionOfInterest(mft.Get());
+        apply_tuning(mft.Get(), EncoderMode::HardwareMFT, false);
 
         hr = mft->ProcessMessage(MFT_MESSAGE_COMMAND_FLUSH, 0);
         hr = mft->ProcessMessage(MFT_MESSAGE_NOTIFY_BEGIN_STREAMING, 0);
@@ -281,11 +253,12 @@ bool VideoEncoder::try_init_hw(const EncoderProfile& profile,
 
         mft_  = mft;
         mode_ = EncoderMode::HardwareMFT;
+        codec_ = codec;
+        active_bitrate_bps_ = bitrate_bps;
         out_width_  = profile.width;
         out_height_ = profile.height;
         out_fps_    = profile.fps;
         hw_path_    = true;
-        hw_async_mft_ = SUCCEEDED(mft.As(&hw_events_)) && hw_events_;
 
         MFT_OUTPUT_STREAM_INFO output_stream_info{};
         hr = mft_->GetOutputStreamInfo(0, &output_stream_info);
@@ -297,13 +270,23 @@ bool VideoEncoder::try_init_hw(const EncoderProfile& profile,
             mft_output_sample_size_ = 1 << 20;
         }
 
-        if (hw_async_mft_) {
-            pump_hw_events(50);
+        // Async MFTs are driven by METransformNeedInput/HaveOutput events
+        if (is_async) {
+            hw_pump_ = AsyncMftPump::start(mft_.Get(), mft_provides_output_samples_,
+                                           mft_output_sample_size_, output_samples_);
+            if (!hw_pump_) {
+                SR_LOG_WARN(L"HW MFT '%s': async event pump failed to start, skipping", name);
+                mft_.Reset();
+                hw_path_ = false;
+                activates[i]->ShutdownObject();
+                continue;
+            }
         }
+        hw_async_mft_ = hw_pump_ != nullptr;
 
-        SR_LOG_INFO(L"HW H.264 encoder active: %s (%ux%u @ %u fps, %u bps, async=%s)",
-            name, profile.width, profile.height, profile.fps, profile.bitrate_bps,
-            hw_async_mft_ ? L"yes" : L"no");
+        SR_LOG_INFO(L"HW %s encoder active: %s (%ux%u @ %u fps, %u bps, async=%s, roi=%s)",
+            video_codec_label(codec), name, profile.width, profile.height, profile.fps, bitrate_bps,
+            hw_async_mft_ ? L"yes" : L"no", roi_enabled_ ? L"yes" : L"no");
 
         for (UINT32 j = 0; j < count; ++j) activates[j]->Release();
         CoTaskMemFree(activates);
@@ -319,15 +302,14 @@ bool VideoEncoder::try_init_hw(const EncoderProfile& profile,
 // VideoEncoder::try_init_sw
 // ---------------------------------------------------------------------------
 bool VideoEncoder::try_init_sw(const EncoderProfile& profile,
-                                uint32_t width, uint32_t height, uint32_t fps)
+                                uint32_t width, uint32_t height, uint32_t fps,
+                                VideoCodec codec)
 {
-    hw_events_.Reset();
-    hw_async_mft_ = false;
-    hw_need_input_events_ = 0;
-    hw_have_output_events_ = 0;
-    hw_drain_complete_ = false;
+    stop_hw_pump();
+    roi_enabled_ = false;  // the inbox SW encoder has no ROI support
 
-    MFT_REGISTER_TYPE_INFO out_info{ MFMediaType_Video, MFVideoFormat_H264 };
+    const uint32_t bitrate_bps = codec_bitrate(profile.bitrate_bps, codec);
+    MFT_REGISTER_TYPE_INFO out_info{ MFMediaType_Video, video_codec_subtype(codec) };
     IMFActivate** activates = nullptr;
     UINT32 count = 0;
 
@@ -338,7 +320,7 @@ bool VideoEncoder::try_init_sw(const EncoderProfile& profile,
         &activates, &count);
 
     if (FAILED(hr) || count == 0) {
-        SR_LOG_ERROR(L"No software H.264 encoder found");
+        SR_LOG_ERROR(L"No software %s encoder found", video_codec_label(codec));
         if (activates) { for (UINT32 i = 0; i < count; ++i) activates[i]->Release(); CoTaskMemFree(activates); }
         return false;
     }
@@ -350,19 +332,22 @@ bool VideoEncoder::try_init_sw(const EncoderProfile& profile,
         WCHAR name[256]{};
         activates[i]->GetString(MFT_FRIENDLY_NAME_Attribute, name, 256, nullptr);
 
-        hr = ConfigureOutputType(mft.Get(), width, height, fps, 1,
-                                  profile.bitrate_bps);
+        hr = ConfigureOutputType(mft.Get(), codec, width, height, fps, 1, bitrate_bps);
         if (FAILED(hr)) { activates[i]->ShutdownObject(); continue; }
 
         hr = ConfigureInputType(mft.Get(), width, height, fps, 1);
         if (FAILED(hr)) { activates[i]->ShutdownObject(); continue; }
 
-        ApplyEncoderAttributes(mft.Get(), fps, profile.bitrate_bps, false);
+        ApplyEncoderAttributes(mft.Get(), fps, profile.gop_frames, bitrate_bps, false);
+        apply_tuning(mft.Get(), width == 1280 ? EncoderMode::SoftwareMFT720p : EncoderMode::SoftwareMFT,
+                     false);
 
         hr = mft->ProcessMessage(MFT_MESSAGE_NOTIFY_BEGIN_STREAMING, 0);
         hr = mft->ProcessMessage(MFT_MESSAGE_NOTIFY_START_OF_STREAM, 0);
 
         mft_       = mft;
+        codec_      = codec;
+        active_bitrate_bps_ = bitrate_bps;
         out_width_  = width;
         out_height_ = height;
         out_fps_    = fps;
@@ -380,10 +365,11 @@ bool VideoEncoder::try_init_sw(const EncoderProfile& profile,
 
         if (width == 1280) {
             mode_ = EncoderMode::SoftwareMFT720p;
-            SR_LOG_WARN(L"SW H.264 (720p30 degraded fallback): %s", name);
+            SR_LOG_WARN(L"SW %s (720p30 degraded fallback): %s", video_codec_label(codec), name);
         } else {
             mode_ = EncoderMode::SoftwareMFT;
-            SR_LOG_INFO(L"SW H.264 encoder: %s (%ux%u @ %u fps)", name, width, height, fps);
+            SR_LOG_INFO(L"SW %s encoder: %s (%ux%u @ %u fps)", video_codec_label(codec),
+                        name, width, height, fps);
         }
 
         for (UINT32 j = 0; j < count; ++j) activates[j]->Release();
@@ -405,17 +391,11 @@ bool VideoEncoder::initialize(const EncoderProfile& profile,
                                ID3D11Device* d3d_device,
                                ID3D11DeviceContext* d3d_context)
 {
-    d3d_device_  = d3d_device;
-    d3d_context_ = d3d_context;
-    if (dxgi_mgr) dxgi_mgr_ = dxgi_mgr;
+    begin_initialize(profile, dxgi_mgr, d3d_device, d3d_context);
 
     SR_LOG_INFO(L"[Encoder Fallback Chain] Starting — profile: %ux%u @ %u fps, %u bps",
                 profile.width, profile.height, profile.fps, profile.bitrate_bps);
 
-    active_bitrate_bps_ = profile.bitrate_bps;
-    hw_output_fail_count_ = 0;
-    switched_to_sw_due_to_hw_errors_ = false;
-
     wchar_t* order_env = nullptr;
     size_t order_env_len = 0;
     _wdupenv_s(&order_env, &order_env_len, L"SR_ENCODER_ORDER");
@@ -499,96 +479,212 @@ bool VideoEncoder::initialize(const EncoderProfile& profile,
 // ---------------------------------------------------------------------------
 // VideoEncoder::encode_frame
 // ---------------------------------------------------------------------------
-bool VideoEncoder::encode_frame(ID3D11Texture2D* nv12_texture, int64_t pts,
-                                 ComPtr<IMFSample>& out_sample)
+void VideoEncoder::begin_initialize(const EncoderProfile& profile,
+                                    IMFDXGIDeviceManager* dxgi_mgr,
+                                    ID3D11Device* d3d_device,
+                                    ID3D11DeviceContext* d3d_context)
 {
-    if (!initialized_ || !mft_) return false;
+    d3d_device_  = d3d_device;
+    d3d_context_ = d3d_context;
+    if (dxgi_mgr) dxgi_mgr_ = dxgi_mgr;
 
-    // Create an IMFSample wrapping the NV12 texture
-    ComPtr<IMFSample>      sample;
-    ComPtr<IMFMediaBuffer> buffer;
+    active_bitrate_bps_ = profile.bitrate_bps;
+    requested_bitrate_bps_ = profile.bitrate_bps;
+    gop_frames_ = profile.gop_frames;
+    hw_output_fail_count_ = 0;
+    switched_to_sw_due_to_hw_errors_ = false;
 
-    HRESULT hr = MFCreateSample(&sample);
-    if (FAILED(hr)) return false;
+    if (!input_samples_)  input_samples_  = SamplePool::create(L"Video input", kInputPoolSamples);
+    if (!output_samples_) output_samples_ = SamplePool::create(L"Video output", kOutputPoolSamples);
+}
 
-    if (hw_path_) {
-        // HW path: wrap D3D11 texture in MF DXGI buffer
-        hr = MFCreateDXGISurfaceBuffer(
-            __uuidof(ID3D11Texture2D),
-            nv12_texture,
-            0,      // subresource index
-            FALSE,  // bottomUpWhenLinear
-            &buffer);
-        if (FAILED(hr)) {
-            SR_LOG_ERROR(L"MFCreateDXGISurfaceBuffer failed: 0x%08X", hr);
-            return false;
-        }
+// ---------------------------------------------------------------------------
+// VideoEncoder::initialize_mode — one step of the chain, no fallback
+// ---------------------------------------------------------------------------
+bool VideoEncoder::initialize_mode(EncoderMode mode,
+                                    const EncoderProfile& profile,
+                                    IMFDXGIDeviceManager* dxgi_mgr,
+                                    ID3D11Device* d3d_device,
+                                    ID3D11DeviceContext* d3d_context)
+{
+    begin_initialize(profile, dxgi_mgr, d3d_device, d3d_context);
+    bool ok = false;
+    switch (mode) {
+        case EncoderMode::HardwareMFT:
+            ok = try_init_hw(profile, dxgi_mgr);
+            break;
+        case EncoderMode::SoftwareMFT:
+            ok = try_init_sw(profile, profile.width, profile.height, profile.fps);
+            break;
+        case EncoderMode::SoftwareMFT720p:
+            ok = try_init_sw(profile, 1280, 720, 30);
+            break;
+    }
+    SR_LOG_INFO(L"[Encoder] Forced mode %s: %s", encoder_mode_label(mode), ok ? L"ready" : L"failed");
+    initialized_ = ok;
+    return ok;
+}
 
+bool VideoEncoder::encode_frame(ID3D11Texture2D* nv12_texture, int64_t pts,
+                                 ComPtr<IMFSample>& out_sample,
+                                 const DirtyRegion* dirty)
+{
+    if (!initialized_ || !mft_) return false;
+
+    if (hw_path_) {
+        // HW path: a pooled sample whose DXGI buffer wraps this ring texture
         D3D11_TEXTURE2D_DESC td{};
         nv12_texture->GetDesc(&td);
         const DWORD total = static_cast<DWORD>((td.Width * td.Height * 3) / 2);
-        hr = buffer->SetCurrentLength(total);
-        if (FAILED(hr)) {
-            SR_LOG_ERROR(L"DXGI input buffer SetCurrentLength failed: 0x%08X", hr);
-            return false;
-        }
-    } else {
-        // SW path: read back texture to system memory using pre-allocated staging
-        D3D11_TEXTURE2D_DESC td{};
-        nv12_texture->GetDesc(&td);
+        ComPtr<IMFSample> sample;
+        if (!input_samples_->acquire_surface(nv12_texture, total, sample)) return false;
 
-        if (!ensure_staging_texture(td.Width, td.Height)) return false;
+        sample->SetSampleTime(pts);
+        sample->SetSampleDuration(10'000'000LL / static_cast<int64_t>(out_fps_));
+        if (roi_enabled_ && dirty) attach_roi(sample.Get(), *dirty);
 
-        d3d_context_->CopyResource(staging_tex_.Get(), nv12_texture);
+        return submit_input(sample.Get(),
+                            force_keyframe_next_.exchange(false, std::memory_order_acq_rel),
+                            out_sample);
+    }
 
-        D3D11_MAPPED_SUBRESOURCE mapped{};
-        hr = d3d_context_->Map(staging_tex_.Get(), 0, D3D11_MAP_READ, 0, &mapped);
-        if (FAILED(hr)) return false;
+    // SW path: queue a GPU copy into the staging ring, then read back the
+    // oldest slot once its copy is kStagingRingSize-1 frames old.
+    D3D11_TEXTURE2D_DESC td{};
+    nv12_texture->GetDesc(&td);
 
-        // NV12: tightly pack Y + UV planes to match stride=width media type.
-        const uint32_t tight_stride = td.Width;
-        uint32_t y_size  = tight_stride * td.Height;
-        uint32_t uv_size = tight_stride * (td.Height / 2);
-        DWORD total = y_size + uv_size;
+    if (!ensure_staging_texture(td.Width, td.Height)) return false;
 
-        hr = MFCreateMemoryBuffer(total, &buffer);
-        BYTE* buf_data = nullptr;
-        buffer->Lock(&buf_data, nullptr, nullptr);
+    // The keyframe request travels with the staged frame so the IDR lands on
+    // the first post-resume frame rather than on an older buffered one.
+    const bool force_keyframe =
+        force_keyframe_next_.exchange(false, std::memory_order_acq_rel);
+    const auto slot = staging_ring_.stage(pts, force_keyframe);
+    if (!slot) return false;  // unreachable: the ring is drained below on every call
+    d3d_context_->CopyResource(staging_tex_[*slot].Get(), nv12_texture);
 
-        const uint8_t* src = static_cast<uint8_t*>(mapped.pData);
-        uint8_t* dst = buf_data;
+    if (!staging_ring_.ready()) {
+        return false;  // priming the ring — no input for the MFT yet
+    }
 
-        // Copy Y plane row-by-row
-        for (uint32_t row = 0; row < td.Height; ++row) {
-            std::memcpy(dst + row * tight_stride,
-                        src + row * mapped.RowPitch,
-                        tight_stride);
-        }
+    const bool oldest_force_keyframe = staging_ring_.slot(staging_ring_.oldest()).force_keyframe;
+    ComPtr<IMFSample> input;
+    if (!read_back_oldest(input)) return false;
 
-        // Copy UV plane row-by-row
-        const uint8_t* src_uv = src + (mapped.RowPitch * td.Height);
-        uint8_t* dst_uv = dst + y_size;
-        for (uint32_t row = 0; row < td.Height / 2; ++row) {
-            std::memcpy(dst_uv + row * tight_stride,
-                        src_uv + row * mapped.RowPitch,
-                        tight_stride);
+    return submit_input(input.Get(), oldest_force_keyframe, out_sample);
+}
+
+// ---------------------------------------------------------------------------
+// VideoEncoder::attach_roi — boost QP in the changed areas of this frame
+// ---------------------------------------------------------------------------
+void VideoEncoder::attach_roi(IMFSample* sample, const DirtyRegion& dirty) {
+    if (roi_map_.build(dirty, out_width_, out_height_) == 0) return;
+
+    std::array<ROI_AREA, RoiMap::kMaxAreas> areas{};
+    size_t n = 0;
+    for (const RoiArea& a : roi_map_) {
+        areas[n].rect    = { static_cast<LONG>(a.rect.left),  static_cast<LONG>(a.rect.top),
+                             static_cast<LONG>(a.rect.right), static_cast<LONG>(a.rect.bottom) };
+        areas[n].QPDelta = a.qp_delta;
+        ++n;
+    }
+    if (SUCCEEDED(sample->SetBlob(MFSampleExtension_ROIRectangle,
+                                  reinterpret_cast<const UINT8*>(areas.data()),
+                                  static_cast<UINT32>(n * sizeof(ROI_AREA))))) {
+        ++roi_frames_;
+    }
+}
+
+// ---------------------------------------------------------------------------
+// VideoEncoder::read_back_oldest — Map the oldest staged copy into a pooled sample
+// ---------------------------------------------------------------------------
+bool VideoEncoder::read_back_oldest(ComPtr<IMFSample>& input) {
+    if (staging_ring_.empty()) return false;
+
+    const size_t idx = staging_ring_.oldest();
+    const auto meta = staging_ring_.slot(idx);
+    ID3D11Texture2D* staging = staging_tex_[idx].Get();
+
+    // The copy was issued kStagingRingSize-1 frames ago, so it has normally
+    // completed; only block if the GPU is badly behind.
+    D3D11_MAPPED_SUBRESOURCE mapped{};
+    HRESULT hr = d3d_context_->Map(staging, 0, D3D11_MAP_READ, D3D11_MAP_FLAG_DO_NOT_WAIT, &mapped);
+    if (hr == DXGI_ERROR_WAS_STILL_DRAWING) {
+        ++staging_map_waits_;
+        if (staging_map_waits_ == 1 || (staging_map_waits_ % 120) == 0) {
+            SR_LOG_WARN(L"Staging readback still in flight, blocking Map (count=%u)",
+                        staging_map_waits_);
         }
+        hr = d3d_context_->Map(staging, 0, D3D11_MAP_READ, 0, &mapped);
+    }
+    if (FAILED(hr)) {
+        SR_LOG_ERROR(L"Staging texture Map failed: 0x%08X", hr);
+        staging_ring_.release_oldest();
+        return false;
+    }
 
-        buffer->Unlock();
-        buffer->SetCurrentLength(total);
+    // NV12: tightly pack Y + UV planes to match stride=width media type.
+    const DWORD total = static_cast<DWORD>(nv12_tight_size(staging_width_, staging_height_));
 
-        d3d_context_->Unmap(staging_tex_.Get(), 0);
+    ComPtr<IMFMediaBuffer> buffer;
+    BYTE* buf_data = nullptr;
+    if (!input_samples_->acquire(total, input, buffer) ||
+        FAILED(buffer->Lock(&buf_data, nullptr, nullptr)) || !buf_data) {
+        d3d_context_->Unmap(staging, 0);
+        staging_ring_.release_oldest();
+        return false;
     }
 
-    sample->AddBuffer(buffer.Get());
-    sample->SetSampleTime(pts);
+    copy_nv12_tight(buf_data, static_cast<const uint8_t*>(mapped.pData), mapped.RowPitch,
+                    staging_width_, staging_height_);
+
+    buffer->Unlock();
+    buffer->SetCurrentLength(total);
 
-    // Compute duration (100ns)
-    int64_t duration = 10'000'000LL / static_cast<int64_t>(out_fps_);
-    sample->SetSampleDuration(duration);
+    d3d_context_->Unmap(staging, 0);
+    staging_ring_.release_oldest();
+
+    input->SetSampleTime(meta.pts);
+    input->SetSampleDuration(10'000'000LL / static_cast<int64_t>(out_fps_));
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// VideoEncoder::acquire_output_sample — pooled sample for an MFT that wants ours
+// ---------------------------------------------------------------------------
+bool VideoEncoder::acquire_output_sample(IMFSample** out) {
+    ComPtr<IMFSample> sample;
+    if (!output_samples_->acquire(mft_output_sample_size_, sample)) {
+        SR_LOG_ERROR(L"Failed to allocate MFT output sample");
+        return false;
+    }
+    // ProcessOutput's caller owns this reference; a NEED_MORE_INPUT release
+    // hands the sample straight back to the pool
+    *out = sample.Detach();
+    return true;
+}
+
+void VideoEncoder::release_sample_pools() {
+    for (SamplePool** pool : { &input_samples_, &output_samples_ }) {
+        if (!*pool) continue;
+        SR_LOG_INFO(L"[Encoder] %s sample pool: %u created, %u recycled, %u transient",
+                    (*pool)->name(), (*pool)->created(), (*pool)->recycled(), (*pool)->transient());
+        (*pool)->shutdown();
+        (*pool)->Release();
+        *pool = nullptr;
+    }
+}
+
+// ---------------------------------------------------------------------------
+// VideoEncoder::submit_input — ProcessInput + drain one output sample
+// ---------------------------------------------------------------------------
+bool VideoEncoder::submit_input(IMFSample* sample, bool force_keyframe,
+                                ComPtr<IMFSample>& out_sample)
+{
+    HRESULT hr = S_OK;
 
     // Force IDR keyframe if requested (e.g. after resume from pause)
-    if (force_keyframe_next_.exchange(false, std::memory_order_acq_rel)) {
+    if (force_keyframe) {
         ComPtr<ICodecAPI> codec_api;
         if (SUCCEEDED(mft_->QueryInterface(IID_PPV_ARGS(&codec_api)))) {
             VARIANT v{};
@@ -600,52 +696,27 @@ bool VideoEncoder::encode_frame(ID3D11Texture2D* nv12_texture, int64_t pts,
     }
 
     if (hw_async_mft_) {
-        pump_hw_events(0);
-        if (hw_need_input_events_ == 0 && hw_have_output_events_ == 0) {
-            pump_hw_events(5);
-        }
+        return submit_input_async(sample, out_sample);
     }
 
-    // Feed to MFT. Async hardware MFTs must request input first.
-    if (!hw_async_mft_ || hw_need_input_events_ > 0) {
-        hr = mft_->ProcessInput(0, sample.Get(), 0);
-        if (SUCCEEDED(hr) && hw_async_mft_ && hw_need_input_events_ > 0) {
-            --hw_need_input_events_;
-        }
-        if (FAILED(hr) && hr != MF_E_NOTACCEPTING) {
-            SR_LOG_ERROR(L"ProcessInput failed: 0x%08X", hr);
-            return false;
-        }
-    } else if (hw_have_output_events_ == 0) {
+    // Feed to MFT
+    hr = mft_->ProcessInput(0, sample, 0);
+    if (FAILED(hr) && hr != MF_E_NOTACCEPTING) {
+        SR_LOG_ERROR(L"ProcessInput failed: 0x%08X", hr);
         return false;
     }
 
-    if (hw_async_mft_) {
-        pump_hw_events(2);
-    }
-
     // Drain available output. Some encoders buffer internally and may not
     // return a sample for every input frame.
     while (true) {
-        if (hw_async_mft_ && hw_have_output_events_ == 0) {
-            return false;
-        }
-
         MFT_OUTPUT_DATA_BUFFER out_buf{};
         DWORD status = 0;
 
-        if (!mft_provides_output_samples_) {
-            HRESULT alloc_hr = CreateMftOutputSample(mft_output_sample_size_, &out_buf.pSample);
-            if (FAILED(alloc_hr)) {
-                SR_LOG_ERROR(L"Failed to allocate MFT output sample: 0x%08X", alloc_hr);
-                return false;
-            }
+        if (!mft_provides_output_samples_ && !acquire_output_sample(&out_buf.pSample)) {
+            return false;
         }
 
         hr = mft_->ProcessOutput(0, 1, &out_buf, &status);
-        if (hw_async_mft_ && hw_have_output_events_ > 0) {
-            --hw_have_output_events_;
-        }
 
         if (hr == MF_E_TRANSFORM_NEED_MORE_INPUT) {
             if (out_buf.pSample) out_buf.pSample->Release();
@@ -687,6 +758,56 @@ bool VideoEncoder::encode_frame(ID3D11Texture2D* nv12_texture, int64_t pts,
     }
 }
 
+// ---------------------------------------------------------------------------
+// VideoEncoder::submit_input_async — hand a frame to the async HW MFT
+// Waits only for an input credit (METransformNeedInput); encoded output is
+// collected by the pump thread and returned here or from take_output().
+// ---------------------------------------------------------------------------
+bool VideoEncoder::submit_input_async(IMFSample* sample, ComPtr<IMFSample>& out_sample) {
+    // Same instability rule as the sync path, counted on the pump thread
+    if (hw_pump_->output_failures() >= 10 &&
+        hw_pump_->last_failure() == static_cast<HRESULT>(0x8000FFFF) &&
+        !switched_to_sw_due_to_hw_errors_)
+    {
+        if (switch_to_software_fallback()) {
+            switched_to_sw_due_to_hw_errors_ = true;
+            SR_LOG_WARN(L"HW encoder became unstable (0x8000FFFF, 10 consecutive failures). Switched to SW fallback for this session.");
+        }
+        return false;
+    }
+
+    // Bounded by ~2 frame intervals: a stalled encoder costs a dropped frame, not the queue
+    const uint32_t wait_ms = (std::max)(5u, 2000u / (std::max)(1u, out_fps_));
+    if (!hw_pump_->wait_for_input(wait_ms)) {
+        ++hw_input_waits_;
+        if (hw_input_waits_ == 1 || (hw_input_waits_ % 120) == 0) {
+            SR_LOG_WARN(L"Async HW MFT did not request input within %u ms (count=%u)",
+                        wait_ms, hw_input_waits_);
+        }
+        return take_output(out_sample);
+    }
+
+    const HRESULT hr = hw_pump_->process_input(sample);
+    if (FAILED(hr) && hr != MF_E_NOTACCEPTING) {
+        SR_LOG_ERROR(L"ProcessInput (async) failed: 0x%08X", hr);
+        return false;
+    }
+    return take_output(out_sample);
+}
+
+bool VideoEncoder::take_output(ComPtr<IMFSample>& out_sample) {
+    return hw_pump_ && hw_pump_->pop_output(out_sample);
+}
+
+void VideoEncoder::stop_hw_pump() {
+    if (hw_pump_) {
+        hw_pump_->stop();
+        hw_pump_->Release();
+        hw_pump_ = nullptr;
+    }
+    hw_async_mft_ = false;
+}
+
 bool VideoEncoder::switch_to_software_fallback() {
     if (!initialized_ || !mft_) return false;
 
@@ -695,16 +816,22 @@ bool VideoEncoder::switch_to_software_fallback() {
     const uint32_t fps = out_fps_;
 
     mft_->ProcessMessage(MFT_MESSAGE_NOTIFY_END_STREAMING, 0);
+    stop_hw_pump();
     mft_.Reset();
 
     EncoderProfile profile{};
     profile.width = width;
     profile.height = height;
     profile.fps = fps;
-    profile.bitrate_bps = active_bitrate_bps_;
-
-    if (!try_init_sw(profile, width, height, fps)) {
-        SR_LOG_ERROR(L"Failed to switch to SW fallback after HW encoder instability");
+    profile.bitrate_bps = requested_bitrate_bps_;
+    profile.gop_frames  = gop_frames_;
+
+    // The muxer's video track is already typed for codec_, so the SW encoder
+    // must produce the same codec (HEVC needs the HEVC Video Extensions; there
+    // is no inbox SW AV1 encoder).
+    if (!try_init_sw(profile, width, height, fps, codec_)) {
+        SR_LOG_ERROR(L"Failed to switch to SW %s fallback after HW encoder instability",
+                     video_codec_label(codec_));
         return false;
     }
 
@@ -713,60 +840,168 @@ bool VideoEncoder::switch_to_software_fallback() {
     return true;
 }
 
+// ---------------------------------------------------------------------------
+// VideoEncoder::sequence_header
+// ---------------------------------------------------------------------------
+bool VideoEncoder::sequence_header(std::vector<uint8_t>& out) const {
+    out.clear();
+    if (!mft_) return false;
+    ComPtr<IMFMediaType> type;
+    if (FAILED(mft_->GetOutputCurrentType(0, &type)) || !type) return false;
+    UINT32 size = 0;
+    if (FAILED(type->GetBlobSize(MF_MT_MPEG_SEQUENCE_HEADER, &size)) || size == 0) return false;
+    out.resize(size);
+    if (FAILED(type->GetBlob(MF_MT_MPEG_SEQUENCE_HEADER, out.data(), size, &size))) {
+        out.clear();
+        return false;
+    }
+    out.resize(size);
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// VideoEncoder::set_bitrate — runtime CBR target change (QualityGovernor)
+// ---------------------------------------------------------------------------
+bool VideoEncoder::set_bitrate(uint32_t h264_bps) {
+    if (!initialized_ || !mft_) return false;
+    const uint32_t bitrate_bps = codec_bitrate(h264_bps, codec_);
+    if (bitrate_bps == active_bitrate_bps_) return true;
+
+    ComPtr<ICodecAPI> codec_api;
+    if (FAILED(mft_->QueryInterface(IID_PPV_ARGS(&codec_api)))) return false;
+
+    // MeanBitRate is a dynamic property for CBR on the inbox and vendor MFTs;
+    // the new target takes effect on the next submitted frame.
+    VARIANT v{};
+    v.vt    = VT_UI4;
+    v.ulVal = bitrate_bps;
+    HRESULT hr = codec_api->SetValue(&CODECAPI_AVEncCommonMeanBitRate, &v);
+    if (FAILED(hr)) {
+        SR_LOG_WARN(L"VideoEncoder: runtime bitrate change to %u bps rejected (0x%08X)",
+                    bitrate_bps, hr);
+        return false;
+    }
+
+    SR_LOG_INFO(L"VideoEncoder: bitrate %u -> %u bps", active_bitrate_bps_, bitrate_bps);
+    active_bitrate_bps_    = bitrate_bps;
+    requested_bitrate_bps_ = h264_bps;  // a SW fallback keeps the reduced target
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// VideoEncoder::set_power_tuning / apply_tuning — speed/power knobs
+// ---------------------------------------------------------------------------
+void VideoEncoder::set_power_tuning(bool on_ac, bool high_quality) {
+    tuning_on_ac_        = on_ac;
+    tuning_high_quality_ = high_quality;
+    if (initialized_ && mft_) apply_tuning(mft_.Get(), mode_, true);
+}
+
+// At open (live = false) each knob is set if IsSupported; mid-stream only if
+// also IsModifiable. Low-power is a static property on most vendor MFTs, so
+// a battery switch usually gets the faster preset now and the fixed-function
+// path at the next open (resolution switch, next session).
+void VideoEncoder::apply_tuning(IMFTransform* mft, EncoderMode mode, bool live) {
+    ComPtr<ICodecAPI> codec_api;
+    if (FAILED(mft->QueryInterface(IID_PPV_ARGS(&codec_api)))) return;
+    if (!live) {
+        qvs_supported_       = codec_api->IsSupported(&CODECAPI_AVEncCommonQualityVsSpeed) == S_OK;
+        low_power_supported_ = codec_api->IsSupported(&kAVEncLowPowerEncoder) == S_OK;
+        tuning_ = EncoderTuning{};
+    }
+
+    const EncoderTuning want = encoder_tuning_for(mode, tuning_on_ac_, tuning_high_quality_);
+    EncoderTuning applied = tuning_;
+    VARIANT v{};
+    v.vt = VT_UI4;
+    if (qvs_supported_ && want.quality_vs_speed != tuning_.quality_vs_speed &&
+        (!live || codec_api->IsModifiable(&CODECAPI_AVEncCommonQualityVsSpeed) == S_OK)) {
+        v.ulVal = want.quality_vs_speed;
+        if (SUCCEEDED(codec_api->SetValue(&CODECAPI_AVEncCommonQualityVsSpeed, &v))) {
+            applied.quality_vs_speed = want.quality_vs_speed;
+        }
+    }
+    if (low_power_supported_ && want.low_power != tuning_.low_power) {
+        if (!live || codec_api->IsModifiable(&kAVEncLowPowerEncoder) == S_OK) {
+            v.ulVal = want.low_power ? 1 : 0;
+            if (SUCCEEDED(codec_api->SetValue(&kAVEncLowPowerEncoder, &v))) {
+                applied.low_power = want.low_power;
+            }
+        } else {
+            SR_LOG_INFO(L"VideoEncoder: low-power mode %s at the next encoder open",
+                        want.low_power ? L"on" : L"off");
+        }
+    }
+
+    if (!live || !(applied == tuning_)) {
+        SR_LOG_INFO(L"VideoEncoder: %s tuning %s (quality-vs-speed %u%s, low-power %s%s)",
+                    live ? L"power switch," : L"open,", encoder_tuning_label(applied),
+                    applied.quality_vs_speed, qvs_supported_ ? L"" : L" unsupported",
+                    applied.low_power ? L"on" : L"off", low_power_supported_ ? L"" : L" unsupported");
+    }
+    tuning_ = applied;
+}
+
+// ---------------------------------------------------------------------------
+// VideoEncoder::set_frame_rate — runtime cadence change (power-state switch)
+// ---------------------------------------------------------------------------
+bool VideoEncoder::set_frame_rate(uint32_t fps) {
+    if (!initialized_ || !mft_ || fps == 0) return false;
+    if (fps == out_fps_) return true;
+
+    const uint32_t gop = gop_frames_ > 0
+        ? (std::max)(1u, static_cast<uint32_t>(static_cast<uint64_t>(gop_frames_) * fps / out_fps_))
+        : fps;
+    ComPtr<ICodecAPI> codec_api;
+    if (SUCCEEDED(mft_->QueryInterface(IID_PPV_ARGS(&codec_api)))) {
+        VARIANT v{};
+        v.vt    = VT_UI4;
+        v.ulVal = gop;
+        HRESULT hr = codec_api->SetValue(&CODECAPI_AVEncMPVGOPSize, &v);
+        if (FAILED(hr)) {
+            // Not fatal: the IDR interval just stretches in time
+            SR_LOG_WARN(L"VideoEncoder: runtime GOP change to %u frames rejected (0x%08X)", gop, hr);
+        }
+    }
+
+    SR_LOG_INFO(L"VideoEncoder: frame rate %u -> %u fps (GOP %u)", out_fps_, fps, gop);
+    if (gop_frames_ > 0) gop_frames_ = gop;
+    out_fps_ = fps;
+    return true;
+}
+
 // ---------------------------------------------------------------------------
 // VideoEncoder::flush
 // ---------------------------------------------------------------------------
 bool VideoEncoder::flush(std::vector<ComPtr<IMFSample>>& out_samples) {
     if (!initialized_ || !mft_) return false;
 
+    // SW path: frames still parked in the staging ring have not reached the MFT yet.
+    while (!hw_path_ && !staging_ring_.empty()) {
+        const bool force_keyframe = staging_ring_.slot(staging_ring_.oldest()).force_keyframe;
+        ComPtr<IMFSample> input;
+        if (!read_back_oldest(input)) continue;
+        ComPtr<IMFSample> encoded;
+        if (submit_input(input.Get(), force_keyframe, encoded) && encoded) {
+            out_samples.push_back(std::move(encoded));
+        }
+    }
+
     // Some MFTs only emit buffered output after explicit end-of-stream signal.
     HRESULT eos_hr = mft_->ProcessMessage(MFT_MESSAGE_NOTIFY_END_OF_STREAM, 0);
     if (FAILED(eos_hr)) {
         SR_LOG_WARN(L"MFT_MESSAGE_NOTIFY_END_OF_STREAM failed: 0x%08X", eos_hr);
     }
 
+    if (hw_pump_) hw_pump_->begin_drain();
     mft_->ProcessMessage(MFT_MESSAGE_COMMAND_DRAIN, 0);
 
     if (hw_async_mft_) {
-        hw_drain_complete_ = false;
-        const ULONGLONG deadline = GetTickCount64() + 3000;
-
-        while (!hw_drain_complete_ && GetTickCount64() < deadline) {
-            pump_hw_events(10);
-
-            while (hw_have_output_events_ > 0) {
-                MFT_OUTPUT_DATA_BUFFER out_buf{};
-                DWORD status = 0;
-
-                if (!mft_provides_output_samples_) {
-                    HRESULT alloc_hr = CreateMftOutputSample(mft_output_sample_size_, &out_buf.pSample);
-                    if (FAILED(alloc_hr)) {
-                        SR_LOG_ERROR(L"Failed to allocate async MFT flush output sample: 0x%08X", alloc_hr);
-                        return false;
-                    }
-                }
-
-                HRESULT hr = mft_->ProcessOutput(0, 1, &out_buf, &status);
-                if (hw_have_output_events_ > 0) {
-                    --hw_have_output_events_;
-                }
-
-                if (FAILED(hr)) {
-                    SR_LOG_ERROR(L"Async ProcessOutput during flush failed: 0x%08X", hr);
-                    if (out_buf.pSample) out_buf.pSample->Release();
-                    if (out_buf.pEvents) out_buf.pEvents->Release();
-                    return false;
-                }
-
-                if (out_buf.pSample) {
-                    ComPtr<IMFSample> s;
-                    s.Attach(out_buf.pSample);
-                    out_samples.push_back(std::move(s));
-                }
-                if (out_buf.pEvents) out_buf.pEvents->Release();
-            }
+        if (!hw_pump_->wait_drained(3000)) {
+            SR_LOG_WARN(L"Async HW MFT drain did not complete within 3 s");
         }
-
+        ComPtr<IMFSample> sample;
+        while (hw_pump_->pop_output(sample)) out_samples.push_back(std::move(sample));
         return true;
     }
 
@@ -774,12 +1009,8 @@ bool VideoEncoder::flush(std::vector<ComPtr<IMFSample>>& out_samples) {
         MFT_OUTPUT_DATA_BUFFER out_buf{};
         DWORD status = 0;
 
-        if (!mft_provides_output_samples_) {
-            HRESULT alloc_hr = CreateMftOutputSample(mft_output_sample_size_, &out_buf.pSample);
-            if (FAILED(alloc_hr)) {
-                SR_LOG_ERROR(L"Failed to allocate MFT flush output sample: 0x%08X", alloc_hr);
-                break;
-            }
+        if (!mft_provides_output_samples_ && !acquire_output_sample(&out_buf.pSample)) {
+            break;
         }
 
         HRESULT hr = mft_->ProcessOutput(0, 1, &out_buf, &status);
@@ -808,10 +1039,15 @@ bool VideoEncoder::flush(std::vector<ComPtr<IMFSample>>& out_samples) {
 // VideoEncoder::ensure_staging_texture — lazy-init or resize staging texture
 // ---------------------------------------------------------------------------
 bool VideoEncoder::ensure_staging_texture(uint32_t width, uint32_t height) {
-    if (staging_tex_ && staging_width_ == width && staging_height_ == height) {
+    if (staging_tex_[0] && staging_width_ == width && staging_height_ == height) {
         return true;  // already correct size
     }
-    staging_tex_.Reset();
+    if (!staging_ring_.empty()) {
+        SR_LOG_WARN(L"Staging ring resized with %zu frames pending readback — discarding them",
+                    staging_ring_.pending());
+    }
+    staging_ring_.reset();
+    for (auto& tex : staging_tex_) tex.Reset();
 
     D3D11_TEXTURE2D_DESC td{};
     td.Width            = width;
@@ -825,14 +1061,18 @@ bool VideoEncoder::ensure_staging_texture(uint32_t width, uint32_t height) {
     td.CPUAccessFlags   = D3D11_CPU_ACCESS_READ;
     td.MiscFlags        = 0;
 
-    HRESULT hr = d3d_device_->CreateTexture2D(&td, nullptr, &staging_tex_);
-    if (FAILED(hr)) {
-        SR_LOG_ERROR(L"ensure_staging_texture: CreateTexture2D(%ux%u) failed: 0x%08X", width, height, hr);
-        return false;
+    for (auto& tex : staging_tex_) {
+        HRESULT hr = d3d_device_->CreateTexture2D(&td, nullptr, &tex);
+        if (FAILED(hr)) {
+            SR_LOG_ERROR(L"ensure_staging_texture: CreateTexture2D(%ux%u) failed: 0x%08X", width, height, hr);
+            for (auto& t : staging_tex_) t.Reset();
+            return false;
+        }
     }
     staging_width_  = width;
     staging_height_ = height;
-    SR_LOG_INFO(L"Staging texture allocated: %ux%u NV12", width, height);
+    staging_map_waits_ = 0;
+    SR_LOG_INFO(L"Staging ring allocated: %zu x %ux%u NV12", kStagingRingSize, width, height);
     return true;
 }
 
@@ -842,17 +1082,17 @@ bool VideoEncoder::ensure_staging_texture(uint32_t width, uint32_t height) {
 void VideoEncoder::shutdown() {
     if (mft_) {
         mft_->ProcessMessage(MFT_MESSAGE_NOTIFY_END_STREAMING, 0);
-        mft_.Reset();
     }
-    hw_events_.Reset();
-    staging_tex_.Reset();
+    stop_hw_pump();
+    mft_.Reset();
+    for (auto& tex : staging_tex_) tex.Reset();
+    staging_ring_.reset();
     staging_width_  = 0;
     staging_height_ = 0;
+    release_sample_pools();
     initialized_ = false;
-    hw_async_mft_ = false;
-    hw_need_input_events_ = 0;
-    hw_have_output_events_ = 0;
-    hw_drain_complete_ = false;
+    roi_enabled_ = false;
+    hw_input_waits_ = 0;
 }
 
 } // namespace sr
@@ -1,7 +1,8 @@
 #pragma once
-// video_encoder.h — Media Foundation H.264 hardware encoder with 3-step fallback chain
-// T013: CBR, 2s GOP, low-latency, no B-frames. Baseline/Main profile.
-// Fallback chain: HW MFT -> SW MFT (same res) -> 720p30 SW
+// video_encoder.h — Media Foundation H.264/HEVC/AV1 encoder with 3-step fallback chain
+// T013: CBR, 2s GOP, low-latency, no B-frames. Main profile.
+// Fallback chain: HW MFT (codecs in EncoderProfile::codec order) -> SW H.264 MFT
+// (same res) -> 720p30 SW H.264
 
 #include <windows.h>
 #include <mfapi.h>
@@ -9,19 +10,21 @@
 #include <mfreadwrite.h>
 #include <mftransform.h>
 #include <wrl/client.h>
+#include <array>
 #include <atomic>
 #include <cstdint>
+#include <vector>
+#include "encoder/encoder_tuning.h"
+#include "encoder/readback_ring.h"
+#include "encoder/roi_map.h"
 #include "utils/render_frame.h"
 
 namespace sr {
 
 using Microsoft::WRL::ComPtr;
 
-enum class EncoderMode {
-    HardwareMFT,        // Intel Quick Sync or other HW MFT
-    SoftwareMFT,        // SW MFT, original resolution
-    SoftwareMFT720p,    // SW MFT, 720p30 degraded fallback
-};
+class AsyncMftPump;
+class SamplePool;
 
 class VideoEncoder {
 public:
@@ -33,65 +36,143 @@ public:
     bool initialize(const EncoderProfile& profile, IMFDXGIDeviceManager* dxgi_mgr,
                     ID3D11Device* d3d_device, ID3D11DeviceContext* d3d_context);
 
+    // Open exactly one step of the fallback chain (benchmarks, diagnostics).
+    // SoftwareMFT720p encodes 1280x720 @ 30; feed textures at output_width()
+    // x output_height(). Runtime HW->SW fallback still applies.
+    bool initialize_mode(EncoderMode mode, const EncoderProfile& profile,
+                         IMFDXGIDeviceManager* dxgi_mgr,
+                         ID3D11Device* d3d_device, ID3D11DeviceContext* d3d_context);
+
     // Encode one NV12 frame.  pts is in 100ns units.
     // Encoded bytes are appended to out_samples (as IMFSample AddRef'd pointers).
     // Caller must Release() each sample after writing it to the muxer.
+    // dirty (optional): changed areas in output coordinates, used for ROI
+    // QP hints when the HW encoder supports them.
     bool encode_frame(ID3D11Texture2D* nv12_texture, int64_t pts,
-                      ComPtr<IMFSample>& out_sample);
+                      ComPtr<IMFSample>& out_sample,
+                      const DirtyRegion* dirty = nullptr);
+
+    // Async HW path: pop an encoded sample that became ready after the last
+    // encode_frame() call. Call until false to keep the mux stage current.
+    bool take_output(ComPtr<IMFSample>& out_sample);
+
+    // Codec private data (MF_MT_MPEG_SEQUENCE_HEADER: SPS/PPS, VPS/SPS/PPS or
+    // AV1 sequence header OBU) from the MFT's current output type, if exposed
+    bool sequence_header(std::vector<uint8_t>& out) const;
 
     // Drain remaining frames from encoder
     bool flush(std::vector<ComPtr<IMFSample>>& out_samples);
 
     void shutdown();
 
+    // Change the CBR target mid-stream (H.264-equivalent, scaled per codec
+    // like the profile bitrate). Returns false if the MFT rejects it.
+    bool set_bitrate(uint32_t h264_bps);
+
+    // Change the frame rate fed to the encoder mid-stream. The GOP length
+    // follows so the IDR interval stays the same in time; the media types keep
+    // their frame rate (fixed once streaming) and sample times carry the cadence.
+    bool set_frame_rate(uint32_t fps);
+
+    // Power state for the speed/power knobs (encoder_tuning.h). Takes effect
+    // at the next initialize and, when open, live for each knob the MFT
+    // allows to change mid-stream; the rest wait for the next open.
+    void set_power_tuning(bool on_ac, bool high_quality);
+
     // Request that the next encoded frame be a keyframe (IDR).
     // Call this immediately on resume from pause to ensure seekability.
     void request_keyframe() { force_keyframe_next_.store(true, std::memory_order_release); }
 
     EncoderMode  mode()         const { return mode_; }
+    VideoCodec   codec()        const { return codec_; }
     uint32_t     output_width() const { return out_width_; }
     uint32_t     output_height()const { return out_height_; }
     uint32_t     output_fps()   const { return out_fps_; }
     uint32_t     output_bitrate() const { return active_bitrate_bps_; }
+    bool         roi_enabled()  const { return roi_enabled_; }
+    uint32_t     roi_frames()   const { return roi_frames_; }  // frames sent with ROI areas
+    EncoderTuning tuning()      const { return tuning_; }      // knobs currently applied
 
 private:
+    void begin_initialize(const EncoderProfile& profile, IMFDXGIDeviceManager* dxgi_mgr,
+                          ID3D11Device* d3d_device, ID3D11DeviceContext* d3d_context);
     bool try_init_hw(const EncoderProfile& profile, IMFDXGIDeviceManager* dxgi_mgr);
-    bool try_init_sw(const EncoderProfile& profile, uint32_t width, uint32_t height, uint32_t fps);
+    bool try_init_hw_codec(const EncoderProfile& profile, IMFDXGIDeviceManager* dxgi_mgr,
+                           VideoCodec codec);
+    bool try_init_sw(const EncoderProfile& profile, uint32_t width, uint32_t height, uint32_t fps,
+                     VideoCodec codec = VideoCodec::H264);
     bool configure_encoder(IMFTransform* mft, uint32_t width, uint32_t height,
                            uint32_t fps, uint32_t bitrate_bps, bool use_hw);
     bool switch_to_software_fallback();
-    bool pump_hw_events(uint32_t wait_ms);
+    void apply_tuning(IMFTransform* mft, EncoderMode mode, bool live);
+
+    // Feed one input sample to the MFT and pull at most one encoded sample
+    bool submit_input(IMFSample* input, bool force_keyframe, ComPtr<IMFSample>& out_sample);
+    bool submit_input_async(IMFSample* input, ComPtr<IMFSample>& out_sample);
+    void stop_hw_pump();
+
+    // SW path: Map the oldest staged slot, copy it into a pooled input sample, release the slot
+    bool read_back_oldest(ComPtr<IMFSample>& input);
+    void attach_roi(IMFSample* sample, const DirtyRegion& dirty);
+    bool acquire_output_sample(IMFSample** out);
+    void release_sample_pools();
 
     ComPtr<IMFTransform>       mft_;
-    ComPtr<IMFMediaEventGenerator> hw_events_;
     ComPtr<IMFDXGIDeviceManager> dxgi_mgr_;
     ComPtr<ID3D11Device>       d3d_device_;
     ComPtr<ID3D11DeviceContext> d3d_context_;
 
     EncoderMode mode_        = EncoderMode::SoftwareMFT;
+    VideoCodec  codec_       = VideoCodec::H264;
     uint32_t    out_width_   = 1920;
     uint32_t    out_height_  = 1080;
     uint32_t    out_fps_     = 30;
     bool        initialized_ = false;
     bool        mft_provides_output_samples_ = true;
     uint32_t    mft_output_sample_size_      = 1 << 20;
-    uint32_t    active_bitrate_bps_          = 4'000'000;
+    uint32_t    active_bitrate_bps_          = 4'000'000;  // after codec scaling
+    uint32_t    requested_bitrate_bps_       = 4'000'000;  // H.264-equivalent from the profile
+    uint32_t    gop_frames_                  = 0;          // profile GOP override (0 = fps)
 
     // For HW path: need staging texture to share with MFT
     bool        hw_path_     = false;
     uint32_t    hw_output_fail_count_ = 0;
     bool        switched_to_sw_due_to_hw_errors_ = false;
     bool        hw_async_mft_ = false;
-    uint32_t    hw_need_input_events_ = 0;
-    uint32_t    hw_have_output_events_ = 0;
-    bool        hw_drain_complete_ = false;
-
-    // Pre-allocated staging texture for SW encoder path (avoids per-frame alloc)
-    ComPtr<ID3D11Texture2D> staging_tex_;
+    AsyncMftPump* hw_pump_    = nullptr;  // owned reference; see AsyncMftPump
+    uint32_t    hw_input_waits_ = 0;      // encode_frame calls that got no input credit
+
+    // HW path: dirty-rect driven ROI (CODECAPI_AVEncVideoROIEnabled)
+    bool        roi_enabled_ = false;
+    uint32_t    roi_frames_  = 0;
+    RoiMap      roi_map_;
+
+    // Speed/power knobs: requested power state, what the MFT accepted
+    bool          tuning_on_ac_        = true;
+    bool          tuning_high_quality_ = false;
+    EncoderTuning tuning_;
+    bool          qvs_supported_       = false;  // CODECAPI_AVEncCommonQualityVsSpeed
+    bool          low_power_supported_ = false;  // CODECAPI_AVEncLowPowerEncoder
+
+    // Pre-allocated staging ring for SW encoder path (avoids per-frame alloc).
+    // Frame N is copied while frame N-(kStagingRingSize-1) is mapped, so Map
+    // never waits on an in-flight CopyResource.
+    static constexpr size_t kStagingRingSize = 3;
+    std::array<ComPtr<ID3D11Texture2D>, kStagingRingSize> staging_tex_;
+    ReadbackRing<kStagingRingSize> staging_ring_;
     uint32_t    staging_width_  = 0;
     uint32_t    staging_height_ = 0;
+    uint32_t    staging_map_waits_ = 0;  // Map calls that still had to block
     bool ensure_staging_texture(uint32_t width, uint32_t height);
 
+    // Recycled input (DXGI-wrapped or SW readback) and MFT output samples;
+    // owned references, see SamplePool. Output covers the encoded-video
+    // queue plus what the MFT and sink writer hold.
+    static constexpr uint32_t kInputPoolSamples  = 8;
+    static constexpr uint32_t kOutputPoolSamples = 24;
+    SamplePool* input_samples_  = nullptr;
+    SamplePool* output_samples_ = nullptr;
+
     // Force next frame to be an IDR keyframe (set on resume from pause)
     std::atomic<bool> force_keyframe_next_{ false };
 };
@@ -0,0 +1,150 @@
+#pragma once
+// disk_space_monitor.h — Remaining-recording-time projection for the output volume
+//
+// Replaces the fixed 500 MB poll thread. The mux stage calls update() with
+// the bytes it has written so far this session; the monitor measures the
+// real write rate from that, and only asks the volume for its free space
+// when the projection says something may have changed: every 30 s while
+// hours remain, down to once a second in the last minutes. Between queries
+// free space is extrapolated from the bytes written since the last one.
+//
+// Levels only escalate until the projection recovers with some margin
+// (space freed elsewhere), so each warning is raised once.
+//
+// Pure logic (the free-space query is a callable) for unit tests.
+
+#include <algorithm>
+#include <cstdint>
+
+namespace sr {
+
+enum class DiskSpaceLevel : uint8_t {
+    Ok,
+    Low,        // under DiskSpaceThresholds::low_seconds of recording left
+    Critical,   // under critical_seconds left
+    Exhausted,  // under reserve_bytes free: stop now
+};
+
+struct DiskSpaceThresholds {
+    uint32_t low_seconds      = 10 * 60;
+    uint32_t critical_seconds = 2 * 60;
+    uint64_t reserve_bytes    = 500ull * 1024 * 1024;   // moov + rename headroom
+};
+
+struct DiskSpaceStatus {
+    DiskSpaceLevel level         = DiskSpaceLevel::Ok;
+    uint64_t       free_bytes    = 0;     // extrapolated to the last update()
+    uint64_t       bytes_per_sec = 0;     // smoothed session write rate
+    int64_t        remaining_s   = -1;    // -1 until a rate is known
+};
+
+class DiskSpaceMonitor {
+public:
+    static constexpr int64_t kMinQueryMs  = 1000;
+    static constexpr int64_t kMaxQueryMs  = 30'000;
+    static constexpr int64_t kRateWindowMs = 2000;   // shortest span a rate is taken over
+
+    void reset(const DiskSpaceThresholds& thresholds) {
+        thresholds_ = thresholds;
+        status_     = {};
+        started_    = false;
+        have_rate_  = false;
+    }
+
+    // `written`: session total (all segments); `query_free()` returns the
+    // volume's free bytes, 0 when unknown (an unknown volume never stops the
+    // recording). True when the level changed.
+    template <typename QueryFree>
+    bool update(int64_t now_ms, uint64_t written, QueryFree&& query_free) {
+        if (!started_) {
+            started_        = true;
+            rate_ms_        = now_ms;
+            rate_bytes_     = written;
+            query_written_  = written;
+            query_free_     = query_free();
+            next_query_ms_  = now_ms + kMinQueryMs;
+            status_.free_bytes = query_free_;
+            return classify();
+        }
+
+        if (now_ms - rate_ms_ >= kRateWindowMs) {
+            const uint64_t bytes = written >= rate_bytes_ ? written - rate_bytes_ : 0;
+            // Nothing written (paused): keep the last rate for when it resumes
+            if (bytes > 0) {
+                const uint64_t bps = bytes * 1000 / static_cast<uint64_t>(now_ms - rate_ms_);
+                // Smooth GOP-sized bursts; the first window is taken as-is
+                status_.bytes_per_sec = have_rate_ ? (status_.bytes_per_sec * 3 + bps) / 4 : bps;
+                have_rate_ = true;
+            }
+            rate_ms_    = now_ms;
+            rate_bytes_ = written;
+        }
+
+        const uint64_t since_query = written >= query_written_ ? written - query_written_ : 0;
+        if (now_ms >= next_query_ms_) {
+            const uint64_t measured = query_free();
+            if (measured > 0) {
+                query_free_    = measured;
+                query_written_ = written;
+            }
+            status_.free_bytes = measured > 0 ? measured : sub(query_free_, since_query);
+        } else {
+            status_.free_bytes = sub(query_free_, since_query);
+        }
+
+        const bool changed = classify();
+        // Query sooner as the margin shrinks; a tenth of the remaining time
+        // keeps the worst-case error in the projection under 10 %
+        if (now_ms >= next_query_ms_) {
+            int64_t interval = kMaxQueryMs;
+            if (status_.remaining_s >= 0) interval = std::clamp<int64_t>(status_.remaining_s * 100, kMinQueryMs, kMaxQueryMs);
+            next_query_ms_ = now_ms + interval;
+        }
+        return changed;
+    }
+
+    const DiskSpaceStatus& status() const { return status_; }
+
+private:
+    static uint64_t sub(uint64_t a, uint64_t b) { return a > b ? a - b : 0; }
+
+    bool classify() {
+        const uint64_t usable = sub(status_.free_bytes, thresholds_.reserve_bytes);
+        status_.remaining_s = (have_rate_ && status_.bytes_per_sec > 0)
+            ? static_cast<int64_t>(usable / status_.bytes_per_sec) : -1;
+
+        // Every tier needs a real measurement: an unknown volume (free space
+        // never reported) projects 0 s left and must not warn or stop
+        DiskSpaceLevel level = DiskSpaceLevel::Ok;
+        const bool known = query_free_ > 0;
+        if (known && status_.free_bytes < thresholds_.reserve_bytes) {
+            level = DiskSpaceLevel::Exhausted;
+        } else if (known && status_.remaining_s >= 0 && status_.remaining_s < thresholds_.critical_seconds) {
+            level = DiskSpaceLevel::Critical;
+        } else if (known && status_.remaining_s >= 0 && status_.remaining_s < thresholds_.low_seconds) {
+            level = DiskSpaceLevel::Low;
+        }
+
+        // De-escalate only with 50 % headroom over the tier's threshold
+        if (level < status_.level && status_.level != DiskSpaceLevel::Exhausted) {
+            const uint32_t tier = status_.level == DiskSpaceLevel::Critical
+                ? thresholds_.critical_seconds : thresholds_.low_seconds;
+            if (status_.remaining_s >= 0 && status_.remaining_s < int64_t{ tier } * 3 / 2) level = status_.level;
+        }
+        if (level == status_.level) return false;
+        status_.level = level;
+        return true;
+    }
+
+    DiskSpaceThresholds thresholds_;
+    DiskSpaceStatus     status_;
+    bool     started_       = false;
+    bool     have_rate_     = false;
+    int64_t  rate_ms_       = 0;
+    uint64_t rate_bytes_    = 0;
+    uint64_t query_written_ = 0;
+    uint64_t query_free_    = 0;
+    int64_t  next_query_ms_ = 0;
+};
+
+} // namespace sr
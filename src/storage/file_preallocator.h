@@ -0,0 +1,99 @@
+#pragma once
+// file_preallocator.h — Grow a recording's on-disk allocation in large steps
+//
+// Appending a multi-GB MP4 a few KB at a time makes NTFS extend the file (and
+// update its MFT record / bitmap) thousands of times and scatters the extents.
+// Instead MuxWriter reserves space ahead of the writer with FileAllocationInfo
+// in increments worth several minutes of the configured bitrate:
+//
+//   prealloc.reset(handle, preallocation_increment(bitrate_bps));
+//   prealloc.extend_for(bytes_written);   // after every sample (cheap compare)
+//   prealloc.trim();                      // before the handle is closed
+//
+// Allocation does not move end-of-file, so readers and the sink see no change.
+// If the volume cannot provide an increment, preallocation stops (logged once)
+// and recording continues; the disk-space poll still handles the final stop.
+
+#include <windows.h>
+#include <algorithm>
+#include <cstdint>
+#include "utils/logging.h"
+
+namespace sr {
+
+// Minutes of output reserved per allocation step
+inline constexpr uint32_t kPreallocMinutes = 5;
+
+// Bytes per allocation step for a stream of `bitrate_bps` (video + audio),
+// clamped to [64 MB, 1 GB]
+inline uint64_t preallocation_increment(uint32_t bitrate_bps) {
+    const uint64_t bytes = static_cast<uint64_t>(bitrate_bps) / 8 * 60 * kPreallocMinutes;
+    return (std::clamp)(bytes, uint64_t{ 64 } << 20, uint64_t{ 1 } << 30);
+}
+
+class FilePreallocator {
+public:
+    // handle needs GENERIC_WRITE; INVALID_HANDLE_VALUE disables preallocation
+    void reset(HANDLE file, uint64_t increment) {
+        file_       = file;
+        increment_  = increment;
+        allocated_  = 0;
+        extensions_ = 0;
+        exhausted_  = false;
+    }
+
+    bool active() const { return file_ != INVALID_HANDLE_VALUE && increment_ > 0 && !exhausted_; }
+
+    // Keep at least half an increment reserved beyond `bytes`. Returns false
+    // once the volume could not satisfy a step.
+    bool extend_for(uint64_t bytes) {
+        if (!active()) return !exhausted_;
+        if (bytes + increment_ / 2 <= allocated_) return true;
+
+        uint64_t target = ((bytes + increment_ / 2) / increment_ + 1) * increment_;
+        // bytes_written is payload only: never request less than the real EOF
+        // (a smaller AllocationSize truncates the file)
+        LARGE_INTEGER eof{};
+        if (GetFileSizeEx(file_, &eof) && static_cast<uint64_t>(eof.QuadPart) + increment_ / 2 > target) {
+            target = (static_cast<uint64_t>(eof.QuadPart) / increment_ + 1) * increment_;
+        }
+        FILE_ALLOCATION_INFO info{};
+        info.AllocationSize.QuadPart = static_cast<LONGLONG>(target);
+        if (!SetFileInformationByHandle(file_, FileAllocationInfo, &info, sizeof(info))) {
+            SR_LOG_WARN(L"Preallocation to %llu MB failed (%u); continuing without",
+                        target >> 20, GetLastError());
+            exhausted_ = true;
+            return false;
+        }
+        allocated_ = target;
+        ++extensions_;
+        return true;
+    }
+
+    // Release the reservation beyond the current end-of-file. Never below EOF:
+    // a smaller AllocationSize would truncate the file.
+    void trim() {
+        if (file_ == INVALID_HANDLE_VALUE || allocated_ == 0) return;
+        LARGE_INTEGER eof{};
+        if (!GetFileSizeEx(file_, &eof)) return;
+        FILE_ALLOCATION_INFO info{};
+        info.AllocationSize = eof;
+        if (!SetFileInformationByHandle(file_, FileAllocationInfo, &info, sizeof(info))) {
+            SR_LOG_WARN(L"Preallocation trim failed: %u", GetLastError());
+        }
+        allocated_ = 0;
+    }
+
+    uint64_t allocated()  const { return allocated_; }
+    uint32_t extensions() const { return extensions_; }
+    bool     exhausted()  const { return exhausted_; }
+
+private:
+    HANDLE   file_       = INVALID_HANDLE_VALUE;
+    uint64_t increment_  = 0;
+    uint64_t allocated_  = 0;
+    uint32_t extensions_ = 0;
+    bool     exhausted_  = false;
+};
+
+} // namespace sr
@@ -0,0 +1,141 @@
+#pragma once
+// gop_send_queue.h — Bounded send queue for the live-stream sink that drops whole GOPs
+//
+// The mux stage pushes every encoded video frame; the network thread pops
+// them as fast as the connection allows. When the queue holds more than
+// `max_latency` of video or `max_bytes`, the oldest GOPs are discarded up to
+// the next queued keyframe, so the stream falls behind by whole GOPs and
+// never sends a frame whose references were dropped. If no later keyframe
+// is queued everything goes, and frames are refused until the next
+// keyframe arrives. push() never blocks the mux stage.
+//
+// Thread-safe: one producer, one consumer.
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <utility>
+
+namespace sr {
+
+template <typename Frame>
+class GopSendQueue {
+public:
+    struct Entry {
+        Frame    frame;
+        int64_t  pts      = 0;   // 100ns
+        size_t   bytes    = 0;
+        bool     keyframe = false;
+    };
+
+    struct Stats {
+        uint64_t pushed         = 0;
+        uint64_t dropped_frames = 0;
+        uint64_t dropped_gops   = 0;   // drop events
+    };
+
+    void reset(int64_t max_latency_100ns, size_t max_bytes) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        max_latency_  = max_latency_100ns;
+        max_bytes_    = max_bytes;
+        entries_.clear();
+        bytes_        = 0;
+        waiting_key_  = true;   // a stream starts on a keyframe
+        closed_       = false;
+        stats_        = {};
+    }
+
+    // Drops `frame` (returns false) while waiting for a keyframe
+    bool push(Frame frame, int64_t pts, size_t bytes, bool keyframe) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (closed_) return false;
+            ++stats_.pushed;
+            if (waiting_key_ && !keyframe) {
+                ++stats_.dropped_frames;
+                return false;
+            }
+            waiting_key_ = false;
+            entries_.push_back(Entry{ std::move(frame), pts, bytes, keyframe });
+            bytes_ += bytes;
+            enforce_limits();
+            if (entries_.empty()) return false;
+        }
+        cv_.notify_one();
+        return true;
+    }
+
+    // Oldest frame; false on timeout or once closed and empty
+    bool pop(Entry& out, std::chrono::milliseconds wait) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (!cv_.wait_for(lock, wait, [this] { return !entries_.empty() || closed_; })) return false;
+        if (entries_.empty()) return false;
+        out = std::move(entries_.front());
+        entries_.pop_front();
+        bytes_ -= out.bytes;
+        return true;
+    }
+
+    // After a reconnect: discard what is queued, resume on a keyframe
+    void restart_at_keyframe() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stats_.dropped_frames += entries_.size();
+        entries_.clear();
+        bytes_ = 0;
+        waiting_key_ = true;
+    }
+
+    void close() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            closed_ = true;
+        }
+        cv_.notify_all();
+    }
+
+    size_t size() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return entries_.size();
+    }
+    Stats stats() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return stats_;
+    }
+
+private:
+    bool over_limit() const {
+        if (entries_.empty()) return false;
+        if (max_bytes_ > 0 && bytes_ > max_bytes_) return true;
+        return max_latency_ > 0 && entries_.back().pts - entries_.front().pts > max_latency_;
+    }
+
+    void enforce_limits() {
+        bool dropped = false;
+        while (over_limit()) {
+            dropped = true;
+            // Drop through the oldest GOP: up to (not including) the next keyframe
+            do {
+                bytes_ -= entries_.front().bytes;
+                entries_.pop_front();
+                ++stats_.dropped_frames;
+            } while (!entries_.empty() && !entries_.front().keyframe);
+            if (entries_.empty()) waiting_key_ = true;
+        }
+        if (dropped) ++stats_.dropped_gops;
+    }
+
+    mutable std::mutex      mutex_;
+    std::condition_variable cv_;
+    std::deque<Entry>       entries_;
+    int64_t                 max_latency_ = 0;
+    size_t                  max_bytes_   = 0;
+    size_t                  bytes_       = 0;
+    bool                    waiting_key_ = true;
+    bool                    closed_      = false;
+    Stats                   stats_;
+};
+
+} // namespace sr
@@ -0,0 +1,148 @@
+#pragma once
+// keyframe_index.h — Keyframe index sidecar (<recording>.keyidx)
+//
+// MuxWriter feeds every written video sample through on_video_sample(); the
+// clean points (MFSampleExtension_CleanPoint) are kept as (PTS, frame number,
+// video stream bytes before the keyframe) and saved next to the finished file.
+// Mp4Trim uses the index to cut on a keyframe without re-encoding and without
+// having to parse the container for sync samples first.
+//
+// The byte position is the offset into the concatenated video elementary
+// stream, not a file offset: the MF sink writer owns the file layout. It is
+// what a reader needs to estimate cut sizes and bitrates.
+//
+// File layout (little endian, 16-byte header then 20-byte entries):
+//   u32 magic 'SRKI'   u32 version   u32 count   u32 reserved
+//   { i64 pts_100ns   u32 frame   u64 stream_bytes } * count
+
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace sr {
+
+struct KeyframeEntry {
+    int64_t  pts_100ns    = 0;
+    uint32_t frame        = 0;   // video sample number in the file
+    uint64_t stream_bytes = 0;   // video payload written before this keyframe
+
+    bool operator==(const KeyframeEntry&) const = default;
+};
+
+class KeyframeIndex {
+public:
+    static constexpr uint32_t kMagic      = 0x494B5253;  // "SRKI"
+    static constexpr uint32_t kVersion    = 1;
+    static constexpr size_t   kHeaderSize = 16;
+    static constexpr size_t   kEntrySize  = 20;
+
+    static std::wstring sidecar_path(const std::wstring& media_path) { return media_path + L".keyidx"; }
+
+    void clear() {
+        entries_.clear();
+        frames_       = 0;
+        stream_bytes_ = 0;
+    }
+
+    // Mux thread: one written video sample, in decode order
+    void on_video_sample(int64_t pts_100ns, uint32_t bytes, bool keyframe) {
+        if (keyframe) entries_.push_back({ pts_100ns, frames_, stream_bytes_ });
+        ++frames_;
+        stream_bytes_ += bytes;
+    }
+
+    const std::vector<KeyframeEntry>& entries() const { return entries_; }
+    bool     empty()        const { return entries_.empty(); }
+    uint32_t frames()       const { return frames_; }
+    uint64_t stream_bytes() const { return stream_bytes_; }
+
+    // Lossless cut start: the last keyframe at or before `pts_100ns` (the
+    // first keyframe when `pts_100ns` precedes all of them); null when empty
+    const KeyframeEntry* keyframe_at_or_before(int64_t pts_100ns) const {
+        if (entries_.empty()) return nullptr;
+        const KeyframeEntry* best = &entries_.front();
+        for (const KeyframeEntry& e : entries_) {
+            if (e.pts_100ns > pts_100ns) break;
+            best = &e;
+        }
+        return best;
+    }
+
+    std::vector<uint8_t> serialize() const {
+        std::vector<uint8_t> out(kHeaderSize + entries_.size() * kEntrySize);
+        uint8_t* p = out.data();
+        put(p, kMagic);
+        put(p, kVersion);
+        put(p, static_cast<uint32_t>(entries_.size()));
+        put(p, uint32_t{ 0 });
+        for (const KeyframeEntry& e : entries_) {
+            put(p, e.pts_100ns);
+            put(p, e.frame);
+            put(p, e.stream_bytes);
+        }
+        return out;
+    }
+
+    // False on a bad magic / version or a truncated file; `out` is then empty
+    static bool parse(const uint8_t* data, size_t size, KeyframeIndex& out) {
+        out.clear();
+        if (!data || size < kHeaderSize) return false;
+        const uint8_t* p = data;
+        const uint32_t magic   = get<uint32_t>(p);
+        const uint32_t version = get<uint32_t>(p);
+        const uint32_t count   = get<uint32_t>(p);
+        get<uint32_t>(p);
+        if (magic != kMagic || version != kVersion ||
+            size < kHeaderSize + static_cast<size_t>(count) * kEntrySize) {
+            return false;
+        }
+        out.entries_.reserve(count);
+        for (uint32_t i = 0; i < count; ++i) {
+            KeyframeEntry e;
+            e.pts_100ns    = get<int64_t>(p);
+            e.frame        = get<uint32_t>(p);
+            e.stream_bytes = get<uint64_t>(p);
+            out.entries_.push_back(e);
+        }
+        return true;
+    }
+
+    bool save(const std::wstring& path) const {
+        const std::vector<uint8_t> bytes = serialize();
+        std::ofstream file(std::filesystem::path(path), std::ios::binary | std::ios::trunc);
+        if (!file) return false;
+        file.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+        return static_cast<bool>(file);
+    }
+
+    static bool load(const std::wstring& path, KeyframeIndex& out) {
+        out.clear();
+        std::ifstream file(std::filesystem::path(path), std::ios::binary);
+        if (!file) return false;
+        const std::vector<uint8_t> bytes((std::istreambuf_iterator<char>(file)),
+                                         std::istreambuf_iterator<char>());
+        return parse(bytes.data(), bytes.size(), out);
+    }
+
+private:
+    // The format is little endian, like every platform this builds for
+    template <typename T> static void put(uint8_t*& p, T v) {
+        std::memcpy(p, &v, sizeof(T));
+        p += sizeof(T);
+    }
+    template <typename T> static T get(const uint8_t*& p) {
+        T v{};
+        std::memcpy(&v, p, sizeof(T));
+        p += sizeof(T);
+        return v;
+    }
+
+    std::vector<KeyframeEntry> entries_;
+    uint32_t frames_       = 0;
+    uint64_t stream_bytes_ = 0;
+};
+
+} // namespace sr
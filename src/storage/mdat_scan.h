@@ -0,0 +1,399 @@
+#pragma once
+// mdat_scan.h — Rebuild the sample tables of a crashed, moov-less MP4
+//
+// A crash leaves MuxWriter's .partial.mp4 as ftyp + an mdat the sink writer
+// never closed: the samples are there, the moov with their sizes and
+// offsets is not. H.264 samples in the mdat are AVCC (4-byte big-endian NAL
+// lengths), so the video can be recovered by walking the length chain and
+// grouping NAL units into access units. Anything that does not parse as a
+// NAL (the AAC chunks the sink interleaves, a torn tail, preallocated zeros)
+// is skipped until a point where several NAL units chain plausibly again.
+//
+// The AAC frames are raw (no ADTS sync word), so their boundaries cannot be
+// found without decoding; the rebuilt file is video only.
+//
+// Pure byte-level code so it can be unit-tested on synthetic buffers.
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace sr {
+
+constexpr uint32_t mp4_fourcc(const char (&s)[5]) {
+    return (static_cast<uint32_t>(static_cast<uint8_t>(s[0])) << 24) |
+           (static_cast<uint32_t>(static_cast<uint8_t>(s[1])) << 16) |
+           (static_cast<uint32_t>(static_cast<uint8_t>(s[2])) << 8)  |
+            static_cast<uint32_t>(static_cast<uint8_t>(s[3]));
+}
+
+inline uint32_t read_be32(const uint8_t* p) {
+    return (uint32_t{ p[0] } << 24) | (uint32_t{ p[1] } << 16) | (uint32_t{ p[2] } << 8) | p[3];
+}
+inline uint64_t read_be64(const uint8_t* p) {
+    return (uint64_t{ read_be32(p) } << 32) | read_be32(p + 4);
+}
+
+struct Mp4Box {
+    uint32_t type      = 0;
+    uint64_t offset    = 0;   // box start in the file
+    uint32_t header    = 8;   // 8, or 16 with a 64-bit largesize
+    uint64_t size      = 0;   // clamped to the file
+    bool     truncated = false;  // declared size ran past the end / was "to EOF"
+};
+
+// Top-level boxes; stops at the first header that cannot be a box
+inline std::vector<Mp4Box> list_top_level_boxes(const uint8_t* data, uint64_t file_size) {
+    std::vector<Mp4Box> boxes;
+    uint64_t pos = 0;
+    while (file_size - pos >= 8) {
+        Mp4Box box;
+        box.offset = pos;
+        box.type   = read_be32(data + pos + 4);
+        uint64_t size = read_be32(data + pos);
+        if (size == 1) {
+            if (file_size - pos < 16) break;
+            size = read_be64(data + pos + 8);
+            box.header = 16;
+        }
+        if (size == 0 || size > file_size - pos) {
+            box.truncated = true;
+            size = file_size - pos;
+        }
+        if (size < box.header) break;
+        box.size = size;
+        boxes.push_back(box);
+        pos += size;
+    }
+    return boxes;
+}
+
+struct RecoveredSample {
+    uint64_t offset   = 0;   // file offset of the first length prefix
+    uint32_t size     = 0;   // bytes including every length prefix
+    bool     keyframe = false;
+};
+
+struct MdatScan {
+    std::vector<RecoveredSample> video;
+    std::vector<uint8_t> sps, pps;    // first in-band parameter sets (no length prefix)
+    uint64_t data_end      = 0;       // end of the last complete video sample
+    uint64_t skipped_bytes = 0;       // audio chunks and unparseable data
+};
+
+namespace mdat_detail {
+
+constexpr uint32_t kMaxNalBytes   = 16u << 20;   // far above any 4K IDR
+constexpr uint64_t kMaxGapBytes   = 32u << 20;   // no video resumes after this: end of data
+constexpr int      kChainDepth    = 3;
+
+struct Nal {
+    uint32_t length = 0;   // payload bytes after the 4-byte prefix
+    uint8_t  type   = 0;
+    bool     first_slice = false;   // slice with first_mb_in_slice == 0
+};
+
+inline bool parse_nal(const uint8_t* data, uint64_t pos, uint64_t end, Nal& nal) {
+    if (end - pos < 5) return false;
+    nal.length = read_be32(data + pos);
+    if (nal.length == 0 || nal.length > kMaxNalBytes || nal.length > end - pos - 4) return false;
+    const uint8_t header = data[pos + 4];
+    if (header & 0x80) return false;   // forbidden_zero_bit
+    const bool ref = (header & 0x60) != 0;
+    nal.type = header & 0x1F;
+    switch (nal.type) {
+        case 1:  break;                            // non-IDR slice
+        case 5: case 7: case 8: if (!ref) return false; break;   // IDR / SPS / PPS are reference
+        case 6: case 9: case 12: if (ref) return false; break;   // SEI / AUD / filler never are
+        default: return false;
+    }
+    // ue(v) first_mb_in_slice == 0 is a single '1' bit
+    nal.first_slice = (nal.type == 1 || nal.type == 5) && nal.length >= 2 && (data[pos + 5] & 0x80);
+    return true;
+}
+
+// `pos` starts a NAL that the next kChainDepth-1 NAL units (or the end of
+// the range) follow without a gap
+inline bool chains(const uint8_t* data, uint64_t pos, uint64_t end) {
+    for (int i = 0; i < kChainDepth; ++i) {
+        if (pos == end) return i > 0;
+        Nal nal;
+        if (!parse_nal(data, pos, end, nal)) return false;
+        pos += 4 + uint64_t{ nal.length };
+    }
+    return true;
+}
+
+// A NAL that may open an access unit: AUD, SPS, SEI or a first slice
+inline bool can_open_au(const Nal& nal) {
+    return nal.type == 9 || nal.type == 7 || nal.type == 6 || nal.first_slice;
+}
+
+} // namespace mdat_detail
+
+// Walk the mdat payload [begin, end) of `data` (the mapped file)
+inline MdatScan scan_avcc_mdat(const uint8_t* data, uint64_t begin, uint64_t end) {
+    using namespace mdat_detail;
+    MdatScan scan;
+    scan.data_end = begin;
+
+    RecoveredSample au;
+    bool au_open = false, au_has_slice = false;
+    auto close_au = [&](uint64_t au_end) {
+        if (au_open && au_has_slice) {
+            au.size = static_cast<uint32_t>(au_end - au.offset);
+            scan.video.push_back(au);
+            scan.data_end = au_end;
+        }
+        au_open = au_has_slice = false;
+    };
+
+    uint64_t pos = begin;
+    bool in_run = false;   // `pos` is where the previous NAL ended
+    while (pos < end) {
+        // Only a fresh start has to chain: inside a run the NAL just has to
+        // parse, since an audio chunk may follow the last NAL of a chunk
+        Nal nal;
+        if (!parse_nal(data, pos, end, nal) || (!in_run && !chains(data, pos, end))) {
+            // Not video (or torn): resynchronise on the next chained AU start
+            close_au(pos);
+            const uint64_t from = pos;
+            uint64_t next = pos + 1;
+            for (; next < end && next - from <= kMaxGapBytes; ++next) {
+                Nal probe;
+                if (parse_nal(data, next, end, probe) && can_open_au(probe) && chains(data, next, end)) break;
+            }
+            if (next >= end || next - from > kMaxGapBytes) break;
+            scan.skipped_bytes += next - from;
+            pos = next;
+            in_run = false;
+            continue;
+        }
+        in_run = true;
+
+        if (au_open && au_has_slice && can_open_au(nal)) close_au(pos);
+        if (!au_open) {
+            au = RecoveredSample{ pos, 0, false };
+            au_open = true;
+        }
+        if (nal.type == 1 || nal.type == 5) au_has_slice = true;
+        if (nal.type == 5) au.keyframe = true;
+        if (nal.type == 7 && scan.sps.empty()) scan.sps.assign(data + pos + 4, data + pos + 4 + nal.length);
+        if (nal.type == 8 && scan.pps.empty()) scan.pps.assign(data + pos + 4, data + pos + 4 + nal.length);
+        pos += 4 + uint64_t{ nal.length };
+    }
+    // The last AU may be cut short by the crash; only a complete chain ends it
+    if (pos == end) close_au(pos);
+    return scan;
+}
+
+// First SPS and PPS of an Annex-B blob (MF_MT_MPEG_SEQUENCE_HEADER)
+inline bool split_annexb_parameter_sets(const std::vector<uint8_t>& blob,
+                                        std::vector<uint8_t>& sps, std::vector<uint8_t>& pps) {
+    sps.clear();
+    pps.clear();
+    size_t i = 0;
+    auto start_code = [&](size_t at, size_t& len) {
+        if (at + 3 <= blob.size() && blob[at] == 0 && blob[at + 1] == 0 && blob[at + 2] == 1) { len = 3; return true; }
+        if (at + 4 <= blob.size() && blob[at] == 0 && blob[at + 1] == 0 && blob[at + 2] == 0 && blob[at + 3] == 1) { len = 4; return true; }
+        return false;
+    };
+    while (i < blob.size()) {
+        size_t sc = 0;
+        if (!start_code(i, sc)) { ++i; continue; }
+        const size_t nal_begin = i + sc;
+        size_t nal_end = nal_begin;
+        size_t dummy = 0;
+        while (nal_end < blob.size() && !start_code(nal_end, dummy)) ++nal_end;
+        if (nal_end > nal_begin) {
+            const uint8_t type = blob[nal_begin] & 0x1F;
+            if (type == 7 && sps.empty()) sps.assign(blob.begin() + nal_begin, blob.begin() + nal_end);
+            if (type == 8 && pps.empty()) pps.assign(blob.begin() + nal_begin, blob.begin() + nal_end);
+        }
+        i = nal_end;
+    }
+    return !sps.empty() && !pps.empty();
+}
+
+struct RebuildParams {
+    uint32_t width   = 1920;
+    uint32_t height  = 1080;
+    uint32_t fps_num = 30;   // constant-rate timing: mdat carries no timestamps
+    uint32_t fps_den = 1;
+    std::vector<uint8_t> sps, pps;   // used when the scan found none in-band
+};
+
+namespace mdat_detail {
+
+class BoxWriter {
+public:
+    explicit BoxWriter(std::vector<uint8_t>& out) : out_(out) {}
+    size_t begin(uint32_t type) {
+        const size_t at = out_.size();
+        u32(0);
+        u32(type);
+        return at;
+    }
+    size_t begin_full(uint32_t type, uint8_t version, uint32_t flags) {
+        const size_t at = begin(type);
+        u32((uint32_t{ version } << 24) | (flags & 0xFFFFFF));
+        return at;
+    }
+    void end(size_t at) {
+        const uint32_t size = static_cast<uint32_t>(out_.size() - at);
+        for (int i = 0; i < 4; ++i) out_[at + i] = static_cast<uint8_t>(size >> (24 - 8 * i));
+    }
+    void u8(uint8_t v)   { out_.push_back(v); }
+    void u16(uint16_t v) { u8(static_cast<uint8_t>(v >> 8)); u8(static_cast<uint8_t>(v)); }
+    void u32(uint32_t v) { u16(static_cast<uint16_t>(v >> 16)); u16(static_cast<uint16_t>(v)); }
+    void u64(uint64_t v) { u32(static_cast<uint32_t>(v >> 32)); u32(static_cast<uint32_t>(v)); }
+    void zeros(size_t n) { out_.insert(out_.end(), n, 0); }
+    void bytes(const std::vector<uint8_t>& v) { out_.insert(out_.end(), v.begin(), v.end()); }
+    void matrix() {
+        const uint32_t m[9] = { 0x00010000, 0, 0, 0, 0x00010000, 0, 0, 0, 0x40000000 };
+        for (uint32_t v : m) u32(v);
+    }
+
+private:
+    std::vector<uint8_t>& out_;
+};
+
+} // namespace mdat_detail
+
+// moov for one AVC video track over `scan.video` (co64 offsets, one sample
+// per chunk, constant frame duration). Empty when there is nothing to index
+// or no SPS/PPS.
+inline std::vector<uint8_t> build_avc_moov(const MdatScan& scan, const RebuildParams& params) {
+    using mdat_detail::BoxWriter;
+    std::vector<uint8_t> out;
+    const std::vector<uint8_t>& sps = scan.sps.empty() ? params.sps : scan.sps;
+    const std::vector<uint8_t>& pps = scan.pps.empty() ? params.pps : scan.pps;
+    if (scan.video.empty() || sps.size() < 4 || pps.empty() || params.fps_num == 0 || params.fps_den == 0) {
+        return out;
+    }
+
+    const uint32_t timescale = params.fps_num * 1000u;
+    const uint32_t delta     = params.fps_den * 1000u;
+    const uint32_t count     = static_cast<uint32_t>(scan.video.size());
+    const uint64_t duration  = uint64_t{ delta } * count;
+
+    BoxWriter w(out);
+    const size_t moov = w.begin(mp4_fourcc("moov"));
+
+    const size_t mvhd = w.begin_full(mp4_fourcc("mvhd"), 1, 0);
+    w.u64(0); w.u64(0);                 // creation / modification
+    w.u32(timescale);
+    w.u64(duration);
+    w.u32(0x00010000);                  // rate 1.0
+    w.u16(0x0100);                      // volume 1.0
+    w.zeros(10);
+    w.matrix();
+    w.zeros(24);                        // pre_defined
+    w.u32(2);                           // next_track_ID
+    w.end(mvhd);
+
+    const size_t trak = w.begin(mp4_fourcc("trak"));
+    const size_t tkhd = w.begin_full(mp4_fourcc("tkhd"), 1, 0x3);   // enabled | in movie
+    w.u64(0); w.u64(0);
+    w.u32(1);                           // track_ID
+    w.u32(0);
+    w.u64(duration);
+    w.zeros(8);
+    w.u16(0); w.u16(0); w.u16(0); w.u16(0);   // layer, alternate_group, volume, reserved
+    w.matrix();
+    w.u32(params.width << 16);
+    w.u32(params.height << 16);
+    w.end(tkhd);
+
+    const size_t mdia = w.begin(mp4_fourcc("mdia"));
+    const size_t mdhd = w.begin_full(mp4_fourcc("mdhd"), 1, 0);
+    w.u64(0); w.u64(0);
+    w.u32(timescale);
+    w.u64(duration);
+    w.u16(0x55C4);                      // language "und"
+    w.u16(0);
+    w.end(mdhd);
+
+    const size_t hdlr = w.begin_full(mp4_fourcc("hdlr"), 0, 0);
+    w.u32(0);
+    w.u32(mp4_fourcc("vide"));
+    w.zeros(12);
+    w.bytes({ 'V', 'i', 'd', 'e', 'o', 'H', 'a', 'n', 'd', 'l', 'e', 'r', 0 });
+    w.end(hdlr);
+
+    const size_t minf = w.begin(mp4_fourcc("minf"));
+    const size_t vmhd = w.begin_full(mp4_fourcc("vmhd"), 0, 1);
+    w.zeros(8);                         // graphicsmode, opcolor
+    w.end(vmhd);
+    const size_t dinf = w.begin(mp4_fourcc("dinf"));
+    const size_t dref = w.begin_full(mp4_fourcc("dref"), 0, 0);
+    w.u32(1);
+    w.end(w.begin_full(mp4_fourcc("url "), 0, 1));   // data in this file
+    w.end(dref);
+    w.end(dinf);
+
+    const size_t stbl = w.begin(mp4_fourcc("stbl"));
+    const size_t stsd = w.begin_full(mp4_fourcc("stsd"), 0, 0);
+    w.u32(1);
+    const size_t avc1 = w.begin(mp4_fourcc("avc1"));
+    w.zeros(6);
+    w.u16(1);                           // data_reference_index
+    w.zeros(16);
+    w.u16(static_cast<uint16_t>(params.width));
+    w.u16(static_cast<uint16_t>(params.height));
+    w.u32(0x00480000); w.u32(0x00480000);   // 72 dpi
+    w.u32(0);
+    w.u16(1);                           // frame_count
+    w.zeros(32);                        // compressorname
+    w.u16(0x0018);                      // depth
+    w.u16(0xFFFF);
+    const size_t avcc = w.begin(mp4_fourcc("avcC"));
+    w.u8(1);
+    w.u8(sps[1]); w.u8(sps[2]); w.u8(sps[3]);   // profile, compatibility, level
+    w.u8(0xFF);                         // 4-byte NAL lengths
+    w.u8(0xE1);                         // one SPS
+    w.u16(static_cast<uint16_t>(sps.size()));
+    w.bytes(sps);
+    w.u8(1);                            // one PPS
+    w.u16(static_cast<uint16_t>(pps.size()));
+    w.bytes(pps);
+    w.end(avcc);
+    w.end(avc1);
+    w.end(stsd);
+
+    const size_t stts = w.begin_full(mp4_fourcc("stts"), 0, 0);
+    w.u32(1); w.u32(count); w.u32(delta);
+    w.end(stts);
+
+    const size_t stss = w.begin_full(mp4_fourcc("stss"), 0, 0);
+    uint32_t keyframes = 0;
+    for (const RecoveredSample& s : scan.video) keyframes += s.keyframe ? 1 : 0;
+    w.u32(keyframes);
+    for (uint32_t i = 0; i < count; ++i) {
+        if (scan.video[i].keyframe) w.u32(i + 1);
+    }
+    w.end(stss);
+
+    const size_t stsz = w.begin_full(mp4_fourcc("stsz"), 0, 0);
+    w.u32(0); w.u32(count);
+    for (const RecoveredSample& s : scan.video) w.u32(s.size);
+    w.end(stsz);
+
+    const size_t stsc = w.begin_full(mp4_fourcc("stsc"), 0, 0);
+    w.u32(1); w.u32(1); w.u32(1); w.u32(1);   // every chunk: one sample, description 1
+    w.end(stsc);
+
+    const size_t co64 = w.begin_full(mp4_fourcc("co64"), 0, 0);
+    w.u32(count);
+    for (const RecoveredSample& s : scan.video) w.u64(s.offset);
+    w.end(co64);
+
+    w.end(stbl);
+    w.end(minf);
+    w.end(mdia);
+    w.end(trak);
+    w.end(moov);
+    return out;
+}
+
+} // namespace sr
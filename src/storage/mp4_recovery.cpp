@@ -0,0 +1,241 @@
+// mp4_recovery.cpp — moov rebuild for crashed recordings (see mp4_recovery.h)
+
+#include "storage/mp4_recovery.h"
+#include "storage/storage_manager.h"
+#include "utils/logging.h"
+#include "utils/qpc_clock.h"
+
+#include <cstring>
+#include <cwchar>
+#include <memory>
+
+namespace sr {
+
+namespace {
+
+void write_u32(const wchar_t* ini, const wchar_t* key, uint32_t v) {
+    wchar_t buf[16];
+    _snwprintf_s(buf, _countof(buf), _TRUNCATE, L"%u", v);
+    WritePrivateProfileStringW(L"Recovery", key, buf, ini);
+}
+
+std::wstring to_hex(const std::vector<uint8_t>& bytes) {
+    static const wchar_t kDigits[] = L"0123456789ABCDEF";
+    std::wstring out;
+    out.reserve(bytes.size() * 2);
+    for (uint8_t b : bytes) {
+        out.push_back(kDigits[b >> 4]);
+        out.push_back(kDigits[b & 0xF]);
+    }
+    return out;
+}
+
+std::vector<uint8_t> from_hex(const wchar_t* text) {
+    std::vector<uint8_t> out;
+    auto nibble = [](wchar_t c) -> int {
+        if (c >= L'0' && c <= L'9') return c - L'0';
+        if (c >= L'A' && c <= L'F') return c - L'A' + 10;
+        if (c >= L'a' && c <= L'f') return c - L'a' + 10;
+        return -1;
+    };
+    for (size_t i = 0; text[i] && text[i + 1]; i += 2) {
+        const int hi = nibble(text[i]), lo = nibble(text[i + 1]);
+        if (hi < 0 || lo < 0) break;
+        out.push_back(static_cast<uint8_t>((hi << 4) | lo));
+    }
+    return out;
+}
+
+// Read-only view of a whole file
+class MappedFile {
+public:
+    ~MappedFile() {
+        if (view_) UnmapViewOfFile(view_);
+        if (mapping_) CloseHandle(mapping_);
+    }
+    bool map(HANDLE file, uint64_t size) {
+        if (size == 0 || size > SIZE_MAX) return false;
+        mapping_ = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (!mapping_) return false;
+        view_ = MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0);
+        return view_ != nullptr;
+    }
+    const uint8_t* data() const { return static_cast<const uint8_t*>(view_); }
+
+private:
+    HANDLE mapping_ = nullptr;
+    void*  view_    = nullptr;
+};
+
+bool fail(Mp4RecoveryResult& result, const wchar_t* message, DWORD error = 0) {
+    result.succeeded  = false;
+    result.message    = message;
+    result.error_code = error;
+    SR_LOG_ERROR(L"Recovery: %s (%u)", message, error);
+    return false;
+}
+
+} // namespace
+
+bool RecoveryInfo::save(const std::wstring& partial_path, const std::vector<uint8_t>& sequence_header) const {
+    const std::wstring path = sidecar_path(partial_path);
+    const wchar_t* ini = path.c_str();
+    write_u32(ini, L"codec",      static_cast<uint32_t>(codec));
+    write_u32(ini, L"fragmented", fragmented ? 1 : 0);
+    write_u32(ini, L"width",      params.width);
+    write_u32(ini, L"height",     params.height);
+    write_u32(ini, L"fps_num",    params.fps_num);
+    write_u32(ini, L"fps_den",    params.fps_den);
+    return WritePrivateProfileStringW(L"Recovery", L"sequence_header",
+                                      to_hex(sequence_header).c_str(), ini) != FALSE;
+}
+
+bool RecoveryInfo::load(const std::wstring& partial_path, RecoveryInfo& out) {
+    const std::wstring path = sidecar_path(partial_path);
+    if (GetFileAttributesW(path.c_str()) == INVALID_FILE_ATTRIBUTES) return false;
+    const wchar_t* ini = path.c_str();
+    auto get = [ini](const wchar_t* key, uint32_t def) {
+        return static_cast<uint32_t>(GetPrivateProfileIntW(L"Recovery", key, static_cast<int>(def), ini));
+    };
+    out.codec          = static_cast<VideoCodec>(get(L"codec", static_cast<uint32_t>(out.codec)));
+    out.fragmented     = get(L"fragmented", 0) != 0;
+    out.params.width   = get(L"width", out.params.width);
+    out.params.height  = get(L"height", out.params.height);
+    out.params.fps_num = get(L"fps_num", out.params.fps_num);
+    out.params.fps_den = get(L"fps_den", out.params.fps_den);
+
+    std::wstring hex(8192, L'\0');
+    const DWORD n = GetPrivateProfileStringW(L"Recovery", L"sequence_header", L"", hex.data(),
+                                             static_cast<DWORD>(hex.size()), ini);
+    hex.resize(n);
+    split_annexb_parameter_sets(from_hex(hex.c_str()), out.params.sps, out.params.pps);
+    return true;
+}
+
+void RecoveryInfo::remove(const std::wstring& partial_path) {
+    DeleteFileW(sidecar_path(partial_path).c_str());
+}
+
+bool rebuild_partial_mp4(const std::wstring& partial_path, const RecoveryInfo& fallback,
+                         Mp4RecoveryResult& result) {
+    result = {};
+    RecoveryInfo info = fallback;
+    RecoveryInfo::load(partial_path, info);
+    if (info.fragmented) {
+        // fMP4 is playable up to the last complete fragment
+        result.succeeded = true;
+        return true;
+    }
+
+    HANDLE file = CreateFileW(partial_path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ,
+                              nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE) return fail(result, L"cannot open the partial file", GetLastError());
+    std::unique_ptr<void, decltype(&CloseHandle)> file_guard(file, &CloseHandle);
+
+    LARGE_INTEGER size{};
+    if (!GetFileSizeEx(file, &size)) return fail(result, L"cannot read the file size", GetLastError());
+    const uint64_t file_size = static_cast<uint64_t>(size.QuadPart);
+
+    Mp4Box mdat;
+    MdatScan scan;
+    {
+        MappedFile mapped;
+        if (!mapped.map(file, file_size)) return fail(result, L"cannot map the partial file", GetLastError());
+
+        bool have_mdat = false;
+        for (const Mp4Box& box : list_top_level_boxes(mapped.data(), file_size)) {
+            if (box.type == mp4_fourcc("moov") || box.type == mp4_fourcc("moof")) {
+                result.succeeded = true;   // finalized or fragmented: nothing to rebuild
+                return true;
+            }
+            if (box.type == mp4_fourcc("mdat") && !have_mdat) {
+                mdat = box;
+                have_mdat = true;
+            }
+        }
+        if (!have_mdat) return fail(result, L"no media data in the file");
+        if (info.codec != VideoCodec::H264) return fail(result, L"only H.264 recordings can be rebuilt");
+
+        const int64_t start_us = QPCClock::instance().now_us();
+        scan = scan_avcc_mdat(mapped.data(), mdat.offset + mdat.header, mdat.offset + mdat.size);
+        SR_LOG_INFO(L"Recovery: scanned %llu MB in %lld ms: %zu video samples, %llu bytes skipped",
+                    mdat.size >> 20, static_cast<long long>((QPCClock::instance().now_us() - start_us) / 1000),
+                    scan.video.size(), scan.skipped_bytes);
+    }
+
+    const std::vector<uint8_t> moov = build_avc_moov(scan, info.params);
+    if (moov.empty()) return fail(result, L"no decodable video found");
+
+    // mdat ends at the last complete sample; the header must say so
+    const uint64_t mdat_size = scan.data_end - mdat.offset;
+    uint8_t header[16]{};
+    DWORD header_len = 0;
+    if (mdat.header == 16) {
+        const uint32_t one = 1;
+        for (int i = 0; i < 4; ++i) header[i] = static_cast<uint8_t>(one >> (24 - 8 * i));
+        for (int i = 0; i < 8; ++i) header[8 + i] = static_cast<uint8_t>(mdat_size >> (56 - 8 * i));
+        std::memcpy(header + 4, "mdat", 4);
+        header_len = 16;
+    } else if (mdat_size <= UINT32_MAX) {
+        for (int i = 0; i < 4; ++i) header[i] = static_cast<uint8_t>(mdat_size >> (24 - 8 * i));
+        std::memcpy(header + 4, "mdat", 4);
+        header_len = 8;
+    } else {
+        return fail(result, L"mdat over 4 GB with a 32-bit header");
+    }
+
+    LARGE_INTEGER pos{};
+    DWORD written = 0;
+    pos.QuadPart = static_cast<LONGLONG>(mdat.offset);
+    if (!SetFilePointerEx(file, pos, nullptr, FILE_BEGIN) ||
+        !WriteFile(file, header, header_len, &written, nullptr) || written != header_len) {
+        return fail(result, L"cannot patch the mdat header", GetLastError());
+    }
+    pos.QuadPart = static_cast<LONGLONG>(scan.data_end);
+    if (!SetFilePointerEx(file, pos, nullptr, FILE_BEGIN) || !SetEndOfFile(file) ||
+        !WriteFile(file, moov.data(), static_cast<DWORD>(moov.size()), &written, nullptr) ||
+        written != moov.size()) {
+        return fail(result, L"cannot write the rebuilt moov", GetLastError());
+    }
+    FlushFileBuffers(file);
+
+    result.succeeded     = true;
+    result.rebuilt       = true;
+    result.video_samples = static_cast<uint32_t>(scan.video.size());
+    result.skipped_bytes = scan.skipped_bytes;
+    SR_LOG_INFO(L"Recovery: rebuilt moov for '%s' (%u samples, %llu MB dropped at the tail)",
+                partial_path.c_str(), result.video_samples,
+                (file_size - scan.data_end) >> 20);
+    return true;
+}
+
+bool recover_partial_async(const std::wstring& partial_path, const RecoveryInfo& fallback,
+                           RecoveryCallback done) {
+    struct Job {
+        std::wstring     path;
+        RecoveryInfo     fallback;
+        RecoveryCallback done;
+    };
+    auto job = std::make_unique<Job>(Job{ partial_path, fallback, std::move(done) });
+    auto run = [](PTP_CALLBACK_INSTANCE, void* context) {
+        std::unique_ptr<Job> job(static_cast<Job*>(context));
+        Mp4RecoveryResult result;
+        if (rebuild_partial_mp4(job->path, job->fallback, result)) {
+            result.final_path = StorageManager::partialToFinal(job->path);
+            if (MoveFileExW(job->path.c_str(), result.final_path.c_str(), MOVEFILE_REPLACE_EXISTING)) {
+                RecoveryInfo::remove(job->path);
+            } else {
+                fail(result, L"cannot rename the recovered file", GetLastError());
+            }
+        }
+        if (job->done) job->done(result);
+    };
+    if (!TrySubmitThreadpoolCallback(run, job.get(), nullptr)) {
+        SR_LOG_ERROR(L"Recovery: thread pool submit failed: %u", GetLastError());
+        return false;
+    }
+    job.release();   // owned by the callback now
+    return true;
+}
+
+} // namespace sr
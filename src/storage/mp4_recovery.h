@@ -0,0 +1,57 @@
+#pragma once
+// mp4_recovery.h — Make a crashed .partial.mp4 playable again
+//
+// MuxWriter leaves <partial>.recovery (an INI with the stream parameters) next
+// to every file it writes and deletes it on a clean finalize. After a crash,
+// rebuild_partial_mp4() maps the partial file, keeps it as-is when it already
+// has a moov (or is fragmented), and otherwise scans the mdat (mdat_scan.h),
+// trims the torn tail, fixes the mdat size and appends a rebuilt moov. Only
+// the moov is written, so a multi-GB file takes one sequential read.
+//
+// recover_partial_async() runs that on the Windows thread pool and renames
+// the result to the final .mp4.
+
+#include <windows.h>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include "storage/mdat_scan.h"
+#include "utils/video_codec.h"
+
+namespace sr {
+
+struct Mp4RecoveryResult {
+    bool         succeeded        = false;
+    bool         rebuilt          = false;   // a moov was written (false = already playable)
+    uint32_t     video_samples    = 0;
+    uint64_t     skipped_bytes    = 0;       // audio / torn data left out of the index
+    DWORD        error_code       = 0;
+    std::wstring final_path;
+    std::wstring message;                    // failure reason for the UI
+};
+
+// Stream parameters MuxWriter records for recovery (cleared on finalize)
+struct RecoveryInfo {
+    VideoCodec    codec      = VideoCodec::H264;
+    bool          fragmented = false;
+    RebuildParams params;
+
+    static std::wstring sidecar_path(const std::wstring& partial_path) { return partial_path + L".recovery"; }
+    bool save(const std::wstring& partial_path, const std::vector<uint8_t>& sequence_header) const;
+    // False when there is no sidecar; `out` then keeps its defaults
+    static bool load(const std::wstring& partial_path, RecoveryInfo& out);
+    static void remove(const std::wstring& partial_path);
+};
+
+// Rebuild the moov of `partial_path` in place when it has none. `fallback`
+// supplies size / rate / parameter sets when the sidecar is missing.
+bool rebuild_partial_mp4(const std::wstring& partial_path, const RecoveryInfo& fallback,
+                         Mp4RecoveryResult& result);
+
+// rebuild_partial_mp4() + rename to the final .mp4 on a thread-pool thread;
+// `done` runs there too (post to the UI from it)
+using RecoveryCallback = std::function<void(const Mp4RecoveryResult&)>;
+bool recover_partial_async(const std::wstring& partial_path, const RecoveryInfo& fallback,
+                           RecoveryCallback done);
+
+} // namespace sr
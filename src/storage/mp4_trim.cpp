@@ -0,0 +1,209 @@
+// mp4_trim.cpp — Lossless MP4 trim (source reader -> sink writer passthrough)
+
+#include "storage/mp4_trim.h"
+#include "utils/logging.h"
+
+#include <mfapi.h>
+#include <mfidl.h>
+#include <mfreadwrite.h>
+#include <propvarutil.h>
+#include <wrl/client.h>
+#include <vector>
+
+#pragma comment(lib, "mfplat.lib")
+#pragma comment(lib, "mfreadwrite.lib")
+#pragma comment(lib, "mfuuid.lib")
+#pragma comment(lib, "propsys.lib")
+
+namespace sr {
+
+using Microsoft::WRL::ComPtr;
+
+namespace {
+
+struct TrimStream {
+    DWORD sink_index = 0;
+    bool  video      = false;
+    bool  done       = false;
+};
+
+// Every source stream selected, in its native (compressed) type, mirrored
+// as a passthrough stream on the sink
+bool add_passthrough_streams(IMFSourceReader* reader, IMFSinkWriter* sink,
+                             std::vector<TrimStream>& streams) {
+    for (DWORD i = 0;; ++i) {
+        ComPtr<IMFMediaType> native;
+        HRESULT hr = reader->GetNativeMediaType(i, 0, &native);
+        if (hr == MF_E_INVALIDSTREAMNUMBER) break;
+        if (FAILED(hr)) {
+            SR_LOG_ERROR(L"Trim: GetNativeMediaType(%u) failed: 0x%08X", i, hr);
+            return false;
+        }
+        GUID major{};
+        native->GetGUID(MF_MT_MAJOR_TYPE, &major);
+        TrimStream s;
+        s.video = major == MFMediaType_Video;
+        if (!s.video && major != MFMediaType_Audio) {
+            reader->SetStreamSelection(i, FALSE);
+            s.done = true;
+            streams.push_back(s);
+            continue;
+        }
+        hr = reader->SetStreamSelection(i, TRUE);
+        if (SUCCEEDED(hr)) hr = reader->SetCurrentMediaType(i, nullptr, native.Get());
+        if (SUCCEEDED(hr)) hr = sink->AddStream(native.Get(), &s.sink_index);
+        if (SUCCEEDED(hr)) hr = sink->SetInputMediaType(s.sink_index, native.Get(), nullptr);
+        if (FAILED(hr)) {
+            SR_LOG_ERROR(L"Trim: passthrough setup for stream %u failed: 0x%08X", i, hr);
+            return false;
+        }
+        streams.push_back(s);
+    }
+    return !streams.empty();
+}
+
+// `min_start`: the first video sync sample at or after it starts the output
+bool copy_samples(IMFSourceReader* reader, IMFSinkWriter* sink, std::vector<TrimStream>& streams,
+                  const TrimRange& range, int64_t min_start, TrimResult& result) {
+    bool have_base = false;
+    int64_t base = 0;
+    for (;;) {
+        bool all_done = true;
+        for (const TrimStream& s : streams) all_done = all_done && s.done;
+        if (all_done) return true;
+
+        DWORD stream = 0, flags = 0;
+        LONGLONG ts = 0;
+        ComPtr<IMFSample> sample;
+        HRESULT hr = reader->ReadSample(static_cast<DWORD>(MF_SOURCE_READER_ANY_STREAM), 0,
+                                        &stream, &flags, &ts, &sample);
+        if (FAILED(hr)) {
+            SR_LOG_ERROR(L"Trim: ReadSample failed: 0x%08X", hr);
+            return false;
+        }
+        if (flags & MF_SOURCE_READERF_ERROR) {
+            SR_LOG_ERROR(L"Trim: stream %u reported an error", stream);
+            return false;
+        }
+        if (flags & MF_SOURCE_READERF_ENDOFSTREAM) {
+            if (stream < streams.size()) streams[stream].done = true;
+            continue;
+        }
+        if (!sample || stream >= streams.size() || streams[stream].done) continue;
+        TrimStream& s = streams[stream];
+
+        if (ts >= range.end_100ns) {
+            s.done = true;
+            continue;
+        }
+        if (s.video) {
+            // The first video sync sample at or after the cut fixes the time base
+            if (!have_base) {
+                if (!MFGetAttributeUINT32(sample.Get(), MFSampleExtension_CleanPoint, FALSE) ||
+                    ts < min_start) {
+                    continue;
+                }
+                have_base = true;
+                base = ts;
+                result.cut_start_100ns = ts;
+            }
+        } else if (!have_base || ts < base) {
+            continue;   // audio before the cut keyframe
+        }
+
+        sample->SetSampleTime(ts - base);
+        hr = sink->WriteSample(s.sink_index, sample.Get());
+        if (FAILED(hr)) {
+            SR_LOG_ERROR(L"Trim: WriteSample failed: 0x%08X", hr);
+            return false;
+        }
+        if (s.video) {
+            LONGLONG dur = 0;
+            sample->GetSampleDuration(&dur);
+            result.cut_end_100ns = ts + dur;
+            ++result.video_samples;
+        } else {
+            ++result.audio_samples;
+        }
+    }
+}
+
+} // namespace
+
+bool trim_recording(const std::wstring& source, const std::wstring& dest,
+                    const TrimRange& range, TrimResult& result) {
+    result = {};
+    if (range.end_100ns <= range.start_100ns) {
+        SR_LOG_ERROR(L"Trim: empty range");
+        return false;
+    }
+
+    KeyframeIndex index;
+    result.used_index = KeyframeIndex::load(KeyframeIndex::sidecar_path(source), index) && !index.empty();
+    result.cut_start_100ns = lossless_cut_start(index, range.start_100ns);
+    const int64_t seek_to = result.used_index ? result.cut_start_100ns : range.start_100ns;
+
+    HRESULT hr = MFStartup(MF_VERSION, MFSTARTUP_LITE);
+    if (FAILED(hr)) {
+        SR_LOG_ERROR(L"Trim: MFStartup failed: 0x%08X", hr);
+        return false;
+    }
+
+    bool ok = false;
+    {
+        ComPtr<IMFSourceReader> reader;
+        hr = MFCreateSourceReaderFromURL(source.c_str(), nullptr, &reader);
+        if (FAILED(hr)) {
+            SR_LOG_ERROR(L"Trim: cannot open '%s': 0x%08X", source.c_str(), hr);
+        }
+
+        ComPtr<IMFAttributes> sink_attrs;
+        ComPtr<IMFSinkWriter> sink;
+        if (SUCCEEDED(hr)) hr = MFCreateAttributes(&sink_attrs, 2);
+        if (SUCCEEDED(hr)) {
+            // Offline copy: no real-time pacing, and no silent format conversion
+            sink_attrs->SetUINT32(MF_SINK_WRITER_DISABLE_THROTTLING, TRUE);
+            sink_attrs->SetUINT32(MF_READWRITE_DISABLE_CONVERTERS, TRUE);
+            hr = MFCreateSinkWriterFromURL(dest.c_str(), nullptr, sink_attrs.Get(), &sink);
+            if (FAILED(hr)) SR_LOG_ERROR(L"Trim: cannot create '%s': 0x%08X", dest.c_str(), hr);
+        }
+
+        std::vector<TrimStream> streams;
+        if (SUCCEEDED(hr) && add_passthrough_streams(reader.Get(), sink.Get(), streams)) {
+            // MP4 sources seek to the sync sample before the position
+            PROPVARIANT pos;
+            InitPropVariantFromInt64(seek_to, &pos);
+            hr = reader->SetCurrentPosition(GUID_NULL, pos);
+            PropVariantClear(&pos);
+            // With the index the cut keyframe is known exactly; without it
+            // the first sync sample after the seek is the one before the
+            // requested time. A failed seek reads from the start instead.
+            int64_t min_start = result.used_index ? result.cut_start_100ns : INT64_MIN;
+            if (FAILED(hr)) {
+                SR_LOG_WARN(L"Trim: seek failed (0x%08X), reading from the start", hr);
+                if (!result.used_index) min_start = range.start_100ns;
+            }
+
+            hr = sink->BeginWriting();
+            if (SUCCEEDED(hr)) {
+                ok = copy_samples(reader.Get(), sink.Get(), streams, range, min_start, result) &&
+                     result.video_samples > 0;
+                const HRESULT fin = sink->Finalize();
+                ok = ok && SUCCEEDED(fin);
+            }
+        }
+    }
+    MFShutdown();
+
+    if (ok) {
+        SR_LOG_INFO(L"Trim: '%s' -> '%s', %.3f s .. %.3f s (%u video / %u audio samples, %s)",
+                    source.c_str(), dest.c_str(), result.cut_start_100ns / 1e7,
+                    result.cut_end_100ns / 1e7, result.video_samples, result.audio_samples,
+                    result.used_index ? L"keyframe index" : L"container seek");
+    } else {
+        SR_LOG_ERROR(L"Trim of '%s' failed", source.c_str());
+    }
+    return ok;
+}
+
+} // namespace sr
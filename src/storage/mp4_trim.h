@@ -0,0 +1,43 @@
+#pragma once
+// mp4_trim.h — Lossless trim of a finished recording
+//
+// Copies the compressed samples of every stream from a cut start keyframe up
+// to the end time into a new MP4 (source reader -> sink writer passthrough,
+// no decode or encode), so cutting the first minute of an hour-long file
+// takes seconds. The start snaps back to the keyframe at or before the
+// requested time, taken from the .keyidx sidecar when there is one and from
+// the first sync sample after the seek otherwise. All streams are retimed so
+// the output starts at zero; audio before the cut keyframe is dropped.
+
+#include <windows.h>
+#include <cstdint>
+#include <string>
+#include "storage/keyframe_index.h"
+
+namespace sr {
+
+struct TrimRange {
+    int64_t start_100ns = 0;
+    int64_t end_100ns   = INT64_MAX;   // exclusive; INT64_MAX = to the end
+};
+
+struct TrimResult {
+    int64_t  cut_start_100ns = 0;   // keyframe the output starts on (source time)
+    int64_t  cut_end_100ns   = 0;   // end of the last copied video sample (source time)
+    uint32_t video_samples   = 0;
+    uint32_t audio_samples   = 0;
+    bool     used_index      = false;
+};
+
+// Cut start for `requested` given the sidecar index (empty = unknown: the
+// requested time, the reader seeks to the keyframe before it)
+inline int64_t lossless_cut_start(const KeyframeIndex& index, int64_t requested) {
+    const KeyframeEntry* key = index.keyframe_at_or_before(requested);
+    return key ? key->pts_100ns : requested;
+}
+
+// Write `range` of `source` to `dest` without re-encoding. Replaces `dest`.
+bool trim_recording(const std::wstring& source, const std::wstring& dest,
+                    const TrimRange& range, TrimResult& result);
+
+} // namespace sr
@@ -0,0 +1,121 @@
+#pragma once
+// mux_finalizer.h — Background queue that closes finished recording files
+//
+// MuxWriter::finalize() (IMFSinkWriter::Finalize writing the moov, the
+// preallocation trim, MoveFileExW to the final name) takes seconds for a
+// long classic-MP4 recording. Stop and segment rotation hand the writer to
+// this queue instead: the state machine goes back to Idle at once and the
+// engines can start the next session while the old file is still closing.
+//
+// One worker (COM MTA, below-normal priority) finalizes writers in the
+// order they were queued, then runs each job's completion on that worker.
+// The worker starts with the first job and stays up until destruction,
+// which waits for everything queued. Any thread may enqueue.
+//
+// Templated on the writer (anything with `bool finalize()`) so the queue can
+// be tested without a sink writer; production uses MuxFinalizer.
+
+#include <windows.h>
+#include <objbase.h>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+namespace sr {
+
+class MuxWriter;
+
+template <typename Writer>
+class FinalizeQueue {
+public:
+    // ok = finalize() succeeded (false: the partial file was kept)
+    using Completion = std::function<void(bool ok)>;
+
+    FinalizeQueue() = default;
+    ~FinalizeQueue() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+        }
+        work_cv_.notify_all();
+        if (worker_.joinable()) worker_.join();
+    }
+    FinalizeQueue(const FinalizeQueue&) = delete;
+    FinalizeQueue& operator=(const FinalizeQueue&) = delete;
+
+    // Takes ownership; `done` (may be empty) runs on the worker afterwards
+    void enqueue(std::unique_ptr<Writer> writer, Completion done = nullptr) {
+        if (!writer) return;
+        std::lock_guard<std::mutex> lock(mutex_);
+        jobs_.push_back({ std::move(writer), std::move(done) });
+        if (!worker_.joinable()) worker_ = std::thread([this] { run(); });
+        work_cv_.notify_one();
+    }
+
+    // Block until every job queued so far has finalized and completed
+    void drain() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        idle_cv_.wait(lock, [this] { return jobs_.empty() && !busy_; });
+    }
+
+    // Jobs queued or finalizing
+    size_t pending() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return jobs_.size() + (busy_ ? 1 : 0);
+    }
+
+    uint32_t completed() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return completed_;
+    }
+
+private:
+    struct Job {
+        std::unique_ptr<Writer> writer;
+        Completion              done;
+    };
+
+    void run() {
+        SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_BELOW_NORMAL);
+        const HRESULT co = CoInitializeEx(nullptr, COINIT_MULTITHREADED);
+        std::unique_lock<std::mutex> lock(mutex_);
+        for (;;) {
+            work_cv_.wait(lock, [this] { return stopping_ || !jobs_.empty(); });
+            if (jobs_.empty()) break;   // stopping, and everything is done
+            Job job = std::move(jobs_.front());
+            jobs_.pop_front();
+            busy_ = true;
+            lock.unlock();
+
+            const bool ok = job.writer->finalize();
+            job.writer.reset();         // file handles closed before the callback
+            if (job.done) job.done(ok);
+
+            lock.lock();
+            busy_ = false;
+            ++completed_;
+            if (jobs_.empty()) idle_cv_.notify_all();
+        }
+        lock.unlock();
+        if (SUCCEEDED(co)) CoUninitialize();
+    }
+
+    mutable std::mutex      mutex_;
+    std::condition_variable work_cv_;
+    std::condition_variable idle_cv_;
+    std::deque<Job>         jobs_;
+    bool                    busy_      = false;
+    bool                    stopping_  = false;
+    uint32_t                completed_ = 0;
+    std::thread             worker_;
+};
+
+using MuxFinalizer = FinalizeQueue<MuxWriter>;
+
+} // namespace sr
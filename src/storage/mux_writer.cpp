@@ -1,13 +1,18 @@
 // mux_writer.cpp — MP4 muxer using IMFSinkWriter
 // T015: Writes to .partial.mp4, renames to .mp4 on successful finalize
+// Fragmented mode uses the FMPEG4 container: the sink emits a moof/mdat pair at
+// each video sync sample, so the file is playable up to the last fragment even
+// if the process dies, and finalize has no large moov to write.
 
 #include "storage/mux_writer.h"
+#include "storage/unbuffered_byte_stream.h"
+#include "storage/mp4_recovery.h"
 #include "utils/logging.h"
 
 #include <mfapi.h>
 #include <mfidl.h>
 #include <mfreadwrite.h>
-#include <codecapi.h>   // eAVEncH264VProfile_Main
+#include <mftransform.h>
 
 #pragma comment(lib, "mfplat.lib")
 #pragma comment(lib, "mfreadwrite.lib")
@@ -15,6 +20,63 @@
 
 namespace sr {
 
+namespace {
+
+// Shallow copy of `src` (same media buffers and attributes) with its time
+// shifted by -base. Samples may still be referenced elsewhere (replay ring),
+// so the original is never retimed in place.
+HRESULT rebase_sample(IMFSample* src, int64_t base, ComPtr<IMFSample>& out) {
+    LONGLONG t = 0, dur = 0;
+    HRESULT hr = src->GetSampleTime(&t);
+    if (FAILED(hr)) return hr;
+    hr = MFCreateSample(&out);
+    if (FAILED(hr)) return hr;
+    src->CopyAllItems(out.Get());
+    DWORD count = 0;
+    src->GetBufferCount(&count);
+    for (DWORD i = 0; i < count; ++i) {
+        ComPtr<IMFMediaBuffer> buf;
+        if (SUCCEEDED(src->GetBufferByIndex(i, &buf))) out->AddBuffer(buf.Get());
+    }
+    if (SUCCEEDED(src->GetSampleDuration(&dur))) out->SetSampleDuration(dur);
+    return out->SetSampleTime(t - base);
+}
+
+// Whether the AAC encoder the sink writer would insert takes this output
+// type. Asked of the MFT directly: a sink writer stream cannot be removed
+// once AddStream has succeeded, and SetInputMediaType fails too late.
+bool aac_profile_supported(AacProfile profile, uint32_t sample_rate, uint16_t channels,
+                           uint32_t bitrate) {
+    MFT_REGISTER_TYPE_INFO out_info{ MFMediaType_Audio, MFAudioFormat_AAC };
+    IMFActivate** activates = nullptr;
+    UINT32 count = 0;
+    if (FAILED(MFTEnumEx(MFT_CATEGORY_AUDIO_ENCODER, MFT_ENUM_FLAG_SYNCMFT | MFT_ENUM_FLAG_SORTANDFILTER,
+                         nullptr, &out_info, &activates, &count)) || count == 0) {
+        if (activates) CoTaskMemFree(activates);
+        return false;
+    }
+    bool ok = false;
+    ComPtr<IMFTransform> mft;
+    ComPtr<IMFMediaType> type;
+    if (SUCCEEDED(activates[0]->ActivateObject(IID_PPV_ARGS(&mft))) && SUCCEEDED(MFCreateMediaType(&type))) {
+        type->SetGUID(MF_MT_MAJOR_TYPE, MFMediaType_Audio);
+        type->SetGUID(MF_MT_SUBTYPE, MFAudioFormat_AAC);
+        type->SetUINT32(MF_MT_AUDIO_SAMPLES_PER_SECOND, sample_rate);
+        type->SetUINT32(MF_MT_AUDIO_NUM_CHANNELS, channels);
+        type->SetUINT32(MF_MT_AUDIO_BITS_PER_SAMPLE, 16);
+        type->SetUINT32(MF_MT_AUDIO_AVG_BYTES_PER_SECOND, bitrate / 8);
+        type->SetUINT32(MF_MT_AAC_PAYLOAD_TYPE, 0);
+        type->SetUINT32(MF_MT_AAC_AUDIO_PROFILE_LEVEL_INDICATION, aac_profile_level(profile));
+        ok = SUCCEEDED(mft->SetOutputType(0, type.Get(), MFT_SET_TYPE_TEST_ONLY));
+        activates[0]->ShutdownObject();
+    }
+    for (UINT32 i = 0; i < count; ++i) activates[i]->Release();
+    CoTaskMemFree(activates);
+    return ok;
+}
+
+} // namespace
+
 HRESULT configure_mux_writer_attributes(IMFAttributes* attrs) {
     if (!attrs) return E_POINTER;
 
@@ -32,6 +94,10 @@ bool MuxWriter::initialize(const std::wstring& partial_path,
 {
     partial_path_ = partial_path;
     final_path_   = final_path;
+    // A reused writer starts a fresh timeline; set_time_base() follows if needed
+    time_base_     = 0;
+    audio_dropped_ = 0;
+    bytes_written_ = 0;
 
     // --- Sink Writer Attributes ---
     ComPtr<IMFAttributes> attrs;
@@ -41,44 +107,77 @@ bool MuxWriter::initialize(const std::wstring& partial_path,
     hr = configure_mux_writer_attributes(attrs.Get());
     if (FAILED(hr)) { SR_LOG_ERROR(L"MuxWriter attribute setup failed: 0x%08X", hr); return false; }
 
+    if (cfg.container == MuxContainer::FragmentedMp4) {
+        hr = attrs->SetGUID(MF_TRANSCODE_CONTAINERTYPE, MFTranscodeContainerType_FMPEG4);
+        if (FAILED(hr)) { SR_LOG_ERROR(L"MuxWriter fMP4 container setup failed: 0x%08X", hr); return false; }
+    }
+    fragmented_ = cfg.container == MuxContainer::FragmentedMp4;
+    variable_frame_rate_ = cfg.variable_frame_rate;
+    pending_video_.Reset();
+    key_index_.clear();
+    write_key_index_ = cfg.keyframe_index;
+
     // --- Create SinkWriter ---
-    hr = MFCreateSinkWriterFromURL(partial_path.c_str(), nullptr, attrs.Get(),
+    // Unbuffered mode hands the sink our write-behind byte stream; its handle
+    // is opened FILE_SHARE_READ, so it is the exclusive lock as well.
+    if (cfg.unbuffered_io) {
+        byte_stream_.Attach(UnbufferedByteStream::create(partial_path, cfg.io_chunk_mb << 20));
+        if (!byte_stream_) SR_LOG_WARN(L"Falling back to buffered output for '%s'", partial_path.c_str());
+    }
+    hr = MFCreateSinkWriterFromURL(partial_path.c_str(), byte_stream_.Get(), attrs.Get(),
                                    &sink_writer_);
     if (FAILED(hr)) {
         SR_LOG_ERROR(L"MFCreateSinkWriterFromURL('%s') failed: 0x%08X",
                      partial_path.c_str(), hr);
+        if (byte_stream_) {
+            byte_stream_->Close();
+            byte_stream_.Reset();
+        }
         return false;
     }
 
-    // T029: Acquire exclusive write lock (FILE_SHARE_READ only).
-    // MFSinkWriter already opened the file; we open a second handle from our
-    // process with FILE_SHARE_READ so external processes cannot open for write.
-    lock_handle_ = CreateFileW(
-        partial_path.c_str(),
-        GENERIC_WRITE,
-        FILE_SHARE_READ,   // allow only readers, block external writers
-        nullptr,
-        OPEN_EXISTING,
-        FILE_ATTRIBUTE_NORMAL,
-        nullptr);
-    if (lock_handle_ == INVALID_HANDLE_VALUE) {
-        // Non-fatal: log and continue — recording still works, just without exclusive lock
-        SR_LOG_WARN(L"Could not acquire exclusive file lock on '%s': %u",
-                    partial_path.c_str(), GetLastError());
-        lock_handle_ = INVALID_HANDLE_VALUE;
+    if (!byte_stream_) {
+        // T029: Acquire exclusive write lock (FILE_SHARE_READ only).
+        // MFSinkWriter already opened the file; we open a second handle from our
+        // process with FILE_SHARE_READ so external processes cannot open for write.
+        lock_handle_ = CreateFileW(
+            partial_path.c_str(),
+            GENERIC_WRITE | FILE_READ_ATTRIBUTES,   // size queries for preallocation
+            FILE_SHARE_READ,   // allow only readers, block external writers
+            nullptr,
+            OPEN_EXISTING,
+            FILE_ATTRIBUTE_NORMAL,
+            nullptr);
+        if (lock_handle_ == INVALID_HANDLE_VALUE) {
+            // Non-fatal: log and continue — recording still works, just without exclusive lock
+            SR_LOG_WARN(L"Could not acquire exclusive file lock on '%s': %u",
+                        partial_path.c_str(), GetLastError());
+            lock_handle_ = INVALID_HANDLE_VALUE;
+        } else {
+            SR_LOG_INFO(L"Exclusive write lock acquired on partial file");
+        }
+    }
+
+    if (cfg.preallocate) {
+        const HANDLE file = byte_stream_ ? byte_stream_->native_handle() : lock_handle_;
+        prealloc_.reset(file, preallocation_increment(
+            cfg.video_bitrate + audio_track_bitrate(cfg.audio_codec, cfg.aac_profile, cfg.audio_bitrate)));
+        if (prealloc_.extend_for(0)) {
+            SR_LOG_INFO(L"Preallocating output in %llu MB steps", prealloc_.allocated() >> 20);
+        }
     } else {
-        SR_LOG_INFO(L"Exclusive write lock acquired on partial file");
+        prealloc_.reset(INVALID_HANDLE_VALUE, 0);
     }
 
     // ===================================================================
-    // VIDEO STREAM — H.264 output
+    // VIDEO STREAM — H.264 / HEVC / AV1 passthrough (MP4: avc1 / hvc1 / av01)
     // ===================================================================
     ComPtr<IMFMediaType> video_out;
     hr = MFCreateMediaType(&video_out);
     if (FAILED(hr)) return false;
 
     video_out->SetGUID(MF_MT_MAJOR_TYPE,     MFMediaType_Video);
-    video_out->SetGUID(MF_MT_SUBTYPE,        MFVideoFormat_H264);
+    video_out->SetGUID(MF_MT_SUBTYPE,        video_codec_subtype(cfg.video_codec));
     video_out->SetUINT32(MF_MT_AVG_BITRATE,  cfg.video_bitrate);
     video_out->SetUINT32(MF_MT_INTERLACE_MODE, MFVideoInterlace_Progressive);
     MFSetAttributeSize(video_out.Get(), MF_MT_FRAME_SIZE,
@@ -86,15 +185,20 @@ bool MuxWriter::initialize(const std::wstring& partial_path,
     MFSetAttributeRatio(video_out.Get(), MF_MT_FRAME_RATE,
                         cfg.video_fps_num, cfg.video_fps_den);
     MFSetAttributeRatio(video_out.Get(), MF_MT_PIXEL_ASPECT_RATIO, 1, 1);
-    video_out->SetUINT32(MF_MT_MPEG2_PROFILE, eAVEncH264VProfile_Main);
+    video_out->SetUINT32(MF_MT_MPEG2_PROFILE, video_codec_profile(cfg.video_codec));
+    if (!cfg.video_sequence_header.empty()) {
+        video_out->SetBlob(MF_MT_MPEG_SEQUENCE_HEADER, cfg.video_sequence_header.data(),
+                           static_cast<UINT32>(cfg.video_sequence_header.size()));
+    }
 
     hr = sink_writer_->AddStream(video_out.Get(), &video_stream_index_);
     if (FAILED(hr)) {
-        SR_LOG_ERROR(L"SinkWriter AddStream (video) failed: 0x%08X", hr);
+        SR_LOG_ERROR(L"SinkWriter AddStream (video, %s) failed: 0x%08X",
+                     video_codec_label(cfg.video_codec), hr);
         return false;
     }
 
-    // Set matching input type (we pass pre-encoded H.264)
+    // Set matching input type (we pass the pre-encoded elementary stream)
     hr = sink_writer_->SetInputMediaType(video_stream_index_, video_out.Get(), nullptr);
     if (FAILED(hr)) {
         SR_LOG_ERROR(L"SetInputMediaType (video) failed: 0x%08X", hr);
@@ -102,64 +206,162 @@ bool MuxWriter::initialize(const std::wstring& partial_path,
     }
 
     // ===================================================================
-    // AUDIO STREAM — AAC-LC output
+    // AUDIO STREAM(S) — AAC or Opus; optional second track for system audio
     // ===================================================================
-    ComPtr<IMFMediaType> audio_out;
-    hr = MFCreateMediaType(&audio_out);
-    if (FAILED(hr)) return false;
-
-    audio_out->SetGUID(MF_MT_MAJOR_TYPE,              MFMediaType_Audio);
-    audio_out->SetGUID(MF_MT_SUBTYPE,                 MFAudioFormat_AAC);
-    audio_out->SetUINT32(MF_MT_AUDIO_SAMPLES_PER_SECOND, cfg.audio_sample_rate);
-    audio_out->SetUINT32(MF_MT_AUDIO_NUM_CHANNELS,       cfg.audio_channels);
-    audio_out->SetUINT32(MF_MT_AUDIO_AVG_BYTES_PER_SECOND, cfg.audio_bitrate / 8);
-    audio_out->SetUINT32(MF_MT_AUDIO_BITS_PER_SAMPLE,    16);
-    audio_out->SetUINT32(MF_MT_AAC_PAYLOAD_TYPE,          0); // Raw AAC
+    if (!add_audio_stream(cfg, cfg.audio_sample_rate, cfg.audio_channels, cfg.audio_bits_per_sample,
+                          cfg.audio_is_float, main_audio_encoder_, audio_stream_index_)) {
+        return false;
+    }
+    system_track_ = cfg.system_audio_track;
+    if (system_track_ &&
+        !add_audio_stream(cfg, cfg.system_audio_sample_rate, cfg.system_audio_channels,
+                          cfg.system_audio_bits_per_sample, cfg.system_audio_is_float,
+                          system_audio_encoder_, system_stream_index_)) {
+        return false;
+    }
 
-    hr = sink_writer_->AddStream(audio_out.Get(), &audio_stream_index_);
+    // ===================================================================
+    // Begin writing
+    // ===================================================================
+    hr = sink_writer_->BeginWriting();
     if (FAILED(hr)) {
-        SR_LOG_ERROR(L"SinkWriter AddStream (audio) failed: 0x%08X", hr);
+        SR_LOG_ERROR(L"SinkWriter::BeginWriting failed: 0x%08X", hr);
+        return false;
+    }
+
+    // Stream parameters for rebuilding the moov should the process die
+    RecoveryInfo recovery;
+    recovery.codec          = cfg.video_codec;
+    recovery.fragmented     = fragmented_;
+    recovery.params.width   = cfg.video_width;
+    recovery.params.height  = cfg.video_height;
+    recovery.params.fps_num = cfg.video_fps_num;
+    recovery.params.fps_den = cfg.video_fps_den;
+    if (!recovery.save(partial_path, cfg.video_sequence_header)) {
+        SR_LOG_WARN(L"MuxWriter: recovery sidecar not written for '%s'", partial_path.c_str());
+    }
+
+    initialized_ = true;
+    SR_LOG_INFO(L"MuxWriter: writing to '%s' (%s%s)", partial_path.c_str(),
+                fragmented_ ? L"fragmented MP4" : L"MP4",
+                system_track_ ? L", separate mic/system audio tracks" : L"");
+    return true;
+}
+
+// One audio track. Opus: the encoder stage's packets pass straight through
+// (falls back to AAC when no encoder MFT exists or the container refuses
+// it); AAC: PCM / IEEE float in, the sink writer encodes.
+bool MuxWriter::add_audio_stream(const MuxConfig& cfg, uint32_t sample_rate, uint16_t channels,
+                                 uint32_t bits_per_sample, bool is_float, AudioEncoderMft& encoder,
+                                 DWORD& stream_index) {
+    encoder.release();
+    if (cfg.audio_codec == AudioCodec::Opus) {
+        AudioEncoderConfig ec;
+        ec.codec           = AudioCodec::Opus;
+        ec.sample_rate     = sample_rate;
+        ec.channels        = channels;
+        ec.bits_per_sample = bits_per_sample;
+        ec.is_float        = is_float;
+        ec.bitrate_bps     = opus_bitrate(cfg.audio_bitrate);
+        if (encoder.initialize(ec)) {
+            HRESULT hr = sink_writer_->AddStream(encoder.output_type(), &stream_index);
+            if (SUCCEEDED(hr)) {
+                hr = sink_writer_->SetInputMediaType(stream_index, encoder.output_type(), nullptr);
+                if (FAILED(hr)) {
+                    SR_LOG_ERROR(L"SetInputMediaType (audio Opus) failed: 0x%08X", hr);
+                    return false;
+                }
+                return true;
+            }
+            SR_LOG_WARN(L"Container refused the Opus track (0x%08X) — using AAC", hr);
+            encoder.release();
+        } else {
+            SR_LOG_WARN(L"Opus encoder unavailable — using AAC");
+        }
+    }
+
+    AacProfile profile = cfg.aac_profile;
+    if (profile == AacProfile::HE && !aac_profile_supported(profile, sample_rate, channels,
+                                                            aac_encoder_bitrate(cfg.audio_bitrate, profile))) {
+        SR_LOG_WARN(L"AAC encoder has no HE-AAC at %u Hz / %u ch — using AAC-LC", sample_rate, channels);
+        profile = AacProfile::LC;
+    }
+    if (!add_aac_stream(sample_rate, channels, profile, aac_encoder_bitrate(cfg.audio_bitrate, profile),
+                        stream_index)) {
         return false;
     }
 
     // Input audio type: PCM or IEEE Float (SinkWriter will encode to AAC)
     ComPtr<IMFMediaType> audio_in;
-    hr = MFCreateMediaType(&audio_in);
+    HRESULT hr = MFCreateMediaType(&audio_in);
     if (FAILED(hr)) return false;
 
-    GUID audio_subtype = cfg.audio_is_float ? MFAudioFormat_Float : MFAudioFormat_PCM;
+    GUID audio_subtype = is_float ? MFAudioFormat_Float : MFAudioFormat_PCM;
     audio_in->SetGUID(MF_MT_MAJOR_TYPE,              MFMediaType_Audio);
     audio_in->SetGUID(MF_MT_SUBTYPE,                 audio_subtype);
-    audio_in->SetUINT32(MF_MT_AUDIO_SAMPLES_PER_SECOND, cfg.audio_sample_rate);
-    audio_in->SetUINT32(MF_MT_AUDIO_NUM_CHANNELS,       cfg.audio_channels);
-    audio_in->SetUINT32(MF_MT_AUDIO_BITS_PER_SAMPLE,    cfg.audio_bits_per_sample);
-    uint32_t block_align = cfg.audio_channels * (cfg.audio_bits_per_sample / 8);
+    audio_in->SetUINT32(MF_MT_AUDIO_SAMPLES_PER_SECOND, sample_rate);
+    audio_in->SetUINT32(MF_MT_AUDIO_NUM_CHANNELS,       channels);
+    audio_in->SetUINT32(MF_MT_AUDIO_BITS_PER_SAMPLE,    bits_per_sample);
+    uint32_t block_align = channels * (bits_per_sample / 8);
     audio_in->SetUINT32(MF_MT_AUDIO_BLOCK_ALIGNMENT, block_align);
     audio_in->SetUINT32(MF_MT_AUDIO_AVG_BYTES_PER_SECOND,
-                         cfg.audio_sample_rate * block_align);
+                         sample_rate * block_align);
 
-    hr = sink_writer_->SetInputMediaType(audio_stream_index_, audio_in.Get(), nullptr);
+    hr = sink_writer_->SetInputMediaType(stream_index, audio_in.Get(), nullptr);
     if (FAILED(hr)) {
         SR_LOG_ERROR(L"SetInputMediaType (audio PCM) failed: 0x%08X", hr);
         return false;
     }
+    return true;
+}
 
-    // ===================================================================
-    // Begin writing
-    // ===================================================================
-    hr = sink_writer_->BeginWriting();
+bool MuxWriter::add_aac_stream(uint32_t sample_rate, uint16_t channels, AacProfile profile,
+                               uint32_t bitrate, DWORD& stream_index) {
+    ComPtr<IMFMediaType> audio_out;
+    HRESULT hr = MFCreateMediaType(&audio_out);
+    if (FAILED(hr)) return false;
+
+    audio_out->SetGUID(MF_MT_MAJOR_TYPE,              MFMediaType_Audio);
+    audio_out->SetGUID(MF_MT_SUBTYPE,                 MFAudioFormat_AAC);
+    audio_out->SetUINT32(MF_MT_AUDIO_SAMPLES_PER_SECOND, sample_rate);
+    audio_out->SetUINT32(MF_MT_AUDIO_NUM_CHANNELS,       channels);
+    audio_out->SetUINT32(MF_MT_AUDIO_AVG_BYTES_PER_SECOND, bitrate / 8);
+    audio_out->SetUINT32(MF_MT_AUDIO_BITS_PER_SAMPLE,    16);
+    audio_out->SetUINT32(MF_MT_AAC_PAYLOAD_TYPE,          0); // Raw AAC
+    audio_out->SetUINT32(MF_MT_AAC_AUDIO_PROFILE_LEVEL_INDICATION, aac_profile_level(profile));
+
+    hr = sink_writer_->AddStream(audio_out.Get(), &stream_index);
     if (FAILED(hr)) {
-        SR_LOG_ERROR(L"SinkWriter::BeginWriting failed: 0x%08X", hr);
+        SR_LOG_ERROR(L"SinkWriter AddStream (audio %s %u kb/s) failed: 0x%08X",
+                     aac_profile_label(profile), bitrate / 1000, hr);
         return false;
     }
-
-    initialized_ = true;
-    SR_LOG_INFO(L"MuxWriter: writing to '%s'", partial_path.c_str());
     return true;
 }
 
 bool MuxWriter::write_video(IMFSample* sample) {
     if (!initialized_) return false;
+    ComPtr<IMFSample> rebased;
+    if (time_base_ != 0 && SUCCEEDED(rebase_sample(sample, time_base_, rebased))) {
+        sample = rebased.Get();
+    }
+    if (!variable_frame_rate_) return write_video_now(sample);
+
+    // VFR: the held sample lasts until this one starts
+    bool ok = true;
+    if (pending_video_) {
+        LONGLONG prev = 0, next = 0;
+        if (SUCCEEDED(pending_video_->GetSampleTime(&prev)) &&
+            SUCCEEDED(sample->GetSampleTime(&next)) && next > prev) {
+            pending_video_->SetSampleDuration(next - prev);
+        }
+        ok = write_video_now(pending_video_.Get());
+    }
+    pending_video_ = sample;
+    return ok;
+}
+
+bool MuxWriter::write_video_now(IMFSample* sample) {
     HRESULT hr = sink_writer_->WriteSample(video_stream_index_, sample);
     if (FAILED(hr)) {
         SR_LOG_ERROR(L"WriteSample (video) failed: 0x%08X", hr);
@@ -170,12 +372,36 @@ bool MuxWriter::write_video(IMFSample* sample) {
     DWORD buf_len = 0;
     sample->GetTotalLength(&buf_len);
     bytes_written_ += buf_len;
+    LONGLONG t = 0;
+    sample->GetSampleTime(&t);
+    key_index_.on_video_sample(t, buf_len,
+                               MFGetAttributeUINT32(sample, MFSampleExtension_CleanPoint, FALSE) != 0);
+    prealloc_.extend_for(bytes_written_);
     return true;
 }
 
-bool MuxWriter::write_audio(IMFSample* sample) {
+bool MuxWriter::write_audio(IMFSample* sample, AudioTrack track) {
     if (!initialized_) return false;
-    HRESULT hr = sink_writer_->WriteSample(audio_stream_index_, sample);
+    // Without a system track everything goes to the main track
+    const DWORD stream = (track == AudioTrack::System && system_track_)
+        ? system_stream_index_ : audio_stream_index_;
+    ComPtr<IMFSample> rebased;
+    if (time_base_ != 0) {
+        LONGLONG t = 0;
+        if (SUCCEEDED(sample->GetSampleTime(&t)) && t < time_base_) {
+            ++audio_dropped_;
+            return true;
+        }
+        if (SUCCEEDED(rebase_sample(sample, time_base_, rebased))) sample = rebased.Get();
+    }
+    AudioEncoderMft& encoder = (track == AudioTrack::System && system_track_)
+        ? system_audio_encoder_ : main_audio_encoder_;
+    if (encoder.ready()) {
+        encoded_audio_.clear();
+        const bool ok = encoder.encode(sample, encoded_audio_);
+        return write_encoded_audio(stream, encoded_audio_) && ok;
+    }
+    HRESULT hr = sink_writer_->WriteSample(stream, sample);
     if (FAILED(hr)) {
         SR_LOG_ERROR(L"WriteSample (audio) failed: 0x%08X", hr);
         return false;
@@ -183,16 +409,67 @@ bool MuxWriter::write_audio(IMFSample* sample) {
     DWORD buf_len = 0;
     sample->GetTotalLength(&buf_len);
     bytes_written_ += buf_len;
+    prealloc_.extend_for(bytes_written_);
+    return true;
+}
+
+bool MuxWriter::write_encoded_audio(DWORD stream, std::vector<ComPtr<IMFSample>>& packets) {
+    for (auto& packet : packets) {
+        HRESULT hr = sink_writer_->WriteSample(stream, packet.Get());
+        if (FAILED(hr)) {
+            SR_LOG_ERROR(L"WriteSample (encoded audio) failed: 0x%08X", hr);
+            return false;
+        }
+        DWORD buf_len = 0;
+        packet->GetTotalLength(&buf_len);
+        bytes_written_ += buf_len;
+    }
+    packets.clear();
+    prealloc_.extend_for(bytes_written_);
     return true;
 }
 
 bool MuxWriter::finalize() {
     if (!sink_writer_) return true;
+    if (pending_video_) {
+        // Last VFR sample keeps the encoder's nominal duration
+        write_video_now(pending_video_.Get());
+        pending_video_.Reset();
+    }
+    // Opus stages hold up to one batch plus the encoder's lookahead
+    if (main_audio_encoder_.ready()) {
+        encoded_audio_.clear();
+        main_audio_encoder_.drain(encoded_audio_);
+        write_encoded_audio(audio_stream_index_, encoded_audio_);
+    }
+    if (system_audio_encoder_.ready()) {
+        encoded_audio_.clear();
+        system_audio_encoder_.drain(encoded_audio_);
+        write_encoded_audio(system_stream_index_, encoded_audio_);
+    }
+    main_audio_encoder_.release();
+    system_audio_encoder_.release();
     initialized_ = false;
 
     HRESULT hr = sink_writer_->Finalize();
     sink_writer_.Reset();
 
+    // Release unused preallocation (the unbuffered stream trims in Close())
+    if (prealloc_.extensions() > 0) {
+        SR_LOG_INFO(L"Preallocation: %u extensions", prealloc_.extensions());
+    }
+    if (!byte_stream_) prealloc_.trim();
+    prealloc_.reset(INVALID_HANDLE_VALUE, 0);
+
+    if (byte_stream_) {
+        const HRESULT close_hr = byte_stream_->Close();
+        if (SUCCEEDED(hr)) hr = close_hr;
+        SR_LOG_INFO(L"Unbuffered writer: %llu MB submitted, %u write stalls, %u back-patches",
+                    byte_stream_->bytes_submitted() >> 20, byte_stream_->write_stalls(),
+                    byte_stream_->disk_patches());
+        byte_stream_.Reset();
+    }
+
     // T029: Release exclusive write lock before rename so MoveFileEx succeeds
     if (lock_handle_ != INVALID_HANDLE_VALUE) {
         CloseHandle(lock_handle_);
@@ -205,6 +482,7 @@ bool MuxWriter::finalize() {
         SR_LOG_WARN(L"Keeping partial file (not renaming to .mp4): %s", partial_path_.c_str());
         return false;
     }
+    RecoveryInfo::remove(partial_path_);   // the sink wrote a complete moov
 
     // Rename .partial.mp4 -> .mp4
     if (!partial_path_.empty() && !final_path_.empty()) {
@@ -216,6 +494,11 @@ bool MuxWriter::finalize() {
             return false;
         }
         SR_LOG_INFO(L"Recording saved: %s", final_path_.c_str());
+        // Best effort: without the sidecar a trim falls back to container seeks
+        if (write_key_index_ && !key_index_.empty() &&
+            !key_index_.save(KeyframeIndex::sidecar_path(final_path_))) {
+            SR_LOG_WARN(L"Keyframe index for '%s' could not be written", final_path_.c_str());
+        }
     }
 
     return SUCCEEDED(hr);
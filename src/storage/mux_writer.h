@@ -9,6 +9,13 @@
 #include <wrl/client.h>
 #include <string>
 #include <cstdint>
+#include <vector>
+#include "utils/audio_codec.h"
+#include "utils/video_codec.h"
+#include "encoder/audio_encoder.h"
+#include "storage/unbuffered_byte_stream.h"
+#include "storage/file_preallocator.h"
+#include "storage/keyframe_index.h"
 
 namespace sr {
 
@@ -16,20 +23,60 @@ using Microsoft::WRL::ComPtr;
 
 HRESULT configure_mux_writer_attributes(IMFAttributes* attrs);
 
+// Output container layout
+enum class MuxContainer : uint8_t {
+    Mp4,            // classic MP4: moov written at finalize
+    FragmentedMp4,  // fMP4 (moof/mdat per fragment): every fragment playable after a crash
+};
+
+// Audio track a PCM sample belongs to
+enum class AudioTrack : uint8_t {
+    Main,    // microphone, or the mic + system mix
+    System,  // system audio, when muxed as its own track
+};
+
 struct MuxConfig {
+    // Container
+    MuxContainer container    = MuxContainer::Mp4;
+    uint32_t fragment_ms      = 2000;   // fMP4: target fragment duration (IDR cadence)
+
+    // File I/O: unbuffered overlapped writes in io_chunk_mb chunks (4-8)
+    // instead of the sink's small cached writes — for network shares / HDDs
+    bool     unbuffered_io    = false;
+    uint32_t io_chunk_mb      = 4;
+    bool     preallocate      = false;  // reserve extents in multi-minute steps (FilePreallocator)
+    bool     keyframe_index   = true;   // write <final>.keyidx (KeyframeIndex) for lossless trims
+
     // Video stream
     uint32_t video_width      = 1920;
     uint32_t video_height     = 1080;
     uint32_t video_fps_num    = 30;
     uint32_t video_fps_den    = 1;
     uint32_t video_bitrate    = 4'000'000;
+    VideoCodec video_codec    = VideoCodec::H264;
+    std::vector<uint8_t> video_sequence_header;  // codec private data; empty = taken from the stream
+    // VFR: each video sample's duration is set to the gap to the next one
+    // instead of the encoder's nominal 1/fps (video_fps_num stays the nominal rate)
+    bool     variable_frame_rate = false;
 
-    // Audio stream
+    // Audio stream. AAC is encoded inside the sink writer (bitrate snapped
+    // to aac_encoder_bitrate); Opus runs through an AudioEncoderMft stage and
+    // falls back to AAC when no Opus encoder is installed.
+    AudioCodec audio_codec        = AudioCodec::AAC;
+    AacProfile aac_profile        = AacProfile::LC;
     uint32_t audio_sample_rate    = 48000;
     uint16_t audio_channels       = 2;
     uint32_t audio_bitrate        = 128'000;
     uint32_t audio_bits_per_sample= 16;   // 16 = PCM int, 32 = IEEE float
     bool     audio_is_float       = false;
+
+    // Second audio track: system audio unmixed (the main track is then mic only).
+    // Editors get both stems; players typically pick the first track.
+    bool     system_audio_track            = false;
+    uint32_t system_audio_sample_rate      = 48000;
+    uint16_t system_audio_channels         = 2;
+    uint32_t system_audio_bits_per_sample  = 16;
+    bool     system_audio_is_float         = false;
 };
 
 class MuxWriter {
@@ -44,27 +91,61 @@ public:
                     const std::wstring& final_path,
                     const MuxConfig& cfg);
 
-    // Write an encoded H.264 sample (must be called from encode thread)
+    // Write an encoded video sample (must be called from the mux thread).
+    // VFR: the sample is held until the next one (or finalize) fixes its duration.
     bool write_video(IMFSample* sample);
 
-    // Write an AAC audio sample
-    bool write_audio(IMFSample* sample);
+    // Write a PCM audio sample to `track` (encoded by the sink, or by the
+    // track's encoder stage for Opus)
+    bool write_audio(IMFSample* sample, AudioTrack track = AudioTrack::Main);
 
     // Finalize the writer; renames partial_path -> final_path on success
+    // and saves the keyframe index sidecar next to it
     bool finalize();
 
+    // Segmented recording: sample times are written relative to `base_100ns`
+    // (the opening IDR's PTS) so each segment starts at zero. Audio that
+    // precedes the base belongs to the previous segment and is dropped.
+    void set_time_base(int64_t base_100ns) { time_base_ = base_100ns; }
+    int64_t  time_base()      const { return time_base_; }
+    uint32_t audio_dropped()  const { return audio_dropped_; }
+
     bool        initialized()  const { return initialized_; }
+    bool        fragmented()   const { return fragmented_; }
     uint64_t    bytes_written()const { return bytes_written_; }
     std::wstring final_path()  const { return final_path_; }
+    const KeyframeIndex& keyframe_index() const { return key_index_; }
 
 private:
+    bool write_video_now(IMFSample* sample);
+    bool add_audio_stream(const MuxConfig& cfg, uint32_t sample_rate, uint16_t channels,
+                          uint32_t bits_per_sample, bool is_float, AudioEncoderMft& encoder,
+                          DWORD& stream_index);
+    bool add_aac_stream(uint32_t sample_rate, uint16_t channels, AacProfile profile,
+                        uint32_t bitrate, DWORD& stream_index);
+    bool write_encoded_audio(DWORD stream, std::vector<ComPtr<IMFSample>>& packets);
+
     ComPtr<IMFSinkWriter> sink_writer_;
+    ComPtr<UnbufferedByteStream> byte_stream_;   // unbuffered_io only
+    FilePreallocator      prealloc_;
     std::wstring          partial_path_;
     std::wstring          final_path_;
     DWORD                 video_stream_index_ = 0;
     DWORD                 audio_stream_index_ = 1;
+    DWORD                 system_stream_index_ = 2;
+    bool                  system_track_       = false;
+    AudioEncoderMft       main_audio_encoder_;     // Opus only; AAC is encoded by the sink
+    AudioEncoderMft       system_audio_encoder_;
+    std::vector<ComPtr<IMFSample>> encoded_audio_;  // reused per write_audio
     bool                  initialized_        = false;
+    bool                  fragmented_         = false;
+    bool                  variable_frame_rate_ = false;
+    ComPtr<IMFSample>     pending_video_;     // VFR: last sample, duration not yet known
+    KeyframeIndex         key_index_;         // clean points written so far (file time)
+    bool                  write_key_index_    = false;
     uint64_t              bytes_written_      = 0;
+    int64_t               time_base_          = 0;
+    uint32_t              audio_dropped_      = 0;  // audio before time_base_
     // T029: exclusive write lock — FILE_SHARE_READ only, prevents external writes
     HANDLE                lock_handle_        = INVALID_HANDLE_VALUE;
 };
@@ -0,0 +1,504 @@
+// network_sink.cpp — RTMP publisher thread for the live-stream sink (see network_sink.h)
+
+// Winsock 2 must come before <windows.h> (pulled in by network_sink.h),
+// which would otherwise drag in the old winsock.h
+#include <winsock2.h>
+#include <ws2tcpip.h>
+
+#include "storage/network_sink.h"
+#include "storage/rtmp_protocol.h"
+#include "utils/logging.h"
+
+#include <mfapi.h>
+#include <wrl/client.h>
+#include <algorithm>
+#include <climits>
+#include <functional>
+#include <string>
+
+#pragma comment(lib, "ws2_32.lib")
+
+namespace sr {
+
+using Microsoft::WRL::ComPtr;
+
+namespace {
+
+constexpr DWORD    kIoTimeoutMs      = 5000;
+constexpr DWORD    kReplyTimeoutMs   = 5000;
+constexpr uint32_t kMinBackoffMs     = 1000;
+constexpr uint32_t kMaxBackoffMs     = 30'000;
+constexpr auto     kPopWait          = std::chrono::milliseconds(100);
+constexpr uintptr_t kNoSocket        = ~uintptr_t{ 0 };
+
+std::string to_utf8(const std::wstring& w) {
+    if (w.empty()) return {};
+    const int n = WideCharToMultiByte(CP_UTF8, 0, w.c_str(), static_cast<int>(w.size()),
+                                      nullptr, 0, nullptr, nullptr);
+    std::string out(static_cast<size_t>(n > 0 ? n : 0), '\0');
+    if (n > 0) {
+        WideCharToMultiByte(CP_UTF8, 0, w.c_str(), static_cast<int>(w.size()), out.data(), n,
+                            nullptr, nullptr);
+    }
+    return out;
+}
+
+bool is_command(const std::vector<Amf0Value>& v, std::string_view name) {
+    return !v.empty() && v[0].type == Amf0Value::Type::String && v[0].string == name;
+}
+
+} // namespace
+
+// ---------------------------------------------------------------------------
+// One TCP connection: handshake, connect / createStream / publish, then
+// video messages. Every failure returns false and the caller reconnects.
+class NetworkSink::Connection {
+public:
+    explicit Connection(std::atomic<uintptr_t>& published_socket)
+        : published_(published_socket)
+        , reader_([this](const RtmpMessage& m) { inbox_.push_back(m); }) {}
+    ~Connection() { close(); }
+
+    bool open(const RtmpUrl& url) {
+        if (!connect_tcp(url)) return false;
+        if (!handshake()) {
+            SR_LOG_WARN(L"Live: RTMP handshake with %S failed", url.host.c_str());
+            return false;
+        }
+
+        std::vector<uint8_t> payload;
+        const uint8_t chunk[4] = { static_cast<uint8_t>(rtmp::kOutChunkSize >> 24),
+                                   static_cast<uint8_t>(rtmp::kOutChunkSize >> 16),
+                                   static_cast<uint8_t>(rtmp::kOutChunkSize >> 8),
+                                   static_cast<uint8_t>(rtmp::kOutChunkSize) };
+        if (!send_message(rtmp::kCsidControl, 0, rtmp::kSetChunkSize, 0, chunk, sizeof(chunk))) return false;
+        out_chunk_ = rtmp::kOutChunkSize;
+
+        {
+            Amf0Writer w(payload);
+            w.string("connect");
+            w.number(1);
+            w.begin_object();
+            w.key("app");      w.string(url.app);
+            w.key("type");     w.string("nonprivate");
+            w.key("flashVer"); w.string("FMLE/3.0 (compatible; ScreenRecorder)");
+            w.key("tcUrl");    w.string(url.tc_url);
+            w.end_object();
+        }
+        std::vector<Amf0Value> reply;
+        if (!send_command(0, payload) || !wait_for_result(1, reply)) {
+            SR_LOG_WARN(L"Live: connect to app '%S' was refused", url.app.c_str());
+            return false;
+        }
+
+        for (const char* name : { "releaseStream", "FCPublish" }) {
+            payload.clear();
+            Amf0Writer w(payload);
+            w.string(name);
+            w.number(name[0] == 'r' ? 2 : 3);
+            w.null();
+            w.string(url.stream_key);
+            if (!send_command(0, payload)) return false;
+        }
+        payload.clear();
+        {
+            Amf0Writer w(payload);
+            w.string("createStream");
+            w.number(4);
+            w.null();
+        }
+        if (!send_command(0, payload) || !wait_for_result(4, reply) || reply.size() < 4 ||
+            reply[3].type != Amf0Value::Type::Number) {
+            SR_LOG_WARN(L"Live: createStream failed");
+            return false;
+        }
+        stream_id_ = static_cast<uint32_t>(reply[3].number);
+
+        payload.clear();
+        {
+            Amf0Writer w(payload);
+            w.string("publish");
+            w.number(5);
+            w.null();
+            w.string(url.stream_key);
+            w.string("live");
+        }
+        if (!send_command(stream_id_, payload) || !wait_for_publish_start()) {
+            SR_LOG_WARN(L"Live: publish was rejected");
+            return false;
+        }
+        return true;
+    }
+
+    bool send_format(const LiveVideoFormat& f) {
+        std::vector<uint8_t> payload;
+        Amf0Writer w(payload);
+        w.string("@setDataFrame");
+        w.string("onMetaData");
+        w.begin_ecma_array(7);
+        w.key("duration");      w.number(0);
+        w.key("width");         w.number(f.width);
+        w.key("height");        w.number(f.height);
+        w.key("framerate");     w.number(f.fps);
+        w.key("videodatarate"); w.number(f.bitrate_bps / 1000.0);
+        w.key("videocodecid");  w.number(7);   // AVC
+        w.key("encoder");       w.string("ScreenRecorder");
+        w.end_object();
+        if (!send_message(rtmp::kCsidData, 0, rtmp::kDataAmf0, stream_id_, payload.data(), payload.size())) {
+            return false;
+        }
+        const std::vector<uint8_t> header = flv_avc_sequence_header(f.sps, f.pps);
+        return send_message(rtmp::kCsidVideo, 0, rtmp::kVideo, stream_id_, header.data(), header.size());
+    }
+
+    bool send_video(const std::vector<uint8_t>& avcc, uint32_t ts_ms, bool keyframe) {
+        body_.clear();
+        flv_avc_nalu_header(body_, keyframe);
+        body_.insert(body_.end(), avcc.begin(), avcc.end());
+        return send_message(rtmp::kCsidVideo, ts_ms, rtmp::kVideo, stream_id_, body_.data(), body_.size());
+    }
+
+    // Drain what the server sent (acks, pings) without blocking
+    bool poll() { return pump(0) && handle_inbox(); }
+
+    void close() {
+        if (socket_ == INVALID_SOCKET) return;
+        published_.store(kNoSocket, std::memory_order_release);
+        closesocket(socket_);
+        socket_ = INVALID_SOCKET;
+    }
+
+private:
+    bool connect_tcp(const RtmpUrl& url) {
+        addrinfo hints{};
+        hints.ai_family   = AF_UNSPEC;
+        hints.ai_socktype = SOCK_STREAM;
+        hints.ai_protocol = IPPROTO_TCP;
+        addrinfo* list = nullptr;
+        const std::string port = std::to_string(url.port);
+        if (getaddrinfo(url.host.c_str(), port.c_str(), &hints, &list) != 0 || !list) {
+            SR_LOG_WARN(L"Live: cannot resolve %S: %d", url.host.c_str(), WSAGetLastError());
+            return false;
+        }
+        for (addrinfo* ai = list; ai && socket_ == INVALID_SOCKET; ai = ai->ai_next) {
+            SOCKET s = socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+            if (s == INVALID_SOCKET) continue;
+            published_.store(static_cast<uintptr_t>(s), std::memory_order_release);
+            if (connect_with_timeout(s, ai)) {
+                socket_ = s;
+            } else {
+                published_.store(kNoSocket, std::memory_order_release);
+                closesocket(s);
+            }
+        }
+        freeaddrinfo(list);
+        if (socket_ == INVALID_SOCKET) {
+            SR_LOG_WARN(L"Live: cannot connect to %S:%u", url.host.c_str(), url.port);
+            return false;
+        }
+        const DWORD timeout = kIoTimeoutMs;
+        setsockopt(socket_, SOL_SOCKET, SO_SNDTIMEO, reinterpret_cast<const char*>(&timeout), sizeof(timeout));
+        setsockopt(socket_, SOL_SOCKET, SO_RCVTIMEO, reinterpret_cast<const char*>(&timeout), sizeof(timeout));
+        const BOOL nodelay = TRUE;
+        setsockopt(socket_, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char*>(&nodelay), sizeof(nodelay));
+        return true;
+    }
+
+    // A blocking connect() to a dead host takes ~20 s to fail and cannot be
+    // interrupted by stop(), so connect non-blocking and wait kIoTimeoutMs
+    static bool connect_with_timeout(SOCKET s, const addrinfo* ai) {
+        u_long non_blocking = 1;
+        ioctlsocket(s, FIONBIO, &non_blocking);
+        bool connected = ::connect(s, ai->ai_addr, static_cast<int>(ai->ai_addrlen)) == 0;
+        if (!connected && WSAGetLastError() == WSAEWOULDBLOCK) {
+            fd_set writable, failed;
+            FD_ZERO(&writable);
+            FD_ZERO(&failed);
+            FD_SET(s, &writable);
+            FD_SET(s, &failed);
+            timeval tv{ static_cast<long>(kIoTimeoutMs / 1000), 0 };
+            connected = select(0, nullptr, &writable, &failed, &tv) > 0 && FD_ISSET(s, &writable);
+        }
+        non_blocking = 0;
+        ioctlsocket(s, FIONBIO, &non_blocking);
+        return connected;
+    }
+
+    // Simple (non-digest) handshake; C1 is zero time + zero padding
+    bool handshake() {
+        std::vector<uint8_t> c0c1(1 + rtmp::kHandshakeSize, 0);
+        c0c1[0] = 3;
+        if (!send_all(c0c1.data(), c0c1.size())) return false;
+        std::vector<uint8_t> s0s1(1 + rtmp::kHandshakeSize);
+        if (!recv_exact(s0s1.data(), s0s1.size()) || s0s1[0] != 3) return false;
+        if (!send_all(s0s1.data() + 1, rtmp::kHandshakeSize)) return false;   // C2 echoes S1
+        std::vector<uint8_t> s2(rtmp::kHandshakeSize);
+        return recv_exact(s2.data(), s2.size());
+    }
+
+    bool send_all(const uint8_t* d, size_t n) {
+        while (n > 0) {
+            const int chunk = static_cast<int>(std::min<size_t>(n, INT_MAX));
+            const int sent = ::send(socket_, reinterpret_cast<const char*>(d), chunk, 0);
+            if (sent <= 0) return false;
+            d += sent;
+            n -= static_cast<size_t>(sent);
+        }
+        return true;
+    }
+
+    bool recv_exact(uint8_t* d, size_t n) {
+        while (n > 0) {
+            const int got = ::recv(socket_, reinterpret_cast<char*>(d), static_cast<int>(n), 0);
+            if (got <= 0) return false;
+            d += got;
+            n -= static_cast<size_t>(got);
+            received_ += static_cast<uint64_t>(got);
+        }
+        return true;
+    }
+
+    bool send_message(uint32_t csid, uint32_t ts, uint8_t type, uint32_t stream_id,
+                      const uint8_t* payload, size_t size) {
+        wire_.clear();
+        append_rtmp_message(wire_, csid, ts, type, stream_id, payload, size, out_chunk_);
+        return send_all(wire_.data(), wire_.size());
+    }
+
+    bool send_command(uint32_t stream_id, const std::vector<uint8_t>& payload) {
+        return send_message(rtmp::kCsidCommand, 0, rtmp::kCommandAmf0, stream_id, payload.data(), payload.size());
+    }
+
+    // Read whatever arrives within `timeout_ms` into the chunk reader
+    bool pump(DWORD timeout_ms) {
+        fd_set readable;
+        FD_ZERO(&readable);
+        FD_SET(socket_, &readable);
+        timeval tv{ static_cast<long>(timeout_ms / 1000), static_cast<long>((timeout_ms % 1000) * 1000) };
+        const int ready = select(0, &readable, nullptr, nullptr, &tv);
+        if (ready < 0) return false;
+        if (ready == 0) return true;
+        uint8_t buf[4096];
+        const int got = ::recv(socket_, reinterpret_cast<char*>(buf), sizeof(buf), 0);
+        if (got <= 0) return false;   // closed by the server
+        received_ += static_cast<uint64_t>(got);
+        return reader_.feed(buf, static_cast<size_t>(got)) && acknowledge();
+    }
+
+    bool acknowledge() {
+        if (window_ == 0 || received_ - acked_ < window_) return true;
+        acked_ = received_;
+        const uint32_t seq = static_cast<uint32_t>(received_);
+        const uint8_t body[4] = { static_cast<uint8_t>(seq >> 24), static_cast<uint8_t>(seq >> 16),
+                                  static_cast<uint8_t>(seq >> 8), static_cast<uint8_t>(seq) };
+        return send_message(rtmp::kCsidControl, 0, rtmp::kAcknowledgement, 0, body, sizeof(body));
+    }
+
+    // Protocol control handled in place; commands stay queued for the waiters
+    bool handle_inbox() {
+        for (auto it = inbox_.begin(); it != inbox_.end();) {
+            const RtmpMessage& m = *it;
+            if (m.type == rtmp::kWindowAckSize && m.payload.size() >= 4) {
+                window_ = (uint32_t{ m.payload[0] } << 24) | (uint32_t{ m.payload[1] } << 16) |
+                          (uint32_t{ m.payload[2] } << 8) | m.payload[3];
+            } else if (m.type == rtmp::kUserControl && m.payload.size() >= 6 &&
+                       m.payload[0] == 0 && m.payload[1] == 6) {
+                // PingRequest -> PingResponse with the same timestamp
+                uint8_t pong[6] = { 0, 7, m.payload[2], m.payload[3], m.payload[4], m.payload[5] };
+                if (!send_message(rtmp::kCsidControl, 0, rtmp::kUserControl, 0, pong, sizeof(pong))) return false;
+            } else if (m.type == rtmp::kCommandAmf0) {
+                std::vector<Amf0Value> values;
+                if (parse_amf0_values(m.payload.data(), m.payload.size(), values)) commands_.push_back(std::move(values));
+            }
+            it = inbox_.erase(it);
+        }
+        return true;
+    }
+
+    bool wait_for(DWORD timeout_ms, const std::function<int(const std::vector<Amf0Value>&)>& match,
+                  std::vector<Amf0Value>& out) {
+        const ULONGLONG deadline = GetTickCount64() + timeout_ms;
+        for (;;) {
+            if (!handle_inbox()) return false;
+            for (auto it = commands_.begin(); it != commands_.end(); ++it) {
+                const int verdict = match(*it);
+                if (verdict == 0) continue;
+                out = std::move(*it);
+                commands_.erase(it);
+                return verdict > 0;
+            }
+            const ULONGLONG now = GetTickCount64();
+            if (now >= deadline) return false;
+            if (!pump(static_cast<DWORD>(std::min<ULONGLONG>(deadline - now, 200)))) return false;
+        }
+    }
+
+    bool wait_for_result(double txn, std::vector<Amf0Value>& out) {
+        return wait_for(kReplyTimeoutMs, [txn](const std::vector<Amf0Value>& v) {
+            if (v.size() < 2 || v[1].type != Amf0Value::Type::Number || v[1].number != txn) return 0;
+            if (is_command(v, "_result")) return 1;
+            return is_command(v, "_error") ? -1 : 0;
+        }, out);
+    }
+
+    bool wait_for_publish_start() {
+        std::vector<Amf0Value> out;
+        return wait_for(kReplyTimeoutMs, [](const std::vector<Amf0Value>& v) {
+            if (!is_command(v, "onStatus") || v.size() < 4) return 0;
+            const Amf0Value* code = v[3].find("code");
+            if (!code || code->type != Amf0Value::Type::String) return 0;
+            if (code->string == "NetStream.Publish.Start") return 1;
+            SR_LOG_WARN(L"Live: server status %S", code->string.c_str());
+            return -1;
+        }, out);
+    }
+
+    std::atomic<uintptr_t>& published_;
+    SOCKET          socket_ = INVALID_SOCKET;
+    RtmpChunkReader reader_;
+    std::vector<RtmpMessage> inbox_;
+    std::vector<std::vector<Amf0Value>> commands_;
+    std::vector<uint8_t> wire_, body_;
+    uint32_t out_chunk_ = 128;
+    uint32_t stream_id_ = 0;
+    uint64_t received_  = 0;
+    uint64_t acked_     = 0;
+    uint32_t window_    = 0;
+};
+
+// ---------------------------------------------------------------------------
+
+bool NetworkSink::start(const NetworkSinkConfig& config, const LiveVideoFormat& format) {
+    stop();
+    RtmpUrl url;
+    url_ = to_utf8(config.url);
+    if (!parse_rtmp_url(url_, url)) {
+        SR_LOG_ERROR(L"Live: '%s' is not an rtmp://host/app/key URL", config.url.c_str());
+        return false;
+    }
+    if (format.sps.size() < 4 || format.pps.empty()) {
+        SR_LOG_ERROR(L"Live: no H.264 SPS/PPS from the encoder");
+        return false;
+    }
+    WSADATA wsa{};
+    if (WSAStartup(MAKEWORD(2, 2), &wsa) != 0) {
+        SR_LOG_ERROR(L"Live: WSAStartup failed");
+        return false;
+    }
+    wake_ = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+    config_ = config;
+    format_ = std::make_shared<const LiveVideoFormat>(format);
+    queue_.reset(int64_t{ config.max_latency_ms } * 10'000, size_t{ config.max_queue_mb } << 20);
+    sent_frames_ = 0;
+    sent_bytes_  = 0;
+    reconnects_  = 0;
+    running_.store(true, std::memory_order_release);
+    sender_ = std::thread(&NetworkSink::run, this);
+    SR_LOG_INFO(L"Live: streaming to %S:%u/%S (max latency %u ms)",
+                url.host.c_str(), url.port, url.app.c_str(), config.max_latency_ms);
+    return true;
+}
+
+void NetworkSink::stop() {
+    if (!running_.exchange(false, std::memory_order_acq_rel)) return;
+    queue_.close();
+    if (wake_) SetEvent(wake_);
+    // Abort a send blocked on a stalled connection
+    const uintptr_t s = socket_.load(std::memory_order_acquire);
+    if (s != kNoSocket) shutdown(static_cast<SOCKET>(s), SD_BOTH);
+    if (sender_.joinable()) sender_.join();
+    if (wake_) {
+        CloseHandle(wake_);
+        wake_ = nullptr;
+    }
+    WSACleanup();
+
+    const NetworkSinkStats s_end = stats();
+    SR_LOG_INFO(L"Live: stopped; %llu frames (%llu MB) sent, %llu dropped in %llu GOP drops, %u reconnects",
+                s_end.sent_frames, s_end.sent_bytes >> 20, s_end.dropped_frames, s_end.dropped_gops,
+                s_end.reconnects);
+}
+
+void NetworkSink::set_format(const LiveVideoFormat& format) {
+    format_ = std::make_shared<const LiveVideoFormat>(format);
+}
+
+void NetworkSink::push_video(IMFSample* sample, int64_t pts, bool keyframe) {
+    if (!running_.load(std::memory_order_relaxed) || !sample) return;
+    ComPtr<IMFMediaBuffer> buffer;
+    if (FAILED(sample->ConvertToContiguousBuffer(&buffer))) return;
+    BYTE* data = nullptr;
+    DWORD len = 0;
+    if (FAILED(buffer->Lock(&data, nullptr, &len))) return;
+    Frame frame;
+    annexb_to_avcc(data, len, frame.avcc);
+    buffer->Unlock();
+    if (frame.avcc.empty()) return;
+    frame.format = format_;
+    const size_t bytes = frame.avcc.size();
+    queue_.push(std::move(frame), pts, bytes, keyframe);
+}
+
+NetworkSinkStats NetworkSink::stats() const {
+    const auto q = queue_.stats();
+    NetworkSinkStats s;
+    s.sent_frames    = sent_frames_.load(std::memory_order_relaxed);
+    s.sent_bytes     = sent_bytes_.load(std::memory_order_relaxed);
+    s.dropped_frames = q.dropped_frames;
+    s.dropped_gops   = q.dropped_gops;
+    s.reconnects     = reconnects_.load(std::memory_order_relaxed);
+    s.connected      = connected_.load(std::memory_order_relaxed);
+    return s;
+}
+
+void NetworkSink::run() {
+    RtmpUrl url;
+    parse_rtmp_url(url_, url);
+    uint32_t backoff_ms = kMinBackoffMs;
+
+    while (running_.load(std::memory_order_acquire)) {
+        Connection conn(socket_);
+        if (!conn.open(url)) {
+            conn.close();
+            WaitForSingleObject(wake_, backoff_ms);
+            backoff_ms = std::min(backoff_ms * 2, kMaxBackoffMs);
+            continue;
+        }
+        backoff_ms = kMinBackoffMs;
+        connected_.store(true, std::memory_order_relaxed);
+        SR_LOG_INFO(L"Live: publishing to %S", url.host.c_str());
+        // Whatever queued up while connecting is stale for a live viewer
+        queue_.restart_at_keyframe();
+
+        std::shared_ptr<const LiveVideoFormat> sent_format;
+        int64_t base_pts = INT64_MIN;
+        bool ok = true;
+        while (ok && running_.load(std::memory_order_acquire)) {
+            GopSendQueue<Frame>::Entry e;
+            if (!queue_.pop(e, kPopWait)) {
+                ok = conn.poll();
+                continue;
+            }
+            if (e.keyframe && e.frame.format != sent_format) {
+                ok = conn.send_format(*e.frame.format);
+                sent_format = e.frame.format;
+            }
+            if (!ok || !sent_format) continue;
+            if (base_pts == INT64_MIN) base_pts = e.pts;
+            const uint32_t ts_ms = static_cast<uint32_t>(std::max<int64_t>(0, (e.pts - base_pts) / 10'000));
+            ok = conn.send_video(e.frame.avcc, ts_ms, e.keyframe) && conn.poll();
+            if (ok) {
+                sent_frames_.fetch_add(1, std::memory_order_relaxed);
+                sent_bytes_.fetch_add(e.bytes, std::memory_order_relaxed);
+            }
+        }
+        connected_.store(false, std::memory_order_relaxed);
+        conn.close();
+        if (running_.load(std::memory_order_acquire)) {
+            reconnects_.fetch_add(1, std::memory_order_relaxed);
+            SR_LOG_WARN(L"Live: connection to %S lost; reconnecting", url.host.c_str());
+        }
+    }
+}
+
+} // namespace sr
@@ -0,0 +1,94 @@
+#pragma once
+// network_sink.h — Live RTMP output fed from the same encoder as the file
+//
+// SessionController hands every encoded H.264 frame to push_video() on the
+// mux stage right after MuxWriter gets it. The frame is converted to AVCC
+// and queued (GopSendQueue, whole-GOP drops under congestion); a sender
+// thread owns the socket, connects and publishes, and reconnects with
+// backoff when the server goes away, resuming on the next keyframe.
+// Nothing here can stall the recording: a slow or dead server only costs
+// live frames.
+//
+// Video only: audio reaches the sink writer as PCM and is AAC-encoded
+// inside it, so there are no compressed audio frames to forward.
+
+#include <windows.h>
+#include <mfobjects.h>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include "storage/gop_send_queue.h"
+
+namespace sr {
+
+struct NetworkSinkConfig {
+    std::wstring url;                    // rtmp://host[:port]/app/stream_key
+    uint32_t     max_latency_ms = 2000;  // queued video beyond this is dropped in GOPs
+    uint32_t     max_queue_mb   = 32;
+};
+
+// Stream parameters sent as onMetaData + the AVC sequence header
+struct LiveVideoFormat {
+    uint32_t width       = 0;
+    uint32_t height      = 0;
+    uint32_t fps         = 0;
+    uint32_t bitrate_bps = 0;
+    std::vector<uint8_t> sps, pps;
+};
+
+struct NetworkSinkStats {
+    uint64_t sent_frames    = 0;
+    uint64_t dropped_frames = 0;
+    uint64_t dropped_gops   = 0;
+    uint64_t sent_bytes     = 0;
+    uint32_t reconnects     = 0;
+    bool     connected      = false;
+};
+
+class NetworkSink {
+public:
+    NetworkSink() = default;
+    ~NetworkSink() { stop(); }
+    NetworkSink(const NetworkSink&) = delete;
+    NetworkSink& operator=(const NetworkSink&) = delete;
+
+    // False when the URL or the format's SPS/PPS is unusable; the
+    // connection itself is made (and remade) on the sender thread.
+    bool start(const NetworkSinkConfig& config, const LiveVideoFormat& format);
+    void stop();
+
+    // Mux stage: the encoder was re-created (resolution switch); frames
+    // pushed after this carry the new format
+    void set_format(const LiveVideoFormat& format);
+    void push_video(IMFSample* sample, int64_t pts, bool keyframe);
+
+    NetworkSinkStats stats() const;
+
+private:
+    struct Frame {
+        std::vector<uint8_t> avcc;
+        std::shared_ptr<const LiveVideoFormat> format;
+    };
+    class Connection;
+
+    void run();
+
+    std::string        url_;
+    NetworkSinkConfig  config_;
+    std::shared_ptr<const LiveVideoFormat> format_;   // mux stage only
+    GopSendQueue<Frame> queue_;
+    std::thread        sender_;
+    std::atomic<bool>  running_{ false };
+    HANDLE             wake_ = nullptr;               // cuts a reconnect backoff short on stop()
+
+    std::atomic<uint64_t> sent_frames_{ 0 };
+    std::atomic<uint64_t> sent_bytes_{ 0 };
+    std::atomic<uint32_t> reconnects_{ 0 };
+    std::atomic<bool>     connected_{ false };
+    std::atomic<uintptr_t> socket_{ ~uintptr_t{ 0 } };  // for stop() to abort a blocking send
+};
+
+} // namespace sr
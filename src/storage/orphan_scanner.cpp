@@ -0,0 +1,141 @@
+// orphan_scanner.cpp — Async orphan scan + ReadDirectoryChangesW cache (see orphan_scanner.h)
+
+#include "storage/orphan_scanner.h"
+#include "utils/logging.h"
+#include "utils/qpc_clock.h"
+
+namespace sr {
+
+bool OrphanScanner::start(const std::wstring& directory, ReadyCallback on_ready) {
+    stop();
+    stop_event_ = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+    if (!stop_event_) {
+        SR_LOG_ERROR(L"OrphanScanner: CreateEvent failed: %u", GetLastError());
+        return false;
+    }
+    dir_      = directory;
+    on_ready_ = std::move(on_ready);
+    cancel_.store(false, std::memory_order_relaxed);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        set_   = {};
+        ready_ = false;
+    }
+    worker_ = std::thread([this] { run(); });
+    return true;
+}
+
+void OrphanScanner::stop() {
+    cancel_.store(true, std::memory_order_relaxed);
+    if (stop_event_) SetEvent(stop_event_);
+    if (worker_.joinable()) worker_.join();
+    if (stop_event_) {
+        CloseHandle(stop_event_);
+        stop_event_ = nullptr;
+    }
+}
+
+bool OrphanScanner::ready() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return ready_;
+}
+
+std::vector<std::wstring> OrphanScanner::snapshot() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<std::wstring> paths;
+    paths.reserve(set_.names().size());
+    for (const std::wstring& name : set_.names()) paths.push_back(dir_ + L"\\" + name);
+    return paths;
+}
+
+bool OrphanScanner::contains(const std::wstring& path) const {
+    const size_t slash = path.find_last_of(L"\\/");
+    const std::wstring_view name = slash == std::wstring::npos
+        ? std::wstring_view(path) : std::wstring_view(path).substr(slash + 1);
+    std::lock_guard<std::mutex> lock(mutex_);
+    return set_.contains(name);
+}
+
+void OrphanScanner::run() {
+    const int64_t start_us = QPCClock::instance().now_us();
+    rescan();
+    if (cancel_.load(std::memory_order_relaxed)) return;
+
+    std::vector<std::wstring> orphans = snapshot();
+    SR_LOG_INFO(L"OrphanScanner: %zu orphan(s) in %s (%lld ms)", orphans.size(), dir_.c_str(),
+                static_cast<long long>((QPCClock::instance().now_us() - start_us) / 1000));
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ready_ = true;
+    }
+    if (on_ready_) on_ready_(orphans);
+    watch();
+}
+
+void OrphanScanner::rescan() {
+    std::vector<std::wstring> names = list_partial_files(dir_, &cancel_);
+    std::lock_guard<std::mutex> lock(mutex_);
+    set_.assign(std::move(names));
+}
+
+void OrphanScanner::watch() {
+    HANDLE dir = CreateFileW(dir_.c_str(), FILE_LIST_DIRECTORY,
+                             FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr,
+                             OPEN_EXISTING, FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED, nullptr);
+    if (dir == INVALID_HANDLE_VALUE) {
+        SR_LOG_WARN(L"OrphanScanner: cannot watch %s (%u); the cache will not update",
+                    dir_.c_str(), GetLastError());
+        return;
+    }
+    OVERLAPPED ov{};
+    ov.hEvent = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+    if (!ov.hEvent) {
+        CloseHandle(dir);
+        return;
+    }
+
+    // 64 KB is the most ReadDirectoryChangesW accepts on a network share
+    std::vector<DWORD> buffer(64 * 1024 / sizeof(DWORD));
+    const DWORD buffer_bytes = static_cast<DWORD>(buffer.size() * sizeof(DWORD));
+    const HANDLE waits[2] = { ov.hEvent, stop_event_ };
+    while (!cancel_.load(std::memory_order_relaxed)) {
+        ResetEvent(ov.hEvent);
+        if (!ReadDirectoryChangesW(dir, buffer.data(), buffer_bytes, FALSE, FILE_NOTIFY_CHANGE_FILE_NAME,
+                                   nullptr, &ov, nullptr)) {
+            SR_LOG_WARN(L"OrphanScanner: ReadDirectoryChangesW failed: %u", GetLastError());
+            break;
+        }
+        if (WaitForMultipleObjects(2, waits, FALSE, INFINITE) != WAIT_OBJECT_0) {
+            CancelIoEx(dir, &ov);
+            DWORD ignored = 0;
+            GetOverlappedResult(dir, &ov, &ignored, TRUE);
+            break;
+        }
+        DWORD bytes = 0;
+        if (!GetOverlappedResult(dir, &ov, &bytes, FALSE)) {
+            const DWORD err = GetLastError();
+            if (err != ERROR_NOTIFY_ENUM_DIR) {
+                SR_LOG_WARN(L"OrphanScanner: watch ended: %u", err);
+                break;
+            }
+            bytes = 0;
+        }
+        if (bytes == 0) {
+            // Too many changes for the buffer: the only safe answer is a rescan
+            rescan();
+            continue;
+        }
+        std::lock_guard<std::mutex> lock(mutex_);
+        const auto* base = reinterpret_cast<const BYTE*>(buffer.data());
+        for (size_t offset = 0;;) {
+            const auto* info = reinterpret_cast<const FILE_NOTIFY_INFORMATION*>(base + offset);
+            set_.apply(info->Action, std::wstring_view(info->FileName, info->FileNameLength / sizeof(wchar_t)));
+            if (info->NextEntryOffset == 0) break;
+            offset += info->NextEntryOffset;
+        }
+    }
+    CloseHandle(ov.hEvent);
+    CloseHandle(dir);
+}
+
+} // namespace sr
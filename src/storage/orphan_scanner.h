@@ -0,0 +1,135 @@
+#pragma once
+// orphan_scanner.h — Background scan for *.partial.mp4 left by a crash
+//
+// The scan used to run a std::filesystem::directory_iterator on the UI
+// thread before the window was usable; on a network share full of
+// recordings that took seconds. OrphanScanner lists the output directory
+// on a worker thread (FindFirstFileExW with a large fetch and no per-file
+// stat) and then keeps the result current from ReadDirectoryChangesW: a
+// .partial.mp4 created, deleted or renamed updates the cached set in place.
+// Only a notification overflow costs a full rescan. stop() cancels a
+// running scan or a pending watch without waiting for the share.
+
+#include <windows.h>
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace sr {
+
+inline bool is_partial_mp4_name(std::wstring_view name) {
+    constexpr std::wstring_view kSuffix = L".partial.mp4";
+    return name.size() > kSuffix.size() && name.substr(name.size() - kSuffix.size()) == kSuffix;
+}
+
+// File names (not paths) of *.partial.mp4 directly in `directory`. A set
+// `cancel` ends the listing early with what was found so far.
+inline std::vector<std::wstring> list_partial_files(const std::wstring& directory,
+                                                   const std::atomic<bool>* cancel = nullptr) {
+    std::vector<std::wstring> names;
+    WIN32_FIND_DATAW data{};
+    const std::wstring pattern = directory + L"\\*.partial.mp4";
+    HANDLE find = FindFirstFileExW(pattern.c_str(), FindExInfoBasic, &data, FindExSearchNameMatch,
+                                   nullptr, FIND_FIRST_EX_LARGE_FETCH);
+    if (find == INVALID_HANDLE_VALUE) return names;
+    do {
+        if (cancel && cancel->load(std::memory_order_relaxed)) break;
+        // The pattern also matches 8.3 short names; check the long name
+        if (!(data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) && is_partial_mp4_name(data.cFileName)) {
+            names.emplace_back(data.cFileName);
+        }
+    } while (FindNextFileW(find, &data));
+    FindClose(find);
+    return names;
+}
+
+// True while another handle (this process's MuxWriter, or another machine
+// recording into the same share) has the file open for writing
+inline bool is_partial_in_use(const std::wstring& path) {
+    HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                              OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) return GetLastError() == ERROR_SHARING_VIOLATION;
+    CloseHandle(file);
+    return false;
+}
+
+// Sorted set of orphan file names, updated from FILE_NOTIFY_INFORMATION actions
+class OrphanSet {
+public:
+    void assign(std::vector<std::wstring> names) {
+        names_ = std::move(names);
+        std::sort(names_.begin(), names_.end());
+        names_.erase(std::unique(names_.begin(), names_.end()), names_.end());
+    }
+
+    // FILE_ACTION_*; true when the set changed
+    bool apply(DWORD action, std::wstring_view name) {
+        if (!is_partial_mp4_name(name)) return false;
+        const auto it = std::lower_bound(names_.begin(), names_.end(), name);
+        const bool present = it != names_.end() && *it == name;
+        switch (action) {
+            case FILE_ACTION_ADDED:
+            case FILE_ACTION_RENAMED_NEW_NAME:
+                if (present) return false;
+                names_.emplace(it, name);
+                return true;
+            case FILE_ACTION_REMOVED:
+            case FILE_ACTION_RENAMED_OLD_NAME:
+                if (!present) return false;
+                names_.erase(it);
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    bool contains(std::wstring_view name) const {
+        return std::binary_search(names_.begin(), names_.end(), name);
+    }
+    const std::vector<std::wstring>& names() const { return names_; }
+
+private:
+    std::vector<std::wstring> names_;
+};
+
+class OrphanScanner {
+public:
+    // Full paths; runs on the worker thread once the first scan is complete
+    using ReadyCallback = std::function<void(const std::vector<std::wstring>& orphans)>;
+
+    OrphanScanner() = default;
+    ~OrphanScanner() { stop(); }
+    OrphanScanner(const OrphanScanner&) = delete;
+    OrphanScanner& operator=(const OrphanScanner&) = delete;
+
+    // Stops any previous scan first
+    bool start(const std::wstring& directory, ReadyCallback on_ready);
+    void stop();
+
+    bool ready() const;
+    std::vector<std::wstring> snapshot() const;
+    // `path` is still an orphan as far as the watcher knows
+    bool contains(const std::wstring& path) const;
+
+private:
+    void run();
+    void rescan();
+    void watch();
+
+    std::wstring      dir_;
+    ReadyCallback     on_ready_;
+    std::thread       worker_;
+    std::atomic<bool> cancel_{ false };
+    HANDLE            stop_event_ = nullptr;
+
+    mutable std::mutex mutex_;
+    OrphanSet          set_;
+    bool               ready_ = false;
+};
+
+} // namespace sr
@@ -0,0 +1,108 @@
+#pragma once
+// replay_ring.h — Last N seconds of encoded samples for "instant replay"
+//
+// In replay mode the mux stage appends every encoded video/audio sample here
+// instead of writing to disk. Eviction works in whole GOPs: the ring always
+// starts on a video keyframe, and the oldest GOP is dropped only once the next
+// keyframe is itself at least `window` old — so a saved replay covers at least
+// the requested window (up to one GOP more). A byte cap bounds memory if the
+// GOP is very long or the bitrate spikes.
+//
+// Samples are held by reference (ComPtr in production), so a snapshot for
+// saving is cheap. The mux stage pushes copies of the encoder's pooled
+// output, never the pooled samples themselves. Not thread-safe — owned by the mux stage.
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <utility>
+
+namespace sr {
+
+template <typename Sample>
+class ReplayRing {
+public:
+    struct Entry {
+        Sample   sample;
+        int64_t  pts      = 0;      // 100ns
+        uint32_t bytes    = 0;
+        bool     video    = false;
+        bool     keyframe = false;
+    };
+
+    void reset(int64_t window_100ns, uint64_t max_bytes) {
+        window_    = window_100ns;
+        max_bytes_ = max_bytes;
+        clear();
+    }
+
+    void clear() {
+        entries_.clear();
+        keyframes_.clear();
+        bytes_  = 0;
+        newest_ = 0;
+    }
+
+    void push_video(Sample sample, int64_t pts, uint32_t bytes, bool keyframe) {
+        // Nothing is playable before the first keyframe
+        if (keyframes_.empty() && !keyframe) return;
+        if (keyframe) keyframes_.push_back(pts);
+        append(std::move(sample), pts, bytes, true, keyframe);
+        if (pts > newest_) newest_ = pts;
+        evict();
+    }
+
+    void push_audio(Sample sample, int64_t pts, uint32_t bytes) {
+        if (keyframes_.empty()) return;
+        append(std::move(sample), pts, bytes, false, false);
+    }
+
+    bool     empty()     const { return entries_.empty(); }
+    size_t   size()      const { return entries_.size(); }
+    uint64_t bytes()     const { return bytes_; }
+    int64_t  start_pts() const { return keyframes_.empty() ? 0 : keyframes_.front(); }
+    int64_t  duration()  const { return keyframes_.empty() ? 0 : newest_ - keyframes_.front(); }
+
+    const std::deque<Entry>& entries() const { return entries_; }
+
+private:
+    void append(Sample&& sample, int64_t pts, uint32_t bytes, bool video, bool keyframe) {
+        Entry e;
+        e.sample   = std::move(sample);
+        e.pts      = pts;
+        e.bytes    = bytes;
+        e.video    = video;
+        e.keyframe = keyframe;
+        entries_.push_back(std::move(e));
+        bytes_ += bytes;
+    }
+
+    // Drop the oldest GOP while the one after it still covers the window,
+    // or while over the byte cap (always keeping the newest GOP).
+    void evict() {
+        while (keyframes_.size() >= 2) {
+            const bool covered  = newest_ - keyframes_[1] >= window_;
+            const bool over_cap = max_bytes_ > 0 && bytes_ > max_bytes_;
+            if (!covered && !over_cap) break;
+            drop_oldest_gop();
+        }
+    }
+
+    void drop_oldest_gop() {
+        keyframes_.pop_front();
+        // Pop until the front is the next keyframe
+        do {
+            bytes_ -= entries_.front().bytes;
+            entries_.pop_front();
+        } while (!entries_.empty() && !(entries_.front().video && entries_.front().keyframe));
+    }
+
+    std::deque<Entry>   entries_;     // mux order (video and audio interleaved)
+    std::deque<int64_t> keyframes_;   // PTS of every keyframe in entries_
+    int64_t  window_    = 0;
+    uint64_t max_bytes_ = 0;
+    uint64_t bytes_     = 0;
+    int64_t  newest_    = 0;
+};
+
+} // namespace sr
@@ -0,0 +1,451 @@
+#pragma once
+// rtmp_protocol.h — RTMP wire format for the live-stream sink (network_sink.h)
+//
+// Just enough of RTMP to publish H.264 to nginx-rtmp, MediaMTX, YouTube or
+// Twitch: AMF0 encode/decode for the command messages, the chunk stream in
+// both directions, the FLV video payloads (AVC sequence header + NAL
+// units) and rtmp:// URL parsing. The MF encoders emit Annex-B, which RTMP
+// carries as 4-byte length-prefixed (AVCC) NAL units.
+//
+// Pure byte-level code so it can be unit-tested without a server.
+
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <map>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace sr {
+
+// ---------------------------------------------------------------------------
+// rtmp://host[:port]/app[/...]/stream_key
+struct RtmpUrl {
+    std::string host;
+    uint16_t    port = 1935;
+    std::string app;          // everything between host and the last '/'
+    std::string stream_key;
+    std::string tc_url;       // rtmp://host[:port]/app, sent with connect
+};
+
+inline bool parse_rtmp_url(std::string_view url, RtmpUrl& out) {
+    out = {};
+    constexpr std::string_view kScheme = "rtmp://";
+    if (url.substr(0, kScheme.size()) != kScheme) return false;
+    std::string_view rest = url.substr(kScheme.size());
+    const size_t slash = rest.find('/');
+    if (slash == std::string_view::npos || slash == 0) return false;
+    std::string_view authority = rest.substr(0, slash);
+    std::string_view path = rest.substr(slash + 1);
+
+    const size_t colon = authority.rfind(':');
+    if (colon != std::string_view::npos) {
+        uint32_t port = 0;
+        const std::string_view digits = authority.substr(colon + 1);
+        if (digits.empty() || digits.size() > 5) return false;
+        for (char c : digits) {
+            if (c < '0' || c > '9') return false;
+            port = port * 10 + static_cast<uint32_t>(c - '0');
+        }
+        if (port == 0 || port > 65535) return false;
+        out.port = static_cast<uint16_t>(port);
+        authority = authority.substr(0, colon);
+    }
+    const size_t key_slash = path.rfind('/');
+    if (authority.empty() || key_slash == std::string_view::npos || key_slash == 0 ||
+        key_slash + 1 == path.size()) {
+        return false;
+    }
+    out.host       = std::string(authority);
+    out.app        = std::string(path.substr(0, key_slash));
+    out.stream_key = std::string(path.substr(key_slash + 1));
+    out.tc_url     = std::string(url.substr(0, kScheme.size() + slash + 1 + key_slash));
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// AMF0
+
+class Amf0Writer {
+public:
+    explicit Amf0Writer(std::vector<uint8_t>& out) : out_(out) {}
+
+    void number(double v) {
+        out_.push_back(0x00);
+        uint64_t bits = 0;
+        std::memcpy(&bits, &v, sizeof(bits));
+        for (int i = 7; i >= 0; --i) out_.push_back(static_cast<uint8_t>(bits >> (8 * i)));
+    }
+    void boolean(bool v) {
+        out_.push_back(0x01);
+        out_.push_back(v ? 1 : 0);
+    }
+    void string(std::string_view v) {
+        out_.push_back(0x02);
+        raw_string(v);
+    }
+    void null() { out_.push_back(0x05); }
+    void begin_object() { out_.push_back(0x03); }
+    void begin_ecma_array(uint32_t count) {
+        out_.push_back(0x08);
+        for (int i = 3; i >= 0; --i) out_.push_back(static_cast<uint8_t>(count >> (8 * i)));
+    }
+    void key(std::string_view k) { raw_string(k); }
+    void end_object() {
+        out_.push_back(0x00);
+        out_.push_back(0x00);
+        out_.push_back(0x09);
+    }
+
+private:
+    void raw_string(std::string_view v) {
+        const size_t n = v.size() > 0xFFFF ? 0xFFFF : v.size();
+        out_.push_back(static_cast<uint8_t>(n >> 8));
+        out_.push_back(static_cast<uint8_t>(n));
+        out_.insert(out_.end(), v.begin(), v.begin() + static_cast<std::ptrdiff_t>(n));
+    }
+
+    std::vector<uint8_t>& out_;
+};
+
+struct Amf0Value {
+    enum class Type : uint8_t { Number, Boolean, String, Object, Null, Undefined } type = Type::Undefined;
+    double      number  = 0;
+    bool        boolean = false;
+    std::string string;
+    std::vector<std::pair<std::string, Amf0Value>> properties;   // Object / ECMA array
+
+    const Amf0Value* find(std::string_view name) const {
+        for (const auto& p : properties) {
+            if (p.first == name) return &p.second;
+        }
+        return nullptr;
+    }
+};
+
+namespace rtmp_detail {
+
+inline bool read_u16(const uint8_t* d, size_t n, size_t& pos, uint16_t& v) {
+    if (n - pos < 2) return false;
+    v = static_cast<uint16_t>((d[pos] << 8) | d[pos + 1]);
+    pos += 2;
+    return true;
+}
+
+inline bool read_amf0(const uint8_t* d, size_t n, size_t& pos, Amf0Value& v, int depth);
+
+inline bool read_properties(const uint8_t* d, size_t n, size_t& pos, Amf0Value& v, int depth) {
+    for (;;) {
+        uint16_t len = 0;
+        if (!read_u16(d, n, pos, len)) return false;
+        if (len == 0) {
+            if (pos >= n || d[pos] != 0x09) return false;
+            ++pos;
+            return true;
+        }
+        if (n - pos < len) return false;
+        std::string name(reinterpret_cast<const char*>(d + pos), len);
+        pos += len;
+        Amf0Value value;
+        if (!read_amf0(d, n, pos, value, depth + 1)) return false;
+        v.properties.emplace_back(std::move(name), std::move(value));
+    }
+}
+
+inline bool read_amf0(const uint8_t* d, size_t n, size_t& pos, Amf0Value& v, int depth) {
+    if (pos >= n || depth > 8) return false;
+    const uint8_t marker = d[pos++];
+    switch (marker) {
+        case 0x00: {
+            if (n - pos < 8) return false;
+            uint64_t bits = 0;
+            for (int i = 0; i < 8; ++i) bits = (bits << 8) | d[pos + i];
+            pos += 8;
+            std::memcpy(&v.number, &bits, sizeof(bits));
+            v.type = Amf0Value::Type::Number;
+            return true;
+        }
+        case 0x01:
+            if (pos >= n) return false;
+            v.type = Amf0Value::Type::Boolean;
+            v.boolean = d[pos++] != 0;
+            return true;
+        case 0x02: {
+            uint16_t len = 0;
+            if (!read_u16(d, n, pos, len) || n - pos < len) return false;
+            v.type = Amf0Value::Type::String;
+            v.string.assign(reinterpret_cast<const char*>(d + pos), len);
+            pos += len;
+            return true;
+        }
+        case 0x03:
+            v.type = Amf0Value::Type::Object;
+            return read_properties(d, n, pos, v, depth);
+        case 0x08:
+            if (n - pos < 4) return false;
+            pos += 4;   // the count is advisory; the end marker terminates
+            v.type = Amf0Value::Type::Object;
+            return read_properties(d, n, pos, v, depth);
+        case 0x05: v.type = Amf0Value::Type::Null; return true;
+        case 0x06: v.type = Amf0Value::Type::Undefined; return true;
+        default:   return false;   // types a server has no reason to send us
+    }
+}
+
+} // namespace rtmp_detail
+
+// All values of a command / data message, in order
+inline bool parse_amf0_values(const uint8_t* data, size_t size, std::vector<Amf0Value>& out) {
+    out.clear();
+    size_t pos = 0;
+    while (pos < size) {
+        Amf0Value v;
+        if (!rtmp_detail::read_amf0(data, size, pos, v, 0)) return false;
+        out.push_back(std::move(v));
+    }
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// Chunk stream
+
+namespace rtmp {
+constexpr uint8_t kSetChunkSize    = 1;
+constexpr uint8_t kAcknowledgement = 3;
+constexpr uint8_t kUserControl     = 4;
+constexpr uint8_t kWindowAckSize   = 5;
+constexpr uint8_t kSetPeerBandwidth = 6;
+constexpr uint8_t kVideo           = 9;
+constexpr uint8_t kDataAmf0        = 18;
+constexpr uint8_t kCommandAmf0     = 20;
+
+constexpr uint32_t kCsidControl = 2;
+constexpr uint32_t kCsidCommand = 3;
+constexpr uint32_t kCsidVideo   = 6;
+constexpr uint32_t kCsidData    = 5;
+
+constexpr uint32_t kHandshakeSize   = 1536;
+constexpr uint32_t kOutChunkSize    = 4096;
+constexpr uint32_t kExtendedTimestamp = 0xFFFFFF;
+} // namespace rtmp
+
+struct RtmpMessage {
+    uint8_t  type      = 0;
+    uint32_t stream_id = 0;
+    uint32_t timestamp = 0;
+    std::vector<uint8_t> payload;
+};
+
+// One message as chunks of `chunk_size`: a type-0 header on the first chunk,
+// type-3 headers on the continuations. `csid` in 2..63.
+inline void append_rtmp_message(std::vector<uint8_t>& out, uint32_t csid, uint32_t timestamp,
+                                uint8_t type, uint32_t stream_id, const uint8_t* payload,
+                                size_t size, uint32_t chunk_size) {
+    const bool extended = timestamp >= rtmp::kExtendedTimestamp;
+    const uint32_t ts_field = extended ? rtmp::kExtendedTimestamp : timestamp;
+    auto be24 = [&](uint32_t v) {
+        out.push_back(static_cast<uint8_t>(v >> 16));
+        out.push_back(static_cast<uint8_t>(v >> 8));
+        out.push_back(static_cast<uint8_t>(v));
+    };
+    auto ext = [&] {
+        if (!extended) return;
+        for (int i = 3; i >= 0; --i) out.push_back(static_cast<uint8_t>(timestamp >> (8 * i)));
+    };
+
+    out.push_back(static_cast<uint8_t>(csid & 0x3F));   // fmt 0
+    be24(ts_field);
+    be24(static_cast<uint32_t>(size));
+    out.push_back(type);
+    for (int i = 0; i < 4; ++i) out.push_back(static_cast<uint8_t>(stream_id >> (8 * i)));   // little-endian
+    ext();
+
+    size_t pos = 0;
+    for (;;) {
+        const size_t n = size - pos < chunk_size ? size - pos : chunk_size;
+        out.insert(out.end(), payload + pos, payload + pos + n);
+        pos += n;
+        if (pos >= size) break;
+        out.push_back(static_cast<uint8_t>(0xC0 | (csid & 0x3F)));   // fmt 3
+        ext();
+    }
+}
+
+// Reassembles incoming chunks into messages. Set Chunk Size from the peer
+// is applied here; everything else goes to the callback.
+class RtmpChunkReader {
+public:
+    using MessageCallback = std::function<void(const RtmpMessage&)>;
+    explicit RtmpChunkReader(MessageCallback on_message) : on_message_(std::move(on_message)) {}
+
+    // False on a protocol error (the connection should be dropped)
+    bool feed(const uint8_t* data, size_t size) {
+        pending_.insert(pending_.end(), data, data + size);
+        size_t pos = 0;
+        for (;;) {
+            const size_t used = parse_chunk(pending_.data() + pos, pending_.size() - pos);
+            if (used == kError) return false;
+            if (used == 0) break;
+            pos += used;
+        }
+        pending_.erase(pending_.begin(), pending_.begin() + static_cast<std::ptrdiff_t>(pos));
+        return true;
+    }
+
+    uint32_t chunk_size() const { return chunk_size_; }
+
+private:
+    static constexpr size_t kError = static_cast<size_t>(-1);
+    static constexpr uint32_t kMaxMessage = 16u << 20;
+
+    struct Stream {
+        uint32_t timestamp = 0, delta = 0, length = 0, stream_id = 0;
+        uint8_t  type = 0;
+        bool     extended = false;
+        std::vector<uint8_t> partial;
+    };
+
+    // Bytes consumed by one complete chunk; 0 = need more data
+    size_t parse_chunk(const uint8_t* d, size_t n) {
+        if (n < 1) return 0;
+        size_t pos = 1;
+        const uint8_t fmt = d[0] >> 6;
+        uint32_t csid = d[0] & 0x3F;
+        if (csid == 0) {
+            if (n < 2) return 0;
+            csid = 64u + d[1];
+            pos = 2;
+        } else if (csid == 1) {
+            if (n < 3) return 0;
+            csid = 64u + d[1] + (uint32_t{ d[2] } << 8);
+            pos = 3;
+        }
+        static constexpr size_t kHeader[4] = { 11, 7, 3, 0 };
+        if (n - pos < kHeader[fmt]) return 0;
+        Stream& s = streams_[csid];
+        const bool new_message = s.partial.empty();
+
+        uint32_t ts_field = 0;
+        if (fmt <= 2) {
+            ts_field = (uint32_t{ d[pos] } << 16) | (uint32_t{ d[pos + 1] } << 8) | d[pos + 2];
+        }
+        if (fmt <= 1) {
+            s.length = (uint32_t{ d[pos + 3] } << 16) | (uint32_t{ d[pos + 4] } << 8) | d[pos + 5];
+            s.type   = d[pos + 6];
+            if (s.length > kMaxMessage) return kError;
+        }
+        if (fmt == 0) {
+            s.stream_id = uint32_t{ d[pos + 7] } | (uint32_t{ d[pos + 8] } << 8) |
+                          (uint32_t{ d[pos + 9] } << 16) | (uint32_t{ d[pos + 10] } << 24);
+        }
+        pos += kHeader[fmt];
+        if (fmt <= 2) s.extended = ts_field == rtmp::kExtendedTimestamp;
+        uint32_t ext = 0;
+        if (s.extended) {
+            if (n - pos < 4) return 0;
+            ext = (uint32_t{ d[pos] } << 24) | (uint32_t{ d[pos + 1] } << 16) |
+                  (uint32_t{ d[pos + 2] } << 8) | d[pos + 3];
+            pos += 4;
+        }
+        const uint32_t ts_value = s.extended ? ext : ts_field;
+
+        const size_t remaining = s.length - s.partial.size();
+        const size_t take = remaining < chunk_size_ ? remaining : chunk_size_;
+        if (n - pos < take) return 0;
+
+        // Header state is committed only once the whole chunk is here
+        if (new_message) {
+            if (fmt == 0) {
+                s.timestamp = ts_value;
+                s.delta = 0;
+            } else if (fmt <= 2) {
+                s.delta = ts_value;
+                s.timestamp += ts_value;
+            } else {
+                s.timestamp += s.delta;
+            }
+        }
+        s.partial.insert(s.partial.end(), d + pos, d + pos + take);
+        pos += take;
+
+        if (s.partial.size() == s.length) {
+            RtmpMessage msg;
+            msg.type = s.type;
+            msg.stream_id = s.stream_id;
+            msg.timestamp = s.timestamp;
+            msg.payload.swap(s.partial);
+            if (msg.type == rtmp::kSetChunkSize && msg.payload.size() >= 4) {
+                const uint32_t size = ((uint32_t{ msg.payload[0] } << 24) | (uint32_t{ msg.payload[1] } << 16) |
+                                       (uint32_t{ msg.payload[2] } << 8) | msg.payload[3]) & 0x7FFFFFFF;
+                if (size == 0) return kError;
+                chunk_size_ = size;
+            } else if (on_message_) {
+                on_message_(msg);
+            }
+        }
+        return pos;
+    }
+
+    MessageCallback on_message_;
+    std::map<uint32_t, Stream> streams_;
+    std::vector<uint8_t> pending_;
+    uint32_t chunk_size_ = 128;
+};
+
+// ---------------------------------------------------------------------------
+// FLV video payloads (RTMP message type 9)
+
+// Annex-B access unit -> AVCC NAL units. AUDs are dropped (RTMP delimits
+// frames itself); in-band SPS/PPS are kept for decoders joining late.
+inline void annexb_to_avcc(const uint8_t* data, size_t size, std::vector<uint8_t>& out) {
+    out.clear();
+    auto start_code = [&](size_t at) -> size_t {
+        if (at + 3 <= size && data[at] == 0 && data[at + 1] == 0 && data[at + 2] == 1) return 3;
+        if (at + 4 <= size && data[at] == 0 && data[at + 1] == 0 && data[at + 2] == 0 && data[at + 3] == 1) return 4;
+        return 0;
+    };
+    size_t i = 0;
+    while (i < size && start_code(i) == 0) ++i;
+    while (i < size) {
+        const size_t begin = i + start_code(i);
+        size_t end = begin;
+        while (end < size && start_code(end) == 0) ++end;
+        // Trailing zeros belong to the next start code (zero_byte)
+        size_t nal_end = end;
+        while (nal_end > begin && end < size && data[nal_end - 1] == 0) --nal_end;
+        if (nal_end > begin && (data[begin] & 0x1F) != 9) {
+            const uint32_t len = static_cast<uint32_t>(nal_end - begin);
+            for (int b = 3; b >= 0; --b) out.push_back(static_cast<uint8_t>(len >> (8 * b)));
+            out.insert(out.end(), data + begin, data + nal_end);
+        }
+        i = end;
+    }
+}
+
+// AVC sequence header tag body: AVCDecoderConfigurationRecord
+inline std::vector<uint8_t> flv_avc_sequence_header(const std::vector<uint8_t>& sps,
+                                                    const std::vector<uint8_t>& pps) {
+    std::vector<uint8_t> out;
+    if (sps.size() < 4 || pps.empty()) return out;
+    out = { 0x17, 0x00, 0x00, 0x00, 0x00,            // keyframe + AVC, sequence header, CT 0
+            0x01, sps[1], sps[2], sps[3], 0xFF,       // version, profile, compat, level, 4-byte lengths
+            0xE1 };                                   // one SPS
+    out.push_back(static_cast<uint8_t>(sps.size() >> 8));
+    out.push_back(static_cast<uint8_t>(sps.size()));
+    out.insert(out.end(), sps.begin(), sps.end());
+    out.push_back(0x01);                              // one PPS
+    out.push_back(static_cast<uint8_t>(pps.size() >> 8));
+    out.push_back(static_cast<uint8_t>(pps.size()));
+    out.insert(out.end(), pps.begin(), pps.end());
+    return out;
+}
+
+// Tag body header for AVCC NAL units; the NAL units follow it
+inline void flv_avc_nalu_header(std::vector<uint8_t>& out, bool keyframe) {
+    const uint8_t header[5] = { static_cast<uint8_t>(keyframe ? 0x17 : 0x27), 0x01, 0x00, 0x00, 0x00 };
+    out.insert(out.end(), header, header + 5);
+}
+
+} // namespace sr
@@ -0,0 +1,74 @@
+#pragma once
+// segment_policy.h — When to rotate a long recording into a new file
+//
+// Segmented recording splits one session into files of at most N minutes or
+// N MB without stopping capture or re-initialising the encoder:
+//   1. the mux stage calls check() after each video write; the first call past
+//      a limit returns true and the caller requests an IDR
+//   2. the next keyframe opens the new segment (opens_segment()); the caller
+//      finalizes the old file, starts a new MuxWriter and calls start_segment()
+//      with that keyframe's PTS as the new time base
+// So every segment starts on an IDR and plays on its own.
+//
+// Not thread-safe — owned by the mux stage.
+
+#include <cstdint>
+
+namespace sr {
+
+struct SegmentLimits {
+    uint32_t max_minutes = 0;   // 0 = no duration limit
+    uint32_t max_mb      = 0;   // 0 = no size limit
+
+    bool enabled() const { return max_minutes > 0 || max_mb > 0; }
+};
+
+class SegmentPolicy {
+public:
+    void reset(const SegmentLimits& limits) {
+        limits_  = limits;
+        base_    = 0;
+        pending_ = false;
+        index_   = 1;
+    }
+
+    // Stop rotating (e.g. the next file could not be created); keeps the index
+    void disable() {
+        limits_  = {};
+        pending_ = false;
+    }
+
+    bool enabled() const { return limits_.enabled(); }
+
+    // pts: latest written video PTS; bytes: bytes written to the current file
+    bool check(int64_t pts, uint64_t bytes) {
+        if (!enabled() || pending_) return false;
+        const bool time_up = limits_.max_minutes > 0 &&
+            pts - base_ >= static_cast<int64_t>(limits_.max_minutes) * 60 * 10'000'000;
+        const bool size_up = limits_.max_mb > 0 &&
+            bytes >= static_cast<uint64_t>(limits_.max_mb) * 1024 * 1024;
+        pending_ = time_up || size_up;
+        return pending_;
+    }
+
+    // True when `keyframe` should become the first sample of a new segment
+    bool opens_segment(bool keyframe) const { return pending_ && keyframe; }
+
+    void start_segment(int64_t base_pts) {
+        base_    = base_pts;
+        pending_ = false;
+        ++index_;
+    }
+
+    bool     pending()       const { return pending_; }
+    int64_t  base_pts()      const { return base_; }
+    uint32_t segment_index() const { return index_; }   // 1-based index of the current file
+
+private:
+    SegmentLimits limits_;
+    int64_t  base_    = 0;
+    bool     pending_ = false;
+    uint32_t index_   = 1;
+};
+
+} // namespace sr
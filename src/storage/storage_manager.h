@@ -11,22 +11,19 @@
 #include <thread>
 #include <atomic>
 #include <chrono>
+#include <mutex>
+#include <unordered_set>
 #include "utils/logging.h"
+#include "storage/orphan_scanner.h"
 
 namespace sr {
 
-using DiskSpaceLowCallback = std::function<void()>;
-
 class StorageManager {
 public:
     StorageManager() {
         resolveDefaultDirectory();
     }
 
-    ~StorageManager() {
-        stopDiskSpacePolling();
-    }
-
     // Resolve default output directory: %USERPROFILE%\Videos\Recordings
     bool resolveDefaultDirectory() {
         wchar_t* videos_path = nullptr;
@@ -68,8 +65,15 @@ public:
         return true;
     }
 
-    // Generate unique filename: ScreenRec_YYYY-MM-DD_HH-mm-ss[_NNN].partial.mp4
-    std::wstring generateFilename() const {
+    // Fixed file name (without .mp4) instead of the timestamp, e.g. for
+    // scripted recordings; empty = timestamped names again
+    void setFileStem(const std::wstring& stem) { file_stem_ = stem; }
+
+    // Generate unique filename: ScreenRec_YYYY-MM-DD_HH-mm-ss[_tag][_NNN].partial.mp4
+    // (or <stem>[_tag][_NNN].partial.mp4 after setFileStem). A name handed out
+    // is never returned again, even before its file exists (replays are
+    // written on another thread, several may be saved within one second).
+    std::wstring generateFilename(const wchar_t* tag = nullptr) const {
         std::time_t now = std::time(nullptr);
         std::tm tm_buf{};
         localtime_s(&tm_buf, &now);
@@ -77,14 +81,17 @@ public:
         wchar_t ts[64];
         wcsftime(ts, _countof(ts), L"ScreenRec_%Y-%m-%d_%H-%M-%S", &tm_buf);
 
-        std::wstring base = output_dir_ + L"\\" + ts;
+        std::wstring base = output_dir_ + L"\\" + (file_stem_.empty() ? std::wstring(ts) : file_stem_);
+        if (tag && *tag) base += std::wstring(L"_") + tag;
 
         // Check for conflicts and add suffix if needed
         std::wstring partial = base + L".partial.mp4";
         std::wstring final_name = base + L".mp4";
 
+        std::lock_guard<std::mutex> lock(issued_mutex_);
         int suffix = 0;
-        while (std::filesystem::exists(partial) || std::filesystem::exists(final_name)) {
+        while (std::filesystem::exists(partial) || std::filesystem::exists(final_name) ||
+               issued_.count(partial) != 0) {
             suffix++;
             wchar_t suffix_str[16];
             _snwprintf_s(suffix_str, _countof(suffix_str), _TRUNCATE, L"_%03d", suffix);
@@ -92,9 +99,49 @@ public:
             final_name = base + suffix_str + L".mp4";
         }
 
+        issued_.insert(partial);
         return partial;
     }
 
+    // Segmented recording: partial path of segment `index` (2, 3, ...) next to the
+    // first segment, e.g. ScreenRec_2026-02-28_10-00-00_part002.partial.mp4
+    static std::wstring segmentFilename(const std::wstring& first_partial, uint32_t index) {
+        std::wstring base = first_partial;
+        size_t pos = base.rfind(L".partial.mp4");
+        if (pos != std::wstring::npos && pos + 12 == base.size()) base.resize(pos);
+        wchar_t part[16];
+        _snwprintf_s(part, _countof(part), _TRUNCATE, L"_part%03u", index);
+        return base + part + L".partial.mp4";
+    }
+
+    // Dual-output recording: partial path of the low-res proxy next to the main
+    // file, e.g. ScreenRec_2026-02-28_10-00-00_proxy.partial.mp4
+    static std::wstring proxyFilename(const std::wstring& main_partial) {
+        std::wstring base = main_partial;
+        size_t pos = base.rfind(L".partial.mp4");
+        if (pos != std::wstring::npos && pos + 12 == base.size()) base.resize(pos);
+        return base + L"_proxy.partial.mp4";
+    }
+
+    // Multi-monitor recording: partial path of the file for the display at
+    // `index` (1-based, the main file being display 1),
+    // e.g. ScreenRec_2026-02-28_10-00-00_display2.partial.mp4
+    static std::wstring displayFilename(const std::wstring& main_partial, uint32_t index) {
+        std::wstring base = main_partial;
+        size_t pos = base.rfind(L".partial.mp4");
+        if (pos != std::wstring::npos && pos + 12 == base.size()) base.resize(pos);
+        return base + L"_display" + std::to_wstring(index) + L".partial.mp4";
+    }
+
+    // Background transcode: partial path of the `tag` rendition of a finished
+    // recording, e.g. ScreenRec_2026-02-28_10-00-00_720p.partial.mp4
+    static std::wstring transcodeFilename(const std::wstring& final_path, const std::wstring& tag) {
+        std::wstring base = final_path;
+        size_t pos = base.rfind(L".mp4");
+        if (pos != std::wstring::npos && pos + 4 == base.size()) base.resize(pos);
+        return base + L"_" + tag + L".partial.mp4";
+    }
+
     // Get final path from partial path (remove ".partial" from name)
     static std::wstring partialToFinal(const std::wstring& partial_path) {
         std::wstring result = partial_path;
@@ -119,73 +166,22 @@ public:
         return getFreeDiskSpace() < threshold_bytes;
     }
 
-    // Scan for orphaned .partial.mp4 files
+    // Scan for orphaned .partial.mp4 files (blocking; the UI uses OrphanScanner)
     std::vector<std::wstring> findOrphanedFiles() const {
         std::vector<std::wstring> orphans;
-        std::error_code ec;
-        for (const auto& entry : std::filesystem::directory_iterator(output_dir_, ec)) {
-            if (entry.is_regular_file()) {
-                auto name = entry.path().filename().wstring();
-                if (name.size() > 12 && name.substr(name.size() - 12) == L".partial.mp4") {
-                    orphans.push_back(entry.path().wstring());
-                }
-            }
+        for (const std::wstring& name : list_partial_files(output_dir_)) {
+            orphans.push_back(output_dir_ + L"\\" + name);
         }
         return orphans;
     }
 
     const std::wstring& outputDirectory() const { return output_dir_; }
 
-    // -----------------------------------------------------------------------
-    // T028 — Async disk space polling
-    // Fires callback on main thread (or poll thread) when free space < threshold.
-    // interval_ms: polling interval (default 10000 ms — disk space changes slowly)
-    // threshold_bytes: low-disk threshold (default 500 MB; configurable for tests)
-    // -----------------------------------------------------------------------
-    void startDiskSpacePolling(DiskSpaceLowCallback callback,
-                               std::chrono::milliseconds interval = std::chrono::milliseconds(10000),
-                               uint64_t threshold_bytes = 500ULL * 1024 * 1024)
-    {
-        stopDiskSpacePolling(); // stop any existing poll thread
-        low_disk_cb_  = std::move(callback);
-        poll_running_.store(true, std::memory_order_release);
-        poll_thread_  = std::thread([this, interval, threshold_bytes]() {
-            while (poll_running_.load(std::memory_order_acquire)) {
-                if (isDiskSpaceLow(threshold_bytes) && low_disk_cb_) {
-                    SR_LOG_WARN(L"Disk space low! Free: %llu MB",
-                                getFreeDiskSpace() / (1024 * 1024));
-                    low_disk_cb_();
-                }
-                // Sleep in 500ms increments so stop is responsive
-                auto deadline = std::chrono::steady_clock::now() + interval;
-                while (poll_running_.load(std::memory_order_acquire) &&
-                       std::chrono::steady_clock::now() < deadline) {
-                    std::this_thread::sleep_for(std::chrono::milliseconds(500));
-                }
-            }
-        });
-    }
-
-    void stopDiskSpacePolling() {
-        poll_running_.store(false, std::memory_order_release);
-        if (poll_thread_.joinable()) {
-            if (poll_thread_.get_id() == std::this_thread::get_id()) {
-                // Called re-entrantly from the poll thread (e.g. low-disk callback -> stop())
-                // Detach to avoid deadlock — the thread will exit naturally
-                poll_thread_.detach();
-            } else {
-                poll_thread_.join();
-            }
-        }
-    }
-
 private:
     std::wstring output_dir_;
-
-    // T028 — polling state
-    std::thread              poll_thread_;
-    std::atomic<bool>        poll_running_{ false };
-    DiskSpaceLowCallback     low_disk_cb_;
+    std::wstring file_stem_;
+    mutable std::mutex   issued_mutex_;
+    mutable std::unordered_set<std::wstring> issued_;   // every generateFilename result
 };
 
 } // namespace sr
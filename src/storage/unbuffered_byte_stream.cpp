@@ -0,0 +1,478 @@
+// unbuffered_byte_stream.cpp — Write-behind IMFByteStream (see header)
+
+#include "storage/unbuffered_byte_stream.h"
+#include "utils/logging.h"
+
+#include <wrl/client.h>
+#include <algorithm>
+#include <cstring>
+
+#pragma comment(lib, "mfplat.lib")
+
+namespace sr {
+
+using Microsoft::WRL::ComPtr;
+
+namespace {
+
+// Byte count carried from Begin{Read,Write} to End{Read,Write}
+// {5B0C6E8A-3D1F-4C52-9B7E-2A61F0D4C8E3}
+const GUID kAsyncBytesKey =
+    { 0x5b0c6e8a, 0x3d1f, 0x4c52, { 0x9b, 0x7e, 0x2a, 0x61, 0xf0, 0xd4, 0xc8, 0xe3 } };
+
+uint8_t* alloc_aligned(size_t size) {
+    // VirtualAlloc returns page-aligned, zeroed memory — satisfies NO_BUFFERING
+    return static_cast<uint8_t*>(VirtualAlloc(nullptr, size, MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE));
+}
+
+void free_aligned(uint8_t* p) {
+    if (p) VirtualFree(p, 0, MEM_RELEASE);
+}
+
+void set_offset(OVERLAPPED& ov, uint64_t offset) {
+    ov.Offset     = static_cast<DWORD>(offset);
+    ov.OffsetHigh = static_cast<DWORD>(offset >> 32);
+}
+
+HRESULT complete_async(HRESULT status, ULONG bytes, IMFAsyncCallback* callback, IUnknown* state) {
+    ComPtr<IMFAttributes> carrier;
+    HRESULT hr = MFCreateAttributes(&carrier, 1);
+    if (FAILED(hr)) return hr;
+    carrier->SetUINT32(kAsyncBytesKey, bytes);
+
+    ComPtr<IMFAsyncResult> result;
+    hr = MFCreateAsyncResult(carrier.Get(), callback, state, &result);
+    if (FAILED(hr)) return hr;
+    result->SetStatus(status);
+    return MFInvokeCallback(result.Get());
+}
+
+HRESULT finish_async(IMFAsyncResult* result, ULONG* bytes) {
+    if (!result || !bytes) return E_POINTER;
+    *bytes = 0;
+    ComPtr<IUnknown> object;
+    ComPtr<IMFAttributes> carrier;
+    if (SUCCEEDED(result->GetObject(&object)) && SUCCEEDED(object.As(&carrier))) {
+        UINT32 n = 0;
+        carrier->GetUINT32(kAsyncBytesKey, &n);
+        *bytes = n;
+    }
+    return result->GetStatus();
+}
+
+} // namespace
+
+UnbufferedByteStream* UnbufferedByteStream::create(const std::wstring& path, uint32_t chunk_bytes) {
+    HANDLE file = CreateFileW(
+        path.c_str(),
+        GENERIC_READ | GENERIC_WRITE,
+        FILE_SHARE_READ,   // T029: readers only — this handle is also the write lock
+        nullptr,
+        CREATE_ALWAYS,
+        FILE_ATTRIBUTE_NORMAL | FILE_FLAG_NO_BUFFERING | FILE_FLAG_OVERLAPPED,
+        nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        SR_LOG_WARN(L"Unbuffered open of '%s' failed: %u", path.c_str(), GetLastError());
+        return nullptr;
+    }
+
+    auto* stream = new UnbufferedByteStream();
+    stream->file_ = file;
+
+    FILE_STORAGE_INFO storage{};
+    if (GetFileInformationByHandleEx(file, FileStorageInfo, &storage, sizeof(storage))) {
+        const ULONG sector = storage.PhysicalBytesPerSectorForPerformance;
+        if (sector > stream->align_ && sector <= 65536 && (sector & (sector - 1)) == 0) {
+            stream->align_ = sector;
+        }
+    }
+    stream->chunk_cap_ = static_cast<size_t>(
+        stream->align_up((std::clamp)(chunk_bytes, kMinChunkBytes, kMaxChunkBytes)));
+
+    for (auto& c : stream->chunks_) {
+        c.data       = alloc_aligned(stream->chunk_cap_);
+        c.ov.hEvent  = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+        if (!c.data || !c.ov.hEvent) {
+            SR_LOG_ERROR(L"Unbuffered byte stream: buffer allocation failed");
+            stream->Release();
+            return nullptr;
+        }
+    }
+
+    SR_LOG_INFO(L"Unbuffered writer: %zu MB chunks, %u-byte alignment -> %s",
+                stream->chunk_cap_ >> 20, stream->align_, path.c_str());
+    return stream;
+}
+
+UnbufferedByteStream::~UnbufferedByteStream() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        close_locked();
+    }
+    for (auto& c : chunks_) {
+        free_aligned(c.data);
+        if (c.ov.hEvent) CloseHandle(c.ov.hEvent);
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Chunk pipeline
+// ---------------------------------------------------------------------------
+HRESULT UnbufferedByteStream::wait_chunk(Chunk& c) {
+    if (!c.pending) return S_OK;
+    if (!HasOverlappedIoCompleted(&c.ov)) {
+        write_stalls_.fetch_add(1, std::memory_order_relaxed);
+    }
+    DWORD done = 0;
+    const BOOL ok = GetOverlappedResult(file_, &c.ov, &done, TRUE);
+    c.pending = false;
+    return ok ? S_OK : HRESULT_FROM_WIN32(GetLastError());
+}
+
+HRESULT UnbufferedByteStream::wait_all() {
+    const HRESULT a = wait_chunk(chunks_[0]);
+    const HRESULT b = wait_chunk(chunks_[1]);
+    return FAILED(a) ? a : b;
+}
+
+HRESULT UnbufferedByteStream::submit_current() {
+    Chunk& c = chunks_[cur_];
+    // Padding past chunk_fill_ is zero: every chunk is cleared when claimed
+    const size_t size = static_cast<size_t>(align_up(chunk_fill_));
+    set_offset(c.ov, chunk_base_);
+    ResetEvent(c.ov.hEvent);
+    if (!WriteFile(file_, c.data, static_cast<DWORD>(size), nullptr, &c.ov)) {
+        const DWORD err = GetLastError();
+        if (err != ERROR_IO_PENDING) {
+            SR_LOG_ERROR(L"Unbuffered WriteFile at %llu failed: %u", chunk_base_, err);
+            return HRESULT_FROM_WIN32(err);
+        }
+    }
+    c.pending = true;
+    bytes_submitted_.fetch_add(size, std::memory_order_relaxed);
+
+    // Claim the other chunk; waits only if its previous write is still in flight
+    cur_ ^= 1;
+    Chunk& next = chunks_[cur_];
+    const HRESULT hr = wait_chunk(next);
+    std::memset(next.data, 0, chunk_cap_);
+    chunk_base_ += chunk_cap_;
+    chunk_fill_  = 0;
+    return hr;
+}
+
+HRESULT UnbufferedByteStream::advance_to(uint64_t offset) {
+    if (chunk_fill_ > 0) {
+        const HRESULT hr = submit_current();
+        if (FAILED(hr)) return hr;
+    } else {
+        chunk_base_ += chunk_cap_;
+    }
+    // Forward seek past the next chunk: the gap is never-written (reads as zero)
+    if (offset >= chunk_base_ + chunk_cap_) chunk_base_ = align_down(offset);
+    return S_OK;
+}
+
+HRESULT UnbufferedByteStream::write_sync(const uint8_t* aligned, uint64_t offset, size_t size) {
+    OVERLAPPED ov{};
+    set_offset(ov, offset);
+    ov.hEvent = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+    if (!ov.hEvent) return HRESULT_FROM_WIN32(GetLastError());
+    DWORD done = 0;
+    BOOL ok = WriteFile(file_, aligned, static_cast<DWORD>(size), nullptr, &ov);
+    if (ok || GetLastError() == ERROR_IO_PENDING) {
+        ok = GetOverlappedResult(file_, &ov, &done, TRUE);
+    }
+    const HRESULT hr = ok ? S_OK : HRESULT_FROM_WIN32(GetLastError());
+    CloseHandle(ov.hEvent);
+    return hr;
+}
+
+HRESULT UnbufferedByteStream::read_sync(uint8_t* aligned, uint64_t offset, size_t size, size_t* got) {
+    *got = 0;
+    OVERLAPPED ov{};
+    set_offset(ov, offset);
+    ov.hEvent = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+    if (!ov.hEvent) return HRESULT_FROM_WIN32(GetLastError());
+    DWORD done = 0;
+    BOOL ok = ReadFile(file_, aligned, static_cast<DWORD>(size), nullptr, &ov);
+    if (ok || GetLastError() == ERROR_IO_PENDING) {
+        ok = GetOverlappedResult(file_, &ov, &done, TRUE);
+    }
+    HRESULT hr = S_OK;
+    if (!ok) {
+        const DWORD err = GetLastError();
+        if (err != ERROR_HANDLE_EOF) hr = HRESULT_FROM_WIN32(err);
+    }
+    CloseHandle(ov.hEvent);
+    *got = done;
+    return hr;
+}
+
+// Back-patch of an already submitted range: aligned read-modify-write
+HRESULT UnbufferedByteStream::patch_disk(uint64_t offset, const uint8_t* src, size_t size) {
+    disk_patches_.fetch_add(1, std::memory_order_relaxed);
+    HRESULT hr = wait_all();
+    if (FAILED(hr)) return hr;
+
+    const uint64_t first = align_down(offset);
+    const size_t   span  = static_cast<size_t>(align_up(offset + size) - first);
+    uint8_t* scratch = alloc_aligned(span);
+    if (!scratch) return E_OUTOFMEMORY;
+
+    size_t got = 0;
+    hr = read_sync(scratch, first, span, &got);
+    if (SUCCEEDED(hr)) {
+        std::memcpy(scratch + (offset - first), src, size);
+        hr = write_sync(scratch, first, span);
+    }
+    free_aligned(scratch);
+    if (FAILED(hr)) SR_LOG_ERROR(L"Unbuffered patch at %llu failed: 0x%08X", offset, hr);
+    return hr;
+}
+
+HRESULT UnbufferedByteStream::read_disk(uint64_t offset, uint8_t* dst, size_t size) {
+    HRESULT hr = wait_all();
+    if (FAILED(hr)) return hr;
+
+    const uint64_t first = align_down(offset);
+    const size_t   span  = static_cast<size_t>(align_up(offset + size) - first);
+    uint8_t* scratch = alloc_aligned(span);
+    if (!scratch) return E_OUTOFMEMORY;
+
+    size_t got = 0;
+    hr = read_sync(scratch, first, span, &got);
+    if (SUCCEEDED(hr)) std::memcpy(dst, scratch + (offset - first), size);  // short read -> zeros
+    free_aligned(scratch);
+    return hr;
+}
+
+HRESULT UnbufferedByteStream::write_locked(const uint8_t* src, ULONG cb) {
+    while (cb > 0) {
+        ULONG n = 0;
+        HRESULT hr = S_OK;
+        if (position_ < chunk_base_) {
+            n  = static_cast<ULONG>((std::min)(static_cast<uint64_t>(cb), chunk_base_ - position_));
+            hr = patch_disk(position_, src, n);
+        } else if (position_ < chunk_base_ + chunk_cap_) {
+            const size_t off = static_cast<size_t>(position_ - chunk_base_);
+            n = static_cast<ULONG>((std::min)(static_cast<size_t>(cb), chunk_cap_ - off));
+            std::memcpy(chunks_[cur_].data + off, src, n);
+            chunk_fill_ = (std::max)(chunk_fill_, off + n);
+        } else {
+            hr = advance_to(position_);
+            if (FAILED(hr)) return hr;
+            continue;
+        }
+        if (FAILED(hr)) return hr;
+
+        position_ += n;
+        src       += n;
+        cb        -= n;
+        length_    = (std::max)(length_, position_);
+
+        if (chunk_fill_ == chunk_cap_) {
+            hr = submit_current();
+            if (FAILED(hr)) return hr;
+        }
+    }
+    return S_OK;
+}
+
+HRESULT UnbufferedByteStream::read_locked(uint8_t* dst, ULONG cb, ULONG* read) {
+    ULONG total = 0;
+    const uint64_t end = (std::min)(length_, position_ + cb);
+    while (position_ < end) {
+        size_t n = static_cast<size_t>(end - position_);
+        if (position_ >= chunk_base_) {
+            const uint64_t off = position_ - chunk_base_;
+            if (off < chunk_cap_) {
+                n = (std::min)(n, static_cast<size_t>(chunk_cap_ - off));
+                std::memcpy(dst, chunks_[cur_].data + off, n);
+            } else {
+                std::memset(dst, 0, n);   // SetLength() beyond anything written
+            }
+        } else {
+            n = (std::min)(n, static_cast<size_t>(chunk_base_ - position_));
+            const HRESULT hr = read_disk(position_, dst, n);
+            if (FAILED(hr)) {
+                if (read) *read = total;
+                return hr;
+            }
+        }
+        position_ += n;
+        dst       += n;
+        total     += static_cast<ULONG>(n);
+    }
+    if (read) *read = total;
+    return S_OK;
+}
+
+HRESULT UnbufferedByteStream::close_locked() {
+    if (closed_) return S_OK;
+    closed_ = true;
+    if (file_ == INVALID_HANDLE_VALUE) return S_OK;
+
+    HRESULT hr = wait_all();
+    if (chunk_fill_ > 0) {
+        const size_t size = static_cast<size_t>(align_up(chunk_fill_));
+        const HRESULT tail = write_sync(chunks_[cur_].data, chunk_base_, size);
+        if (SUCCEEDED(tail)) bytes_submitted_.fetch_add(size, std::memory_order_relaxed);
+        if (SUCCEEDED(hr)) hr = tail;
+    }
+
+    // Drop the sector padding past the logical end, and any preallocation
+    FILE_END_OF_FILE_INFO eof{};
+    eof.EndOfFile.QuadPart = static_cast<LONGLONG>(length_);
+    if (!SetFileInformationByHandle(file_, FileEndOfFileInfo, &eof, sizeof(eof)) && SUCCEEDED(hr)) {
+        hr = HRESULT_FROM_WIN32(GetLastError());
+    }
+    FILE_ALLOCATION_INFO alloc{};
+    alloc.AllocationSize = eof.EndOfFile;
+    SetFileInformationByHandle(file_, FileAllocationInfo, &alloc, sizeof(alloc));
+    CloseHandle(file_);
+    file_ = INVALID_HANDLE_VALUE;
+    if (FAILED(hr)) SR_LOG_ERROR(L"Unbuffered byte stream close failed: 0x%08X", hr);
+    return hr;
+}
+
+// ---------------------------------------------------------------------------
+// IMFByteStream
+// ---------------------------------------------------------------------------
+HRESULT STDMETHODCALLTYPE UnbufferedByteStream::GetCapabilities(DWORD* caps) {
+    if (!caps) return E_POINTER;
+    *caps = MFBYTESTREAM_IS_READABLE | MFBYTESTREAM_IS_WRITABLE | MFBYTESTREAM_IS_SEEKABLE;
+    return S_OK;
+}
+
+HRESULT STDMETHODCALLTYPE UnbufferedByteStream::GetLength(QWORD* length) {
+    if (!length) return E_POINTER;
+    std::lock_guard<std::mutex> lock(mutex_);
+    *length = length_;
+    return S_OK;
+}
+
+HRESULT STDMETHODCALLTYPE UnbufferedByteStream::SetLength(QWORD length) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (closed_) return MF_E_INVALIDREQUEST;
+    length_ = length;   // applied to the file in Close()
+    return S_OK;
+}
+
+HRESULT STDMETHODCALLTYPE UnbufferedByteStream::GetCurrentPosition(QWORD* position) {
+    if (!position) return E_POINTER;
+    std::lock_guard<std::mutex> lock(mutex_);
+    *position = position_;
+    return S_OK;
+}
+
+HRESULT STDMETHODCALLTYPE UnbufferedByteStream::SetCurrentPosition(QWORD position) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    position_ = position;
+    return S_OK;
+}
+
+HRESULT STDMETHODCALLTYPE UnbufferedByteStream::IsEndOfStream(BOOL* end) {
+    if (!end) return E_POINTER;
+    std::lock_guard<std::mutex> lock(mutex_);
+    *end = position_ >= length_;
+    return S_OK;
+}
+
+HRESULT STDMETHODCALLTYPE UnbufferedByteStream::Read(BYTE* buffer, ULONG cb, ULONG* read) {
+    if (!buffer) return E_POINTER;
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (closed_) return MF_E_INVALIDREQUEST;
+    return read_locked(buffer, cb, read);
+}
+
+HRESULT STDMETHODCALLTYPE UnbufferedByteStream::BeginRead(BYTE* buffer, ULONG cb,
+                                                          IMFAsyncCallback* callback,
+                                                          IUnknown* state) {
+    if (!buffer || !callback) return E_POINTER;
+    ULONG read = 0;
+    const HRESULT status = Read(buffer, cb, &read);
+    return complete_async(status, read, callback, state);
+}
+
+HRESULT STDMETHODCALLTYPE UnbufferedByteStream::EndRead(IMFAsyncResult* result, ULONG* read) {
+    return finish_async(result, read);
+}
+
+HRESULT STDMETHODCALLTYPE UnbufferedByteStream::Write(const BYTE* buffer, ULONG cb, ULONG* written) {
+    if (!buffer) return E_POINTER;
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (closed_) return MF_E_INVALIDREQUEST;
+    const uint64_t start = position_;
+    const HRESULT hr = write_locked(buffer, cb);
+    if (written) *written = static_cast<ULONG>(position_ - start);
+    return hr;
+}
+
+HRESULT STDMETHODCALLTYPE UnbufferedByteStream::BeginWrite(const BYTE* buffer, ULONG cb,
+                                                           IMFAsyncCallback* callback,
+                                                           IUnknown* state) {
+    if (!buffer || !callback) return E_POINTER;
+    // Completes inline (a memcpy unless a chunk boundary is crossed) and
+    // signals the callback through the MF work queue as the contract requires.
+    ULONG written = 0;
+    const HRESULT status = Write(buffer, cb, &written);
+    return complete_async(status, written, callback, state);
+}
+
+HRESULT STDMETHODCALLTYPE UnbufferedByteStream::EndWrite(IMFAsyncResult* result, ULONG* written) {
+    return finish_async(result, written);
+}
+
+HRESULT STDMETHODCALLTYPE UnbufferedByteStream::Seek(MFBYTESTREAM_SEEK_ORIGIN origin, LONGLONG offset,
+                                                     DWORD /*flags*/, QWORD* position) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    LONGLONG target = offset;
+    if (origin == msoCurrent) target += static_cast<LONGLONG>(position_);
+    if (target < 0) return E_INVALIDARG;
+    position_ = static_cast<uint64_t>(target);
+    if (position) *position = position_;
+    return S_OK;
+}
+
+HRESULT STDMETHODCALLTYPE UnbufferedByteStream::Flush() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (closed_) return MF_E_INVALIDREQUEST;
+    HRESULT hr = wait_all();
+    if (SUCCEEDED(hr) && chunk_fill_ > 0) {
+        // Persist the partial chunk but keep filling it; it is rewritten whole later
+        hr = write_sync(chunks_[cur_].data, chunk_base_, static_cast<size_t>(align_up(chunk_fill_)));
+    }
+    return hr;
+}
+
+HRESULT STDMETHODCALLTYPE UnbufferedByteStream::Close() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return close_locked();
+}
+
+// ---------------------------------------------------------------------------
+// IUnknown
+// ---------------------------------------------------------------------------
+ULONG STDMETHODCALLTYPE UnbufferedByteStream::AddRef() {
+    return ref_.fetch_add(1, std::memory_order_relaxed) + 1;
+}
+
+ULONG STDMETHODCALLTYPE UnbufferedByteStream::Release() {
+    const ULONG refs = ref_.fetch_sub(1, std::memory_order_acq_rel) - 1;
+    if (refs == 0) delete this;
+    return refs;
+}
+
+HRESULT STDMETHODCALLTYPE UnbufferedByteStream::QueryInterface(REFIID riid, void** ppv) {
+    if (!ppv) return E_POINTER;
+    if (riid == __uuidof(IUnknown) || riid == __uuidof(IMFByteStream)) {
+        *ppv = static_cast<IMFByteStream*>(this);
+        AddRef();
+        return S_OK;
+    }
+    *ppv = nullptr;
+    return E_NOINTERFACE;
+}
+
+} // namespace sr
@@ -0,0 +1,118 @@
+#pragma once
+// unbuffered_byte_stream.h — Write-behind IMFByteStream for MuxWriter
+//
+// The stock URL byte stream issues many small synchronous cached writes; on
+// network shares and slow HDDs these stall the sink writer (and through its
+// WriteSample backpressure, the mux and encode stages). This stream instead:
+//   - opens the file FILE_FLAG_NO_BUFFERING | FILE_FLAG_OVERLAPPED
+//   - appends into a large sector-aligned chunk (4-8 MB, VirtualAlloc'd)
+//   - submits each full chunk as one overlapped WriteFile and keeps filling
+//     the second chunk while it is in flight (double buffering)
+// A writer only waits when the disk is a whole chunk behind.
+//
+// The MP4 sink also seeks back to patch box sizes: writes that land in the
+// current chunk are applied in memory, older ranges are patched on disk with
+// an aligned read-modify-write (rare — a few per file). Close() writes the
+// padded tail and trims the file to its logical length.
+//
+// The file is opened FILE_SHARE_READ, so the handle doubles as the T029
+// exclusive write lock. Thread-safe: MF may call from its work queue threads.
+
+#include <windows.h>
+#include <mfapi.h>
+#include <mfidl.h>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+
+namespace sr {
+
+class UnbufferedByteStream : public IMFByteStream {
+public:
+    static constexpr uint32_t kMinChunkBytes = 4u << 20;
+    static constexpr uint32_t kMaxChunkBytes = 8u << 20;
+
+    // Creates (truncates) `path`; refcount 1. Returns nullptr if the file
+    // cannot be opened unbuffered (caller falls back to the URL byte stream).
+    static UnbufferedByteStream* create(const std::wstring& path, uint32_t chunk_bytes);
+
+    uint64_t bytes_submitted() const { return bytes_submitted_.load(std::memory_order_relaxed); }
+    uint32_t write_stalls()    const { return write_stalls_.load(std::memory_order_relaxed); }
+    uint32_t disk_patches()    const { return disk_patches_.load(std::memory_order_relaxed); }
+    uint32_t chunk_bytes()     const { return static_cast<uint32_t>(chunk_cap_); }
+
+    // Underlying file (e.g. for FileAllocationInfo); valid until Close()
+    HANDLE   native_handle()   const { return file_; }
+
+    // IUnknown
+    ULONG   STDMETHODCALLTYPE AddRef() override;
+    ULONG   STDMETHODCALLTYPE Release() override;
+    HRESULT STDMETHODCALLTYPE QueryInterface(REFIID riid, void** ppv) override;
+
+    // IMFByteStream
+    HRESULT STDMETHODCALLTYPE GetCapabilities(DWORD* caps) override;
+    HRESULT STDMETHODCALLTYPE GetLength(QWORD* length) override;
+    HRESULT STDMETHODCALLTYPE SetLength(QWORD length) override;
+    HRESULT STDMETHODCALLTYPE GetCurrentPosition(QWORD* position) override;
+    HRESULT STDMETHODCALLTYPE SetCurrentPosition(QWORD position) override;
+    HRESULT STDMETHODCALLTYPE IsEndOfStream(BOOL* end) override;
+    HRESULT STDMETHODCALLTYPE Read(BYTE* buffer, ULONG cb, ULONG* read) override;
+    HRESULT STDMETHODCALLTYPE BeginRead(BYTE* buffer, ULONG cb, IMFAsyncCallback* callback,
+                                        IUnknown* state) override;
+    HRESULT STDMETHODCALLTYPE EndRead(IMFAsyncResult* result, ULONG* read) override;
+    HRESULT STDMETHODCALLTYPE Write(const BYTE* buffer, ULONG cb, ULONG* written) override;
+    HRESULT STDMETHODCALLTYPE BeginWrite(const BYTE* buffer, ULONG cb, IMFAsyncCallback* callback,
+                                         IUnknown* state) override;
+    HRESULT STDMETHODCALLTYPE EndWrite(IMFAsyncResult* result, ULONG* written) override;
+    HRESULT STDMETHODCALLTYPE Seek(MFBYTESTREAM_SEEK_ORIGIN origin, LONGLONG offset, DWORD flags,
+                                   QWORD* position) override;
+    HRESULT STDMETHODCALLTYPE Flush() override;
+    HRESULT STDMETHODCALLTYPE Close() override;
+
+private:
+    struct Chunk {
+        uint8_t*   data    = nullptr;
+        OVERLAPPED ov{};
+        bool       pending = false;
+    };
+
+    UnbufferedByteStream() = default;
+    ~UnbufferedByteStream();
+
+    // All helpers run under mutex_
+    HRESULT write_locked(const uint8_t* src, ULONG cb);
+    HRESULT read_locked(uint8_t* dst, ULONG cb, ULONG* read);
+    HRESULT submit_current();                 // async write of the current chunk, then swap
+    HRESULT advance_to(uint64_t offset);      // make `offset` fall inside the current chunk
+    HRESULT wait_chunk(Chunk& c);
+    HRESULT wait_all();
+    HRESULT write_sync(const uint8_t* aligned, uint64_t offset, size_t size);
+    HRESULT read_sync(uint8_t* aligned, uint64_t offset, size_t size, size_t* got);
+    HRESULT patch_disk(uint64_t offset, const uint8_t* src, size_t size);
+    HRESULT read_disk(uint64_t offset, uint8_t* dst, size_t size);
+    HRESULT close_locked();
+
+    uint64_t align_down(uint64_t v) const { return v & ~(static_cast<uint64_t>(align_) - 1); }
+    uint64_t align_up(uint64_t v)   const { return align_down(v + align_ - 1); }
+
+    std::atomic<ULONG> ref_{ 1 };
+    std::mutex         mutex_;
+
+    HANDLE   file_      = INVALID_HANDLE_VALUE;
+    uint32_t align_     = 4096;   // sector size used for offsets / lengths
+    size_t   chunk_cap_ = kMinChunkBytes;
+    Chunk    chunks_[2];
+    int      cur_        = 0;
+    uint64_t chunk_base_ = 0;     // file offset of chunks_[cur_].data[0]
+    size_t   chunk_fill_ = 0;     // bytes of the current chunk holding data
+    uint64_t position_   = 0;
+    uint64_t length_     = 0;     // logical file length
+    bool     closed_     = false;
+
+    std::atomic<uint64_t> bytes_submitted_{ 0 };
+    std::atomic<uint32_t> write_stalls_{ 0 };
+    std::atomic<uint32_t> disk_patches_{ 0 };
+};
+
+} // namespace sr
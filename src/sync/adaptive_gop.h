@@ -0,0 +1,99 @@
+#pragma once
+// adaptive_gop.h — Content-driven IDR cadence for screen recordings
+//
+// A fixed 2 s GOP spends most of a static desktop recording's bits on IDRs
+// that repeat an unchanged picture. AdaptiveGop decides per encoded frame,
+// from the capture's dedup and dirty-rect signals, when to ask for an IDR:
+//
+//   - moving content (a frame changed >= kMotionFraction of the picture, or
+//     its change is unknown, within the last base interval): every base
+//     interval, as before
+//   - static content: only every max interval, the seekability bound
+//   - scene cut: a frame that changes >= kSceneCutFraction right after a
+//     quiet frame (app / tab switch, slide change) is keyed at once, at most
+//     every half base interval. Continuous large changes (scrolling, video)
+//     are motion, not cuts.
+//
+//   gop.reset(2 * 10'000'000, 10 * 10'000'000);
+//   if (gop.due(pts, change)) encoder->request_keyframe();
+//   ...
+//   gop.on_keyframe(pts);   // every IDR the encoder emits, requested or not
+//
+// IDRs the schedule did not ask for (segment rotation, resume, the encoder's
+// own GOP bound) restart the interval through on_keyframe(). Times are in
+// 100 ns; base 0 disables the schedule.
+
+#include <cstdint>
+
+namespace sr {
+
+// `change` argument of AdaptiveGop::due() for frames without dirty-rect info
+constexpr double kGopChangeUnknown = -1.0;
+
+class AdaptiveGop {
+public:
+    static constexpr double kMotionFraction   = 0.02;
+    static constexpr double kQuietFraction    = 0.10;
+    static constexpr double kSceneCutFraction = 0.50;
+
+    void reset(int64_t base_100ns, int64_t max_100ns) {
+        base_        = base_100ns > 0 ? base_100ns : 0;
+        max_         = max_100ns > base_ ? max_100ns : base_;
+        last_key_    = -1;
+        last_motion_ = -1;
+        prev_change_ = 0.0;
+        keyframes_   = 0;
+        scene_cuts_  = 0;
+    }
+
+    bool enabled() const { return base_ > 0; }
+
+    // Before encoding the frame at `pts`. `change` is the fraction of the
+    // picture that differs from the previous frame (0 for a duplicate), or
+    // kGopChangeUnknown. True: request an IDR for this frame.
+    bool due(int64_t pts, double change) {
+        if (!enabled()) return false;
+        const bool unknown      = change < 0.0;
+        const bool quiet_before = prev_change_ >= 0.0 && prev_change_ < kQuietFraction;
+        prev_change_ = change;
+        if (unknown || change >= kMotionFraction) last_motion_ = pts;
+
+        if (last_key_ < 0) return key(pts);
+        const int64_t since = pts - last_key_;
+        if (!unknown && change >= kSceneCutFraction && quiet_before && since >= base_ / 2) {
+            ++scene_cuts_;
+            return key(pts);
+        }
+        return since >= (moving(pts) ? base_ : max_) ? key(pts) : false;
+    }
+
+    // Any IDR the encoder produced at `pts`
+    void on_keyframe(int64_t pts) {
+        if (pts > last_key_) last_key_ = pts;
+    }
+
+    // Content changed within the last base interval
+    bool moving(int64_t pts) const { return last_motion_ >= 0 && pts - last_motion_ < base_; }
+
+    int64_t  base_100ns() const { return base_; }
+    int64_t  max_100ns()  const { return max_; }
+    uint32_t keyframes()  const { return keyframes_; }   // IDRs requested
+    uint32_t scene_cuts() const { return scene_cuts_; }  // ... of which on a scene cut
+
+private:
+    bool key(int64_t pts) {
+        last_key_ = pts;
+        ++keyframes_;
+        return true;
+    }
+
+    int64_t  base_        = 0;
+    int64_t  max_         = 0;
+    int64_t  last_key_    = -1;
+    int64_t  last_motion_ = -1;
+    double   prev_change_ = 0.0;
+    uint32_t keyframes_   = 0;
+    uint32_t scene_cuts_  = 0;
+};
+
+} // namespace sr
@@ -5,20 +5,27 @@
 //   • Detects gaps > 1.5× target interval → caller should insert a duplicate frame
 //   • Clamps large jumps to prevent PTS drift accumulation
 //   • On backpressure (queue full) → returns Drop so the caller discards the frame
-//   • Tracks duplicate count and drop count as telemetry
+//   • Unchanged frames (RenderFrame::is_duplicate) → Skip, except one refresh
+//     per kStaticRefresh100ns so a static screen still produces samples
+//   • Tracks duplicate, skip and drop counts as telemetry
 //
-// Usage (in encode_loop):
+// Variable-frame-rate mode (set_variable_rate): no duplicates, no smoothing —
+// frames keep their capture PTS (forced strictly increasing) and unchanged
+// frames are always skipped, so the encoder only sees content changes. The
+// muxer then derives real per-sample durations (MuxConfig::variable_frame_rate).
+//
+// Usage (in video_encode_loop):
 //   pacer_.initialize(fps);
 //   ...
 //   int64_t out_pts;
-//   PaceAction action = pacer_.pace_frame(frame.pts, queue_full, &out_pts);
-//   if (action == PaceAction::Drop)      { skip; }
+//   PaceAction action = pacer_.pace_frame(frame.pts, queue_full, &out_pts, frame.is_duplicate);
+//   if (action == PaceAction::Drop || action == PaceAction::Skip) { skip; }
 //   if (action == PaceAction::Duplicate) { encode last frame again with out_pts; }
 //   encode frame using out_pts;
 
 #include <cstdint>
 #include <algorithm>
-#include "utils/logging.h"
+#include "utils/core_logging.h"
 
 namespace sr {
 
@@ -26,10 +33,14 @@ enum class PaceAction {
     Accept,     // Frame is fine — use *out_pts as the corrected PTS
     Duplicate,  // Gap > 1.5× target — insert a duplicate of the PREVIOUS frame first
     Drop,       // Queue backpressure — caller should discard this frame entirely
+    Skip,       // Content unchanged since the last encoded frame — nothing to encode
 };
 
 class FramePacer {
 public:
+    // Longest run of unchanged frames that is skipped before one is encoded
+    static constexpr int64_t kStaticRefresh100ns = 10'000'000;  // 1 s
+
     FramePacer() = default;
 
     // Call once before recording starts (or on resume after reset()).
@@ -40,23 +51,32 @@ public:
             : 333'333LL;
         last_pts_     = -1;
         smoothed_pts_ = -1;
+        last_encoded_pts_ = -1;
         dups_         = 0;
         drops_        = 0;
+        skips_        = 0;
         SR_LOG_INFO(L"[FramePacer] Initialized: target interval %lld 100ns (~%u fps)",
                     target_interval_100ns_, fps);
     }
 
+    // VFR on/off; survives initialize() (power-profile fps changes)
+    void set_variable_rate(bool enabled) { variable_rate_ = enabled; }
+    bool variable_rate() const { return variable_rate_; }
+
     // Call after pause to prevent a gap being mistaken for a frame skip.
     void reset() {
         last_pts_     = -1;
         smoothed_pts_ = -1;
+        last_encoded_pts_ = -1;
     }
 
     // Classify the incoming raw_pts and compute a corrected PTS.
     //   queue_full — true when the frame queue is at capacity (backpressure)
     //   *out_pts  — receives the PTS to stamp on the encoded frame
+    //   unchanged — frame content is identical to the previous frame
     // Returns PaceAction indicating how the caller should handle this frame.
-    PaceAction pace_frame(int64_t raw_pts, bool queue_full, int64_t* out_pts) {
+    PaceAction pace_frame(int64_t raw_pts, bool queue_full, int64_t* out_pts,
+                          bool unchanged = false) {
         // Backpressure: drop this frame entirely
         if (queue_full) {
             ++drops_;
@@ -68,13 +88,28 @@ public:
         if (last_pts_ < 0) {
             smoothed_pts_ = raw_pts;
             last_pts_     = raw_pts;
+            last_encoded_pts_ = raw_pts;
             *out_pts      = raw_pts;
             return PaceAction::Accept;
         }
 
+        if (variable_rate_) {
+            const int64_t pts = raw_pts > last_encoded_pts_ ? raw_pts : last_encoded_pts_ + 1;
+            last_pts_     = raw_pts;
+            smoothed_pts_ = pts;
+            *out_pts      = pts;
+            if (unchanged) {
+                ++skips_;
+                return PaceAction::Skip;
+            }
+            last_encoded_pts_ = pts;
+            return PaceAction::Accept;
+        }
+
         int64_t gap             = raw_pts - last_pts_;
         int64_t threshold_150pct = target_interval_100ns_ * 3 / 2;
-        bool    need_dup         = (gap > threshold_150pct);
+        // An unchanged frame already repeats the previous picture; no synthetic copy needed
+        bool    need_dup         = (gap > threshold_150pct) && !unchanged;
 
         if (need_dup) {
             ++dups_;
@@ -91,18 +126,30 @@ public:
         last_pts_           = raw_pts;
         *out_pts            = smoothed_pts_;
 
+        // Timing state above still advances for skipped frames, so the next
+        // real change isn't mistaken for a gap.
+        if (unchanged && smoothed_pts_ - last_encoded_pts_ < kStaticRefresh100ns) {
+            ++skips_;
+            return PaceAction::Skip;
+        }
+        last_encoded_pts_ = smoothed_pts_;
+
         return need_dup ? PaceAction::Duplicate : PaceAction::Accept;
     }
 
     uint32_t duplicates_inserted() const { return dups_; }
     uint32_t drops()               const { return drops_; }
+    uint32_t skips()               const { return skips_; }
 
 private:
     int64_t  target_interval_100ns_ = 333'333;
     int64_t  last_pts_              = -1;
     int64_t  smoothed_pts_          = -1;
+    int64_t  last_encoded_pts_      = -1;
     uint32_t dups_                  = 0;
     uint32_t drops_                 = 0;
+    uint32_t skips_                 = 0;
+    bool     variable_rate_         = false;
 };
 
 } // namespace sr
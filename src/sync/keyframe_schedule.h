@@ -0,0 +1,51 @@
+#pragma once
+// keyframe_schedule.h — Time-based IDR cadence for fragment / segment boundaries
+//
+// The encoder's own GOP counts frames, which drifts in wall time once static
+// frames are skipped (FramePacer Skip). When the output container needs an IDR
+// at a fixed time interval (fMP4 fragments), the encode stage asks this
+// schedule before each frame and calls VideoEncoder::request_keyframe() when
+// a boundary has been crossed:
+//
+//   schedule.reset(2'000 * 10'000);           // every 2 s (100ns units)
+//   if (schedule.due(pts)) encoder->request_keyframe();
+//
+// The first frame is always due (streams start on an IDR). Boundaries advance
+// from the frame that was actually keyed, so a long gap yields one IDR rather
+// than a burst. interval 0 disables the schedule.
+
+#include <cstdint>
+
+namespace sr {
+
+class KeyframeSchedule {
+public:
+    void reset(int64_t interval_100ns) {
+        interval_ = interval_100ns > 0 ? interval_100ns : 0;
+        next_     = 0;
+        started_  = false;
+        count_    = 0;
+    }
+
+    bool enabled() const { return interval_ > 0; }
+
+    bool due(int64_t pts) {
+        if (interval_ == 0) return false;
+        if (started_ && pts < next_) return false;
+        started_ = true;
+        next_    = pts + interval_;
+        ++count_;
+        return true;
+    }
+
+    int64_t  interval_100ns() const { return interval_; }
+    uint32_t count()          const { return count_; }   // boundaries signalled
+
+private:
+    int64_t  interval_ = 0;
+    int64_t  next_     = 0;
+    bool     started_  = false;
+    uint32_t count_    = 0;
+};
+
+} // namespace sr
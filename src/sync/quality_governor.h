@@ -0,0 +1,162 @@
+#pragma once
+// quality_governor.h — Closed-loop bitrate / fps reduction under encode overload
+//
+// FramePacer and PowerModeDetector only react at session start or on power
+// flips, so a thermally throttled laptop silently drops frames. The governor
+// watches the video-encode stage once per window (1 s):
+//   - mean encode time per frame against the frame interval
+//   - mean FrameQueue depth (capacity 3) seen by the encode stage
+//   - drop rate (capture ring/queue drops + pacer backpressure drops)
+// Two overloaded windows in a row step one level down; ten healthy windows
+// step one level back up. After each change it holds for a few windows so
+// the encoder settles before being judged again.
+//
+//   Level 0: nominal bitrate, nominal fps
+//   Level 1: 75% bitrate      Level 2: 55% bitrate      Level 3: 40% bitrate
+//   Level 4: 40% bitrate and half fps (not below kMinFps) via frame decimation
+//
+// Usage (video-encode stage only — not thread-safe):
+//   gov.reset(bitrate_bps, fps);
+//   if (!gov.admit(pts)) continue;           // level-4 decimation
+//   gov.on_frame(encode_us, queue_depth);    // after each encode_frame()
+//   gov.on_drop(n);                          // frames lost upstream
+//   if (gov.evaluate(now_us)) encoder.set_bitrate(gov.bitrate_bps());
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+
+namespace sr {
+
+class QualityGovernor {
+public:
+    static constexpr uint32_t kMaxLevel         = 4;
+    static constexpr int64_t  kWindowUs         = 1'000'000;
+    static constexpr uint32_t kOverloadWindows  = 2;    // consecutive, to step down
+    static constexpr uint32_t kHealthyWindows   = 10;   // consecutive, to step up
+    static constexpr uint32_t kHoldWindows      = 3;    // after any change
+    static constexpr uint32_t kMinFps           = 15;
+
+    void reset(uint32_t bitrate_bps, uint32_t fps) {
+        nominal_bitrate_ = bitrate_bps;
+        nominal_fps_     = (std::max)(1u, fps);
+        level_           = 0;
+        overloaded_run_  = 0;
+        healthy_run_     = 0;
+        hold_            = 0;
+        downgrades_      = 0;
+        upgrades_        = 0;
+        window_start_us_ = -1;
+        last_admitted_   = -1;
+        clear_window();
+    }
+
+    // Frame decimation for reduced fps: false = don't encode this frame
+    bool admit(int64_t pts) {
+        if (fps() >= nominal_fps_) return true;
+        // 10% tolerance so capture jitter doesn't halve the rate again
+        const int64_t interval = 10'000'000 / static_cast<int64_t>(fps());
+        if (last_admitted_ >= 0 && pts - last_admitted_ < interval * 9 / 10) return false;
+        last_admitted_ = pts;
+        return true;
+    }
+
+    void on_frame(int64_t encode_us, size_t queue_depth) {
+        ++frames_;
+        encode_us_sum_ += (std::max)(int64_t{ 0 }, encode_us);
+        depth_sum_     += queue_depth;
+    }
+
+    void on_drop(uint32_t frames = 1) { drops_ += frames; }
+
+    // Close the window ending at now_us. Returns true when the level changed.
+    bool evaluate(int64_t now_us) {
+        if (window_start_us_ < 0) { window_start_us_ = now_us; return false; }
+        if (now_us - window_start_us_ < kWindowUs) return false;
+        window_start_us_ = now_us;
+
+        const bool no_load = frames_ == 0 && drops_ == 0;  // static screen / paused
+        const bool over    = !no_load && overloaded();
+        const bool healthy = no_load || comfortable();
+        clear_window();
+
+        if (hold_ > 0) { --hold_; return false; }
+
+        overloaded_run_ = over    ? overloaded_run_ + 1 : 0;
+        healthy_run_    = healthy ? healthy_run_ + 1    : 0;
+        if (overloaded_run_ >= kOverloadWindows && level_ < max_level()) {
+            ++level_;
+            ++downgrades_;
+            return changed();
+        }
+        if (healthy_run_ >= kHealthyWindows && level_ > 0) {
+            --level_;
+            ++upgrades_;
+            return changed();
+        }
+        return false;
+    }
+
+    uint32_t level() const { return level_; }
+    uint32_t bitrate_bps() const {
+        static constexpr std::array<uint32_t, kMaxLevel + 1> kPct{ 100, 75, 55, 40, 40 };
+        return static_cast<uint32_t>(static_cast<uint64_t>(nominal_bitrate_) * kPct[level_] / 100);
+    }
+    uint32_t fps() const {
+        return level_ >= 4 ? (std::max)(kMinFps, nominal_fps_ / 2) : nominal_fps_;
+    }
+    uint32_t downgrades() const { return downgrades_; }
+    uint32_t upgrades()   const { return upgrades_; }
+
+private:
+    // Level 4 only exists when halving fps still leaves at least kMinFps
+    uint32_t max_level() const { return nominal_fps_ / 2 >= kMinFps ? kMaxLevel : kMaxLevel - 1; }
+
+    int64_t budget_us() const { return 1'000'000 / static_cast<int64_t>(fps()); }
+
+    bool overloaded() const {
+        const uint32_t offered = frames_ + drops_;
+        if (offered > 0 && drops_ * 50 > offered) return true;          // > 2% dropped
+        if (frames_ == 0) return drops_ > 0;
+        if (encode_us_sum_ / frames_ > budget_us() * 85 / 100) return true;
+        return depth_sum_ >= 2ull * frames_;   // queue stays nearly full
+    }
+
+    bool comfortable() const {
+        if (drops_ > 0)  return false;
+        if (frames_ == 0) return true;
+        return encode_us_sum_ / frames_ < budget_us() * 60 / 100 && depth_sum_ < frames_;
+    }
+
+    bool changed() {
+        overloaded_run_ = healthy_run_ = 0;
+        hold_           = kHoldWindows;
+        last_admitted_  = -1;
+        return true;
+    }
+
+    void clear_window() {
+        frames_        = 0;
+        drops_         = 0;
+        encode_us_sum_ = 0;
+        depth_sum_     = 0;
+    }
+
+    uint32_t nominal_bitrate_ = 4'000'000;
+    uint32_t nominal_fps_     = 30;
+    uint32_t level_           = 0;
+    uint32_t overloaded_run_  = 0;
+    uint32_t healthy_run_     = 0;
+    uint32_t hold_            = 0;
+    uint32_t downgrades_      = 0;
+    uint32_t upgrades_        = 0;
+    int64_t  window_start_us_ = -1;
+    int64_t  last_admitted_   = -1;
+
+    uint32_t frames_        = 0;
+    uint32_t drops_         = 0;
+    int64_t  encode_us_sum_ = 0;
+    uint64_t depth_sum_     = 0;
+};
+
+} // namespace sr
@@ -2,8 +2,8 @@
 // sync_manager.h — A/V presentation timestamp (PTS) alignment using QPC clock
 // T014: Converts QPC timestamps to 100ns units, tracks pause offsets for PTS rebasing
 
-#include <windows.h>
 #include <cstdint>
+#include "utils/qpc_clock.h"
 
 namespace sr {
 
@@ -13,27 +13,21 @@ public:
 
     // Call at recording start; anchors the QPC base time
     void start() {
-        LARGE_INTEGER now{};
-        QueryPerformanceCounter(&now);
-        anchor_qpc_       = now.QuadPart;
+        anchor_qpc_       = QPCClock::ticks();
+        anchor_100ns_     = ticks_to_100ns(anchor_qpc_);
         paused_accum_100ns_ = 0;
         pause_start_qpc_  = 0;
-        freq_ = get_freq();
     }
 
     // Call immediately at pause
     void pause() {
-        LARGE_INTEGER now{};
-        QueryPerformanceCounter(&now);
-        pause_start_qpc_ = now.QuadPart;
+        pause_start_qpc_ = QPCClock::ticks();
     }
 
     // Call immediately at resume; accumulates pause duration
     void resume() {
         if (pause_start_qpc_ > 0) {
-            LARGE_INTEGER now{};
-            QueryPerformanceCounter(&now);
-            int64_t paused_ticks = now.QuadPart - pause_start_qpc_;
+            int64_t paused_ticks = QPCClock::ticks() - pause_start_qpc_;
             paused_accum_100ns_ += ticks_to_100ns(paused_ticks);
             pause_start_qpc_ = 0;
         }
@@ -46,11 +40,17 @@ public:
         return raw - paused_accum_100ns_;
     }
 
+    // Map a system-relative 100ns timestamp (QPC time base, e.g. WGC
+    // Direct3D11CaptureFrame::SystemRelativeTime) to time since start().
+    // Pause gaps are kept, like the audio timeline's sample clock; paused
+    // media is dropped by the pipeline instead of being rebased.
+    int64_t session_time(int64_t system_100ns) const {
+        return system_100ns - anchor_100ns_;
+    }
+
     // Convenience: PTS at "now"
     int64_t now_pts() const {
-        LARGE_INTEGER now{};
-        QueryPerformanceCounter(&now);
-        return to_pts(now.QuadPart);
+        return to_pts(QPCClock::ticks());
     }
 
     // Total paused duration in 100ns units
@@ -61,25 +61,12 @@ public:
 
 private:
     int64_t anchor_qpc_        = 0;
+    int64_t anchor_100ns_      = 0;
     int64_t paused_accum_100ns_ = 0;
     int64_t pause_start_qpc_   = 0;
-    mutable int64_t freq_      = 0;
 
-    static int64_t get_freq() {
-        LARGE_INTEGER f{};
-        QueryPerformanceFrequency(&f);
-        return f.QuadPart;
-    }
-
-    int64_t ticks_to_100ns(int64_t ticks) const {
-        if (freq_ == 0) {
-            const_cast<SyncManager*>(this)->freq_ = get_freq();
-        }
-        // Avoid overflow: use double arithmetic (sufficient precision for 60-min sessions)
-        return static_cast<int64_t>(
-            static_cast<double>(ticks) * 10'000'000.0 /
-            static_cast<double>(freq_)
-        );
+    static int64_t ticks_to_100ns(int64_t ticks) {
+        return QPCClock::instance().ticks_to_hns(ticks);
     }
 };
 
@@ -0,0 +1,85 @@
+#pragma once
+// audio_codec.h — Audio codec selection shared by the muxer and its encoder stage
+//
+// AAC is encoded by the sink writer itself (the Microsoft AAC encoder it
+// inserts between our PCM and the MP4 stream), which only accepts a few
+// fixed bitrates: aac_encoder_bitrate() snaps a request to one of them.
+// HE-AAC (SBR) halves the bitrate for speech at the same intelligibility
+// where the encoder offers it; otherwise the muxer falls back to AAC-LC.
+//
+// Opus goes through an explicit encoder MFT (AudioEncoderMft) because the
+// sink writer will not insert one by itself; the MP4 then carries the
+// encoded packets as-is. Windows ships an Opus decoder but no encoder, so
+// this needs a third-party MFT and falls back to AAC without one.
+
+#include <mfapi.h>
+#include <array>
+#include <cstdint>
+
+namespace sr {
+
+enum class AudioCodec : uint8_t {
+    AAC,    // default — plays everywhere
+    Opus,   // cheaper at voice bitrates; needs an Opus encoder MFT
+};
+
+enum class AacProfile : uint8_t {
+    LC,     // AAC-LC
+    HE,     // HE-AAC v1 (AAC-LC + SBR)
+};
+
+inline const wchar_t* audio_codec_label(AudioCodec codec) {
+    switch (codec) {
+        case AudioCodec::AAC:  return L"AAC";
+        case AudioCodec::Opus: return L"Opus";
+    }
+    return L"?";
+}
+
+inline const wchar_t* aac_profile_label(AacProfile profile) {
+    return profile == AacProfile::HE ? L"HE-AAC" : L"AAC-LC";
+}
+
+// MF_MT_AAC_AUDIO_PROFILE_LEVEL_INDICATION: AAC Profile L2 / High Efficiency v1 L2
+inline uint32_t aac_profile_level(AacProfile profile) {
+    return profile == AacProfile::HE ? 0x2C : 0x29;
+}
+
+// Nearest bitrate the Microsoft AAC encoder accepts for `profile`
+// (MF_MT_AUDIO_AVG_BYTES_PER_SECOND must be one of these / 8)
+inline uint32_t aac_encoder_bitrate(uint32_t requested_bps, AacProfile profile) {
+    static constexpr std::array<uint32_t, 4> kLc = { 96'000, 128'000, 160'000, 192'000 };
+    static constexpr std::array<uint32_t, 4> kHe = { 48'000, 64'000, 80'000, 96'000 };
+    const auto& rates = profile == AacProfile::HE ? kHe : kLc;
+    uint32_t best = rates[0];
+    for (uint32_t r : rates) {
+        const uint32_t d_best = best > requested_bps ? best - requested_bps : requested_bps - best;
+        const uint32_t d      = r > requested_bps ? r - requested_bps : requested_bps - r;
+        if (d < d_best) best = r;
+    }
+    return best;
+}
+
+// Opus: 6-510 kb/s; 24-32 kb/s is transparent for speech
+inline uint32_t opus_bitrate(uint32_t requested_bps) {
+    return requested_bps < 6'000 ? 6'000 : (requested_bps > 510'000 ? 510'000 : requested_bps);
+}
+
+// What one track of `codec` will actually cost, for size and space estimates
+inline uint32_t audio_track_bitrate(AudioCodec codec, AacProfile profile, uint32_t requested_bps) {
+    return codec == AudioCodec::Opus ? opus_bitrate(requested_bps)
+                                     : aac_encoder_bitrate(requested_bps, profile);
+}
+
+// MF_MT_SUBTYPE. Opus is built from its format tag (WAVE_FORMAT_OPUS) so
+// SDKs that predate MFAudioFormat_Opus still compile.
+inline GUID audio_codec_subtype(AudioCodec codec) {
+    if (codec == AudioCodec::Opus) {
+        GUID g = MFAudioFormat_Base;
+        g.Data1 = 0x704F;
+        return g;
+    }
+    return MFAudioFormat_AAC;
+}
+
+} // namespace sr
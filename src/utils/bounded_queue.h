@@ -4,6 +4,18 @@
 // Pop side is lock-free (single consumer assumed).
 // Max depth is statically bounded by Capacity — queues NEVER grow unboundedly.
 //
+// Producer policy (third template parameter):
+//   MultiProducer  (default) — mutex-serialised push, condition_variable wake.
+//   SingleProducer — exactly one producer thread. Push is lock-free and only
+//                    issues a WakeByAddressSingle when the consumer is actually
+//                    parked in wait_pop(), so the producer (e.g. the WGC
+//                    frame-arrived callback) never takes a lock or a syscall
+//                    in the common case.
+//
+// Part of the platform-neutral core (sr_core): the consumer parks with
+// WaitOnAddress on Windows and a private futex on Linux — the same
+// wait-while-equal-with-timeout contract.
+//
 // T036 Memory Stability Review:
 //   - Video queue:  Capacity=3  → max 3 queued D3D11 texture refs = bounded
 //   - Audio queue:  Capacity=16 → max 16 packets * ~10ms PCM ≈ bounded
@@ -11,12 +23,21 @@
 //   - try_push returns false (caller drops) when full — NO dynamic growth
 //   - COM texture pointers in RenderFrame use WRL ComPtr — Released in destructor
 //     when popped frame goes out of scope in encode_loop
-//   - AudioPacket.buffer is std::vector<uint8_t> — bounded by PCM packet size (~1KB)
+//   - AudioPacket.buffer is a PcmBuffer borrowing a fixed PcmBlockPool slab block
 //   - No global statics with COM objects (COM uninit-safe)
 //
 // Architectural constraint check:
 //   BoundedQueue<RenderFrame, 3>  ← keep intentionally small for laptop RAM/latency
 
+#ifdef _WIN32
+#include <windows.h>
+#pragma comment(lib, "Synchronization.lib")  // WaitOnAddress / WakeByAddressSingle
+#else
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+#endif
 #include <atomic>
 #include <optional>
 #include <array>
@@ -25,31 +46,61 @@
 #include <thread>
 #include <mutex>
 #include <condition_variable>
+#include <type_traits>
 
 namespace sr {
 
-template <typename T, size_t Capacity = 5>
+// Producer policies for BoundedQueue
+struct MultiProducer  {};
+struct SingleProducer {};
+
+template <typename T, size_t Capacity = 5, typename Policy = MultiProducer>
 class BoundedQueue {
     // T036: Compile-time guard — prevent accidental unbounded config
     static_assert(Capacity >= 1  && Capacity <= 256,
                   "BoundedQueue Capacity must be in [1, 256]");
+    static_assert(std::is_same_v<Policy, MultiProducer> ||
+                  std::is_same_v<Policy, SingleProducer>,
+                  "BoundedQueue Policy must be MultiProducer or SingleProducer");
+
+    static constexpr bool kSingleProducer = std::is_same_v<Policy, SingleProducer>;
 
 public:
     BoundedQueue() : head_(0), tail_(0) {}
 
     // Non-blocking push. Returns false if queue is full (caller applies drop policy).
-    // Thread-safe for multiple concurrent producers (mutex-protected).
+    // MultiProducer: thread-safe for concurrent producers (mutex-protected).
+    // SingleProducer: lock-free; must only ever be called from one thread.
     bool try_push(T&& item) {
-        std::lock_guard<std::mutex> lock(push_mutex_);
-        size_t head = head_.load(std::memory_order_relaxed);
-        size_t next = (head + 1) % (Capacity + 1);
-        if (next == tail_.load(std::memory_order_acquire)) {
-            return false; // Full — caller must apply drop policy
+        if constexpr (kSingleProducer) {
+            size_t head = head_.load(std::memory_order_relaxed);
+            size_t next = (head + 1) % (Capacity + 1);
+            if (next == tail_.load(std::memory_order_acquire)) {
+                return false; // Full — caller must apply drop policy
+            }
+            buffer_[head] = std::move(item);
+            head_.store(next, std::memory_order_release);
+
+            // Pairs with the fence in wait_pop(): either the consumer sees the
+            // new head before parking, or we see consumer_parked_ and wake it.
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (consumer_parked_.load(std::memory_order_relaxed)) {
+                wake_seq_.fetch_add(1, std::memory_order_release);
+                wake_consumer();
+            }
+            return true;
+        } else {
+            std::lock_guard<std::mutex> lock(push_mutex_);
+            size_t head = head_.load(std::memory_order_relaxed);
+            size_t next = (head + 1) % (Capacity + 1);
+            if (next == tail_.load(std::memory_order_acquire)) {
+                return false; // Full — caller must apply drop policy
+            }
+            buffer_[head] = std::move(item);
+            head_.store(next, std::memory_order_release);
+            cv_.notify_one();
+            return true;
         }
-        buffer_[head] = std::move(item);
-        head_.store(next, std::memory_order_release);
-        cv_.notify_one();
-        return true;
     }
 
     // Non-blocking pop. Returns nullopt if queue is empty.
@@ -69,13 +120,41 @@ public:
         if (auto item = try_pop(); item.has_value()) {
             return item;
         }
-        std::unique_lock<std::mutex> lock(wait_mutex_);
-        const bool ready = cv_.wait_for(lock, timeout, [this]() {
-            return !empty();
-        });
-        if (!ready) return std::nullopt;
-        lock.unlock();
-        return try_pop();
+        if constexpr (kSingleProducer) {
+            const auto deadline = std::chrono::steady_clock::now() + timeout;
+            while (true) {
+                const uint32_t seq = wake_seq_.load(std::memory_order_acquire);
+                consumer_parked_.store(1, std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                if (!empty()) {
+                    consumer_parked_.store(0, std::memory_order_relaxed);
+                    return try_pop();
+                }
+
+                const auto now = std::chrono::steady_clock::now();
+                if (now >= deadline) {
+                    consumer_parked_.store(0, std::memory_order_relaxed);
+                    return std::nullopt;
+                }
+                const auto remaining_ms = std::chrono::ceil<std::chrono::milliseconds>(deadline - now);
+                // Returns immediately if the producer bumped wake_seq_ since we read it.
+                park_consumer(seq, remaining_ms);
+                consumer_parked_.store(0, std::memory_order_relaxed);
+
+                if (auto item = try_pop(); item.has_value()) {
+                    return item;
+                }
+                // Spurious wake or timeout slice elapsed — re-check the deadline.
+            }
+        } else {
+            std::unique_lock<std::mutex> lock(wait_mutex_);
+            const bool ready = cv_.wait_for(lock, timeout, [this]() {
+                return !empty();
+            });
+            if (!ready) return std::nullopt;
+            lock.unlock();
+            return try_pop();
+        }
     }
 
     // Current occupancy (approximate — head/tail may race)
@@ -99,13 +178,38 @@ public:
     static constexpr size_t capacity() { return Capacity; }
 
 private:
+    // Block while wake_seq_ == seq, at most `timeout`; may wake spuriously
+    void park_consumer(uint32_t seq, std::chrono::milliseconds timeout) {
+#ifdef _WIN32
+        uint32_t expected = seq;
+        WaitOnAddress(&wake_seq_, &expected, sizeof(expected), static_cast<DWORD>(timeout.count()));
+#else
+        timespec ts{};
+        ts.tv_sec  = static_cast<time_t>(timeout.count() / 1000);
+        ts.tv_nsec = static_cast<long>(timeout.count() % 1000) * 1'000'000;
+        syscall(SYS_futex, reinterpret_cast<uint32_t*>(&wake_seq_), FUTEX_WAIT_PRIVATE, seq, &ts, nullptr, 0);
+#endif
+    }
+
+    void wake_consumer() {
+#ifdef _WIN32
+        WakeByAddressSingle(&wake_seq_);
+#else
+        syscall(SYS_futex, reinterpret_cast<uint32_t*>(&wake_seq_), FUTEX_WAKE_PRIVATE, 1, nullptr, nullptr, 0);
+#endif
+    }
+
     // T036: Fixed-size ring buffer — NEVER allocates after construction
     std::array<T, Capacity + 1> buffer_; // One extra slot for ring buffer sentinel
     alignas(64) std::atomic<size_t> head_;
     alignas(64) std::atomic<size_t> tail_;
-    std::mutex push_mutex_; // Serializes concurrent producers
+    std::mutex push_mutex_; // Serializes concurrent producers (MultiProducer)
     std::mutex wait_mutex_;
     std::condition_variable cv_;
+
+    // SingleProducer wake state: the consumer parks on wake_seq_ (WaitOnAddress / futex)
+    alignas(64) std::atomic<uint32_t> wake_seq_{ 0 };
+    std::atomic<uint32_t> consumer_parked_{ 0 };
 };
 
 } // namespace sr
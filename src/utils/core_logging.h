@@ -0,0 +1,44 @@
+#pragma once
+// core_logging.h — SR_LOG_* for the platform-neutral core (sr_core)
+//
+// On Windows this is utils/logging.h: the LogRing-backed Logger. The Linux
+// core build (unit tests, benchmarks, sanitizer runs) has no Logger, so
+// Debug/Info compile to nothing there and Warn/Error are formatted on the
+// calling thread and written to stderr.
+//
+// Core code keeps to format specifiers both CRTs read the same way (%d, %u,
+// %lld, %f, %ls) — a bare %s is a wide string only on Windows.
+
+#ifdef _WIN32
+#include "utils/logging.h"
+#else
+#include <cstdarg>
+#include <cstdio>
+#include <cwchar>
+
+namespace sr {
+
+inline void core_log(const char* level, const wchar_t* fmt, ...) {
+    wchar_t line[1024];
+    va_list args;
+    va_start(args, fmt);
+    const int n = std::vswprintf(line, sizeof(line) / sizeof(line[0]), fmt, args);
+    va_end(args);
+    if (n < 0) return;
+    // ASCII out: stderr stays byte-oriented for the test runners sharing it
+    char narrow[sizeof(line) / sizeof(line[0])];
+    size_t i = 0;
+    for (; line[i] != L'\0'; ++i) {
+        narrow[i] = line[i] < 0x80 ? static_cast<char>(line[i]) : '?';
+    }
+    narrow[i] = '\0';
+    std::fprintf(stderr, "%s %s\n", level, narrow);
+}
+
+} // namespace sr
+
+#define SR_LOG_DEBUG(fmt, ...) do { } while (0)
+#define SR_LOG_INFO(fmt, ...)  do { } while (0)
+#define SR_LOG_WARN(fmt, ...)  sr::core_log("WARN ", fmt, ##__VA_ARGS__)
+#define SR_LOG_ERROR(fmt, ...) sr::core_log("ERROR", fmt, ##__VA_ARGS__)
+#endif
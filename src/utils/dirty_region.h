@@ -0,0 +1,158 @@
+#pragma once
+// dirty_region.h — Fixed-capacity set of changed rectangles for one captured frame
+//
+// Filled from WGC Direct3D11CaptureFrame::DirtyRegions (Windows 11 24H2+) in
+// content coordinates, then scaled to the encoder's output size. Consumers:
+//   - capture:  an empty, known region means the frame is a duplicate
+//   - encoder:  changed areas can drive ROI / QP hints
+//
+// No allocation: rectangles past kMaxRects are merged into the existing rect
+// whose bounding box grows the least, so the region only ever over-covers.
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace sr {
+
+// Half-open pixel rectangle [left, right) x [top, bottom)
+struct FrameRect {
+    uint32_t left   = 0;
+    uint32_t top    = 0;
+    uint32_t right  = 0;
+    uint32_t bottom = 0;
+
+    bool     empty()  const { return right <= left || bottom <= top; }
+    uint32_t width()  const { return empty() ? 0 : right - left; }
+    uint32_t height() const { return empty() ? 0 : bottom - top; }
+    uint64_t area()   const { return static_cast<uint64_t>(width()) * height(); }
+
+    FrameRect united(const FrameRect& o) const {
+        return { (std::min)(left, o.left), (std::min)(top, o.top),
+                 (std::max)(right, o.right), (std::max)(bottom, o.bottom) };
+    }
+    FrameRect intersected(const FrameRect& o) const {
+        FrameRect r{ (std::max)(left, o.left), (std::max)(top, o.top),
+                     (std::min)(right, o.right), (std::min)(bottom, o.bottom) };
+        return r.empty() ? FrameRect{} : r;
+    }
+    bool contains(const FrameRect& o) const {
+        return o.left >= left && o.top >= top && o.right <= right && o.bottom <= bottom;
+    }
+    bool operator==(const FrameRect&) const = default;
+};
+
+class DirtyRegion {
+public:
+    static constexpr size_t kMaxRects = 16;
+
+    // known() == false means "no dirty-rect information" and must be treated
+    // as a full-frame change; known() && empty() means nothing changed.
+    bool   known() const { return known_; }
+    bool   empty() const { return count_ == 0; }
+    size_t size()  const { return count_; }
+    const FrameRect& operator[](size_t i) const { return rects_[i]; }
+    const FrameRect* begin() const { return rects_.data(); }
+    const FrameRect* end()   const { return rects_.data() + count_; }
+
+    void clear_unknown() { known_ = false; count_ = 0; }
+
+    // Start a known (possibly empty) region for a width x height surface
+    void reset(uint32_t width, uint32_t height) {
+        known_  = true;
+        count_  = 0;
+        width_  = width;
+        height_ = height;
+    }
+
+    void set_full(uint32_t width, uint32_t height) {
+        reset(width, height);
+        add({ 0, 0, width, height });
+    }
+
+    // Clips to the surface; drops empties and rects already covered.
+    void add(FrameRect r) {
+        r.right  = (std::min)(r.right, width_);
+        r.bottom = (std::min)(r.bottom, height_);
+        if (r.empty()) return;
+
+        for (size_t i = 0; i < count_; ++i) {
+            if (rects_[i].contains(r)) return;
+        }
+        if (count_ < kMaxRects) {
+            rects_[count_++] = r;
+            return;
+        }
+        size_t best = 0;
+        uint64_t best_growth = UINT64_MAX;
+        for (size_t i = 0; i < count_; ++i) {
+            const uint64_t growth = rects_[i].united(r).area() - rects_[i].area();
+            if (growth < best_growth) { best_growth = growth; best = i; }
+        }
+        rects_[best] = rects_[best].united(r);
+    }
+
+    // Sum of rect areas (may double-count overlaps) — cheap coverage estimate
+    uint64_t area() const {
+        uint64_t total = 0;
+        for (size_t i = 0; i < count_; ++i) total += rects_[i].area();
+        return total;
+    }
+
+    FrameRect bounds() const {
+        if (count_ == 0) return {};
+        FrameRect b = rects_[0];
+        for (size_t i = 1; i < count_; ++i) b = b.united(rects_[i]);
+        return b;
+    }
+
+    uint32_t width()  const { return width_; }
+    uint32_t height() const { return height_; }
+
+    // Restrict to `crop` (in this region's coordinates) and rebase onto its
+    // top-left corner — used when the VP blits only a source sub-rectangle.
+    DirtyRegion cropped(const FrameRect& crop) const {
+        DirtyRegion out;
+        if (!known_) return out;
+        out.reset(crop.width(), crop.height());
+        for (size_t i = 0; i < count_; ++i) {
+            const FrameRect r = rects_[i].intersected(crop);
+            if (r.empty()) continue;
+            out.add({ r.left - crop.left, r.top - crop.top,
+                      r.right - crop.left, r.bottom - crop.top });
+        }
+        return out;
+    }
+
+    // Map to an out_w x out_h surface (the VP stretches content to fill the
+    // output). Edges round outward so scaled rects never under-cover.
+    DirtyRegion scaled(uint32_t out_w, uint32_t out_h) const {
+        DirtyRegion out;
+        if (!known_) return out;
+        out.reset(out_w, out_h);
+        if (width_ == 0 || height_ == 0) return out;
+        for (size_t i = 0; i < count_; ++i) {
+            const FrameRect& r = rects_[i];
+            out.add({ scale_down(r.left, out_w, width_),  scale_down(r.top, out_h, height_),
+                      scale_up(r.right, out_w, width_),   scale_up(r.bottom, out_h, height_) });
+        }
+        return out;
+    }
+
+private:
+    static uint32_t scale_down(uint32_t v, uint32_t num, uint32_t den) {
+        return static_cast<uint32_t>(static_cast<uint64_t>(v) * num / den);
+    }
+    static uint32_t scale_up(uint32_t v, uint32_t num, uint32_t den) {
+        return static_cast<uint32_t>((static_cast<uint64_t>(v) * num + den - 1) / den);
+    }
+
+    std::array<FrameRect, kMaxRects> rects_{};
+    size_t   count_  = 0;
+    uint32_t width_  = 0;
+    uint32_t height_ = 0;
+    bool     known_  = false;
+};
+
+} // namespace sr
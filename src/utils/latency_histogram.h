@@ -0,0 +1,87 @@
+#pragma once
+// latency_histogram.h — Lock-free log-linear latency histogram (HDR-style)
+//
+// Values are microseconds. Each power-of-two range is split into kSubBuckets
+// linear buckets, so any recorded value is reported within ~6% (1/16) of its
+// true value while the whole 0 .. 2^kMaxExponent us range fits in a few
+// hundred counters. record() is a single relaxed fetch_add and may be called
+// from any thread; percentile() scans the counters and is meant for the UI /
+// diagnostics path.
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace sr {
+
+class LatencyHistogram {
+public:
+    static constexpr uint32_t kSubBucketBits = 4;
+    static constexpr uint32_t kSubBuckets    = 1u << kSubBucketBits;   // 16
+    static constexpr uint32_t kMaxExponent   = 25;                     // ~33 s
+    static constexpr size_t   kBucketCount   =
+        (kMaxExponent - kSubBucketBits + 1) * kSubBuckets + kSubBuckets;
+
+    void record(int64_t value_us) {
+        const uint64_t v = value_us > 0 ? static_cast<uint64_t>(value_us) : 0;
+        counts_[bucket_for(v)].fetch_add(1, std::memory_order_relaxed);
+        total_.fetch_add(1, std::memory_order_relaxed);
+        uint64_t prev = max_.load(std::memory_order_relaxed);
+        while (v > prev && !max_.compare_exchange_weak(prev, v, std::memory_order_relaxed)) {}
+    }
+
+    // Value at or below which `pct` percent of samples fall (upper bucket
+    // edge, capped at the recorded max). Returns 0 when empty.
+    uint64_t percentile(double pct) const {
+        const uint64_t total = total_.load(std::memory_order_relaxed);
+        if (total == 0) return 0;
+        if (pct < 0.0) pct = 0.0;
+        if (pct > 100.0) pct = 100.0;
+        uint64_t rank = static_cast<uint64_t>(pct / 100.0 * static_cast<double>(total) + 0.5);
+        if (rank == 0) rank = 1;
+
+        uint64_t seen = 0;
+        for (size_t i = 0; i < kBucketCount; ++i) {
+            seen += counts_[i].load(std::memory_order_relaxed);
+            if (seen >= rank) {
+                const uint64_t hi = bucket_upper(i) - 1;
+                const uint64_t mx = max();
+                return hi < mx ? hi : mx;
+            }
+        }
+        return max();
+    }
+
+    uint64_t count() const { return total_.load(std::memory_order_relaxed); }
+    uint64_t max()   const { return max_.load(std::memory_order_relaxed); }
+
+    void reset() {
+        for (auto& c : counts_) c.store(0, std::memory_order_relaxed);
+        total_.store(0, std::memory_order_relaxed);
+        max_.store(0, std::memory_order_relaxed);
+    }
+
+    static size_t bucket_for(uint64_t v) {
+        if (v < kSubBuckets) return static_cast<size_t>(v);
+        uint32_t msb = 63;
+        while ((v >> msb) == 0) --msb;
+        if (msb > kMaxExponent) return kBucketCount - 1;
+        const uint32_t shift = msb - kSubBucketBits;
+        return static_cast<size_t>(shift) * kSubBuckets + static_cast<size_t>(v >> shift);
+    }
+
+    // Exclusive upper bound of values mapped to bucket i
+    static uint64_t bucket_upper(size_t i) {
+        const size_t shift = i < 2 * kSubBuckets ? 0 : i / kSubBuckets - 1;
+        const uint64_t top = static_cast<uint64_t>(i - shift * kSubBuckets);
+        return (top + 1) << shift;
+    }
+
+private:
+    std::array<std::atomic<uint32_t>, kBucketCount> counts_{};
+    std::atomic<uint64_t> total_{ 0 };
+    std::atomic<uint64_t> max_  { 0 };
+};
+
+} // namespace sr
@@ -0,0 +1,96 @@
+#pragma once
+// log_ring.h — Bounded lock-free MPSC ring of formatted log lines
+//
+// Producers (WGC callback, audio capture, encode/mux stages) claim a slot with
+// one CAS, format into it in place and publish it; they never wait on a lock
+// or a syscall. A full ring drops the line and counts it instead of blocking.
+// The single consumer (Logger's flush thread) drains in FIFO order.
+//
+// Per-slot sequence numbers (Vyukov bounded queue):
+//   seq == pos            slot free for the producer claiming pos
+//   seq == pos + 1        slot published, readable by the consumer at pos
+//   seq == pos + Capacity slot released for the next lap
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace sr {
+
+enum class LogLevel { Debug, Info, Warn, Error };
+
+template <size_t Capacity, size_t LineChars>
+class LogRing {
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+public:
+    struct Line {
+        LogLevel level = LogLevel::Info;
+        wchar_t  text[LineChars]{};
+    };
+
+    LogRing() : slots_(std::make_unique<Slot[]>(Capacity)) {
+        for (size_t i = 0; i < Capacity; ++i) slots_[i].seq.store(i, std::memory_order_relaxed);
+    }
+
+    LogRing(const LogRing&)            = delete;
+    LogRing& operator=(const LogRing&) = delete;
+
+    // Any thread. format(wchar_t* buf, size_t chars) writes a NUL-terminated
+    // line. Returns false (and counts a drop) when the ring is full.
+    template <typename Format>
+    bool try_push(LogLevel level, Format&& format) {
+        size_t pos = head_.load(std::memory_order_relaxed);
+        Slot*  slot;
+        for (;;) {
+            slot = &slots_[pos & (Capacity - 1)];
+            const size_t   seq  = slot->seq.load(std::memory_order_acquire);
+            const intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+            if (diff == 0) {
+                if (head_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+            } else if (diff < 0) {
+                dropped_.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            } else {
+                pos = head_.load(std::memory_order_relaxed);
+            }
+        }
+        slot->line.level   = level;
+        slot->line.text[0] = L'\0';
+        format(slot->line.text, LineChars);
+        slot->line.text[LineChars - 1] = L'\0';
+        slot->seq.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer thread only. Calls sink(const Line&) for the oldest published
+    // line; false when nothing is ready.
+    template <typename Sink>
+    bool try_pop(Sink&& sink) {
+        Slot& slot = slots_[tail_ & (Capacity - 1)];
+        if (slot.seq.load(std::memory_order_acquire) != tail_ + 1) return false;
+        sink(static_cast<const Line&>(slot.line));
+        slot.seq.store(tail_ + Capacity, std::memory_order_release);
+        ++tail_;
+        return true;
+    }
+
+    // Lines lost to a full ring since construction
+    uint64_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+    static constexpr size_t capacity() { return Capacity; }
+
+private:
+    struct Slot {
+        std::atomic<size_t> seq{ 0 };
+        Line                line;
+    };
+
+    std::unique_ptr<Slot[]> slots_;
+    alignas(64) std::atomic<size_t> head_{ 0 };
+    alignas(64) size_t              tail_ = 0;   // consumer-owned
+    std::atomic<uint64_t>           dropped_{ 0 };
+};
+
+} // namespace sr
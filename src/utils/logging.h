@@ -1,15 +1,38 @@
 #pragma once
-// logging.h — Minimal logging utility for ScreenRecorder
-// Uses OutputDebugString for debug builds, can be extended to file logging
+// logging.h — Logging utility for ScreenRecorder
+//
+// SR_LOG_* format on the calling thread into a LogRing slot and return; the
+// Logger flush thread writes OutputDebugString and the optional log file.
+// A debugger or DebugView attached makes OutputDebugString slow, and that
+// cost now lands on the flush thread instead of the WGC callback, the audio
+// capture thread or the encode loop. A full ring drops lines (counted and
+// reported by the flush thread) rather than blocking a real-time thread.
+//
+// Before Logger::start() and after Logger::stop() (tests, tools, static
+// teardown) lines are written synchronously, as before.
+//
+// Compile-time filtering: levels below SR_LOG_MIN_LEVEL (0 Debug .. 3 Error;
+// default Debug in _DEBUG builds, Info otherwise) compile to nothing — the
+// arguments are not even evaluated.
 
 #include <windows.h>
+#include <atomic>
 #include <string>
+#include <thread>
 #include <cstdio>
 #include <cstdarg>
+#include <filesystem>
+#include "utils/log_ring.h"
 
-namespace sr {
+#ifndef SR_LOG_MIN_LEVEL
+#ifdef _DEBUG
+#define SR_LOG_MIN_LEVEL 0
+#else
+#define SR_LOG_MIN_LEVEL 1
+#endif
+#endif
 
-enum class LogLevel { Debug, Info, Warn, Error };
+namespace sr {
 
 inline const wchar_t* level_str(LogLevel l) {
     switch (l) {
@@ -21,27 +44,151 @@ inline const wchar_t* level_str(LogLevel l) {
     }
 }
 
-inline void log(LogLevel level, const wchar_t* fmt, ...) {
-    wchar_t buf[1024];
-    va_list args;
-    va_start(args, fmt);
-    _vsnwprintf_s(buf, _countof(buf) - 1, _TRUNCATE, fmt, args);
-    va_end(args);
+class Logger {
+public:
+    static constexpr size_t   kRingLines = 512;
+    static constexpr size_t   kLineChars = 1024;
+    static constexpr DWORD    kFlushMs   = 50;     // idle wake-up; Warn/Error wake at once
+
+    using Ring = LogRing<kRingLines, kLineChars>;
+
+    // Never destroyed: globals (SessionController, engines) still log from
+    // their destructors during static teardown
+    static Logger& instance() {
+        static Logger* logger = new Logger();
+        return *logger;
+    }
+
+    // Start the flush thread. file_path empty = debugger output only; an
+    // existing file is kept as <name>.1.log. Returns false if already running.
+    bool start(const std::wstring& file_path = {}) {
+        if (running_.load(std::memory_order_acquire) || thread_.joinable()) return false;
+        if (!file_path.empty()) {
+            std::error_code ec;
+            std::filesystem::create_directories(std::filesystem::path(file_path).parent_path(), ec);
+            const std::wstring previous = file_path.substr(0, file_path.find_last_of(L'.')) + L".1.log";
+            MoveFileExW(file_path.c_str(), previous.c_str(), MOVEFILE_REPLACE_EXISTING);
+            file_ = CreateFileW(file_path.c_str(), GENERIC_WRITE, FILE_SHARE_READ, nullptr,
+                                CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+            if (file_ == INVALID_HANDLE_VALUE) file_ = nullptr;
+        }
+        stopping_.store(false, std::memory_order_relaxed);
+        running_.store(true, std::memory_order_release);
+        thread_ = std::thread(&Logger::flush_loop, this);
+        return true;
+    }
+
+    // Drain everything queued, then close the file. Later lines go direct.
+    void stop() {
+        if (!thread_.joinable()) return;
+        running_.store(false, std::memory_order_release);
+        stopping_.store(true, std::memory_order_release);
+        SetEvent(wake_);
+        thread_.join();
+        if (file_) {
+            CloseHandle(file_);
+            file_ = nullptr;
+        }
+    }
+
+    bool running() const { return running_.load(std::memory_order_acquire); }
+    uint64_t dropped() const { return ring_.dropped(); }
 
-    wchar_t out[1100];
-    _snwprintf_s(out, _countof(out) - 1, _TRUNCATE,
-                 L"[SR][%s] %s\n", level_str(level), buf);
+    void write(LogLevel level, const wchar_t* fmt, va_list args) {
+        if (!running()) {
+            wchar_t buf[kLineChars];
+            _vsnwprintf_s(buf, _countof(buf) - 1, _TRUNCATE, fmt, args);
+            emit_direct(level, buf);
+            return;
+        }
+        ring_.try_push(level, [&](wchar_t* buf, size_t chars) {
+            _vsnwprintf_s(buf, chars - 1, _TRUNCATE, fmt, args);
+        });
+        if (level >= LogLevel::Warn) SetEvent(wake_);
+    }
+
+    Logger(const Logger&)            = delete;
+    Logger& operator=(const Logger&) = delete;
+
+private:
+    // The wake event lives as long as the process, so a producer racing
+    // stop() never signals a closed handle
+    Logger() : wake_(CreateEventW(nullptr, FALSE, FALSE, nullptr)) {}
 
-    OutputDebugStringW(out);
+    static void emit_direct(LogLevel level, const wchar_t* text) {
+        wchar_t out[kLineChars + 16];
+        _snwprintf_s(out, _countof(out) - 1, _TRUNCATE, L"[SR][%s] %s\n", level_str(level), text);
+        OutputDebugStringW(out);
+#ifdef _DEBUG
+        fwprintf(stderr, L"%s", out);
+#endif
+    }
+
+    void flush_loop() {
+        SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_BELOW_NORMAL);
+        uint64_t reported_drops = 0;
+        for (;;) {
+            const bool last_pass = stopping_.load(std::memory_order_acquire);
+            std::string utf8;
+            while (ring_.try_pop([&](const Ring::Line& line) {
+                emit(line.level, line.text, utf8);
+            })) {}
+
+            const uint64_t drops = ring_.dropped();
+            if (drops != reported_drops) {
+                wchar_t msg[96];
+                _snwprintf_s(msg, _countof(msg) - 1, _TRUNCATE,
+                             L"[Log] %llu lines dropped (ring full)", drops - reported_drops);
+                emit(LogLevel::Warn, msg, utf8);
+                reported_drops = drops;
+            }
+            if (file_ && !utf8.empty()) {
+                DWORD written = 0;
+                WriteFile(file_, utf8.data(), static_cast<DWORD>(utf8.size()), &written, nullptr);
+            }
+            if (last_pass) break;
+            WaitForSingleObject(wake_, kFlushMs);
+        }
+    }
 
+    // Flush thread: debugger output now, file output batched into utf8
+    void emit(LogLevel level, const wchar_t* text, std::string& utf8) {
+        wchar_t out[kLineChars + 16];
+        const int len = _snwprintf_s(out, _countof(out) - 1, _TRUNCATE,
+                                     L"[SR][%s] %s\n", level_str(level), text);
+        OutputDebugStringW(out);
 #ifdef _DEBUG
-    fwprintf(stderr, L"%s", out);
+        fwprintf(stderr, L"%s", out);
 #endif
+        if (!file_ || len <= 0) return;
+        const int bytes = WideCharToMultiByte(CP_UTF8, 0, out, len, nullptr, 0, nullptr, nullptr);
+        if (bytes <= 0) return;
+        const size_t at = utf8.size();
+        utf8.resize(at + static_cast<size_t>(bytes));
+        WideCharToMultiByte(CP_UTF8, 0, out, len, utf8.data() + at, bytes, nullptr, nullptr);
+    }
+
+    Ring              ring_;
+    std::thread       thread_;
+    std::atomic<bool> running_{ false };
+    std::atomic<bool> stopping_{ false };
+    HANDLE            wake_ = nullptr;
+    HANDLE            file_ = nullptr;
+};
+
+inline void log(LogLevel level, const wchar_t* fmt, ...) {
+    va_list args;
+    va_start(args, fmt);
+    Logger::instance().write(level, fmt, args);
+    va_end(args);
 }
 
-#define SR_LOG_DEBUG(fmt, ...) sr::log(sr::LogLevel::Debug, fmt, ##__VA_ARGS__)
-#define SR_LOG_INFO(fmt, ...)  sr::log(sr::LogLevel::Info,  fmt, ##__VA_ARGS__)
-#define SR_LOG_WARN(fmt, ...)  sr::log(sr::LogLevel::Warn,  fmt, ##__VA_ARGS__)
-#define SR_LOG_ERROR(fmt, ...) sr::log(sr::LogLevel::Error, fmt, ##__VA_ARGS__)
+#define SR_LOG_AT(lvl, level, fmt, ...) \
+    do { if constexpr (SR_LOG_MIN_LEVEL <= (lvl)) sr::log(level, fmt, ##__VA_ARGS__); } while (0)
+
+#define SR_LOG_DEBUG(fmt, ...) SR_LOG_AT(0, sr::LogLevel::Debug, fmt, ##__VA_ARGS__)
+#define SR_LOG_INFO(fmt, ...)  SR_LOG_AT(1, sr::LogLevel::Info,  fmt, ##__VA_ARGS__)
+#define SR_LOG_WARN(fmt, ...)  SR_LOG_AT(2, sr::LogLevel::Warn,  fmt, ##__VA_ARGS__)
+#define SR_LOG_ERROR(fmt, ...) SR_LOG_AT(3, sr::LogLevel::Error, fmt, ##__VA_ARGS__)
 
 } // namespace sr
@@ -0,0 +1,183 @@
+#pragma once
+// pcm_buffer_pool.h — Fixed slab of PCM blocks borrowed by AudioPacket
+//
+// Each AudioEngine owns one PcmBlockPool. The capture thread borrows a block
+// per WASAPI packet and the block returns to the pool when the packet is
+// destroyed on the audio-mix stage, so steady-state recording performs no
+// heap allocations on the audio path (important for multi-hour sessions
+// where allocator fragmentation shows up in the [Perf] memory log).
+//
+// Packets larger than kBlockBytes, or arriving while every block is in
+// flight, fall back to a heap-backed buffer — correctness never depends on
+// the pool having room.
+//
+// Lifetime: the pool must outlive every PcmBuffer borrowed from it.
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace sr {
+
+class PcmBlockPool {
+public:
+    // 16 KB ≈ 42 ms of 48 kHz stereo float32 — covers the 10-20 ms packets
+    // WASAPI delivers in shared event mode, plus resampler overshoot.
+    static constexpr size_t kBlockBytes = 16 * 1024;
+    // 2 × 16-slot AudioQueues + packets held by the mixer, with headroom.
+    static constexpr size_t kBlockCount = 64;
+
+    PcmBlockPool()
+        : slab_(std::make_unique<uint8_t[]>(kBlockBytes * kBlockCount)) {
+        for (size_t i = 0; i < kBlockCount; ++i) {
+            free_[i] = static_cast<uint16_t>(kBlockCount - 1 - i);
+        }
+        free_count_ = kBlockCount;
+    }
+
+    PcmBlockPool(const PcmBlockPool&) = delete;
+    PcmBlockPool& operator=(const PcmBlockPool&) = delete;
+
+    // Borrow a block able to hold `bytes`. Returns nullptr if the request is
+    // too large or the pool is exhausted (caller falls back to the heap).
+    uint8_t* acquire(size_t bytes, uint16_t& block_index) {
+        if (bytes > kBlockBytes) {
+            fallbacks_.fetch_add(1, std::memory_order_relaxed);
+            return nullptr;
+        }
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (free_count_ == 0) {
+            fallbacks_.fetch_add(1, std::memory_order_relaxed);
+            return nullptr;
+        }
+        block_index = free_[--free_count_];
+        return slab_.get() + static_cast<size_t>(block_index) * kBlockBytes;
+    }
+
+    void release(uint16_t block_index) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (free_count_ < kBlockCount) {
+            free_[free_count_++] = block_index;
+        }
+    }
+
+    size_t available() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return free_count_;
+    }
+
+    // Requests that could not be served from the slab
+    uint32_t fallbacks() const { return fallbacks_.load(std::memory_order_relaxed); }
+
+private:
+    std::unique_ptr<uint8_t[]>          slab_;
+    std::array<uint16_t, kBlockCount>   free_{};
+    size_t                              free_count_ = 0;
+    mutable std::mutex                  mutex_;
+    std::atomic<uint32_t>               fallbacks_{ 0 };
+};
+
+// -------------------------------------------------------------------
+// PcmBuffer — byte buffer backed by a PcmBlockPool block when possible.
+// Keeps the small slice of the std::vector interface the pipeline uses
+// (data/size/empty/resize/assign). Copies are deep and heap-backed.
+// -------------------------------------------------------------------
+class PcmBuffer {
+public:
+    PcmBuffer() = default;
+    ~PcmBuffer() { reset(); }
+
+    PcmBuffer(PcmBuffer&& other) noexcept { take(other); }
+    PcmBuffer& operator=(PcmBuffer&& other) noexcept {
+        if (this != &other) {
+            reset();
+            take(other);
+        }
+        return *this;
+    }
+
+    PcmBuffer(const PcmBuffer& other) { copy_from(other); }
+    PcmBuffer& operator=(const PcmBuffer& other) {
+        if (this != &other) {
+            reset();
+            copy_from(other);
+        }
+        return *this;
+    }
+
+    // Size the buffer to n bytes. Contents are unspecified afterwards.
+    // With a pool, borrows a slab block instead of allocating.
+    void resize(size_t n, PcmBlockPool* pool = nullptr) {
+        if (pooled_ && n <= PcmBlockPool::kBlockBytes) {
+            size_ = n;
+            return;
+        }
+        reset();
+        if (pool) {
+            uint16_t index = 0;
+            if (uint8_t* block = pool->acquire(n, index)) {
+                pool_   = pool;
+                block_  = index;
+                pooled_ = block;
+                size_   = n;
+                return;
+            }
+        }
+        heap_.resize(n);
+        size_ = n;
+    }
+
+    void assign(size_t n, uint8_t value) {
+        resize(n);
+        if (n > 0) std::memset(data(), value, n);
+    }
+
+    uint8_t*       data()       { return pooled_ ? pooled_ : heap_.data(); }
+    const uint8_t* data() const { return pooled_ ? pooled_ : heap_.data(); }
+    size_t size()  const { return size_; }
+    bool   empty() const { return size_ == 0; }
+    bool   pooled() const { return pooled_ != nullptr; }
+
+    // Return the block to its pool (or free heap storage)
+    void reset() {
+        if (pooled_ && pool_) {
+            pool_->release(block_);
+        }
+        pool_   = nullptr;
+        pooled_ = nullptr;
+        block_  = 0;
+        size_   = 0;
+        heap_.clear();
+    }
+
+private:
+    void take(PcmBuffer& other) noexcept {
+        pool_   = other.pool_;
+        block_  = other.block_;
+        pooled_ = other.pooled_;
+        size_   = other.size_;
+        heap_   = std::move(other.heap_);
+        other.pool_   = nullptr;
+        other.pooled_ = nullptr;
+        other.block_  = 0;
+        other.size_   = 0;
+    }
+
+    void copy_from(const PcmBuffer& other) {
+        heap_.assign(other.data(), other.data() + other.size());
+        size_ = other.size();
+    }
+
+    PcmBlockPool*        pool_   = nullptr;
+    uint8_t*             pooled_ = nullptr;
+    uint16_t             block_  = 0;
+    size_t               size_   = 0;
+    std::vector<uint8_t> heap_;
+};
+
+} // namespace sr
@@ -0,0 +1,203 @@
+#include "utils/perf_trace.h"
+#include "utils/wide_path.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace sr {
+
+namespace {
+
+uint16_t saturate16(uint32_t v) { return static_cast<uint16_t>((std::min)(v, 0xFFFFu)); }
+uint32_t saturate32(uint64_t v) { return static_cast<uint32_t>((std::min)(v, uint64_t{ 0xFFFFFFFFu })); }
+
+} // namespace
+
+void perf_trace_deltas(const PerfTraceCounters& now, PerfTraceCounters& prev, PerfTraceSample& s) {
+    // A total below the last one means the counters were reset (new
+    // session); count from zero
+    auto delta = [](uint32_t a, uint32_t b) { return a >= b ? a - b : a; };
+    s.frames_in  = saturate16(delta(now.captured, prev.captured));
+    s.frames_out = saturate16(delta(now.encoded, prev.encoded));
+    s.drops      = saturate16(delta(now.dropped, prev.dropped));
+    s.duplicates = saturate16(delta(now.duplicated, prev.duplicated));
+    s.unchanged  = saturate16(delta(now.unchanged, prev.unchanged));
+    prev = now;
+}
+
+void PerfTraceAccumulator::take(PerfTraceSample& s) {
+    const uint64_t count     = count_.exchange(0, std::memory_order_relaxed);
+    const uint64_t sum_us    = sum_us_.exchange(0, std::memory_order_relaxed);
+    const uint64_t max_us    = max_us_.exchange(0, std::memory_order_relaxed);
+    const uint64_t depth_sum = depth_sum_.exchange(0, std::memory_order_relaxed);
+    const uint64_t depth_max = depth_max_.exchange(0, std::memory_order_relaxed);
+    s.encode_us_avg  = count > 0 ? saturate32(sum_us / count) : 0;
+    s.encode_us_max  = saturate32(max_us);
+    s.queue_avg_x100 = count > 0 ? saturate16(saturate32(depth_sum * 100 / count)) : 0;
+    s.queue_max      = static_cast<uint8_t>((std::min)(depth_max, uint64_t{ 0xFF }));
+}
+
+std::wstring PerfTraceWriter::path_for_output(const std::wstring& output_path) {
+    const std::wstring mp4_suffix = L".mp4";
+    if (output_path.size() >= mp4_suffix.size() &&
+        output_path.compare(output_path.size() - mp4_suffix.size(), mp4_suffix.size(), mp4_suffix) == 0) {
+        return output_path.substr(0, output_path.size() - mp4_suffix.size()) + L".perftrace";
+    }
+    return output_path + L".perftrace";
+}
+
+bool PerfTraceWriter::open(const std::wstring& path, PerfTraceHeader header) {
+    close();
+    std::FILE* file = open_wide(path, "wb");
+    if (!file) return false;
+    header.sample_size = sizeof(PerfTraceSample);
+    if (std::fwrite(&header, sizeof(header), 1, file) != 1) {
+        std::fclose(file);
+        return false;
+    }
+    std::fflush(file);
+    file_     = file;
+    path_     = path;
+    stopping_ = false;
+    written_.store(0, std::memory_order_relaxed);
+    worker_ = std::thread([this] { run(); });
+    return true;
+}
+
+void PerfTraceWriter::append(const PerfTraceSample& sample) {
+    if (!file_) return;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        pending_.push_back(sample);
+    }
+    cv_.notify_one();
+}
+
+void PerfTraceWriter::close() {
+    if (!file_) return;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    cv_.notify_one();
+    if (worker_.joinable()) worker_.join();
+    std::fclose(file_);
+    file_ = nullptr;
+}
+
+// Flushed after every batch: a crashed session keeps its trace up to the
+// last second written
+void PerfTraceWriter::run() {
+    std::vector<PerfTraceSample> batch;
+    std::unique_lock<std::mutex> lock(mutex_);
+    for (;;) {
+        cv_.wait(lock, [this] { return stopping_ || !pending_.empty(); });
+        batch.swap(pending_);
+        const bool stop = stopping_;
+        lock.unlock();
+        if (!batch.empty()) {
+            const size_t n = std::fwrite(batch.data(), sizeof(PerfTraceSample), batch.size(), file_);
+            std::fflush(file_);
+            written_.fetch_add(static_cast<uint32_t>(n), std::memory_order_relaxed);
+            batch.clear();
+        }
+        lock.lock();
+        if (stop && pending_.empty()) break;
+    }
+}
+
+bool parse_perf_trace(const uint8_t* data, size_t size, PerfTraceHeader& header,
+                      std::vector<PerfTraceSample>& samples) {
+    samples.clear();
+    if (!data || size < sizeof(PerfTraceHeader)) return false;
+    std::memcpy(&header, data, sizeof(header));
+    if (std::memcmp(header.magic, "SRPT", 4) != 0 || header.version != kPerfTraceVersion ||
+        header.sample_size != sizeof(PerfTraceSample)) {
+        return false;
+    }
+    const size_t count = (size - sizeof(header)) / sizeof(PerfTraceSample);
+    samples.resize(count);
+    if (count > 0) std::memcpy(samples.data(), data + sizeof(header), count * sizeof(PerfTraceSample));
+    return true;
+}
+
+bool read_perf_trace(const std::wstring& path, PerfTraceHeader& header,
+                     std::vector<PerfTraceSample>& samples) {
+    std::FILE* file = open_wide(path, "rb");
+    if (!file) return false;
+    std::vector<uint8_t> bytes;
+    uint8_t chunk[16384];
+    for (size_t n; (n = std::fread(chunk, 1, sizeof(chunk), file)) > 0;) {
+        bytes.insert(bytes.end(), chunk, chunk + n);
+    }
+    std::fclose(file);
+    return parse_perf_trace(bytes.data(), bytes.size(), header, samples);
+}
+
+std::vector<PerfTraceSample> spread_perf_sample(const PerfTraceSample& s, uint32_t seconds) {
+    seconds = (std::clamp)(seconds, 1u, s.t_s + 1);
+    std::vector<PerfTraceSample> out(seconds, s);
+    auto share = [seconds](uint16_t total, uint32_t i) {
+        const uint32_t part = total / seconds;
+        return static_cast<uint16_t>(i + 1 < seconds ? part : total - part * (seconds - 1));
+    };
+    for (uint32_t i = 0; i < seconds; ++i) {
+        PerfTraceSample& o = out[i];
+        o.t_s        = s.t_s - (seconds - 1 - i);
+        o.frames_in  = share(s.frames_in, i);
+        o.frames_out = share(s.frames_out, i);
+        o.drops      = share(s.drops, i);
+        o.duplicates = share(s.duplicates, i);
+        o.unchanged  = share(s.unchanged, i);
+    }
+    return out;
+}
+
+std::vector<PerfTraceSample> bucket_perf_samples(const std::vector<PerfTraceSample>& samples,
+                                                 uint32_t seconds) {
+    if (seconds <= 1) return samples;
+    std::vector<PerfTraceSample> out;
+    for (size_t i = 0; i < samples.size();) {
+        const uint32_t bucket = samples[i].t_s / seconds;
+        PerfTraceSample b = samples[i];
+        b.t_s = bucket * seconds;
+        uint32_t in = 0, outf = 0, drops = 0, dups = 0, unchanged = 0;
+        uint64_t encode_weighted = 0, queue_weighted = 0, frames = 0;
+        bool all_paused = true;
+        for (; i < samples.size() && samples[i].t_s / seconds == bucket; ++i) {
+            const PerfTraceSample& s = samples[i];
+            in += s.frames_in;
+            outf += s.frames_out;
+            drops += s.drops;
+            dups += s.duplicates;
+            unchanged += s.unchanged;
+            encode_weighted += uint64_t{ s.encode_us_avg } * s.frames_out;
+            queue_weighted  += uint64_t{ s.queue_avg_x100 } * s.frames_out;
+            frames          += s.frames_out;
+            b.encode_us_max  = (std::max)(b.encode_us_max, s.encode_us_max);
+            b.queue_max      = (std::max)(b.queue_max, s.queue_max);
+            b.private_mb     = (std::max)(b.private_mb, s.private_mb);
+            b.working_set_mb = (std::max)(b.working_set_mb, s.working_set_mb);
+            b.gpu_local_mb   = (std::max)(b.gpu_local_mb, s.gpu_local_mb);
+            b.gpu_shared_mb  = (std::max)(b.gpu_shared_mb, s.gpu_shared_mb);
+            b.gpu_local_budget_mb  = s.gpu_local_budget_mb;
+            b.gpu_shared_budget_mb = s.gpu_shared_budget_mb;
+            b.encoder_mode   = s.encoder_mode;
+            b.quality_level  = s.quality_level;
+            b.flags          = s.flags;
+            all_paused = all_paused && (s.flags & kPerfTracePaused);
+        }
+        b.frames_in  = saturate16(in);
+        b.frames_out = saturate16(outf);
+        b.drops      = saturate16(drops);
+        b.duplicates = saturate16(dups);
+        b.unchanged  = saturate16(unchanged);
+        b.encode_us_avg  = frames > 0 ? saturate32(encode_weighted / frames) : 0;
+        b.queue_avg_x100 = frames > 0 ? saturate16(saturate32(queue_weighted / frames)) : 0;
+        b.flags = static_cast<uint8_t>((b.flags & ~kPerfTracePaused) | (all_paused ? kPerfTracePaused : 0));
+        out.push_back(b);
+    }
+    return out;
+}
+
+} // namespace sr
@@ -0,0 +1,191 @@
+#pragma once
+// perf_trace.h — Per-second binary performance trace beside each recording
+//
+// <name>.perftrace holds a PerfTraceHeader, then one PerfTraceSample per
+// recorded second. The layout is fixed and little-endian, about 200 KB an
+// hour, so "it stuttered at minute 37" can be looked up after the fact:
+// frames in (converted by capture) and out (encoded), drops, pacer
+// duplicates, unchanged skips, encode time, frame-queue depth, process and
+// GPU memory, power state, encoder mode and quality level.
+//
+// PerfTraceAccumulator collects per-frame encode stats lock-free on the
+// video-encode stage. The mux stage closes each second and hands the sample
+// to PerfTraceWriter, whose worker thread does the file I/O, so no pipeline
+// stage waits on the disk. tools/sr_trace_view renders a trace as a
+// timeline.
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace sr {
+
+constexpr uint16_t kPerfTraceVersion = 1;
+
+// PerfTraceSample::flags
+constexpr uint8_t kPerfTracePaused    = 1u << 0;  // paused when the second was sampled
+constexpr uint8_t kPerfTraceOnAc      = 1u << 1;
+constexpr uint8_t kPerfTraceMemory    = 1u << 2;  // private / working set valid
+constexpr uint8_t kPerfTraceGpuMemory = 1u << 3;  // gpu_* valid
+
+struct PerfTraceHeader {
+    char     magic[4]      = { 'S', 'R', 'P', 'T' };
+    uint16_t version       = kPerfTraceVersion;
+    uint16_t sample_size   = 0;   // sizeof(PerfTraceSample) of the writer
+    int64_t  start_unix_ms = 0;
+    uint32_t fps           = 0;   // target frame rate
+    uint32_t bitrate_bps   = 0;
+    uint16_t width         = 0;
+    uint16_t height        = 0;
+    uint32_t reserved      = 0;
+};
+
+struct PerfTraceSample {
+    uint32_t t_s           = 0;   // seconds since the recording started
+    uint16_t frames_in     = 0;   // converted by capture
+    uint16_t frames_out    = 0;   // encoded
+    uint16_t drops         = 0;   // NV12 ring / frame queue / pacer backpressure
+    uint16_t duplicates    = 0;   // pacer duplicates
+    uint16_t unchanged     = 0;   // unchanged frames not encoded
+    uint8_t  queue_max     = 0;   // frame-queue depth seen by the encoder, max
+    uint8_t  quality_level = 0;   // QualityGovernor level
+    uint32_t encode_us_avg = 0;
+    uint32_t encode_us_max = 0;
+    uint32_t private_mb    = 0;
+    uint32_t working_set_mb = 0;
+    uint32_t gpu_local_mb         = 0;
+    uint32_t gpu_local_budget_mb  = 0;
+    uint32_t gpu_shared_mb        = 0;
+    uint32_t gpu_shared_budget_mb = 0;
+    uint16_t queue_avg_x100 = 0;  // mean depth x 100
+    uint8_t  encoder_mode   = 0;  // TelemetrySnapshot::encoder_mode (0 HW, 1 SW, 2 SW 720p)
+    uint8_t  flags          = 0;  // kPerfTrace*
+    uint32_t reserved       = 0;
+};
+
+static_assert(sizeof(PerfTraceHeader) == 32, "on-disk layout");
+static_assert(sizeof(PerfTraceSample) == 56, "on-disk layout");
+static_assert(std::is_trivially_copyable_v<PerfTraceSample>, "written with fwrite");
+
+inline const char* perf_trace_mode_label(uint8_t mode) {
+    switch (mode) {
+        case 0:  return "HW";
+        case 1:  return "SW";
+        case 2:  return "SW720";
+        default: return "?";
+    }
+}
+
+// Running session totals; each sample carries the difference to the last
+struct PerfTraceCounters {
+    uint32_t captured   = 0;
+    uint32_t encoded    = 0;
+    uint32_t dropped    = 0;
+    uint32_t duplicated = 0;
+    uint32_t unchanged  = 0;
+};
+
+// Fills the frame counts of `s` from `now` - `prev` (saturated to 16 bits),
+// then prev = now
+void perf_trace_deltas(const PerfTraceCounters& now, PerfTraceCounters& prev, PerfTraceSample& s);
+
+// Per-frame encode time and queue depth of the current second
+class PerfTraceAccumulator {
+public:
+    // Video-encode stage, once per encoded frame
+    void on_encode(int64_t encode_us, size_t queue_depth) {
+        const uint64_t us = encode_us > 0 ? static_cast<uint64_t>(encode_us) : 0;
+        count_.fetch_add(1, std::memory_order_relaxed);
+        sum_us_.fetch_add(us, std::memory_order_relaxed);
+        depth_sum_.fetch_add(queue_depth, std::memory_order_relaxed);
+        raise(max_us_, us);
+        raise(depth_max_, queue_depth);
+    }
+
+    // Sampling thread: the stats since the last take() into `s`, then restart
+    void take(PerfTraceSample& s);
+
+    void reset() {
+        count_.store(0, std::memory_order_relaxed);
+        sum_us_.store(0, std::memory_order_relaxed);
+        max_us_.store(0, std::memory_order_relaxed);
+        depth_sum_.store(0, std::memory_order_relaxed);
+        depth_max_.store(0, std::memory_order_relaxed);
+    }
+
+private:
+    static void raise(std::atomic<uint64_t>& slot, uint64_t value) {
+        uint64_t seen = slot.load(std::memory_order_relaxed);
+        while (value > seen && !slot.compare_exchange_weak(seen, value, std::memory_order_relaxed)) {}
+    }
+
+    std::atomic<uint64_t> count_{ 0 };
+    std::atomic<uint64_t> sum_us_{ 0 };
+    std::atomic<uint64_t> max_us_{ 0 };
+    std::atomic<uint64_t> depth_sum_{ 0 };
+    std::atomic<uint64_t> depth_max_{ 0 };
+};
+
+class PerfTraceWriter {
+public:
+    // "<name>.mp4" -> "<name>.perftrace"
+    static std::wstring path_for_output(const std::wstring& output_path);
+
+    PerfTraceWriter() = default;
+    ~PerfTraceWriter() { close(); }
+    PerfTraceWriter(const PerfTraceWriter&) = delete;
+    PerfTraceWriter& operator=(const PerfTraceWriter&) = delete;
+
+    // Create the file and write the header (sample_size is filled in)
+    bool open(const std::wstring& path, PerfTraceHeader header);
+    bool is_open() const { return file_ != nullptr; }
+    const std::wstring& path() const { return path_; }
+
+    // Any thread; queues the sample for the worker, never touches the file
+    void append(const PerfTraceSample& sample);
+
+    // Write everything queued, stop the worker and close the file
+    void close();
+
+    uint32_t written() const { return written_.load(std::memory_order_relaxed); }
+
+private:
+    void run();
+
+    std::FILE*                   file_ = nullptr;
+    std::wstring                 path_;
+    std::mutex                   mutex_;
+    std::condition_variable      cv_;
+    std::vector<PerfTraceSample> pending_;
+    bool                         stopping_ = false;
+    std::thread                  worker_;
+    std::atomic<uint32_t>        written_{ 0 };
+};
+
+// Parse a trace image; false on a foreign magic, version or sample size. A
+// torn last sample (the recorder died mid-write) is ignored.
+bool parse_perf_trace(const uint8_t* data, size_t size, PerfTraceHeader& header,
+                      std::vector<PerfTraceSample>& samples);
+bool read_perf_trace(const std::wstring& path, PerfTraceHeader& header,
+                     std::vector<PerfTraceSample>& samples);
+
+// One sample per second for a sample that covers the `seconds` ending at
+// s.t_s (> 1 when the sampling loop stalled): counts are shared out evenly,
+// the remainder going to the last second; everything else is repeated
+std::vector<PerfTraceSample> spread_perf_sample(const PerfTraceSample& s, uint32_t seconds);
+
+// Fold consecutive samples into `seconds`-wide buckets: counts add up,
+// encode / queue means are frame-weighted, maxima and memory take the
+// largest value, mode / power / level come from the bucket's last sample and
+// Paused only when every sample was paused
+std::vector<PerfTraceSample> bucket_perf_samples(const std::vector<PerfTraceSample>& samples,
+                                                 uint32_t seconds);
+
+} // namespace sr
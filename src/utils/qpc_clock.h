@@ -1,62 +1,77 @@
 #pragma once
 // qpc_clock.h — High-resolution QPC timing wrappers
 // Provides nanosecond-resolution monotonic timestamps for A/V sync
+//
+// Every tick -> time conversion goes through qpc_ticks_to(): exact integer
+// math with no floating-point division. It splits ticks into whole seconds
+// and a remainder, so the result neither overflows nor drifts with uptime.
+// A double holds ~15.9 significant digits, so `now * 1e7 / freq` on an
+// absolute counter starts rounding sample times after a few days of uptime.
+//
+// Off Windows (the sr_core Linux build) the counter is CLOCK_MONOTONIC in
+// nanoseconds, i.e. a fixed 1 GHz "QPC frequency"; everything above it —
+// SyncManager, FramePacer, the histograms — is unchanged.
 
+#ifdef _WIN32
 #include <windows.h>
+#else
+#include <time.h>
+#endif
 #include <cstdint>
 
 namespace sr {
 
+// ticks * units_per_second / freq, truncated toward zero. The remainder term
+// is < freq * units_per_second, and that fits int64 for any QPC frequency
+// up to ~9 GHz even at nanosecond units.
+constexpr int64_t qpc_ticks_to(int64_t ticks, int64_t freq, int64_t units_per_second) {
+    const int64_t whole = ticks / freq;
+    const int64_t part  = ticks % freq;
+    return whole * units_per_second + part * units_per_second / freq;
+}
+
 class QPCClock {
 public:
     QPCClock() {
-        QueryPerformanceFrequency(&freq_);
+#ifdef _WIN32
+        LARGE_INTEGER f{};
+        QueryPerformanceFrequency(&f);
+        freq_ = f.QuadPart;
+#else
+        freq_ = 1'000'000'000;
+#endif
     }
 
-    // Current time in 100-nanosecond units (matches Media Foundation)
-    int64_t now_hns() const {
+    // Raw counter value
+    static int64_t ticks() {
+#ifdef _WIN32
         LARGE_INTEGER counter;
         QueryPerformanceCounter(&counter);
-        // Convert to 100ns units: counter * 10,000,000 / freq
-        return static_cast<int64_t>(
-            (static_cast<double>(counter.QuadPart) / freq_.QuadPart) * 10'000'000.0
-        );
+        return counter.QuadPart;
+#else
+        timespec ts{};
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return static_cast<int64_t>(ts.tv_sec) * 1'000'000'000 + ts.tv_nsec;
+#endif
     }
 
+    // Current time in 100-nanosecond units (matches Media Foundation)
+    int64_t now_hns() const { return ticks_to_hns(ticks()); }
+
     // Current time in nanoseconds
-    int64_t now_ns() const {
-        LARGE_INTEGER counter;
-        QueryPerformanceCounter(&counter);
-        return static_cast<int64_t>(
-            (static_cast<double>(counter.QuadPart) / freq_.QuadPart) * 1'000'000'000.0
-        );
-    }
+    int64_t now_ns() const { return qpc_ticks_to(ticks(), freq_, 1'000'000'000); }
 
     // Current time in microseconds
-    int64_t now_us() const {
-        LARGE_INTEGER counter;
-        QueryPerformanceCounter(&counter);
-        return static_cast<int64_t>(
-            (static_cast<double>(counter.QuadPart) / freq_.QuadPart) * 1'000'000.0
-        );
-    }
+    int64_t now_us() const { return qpc_ticks_to(ticks(), freq_, 1'000'000); }
 
-    // Current time in milliseconds
-    double now_ms() const {
-        LARGE_INTEGER counter;
-        QueryPerformanceCounter(&counter);
-        return (static_cast<double>(counter.QuadPart) / freq_.QuadPart) * 1000.0;
-    }
+    // Current time in milliseconds (UI timers; sub-ms part kept)
+    double now_ms() const { return static_cast<double>(now_us()) / 1000.0; }
 
-    // QPC frequency (ticks per second)
-    int64_t frequency() const { return freq_.QuadPart; }
+    // QPC frequency (ticks per second), read once
+    int64_t frequency() const { return freq_; }
 
-    // Convert QPC ticks to 100ns units
-    int64_t ticks_to_hns(int64_t ticks) const {
-        return static_cast<int64_t>(
-            (static_cast<double>(ticks) / freq_.QuadPart) * 10'000'000.0
-        );
-    }
+    // Convert QPC ticks (absolute or a difference) to 100ns units
+    int64_t ticks_to_hns(int64_t ticks) const { return qpc_ticks_to(ticks, freq_, 10'000'000); }
 
     // Singleton access for shared clock
     static const QPCClock& instance() {
@@ -65,7 +80,7 @@ public:
     }
 
 private:
-    LARGE_INTEGER freq_{};
+    int64_t freq_ = 1;
 };
 
 } // namespace sr
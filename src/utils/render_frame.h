@@ -3,22 +3,58 @@
 // Definitions from data-model.md
 
 #include <d3d11.h>
+#include <d3d11_4.h>
 #include <wrl/client.h>
+#include <atomic>
 #include <cstdint>
+#include <memory>
 #include <vector>
 #include <string>
+#include "utils/dirty_region.h"
+#include "utils/pcm_buffer_pool.h"
+#include "utils/video_codec.h"
 
 namespace sr {
 
 using Microsoft::WRL::ComPtr;
 
+// Per-frame pipeline timestamps (QPCClock microseconds; 0 = not stamped)
+struct FrameStamps {
+    int64_t arrival_us   = 0;   // WGC FrameArrived callback entered
+    int64_t converted_us = 0;   // VideoProcessorBlt submitted (or skipped for duplicates)
+    int64_t dequeued_us  = 0;   // popped by the video-encode stage
+};
+
+// Isolated capture device, reverse direction: the consumer signals this
+// fence (its device's handle) once its reads of a target's slots have been
+// submitted, and the capture engine reuses a released slot only after a
+// signal issued later than the release has completed.
+struct GpuReleaseFence {
+    ComPtr<ID3D11Fence>   fence;
+    std::atomic<uint64_t> issued{ 0 };   // last value handed to Signal
+
+    // Consumer: everything submitted on `context` so far is ordered before
+    // the next value
+    void signal(ID3D11DeviceContext4* context) {
+        if (fence && context) context->Signal(fence.Get(), issued.fetch_add(1, std::memory_order_acq_rel) + 1);
+    }
+};
+
 // Video frame from capture engine, GPU-backed
 struct RenderFrame {
     ComPtr<ID3D11Texture2D> texture;
     int64_t                 pts = 0;          // QPC ticks mapped to 100ns units
     uint32_t                width = 0;
     uint32_t                height = 0;
-    bool                    is_duplicate = false;
+    bool                    is_duplicate = false;  // content identical to the previous frame
+    bool                    overlay_only = false;  // only the drawn cursor / camera changed; dirty = their rects
+    DirtyRegion             dirty;                 // changed areas in output coordinates (if known)
+    FrameStamps             stamps;
+    // Isolated capture device: texture is ready once fence reaches fence_value;
+    // the consumer acknowledges its reads through `release`
+    ComPtr<ID3D11Fence>     fence;
+    uint64_t                fence_value = 0;
+    std::shared_ptr<GpuReleaseFence> release;
 
     RenderFrame() = default;
     RenderFrame(RenderFrame&&) noexcept = default;
@@ -27,12 +63,29 @@ struct RenderFrame {
     RenderFrame& operator=(const RenderFrame&) = delete;
 };
 
-// Audio packet from WASAPI or silence injector
+// Queue a GPU-side wait on the consumer's immediate context until the capture
+// device's conversion into f.texture has completed. No-op for unfenced frames
+// (capture shares the consumer's device and context, so order is implicit).
+inline void wait_for_gpu_producer(const RenderFrame& f, ID3D11DeviceContext4* context) {
+    if (f.fence && context) context->Wait(f.fence.Get(), f.fence_value);
+}
+
+// Consumer loop, once per pass before taking the next frame: acknowledge the
+// reads of every frame handled so far (`release` = the last frame's). Passes
+// without a frame keep acknowledging, so a released slot never waits on new
+// frames arriving.
+inline void release_gpu_reads(const std::shared_ptr<GpuReleaseFence>& release,
+                              ID3D11DeviceContext4* context) {
+    if (release) release->signal(context);
+}
+
+// Audio packet from WASAPI or silence injector.
+// buffer borrows a PcmBlockPool block from the producing AudioEngine.
 struct AudioPacket {
-    std::vector<uint8_t> buffer;
+    PcmBuffer            buffer;
     uint32_t             frame_count = 0;
     int64_t              pts = 0;             // 100ns units
-    bool                 is_silence = false;
+    bool                 is_silence = false;  // no payload: buffer is empty, frame_count is the duration
     uint32_t             sample_rate = 48000;
     uint16_t             channels = 2;
 
@@ -66,6 +119,9 @@ struct EncoderProfile {
     uint32_t gop_seconds = 2;
     bool     low_latency = true;
     uint32_t b_frames = 0;
+    uint32_t gop_frames = 0;  // IDR interval in frames; 0 = fps (about one second)
+    FrameRect source_crop;   // capture sub-rect in source pixels; empty = full surface
+    CodecPreference codec = CodecPreference::H264;  // bitrate_bps is H.264-equivalent
     // CBR by default, Baseline/Main profile
 };
 
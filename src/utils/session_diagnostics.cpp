@@ -1,9 +1,74 @@
 #include "utils/session_diagnostics.h"
+#include "utils/wide_path.h"
 
 #include <cstdio>
+#include <cwchar>
 
 namespace sr {
 
+namespace {
+
+#ifdef _WIN32
+FILE* open_text(const std::wstring& path, bool append) {
+    FILE* file = nullptr;
+    if (_wfopen_s(&file, path.c_str(), append ? L"a, ccs=UTF-8" : L"w, ccs=UTF-8") != 0) return nullptr;
+    return file;
+}
+
+void put_line(FILE* file, const std::wstring& line) {
+    fwprintf(file, L"%ls\n", line.c_str());
+}
+#else
+// wchar_t is UTF-32 here; the file is plain UTF-8 bytes
+FILE* open_text(const std::wstring& path, bool append) {
+    return open_wide(path, append ? "a" : "w");
+}
+
+void put_line(FILE* file, const std::wstring& line) {
+    const std::string bytes = to_utf8(line);
+    std::fwrite(bytes.data(), 1, bytes.size(), file);
+    std::fputc('\n', file);
+}
+#endif
+
+void append_json_string(std::string& out, const std::wstring& value) {
+    out += '"';
+    for (const char c : to_utf8(value)) {
+        switch (c) {
+            case '"':  out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    char esc[8];
+                    std::snprintf(esc, sizeof(esc), "\\u%04x", static_cast<unsigned>(c));
+                    out += esc;
+                } else {
+                    out += c;
+                }
+        }
+    }
+    out += '"';
+}
+
+void append_json_field(std::string& out, const char* key, const std::wstring& value) {
+    out += out.size() > 1 ? ",\"" : "\"";
+    out += key;
+    out += "\":";
+    append_json_string(out, value);
+}
+
+void append_json_field(std::string& out, const char* key, uint64_t value) {
+    out += out.size() > 1 ? ",\"" : "\"";
+    out += key;
+    out += "\":";
+    out += std::to_string(value);
+}
+
+} // namespace
+
 std::wstring SessionDiagnostics::path_for_output(const std::wstring& output_path) {
     const std::wstring mp4_suffix = L".mp4";
     if (output_path.size() >= mp4_suffix.size() &&
@@ -16,69 +81,117 @@ std::wstring SessionDiagnostics::path_for_output(const std::wstring& output_path
     return output_path + L".diagnostics.txt";
 }
 
+// %ls, not %s: only the Windows CRT reads a bare %s as a wide string
 std::wstring SessionDiagnostics::format_start_summary(const StartInfo& info) {
     wchar_t buf[2048]{};
-    _snwprintf_s(buf, _countof(buf), _TRUNCATE,
-                 L"event=session_start output=%s adapter=%s probed_encoder=%s "
-                 L"encoder_mode=%s power=%s quality=%s profile=%ux%u@%ufps %ubps",
-                 info.output_path.c_str(),
-                 info.adapter_name.empty() ? L"unknown" : info.adapter_name.c_str(),
-                 info.probed_encoder_name.empty() ? L"not available" : info.probed_encoder_name.c_str(),
-                 info.encoder_mode.empty() ? L"unknown" : info.encoder_mode.c_str(),
-                 info.power_state.empty() ? L"unknown" : info.power_state.c_str(),
-                 info.high_quality ? L"HQ" : L"Base",
-                 info.width,
-                 info.height,
-                 info.fps,
-                 info.bitrate_bps);
+    std::swprintf(buf, sizeof(buf) / sizeof(buf[0]),
+                  L"event=session_start output=%ls adapter=%ls probed_encoder=%ls "
+                  L"encoder_mode=%ls power=%ls quality=%ls profile=%ux%u@%ufps %ubps cross_adapter=%ls "
+                  L"split_encode=%ls",
+                  info.output_path.c_str(),
+                  info.adapter_name.empty() ? L"unknown" : info.adapter_name.c_str(),
+                  info.probed_encoder_name.empty() ? L"not available" : info.probed_encoder_name.c_str(),
+                  info.encoder_mode.empty() ? L"unknown" : info.encoder_mode.c_str(),
+                  info.power_state.empty() ? L"unknown" : info.power_state.c_str(),
+                  info.high_quality ? L"HQ" : L"Base",
+                  info.width,
+                  info.height,
+                  info.fps,
+                  info.bitrate_bps,
+                  info.cross_adapter ? L"yes" : L"no",
+                  info.split_encode ? L"yes" : L"no");
     return buf;
 }
 
 std::wstring SessionDiagnostics::format_stop_summary(const StopInfo& info) {
     wchar_t buf[1024]{};
-    _snwprintf_s(buf, _countof(buf), _TRUNCATE,
-                 L"event=session_stop status=%s frames_captured=%u frames_encoded=%u "
-                 L"frames_dropped=%u audio_packets=%u",
-                 info.status.empty() ? L"unknown" : info.status.c_str(),
-                 info.frames_captured,
-                 info.frames_encoded,
-                 info.frames_dropped,
-                 info.audio_packets);
+    std::swprintf(buf, sizeof(buf) / sizeof(buf[0]),
+                  L"event=session_stop status=%ls frames_captured=%u frames_encoded=%u "
+                  L"frames_dropped=%u audio_packets=%u",
+                  info.status.empty() ? L"unknown" : info.status.c_str(),
+                  info.frames_captured,
+                  info.frames_encoded,
+                  info.frames_dropped,
+                  info.audio_packets);
     return buf;
 }
 
+int SessionDiagnostics::exit_code(const Summary& summary) {
+    if (!summary.started || !summary.stopped || !summary.failure.empty()) return kExitStartFailed;
+    return summary.stop.status == L"complete" ? kExitComplete : kExitPartialKept;
+}
+
+std::string SessionDiagnostics::format_json_summary(const Summary& summary,
+                                                    const std::vector<std::wstring>& files) {
+    const StartInfo& s = summary.start;
+    const StopInfo&  t = summary.stop;
+    std::string out = "{";
+    append_json_field(out, "status", summary.stopped ? t.status
+                                     : summary.started ? std::wstring(L"running") : std::wstring(L"failed"));
+    append_json_field(out, "exit_code", static_cast<uint64_t>(exit_code(summary)));
+    append_json_field(out, "failure", summary.failure);
+    append_json_field(out, "output", s.output_path);
+    append_json_field(out, "diagnostics", summary.diagnostics_path);
+    append_json_field(out, "adapter", s.adapter_name);
+    append_json_field(out, "encoder_mode", s.encoder_mode);
+    append_json_field(out, "power", s.power_state);
+    append_json_field(out, "quality", std::wstring(s.high_quality ? L"HQ" : L"Base"));
+    append_json_field(out, "width", s.width);
+    append_json_field(out, "height", s.height);
+    append_json_field(out, "fps", s.fps);
+    append_json_field(out, "bitrate_bps", s.bitrate_bps);
+    append_json_field(out, "frames_captured", t.frames_captured);
+    append_json_field(out, "frames_encoded", t.frames_encoded);
+    append_json_field(out, "frames_dropped", t.frames_dropped);
+    append_json_field(out, "audio_packets", t.audio_packets);
+    out += ",\"files\":[";
+    for (size_t i = 0; i < files.size(); ++i) {
+        if (i > 0) out += ',';
+        append_json_string(out, files[i]);
+    }
+    out += "]}";
+    return out;
+}
+
 bool SessionDiagnostics::open_for_output(const std::wstring& output_path) {
+    summary_ = Summary{};
     path_ = path_for_output(output_path);
-    FILE* file = nullptr;
-    if (_wfopen_s(&file, path_.c_str(), L"w, ccs=UTF-8") != 0 || !file) {
+    FILE* file = open_text(path_, false);
+    if (!file) {
         path_.clear();
         return false;
     }
-    fwprintf(file, L"ScreenRecorder diagnostics\n");
+    summary_.diagnostics_path = path_;
+    put_line(file, L"ScreenRecorder diagnostics");
     fclose(file);
     return true;
 }
 
 void SessionDiagnostics::write_start(const StartInfo& info) {
+    summary_.started = true;
+    summary_.start   = info;
     append_line(format_start_summary(info));
 }
 
 void SessionDiagnostics::write_stop(const StopInfo& info) {
+    summary_.stopped = true;
+    summary_.stop    = info;
     append_line(format_stop_summary(info));
 }
 
 void SessionDiagnostics::write_failure(const std::wstring& reason) {
+    summary_.failure = reason;
     append_line(L"event=session_failure reason=" + (reason.empty() ? L"unknown" : reason));
 }
 
 void SessionDiagnostics::append_line(const std::wstring& line) const {
     if (path_.empty()) return;
 
-    FILE* file = nullptr;
-    if (_wfopen_s(&file, path_.c_str(), L"a, ccs=UTF-8") != 0 || !file) {
+    FILE* file = open_text(path_, true);
+    if (!file) {
         return;
     }
-    fwprintf(file, L"%s\n", line.c_str());
+    put_line(file, line);
     fclose(file);
 }
 
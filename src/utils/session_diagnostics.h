@@ -2,6 +2,7 @@
 
 #include <cstdint>
 #include <string>
+#include <vector>
 
 namespace sr {
 
@@ -14,6 +15,8 @@ public:
         std::wstring encoder_mode;
         std::wstring power_state;
         bool high_quality = false;
+        bool cross_adapter = false;  // WGC copying frames from another GPU
+        bool split_encode = false;   // capture on the display GPU, encode on another
         uint32_t width = 0;
         uint32_t height = 0;
         uint32_t fps = 0;
@@ -28,9 +31,30 @@ public:
         uint32_t audio_packets = 0;
     };
 
+    // Everything written for the current session, for callers that report
+    // it themselves (the headless mode's JSON summary and exit code)
+    struct Summary {
+        bool         started = false;   // write_start() ran
+        bool         stopped = false;   // write_stop() ran
+        StartInfo    start;
+        StopInfo     stop;
+        std::wstring failure;           // last write_failure() reason
+        std::wstring diagnostics_path;
+    };
+
+    // Process exit codes of a headless session
+    static constexpr int kExitComplete    = 0;
+    static constexpr int kExitUsage       = 1;   // bad command line (set by the caller)
+    static constexpr int kExitStartFailed = 2;   // not started, or a write_failure()
+    static constexpr int kExitPartialKept = 3;   // recorded, but finalizing failed
+
     static std::wstring path_for_output(const std::wstring& output_path);
     static std::wstring format_start_summary(const StartInfo& info);
     static std::wstring format_stop_summary(const StopInfo& info);
+    static int exit_code(const Summary& summary);
+    // One-line UTF-8 JSON object; `files` = the closed recording files
+    static std::string format_json_summary(const Summary& summary,
+                                           const std::vector<std::wstring>& files = {});
 
     bool open_for_output(const std::wstring& output_path);
     void write_start(const StartInfo& info);
@@ -38,11 +62,13 @@ public:
     void write_failure(const std::wstring& reason);
 
     const std::wstring& path() const { return path_; }
+    const Summary& summary() const { return summary_; }
 
 private:
     void append_line(const std::wstring& line) const;
 
     std::wstring path_;
+    Summary      summary_;
 };
 
 } // namespace sr
@@ -0,0 +1,90 @@
+#pragma once
+// thread_qos.h — Scheduling hints that keep the recording pipeline on time
+// under foreground load (games, builds)
+//
+//   MmcssScope                  registers the calling thread with an MMCSS task
+//                               ("Capture", "Audio", ...) for its lifetime;
+//                               a null task is a no-op
+//   set_thread_eco_qos_opt_out  per-thread: never run this thread under EcoQoS
+//   set_process_eco_qos_opt_out process-wide default for threads without a hint
+//   set_gpu_thread_priority     IDXGIDevice GPU scheduling priority (-7..7)
+//
+// EcoQoS lets Windows park a thread on efficiency cores at a low clock when
+// the window is not in the foreground — exactly the situation while recording
+// a game. Every call here is best-effort: failure is logged and ignored.
+
+#include <windows.h>
+#include <avrt.h>
+#include <dxgi.h>
+#include <wrl/client.h>
+#include "utils/logging.h"
+#pragma comment(lib, "avrt.lib")
+
+namespace sr {
+
+class MmcssScope {
+public:
+    explicit MmcssScope(const wchar_t* task, AVRT_PRIORITY priority = AVRT_PRIORITY_NORMAL) {
+        if (!task) return;
+        DWORD task_idx = 0;
+        handle_ = AvSetMmThreadCharacteristicsW(task, &task_idx);
+        if (!handle_) {
+            SR_LOG_WARN(L"MMCSS \"%s\" registration failed: %lu (non-fatal)", task, GetLastError());
+            return;
+        }
+        if (priority != AVRT_PRIORITY_NORMAL) AvSetMmThreadPriority(handle_, priority);
+    }
+    ~MmcssScope() {
+        if (handle_) AvRevertMmThreadCharacteristics(handle_);
+    }
+
+    bool active() const { return handle_ != nullptr; }
+
+    MmcssScope(const MmcssScope&)            = delete;
+    MmcssScope& operator=(const MmcssScope&) = delete;
+
+private:
+    HANDLE handle_ = nullptr;
+};
+
+// opt_out = true: always full speed / performance cores. false: hand the
+// decision back to the system.
+inline bool set_thread_eco_qos_opt_out(bool opt_out) {
+    THREAD_POWER_THROTTLING_STATE state{};
+    state.Version     = THREAD_POWER_THROTTLING_CURRENT_VERSION;
+    state.ControlMask = opt_out ? THREAD_POWER_THROTTLING_EXECUTION_SPEED : 0;
+    state.StateMask   = 0;
+    if (!SetThreadInformation(GetCurrentThread(), ThreadPowerThrottling, &state, sizeof(state))) {
+        SR_LOG_DEBUG(L"ThreadPowerThrottling not applied: %lu", GetLastError());
+        return false;
+    }
+    return true;
+}
+
+inline bool set_process_eco_qos_opt_out(bool opt_out) {
+    PROCESS_POWER_THROTTLING_STATE state{};
+    state.Version     = PROCESS_POWER_THROTTLING_CURRENT_VERSION;
+    state.ControlMask = opt_out ? PROCESS_POWER_THROTTLING_EXECUTION_SPEED : 0;
+    state.StateMask   = 0;
+    if (!SetProcessInformation(GetCurrentProcess(), ProcessPowerThrottling, &state, sizeof(state))) {
+        SR_LOG_DEBUG(L"ProcessPowerThrottling not applied: %lu", GetLastError());
+        return false;
+    }
+    return true;
+}
+
+// Priority of this device's GPU work relative to other processes. Values
+// above 0 need SeIncreaseBasePriorityPrivilege on some drivers and fail
+// harmlessly without it.
+inline bool set_gpu_thread_priority(IUnknown* device, INT priority) {
+    Microsoft::WRL::ComPtr<IDXGIDevice> dxgi;
+    if (!device || FAILED(device->QueryInterface(IID_PPV_ARGS(&dxgi)))) return false;
+    const HRESULT hr = dxgi->SetGPUThreadPriority(priority);
+    if (FAILED(hr)) {
+        SR_LOG_WARN(L"SetGPUThreadPriority(%d) failed: 0x%08X (non-fatal)", priority, hr);
+        return false;
+    }
+    return true;
+}
+
+} // namespace sr
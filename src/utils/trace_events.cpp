@@ -0,0 +1,24 @@
+#include "utils/trace_events.h"
+
+#pragma comment(lib, "advapi32.lib")
+
+namespace sr {
+
+// {99413329-9a13-4c94-9c78-ee4cc8958912}
+TRACELOGGING_DEFINE_PROVIDER(
+    g_trace_provider,
+    "ScreenRecorder.Pipeline",
+    (0x99413329, 0x9a13, 0x4c94, 0x9c, 0x78, 0xee, 0x4c, 0xc8, 0x95, 0x89, 0x12));
+
+namespace trace {
+
+bool register_provider() {
+    return SUCCEEDED(TraceLoggingRegister(g_trace_provider));
+}
+
+void unregister_provider() {
+    TraceLoggingUnregister(g_trace_provider);
+}
+
+} // namespace trace
+} // namespace sr
@@ -0,0 +1,137 @@
+#pragma once
+// trace_events.h — TraceLogging (ETW) provider for pipeline events
+//
+// Provider "ScreenRecorder.Pipeline" {99413329-9a13-4c94-9c78-ee4cc8958912}.
+// Record it next to the kernel GPU/DWM providers, e.g.
+//   xperf -start SR -on 99413329-9a13-4c94-9c78-ee4cc8958912 -f sr.etl
+//   wpr -start GPU            (or log.cmd for GPUView)
+// then merge the traces and open them in WPA or GPUView: capture stalls line
+// up with present/VSync and encoder engine activity on one timeline.
+//
+// TraceLoggingWrite tests the provider's enable state before evaluating any
+// field, so with no session listening each call is one load and a branch —
+// unlike SR_LOG_*, which always formats. TelemetryStore keeps the in-app
+// counters; these events are the per-frame detail behind them.
+//
+// Every event carries the PTS (100 ns, session-relative) and the depth of the
+// queue the item is entering or leaving. Keywords select the stream:
+//   Video (0x1): FrameArrived, VpBlt, FrameEnqueued, FrameDropped, EncodeStart/Stop
+//   Audio (0x2): AudioPacket, AudioDropped
+//   Mux   (0x4): SinkWrite
+
+#include <windows.h>
+#include <TraceLoggingProvider.h>
+#include <winmeta.h>
+#include <cstdint>
+
+namespace sr {
+
+TRACELOGGING_DECLARE_PROVIDER(g_trace_provider);
+
+namespace trace {
+
+constexpr uint64_t kKeywordVideo = 0x1;
+constexpr uint64_t kKeywordAudio = 0x2;
+constexpr uint64_t kKeywordMux   = 0x4;
+
+// Track ids in SinkWrite / AudioPacket
+enum class Track : uint8_t { Video = 0, Audio = 1, SystemAudio = 2, Proxy = 3, Microphone = 4, Loopback = 5 };
+
+// Process start / exit (main). Until register_provider() every write is a no-op.
+bool register_provider();
+void unregister_provider();
+
+inline bool enabled(uint64_t keyword = 0) {
+    return TraceLoggingProviderEnabled(g_trace_provider, WINEVENT_LEVEL_VERBOSE, keyword);
+}
+
+// --- Video (capture + encode stages) ---------------------------------------
+
+// WGC FrameArrived callback entry, before any GPU work
+inline void frame_arrived(int64_t arrival_us, size_t queue_depth) {
+    TraceLoggingWrite(g_trace_provider, "FrameArrived",
+        TraceLoggingLevel(WINEVENT_LEVEL_VERBOSE), TraceLoggingKeyword(kKeywordVideo),
+        TraceLoggingInt64(arrival_us, "ArrivalUs"),
+        TraceLoggingUInt32(static_cast<uint32_t>(queue_depth), "QueueDepth"));
+}
+
+// BGRA -> NV12 VideoProcessorBlt submitted (the event time is its end)
+inline void vp_blt(int64_t arrival_us, int64_t since_arrival_us, uint32_t slot) {
+    TraceLoggingWrite(g_trace_provider, "VpBlt",
+        TraceLoggingLevel(WINEVENT_LEVEL_VERBOSE), TraceLoggingKeyword(kKeywordVideo),
+        TraceLoggingInt64(arrival_us, "ArrivalUs"),
+        TraceLoggingInt64(since_arrival_us, "SinceArrivalUs"),
+        TraceLoggingUInt32(slot, "Slot"));
+}
+
+// Frame handed to the encode stage's FrameQueue
+inline void frame_enqueued(int64_t pts, size_t queue_depth, bool unchanged) {
+    TraceLoggingWrite(g_trace_provider, "FrameEnqueued",
+        TraceLoggingLevel(WINEVENT_LEVEL_VERBOSE), TraceLoggingKeyword(kKeywordVideo),
+        TraceLoggingInt64(pts, "Pts"),
+        TraceLoggingUInt32(static_cast<uint32_t>(queue_depth), "QueueDepth"),
+        TraceLoggingBool(unchanged, "Unchanged"));
+}
+
+// reason: "ring_full", "queue_full", "pacer_backpressure". pts -1 = dropped
+// before it was stamped (NV12 ring exhausted ahead of the blit)
+inline void frame_dropped(int64_t pts, size_t queue_depth, const char* reason) {
+    TraceLoggingWrite(g_trace_provider, "FrameDropped",
+        TraceLoggingLevel(WINEVENT_LEVEL_INFO), TraceLoggingKeyword(kKeywordVideo),
+        TraceLoggingInt64(pts, "Pts"),
+        TraceLoggingUInt32(static_cast<uint32_t>(queue_depth), "QueueDepth"),
+        TraceLoggingString(reason, "Reason"));
+}
+
+inline void encode_start(int64_t pts, size_t queue_depth) {
+    TraceLoggingWrite(g_trace_provider, "Encode",
+        TraceLoggingLevel(WINEVENT_LEVEL_VERBOSE), TraceLoggingKeyword(kKeywordVideo),
+        TraceLoggingOpcode(WINEVENT_OPCODE_START),
+        TraceLoggingInt64(pts, "Pts"),
+        TraceLoggingUInt32(static_cast<uint32_t>(queue_depth), "QueueDepth"));
+}
+
+// out_depth: encoded-sample queue to the mux stage
+inline void encode_stop(int64_t pts, size_t out_depth, bool produced) {
+    TraceLoggingWrite(g_trace_provider, "Encode",
+        TraceLoggingLevel(WINEVENT_LEVEL_VERBOSE), TraceLoggingKeyword(kKeywordVideo),
+        TraceLoggingOpcode(WINEVENT_OPCODE_STOP),
+        TraceLoggingInt64(pts, "Pts"),
+        TraceLoggingUInt32(static_cast<uint32_t>(out_depth), "QueueDepth"),
+        TraceLoggingBool(produced, "Produced"));
+}
+
+// --- Audio (WASAPI capture threads) ----------------------------------------
+
+inline void audio_packet(Track source, int64_t pts, uint32_t frames, size_t queue_depth, bool silence) {
+    TraceLoggingWrite(g_trace_provider, "AudioPacket",
+        TraceLoggingLevel(WINEVENT_LEVEL_VERBOSE), TraceLoggingKeyword(kKeywordAudio),
+        TraceLoggingUInt8(static_cast<uint8_t>(source), "Track"),
+        TraceLoggingInt64(pts, "Pts"),
+        TraceLoggingUInt32(frames, "Frames"),
+        TraceLoggingUInt32(static_cast<uint32_t>(queue_depth), "QueueDepth"),
+        TraceLoggingBool(silence, "Silence"));
+}
+
+inline void audio_dropped(Track source, int64_t pts, size_t queue_depth) {
+    TraceLoggingWrite(g_trace_provider, "AudioDropped",
+        TraceLoggingLevel(WINEVENT_LEVEL_INFO), TraceLoggingKeyword(kKeywordAudio),
+        TraceLoggingUInt8(static_cast<uint8_t>(source), "Track"),
+        TraceLoggingInt64(pts, "Pts"),
+        TraceLoggingUInt32(static_cast<uint32_t>(queue_depth), "QueueDepth"));
+}
+
+// --- Mux stage ---------------------------------------------------------------
+
+// One sample written to the sink (file, or the replay ring)
+inline void sink_write(Track track, int64_t pts, uint32_t bytes, size_t queue_depth) {
+    TraceLoggingWrite(g_trace_provider, "SinkWrite",
+        TraceLoggingLevel(WINEVENT_LEVEL_VERBOSE), TraceLoggingKeyword(kKeywordMux),
+        TraceLoggingUInt8(static_cast<uint8_t>(track), "Track"),
+        TraceLoggingInt64(pts, "Pts"),
+        TraceLoggingUInt32(bytes, "Bytes"),
+        TraceLoggingUInt32(static_cast<uint32_t>(queue_depth), "QueueDepth"));
+}
+
+} // namespace trace
+} // namespace sr
@@ -0,0 +1,55 @@
+#pragma once
+// triple_buffer.h — Lock-free latest-value hand-off, one producer / one consumer
+//
+// The producer fills back() and publish()es it; the consumer update()s to the
+// newest published slot and reads front(). One atomic word holds the index of
+// the spare slot plus a "fresh" bit, and each side swaps its own slot with it,
+// so neither side ever waits on the other. The third slot is what makes the
+// swap safe: with two, a producer that laps the consumer would write into the
+// buffer still being read.
+//
+// Slots are reused, so e.g. a std::vector payload stops allocating once it
+// has reached the frame size.
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+namespace sr {
+
+template <typename T>
+class TripleBuffer {
+public:
+    // Producer side
+    T& back() { return slots_[back_]; }
+    void publish() {
+        back_ = state_.exchange(back_ | kFresh, std::memory_order_acq_rel) & kIndexMask;
+    }
+
+    // Consumer side: true when front() moved to a newer value
+    bool update() {
+        if (!(state_.load(std::memory_order_relaxed) & kFresh)) return false;
+        front_ = state_.exchange(front_, std::memory_order_acq_rel) & kIndexMask;
+        return true;
+    }
+    const T& front() const { return slots_[front_]; }
+
+    // Reset every slot to `value`; only while neither side is active
+    void reset(const T& value = T{}) {
+        slots_.fill(value);
+        back_  = 0;
+        front_ = 2;
+        state_.store(1, std::memory_order_relaxed);
+    }
+
+private:
+    static constexpr uint32_t kIndexMask = 0x3;
+    static constexpr uint32_t kFresh     = 0x4;
+
+    std::array<T, 3>      slots_{};
+    uint32_t              back_  = 0;    // producer-owned
+    std::atomic<uint32_t> state_{ 1 };   // spare slot | kFresh
+    uint32_t              front_ = 2;    // consumer-owned
+};
+
+} // namespace sr
@@ -0,0 +1,49 @@
+#pragma once
+// wide_path.h — Opening std::wstring paths from the platform-neutral core
+//
+// Windows paths are UTF-16 and go to _wfopen; elsewhere wchar_t is UTF-32
+// and the file system takes UTF-8 bytes.
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+namespace sr {
+
+inline std::string to_utf8(const std::wstring& s) {
+    std::string out;
+    out.reserve(s.size());
+    for (wchar_t wc : s) {
+        const auto c = static_cast<uint32_t>(wc);
+        if (c < 0x80) {
+            out += static_cast<char>(c);
+        } else if (c < 0x800) {
+            out += static_cast<char>(0xC0 | (c >> 6));
+            out += static_cast<char>(0x80 | (c & 0x3F));
+        } else if (c < 0x10000) {
+            out += static_cast<char>(0xE0 | (c >> 12));
+            out += static_cast<char>(0x80 | ((c >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (c & 0x3F));
+        } else {
+            out += static_cast<char>(0xF0 | (c >> 18));
+            out += static_cast<char>(0x80 | ((c >> 12) & 0x3F));
+            out += static_cast<char>(0x80 | ((c >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (c & 0x3F));
+        }
+    }
+    return out;
+}
+
+// fopen with an ASCII `mode` ("rb", "wb", ...); nullptr on failure
+inline std::FILE* open_wide(const std::wstring& path, const char* mode) {
+#ifdef _WIN32
+    std::wstring wmode;
+    for (const char* m = mode; *m; ++m) wmode += static_cast<wchar_t>(*m);
+    std::FILE* file = nullptr;
+    return _wfopen_s(&file, path.c_str(), wmode.c_str()) == 0 ? file : nullptr;
+#else
+    return std::fopen(to_utf8(path).c_str(), mode);
+#endif
+}
+
+} // namespace sr
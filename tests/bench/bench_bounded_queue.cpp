@@ -0,0 +1,91 @@
+// bench_bounded_queue.cpp — BoundedQueue push/pop throughput and contention
+
+#include <benchmark/benchmark.h>
+#include "utils/bounded_queue.h"
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using sr::BoundedQueue;
+using sr::MultiProducer;
+using sr::SingleProducer;
+
+// Uncontended round trip: the cost every stage pays per item
+template <typename Policy>
+void BM_Queue_PushPop(benchmark::State& state) {
+    BoundedQueue<uint64_t, 16, Policy> q;
+    uint64_t v = 0;
+    for (auto _ : state) {
+        q.try_push(uint64_t{ v++ });
+        auto out = q.try_pop();
+        benchmark::DoNotOptimize(out);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK_TEMPLATE(BM_Queue_PushPop, MultiProducer);
+BENCHMARK_TEMPLATE(BM_Queue_PushPop, SingleProducer);
+
+// N producers (benchmark threads) against one draining consumer thread, the
+// shape of the audio queues (mic + loopback) and the encoded-sample queues.
+// Items/s counts successful pushes; a full queue is a drop, like the callers.
+std::atomic<bool>     g_consumer_run{ false };
+std::thread           g_consumer;
+BoundedQueue<uint64_t, 16>* g_shared = nullptr;
+
+void BM_Queue_MultiProducerContention(benchmark::State& state) {
+    if (state.thread_index() == 0) {
+        g_shared = new BoundedQueue<uint64_t, 16>();
+        g_consumer_run.store(true);
+        g_consumer = std::thread([] {
+            while (g_consumer_run.load(std::memory_order_relaxed)) {
+                if (auto v = g_shared->wait_pop(std::chrono::milliseconds(1))) benchmark::DoNotOptimize(*v);
+            }
+            while (g_shared->try_pop()) {}
+        });
+    }
+    uint64_t pushed = 0, dropped = 0;
+    for (auto _ : state) {
+        if (g_shared->try_push(uint64_t{ pushed })) ++pushed;
+        else ++dropped;
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(pushed));
+    state.counters["drop_pct"] = benchmark::Counter(
+        pushed + dropped ? 100.0 * static_cast<double>(dropped) / static_cast<double>(pushed + dropped) : 0.0,
+        benchmark::Counter::kAvgThreads);
+    if (state.thread_index() == 0) {
+        g_consumer_run.store(false);
+        g_consumer.join();
+        delete g_shared;
+        g_shared = nullptr;
+    }
+}
+BENCHMARK(BM_Queue_MultiProducerContention)->Threads(1)->Threads(2)->Threads(4)->UseRealTime();
+
+// Single producer waking a consumer parked in wait_pop (WGC callback -> encode stage)
+template <typename Policy>
+void BM_Queue_WakeParkedConsumer(benchmark::State& state) {
+    BoundedQueue<uint64_t, 3, Policy> q;
+    BoundedQueue<uint64_t, 3, Policy> ack;
+    std::atomic<bool> run{ true };
+    std::thread consumer([&] {
+        while (run.load(std::memory_order_relaxed)) {
+            if (auto v = q.wait_pop(std::chrono::milliseconds(5))) ack.try_push(uint64_t{ *v });
+        }
+    });
+    uint64_t v = 0;
+    for (auto _ : state) {
+        while (!q.try_push(uint64_t{ v })) {}
+        while (!ack.try_pop()) {}
+        ++v;
+    }
+    run.store(false);
+    consumer.join();
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK_TEMPLATE(BM_Queue_WakeParkedConsumer, MultiProducer)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_Queue_WakeParkedConsumer, SingleProducer)->UseRealTime();
+
+} // namespace
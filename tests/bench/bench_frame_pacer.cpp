@@ -0,0 +1,52 @@
+// bench_frame_pacer.cpp — FramePacer::pace_frame per-frame cost
+
+#include <benchmark/benchmark.h>
+#include "sync/frame_pacer.h"
+#include <cstdint>
+#include <random>
+#include <vector>
+
+namespace {
+
+// Steady 60 fps input: the common path, no duplicates or drops
+void BM_FramePacer_Steady(benchmark::State& state) {
+    sr::FramePacer pacer;
+    pacer.initialize(60);
+    constexpr int64_t kInterval = 10'000'000 / 60;
+    int64_t pts = 0;
+    for (auto _ : state) {
+        int64_t out = 0;
+        auto action = pacer.pace_frame(pts, false, &out);
+        benchmark::DoNotOptimize(action);
+        benchmark::DoNotOptimize(out);
+        pts += kInterval;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_FramePacer_Steady);
+
+// WGC-like timestamps: +-4 ms jitter and a share of unchanged frames
+void BM_FramePacer_JitterAndUnchanged(benchmark::State& state) {
+    sr::FramePacer pacer;
+    pacer.initialize(60);
+    constexpr int64_t kInterval = 10'000'000 / 60;
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int64_t> jitter(-40'000, 40'000);
+    std::vector<int64_t> offsets(4096);
+    for (auto& o : offsets) o = jitter(rng);
+
+    int64_t  base = 0;
+    uint32_t i    = 0;
+    for (auto _ : state) {
+        int64_t out = 0;
+        const bool unchanged = (i % 4) == 0;
+        auto action = pacer.pace_frame(base + offsets[i & 4095], false, &out, unchanged);
+        benchmark::DoNotOptimize(action);
+        base += kInterval;
+        ++i;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_FramePacer_JitterAndUnchanged);
+
+} // namespace
@@ -0,0 +1,110 @@
+// bench_resampler.cpp — AudioResampler::process per 10 ms capture period
+// Off Windows only the polyphase filter runs (no Media Foundation backend).
+
+#include <benchmark/benchmark.h>
+#include "audio/polyphase_resampler.h"
+#ifdef _WIN32
+#include "audio/audio_resampler.h"
+#include <mfapi.h>
+#endif
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace {
+
+// One WASAPI period of a 44.1 kHz stereo device: 441 frames
+std::vector<uint8_t> make_period(uint32_t rate, uint16_t channels, uint32_t bits) {
+    const size_t frames = rate / 100;
+    std::vector<uint8_t> pcm(frames * channels * (bits / 8));
+    for (size_t f = 0; f < frames; ++f) {
+        const double s = std::sin(2.0 * 3.14159265358979 * 1000.0 * static_cast<double>(f) / rate) * 0.5;
+        for (uint16_t c = 0; c < channels; ++c) {
+            const size_t i = f * channels + c;
+            if (bits == 32) {
+                const float v = static_cast<float>(s);
+                std::memcpy(&pcm[i * 4], &v, 4);
+            } else {
+                const int16_t v = static_cast<int16_t>(s * 32767.0);
+                std::memcpy(&pcm[i * 2], &v, 2);
+            }
+        }
+    }
+    return pcm;
+}
+
+#ifdef _WIN32
+// Media Foundation is started once for the MFT backend runs
+struct MfSession {
+    MfSession()  { ok = SUCCEEDED(MFStartup(MF_VERSION)); }
+    ~MfSession() { if (ok) MFShutdown(); }
+    bool ok = false;
+};
+
+// range(0): input rate, range(1): bits (32 float / 16 int),
+// range(2): backend (0 native, 1 Media Foundation)
+void BM_AudioResampler_Process(benchmark::State& state) {
+    static MfSession mf;
+    const uint32_t in_rate = static_cast<uint32_t>(state.range(0));
+    const uint32_t bits    = static_cast<uint32_t>(state.range(1));
+    const auto backend = state.range(2) ? sr::ResamplerBackend::MediaFoundation
+                                        : sr::ResamplerBackend::Native;
+    if (backend == sr::ResamplerBackend::MediaFoundation && !mf.ok) {
+        state.SkipWithError("MFStartup failed");
+        return;
+    }
+
+    sr::AudioResampler rs;
+    if (!rs.initialize(in_rate, 2, bits, 48000, backend)) {
+        state.SkipWithError("resampler initialization failed");
+        return;
+    }
+    const auto period = make_period(in_rate, 2, bits);
+    std::vector<uint8_t> out;
+    out.reserve(period.size() * 2);
+    for (auto _ : state) {
+        out.clear();
+        rs.process(period.data(), static_cast<uint32_t>(period.size()), out);
+        benchmark::DoNotOptimize(out.data());
+    }
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(period.size()));
+    // The native backend falls back to the MFT for ratios it doesn't cover
+    state.SetLabel(rs.backend() == sr::ResamplerBackend::Native ? "native" : "mf");
+}
+BENCHMARK(BM_AudioResampler_Process)
+    ->ArgNames({ "rate", "bits", "mf" })
+    ->Args({ 44100, 32, 0 })->Args({ 44100, 16, 0 })->Args({ 96000, 32, 0 })
+    ->Args({ 44100, 32, 1 })->Args({ 44100, 16, 1 });
+#endif
+
+// The polyphase filter alone, per dot-product ISA
+void BM_Polyphase_Isa(benchmark::State& state) {
+    const auto isa = static_cast<sr::MixerIsa>(state.range(0));
+#if defined(SR_MIXER_X86)
+    if (isa == sr::MixerIsa::Avx2 && !sr::mixer::cpu_has_avx2()) {
+        state.SkipWithError("AVX2 not supported on this CPU");
+        return;
+    }
+#endif
+    sr::PolyphaseResampler rs;
+    if (!rs.initialize(44100, 48000, 2, 32, isa)) {
+        state.SkipWithError("ratio not supported");
+        return;
+    }
+    const auto period = make_period(44100, 2, 32);
+    std::vector<uint8_t> out;
+    out.reserve(period.size() * 2);
+    for (auto _ : state) {
+        out.clear();
+        rs.process(period.data(), period.size(), out);
+        benchmark::DoNotOptimize(out.data());
+    }
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(period.size()));
+}
+BENCHMARK(BM_Polyphase_Isa)->ArgName("isa")
+    ->Arg(static_cast<int>(sr::MixerIsa::Scalar))
+    ->Arg(static_cast<int>(sr::MixerIsa::Sse2))
+    ->Arg(static_cast<int>(sr::MixerIsa::Avx2));
+
+} // namespace
@@ -0,0 +1,18 @@
+#pragma once
+// perf_probes.h — Process-level probes for the integration perf gate
+//
+// allocation_count(): every global operator new since process start. The
+// counting hook lives in perf_probes.cpp, so only binaries that compile it
+// (the integration suites) pay for it.
+//
+// peak_working_set_bytes(): PeakWorkingSetSize on Windows, ru_maxrss on
+// Linux — the high-water mark, not the current working set.
+
+#include <cstdint>
+
+namespace sr::perf {
+
+uint64_t allocation_count();
+uint64_t peak_working_set_bytes();
+
+} // namespace sr::perf
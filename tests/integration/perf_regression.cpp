@@ -0,0 +1,202 @@
+// perf_regression.cpp — Perf gate: JSON trend report + baseline comparison
+//
+// Replays the T041 stability harness session (60 min at 30 fps, ±10 ms
+// jitter) and the T040 queue load, and writes what they cost:
+//
+//   pacer_ns_per_frame    FramePacer::pace_frame, best of 5 sessions
+//   queue_items_per_sec   SingleProducer BoundedQueue handoff to a parked consumer
+//   peak_working_set_mb   process high-water mark after the runs
+//   allocs_per_frame      heap allocations per frame on the steady-state path
+//                         (pace -> histogram -> queue), from the counting hook
+//
+// The report goes to $SR_PERF_REPORT (default perf_report.json in the working
+// directory). With $SR_PERF_BASELINE set to an earlier report — CMake passes
+// -DSR_PERF_BASELINE=<file> through — every metric past its threshold in
+// perf_report.h fails the test. Promote a report to the baseline by copying it.
+//
+// pacer_ns_per_frame is wall time of a single-threaded, CPU-bound loop: the
+// Windows thread CPU clock only advances per scheduler quantum.
+
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "perf_probes.h"
+#include "perf_report.h"
+#include "sync/frame_pacer.h"
+#include "utils/bounded_queue.h"
+#include "utils/latency_histogram.h"
+#include "utils/qpc_clock.h"
+
+namespace {
+
+constexpr uint32_t kFps          = 30;
+constexpr int64_t  kTarget100ns  = 10'000'000LL / kFps;
+constexpr int      kSessionFrames = 60 * 60 * kFps;   // 108000, as T041
+
+// The T041 capture timestamps: nominal interval plus ±10 ms of jitter
+std::vector<int64_t> simulated_session() {
+    std::mt19937_64 rng(0xDEADBEEF);
+    std::uniform_int_distribution<int64_t> jitter(-100'000LL, 100'000LL);
+    std::vector<int64_t> pts(kSessionFrames);
+    int64_t raw = 0;
+    for (auto& p : pts) {
+        raw += kTarget100ns + jitter(rng);
+        if (raw < 0) raw = 0;
+        p = raw;
+    }
+    return pts;
+}
+
+std::string env_or(const char* name, const char* fallback) {
+#ifdef _WIN32
+    char* value = nullptr;
+    size_t len = 0;
+    std::string out = fallback;
+    if (_dupenv_s(&value, &len, name) == 0 && value) out = value;
+    free(value);
+    return out;
+#else
+    const char* value = std::getenv(name);
+    return value ? value : fallback;
+#endif
+}
+
+double pacer_ns_per_frame(const std::vector<int64_t>& session) {
+    double best = 0.0;
+    for (int run = 0; run < 5; ++run) {
+        sr::FramePacer pacer;
+        pacer.initialize(kFps);
+        int64_t sink = 0;
+        const int64_t t0 = sr::QPCClock::instance().now_ns();
+        for (int64_t pts : session) {
+            int64_t out = 0;
+            pacer.pace_frame(pts, false, &out);
+            sink += out;
+        }
+        const int64_t t1 = sr::QPCClock::instance().now_ns();
+        EXPECT_GT(sink, 0);
+        const double ns = static_cast<double>(t1 - t0) / static_cast<double>(session.size());
+        if (run == 0 || ns < best) best = ns;
+    }
+    return best;
+}
+
+double allocs_per_frame(const std::vector<int64_t>& session) {
+    sr::FramePacer pacer;
+    pacer.initialize(kFps);
+    sr::LatencyHistogram histogram;
+    sr::BoundedQueue<int64_t, 16, sr::SingleProducer> queue;
+
+    const uint64_t before = sr::perf::allocation_count();
+    int64_t prev = 0;
+    for (int64_t pts : session) {
+        int64_t out = 0;
+        if (pacer.pace_frame(pts, queue.full(), &out) == sr::PaceAction::Drop) continue;
+        histogram.record((out - prev) / 10);
+        prev = out;
+        queue.try_push(std::move(out));
+        queue.try_pop();
+    }
+    return static_cast<double>(sr::perf::allocation_count() - before) / static_cast<double>(session.size());
+}
+
+double queue_items_per_sec() {
+    constexpr uint64_t kItems = 200'000;
+    sr::BoundedQueue<uint64_t, 16, sr::SingleProducer> queue;
+    const int64_t t0 = sr::QPCClock::instance().now_ns();
+    std::thread producer([&queue]() {
+        for (uint64_t i = 0; i < kItems;) {
+            uint64_t v = i;
+            if (queue.try_push(std::move(v))) ++i;
+            else std::this_thread::yield();
+        }
+    });
+    uint64_t received = 0;
+    while (received < kItems) {
+        if (queue.wait_pop(std::chrono::milliseconds(100)).has_value()) ++received;
+    }
+    producer.join();
+    const int64_t t1 = sr::QPCClock::instance().now_ns();
+    return static_cast<double>(kItems) * 1e9 / static_cast<double>(t1 - t0);
+}
+
+TEST(PerfReportTest, JsonRoundTrips) {
+    sr::perf::PerfReport r;
+    r.set("pacer_ns_per_frame", 1.5);
+    r.set("queue_items_per_sec", 2.5e6);
+    r.set("pacer_ns_per_frame", 1.25);   // overwrite keeps one entry
+    const auto parsed = sr::perf::PerfReport::parse(r.to_json());
+    ASSERT_TRUE(parsed.has_value());
+    ASSERT_EQ(parsed->metrics().size(), 2u);
+    EXPECT_DOUBLE_EQ(*parsed->get("pacer_ns_per_frame"), 1.25);
+    EXPECT_DOUBLE_EQ(*parsed->get("queue_items_per_sec"), 2.5e6);
+    EXPECT_FALSE(sr::perf::PerfReport::parse("{\"schema\": 1}").has_value());
+}
+
+TEST(PerfReportTest, FlagsOnlyRegressionsPastThreshold) {
+    sr::perf::PerfReport base;
+    base.set("pacer_ns_per_frame", 2.0);      // limit 2.0 * 1.25 + 0.5 = 3.0
+    base.set("queue_items_per_sec", 1e6);     // limit 0.75e6
+    base.set("allocs_per_frame", 0.0);        // limit 0.01
+    base.set("unknown_metric", 1.0);
+
+    sr::perf::PerfReport ok;
+    ok.set("pacer_ns_per_frame", 2.9);
+    ok.set("queue_items_per_sec", 0.8e6);
+    ok.set("allocs_per_frame", 0.0);
+    ok.set("unknown_metric", 100.0);          // no threshold: never gated
+    ok.set("peak_working_set_mb", 900.0);     // not in the baseline: skipped
+    EXPECT_TRUE(sr::perf::compare_perf_reports(base, ok).empty());
+
+    sr::perf::PerfReport bad;
+    bad.set("pacer_ns_per_frame", 3.1);
+    bad.set("queue_items_per_sec", 0.7e6);
+    bad.set("allocs_per_frame", 1.0);
+    const auto regressions = sr::perf::compare_perf_reports(base, bad);
+    ASSERT_EQ(regressions.size(), 3u);
+    EXPECT_EQ(regressions[0].rfind("pacer_ns_per_frame:", 0), 0u);
+}
+
+TEST(PerfRegressionGate, ReportAndCompareAgainstBaseline) {
+    const std::vector<int64_t> session = simulated_session();
+
+    sr::perf::PerfReport report;
+    report.set("pacer_ns_per_frame", pacer_ns_per_frame(session));
+    report.set("queue_items_per_sec", queue_items_per_sec());
+    report.set("allocs_per_frame", allocs_per_frame(session));
+    report.set("peak_working_set_mb",
+               static_cast<double>(sr::perf::peak_working_set_bytes()) / (1024.0 * 1024.0));
+
+    // The steady-state frame path is allocation-free by design (T036)
+    EXPECT_EQ(*report.get("allocs_per_frame"), 0.0);
+
+    const std::string report_path = env_or("SR_PERF_REPORT", "perf_report.json");
+    {
+        std::ofstream f(report_path, std::ios::trunc);
+        ASSERT_TRUE(f) << "cannot write " << report_path;
+        f << report.to_json();
+    }
+    std::cout << "[perf] " << report_path << "\n" << report.to_json();
+
+    const std::string baseline_path = env_or("SR_PERF_BASELINE", "");
+    if (baseline_path.empty()) return;
+    std::ifstream f(baseline_path);
+    ASSERT_TRUE(f) << "cannot read baseline " << baseline_path;
+    std::stringstream text;
+    text << f.rdbuf();
+    const auto baseline = sr::perf::PerfReport::parse(text.str());
+    ASSERT_TRUE(baseline.has_value()) << baseline_path << " is not a perf report";
+    for (const std::string& r : sr::perf::compare_perf_reports(*baseline, report)) {
+        ADD_FAILURE() << "perf regression: " << r;
+    }
+}
+
+} // namespace
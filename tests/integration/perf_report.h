@@ -0,0 +1,125 @@
+#pragma once
+// perf_report.h — JSON perf report + baseline comparison for the perf gate
+//
+// A report is a flat set of named metrics:
+//
+//   { "schema": 1, "metrics": { "pacer_ns_per_frame": 1.92, ... } }
+//
+// compare_perf_reports() checks a fresh report against a stored baseline
+// (an earlier report copied aside) and names every metric that moved past
+// its threshold in the bad direction. Metrics missing from either side are
+// skipped, so adding a metric does not invalidate old baselines.
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace sr::perf {
+
+enum class Better { Lower, Higher };
+
+struct MetricThreshold {
+    const char* name;
+    Better      better;
+    double      relative;   // allowed fractional move in the bad direction
+    double      absolute;   // plus this much slack (room for values near 0)
+};
+
+// Timing metrics get generous room: the gate catches "got slower", not noise
+inline constexpr MetricThreshold kPerfThresholds[] = {
+    { "pacer_ns_per_frame",   Better::Lower,  0.25, 0.5  },
+    { "queue_items_per_sec",  Better::Higher, 0.25, 0.0  },
+    { "peak_working_set_mb",  Better::Lower,  0.10, 4.0  },
+    { "allocs_per_frame",     Better::Lower,  0.0,  0.01 },
+};
+
+inline const MetricThreshold* find_threshold(const std::string& name) {
+    for (const auto& t : kPerfThresholds) {
+        if (name == t.name) return &t;
+    }
+    return nullptr;
+}
+
+class PerfReport {
+public:
+    void set(const std::string& name, double value) {
+        for (auto& m : metrics_) {
+            if (m.first == name) { m.second = value; return; }
+        }
+        metrics_.emplace_back(name, value);
+    }
+
+    std::optional<double> get(const std::string& name) const {
+        for (const auto& m : metrics_) {
+            if (m.first == name) return m.second;
+        }
+        return std::nullopt;
+    }
+
+    const std::vector<std::pair<std::string, double>>& metrics() const { return metrics_; }
+
+    std::string to_json() const {
+        std::string out = "{\n  \"schema\": 1,\n  \"metrics\": {";
+        char value[64];
+        for (size_t i = 0; i < metrics_.size(); ++i) {
+            std::snprintf(value, sizeof(value), "%.6g", metrics_[i].second);
+            out += i == 0 ? "\n" : ",\n";
+            out += "    \"" + metrics_[i].first + "\": " + value;
+        }
+        out += "\n  }\n}\n";
+        return out;
+    }
+
+    // Reads what to_json() writes. Nullopt for anything without a "metrics" object.
+    static std::optional<PerfReport> parse(const std::string& json) {
+        const size_t key = json.find("\"metrics\"");
+        if (key == std::string::npos) return std::nullopt;
+        size_t pos = json.find('{', key);
+        if (pos == std::string::npos) return std::nullopt;
+        PerfReport report;
+        for (++pos; pos < json.size();) {
+            const size_t open = json.find_first_of("\"}", pos);
+            if (open == std::string::npos) return std::nullopt;
+            if (json[open] == '}') return report;
+            const size_t close = json.find('"', open + 1);
+            const size_t colon = close == std::string::npos ? close : json.find(':', close);
+            if (colon == std::string::npos) return std::nullopt;
+            const char* start = json.c_str() + colon + 1;
+            char* end = nullptr;
+            const double value = std::strtod(start, &end);
+            if (end == start) return std::nullopt;
+            report.set(json.substr(open + 1, close - open - 1), value);
+            pos = static_cast<size_t>(end - json.c_str());
+        }
+        return std::nullopt;
+    }
+
+private:
+    std::vector<std::pair<std::string, double>> metrics_;
+};
+
+// One line per regressed metric, e.g.
+//   "pacer_ns_per_frame: 3.1 vs baseline 2.0 (limit 3)"
+inline std::vector<std::string> compare_perf_reports(const PerfReport& baseline, const PerfReport& current) {
+    std::vector<std::string> regressions;
+    for (const auto& [name, value] : current.metrics()) {
+        const MetricThreshold* t = find_threshold(name);
+        const std::optional<double> base = baseline.get(name);
+        if (!t || !base) continue;
+        const double limit = t->better == Better::Lower ? *base * (1.0 + t->relative) + t->absolute
+                                                        : *base * (1.0 - t->relative) - t->absolute;
+        const bool regressed = t->better == Better::Lower ? value > limit : value < limit;
+        if (!regressed) continue;
+        char line[256];
+        std::snprintf(line, sizeof(line), "%s: %.6g vs baseline %.6g (limit %.6g)",
+                      name.c_str(), value, *base, limit);
+        regressions.emplace_back(line);
+    }
+    return regressions;
+}
+
+} // namespace sr::perf
@@ -0,0 +1,729 @@
+// pipeline_bench.cpp — Offline end-to-end encode/mux benchmark with a synthetic source
+//
+// Drives VideoEncoder + MuxWriter headlessly, without WGC, so encoder changes
+// can be compared on any machine, including CI agents with no desktop. Each
+// selected encoder mode gets a fresh encoder and muxer and is fed the same
+// frames:
+//
+//   synthetic  ring of 8 NV12 textures holding a moving gradient and a noise
+//              block (never a static image, which every encoder makes free)
+//   --input    raw NV12 frames (width x height, tightly packed), looped
+//   --vp       BGRA source textures converted by VideoProcessorBlt each
+//              frame, as the capture path does
+//
+// Reported per mode: achieved fps, encode latency (submit -> encoded sample)
+// p50/p95/p99/max, process CPU time, per-engine GPU running time (PDH "GPU
+// Engine" counters) and muxed bytes. --json writes the same numbers for
+// automated comparison.
+//
+//   pipeline_bench --modes hw,sw --frames 600 --fps 60 --json results.json
+
+#include <windows.h>
+#include <d3d11.h>
+#include <mfapi.h>
+#include <mferror.h>
+#include <pdh.h>
+#include <wrl/client.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <cwchar>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "encoder/encoder_probe.h"
+#include "encoder/nv12_copy.h"
+#include "encoder/video_encoder.h"
+#include "storage/mux_writer.h"
+#include "utils/latency_histogram.h"
+#include "utils/logging.h"
+#include "utils/qpc_clock.h"
+#include "utils/video_codec.h"
+
+#pragma comment(lib, "pdh.lib")
+#pragma comment(lib, "winmm.lib")
+
+using Microsoft::WRL::ComPtr;
+using namespace sr;
+
+namespace {
+
+struct Options {
+    std::vector<EncoderMode> modes{ EncoderMode::HardwareMFT, EncoderMode::SoftwareMFT };
+    uint32_t        width       = 1920;
+    uint32_t        height      = 1080;
+    uint32_t        fps         = 60;
+    uint32_t        frames      = 600;
+    uint32_t        bitrate_bps = 8'000'000;
+    CodecPreference codec       = CodecPreference::H264;
+    bool            paced       = false;   // false = submit as fast as the encoder accepts
+    bool            use_vp      = false;
+    bool            keep_files  = false;
+    std::wstring    input_path;            // raw NV12; empty = synthetic
+    std::wstring    out_dir;
+    std::wstring    json_path;
+};
+
+struct ModeResult {
+    EncoderMode requested = EncoderMode::HardwareMFT;
+    EncoderMode final_mode = EncoderMode::HardwareMFT;
+    bool        ran       = false;
+    VideoCodec  codec     = VideoCodec::H264;
+    uint32_t    width = 0, height = 0;
+    uint32_t    frames_in  = 0;
+    uint32_t    frames_out = 0;
+    uint32_t    late_frames = 0;          // paced runs: submits more than one interval late
+    double      wall_s     = 0.0;
+    double      cpu_s      = 0.0;
+    uint64_t    lat_p50_us = 0, lat_p95_us = 0, lat_p99_us = 0, lat_max_us = 0;
+    uint64_t    bytes      = 0;
+    std::map<std::wstring, double> gpu_ms;  // engine type -> running time
+};
+
+void usage() {
+    fwprintf(stderr,
+        L"usage: pipeline_bench [options]\n"
+        L"  --modes hw,sw,sw720   encoder modes to run (default hw,sw)\n"
+        L"  --frames N            frames per mode (default 600)\n"
+        L"  --fps F               frame rate of the stream (default 60)\n"
+        L"  --paced               submit at F fps instead of as fast as possible\n"
+        L"  --size WxH            source/encode size (default 1920x1080)\n"
+        L"  --bitrate BPS         H.264-equivalent CBR target (default 8000000)\n"
+        L"  --codec h264|hevc|av1 hardware codec preference (default h264)\n"
+        L"  --vp                  feed BGRA through VideoProcessorBlt like capture does\n"
+        L"  --input FILE          raw NV12 frames at --size instead of the synthetic source\n"
+        L"  --out DIR             where the .mp4 files go (default %%TEMP%%)\n"
+        L"  --keep                keep the .mp4 files\n"
+        L"  --json FILE           also write results as JSON\n");
+}
+
+bool parse_modes(const std::wstring& list, std::vector<EncoderMode>& out) {
+    out.clear();
+    size_t start = 0;
+    while (start <= list.size()) {
+        const size_t comma = list.find(L',', start);
+        const std::wstring token = list.substr(start, comma == std::wstring::npos ? std::wstring::npos
+                                                                                   : comma - start);
+        if (token == L"hw")         out.push_back(EncoderMode::HardwareMFT);
+        else if (token == L"sw")    out.push_back(EncoderMode::SoftwareMFT);
+        else if (token == L"sw720") out.push_back(EncoderMode::SoftwareMFT720p);
+        else return false;
+        if (comma == std::wstring::npos) break;
+        start = comma + 1;
+    }
+    return !out.empty();
+}
+
+bool parse_args(int argc, wchar_t** argv, Options& o) {
+    for (int i = 1; i < argc; ++i) {
+        const std::wstring arg = argv[i];
+        auto value = [&]() -> const wchar_t* { return i + 1 < argc ? argv[++i] : nullptr; };
+        const wchar_t* v = nullptr;
+        if (arg == L"--paced")      { o.paced = true; continue; }
+        if (arg == L"--vp")         { o.use_vp = true; continue; }
+        if (arg == L"--keep")       { o.keep_files = true; continue; }
+        if (!(v = value())) return false;
+        if (arg == L"--modes") {
+            if (!parse_modes(v, o.modes)) return false;
+        } else if (arg == L"--frames") {
+            o.frames = static_cast<uint32_t>(wcstoul(v, nullptr, 10));
+        } else if (arg == L"--fps") {
+            o.fps = static_cast<uint32_t>(wcstoul(v, nullptr, 10));
+        } else if (arg == L"--size") {
+            if (swscanf_s(v, L"%ux%u", &o.width, &o.height) != 2) return false;
+        } else if (arg == L"--bitrate") {
+            o.bitrate_bps = static_cast<uint32_t>(wcstoul(v, nullptr, 10));
+        } else if (arg == L"--codec") {
+            const std::wstring c = v;
+            if (c == L"h264")      o.codec = CodecPreference::H264;
+            else if (c == L"hevc") o.codec = CodecPreference::HEVC;
+            else if (c == L"av1")  o.codec = CodecPreference::AV1;
+            else return false;
+        } else if (arg == L"--input") {
+            o.input_path = v;
+        } else if (arg == L"--out") {
+            o.out_dir = v;
+        } else if (arg == L"--json") {
+            o.json_path = v;
+        } else {
+            return false;
+        }
+    }
+    // NV12 needs even dimensions
+    return o.frames > 0 && o.fps > 0 && o.width >= 64 && o.height >= 64 &&
+           (o.width % 2) == 0 && (o.height % 2) == 0;
+}
+
+// ---------------------------------------------------------------------------
+// Frame source
+// ---------------------------------------------------------------------------
+
+class FrameSource {
+public:
+    static constexpr size_t kRingSize = 8;
+
+    // Textures are created at the encoder's output size: the SW path copies
+    // them with CopyResource and takes no scaling.
+    bool initialize(ID3D11Device* device, ID3D11DeviceContext* context,
+                    uint32_t width, uint32_t height, bool use_vp, const std::wstring& input_path) {
+        device_  = device;
+        context_ = context;
+        width_   = width;
+        height_  = height;
+
+        std::vector<std::vector<uint8_t>> frames;
+        if (!input_path.empty()) {
+            if (!load_raw(input_path, frames)) return false;
+        } else {
+            for (size_t i = 0; i < kRingSize; ++i) frames.push_back(make_nv12(static_cast<uint32_t>(i)));
+        }
+
+        D3D11_TEXTURE2D_DESC td{};
+        td.Width            = width;
+        td.Height           = height;
+        td.MipLevels        = 1;
+        td.ArraySize        = 1;
+        td.Format           = DXGI_FORMAT_NV12;
+        td.SampleDesc.Count = 1;
+        td.Usage            = D3D11_USAGE_DEFAULT;
+        td.BindFlags        = D3D11_BIND_RENDER_TARGET | D3D11_BIND_VIDEO_ENCODER;
+
+        nv12_.resize(use_vp ? kRingSize : frames.size());
+        for (size_t i = 0; i < nv12_.size(); ++i) {
+            D3D11_SUBRESOURCE_DATA init{};
+            D3D11_SUBRESOURCE_DATA* pinit = nullptr;
+            if (!use_vp) {
+                init.pSysMem     = frames[i].data();
+                init.SysMemPitch = width;
+                pinit = &init;
+            }
+            const HRESULT hr = device_->CreateTexture2D(&td, pinit, nv12_[i].GetAddressOf());
+            if (FAILED(hr)) {
+                SR_LOG_ERROR(L"[Bench] CreateTexture2D(NV12[%zu]) failed: 0x%08X", i, hr);
+                return false;
+            }
+        }
+        return use_vp ? setup_vp(frames) : true;
+    }
+
+    // Texture for frame `index`; with --vp this runs the BGRA->NV12 blit
+    ID3D11Texture2D* frame(uint32_t index) {
+        if (!vp_) return nv12_[index % nv12_.size()].Get();
+
+        const size_t out = index % nv12_.size();
+        D3D11_VIDEO_PROCESSOR_STREAM stream{};
+        stream.Enable        = TRUE;
+        stream.pInputSurface = vp_in_[index % vp_in_.size()].Get();
+        const HRESULT hr = video_context_->VideoProcessorBlt(vp_.Get(), vp_out_[out].Get(), 0, 1, &stream);
+        if (FAILED(hr)) {
+            SR_LOG_ERROR(L"[Bench] VideoProcessorBlt failed: 0x%08X", hr);
+            return nullptr;
+        }
+        return nv12_[out].Get();
+    }
+
+private:
+    // Diagonal gradient scrolling by 8 px per frame plus a 256x256 noise block
+    // that moves across the frame, so every frame has new detail to encode.
+    std::vector<uint8_t> make_nv12(uint32_t phase) const {
+        std::vector<uint8_t> buf(nv12_tight_size(width_, height_));
+        uint8_t* y = buf.data();
+        for (uint32_t row = 0; row < height_; ++row) {
+            for (uint32_t col = 0; col < width_; ++col) {
+                y[row * width_ + col] = static_cast<uint8_t>(col + row + phase * 8);
+            }
+        }
+        uint32_t rng = 0x9E3779B9u ^ phase;
+        const uint32_t bx = (phase * width_ / kRingSize) % (width_ > 256 ? width_ - 256 : 1);
+        const uint32_t by = (phase * height_ / kRingSize) % (height_ > 256 ? height_ - 256 : 1);
+        for (uint32_t row = by; row < (std::min)(by + 256, height_); ++row) {
+            for (uint32_t col = bx; col < (std::min)(bx + 256, width_); ++col) {
+                rng = rng * 1664525u + 1013904223u;
+                y[row * width_ + col] = static_cast<uint8_t>(rng >> 24);
+            }
+        }
+        uint8_t* uv = buf.data() + static_cast<size_t>(width_) * height_;
+        for (uint32_t row = 0; row < height_ / 2; ++row) {
+            for (uint32_t col = 0; col < width_; col += 2) {
+                uv[row * width_ + col]     = static_cast<uint8_t>(128 + ((col / 2 + phase * 4) & 31) - 16);
+                uv[row * width_ + col + 1] = static_cast<uint8_t>(128 + ((row + phase * 4) & 31) - 16);
+            }
+        }
+        return buf;
+    }
+
+    bool load_raw(const std::wstring& path, std::vector<std::vector<uint8_t>>& frames) const {
+        std::ifstream in(std::filesystem::path(path), std::ios::binary);
+        if (!in) {
+            SR_LOG_ERROR(L"[Bench] Cannot open %s", path.c_str());
+            return false;
+        }
+        const size_t frame_bytes = nv12_tight_size(width_, height_);
+        while (frames.size() < kRingSize) {
+            std::vector<uint8_t> buf(frame_bytes);
+            if (!in.read(reinterpret_cast<char*>(buf.data()), static_cast<std::streamsize>(frame_bytes))) break;
+            frames.push_back(std::move(buf));
+        }
+        if (frames.empty()) {
+            SR_LOG_ERROR(L"[Bench] %s holds no complete %ux%u NV12 frame", path.c_str(), width_, height_);
+            return false;
+        }
+        return true;
+    }
+
+    // NV12 -> BGRA on the CPU, once, so --vp and plain runs see the same picture
+    std::vector<uint8_t> to_bgra(const std::vector<uint8_t>& nv12) const {
+        std::vector<uint8_t> out(static_cast<size_t>(width_) * height_ * 4);
+        const uint8_t* y  = nv12.data();
+        const uint8_t* uv = nv12.data() + static_cast<size_t>(width_) * height_;
+        for (uint32_t row = 0; row < height_; ++row) {
+            for (uint32_t col = 0; col < width_; ++col) {
+                const int c = y[row * width_ + col] - 16;
+                const int d = uv[(row / 2) * width_ + (col & ~1u)] - 128;
+                const int e = uv[(row / 2) * width_ + (col & ~1u) + 1] - 128;
+                auto clamp = [](int v) { return static_cast<uint8_t>(v < 0 ? 0 : v > 255 ? 255 : v); };
+                uint8_t* px = &out[(static_cast<size_t>(row) * width_ + col) * 4];
+                px[0] = clamp((298 * c + 516 * d + 128) >> 8);
+                px[1] = clamp((298 * c - 100 * d - 208 * e + 128) >> 8);
+                px[2] = clamp((298 * c + 409 * e + 128) >> 8);
+                px[3] = 255;
+            }
+        }
+        return out;
+    }
+
+    bool setup_vp(const std::vector<std::vector<uint8_t>>& frames) {
+        HRESULT hr = device_.As(&video_device_);
+        if (SUCCEEDED(hr)) hr = context_.As(&video_context_);
+        if (FAILED(hr)) {
+            SR_LOG_ERROR(L"[Bench] D3D11 video interfaces unavailable: 0x%08X", hr);
+            return false;
+        }
+
+        D3D11_VIDEO_PROCESSOR_CONTENT_DESC vpcd{};
+        vpcd.InputFrameFormat = D3D11_VIDEO_FRAME_FORMAT_PROGRESSIVE;
+        vpcd.InputWidth       = width_;
+        vpcd.InputHeight      = height_;
+        vpcd.OutputWidth      = width_;
+        vpcd.OutputHeight     = height_;
+        vpcd.Usage            = D3D11_VIDEO_USAGE_PLAYBACK_NORMAL;
+        hr = video_device_->CreateVideoProcessorEnumerator(&vpcd, vp_enum_.GetAddressOf());
+        if (SUCCEEDED(hr)) hr = video_device_->CreateVideoProcessor(vp_enum_.Get(), 0, vp_.GetAddressOf());
+        if (FAILED(hr)) {
+            SR_LOG_ERROR(L"[Bench] Video processor creation failed: 0x%08X", hr);
+            return false;
+        }
+
+        D3D11_TEXTURE2D_DESC td{};
+        td.Width            = width_;
+        td.Height           = height_;
+        td.MipLevels        = 1;
+        td.ArraySize        = 1;
+        td.Format           = DXGI_FORMAT_B8G8R8A8_UNORM;
+        td.SampleDesc.Count = 1;
+        td.Usage            = D3D11_USAGE_DEFAULT;
+        td.BindFlags        = D3D11_BIND_RENDER_TARGET | D3D11_BIND_SHADER_RESOURCE;
+
+        D3D11_VIDEO_PROCESSOR_INPUT_VIEW_DESC ivd{};
+        ivd.ViewDimension = D3D11_VPIV_DIMENSION_TEXTURE2D;
+        bgra_.resize(frames.size());
+        vp_in_.resize(frames.size());
+        for (size_t i = 0; i < frames.size(); ++i) {
+            const std::vector<uint8_t> pixels = to_bgra(frames[i]);
+            D3D11_SUBRESOURCE_DATA init{ pixels.data(), width_ * 4, 0 };
+            hr = device_->CreateTexture2D(&td, &init, bgra_[i].GetAddressOf());
+            if (SUCCEEDED(hr)) {
+                hr = video_device_->CreateVideoProcessorInputView(bgra_[i].Get(), vp_enum_.Get(), &ivd,
+                                                                 vp_in_[i].GetAddressOf());
+            }
+            if (FAILED(hr)) {
+                SR_LOG_ERROR(L"[Bench] BGRA source[%zu] setup failed: 0x%08X", i, hr);
+                return false;
+            }
+        }
+
+        D3D11_VIDEO_PROCESSOR_OUTPUT_VIEW_DESC ovd{};
+        ovd.ViewDimension = D3D11_VPOV_DIMENSION_TEXTURE2D;
+        vp_out_.resize(nv12_.size());
+        for (size_t i = 0; i < nv12_.size(); ++i) {
+            hr = video_device_->CreateVideoProcessorOutputView(nv12_[i].Get(), vp_enum_.Get(), &ovd,
+                                                              vp_out_[i].GetAddressOf());
+            if (FAILED(hr)) {
+                SR_LOG_ERROR(L"[Bench] CreateVideoProcessorOutputView[%zu] failed: 0x%08X", i, hr);
+                return false;
+            }
+        }
+        return true;
+    }
+
+    ComPtr<ID3D11Device>        device_;
+    ComPtr<ID3D11DeviceContext> context_;
+    uint32_t width_ = 0, height_ = 0;
+    std::vector<ComPtr<ID3D11Texture2D>> nv12_;
+
+    ComPtr<ID3D11VideoDevice>                            video_device_;
+    ComPtr<ID3D11VideoContext>                           video_context_;
+    ComPtr<ID3D11VideoProcessorEnumerator>               vp_enum_;
+    ComPtr<ID3D11VideoProcessor>                         vp_;
+    std::vector<ComPtr<ID3D11Texture2D>>                 bgra_;
+    std::vector<ComPtr<ID3D11VideoProcessorInputView>>   vp_in_;
+    std::vector<ComPtr<ID3D11VideoProcessorOutputView>>  vp_out_;
+};
+
+// ---------------------------------------------------------------------------
+// Resource usage
+// ---------------------------------------------------------------------------
+
+double process_cpu_seconds() {
+    FILETIME created, exited, kernel, user;
+    if (!GetProcessTimes(GetCurrentProcess(), &created, &exited, &kernel, &user)) return 0.0;
+    auto to_u64 = [](const FILETIME& ft) {
+        return (static_cast<uint64_t>(ft.dwHighDateTime) << 32) | ft.dwLowDateTime;
+    };
+    return static_cast<double>(to_u64(kernel) + to_u64(user)) / 1e7;
+}
+
+// Per-engine-type GPU running time of this process. Instance names look like
+// pid_1234_luid_0x..._phys_0_eng_3_engtype_VideoEncode; the raw value is the
+// accumulated running time in 100 ns units.
+class GpuEngineTimes {
+public:
+    ~GpuEngineTimes() { if (query_) PdhCloseQuery(query_); }
+
+    bool open() {
+        wchar_t path[128];
+        _snwprintf_s(path, _countof(path), _TRUNCATE, L"\\GPU Engine(pid_%lu_*)\\Running Time",
+                     GetCurrentProcessId());
+        if (PdhOpenQueryW(nullptr, 0, &query_) != ERROR_SUCCESS) return false;
+        if (PdhAddEnglishCounterW(query_, path, 0, &counter_) != ERROR_SUCCESS) {
+            PdhCloseQuery(query_);
+            query_ = nullptr;
+            return false;
+        }
+        return true;
+    }
+
+    // Accumulated running time per engine type, in 100 ns units
+    std::map<std::wstring, uint64_t> sample() const {
+        std::map<std::wstring, uint64_t> totals;
+        if (!query_ || PdhCollectQueryData(query_) != ERROR_SUCCESS) return totals;
+
+        DWORD bytes = 0, count = 0;
+        if (PdhGetRawCounterArrayW(counter_, &bytes, &count, nullptr) != PDH_MORE_DATA) return totals;
+        std::vector<uint8_t> buf(bytes);
+        auto* items = reinterpret_cast<PDH_RAW_COUNTER_ITEM_W*>(buf.data());
+        if (PdhGetRawCounterArrayW(counter_, &bytes, &count, items) != ERROR_SUCCESS) return totals;
+
+        for (DWORD i = 0; i < count; ++i) {
+            const wchar_t* type = wcsstr(items[i].szName, L"engtype_");
+            const std::wstring key = type ? std::wstring(type + 8) : std::wstring(L"Other");
+            totals[key.empty() ? L"Other" : key] += static_cast<uint64_t>(items[i].RawValue.FirstValue);
+        }
+        return totals;
+    }
+
+    bool available() const { return query_ != nullptr; }
+
+private:
+    PDH_HQUERY   query_   = nullptr;
+    PDH_HCOUNTER counter_ = nullptr;
+};
+
+// ---------------------------------------------------------------------------
+// One mode
+// ---------------------------------------------------------------------------
+
+// 20 ms of 48 kHz stereo 16-bit silence; MuxWriter always opens an audio track
+bool make_silence(int64_t pts, ComPtr<IMFSample>& out) {
+    constexpr int64_t kDuration = 200'000;
+    constexpr DWORD   kBytes    = 48'000 / 50 * 2 * 2;
+    ComPtr<IMFMediaBuffer> buf;
+    if (FAILED(MFCreateSample(&out)) || FAILED(MFCreateMemoryBuffer(kBytes, &buf))) return false;
+    BYTE* data = nullptr;
+    if (FAILED(buf->Lock(&data, nullptr, nullptr))) return false;
+    std::memset(data, 0, kBytes);
+    buf->Unlock();
+    buf->SetCurrentLength(kBytes);
+    out->AddBuffer(buf.Get());
+    out->SetSampleTime(pts);
+    out->SetSampleDuration(kDuration);
+    return true;
+}
+
+bool run_mode(const Options& opt, ProbeResult& probe, GpuEngineTimes& gpu, ModeResult& r) {
+    EncoderProfile profile;
+    profile.width       = opt.width;
+    profile.height      = opt.height;
+    profile.fps         = opt.fps;
+    profile.bitrate_bps = opt.bitrate_bps;
+    profile.codec       = opt.codec;
+
+    VideoEncoder encoder;
+    if (!encoder.initialize_mode(r.requested, profile, probe.dxgi_device_manager.Get(),
+                                 probe.d3d_device.Get(), probe.d3d_context.Get())) {
+        fwprintf(stderr, L"[%s] encoder unavailable, skipped\n", encoder_mode_label(r.requested));
+        return false;
+    }
+    r.codec  = encoder.codec();
+    r.width  = encoder.output_width();
+    r.height = encoder.output_height();
+    const uint32_t fps = encoder.output_fps();
+    if (!opt.input_path.empty() && (r.width != opt.width || r.height != opt.height)) {
+        fwprintf(stderr, L"[%s] encodes %ux%u; raw input is %ux%u, skipped\n",
+                 encoder_mode_label(r.requested), r.width, r.height, opt.width, opt.height);
+        return false;
+    }
+
+    FrameSource source;
+    if (!source.initialize(probe.d3d_device.Get(), probe.d3d_context.Get(), r.width, r.height,
+                           opt.use_vp, opt.input_path)) {
+        return false;
+    }
+
+    const std::wstring base = opt.out_dir + L"\\pipeline_bench_" +
+                              std::to_wstring(static_cast<int>(r.requested));
+    const std::wstring partial_path = base + L".partial.mp4";
+    const std::wstring final_path   = base + L".mp4";
+
+    MuxConfig cfg;
+    cfg.video_width   = r.width;
+    cfg.video_height  = r.height;
+    cfg.video_fps_num = fps;
+    cfg.video_bitrate = encoder.output_bitrate();
+    cfg.video_codec   = r.codec;
+    encoder.sequence_header(cfg.video_sequence_header);
+
+    MuxWriter muxer;
+    if (!muxer.initialize(partial_path, final_path, cfg)) {
+        fwprintf(stderr, L"[%s] MuxWriter::initialize failed\n", encoder_mode_label(r.requested));
+        return false;
+    }
+
+    QPCClock clock;
+    LatencyHistogram latency;
+    std::unordered_map<int64_t, int64_t> submitted_us;   // pts -> submit time
+    auto on_output = [&](IMFSample* sample) {
+        LONGLONG pts = 0;
+        if (SUCCEEDED(sample->GetSampleTime(&pts))) {
+            const auto it = submitted_us.find(pts);
+            if (it != submitted_us.end()) {
+                latency.record(clock.now_us() - it->second);
+                submitted_us.erase(it);
+            }
+        }
+        if (muxer.write_video(sample)) ++r.frames_out;
+    };
+
+    const int64_t frame_hns = 10'000'000 / fps;
+    int64_t       audio_pts = 0;
+
+    const auto     gpu_before = gpu.sample();
+    const double   cpu_before = process_cpu_seconds();
+    const int64_t  t0_us      = clock.now_us();
+    const auto     start      = std::chrono::steady_clock::now();
+    const auto     interval   = std::chrono::nanoseconds(1'000'000'000ll / fps);
+
+    for (uint32_t i = 0; i < opt.frames; ++i) {
+        if (opt.paced) {
+            const auto due = start + interval * i;
+            const auto now = std::chrono::steady_clock::now();
+            if (now < due) std::this_thread::sleep_until(due);
+            else if (now - due > interval) ++r.late_frames;
+        }
+
+        ID3D11Texture2D* tex = source.frame(i);
+        if (!tex) break;
+        const int64_t pts = static_cast<int64_t>(i) * frame_hns;
+        submitted_us[pts] = clock.now_us();
+
+        ComPtr<IMFSample> out;
+        if (!encoder.encode_frame(tex, pts, out)) {
+            fwprintf(stderr, L"[%s] encode_frame failed at frame %u\n", encoder_mode_label(r.requested), i);
+            break;
+        }
+        ++r.frames_in;
+        if (out) on_output(out.Get());
+        for (ComPtr<IMFSample> ready; encoder.take_output(ready); ready.Reset()) on_output(ready.Get());
+
+        while (audio_pts <= pts) {
+            ComPtr<IMFSample> silence;
+            if (make_silence(audio_pts, silence)) muxer.write_audio(silence.Get());
+            audio_pts += 200'000;
+        }
+    }
+
+    std::vector<ComPtr<IMFSample>> tail;
+    encoder.flush(tail);
+    for (auto& s : tail) on_output(s.Get());
+
+    r.wall_s = static_cast<double>(clock.now_us() - t0_us) / 1e6;
+    r.cpu_s  = process_cpu_seconds() - cpu_before;
+    const auto gpu_after = gpu.sample();
+    for (const auto& [engine, after] : gpu_after) {
+        const auto it = gpu_before.find(engine);
+        const uint64_t before = it != gpu_before.end() ? it->second : 0;
+        if (after > before) r.gpu_ms[engine] = static_cast<double>(after - before) / 1e4;
+    }
+
+    muxer.finalize();
+    r.bytes      = muxer.bytes_written();
+    r.final_mode = encoder.mode();
+    r.lat_p50_us = latency.percentile(50.0);
+    r.lat_p95_us = latency.percentile(95.0);
+    r.lat_p99_us = latency.percentile(99.0);
+    r.lat_max_us = latency.max();
+    r.ran        = true;
+
+    if (!opt.keep_files) {
+        DeleteFileW(final_path.c_str());
+        DeleteFileW(partial_path.c_str());
+    }
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// Reporting
+// ---------------------------------------------------------------------------
+
+void print_results(const Options& opt, const std::vector<ModeResult>& results) {
+    wprintf(L"\n%u frames @ %u fps (%s), %ux%u, %s source%s\n\n",
+            opt.frames, opt.fps, opt.paced ? L"paced" : L"unpaced", opt.width, opt.height,
+            opt.input_path.empty() ? L"synthetic" : L"raw NV12", opt.use_vp ? L" + VideoProcessorBlt" : L"");
+    wprintf(L"%-8s %-6s %-10s %8s %8s %8s %8s %8s %8s %10s\n",
+            L"mode", L"codec", L"size", L"fps", L"p50 ms", L"p95 ms", L"p99 ms", L"max ms", L"cpu %", L"MB");
+    for (const ModeResult& r : results) {
+        if (!r.ran) {
+            wprintf(L"%-8s (skipped)\n", encoder_mode_label(r.requested));
+            continue;
+        }
+        wchar_t size[24];
+        _snwprintf_s(size, _countof(size), _TRUNCATE, L"%ux%u", r.width, r.height);
+        wprintf(L"%-8s %-6s %-10s %8.1f %8.2f %8.2f %8.2f %8.2f %8.1f %10.2f\n",
+                encoder_mode_label(r.requested), video_codec_label(r.codec), size,
+                r.wall_s > 0 ? r.frames_out / r.wall_s : 0.0,
+                r.lat_p50_us / 1000.0, r.lat_p95_us / 1000.0, r.lat_p99_us / 1000.0, r.lat_max_us / 1000.0,
+                r.wall_s > 0 ? 100.0 * r.cpu_s / r.wall_s : 0.0,
+                r.bytes / (1024.0 * 1024.0));
+        if (!r.gpu_ms.empty()) {
+            wprintf(L"         gpu ms:");
+            for (const auto& [engine, ms] : r.gpu_ms) wprintf(L" %s=%.1f", engine.c_str(), ms);
+            wprintf(L"\n");
+        }
+        if (r.final_mode != r.requested) {
+            wprintf(L"         fell back to %s during the run\n", encoder_mode_label(r.final_mode));
+        }
+        if (r.frames_out != r.frames_in) {
+            wprintf(L"         %u frames submitted, %u muxed\n", r.frames_in, r.frames_out);
+        }
+        if (r.late_frames) wprintf(L"         %u frames submitted late\n", r.late_frames);
+    }
+}
+
+std::string narrow(const std::wstring& s) {
+    std::string out;
+    for (wchar_t c : s) out.push_back(c < 0x80 ? static_cast<char>(c) : '?');
+    return out;
+}
+
+bool write_json(const Options& opt, const std::vector<ModeResult>& results) {
+    std::ofstream f(std::filesystem::path(opt.json_path), std::ios::trunc);
+    if (!f) return false;
+    char line[512];
+    std::snprintf(line, sizeof(line),
+                  "{\n  \"frames\": %u,\n  \"fps\": %u,\n  \"paced\": %s,\n  \"width\": %u,\n"
+                  "  \"height\": %u,\n  \"source\": \"%s\",\n  \"vp\": %s,\n  \"modes\": [",
+                  opt.frames, opt.fps, opt.paced ? "true" : "false", opt.width, opt.height,
+                  opt.input_path.empty() ? "synthetic" : "raw", opt.use_vp ? "true" : "false");
+    f << line;
+    bool first = true;
+    for (const ModeResult& r : results) {
+        if (!r.ran) continue;
+        std::snprintf(line, sizeof(line),
+                      "%s\n    {\"mode\": \"%s\", \"final_mode\": \"%s\", \"codec\": \"%s\", "
+                      "\"width\": %u, \"height\": %u, \"frames_in\": %u, \"frames_out\": %u, "
+                      "\"late_frames\": %u, \"wall_s\": %.4f, \"fps\": %.2f, \"cpu_s\": %.4f, "
+                      "\"latency_us\": {\"p50\": %llu, \"p95\": %llu, \"p99\": %llu, \"max\": %llu}, "
+                      "\"bytes\": %llu, \"gpu_ms\": {",
+                      first ? "" : ",",
+                      narrow(encoder_mode_label(r.requested)).c_str(),
+                      narrow(encoder_mode_label(r.final_mode)).c_str(),
+                      narrow(video_codec_label(r.codec)).c_str(),
+                      r.width, r.height, r.frames_in, r.frames_out, r.late_frames, r.wall_s,
+                      r.wall_s > 0 ? r.frames_out / r.wall_s : 0.0, r.cpu_s,
+                      static_cast<unsigned long long>(r.lat_p50_us), static_cast<unsigned long long>(r.lat_p95_us),
+                      static_cast<unsigned long long>(r.lat_p99_us), static_cast<unsigned long long>(r.lat_max_us),
+                      static_cast<unsigned long long>(r.bytes));
+        f << line;
+        bool first_engine = true;
+        for (const auto& [engine, ms] : r.gpu_ms) {
+            std::snprintf(line, sizeof(line), "%s\"%s\": %.2f", first_engine ? "" : ", ",
+                          narrow(engine).c_str(), ms);
+            f << line;
+            first_engine = false;
+        }
+        f << "}}";
+        first = false;
+    }
+    f << "\n  ]\n}\n";
+    return f.good();
+}
+
+} // namespace
+
+int wmain(int argc, wchar_t** argv) {
+    Options opt;
+    if (!parse_args(argc, argv, opt)) {
+        usage();
+        return 2;
+    }
+    if (opt.out_dir.empty()) {
+        wchar_t tmp[MAX_PATH];
+        GetTempPathW(MAX_PATH, tmp);
+        opt.out_dir = tmp;
+        while (!opt.out_dir.empty() && (opt.out_dir.back() == L'\\' || opt.out_dir.back() == L'/')) {
+            opt.out_dir.pop_back();
+        }
+    }
+
+    CoInitializeEx(nullptr, COINIT_MULTITHREADED);
+    MFStartup(MF_VERSION);
+    timeBeginPeriod(1);
+
+    int exit_code = 0;
+    ProbeResult probe;
+    if (!EncoderProbe::run(probe)) {
+        fwprintf(stderr, L"D3D11 device creation failed\n");
+        exit_code = 1;
+    } else {
+        wprintf(L"Adapter: %s\n", probe.adapter_name.c_str());
+        GpuEngineTimes gpu;
+        if (!gpu.open()) fwprintf(stderr, L"GPU engine counters unavailable; GPU time not reported\n");
+
+        std::vector<ModeResult> results;
+        for (EncoderMode mode : opt.modes) {
+            ModeResult r;
+            r.requested = mode;
+            run_mode(opt, probe, gpu, r);
+            results.push_back(std::move(r));
+        }
+        print_results(opt, results);
+        if (!opt.json_path.empty() && !write_json(opt, results)) {
+            fwprintf(stderr, L"Cannot write %s\n", opt.json_path.c_str());
+            exit_code = 1;
+        }
+        if (std::none_of(results.begin(), results.end(), [](const ModeResult& r) { return r.ran; })) {
+            exit_code = 1;
+        }
+    }
+
+    timeEndPeriod(1);
+    MFShutdown();
+    CoUninitialize();
+    return exit_code;
+}
@@ -0,0 +1,67 @@
+// test_adapter_pairing.cpp — Unit tests for the capture/encode adapter pairing
+
+#include <gtest/gtest.h>
+#include "encoder/adapter_pairing.h"
+
+using namespace sr;
+
+namespace {
+
+AdapterPairingCandidate adapter(bool display, bool any_output, bool encoder, int preference = 10) {
+    AdapterPairingCandidate a;
+    a.drives_display    = display;
+    a.drives_any_output = any_output;
+    a.hw_encoder        = encoder;
+    a.preference        = preference;
+    return a;
+}
+
+} // namespace
+
+TEST(AdapterPairingTest, SingleAdapterCapturesAndEncodesInPlace) {
+    const AdapterPairing p = choose_adapter_pairing({ adapter(true, true, true) });
+    EXPECT_EQ(p.capture, 0);
+    EXPECT_EQ(p.encode, 0);
+    EXPECT_FALSE(p.split());
+}
+
+TEST(AdapterPairingTest, HeadlessDiscreteEncodesWhileIntegratedDrivesDisplay) {
+    // iGPU scans out the monitor, dGPU has NVENC and no outputs
+    const AdapterPairing p = choose_adapter_pairing({ adapter(true, true, true, 110),
+                                                      adapter(false, false, true, 10) });
+    EXPECT_EQ(p.capture, 0);
+    EXPECT_EQ(p.encode, 1);
+    EXPECT_TRUE(p.split());
+    EXPECT_EQ(p.cost, kPairingCrossAdapterCost);
+}
+
+TEST(AdapterPairingTest, BusyAdaptersStayUnsplit) {
+    // Both GPUs drive monitors: the copy would only add cost
+    const AdapterPairing p = choose_adapter_pairing({ adapter(true, true, true),
+                                                      adapter(false, true, true, 110) });
+    EXPECT_EQ(p.encode, 0);
+    EXPECT_FALSE(p.split());
+}
+
+TEST(AdapterPairingTest, DisplayAdapterWithoutEncoderHandsOff) {
+    const AdapterPairing p = choose_adapter_pairing({ adapter(true, true, false),
+                                                      adapter(false, true, true) });
+    EXPECT_EQ(p.capture, 0);
+    EXPECT_EQ(p.encode, 1);
+    EXPECT_LT(p.cost, kPairingNoEncoderCost);
+}
+
+TEST(AdapterPairingTest, UnknownDisplayFollowsEncoderAndPreference) {
+    const AdapterPairing p = choose_adapter_pairing({ adapter(false, false, true, 10),
+                                                      adapter(false, false, true, 110) });
+    EXPECT_EQ(p.encode, 1);
+    EXPECT_EQ(p.capture, 1);
+    EXPECT_FALSE(p.split());
+}
+
+TEST(AdapterPairingTest, SoftwareAdaptersAreNeverPicked) {
+    AdapterPairingCandidate warp = adapter(false, false, true);
+    warp.is_software = true;
+    EXPECT_EQ(choose_adapter_pairing({ warp }).encode, -1);
+    EXPECT_EQ(choose_adapter_pairing({ warp, adapter(true, true, false) }).encode, 1);
+}
@@ -0,0 +1,97 @@
+// test_adaptive_gop.cpp — Unit tests for AdaptiveGop (content-driven IDR cadence)
+
+#include <gtest/gtest.h>
+#include "sync/adaptive_gop.h"
+
+using sr::AdaptiveGop;
+
+namespace {
+
+constexpr int64_t kSecond = 10'000'000;
+constexpr int64_t kFrame  = 333'333;  // 30 fps
+
+// Keyframes requested over `frames` frames of constant `change`
+uint32_t run(AdaptiveGop& gop, int64_t& pts, int frames, double change) {
+    uint32_t keys = 0;
+    for (int f = 0; f < frames; ++f, pts += kFrame) {
+        if (gop.due(pts, change)) ++keys;
+    }
+    return keys;
+}
+
+} // namespace
+
+TEST(AdaptiveGopTest, DisabledNeverDue) {
+    AdaptiveGop gop;
+    gop.reset(0, 10 * kSecond);
+    EXPECT_FALSE(gop.enabled());
+    EXPECT_FALSE(gop.due(0, 1.0));
+}
+
+TEST(AdaptiveGopTest, MovingContentKeepsTheBaseInterval) {
+    AdaptiveGop gop;
+    gop.reset(2 * kSecond, 10 * kSecond);
+    int64_t pts = 0;
+    EXPECT_EQ(run(gop, pts, 300, 0.2), 5u);   // 10 s: 0, 2, 4, 6, 8 s
+    EXPECT_EQ(gop.scene_cuts(), 0u);
+}
+
+TEST(AdaptiveGopTest, UnknownChangeCountsAsMotion) {
+    AdaptiveGop gop;
+    gop.reset(2 * kSecond, 10 * kSecond);
+    int64_t pts = 0;
+    EXPECT_EQ(run(gop, pts, 300, sr::kGopChangeUnknown), 5u);
+}
+
+TEST(AdaptiveGopTest, StaticContentStretchesToTheMaximum) {
+    AdaptiveGop gop;
+    gop.reset(2 * kSecond, 10 * kSecond);
+    int64_t pts = 0;
+    // Duplicates and cursor-sized changes: the first frame, then every 10 s
+    EXPECT_EQ(run(gop, pts, 900, 0.0), 3u);
+    EXPECT_EQ(run(gop, pts, 900, 0.005), 3u);
+    EXPECT_FALSE(gop.moving(pts));
+}
+
+TEST(AdaptiveGopTest, LargeChangeAfterQuietIsAKeyedSceneCut) {
+    AdaptiveGop gop;
+    gop.reset(2 * kSecond, 10 * kSecond);
+    int64_t pts = 0;
+    run(gop, pts, 60, 0.0);               // keyed at 0, quiet for 2 s
+    EXPECT_TRUE(gop.due(pts, 0.9));       // app switch
+    EXPECT_EQ(gop.scene_cuts(), 1u);
+    pts += kFrame;
+    EXPECT_FALSE(gop.due(pts, 0.0));
+    pts += kFrame;
+    EXPECT_FALSE(gop.due(pts, 0.9));      // inside half a base interval of the cut
+}
+
+TEST(AdaptiveGopTest, ContinuousLargeChangesAreNotCuts) {
+    AdaptiveGop gop;
+    gop.reset(2 * kSecond, 10 * kSecond);
+    int64_t pts = 0;
+    EXPECT_EQ(run(gop, pts, 300, 0.8), 5u);   // scrolling: base cadence only
+    EXPECT_EQ(gop.scene_cuts(), 0u);
+}
+
+TEST(AdaptiveGopTest, ExternalKeyframesRestartTheInterval) {
+    AdaptiveGop gop;
+    gop.reset(2 * kSecond, 10 * kSecond);
+    int64_t pts = 0;
+    EXPECT_TRUE(gop.due(pts, 0.2));
+    pts = 15 * kFrame;
+    gop.on_keyframe(pts);                     // segment rotation / resume IDR
+    pts = 70 * kFrame;                        // 2.3 s after the first key
+    EXPECT_FALSE(gop.due(pts, 0.2));
+    pts = 76 * kFrame;                        // 2 s after the external one
+    EXPECT_TRUE(gop.due(pts, 0.2));
+}
+
+TEST(AdaptiveGopTest, MotionAfterStaticKeysOnceTheBaseIntervalHasPassed) {
+    AdaptiveGop gop;
+    gop.reset(2 * kSecond, 10 * kSecond);
+    int64_t pts = 0;
+    run(gop, pts, 150, 0.0);                  // 5 s static, keyed at 0 only
+    EXPECT_TRUE(gop.due(pts, 0.05));          // moving again: 5 s > base
+    EXPECT_TRUE(gop.moving(pts));
+}
@@ -0,0 +1,36 @@
+// test_audio_codec.cpp — Unit tests for audio codec selection helpers
+
+#include <gtest/gtest.h>
+#include "utils/audio_codec.h"
+
+using namespace sr;
+
+TEST(AudioCodecTest, AacBitrateSnapsToEncoderRates) {
+    EXPECT_EQ(aac_encoder_bitrate(128'000, AacProfile::LC), 128'000u);
+    EXPECT_EQ(aac_encoder_bitrate(64'000, AacProfile::LC), 96'000u);     // below the lowest LC rate
+    EXPECT_EQ(aac_encoder_bitrate(150'000, AacProfile::LC), 160'000u);
+    EXPECT_EQ(aac_encoder_bitrate(320'000, AacProfile::LC), 192'000u);
+    EXPECT_EQ(aac_encoder_bitrate(128'000, AacProfile::HE), 96'000u);
+    EXPECT_EQ(aac_encoder_bitrate(56'000, AacProfile::HE), 48'000u);     // ties keep the lower rate
+    EXPECT_EQ(aac_encoder_bitrate(70'000, AacProfile::HE), 64'000u);
+}
+
+TEST(AudioCodecTest, ProfileLevelIndications) {
+    EXPECT_EQ(aac_profile_level(AacProfile::LC), 0x29u);
+    EXPECT_EQ(aac_profile_level(AacProfile::HE), 0x2Cu);
+}
+
+TEST(AudioCodecTest, OpusBitrateIsClamped) {
+    EXPECT_EQ(opus_bitrate(1'000), 6'000u);
+    EXPECT_EQ(opus_bitrate(32'000), 32'000u);
+    EXPECT_EQ(opus_bitrate(1'000'000), 510'000u);
+    EXPECT_EQ(audio_track_bitrate(AudioCodec::Opus, AacProfile::LC, 24'000), 24'000u);
+    EXPECT_EQ(audio_track_bitrate(AudioCodec::AAC, AacProfile::LC, 24'000), 96'000u);
+}
+
+TEST(AudioCodecTest, SubtypesFollowFormatTags) {
+    const GUID opus = audio_codec_subtype(AudioCodec::Opus);
+    EXPECT_EQ(opus.Data1, 0x704Fu);
+    EXPECT_EQ(opus.Data2, MFAudioFormat_Base.Data2);
+    EXPECT_TRUE(IsEqualGUID(audio_codec_subtype(AudioCodec::AAC), MFAudioFormat_AAC));
+}
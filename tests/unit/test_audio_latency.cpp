@@ -0,0 +1,46 @@
+// test_audio_latency.cpp — Unit tests for the WASAPI period / wakeup plan
+
+#include <gtest/gtest.h>
+#include "audio/audio_latency.h"
+
+using namespace sr;
+
+TEST(AudioLatencyTest, DefaultIsEventDrivenWithHundredMsBuffer) {
+    const AudioPeriodPlan plan = plan_audio_period(AudioLatencyMode::Default, 128);
+    EXPECT_EQ(plan.mode, AudioLatencyMode::Default);
+    EXPECT_TRUE(plan.event_driven);
+    EXPECT_FALSE(plan.shared_stream);
+    EXPECT_EQ(plan.buffer_100ns, 1'000'000);
+    EXPECT_EQ(audio_wakeups_per_second(plan, 100'000, 48000), 100u);   // 10 ms period
+}
+
+TEST(AudioLatencyTest, PowerSavingCutsWakeupsFourfold) {
+    const AudioPeriodPlan plan = plan_audio_period(AudioLatencyMode::PowerSaving, 0);
+    EXPECT_FALSE(plan.event_driven);
+    EXPECT_EQ(plan.wait_ms, kPowerSavingWakeMs);
+    // The buffer holds several poll intervals so a late wakeup loses nothing
+    EXPECT_GE(plan.buffer_100ns, int64_t{ kPowerSavingWakeMs } * 4 * 10'000);
+    const AudioPeriodPlan base = plan_audio_period(AudioLatencyMode::Default, 0);
+    EXPECT_EQ(audio_wakeups_per_second(base, 100'000, 48000),
+              4 * audio_wakeups_per_second(plan, 100'000, 48000));
+}
+
+TEST(AudioLatencyTest, LowLatencyUsesMinimumPeriodWhenAvailable) {
+    AudioPeriodPlan plan = plan_audio_period(AudioLatencyMode::LowLatency, 128);
+    EXPECT_EQ(plan.mode, AudioLatencyMode::LowLatency);
+    EXPECT_TRUE(plan.shared_stream);
+    EXPECT_TRUE(plan.event_driven);
+    EXPECT_EQ(plan.period_frames, 128u);
+    EXPECT_EQ(audio_wakeups_per_second(plan, 100'000, 48000), 375u);
+
+    // No IAudioClient3: the default period
+    plan = plan_audio_period(AudioLatencyMode::LowLatency, 0);
+    EXPECT_EQ(plan.mode, AudioLatencyMode::Default);
+    EXPECT_FALSE(plan.shared_stream);
+}
+
+TEST(AudioLatencyTest, UnresolvedAutoPlansAsDefault) {
+    const AudioPeriodPlan plan = plan_audio_period(AudioLatencyMode::Auto, 128);
+    EXPECT_EQ(plan.mode, AudioLatencyMode::Default);
+    EXPECT_TRUE(plan.event_driven);
+}
@@ -0,0 +1,205 @@
+// test_audio_mixer.cpp — Unit tests for the PCM mix / level kernels (audio_mixer.h)
+// Every SIMD variant the build machine supports is checked against the scalar
+// reference, using odd lengths so the vector tails are exercised too.
+
+#include <gtest/gtest.h>
+#include "audio/audio_mixer.h"
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+using namespace sr;
+
+namespace {
+
+constexpr size_t kOddLength = 1923;  // not a multiple of 4, 8 or 16
+
+std::vector<float> random_float(size_t n, uint32_t seed, float amplitude) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> dist(-amplitude, amplitude);
+    std::vector<float> v(n);
+    for (auto& s : v) s = dist(rng);
+    return v;
+}
+
+std::vector<int16_t> random_int16(size_t n, uint32_t seed) {
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<int> dist(-32768, 32767);
+    std::vector<int16_t> v(n);
+    for (auto& s : v) s = static_cast<int16_t>(dist(rng));
+    return v;
+}
+
+} // namespace
+
+TEST(AudioMixerTest, ScalarFloatAddClamps) {
+    float dst[3] = { 0.75f, -0.75f, 0.25f };
+    const float src[3] = { 0.5f, -0.5f, 0.25f };
+    mixer::scalar::mix_add_float(dst, src, 3, 1.0f);
+    EXPECT_FLOAT_EQ(dst[0], 1.0f);
+    EXPECT_FLOAT_EQ(dst[1], -1.0f);
+    EXPECT_FLOAT_EQ(dst[2], 0.5f);
+}
+
+TEST(AudioMixerTest, ScalarInt16AddSaturates) {
+    int16_t dst[3] = { 30000, -30000, 100 };
+    const int16_t src[3] = { 10000, -10000, 23 };
+    mixer::scalar::mix_add_int16(dst, src, 3, 1.0f);
+    EXPECT_EQ(dst[0], 32767);
+    EXPECT_EQ(dst[1], -32768);
+    EXPECT_EQ(dst[2], 123);
+}
+
+TEST(AudioMixerTest, ScalarLevelsNormalizedToFullScale) {
+    const int16_t square[4] = { 16384, -16384, 16384, -16384 };
+    const AudioLevels l16 = mixer::scalar::measure_int16(square, 4);
+    EXPECT_NEAR(l16.rms, 0.5f, 1e-6f);
+    EXPECT_NEAR(l16.peak, 0.5f, 1e-6f);
+
+    const int16_t min_value[1] = { -32768 };
+    EXPECT_FLOAT_EQ(mixer::scalar::measure_int16(min_value, 1).peak, 1.0f);
+
+    const float f[2] = { 0.25f, -0.25f };
+    const AudioLevels lf = mixer::scalar::measure_float(f, 2);
+    EXPECT_FLOAT_EQ(lf.rms, 0.25f);
+    EXPECT_FLOAT_EQ(lf.peak, 0.25f);
+
+    EXPECT_FLOAT_EQ(mixer::scalar::measure_float(nullptr, 0).rms, 0.0f);
+}
+
+#if defined(SR_MIXER_X86)
+
+namespace {
+
+// Runs `check(isa)` for each SIMD level the host supports
+template <typename Check>
+void for_each_simd_isa(Check check) {
+    check(MixerIsa::Sse2);
+    if (mixer::cpu_has_avx2()) check(MixerIsa::Avx2);
+}
+
+} // namespace
+
+TEST(AudioMixerSimdTest, FloatAddMatchesScalar) {
+    for (const float gain : { 1.0f, 0.5f, 2.5f }) {
+        const auto src  = random_float(kOddLength, 1, 1.0f);
+        const auto base = random_float(kOddLength, 2, 1.0f);
+        auto expected = base;
+        mixer::scalar::mix_add_float(expected.data(), src.data(), kOddLength, gain);
+
+        for_each_simd_isa([&](MixerIsa isa) {
+            auto dst = base;
+            if (isa == MixerIsa::Avx2) mixer::avx2::mix_add_float(dst.data(), src.data(), kOddLength, gain);
+            else                       mixer::sse2::mix_add_float(dst.data(), src.data(), kOddLength, gain);
+            for (size_t i = 0; i < kOddLength; ++i) {
+                ASSERT_FLOAT_EQ(dst[i], expected[i]) << "isa=" << static_cast<int>(isa) << " i=" << i;
+            }
+        });
+    }
+}
+
+TEST(AudioMixerSimdTest, Int16AddMatchesScalar) {
+    for (const float gain : { 1.0f, 0.5f, 1.7f }) {
+        const auto src  = random_int16(kOddLength, 3);
+        const auto base = random_int16(kOddLength, 4);
+        auto expected = base;
+        mixer::scalar::mix_add_int16(expected.data(), src.data(), kOddLength, gain);
+
+        for_each_simd_isa([&](MixerIsa isa) {
+            auto dst = base;
+            if (isa == MixerIsa::Avx2) mixer::avx2::mix_add_int16(dst.data(), src.data(), kOddLength, gain);
+            else                       mixer::sse2::mix_add_int16(dst.data(), src.data(), kOddLength, gain);
+            for (size_t i = 0; i < kOddLength; ++i) {
+                ASSERT_EQ(dst[i], expected[i]) << "isa=" << static_cast<int>(isa) << " i=" << i;
+            }
+        });
+    }
+}
+
+TEST(AudioMixerSimdTest, GainMatchesScalar) {
+    const auto fbase = random_float(kOddLength, 5, 1.0f);
+    const auto ibase = random_int16(kOddLength, 6);
+    auto fexpected = fbase;
+    auto iexpected = ibase;
+    mixer::scalar::apply_gain_float(fexpected.data(), kOddLength, 1.8f);
+    mixer::scalar::apply_gain_int16(iexpected.data(), kOddLength, 1.8f);
+
+    for_each_simd_isa([&](MixerIsa isa) {
+        auto f = fbase;
+        auto s = ibase;
+        if (isa == MixerIsa::Avx2) {
+            mixer::avx2::apply_gain_float(f.data(), kOddLength, 1.8f);
+            mixer::avx2::apply_gain_int16(s.data(), kOddLength, 1.8f);
+        } else {
+            mixer::sse2::apply_gain_float(f.data(), kOddLength, 1.8f);
+            mixer::sse2::apply_gain_int16(s.data(), kOddLength, 1.8f);
+        }
+        for (size_t i = 0; i < kOddLength; ++i) {
+            ASSERT_FLOAT_EQ(f[i], fexpected[i]) << "i=" << i;
+            ASSERT_EQ(s[i], iexpected[i]) << "i=" << i;
+        }
+    });
+}
+
+TEST(AudioMixerSimdTest, LevelsMatchScalar) {
+    auto f = random_float(kOddLength, 7, 0.8f);
+    auto s = random_int16(kOddLength, 8);
+    s[kOddLength / 2] = -32768;  // worst case for the pairwise madd accumulation
+    s[kOddLength / 2 + 1] = -32768;
+    const AudioLevels fexpected = mixer::scalar::measure_float(f.data(), kOddLength);
+    const AudioLevels sexpected = mixer::scalar::measure_int16(s.data(), kOddLength);
+
+    for_each_simd_isa([&](MixerIsa isa) {
+        const AudioLevels fl = (isa == MixerIsa::Avx2)
+            ? mixer::avx2::measure_float(f.data(), kOddLength)
+            : mixer::sse2::measure_float(f.data(), kOddLength);
+        const AudioLevels sl = (isa == MixerIsa::Avx2)
+            ? mixer::avx2::measure_int16(s.data(), kOddLength)
+            : mixer::sse2::measure_int16(s.data(), kOddLength);
+        EXPECT_NEAR(fl.rms, fexpected.rms, 1e-6f);
+        EXPECT_FLOAT_EQ(fl.peak, fexpected.peak);
+        EXPECT_FLOAT_EQ(sl.rms, sexpected.rms);
+        EXPECT_FLOAT_EQ(sl.peak, 1.0f);
+    });
+}
+
+#endif // SR_MIXER_X86
+
+TEST(AudioMixerTest, MixPcmSourcesSumsWithGain) {
+    const std::vector<int16_t> a(64, 1000);
+    const std::vector<int16_t> b(64, 2000);
+    const std::vector<int16_t> c(64, -400);
+    std::vector<int16_t> out(64, 12345);
+
+    const PcmMixSource sources[] = {
+        { reinterpret_cast<const uint8_t*>(a.data()), 1.0f },
+        { nullptr, 1.0f },
+        { reinterpret_cast<const uint8_t*>(b.data()), 0.5f },
+        { reinterpret_cast<const uint8_t*>(c.data()), 2.0f },
+    };
+    mix_pcm_sources(reinterpret_cast<uint8_t*>(out.data()), out.size() * sizeof(int16_t), 16,
+                    sources, 4);
+    for (int16_t v : out) EXPECT_EQ(v, 1000 + 1000 - 800);
+}
+
+TEST(AudioMixerTest, MixPcmSourcesWithNoInputsProducesSilence) {
+    std::vector<float> out(16, 0.7f);
+    const PcmMixSource none[] = { { nullptr, 1.0f } };
+    mix_pcm_sources(reinterpret_cast<uint8_t*>(out.data()), out.size() * sizeof(float), 32, none, 1);
+    for (float v : out) EXPECT_EQ(v, 0.0f);
+}
+
+TEST(AudioMixerTest, MeasurePcmLevelsDetectsNoiseGateFloor) {
+    // ~-50 dBFS hiss must fall under the AudioEngine gate (0.003 float, 100 int16)
+    const auto hiss = random_float(960, 9, 0.004f);
+    EXPECT_LT(measure_pcm_levels(reinterpret_cast<const uint8_t*>(hiss.data()),
+                                 hiss.size() * sizeof(float), 32).rms, 0.003f);
+
+    const std::vector<int16_t> tone(960, 8192);
+    const AudioLevels l = measure_pcm_levels(reinterpret_cast<const uint8_t*>(tone.data()),
+                                             tone.size() * sizeof(int16_t), 16);
+    EXPECT_NEAR(l.rms, 0.25f, 1e-6f);
+
+    EXPECT_EQ(measure_pcm_levels(reinterpret_cast<const uint8_t*>(tone.data()), 8, 24).rms, 0.0f);
+}
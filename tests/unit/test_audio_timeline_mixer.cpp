@@ -0,0 +1,274 @@
+// test_audio_timeline_mixer.cpp — Unit tests for AudioTimelineMixer (sample-indexed mic/loopback mix)
+
+#include <gtest/gtest.h>
+#include "audio/audio_timeline_mixer.h"
+
+#include <cstdint>
+#include <vector>
+
+using sr::AudioPacket;
+using sr::AudioTimelineMixer;
+
+namespace {
+
+// 48 kHz mono int16: 1 frame = 2 bytes, 10 ms = 480 frames = 100'000 pts units
+AudioTimelineMixer make_mixer(uint32_t block_ms = 20) {
+    AudioTimelineMixer timeline;
+    AudioTimelineMixer::Format fmt;
+    fmt.sample_rate = 48000;
+    fmt.channels = 1;
+    fmt.bits_per_sample = 16;
+    EXPECT_TRUE(timeline.configure(fmt, block_ms, 100, 500));
+    return timeline;
+}
+
+AudioPacket make_packet(int64_t pts, uint32_t frames, int16_t value, uint16_t channels = 1) {
+    AudioPacket pkt;
+    pkt.pts = pts;
+    pkt.frame_count = frames;
+    pkt.channels = channels;
+    pkt.sample_rate = 48000;
+    pkt.buffer.resize(static_cast<size_t>(frames) * channels * sizeof(int16_t));
+    auto* s = reinterpret_cast<int16_t*>(pkt.buffer.data());
+    for (size_t i = 0; i < static_cast<size_t>(frames) * channels; ++i) s[i] = value;
+    return pkt;
+}
+
+struct Emitted {
+    int64_t pts = 0;
+    int64_t duration = 0;
+    std::vector<int16_t> samples;
+};
+
+std::vector<Emitted> drain(AudioTimelineMixer& timeline, bool flush = false) {
+    std::vector<Emitted> out;
+    timeline.drain([&](const AudioTimelineMixer::Block& block) {
+        Emitted e;
+        e.pts = block.pts;
+        e.duration = block.duration;
+        const auto* s = reinterpret_cast<const int16_t*>(block.data);
+        e.samples.assign(s, s + block.bytes / sizeof(int16_t));
+        out.push_back(std::move(e));
+    }, flush);
+    return out;
+}
+
+} // namespace
+
+TEST(AudioTimelineMixerTest, RejectsInvalidConfiguration) {
+    AudioTimelineMixer timeline;
+    AudioTimelineMixer::Format fmt;
+    fmt.bits_per_sample = 24;
+    EXPECT_FALSE(timeline.configure(fmt));
+    fmt.bits_per_sample = 16;
+    EXPECT_FALSE(timeline.configure(fmt, 20, 100, 100));  // capacity must exceed latency + block
+    EXPECT_TRUE(timeline.configure(fmt));
+}
+
+TEST(AudioTimelineMixerTest, EmitsFixedBlocksWithContiguousPts) {
+    auto timeline = make_mixer(20);
+    // 7 ms packets (336 frames) — not a divisor of the 20 ms block
+    for (int i = 0; i < 9; ++i) {
+        ASSERT_TRUE(timeline.add(0, make_packet(i * 70'000LL, 336, 5)));
+    }
+    const auto blocks = drain(timeline);
+    ASSERT_EQ(blocks.size(), 3u);  // 63 ms buffered -> three full 20 ms blocks
+    for (size_t i = 0; i < blocks.size(); ++i) {
+        EXPECT_EQ(blocks[i].pts, static_cast<int64_t>(i) * 200'000);
+        EXPECT_EQ(blocks[i].duration, 200'000);
+        ASSERT_EQ(blocks[i].samples.size(), 960u);
+        for (int16_t v : blocks[i].samples) ASSERT_EQ(v, 5);
+    }
+    EXPECT_EQ(timeline.buffered_frames(), 9 * 336 - 3 * 960);
+}
+
+TEST(AudioTimelineMixerTest, SumsSourcesSampleAccuratelyAcrossPacketSizes) {
+    auto timeline = make_mixer(20);
+    // Mic in 10 ms packets, loopback in 5 ms packets offset by 2.5 ms
+    for (int i = 0; i < 2; ++i) ASSERT_TRUE(timeline.add(0, make_packet(i * 100'000LL, 480, 1000)));
+    for (int i = 0; i < 4; ++i) ASSERT_TRUE(timeline.add(1, make_packet(25'000 + i * 50'000LL, 240, 7)));
+
+    const auto blocks = drain(timeline);
+    ASSERT_EQ(blocks.size(), 1u);
+    const auto& s = blocks[0].samples;
+    for (size_t i = 0; i < 120; ++i) ASSERT_EQ(s[i], 1000) << i;      // before loopback starts
+    for (size_t i = 120; i < 960; ++i) ASSERT_EQ(s[i], 1007) << i;    // both sources
+}
+
+TEST(AudioTimelineMixerTest, SnapsRoundingJitterWithoutGapsOrOverlap) {
+    auto timeline = make_mixer(10);
+    // 441 frames @ 48 kHz = 91875 pts units; push pts one unit early/late
+    ASSERT_TRUE(timeline.add(0, make_packet(0, 441, 1)));
+    ASSERT_TRUE(timeline.add(0, make_packet(91'874, 441, 1)));
+    ASSERT_TRUE(timeline.add(0, make_packet(183'751, 441, 1)));
+    const auto blocks = drain(timeline, /*flush=*/true);
+    size_t total = 0;
+    for (const auto& b : blocks) {
+        for (int16_t v : b.samples) ASSERT_EQ(v, 1);
+        total += b.samples.size();
+    }
+    EXPECT_EQ(total, 3u * 441u);
+    EXPECT_EQ(timeline.stats().trimmed_frames, 0u);
+}
+
+TEST(AudioTimelineMixerTest, WaitsForSlowerSourceUntilLatency) {
+    auto timeline = make_mixer(20);
+    ASSERT_TRUE(timeline.add(1, make_packet(0, 240, 3)));        // loopback: 5 ms only
+    ASSERT_TRUE(timeline.add(0, make_packet(0, 960, 10)));       // mic: 20 ms
+    EXPECT_TRUE(drain(timeline).empty());                        // loopback hasn't covered the block
+
+    // Mic runs ahead by more than the 100 ms latency: blocks go out without loopback
+    for (int i = 1; i <= 6; ++i) ASSERT_TRUE(timeline.add(0, make_packet(i * 200'000LL, 960, 10)));
+    const auto blocks = drain(timeline);
+    ASSERT_GE(blocks.size(), 1u);
+    EXPECT_EQ(blocks[0].samples[0], 13);
+    EXPECT_EQ(blocks[0].samples[500], 10);
+}
+
+TEST(AudioTimelineMixerTest, RetimesSourceThatFellFarBehind) {
+    auto timeline = make_mixer(20);
+    // Loopback delivered 20 ms, then nothing while system audio was silent
+    ASSERT_TRUE(timeline.add(1, make_packet(0, 960, 2)));
+    for (int i = 0; i < 20; ++i) ASSERT_TRUE(timeline.add(0, make_packet(i * 200'000LL, 960, 10)));
+    drain(timeline);
+    const int64_t head_pts = 20 * 200'000LL - 200'000LL * 5;  // read head trails mic by ~latency
+
+    // Loopback resumes with its sample-count pts (still 20 ms) — must not be dropped
+    ASSERT_TRUE(timeline.add(1, make_packet(200'000, 960, 2)));
+    EXPECT_EQ(timeline.stats().retimed, 1u);
+    const auto blocks = drain(timeline, /*flush=*/true);
+    bool heard_loopback = false;
+    for (const auto& b : blocks) {
+        if (b.pts >= head_pts && b.samples[0] == 12) heard_loopback = true;
+    }
+    EXPECT_TRUE(heard_loopback);
+}
+
+TEST(AudioTimelineMixerTest, RejectsFormatMismatch) {
+    auto timeline = make_mixer();
+    EXPECT_FALSE(timeline.add(0, make_packet(0, 480, 1, /*channels=*/2)));
+    AudioPacket other_rate = make_packet(0, 480, 1);
+    other_rate.sample_rate = 44100;
+    EXPECT_FALSE(timeline.add(0, other_rate));
+    EXPECT_FALSE(timeline.add(AudioTimelineMixer::kMaxSources, make_packet(0, 480, 1)));
+    EXPECT_EQ(timeline.stats().format_rejects, 2u);
+    EXPECT_TRUE(timeline.empty());
+}
+
+TEST(AudioTimelineMixerTest, FlushEmitsShortTailAndResetsAnchor) {
+    auto timeline = make_mixer(20);
+    ASSERT_TRUE(timeline.add(0, make_packet(0, 1200, 4)));  // 25 ms
+    const auto blocks = drain(timeline, /*flush=*/true);
+    ASSERT_EQ(blocks.size(), 2u);
+    EXPECT_EQ(blocks[1].pts, 200'000);
+    EXPECT_EQ(blocks[1].samples.size(), 240u);
+    EXPECT_TRUE(timeline.empty());
+
+    // Next packet anchors a fresh timeline at its own pts
+    ASSERT_TRUE(timeline.add(0, make_packet(10'000'000, 960, 1)));
+    const auto next = drain(timeline);
+    ASSERT_EQ(next.size(), 1u);
+    EXPECT_EQ(next[0].pts, 10'000'000);
+}
+
+TEST(AudioTimelineMixerTest, JumpBeyondCapacityReanchors) {
+    auto timeline = make_mixer(20);
+    ASSERT_TRUE(timeline.add(0, make_packet(0, 480, 1)));
+    ASSERT_TRUE(timeline.add(0, make_packet(50'000'000, 960, 9)));  // +5 s (e.g. resume)
+    EXPECT_EQ(timeline.stats().discontinuities, 1u);
+    const auto blocks = drain(timeline);
+    ASSERT_EQ(blocks.size(), 1u);
+    EXPECT_EQ(blocks[0].pts, 50'000'000);
+    EXPECT_EQ(blocks[0].samples[0], 9);
+}
+
+TEST(AudioTimelineMixerTest, SilencePacketsAdvanceTimelineWithoutMixing) {
+    auto timeline = make_mixer(20);
+    AudioPacket silent = make_packet(0, 960, 1234);
+    silent.is_silence = true;
+    ASSERT_TRUE(timeline.add(0, silent));
+    const auto blocks = drain(timeline);
+    ASSERT_EQ(blocks.size(), 1u);
+    for (int16_t v : blocks[0].samples) ASSERT_EQ(v, 0);
+}
+
+TEST(AudioTimelineMixerTest, ZeroPayloadSilenceEmitsSilentBlocks) {
+    auto timeline = make_mixer(20);
+    AudioPacket silent;
+    silent.pts = 0;
+    silent.frame_count = 960;   // duration only, no PCM
+    silent.channels = 1;
+    silent.sample_rate = 48000;
+    silent.is_silence = true;
+    ASSERT_TRUE(timeline.add(0, silent));
+    ASSERT_TRUE(timeline.add(0, make_packet(200'000, 960, 5)));
+
+    std::vector<bool> flags;
+    std::vector<int64_t> pts;
+    timeline.drain([&](const AudioTimelineMixer::Block& block) {
+        flags.push_back(block.silent);
+        pts.push_back(block.pts);
+        const auto* s = reinterpret_cast<const int16_t*>(block.data);
+        for (uint32_t i = 0; i < block.frames; ++i) ASSERT_EQ(s[i], block.silent ? 0 : 5);
+    }, /*flush=*/true);
+    EXPECT_EQ(flags, (std::vector<bool>{ true, false }));
+    EXPECT_EQ(pts, (std::vector<int64_t>{ 0, 200'000 }));
+}
+
+TEST(AudioTimelineMixerTest, BlocksAreSilentAgainAfterTheyAreEmitted) {
+    auto timeline = make_mixer(20);
+    ASSERT_TRUE(timeline.add(0, make_packet(0, 960, 3)));
+    EXPECT_EQ(timeline.drain([](const AudioTimelineMixer::Block& b) { EXPECT_FALSE(b.silent); }), 1u);
+
+    // Wraps the ring back onto the block just emitted
+    AudioPacket silent;
+    silent.frame_count = 960;
+    silent.channels = 1;
+    silent.sample_rate = 48000;
+    silent.is_silence = true;
+    size_t silent_blocks = 0;
+    for (int64_t t = 200'000; t < 200'000 * 30; t += 200'000) {
+        silent.pts = t;
+        ASSERT_TRUE(timeline.add(0, silent));
+        timeline.drain([&](const AudioTimelineMixer::Block& b) {
+            EXPECT_TRUE(b.silent);
+            ++silent_blocks;
+        });
+    }
+    EXPECT_GE(silent_blocks, 25u);
+}
+
+TEST(AudioTimelineMixerTest, ExternalClockFillsIdleSourceWithSilence) {
+    auto timeline = make_mixer(20);
+    // System-audio track: 20 ms of sound, then WASAPI delivers nothing while
+    // the mic track's clock runs on to 400 ms
+    ASSERT_TRUE(timeline.add(0, make_packet(0, 960, 7)));
+    timeline.advance_clock(4'000'000);
+    const auto blocks = drain(timeline);
+    ASSERT_EQ(blocks.size(), 15u);  // 400 ms less the 100 ms latency
+    EXPECT_EQ(blocks[0].samples[0], 7);
+    for (size_t i = 1; i < blocks.size(); ++i) {
+        EXPECT_EQ(blocks[i].pts, blocks[i - 1].pts + blocks[i - 1].duration);
+        EXPECT_EQ(blocks[i].samples[0], 0);
+    }
+
+    // Resuming with its sample-count pts lands at the read head, not 280 ms in the past
+    ASSERT_TRUE(timeline.add(0, make_packet(200'000, 960, 7)));
+    EXPECT_EQ(timeline.stats().retimed, 1u);
+    const auto tail = drain(timeline, /*flush=*/true);
+    ASSERT_FALSE(tail.empty());
+    EXPECT_EQ(tail.front().pts, 3'000'000);
+    EXPECT_EQ(tail.front().samples[0], 7);
+}
+
+TEST(AudioTimelineMixerTest, ExternalClockAnchorsEmptyMixer) {
+    auto timeline = make_mixer(20);
+    timeline.advance_clock(1'000'000);
+    timeline.advance_clock(1'400'000);
+    ASSERT_TRUE(timeline.add(0, make_packet(1'200'000, 960, 3)));
+    const auto blocks = drain(timeline, /*flush=*/true);
+    ASSERT_EQ(blocks.size(), 2u);
+    EXPECT_EQ(blocks[0].pts, 1'000'000);
+    EXPECT_EQ(blocks[0].samples[0], 0);
+    EXPECT_EQ(blocks[1].samples[0], 3);
+}
@@ -183,3 +183,67 @@ TEST(BoundedQueueTest, QueueNeverExceedsCapacity) {
 
     EXPECT_LE(max_observed.load(), 5u);
 }
+
+// ─── SingleProducer policy ────────────────────────────────────────────────────
+
+using SpscQueue = BoundedQueue<int, 4, sr::SingleProducer>;
+
+TEST(BoundedQueueSpscTest, PushPopAndCapacity) {
+    SpscQueue q;
+    for (int i = 0; i < 4; ++i) EXPECT_TRUE(q.try_push(std::move(i)));
+    EXPECT_TRUE(q.full());
+    EXPECT_FALSE(q.try_push(99));
+    EXPECT_EQ(SpscQueue::capacity(), 4u);
+    for (int i = 0; i < 4; ++i) {
+        auto v = q.try_pop();
+        ASSERT_TRUE(v.has_value());
+        EXPECT_EQ(*v, i);
+    }
+    EXPECT_TRUE(q.empty());
+}
+
+TEST(BoundedQueueSpscTest, WaitPopTimesOutWhenEmpty) {
+    SpscQueue q;
+    const auto t0 = std::chrono::steady_clock::now();
+    auto v = q.wait_pop(std::chrono::milliseconds(30));
+    const auto elapsed = std::chrono::steady_clock::now() - t0;
+    EXPECT_FALSE(v.has_value());
+    EXPECT_GE(elapsed, std::chrono::milliseconds(25));
+}
+
+TEST(BoundedQueueSpscTest, WaitPopWakesOnPush) {
+    SpscQueue q;
+    std::thread producer([&]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        q.try_push(7);
+    });
+    const auto t0 = std::chrono::steady_clock::now();
+    auto v = q.wait_pop(std::chrono::seconds(5));
+    const auto elapsed = std::chrono::steady_clock::now() - t0;
+    producer.join();
+    ASSERT_TRUE(v.has_value());
+    EXPECT_EQ(*v, 7);
+    EXPECT_LT(elapsed, std::chrono::seconds(2)); // woken, not timed out
+}
+
+TEST(BoundedQueueSpscTest, StreamPreservesOrderUnderContention) {
+    BoundedQueue<int, 3, sr::SingleProducer> q;
+    constexpr int kItems = 20000;
+    std::thread producer([&]() {
+        for (int i = 0; i < kItems; ) {
+            int v = i;
+            if (q.try_push(std::move(v))) ++i;
+            else std::this_thread::yield();
+        }
+    });
+
+    int expected = 0;
+    while (expected < kItems) {
+        auto v = q.wait_pop(std::chrono::milliseconds(100));
+        if (!v) continue;
+        ASSERT_EQ(*v, expected);
+        ++expected;
+    }
+    producer.join();
+    EXPECT_TRUE(q.empty());
+}
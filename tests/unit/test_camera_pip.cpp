@@ -0,0 +1,111 @@
+// test_camera_pip.cpp — Unit tests for camera picture-in-picture layout and hand-off
+
+#include <gtest/gtest.h>
+#include "capture/camera_pip.h"
+
+using sr::CameraMailbox;
+using sr::FrameRect;
+using sr::PipCorner;
+using sr::PipLayout;
+using sr::pip_dest_rect;
+
+TEST(CameraPipTest, DefaultLayoutIsBottomRightQuarterWidth) {
+    // 1280x720 camera in 1920x1080: 480x270 with a 38 px margin
+    const FrameRect r = pip_dest_rect(1280, 720, 1920, 1080, PipLayout{});
+    EXPECT_EQ(r.width(), 480u);
+    EXPECT_EQ(r.height(), 270u);
+    EXPECT_EQ(r.right, 1920u - 38u);
+    EXPECT_EQ(r.bottom, 1080u - 38u);
+}
+
+TEST(CameraPipTest, CornersAndEvenAlignment) {
+    PipLayout layout;
+    layout.corner = PipCorner::TopLeft;
+    const FrameRect tl = pip_dest_rect(640, 480, 1920, 1080, layout);
+    EXPECT_EQ(tl.left, 38u);
+    EXPECT_EQ(tl.top, 38u);
+    EXPECT_EQ(tl.width(), 480u);
+    EXPECT_EQ(tl.height(), 360u);
+
+    layout.corner = PipCorner::TopRight;
+    const FrameRect tr = pip_dest_rect(640, 480, 1366, 768, layout);
+    for (uint32_t v : { tr.left, tr.top, tr.right, tr.bottom }) EXPECT_EQ(v % 2, 0u);
+    EXPECT_LE(tr.right, 1366u);
+}
+
+TEST(CameraPipTest, ScalesWithOutputSoProxyMatchesMain) {
+    const FrameRect main  = pip_dest_rect(1280, 720, 1920, 1080, PipLayout{});
+    const FrameRect proxy = pip_dest_rect(1280, 720, 848, 480, PipLayout{});
+    EXPECT_NEAR(static_cast<double>(main.left) / 1920, static_cast<double>(proxy.left) / 848, 0.01);
+    EXPECT_NEAR(static_cast<double>(main.width()) / 1920, static_cast<double>(proxy.width()) / 848, 0.01);
+}
+
+TEST(CameraPipTest, PortraitCameraIsLimitedToOutputHeight) {
+    PipLayout layout;
+    layout.width_pct = 50;
+    const FrameRect r = pip_dest_rect(480, 1920, 1280, 720, layout);
+    EXPECT_LE(r.height(), 720u);
+    EXPECT_LE(r.bottom, 720u);
+    EXPECT_FALSE(r.empty());
+}
+
+TEST(CameraPipTest, DegenerateInputsGiveEmptyRect) {
+    EXPECT_TRUE(pip_dest_rect(0, 480, 1920, 1080, PipLayout{}).empty());
+    EXPECT_TRUE(pip_dest_rect(640, 480, 0, 0, PipLayout{}).empty());
+}
+
+TEST(CameraPipTest, MailboxKeepsLatestFrameAndForcesOpaque) {
+    CameraMailbox box;
+    std::vector<uint8_t> px;
+    uint32_t w = 0, h = 0;
+    uint64_t seq = 0;
+    EXPECT_FALSE(box.take(px, w, h, seq));
+
+    // 2x1 frame with a 12-byte stride (padding must be dropped)
+    const uint8_t first[12]  = { 1, 2, 3, 0, 4, 5, 6, 0, 9, 9, 9, 9 };
+    const uint8_t second[12] = { 7, 7, 7, 0, 8, 8, 8, 0, 9, 9, 9, 9 };
+    box.post(first, 2, 1, 12);
+    box.post(second, 2, 1, 12);
+    ASSERT_TRUE(box.take(px, w, h, seq));
+    EXPECT_EQ(w, 2u);
+    EXPECT_EQ(h, 1u);
+    ASSERT_EQ(px.size(), 8u);
+    EXPECT_EQ(px[0], 7);
+    EXPECT_EQ(px[3], 0xFF);
+    EXPECT_EQ(px[7], 0xFF);
+    EXPECT_EQ(seq, box.sequence());
+
+    // Nothing new since the last take
+    EXPECT_FALSE(box.take(px, w, h, seq));
+}
+
+TEST(CameraPipTest, MailboxClearStartsOverForTheNextConsumer) {
+    CameraMailbox box;
+    std::vector<uint8_t> px;
+    uint32_t w = 0, h = 0;
+    uint64_t seq = 0;
+    const uint8_t frame[8] = { 1, 2, 3, 0, 4, 5, 6, 0 };
+    box.post(frame, 2, 1, 8);
+    EXPECT_TRUE(box.pending(seq));
+    ASSERT_TRUE(box.take(px, w, h, seq));
+    EXPECT_FALSE(box.pending(seq));
+
+    // Posted but cleared before the consumer looked: nothing to draw
+    box.post(frame, 2, 1, 8);
+    box.clear();
+    EXPECT_EQ(box.sequence(), 0u);
+    uint64_t fresh = 0;
+    EXPECT_FALSE(box.pending(fresh));
+    EXPECT_FALSE(box.take(px, w, h, fresh));
+
+    box.post(frame, 2, 1, 8);
+    EXPECT_TRUE(box.pending(fresh));
+    EXPECT_TRUE(box.take(px, w, h, fresh));
+}
+
+TEST(CameraPipTest, MailboxRejectsShortStride) {
+    CameraMailbox box;
+    const uint8_t frame[4] = {};
+    box.post(frame, 2, 1, 4);
+    EXPECT_EQ(box.sequence(), 0u);
+}
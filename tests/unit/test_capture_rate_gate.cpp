@@ -0,0 +1,75 @@
+// test_capture_rate_gate.cpp — Unit tests for the source-side WGC rate limit
+
+#include <gtest/gtest.h>
+#include "capture/capture_rate_gate.h"
+
+using namespace sr;
+
+namespace {
+
+// Admitted count for `n` deliveries every `period_100ns`
+int admitted(CaptureRateGate& gate, int n, int64_t period_100ns, int64_t start = 0) {
+    int count = 0;
+    for (int i = 0; i < n; ++i) {
+        if (gate.admit(start + i * period_100ns)) ++count;
+    }
+    return count;
+}
+
+} // namespace
+
+TEST(CaptureRateGateTest, OffAdmitsEverything) {
+    CaptureRateGate gate;
+    EXPECT_EQ(gate.fps(), 0u);
+    EXPECT_EQ(admitted(gate, 144, 69'444), 144);
+}
+
+TEST(CaptureRateGateTest, HighRefreshKeepsTheTargetRate) {
+    CaptureRateGate gate;
+    gate.set_fps(30);
+    // Ten seconds of 144 Hz deliveries -> 30 fps, not 28.8 (every 5th) or 36
+    EXPECT_NEAR(admitted(gate, 1440, 69'444), 300, 1);
+
+    CaptureRateGate gate60;
+    gate60.set_fps(60);
+    EXPECT_NEAR(admitted(gate60, 1200, 83'333), 600, 1);
+}
+
+TEST(CaptureRateGateTest, SlowerSourcePassesThrough) {
+    CaptureRateGate gate;
+    gate.set_fps(60);
+    EXPECT_EQ(admitted(gate, 30, 333'333), 30);
+}
+
+TEST(CaptureRateGateTest, NextDueIsTheMissedSlot) {
+    CaptureRateGate gate;
+    gate.set_fps(30);
+    EXPECT_EQ(gate.next_due(), -1);
+    EXPECT_TRUE(gate.admit(1'000'000));
+    EXPECT_EQ(gate.next_due(), 1'333'333);
+    EXPECT_FALSE(gate.admit(1'100'000));
+    EXPECT_EQ(gate.next_due(), 1'333'333);   // turned-away frames don't move the grid
+    EXPECT_TRUE(gate.admit(1'333'333));
+    EXPECT_EQ(gate.next_due(), 1'666'666);
+}
+
+TEST(CaptureRateGateTest, GapRestartsTheGrid) {
+    CaptureRateGate gate;
+    gate.set_fps(30);
+    EXPECT_TRUE(gate.admit(0));
+    EXPECT_TRUE(gate.admit(50'000'000));      // static screen for 5 s
+    EXPECT_EQ(gate.next_due(), 50'333'333);
+    EXPECT_FALSE(gate.admit(50'100'000));
+}
+
+TEST(CaptureRateGateTest, RateChangeRestartsTheGrid) {
+    CaptureRateGate gate;
+    gate.set_fps(60);
+    EXPECT_TRUE(gate.admit(0));
+    gate.set_fps(30);
+    EXPECT_EQ(gate.fps(), 30u);
+    EXPECT_EQ(gate.next_due(), -1);
+    EXPECT_TRUE(gate.admit(10'000));
+    gate.set_fps(30);                         // unchanged: the grid stays
+    EXPECT_EQ(gate.next_due(), 343'333);
+}
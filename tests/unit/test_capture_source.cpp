@@ -0,0 +1,50 @@
+// test_capture_source.cpp — Unit tests for CaptureSource selection helpers
+
+#include <gtest/gtest.h>
+#include "capture/capture_source.h"
+
+using sr::CaptureSource;
+
+TEST(CaptureSourceTest, FactoriesSelectKind) {
+    EXPECT_EQ(CaptureSource::primary().kind, CaptureSource::Kind::PrimaryMonitor);
+    EXPECT_EQ(CaptureSource::monitor_at(0).kind, CaptureSource::Kind::PrimaryMonitor);
+
+    const auto second = CaptureSource::monitor_at(1);
+    EXPECT_EQ(second.kind, CaptureSource::Kind::Monitor);
+    EXPECT_EQ(second.monitor_index, 1u);
+    EXPECT_FALSE(second.is_window());
+
+    const auto win = CaptureSource::window_titled(L"Notepad");
+    EXPECT_TRUE(win.is_window());
+    EXPECT_EQ(win.window_title, L"Notepad");
+}
+
+TEST(CaptureSourceTest, TitleMatchIsCaseInsensitiveSubstring) {
+    EXPECT_TRUE(sr::title_matches(L"Untitled - Notepad", L"notepad"));
+    EXPECT_TRUE(sr::title_matches(L"Untitled - Notepad", L"TITLED"));
+    EXPECT_FALSE(sr::title_matches(L"Untitled - Notepad", L"Paint"));
+    EXPECT_FALSE(sr::title_matches(L"Pad", L"Notepad"));
+    EXPECT_FALSE(sr::title_matches(L"Anything", L""));
+}
+
+TEST(CaptureSourceTest, MonitorResolutionFallsBackToPrimary) {
+    const HMONITOR primary = MonitorFromPoint({ 0, 0 }, MONITOR_DEFAULTTOPRIMARY);
+    EXPECT_EQ(sr::resolve_monitor(CaptureSource::primary()), primary);
+    EXPECT_EQ(sr::resolve_monitor(CaptureSource::monitor_at(1000)), primary);
+
+    const auto monitors = sr::enumerate_monitors();
+    if (!monitors.empty()) EXPECT_EQ(monitors.front(), primary);
+}
+
+TEST(CaptureSourceTest, EffectiveSourceRectClipsAndEvens) {
+    using sr::FrameRect;
+    EXPECT_EQ(sr::effective_source_rect({}, 2560, 1440), (FrameRect{ 0, 0, 2560, 1440 }));
+    EXPECT_EQ(sr::effective_source_rect({ 641, 361, 1921, 1081 }, 2560, 1440),
+              (FrameRect{ 640, 360, 1920, 1080 }));
+    // Clipped to a smaller surface
+    EXPECT_EQ(sr::effective_source_rect({ 1280, 720, 2560, 1440 }, 1920, 1080),
+              (FrameRect{ 1280, 720, 1920, 1080 }));
+    // Crop entirely off-surface falls back to the whole surface
+    EXPECT_EQ(sr::effective_source_rect({ 3000, 0, 3200, 100 }, 1920, 1080),
+              (FrameRect{ 0, 0, 1920, 1080 }));
+}
@@ -0,0 +1,41 @@
+// test_cursor_overlay.cpp — Unit tests for software-cursor placement in the NV12 output
+
+#include <gtest/gtest.h>
+#include "capture/cursor_overlay.h"
+
+using sr::CursorQuad;
+using sr::FrameRect;
+using sr::map_cursor_quad;
+using sr::visible_rect;
+
+TEST(CursorOverlayTest, UnscaledOutputKeepsContentPosition) {
+    const FrameRect src{ 0, 0, 1920, 1080 };
+    EXPECT_EQ(map_cursor_quad(100, 200, 32, 32, src, 1920, 1080), (CursorQuad{ 100, 200, 132, 232 }));
+}
+
+TEST(CursorOverlayTest, ScalesAndRoundsOutward) {
+    // 2560x1440 -> 1920x1080 is 0.75; the quad must cover every touched pixel
+    const FrameRect src{ 0, 0, 2560, 1440 };
+    const CursorQuad q = map_cursor_quad(101, 201, 32, 32, src, 1920, 1080);
+    EXPECT_EQ(q.left, 75);      // floor(75.75)
+    EXPECT_EQ(q.top, 150);      // floor(150.75)
+    EXPECT_EQ(q.right, 100);    // ceil(99.75)
+    EXPECT_EQ(q.bottom, 175);   // ceil(174.75)
+}
+
+TEST(CursorOverlayTest, CropShiftsOriginAndMayPushCursorOffEdge) {
+    const FrameRect crop{ 500, 300, 1460, 840 };   // 960x540 to a 960x540 output
+    EXPECT_EQ(map_cursor_quad(510, 310, 16, 16, crop, 960, 540), (CursorQuad{ 10, 10, 26, 26 }));
+
+    const CursorQuad off = map_cursor_quad(490, 290, 16, 16, crop, 960, 540);
+    EXPECT_EQ(off, (CursorQuad{ -10, -10, 6, 6 }));
+    EXPECT_EQ(visible_rect(off, 960, 540), (FrameRect{ 0, 0, 6, 6 }));
+}
+
+TEST(CursorOverlayTest, CursorOutsideOutputHasNoDamage) {
+    const FrameRect src{ 0, 0, 1920, 1080 };
+    EXPECT_TRUE(visible_rect(map_cursor_quad(-64, 10, 32, 32, src, 1920, 1080), 1920, 1080).empty());
+    EXPECT_TRUE(visible_rect(map_cursor_quad(1930, 10, 32, 32, src, 1920, 1080), 1920, 1080).empty());
+    EXPECT_TRUE(map_cursor_quad(10, 10, 0, 32, src, 1920, 1080).empty());
+    EXPECT_TRUE(map_cursor_quad(10, 10, 32, 32, FrameRect{}, 1920, 1080).empty());
+}
@@ -0,0 +1,85 @@
+// test_dirty_region.cpp — Unit tests for DirtyRegion (WGC dirty-rect bookkeeping)
+
+#include <gtest/gtest.h>
+#include "utils/dirty_region.h"
+
+using sr::DirtyRegion;
+using sr::FrameRect;
+
+TEST(DirtyRegionTest, DefaultIsUnknownAndReportsNoRects) {
+    DirtyRegion region;
+    EXPECT_FALSE(region.known());
+    EXPECT_TRUE(region.empty());
+    region.reset(1920, 1080);
+    EXPECT_TRUE(region.known());
+    EXPECT_TRUE(region.empty());
+    region.clear_unknown();
+    EXPECT_FALSE(region.known());
+}
+
+TEST(DirtyRegionTest, ClipsAndDropsCoveredRects) {
+    DirtyRegion region;
+    region.reset(100, 100);
+    region.add({ 90, 90, 200, 200 });
+    ASSERT_EQ(region.size(), 1u);
+    EXPECT_EQ(region[0], (FrameRect{ 90, 90, 100, 100 }));
+
+    region.add({ 95, 95, 98, 98 });    // inside the first rect
+    region.add({ 10, 10, 10, 50 });    // zero width
+    region.add({ 120, 0, 130, 10 });   // fully off-surface
+    EXPECT_EQ(region.size(), 1u);
+}
+
+TEST(DirtyRegionTest, OverflowMergesIntoNearestRect) {
+    DirtyRegion region;
+    region.reset(4096, 4096);
+    for (uint32_t i = 0; i < DirtyRegion::kMaxRects; ++i) {
+        region.add({ i * 200, 0, i * 200 + 10, 10 });
+    }
+    ASSERT_EQ(region.size(), DirtyRegion::kMaxRects);
+
+    region.add({ 205, 0, 215, 10 });   // next to rect #1
+    ASSERT_EQ(region.size(), DirtyRegion::kMaxRects);
+    EXPECT_EQ(region[1], (FrameRect{ 200, 0, 215, 10 }));
+    EXPECT_EQ(region.bounds(), (FrameRect{ 0, 0, 15 * 200 + 10, 10 }));
+}
+
+TEST(DirtyRegionTest, ScalingRoundsOutward) {
+    DirtyRegion region;
+    region.reset(2560, 1440);
+    region.add({ 1, 1, 3, 3 });
+    const DirtyRegion out = region.scaled(848, 480);
+    ASSERT_TRUE(out.known());
+    ASSERT_EQ(out.size(), 1u);
+    EXPECT_EQ(out[0], (FrameRect{ 0, 0, 1, 1 }));
+
+    DirtyRegion full;
+    full.set_full(2560, 1440);
+    EXPECT_EQ(full.scaled(1920, 1080)[0], (FrameRect{ 0, 0, 1920, 1080 }));
+}
+
+TEST(DirtyRegionTest, EmptyKnownRegionStaysEmptyWhenScaled) {
+    DirtyRegion region;
+    region.reset(1920, 1080);
+    const DirtyRegion out = region.scaled(848, 480);
+    EXPECT_TRUE(out.known());
+    EXPECT_TRUE(out.empty());
+    EXPECT_FALSE(DirtyRegion{}.scaled(848, 480).known());
+}
+
+TEST(DirtyRegionTest, CroppedRebasesOntoCropOrigin) {
+    DirtyRegion content;
+    content.reset(2560, 1440);
+    content.add({ 100, 100, 200, 200 });     // outside the crop
+    content.add({ 1200, 700, 1400, 800 });   // inside the crop
+
+    const FrameRect crop{ 640, 360, 1920, 1080 };
+    const DirtyRegion local = content.cropped(crop);
+    ASSERT_TRUE(local.known());
+    EXPECT_EQ(local.width(), 1280u);
+    EXPECT_EQ(local.height(), 720u);
+    ASSERT_EQ(local.size(), 1u);
+    EXPECT_EQ(local[0], (FrameRect{ 560, 340, 760, 440 }));
+
+    EXPECT_FALSE(DirtyRegion{}.cropped(crop).known());
+}
@@ -0,0 +1,96 @@
+// test_encoder_scheduler.cpp — Unit tests for concurrent encoder placement / fps
+
+#include <gtest/gtest.h>
+#include "encoder/encoder_scheduler.h"
+
+using sr::EncoderCapacity;
+using sr::EncoderStreamRequest;
+
+namespace {
+
+constexpr EncoderStreamRequest k1080p30{ 1920, 1080, 30 };
+constexpr EncoderStreamRequest k1440p60{ 2560, 1440, 60 };
+
+EncoderCapacity capacity(uint32_t sessions, uint64_t hw_rate, uint64_t sw_rate) {
+    EncoderCapacity c;
+    c.hw_sessions   = sessions;
+    c.hw_pixel_rate = hw_rate;
+    c.sw_pixel_rate = sw_rate;
+    return c;
+}
+
+} // namespace
+
+TEST(EncoderSchedulerTest, ThreeMonitorsFitOnTheHardwareEncoder) {
+    const auto plan = sr::schedule_encoder_streams({ k1080p30, k1080p30, k1080p30 },
+                                                   capacity(8, sr::kHwEncoderPixelRate, 0));
+    ASSERT_EQ(plan.size(), 3u);
+    for (const auto& p : plan) {
+        EXPECT_TRUE(p.hardware);
+        EXPECT_EQ(p.fps, 30u);
+    }
+}
+
+TEST(EncoderSchedulerTest, SessionLimitSendsTheSmallestSecondaryToSoftware) {
+    const EncoderStreamRequest small{ 1280, 720, 30 };
+    const auto plan = sr::schedule_encoder_streams({ k1080p30, small, k1440p60 },
+                                                   capacity(2, sr::kHwEncoderPixelRate, sr::sw_encoder_pixel_rate(16)));
+    EXPECT_TRUE(plan[0].hardware);    // the primary always comes first
+    EXPECT_FALSE(plan[1].hardware);
+    EXPECT_TRUE(plan[2].hardware);    // the largest secondary next
+    EXPECT_EQ(plan[1].fps, 30u);
+}
+
+TEST(EncoderSchedulerTest, FullHardwareBudgetSpillsToSoftwareWithRoom) {
+    const uint64_t hw = k1080p30.pixel_rate() * 2;
+    const auto plan = sr::schedule_encoder_streams({ k1080p30, k1080p30, k1080p30 },
+                                                   capacity(8, hw, k1080p30.pixel_rate()));
+    EXPECT_TRUE(plan[0].hardware);
+    EXPECT_TRUE(plan[1].hardware);
+    EXPECT_FALSE(plan[2].hardware);
+    for (const auto& p : plan) EXPECT_EQ(p.fps, 30u);
+}
+
+TEST(EncoderSchedulerTest, PinnedPrimaryCountsAgainstTheHardwareItRunsOn) {
+    // A 4K60 main encode already over the hardware budget would fit software,
+    // but it is open on hardware: the secondary goes to software instead
+    const EncoderStreamRequest main4k{ 3840, 2160, 60, true };
+    const auto plan = sr::schedule_encoder_streams({ main4k, k1080p30 },
+                                                   capacity(2, sr::kHwEncoderPixelRate / 2, sr::sw_encoder_pixel_rate(64)));
+    EXPECT_TRUE(plan[0].hardware);
+    EXPECT_FALSE(plan[1].hardware);
+    EXPECT_EQ(plan[1].fps, 30u);
+
+    // With the only session taken by the pinned primary, nothing else gets hardware
+    const auto one = sr::schedule_encoder_streams({ main4k, k1080p30 },
+                                                  capacity(1, sr::kHwEncoderPixelRate, 0));
+    EXPECT_TRUE(one[0].hardware);
+    EXPECT_FALSE(one[1].hardware);
+}
+
+TEST(EncoderSchedulerTest, OverloadedPoolLowersSecondariesFirst) {
+    // Room for two streams: the primary keeps 30 fps, the others share the rest
+    const uint64_t hw = k1080p30.pixel_rate() * 2;
+    const auto plan = sr::schedule_encoder_streams({ k1080p30, k1080p30, k1080p30 },
+                                                   capacity(8, hw, 0));
+    EXPECT_EQ(plan[0].fps, 30u);
+    EXPECT_EQ(plan[1].fps, 15u);
+    EXPECT_EQ(plan[2].fps, 15u);
+}
+
+TEST(EncoderSchedulerTest, PrimaryIsLoweredOnlyOnceSecondariesHitTheFloor) {
+    const uint64_t sw = k1080p30.pixel_rate();
+    const auto plan = sr::schedule_encoder_streams({ k1080p30, k1080p30, k1080p30 },
+                                                   capacity(0, 0, sw));
+    EXPECT_FALSE(plan[0].hardware);
+    EXPECT_EQ(plan[1].fps, 15u);      // min_fps
+    EXPECT_EQ(plan[2].fps, 15u);
+    EXPECT_EQ(plan[0].fps, 15u);      // budget still exceeded: floor, best effort
+}
+
+TEST(EncoderSchedulerTest, SessionLimitsByVendor) {
+    EXPECT_EQ(sr::hw_encoder_session_limit(0x10DE), 8u);
+    EXPECT_GT(sr::hw_encoder_session_limit(0x8086), 8u);
+    EXPECT_GT(sr::sw_encoder_pixel_rate(16), sr::sw_encoder_pixel_rate(4));
+    EXPECT_GT(sr::sw_encoder_pixel_rate(1), 0u);
+}
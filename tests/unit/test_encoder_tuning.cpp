@@ -0,0 +1,43 @@
+// test_encoder_tuning.cpp — Unit tests for the per-power-state encoder knobs
+
+#include <gtest/gtest.h>
+#include "encoder/encoder_tuning.h"
+
+using namespace sr;
+
+TEST(EncoderTuningTest, AcRestoresMftDefaults) {
+    for (EncoderMode mode : { EncoderMode::HardwareMFT, EncoderMode::SoftwareMFT }) {
+        EXPECT_EQ(encoder_tuning_for(mode, true, false), EncoderTuning{});
+    }
+}
+
+TEST(EncoderTuningTest, BatteryUsesLowPowerPathOnHardwareOnly) {
+    const EncoderTuning hw = encoder_tuning_for(EncoderMode::HardwareMFT, false, false);
+    EXPECT_TRUE(hw.low_power);
+    EXPECT_LT(hw.quality_vs_speed, EncoderTuning{}.quality_vs_speed);
+    EXPECT_STREQ(encoder_tuning_label(hw), L"low-power");
+
+    const EncoderTuning sw = encoder_tuning_for(EncoderMode::SoftwareMFT, false, false);
+    EXPECT_FALSE(sw.low_power);
+    EXPECT_EQ(sw.quality_vs_speed, 0u);
+    EXPECT_STREQ(encoder_tuning_label(sw), L"speed");
+}
+
+TEST(EncoderTuningTest, HighQualityStepsDownLessOnBattery) {
+    for (EncoderMode mode : { EncoderMode::HardwareMFT, EncoderMode::SoftwareMFT,
+                              EncoderMode::SoftwareMFT720p }) {
+        const EncoderTuning hq_ac  = encoder_tuning_for(mode, true, true);
+        const EncoderTuning hq_bat = encoder_tuning_for(mode, false, true);
+        EXPECT_FALSE(hq_bat.low_power);
+        EXPECT_GE(hq_ac.quality_vs_speed, hq_bat.quality_vs_speed);
+        EXPECT_GT(hq_bat.quality_vs_speed, encoder_tuning_for(mode, false, false).quality_vs_speed);
+    }
+    EXPECT_STREQ(encoder_tuning_label(encoder_tuning_for(EncoderMode::HardwareMFT, true, true)),
+                 L"quality");
+}
+
+TEST(EncoderTuningTest, DegradedFallbackFavoursSpeed) {
+    EXPECT_EQ(encoder_tuning_for(EncoderMode::SoftwareMFT720p, true, false).quality_vs_speed, 0u);
+    EXPECT_LE(encoder_tuning_for(EncoderMode::SoftwareMFT720p, true, true).quality_vs_speed,
+              encoder_tuning_for(EncoderMode::SoftwareMFT, true, true).quality_vs_speed);
+}
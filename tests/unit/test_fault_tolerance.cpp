@@ -1,5 +1,5 @@
 // test_fault_tolerance.cpp — Phase 7 unit tests
-// Covers: T028 (disk space polling), T029 (exclusive file lock), T030 (orphan detection)
+// Covers: T028 (disk space projection), T029 (exclusive file lock), T030 (orphan detection)
 
 #include <gtest/gtest.h>
 #include <windows.h>
@@ -8,8 +8,12 @@
 #include <chrono>
 #include <thread>
 #include <string>
+#include <vector>
+#include <algorithm>
+#include <functional>
 
 #include "storage/storage_manager.h"
+#include "storage/disk_space_monitor.h"
 
 namespace fs = std::filesystem;
 
@@ -34,76 +38,106 @@ static void remove_temp_dir(const std::wstring& dir) {
 }
 
 // ============================================================================
-// T028 — Async disk space polling
+// T028 — Disk space projection (DiskSpaceMonitor, driven by the mux stage)
 // ============================================================================
 
-// Test: callback fires when threshold is set above current free space (always-low)
-TEST(DiskSpacePollingTest, CallbackFiresWhenBelowThreshold) {
-    sr::StorageManager sm;
-
-    std::atomic<int> call_count{ 0 };
-    // Use UINT64_MAX as threshold — guaranteed to be "low" on any machine
-    sm.startDiskSpacePolling(
-        [&]() { call_count.fetch_add(1, std::memory_order_relaxed); },
-        std::chrono::milliseconds(100),   // fast polling for test
-        UINT64_MAX                         // always-low threshold
-    );
-
-    // Wait up to 2 seconds for at least 1 callback
-    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
-    while (call_count.load() == 0 &&
-           std::chrono::steady_clock::now() < deadline) {
-        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+static constexpr uint64_t kMB = 1024ull * 1024;
+
+// Simulated volume: `free` shrinks by what the session writes
+struct FakeVolume {
+    uint64_t free    = 0;
+    int      queries = 0;
+    uint64_t operator()() { ++queries; return free; }
+};
+
+// Record at `mb_per_s` for `seconds`, one update per 100 ms like the mux loop
+static void record(sr::DiskSpaceMonitor& monitor, FakeVolume& volume, int64_t& now_ms,
+                   uint64_t& written, uint64_t mb_per_s, int seconds,
+                   std::vector<sr::DiskSpaceLevel>* changes = nullptr) {
+    for (int i = 0; i < seconds * 10; ++i) {
+        now_ms  += 100;
+        written += mb_per_s * kMB / 10;
+        volume.free -= std::min(volume.free, mb_per_s * kMB / 10);
+        if (monitor.update(now_ms, written, std::ref(volume)) && changes) {
+            changes->push_back(monitor.status().level);
+        }
     }
-
-    sm.stopDiskSpacePolling();
-    EXPECT_GE(call_count.load(), 1) << "Low-disk callback should have fired at least once";
 }
 
-// Test: callback does NOT fire when threshold is 0 (never-low)
-TEST(DiskSpacePollingTest, CallbackDoesNotFireWhenAboveThreshold) {
-    sr::StorageManager sm;
-
-    std::atomic<int> call_count{ 0 };
-    // threshold = 0 bytes — disk space will never be below 0
-    sm.startDiskSpacePolling(
-        [&]() { call_count.fetch_add(1, std::memory_order_relaxed); },
-        std::chrono::milliseconds(100),
-        0  // never fires
-    );
+TEST(DiskSpaceMonitorTest, ProjectsRemainingTimeFromWriteRate) {
+    sr::DiskSpaceMonitor monitor;
+    monitor.reset({});
+    FakeVolume volume{ 100'000 * kMB };
+    int64_t now_ms = 0;
+    uint64_t written = 0;
+    monitor.update(now_ms, written, std::ref(volume));
+    EXPECT_EQ(monitor.status().remaining_s, -1);   // no rate yet
+
+    record(monitor, volume, now_ms, written, 10, 10);
+    const auto& s = monitor.status();
+    EXPECT_NEAR(static_cast<double>(s.bytes_per_sec), 10.0 * kMB, 0.5 * kMB);
+    EXPECT_NEAR(static_cast<double>(s.remaining_s), (100'000.0 - 100 - 500) / 10, 50);
+    EXPECT_EQ(s.level, sr::DiskSpaceLevel::Ok);
+}
 
-    // Wait 500ms — callback should NOT fire
-    std::this_thread::sleep_for(std::chrono::milliseconds(500));
+TEST(DiskSpaceMonitorTest, RaisesEachTierOnceAndStopsAtReserve) {
+    sr::DiskSpaceMonitor monitor;
+    monitor.reset({});
+    // 50 MB/s with 20 min of space above the 500 MB reserve
+    FakeVolume volume{ 500 * kMB + 50 * kMB * 1200 };
+    int64_t now_ms = 0;
+    uint64_t written = 0;
+    std::vector<sr::DiskSpaceLevel> changes;
+    monitor.update(now_ms, written, std::ref(volume));
+    record(monitor, volume, now_ms, written, 50, 1300, &changes);
+
+    ASSERT_EQ(changes.size(), 3u);
+    EXPECT_EQ(changes[0], sr::DiskSpaceLevel::Low);
+    EXPECT_EQ(changes[1], sr::DiskSpaceLevel::Critical);
+    EXPECT_EQ(changes[2], sr::DiskSpaceLevel::Exhausted);
+}
 
-    sm.stopDiskSpacePolling();
-    EXPECT_EQ(call_count.load(), 0) << "Callback should not fire when disk is not low";
+TEST(DiskSpaceMonitorTest, QueriesRarelyWhileSpaceIsPlentiful) {
+    sr::DiskSpaceMonitor monitor;
+    monitor.reset({});
+    FakeVolume volume{ 1'000'000 * kMB };
+    int64_t now_ms = 0;
+    uint64_t written = 0;
+    monitor.update(now_ms, written, std::ref(volume));
+    record(monitor, volume, now_ms, written, 1, 300);   // 5 min at 1 MB/s
+    // The old poll thread would have asked 600 times
+    EXPECT_LE(volume.queries, 15);
 }
 
-// Test: stopDiskSpacePolling returns cleanly; a second stop is a no-op
-TEST(DiskSpacePollingTest, StopIsIdempotent) {
-    sr::StorageManager sm;
-    sm.startDiskSpacePolling([]() {}, std::chrono::milliseconds(500), 0);
-    sm.stopDiskSpacePolling(); // first stop
-    EXPECT_NO_FATAL_FAILURE(sm.stopDiskSpacePolling()); // second stop — no-op
+TEST(DiskSpaceMonitorTest, RecoversWhenSpaceIsFreed) {
+    sr::DiskSpaceMonitor monitor;
+    monitor.reset({});
+    FakeVolume volume{ 500 * kMB + 10 * kMB * 300 };   // 5 min at 10 MB/s
+    int64_t now_ms = 0;
+    uint64_t written = 0;
+    std::vector<sr::DiskSpaceLevel> changes;
+    monitor.update(now_ms, written, std::ref(volume));
+    record(monitor, volume, now_ms, written, 10, 10, &changes);
+    ASSERT_EQ(changes.size(), 1u);
+    EXPECT_EQ(changes[0], sr::DiskSpaceLevel::Low);
+
+    volume.free += 100'000 * kMB;
+    record(monitor, volume, now_ms, written, 10, 60, &changes);
+    ASSERT_EQ(changes.size(), 2u);
+    EXPECT_EQ(changes[1], sr::DiskSpaceLevel::Ok);
 }
 
-// Test: polling restarts correctly after stop+start
-TEST(DiskSpacePollingTest, CanRestartPolling) {
-    sr::StorageManager sm;
-    std::atomic<int> count1{ 0 }, count2{ 0 };
-
-    sm.startDiskSpacePolling([&]() { count1++; },
-                              std::chrono::milliseconds(100), UINT64_MAX);
-    std::this_thread::sleep_for(std::chrono::milliseconds(350));
-    sm.stopDiskSpacePolling();
-    int first_count = count1.load();
-    EXPECT_GE(first_count, 1);
-
-    sm.startDiskSpacePolling([&]() { count2++; },
-                              std::chrono::milliseconds(100), UINT64_MAX);
-    std::this_thread::sleep_for(std::chrono::milliseconds(350));
-    sm.stopDiskSpacePolling();
-    EXPECT_GE(count2.load(), 1);
+TEST(DiskSpaceMonitorTest, UnknownVolumeNeverStops) {
+    sr::DiskSpaceMonitor monitor;
+    monitor.reset({});
+    FakeVolume volume{ 0 };
+    int64_t now_ms = 0;
+    uint64_t written = 0;
+    std::vector<sr::DiskSpaceLevel> changes;
+    monitor.update(now_ms, written, std::ref(volume));
+    record(monitor, volume, now_ms, written, 10, 30, &changes);
+    EXPECT_TRUE(changes.empty());
+    EXPECT_EQ(monitor.status().level, sr::DiskSpaceLevel::Ok);
 }
 
 // ============================================================================
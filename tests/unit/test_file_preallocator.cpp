@@ -0,0 +1,71 @@
+// test_file_preallocator.cpp — Unit tests for output extent preallocation
+
+#include <gtest/gtest.h>
+#include "storage/file_preallocator.h"
+#include <filesystem>
+
+namespace fs = std::filesystem;
+using sr::FilePreallocator;
+
+static constexpr uint64_t kMB = 1ull << 20;
+
+TEST(FilePreallocatorTest, IncrementTracksBitrateWithinBounds) {
+    EXPECT_EQ(sr::preallocation_increment(128'000), 64 * kMB);        // floor
+    EXPECT_EQ(sr::preallocation_increment(8'000'000), 300'000'000ull); // 5 min at 8 Mbps
+    EXPECT_EQ(sr::preallocation_increment(100'000'000), 1024 * kMB);   // cap
+}
+
+class FilePreallocatorFileTest : public ::testing::Test {
+protected:
+    std::wstring path;
+    HANDLE file = INVALID_HANDLE_VALUE;
+
+    void SetUp() override {
+        wchar_t tmp[MAX_PATH];
+        GetTempPathW(MAX_PATH, tmp);
+        path = std::wstring(tmp) + L"sr_prealloc_" + std::to_wstring(GetCurrentProcessId()) + L".bin";
+        file = CreateFileW(path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr,
+                           CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+    }
+
+    void TearDown() override {
+        if (file != INVALID_HANDLE_VALUE) CloseHandle(file);
+        std::error_code ec;
+        fs::remove(path, ec);
+    }
+
+    uint64_t allocation() const {
+        FILE_STANDARD_INFO info{};
+        GetFileInformationByHandleEx(file, FileStandardInfo, &info, sizeof(info));
+        return static_cast<uint64_t>(info.AllocationSize.QuadPart);
+    }
+};
+
+TEST_F(FilePreallocatorFileTest, ExtendsInStepsAndTrimsToEof) {
+    ASSERT_NE(file, INVALID_HANDLE_VALUE);
+    FilePreallocator prealloc;
+    prealloc.reset(file, 64 * kMB);
+
+    ASSERT_TRUE(prealloc.extend_for(0));
+    EXPECT_EQ(prealloc.allocated(), 64 * kMB);
+    EXPECT_GE(allocation(), 64 * kMB);
+
+    // Within the first half-step: no new extension
+    EXPECT_TRUE(prealloc.extend_for(20 * kMB));
+    EXPECT_EQ(prealloc.extensions(), 1u);
+
+    EXPECT_TRUE(prealloc.extend_for(40 * kMB));
+    EXPECT_EQ(prealloc.extensions(), 2u);
+    EXPECT_EQ(prealloc.allocated(), 128 * kMB);
+
+    // End-of-file is untouched by preallocation
+    LARGE_INTEGER size{};
+    ASSERT_TRUE(GetFileSizeEx(file, &size));
+    EXPECT_EQ(size.QuadPart, 0);
+
+    const char data[4096] = {};
+    DWORD written = 0;
+    ASSERT_TRUE(WriteFile(file, data, sizeof(data), &written, nullptr));
+    prealloc.trim();
+    EXPECT_LT(allocation(), 1 * kMB);
+}
@@ -0,0 +1,75 @@
+// test_frame_tap.cpp — Unit tests for the frame tap's shared header protocol
+
+#include <gtest/gtest.h>
+#include "capture/frame_tap_layout.h"
+
+#include <memory>
+#include <set>
+
+using namespace sr;
+
+TEST(FrameTapLayoutTest, HeaderIsSelfDescribing) {
+    auto h = std::make_unique<FrameTapHeader>();
+    EXPECT_EQ(h->magic, kFrameTapMagic);
+    EXPECT_EQ(h->version, kFrameTapVersion);
+    EXPECT_EQ(h->header_size, sizeof(FrameTapHeader));
+    // Fixed-size fields only: the same layout in 32- and 64-bit consumers
+    EXPECT_EQ(sizeof(FrameTapHeader) % 8, 0u);
+}
+
+TEST(FrameTapLayoutTest, TextureNamesAreUniquePerGenerationAndSlot) {
+    std::set<std::wstring> names;
+    for (uint32_t g : { 1u, 2u, 12u }) {
+        for (uint32_t s = 0; s < kFrameTapMaxSlots; ++s) names.insert(frame_tap_texture_name(g, s));
+    }
+    EXPECT_EQ(names.size(), 3u * kFrameTapMaxSlots);
+    EXPECT_EQ(frame_tap_texture_name(7, 2), L"Local\\ScreenRecorderFrameTap_7_2");
+}
+
+TEST(FrameTapLayoutTest, FormatIsOnlyReadableBetweenGenerations) {
+    auto h = std::make_unique<FrameTapHeader>();
+    FrameTapFormat f;
+    EXPECT_FALSE(read_frame_tap_format(*h, f));   // producer not up
+
+    h->producer_alive = 1;
+    h->width  = 1920;
+    h->height = 1080;
+    EXPECT_FALSE(read_frame_tap_format(*h, f));   // generation 0: re-creating
+    h->generation = 5;
+    ASSERT_TRUE(read_frame_tap_format(*h, f));
+    EXPECT_EQ(f.generation, 5u);
+    EXPECT_EQ(f.width, 1920u);
+    EXPECT_EQ(f.height, 1080u);
+
+    h->producer_alive = 0;
+    EXPECT_FALSE(read_frame_tap_format(*h, f));
+    h->producer_alive = 1;
+    h->magic = 0;
+    EXPECT_FALSE(read_frame_tap_format(*h, f));
+}
+
+TEST(FrameTapLayoutTest, ProducerSkipsSlotsHeldByConsumers) {
+    bool held[3] = { false, false, false };
+    auto try_lock = [&](uint32_t s) { return !held[s]; };
+
+    // Starts after the latest slot so a reader of the latest frame keeps it
+    EXPECT_EQ(pick_frame_tap_slot(0, 3, try_lock), 1u);
+    EXPECT_EQ(pick_frame_tap_slot(2, 3, try_lock), 0u);
+
+    held[1] = true;
+    EXPECT_EQ(pick_frame_tap_slot(0, 3, try_lock), 2u);
+    held[2] = true;
+    EXPECT_EQ(pick_frame_tap_slot(0, 3, try_lock), 0u);   // only the latest is free
+    held[0] = true;
+    EXPECT_EQ(pick_frame_tap_slot(0, 3, try_lock), kFrameTapMaxSlots);
+}
+
+TEST(FrameTapLayoutTest, PublishRecordsSlotSequenceAndPts) {
+    auto h = std::make_unique<FrameTapHeader>();
+    publish_frame_tap_slot(*h, 2, 41, 123'456);
+    EXPECT_EQ(h->latest_slot.load(), 2u);
+    EXPECT_EQ(h->latest_sequence.load(), 41u);
+    EXPECT_EQ(h->slots[2].sequence.load(), 41u);
+    EXPECT_EQ(h->slots[2].pts.load(), 123'456);
+    EXPECT_EQ(h->slots[0].sequence.load(), 0u);
+}
@@ -0,0 +1,49 @@
+// test_hdr_tonemap.cpp — Unit tests for the HDR -> SDR highlight shoulder
+
+#include <gtest/gtest.h>
+#include "capture/hdr_tonemap.h"
+
+using sr::hdr_shoulder;
+using sr::HdrToneMapper;
+
+namespace {
+constexpr float kKnee = HdrToneMapper::kKnee;
+}
+
+TEST(HdrToneMapTest, SdrRangeBelowKneeIsUntouched) {
+    for (float x : { 0.0f, 0.1f, 0.5f, kKnee }) {
+        EXPECT_FLOAT_EQ(hdr_shoulder(x, kKnee, 4.0f), x);
+    }
+}
+
+TEST(HdrToneMapTest, DisplayPeakMapsToSdrWhite) {
+    EXPECT_NEAR(hdr_shoulder(4.0f, kKnee, 4.0f), 1.0f, 1e-5f);
+    EXPECT_NEAR(hdr_shoulder(12.5f, kKnee, 12.5f), 1.0f, 1e-5f);
+    // Beyond the reported peak stays clipped at white
+    EXPECT_FLOAT_EQ(hdr_shoulder(20.0f, kKnee, 4.0f), 1.0f);
+}
+
+TEST(HdrToneMapTest, ShoulderIsContinuousAndMonotonic) {
+    EXPECT_NEAR(hdr_shoulder(kKnee + 1e-4f, kKnee, 4.0f), kKnee, 1e-3f);
+    float prev = 0.0f;
+    for (float x = 0.0f; x <= 4.0f; x += 0.05f) {
+        const float y = hdr_shoulder(x, kKnee, 4.0f);
+        EXPECT_GE(y, prev) << "x=" << x;
+        EXPECT_LE(y, 1.0f);
+        prev = y;
+    }
+}
+
+TEST(HdrToneMapTest, NoHeadroomClipsAtWhite) {
+    EXPECT_FLOAT_EQ(hdr_shoulder(0.9f, kKnee, 1.0f), 0.9f);
+    EXPECT_FLOAT_EQ(hdr_shoulder(1.5f, kKnee, 1.0f), 1.0f);
+}
+
+TEST(HdrToneMapTest, NoHeadroomIsTheLimitOfTheShoulder) {
+    // Highlights between the knee and SDR white pass through, as the
+    // roll-off does when the peak approaches 1 from above
+    for (float x = kKnee; x <= 1.5f; x += 0.05f) {
+        EXPECT_FLOAT_EQ(hdr_shoulder(x, kKnee, 1.0f), x < 1.0f ? x : 1.0f) << "x=" << x;
+        EXPECT_NEAR(hdr_shoulder(x, kKnee, 1.0f), hdr_shoulder(x, kKnee, 1.0001f), 1e-3f) << "x=" << x;
+    }
+}
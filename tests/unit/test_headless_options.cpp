@@ -0,0 +1,53 @@
+// test_headless_options.cpp — Unit tests for the headless mode's command line
+
+#include <gtest/gtest.h>
+#include "app/headless_options.h"
+
+using sr::HeadlessOptions;
+
+TEST(HeadlessOptionsTest, EmptyCommandLineKeepsTheSettings) {
+    HeadlessOptions opt;
+    ASSERT_TRUE(sr::parse_headless_options({}, opt));
+    EXPECT_EQ(opt.profile, HeadlessOptions::Profile::Settings);
+    EXPECT_EQ(opt.duration_s, 0.0);
+    EXPECT_TRUE(opt.output_dir.empty());
+    EXPECT_FALSE(opt.segments_given);
+}
+
+TEST(HeadlessOptionsTest, ParsesEveryOption) {
+    HeadlessOptions opt;
+    ASSERT_TRUE(sr::parse_headless_options({ L"--profile", L"hq", L"--duration", L"90.5",
+                                             L"--output", L"C:\\ci\\run42.mp4",
+                                             L"--segment-mb", L"500", L"--summary", L"out.json" }, opt));
+    EXPECT_EQ(opt.profile, HeadlessOptions::Profile::HighQuality);
+    EXPECT_DOUBLE_EQ(opt.duration_s, 90.5);
+    EXPECT_EQ(opt.output_dir, L"C:\\ci");
+    EXPECT_EQ(opt.output_stem, L"run42");
+    EXPECT_TRUE(opt.segments_given);
+    EXPECT_EQ(opt.segment_mb, 500u);
+    EXPECT_EQ(opt.segment_minutes, 0u);
+    EXPECT_EQ(opt.summary_path, L"out.json");
+}
+
+TEST(HeadlessOptionsTest, OutputWithoutMp4IsADirectory) {
+    HeadlessOptions opt;
+    ASSERT_TRUE(sr::parse_headless_options({ L"--output", L"D:\\Recordings" }, opt));
+    EXPECT_EQ(opt.output_dir, L"D:\\Recordings");
+    EXPECT_TRUE(opt.output_stem.empty());
+
+    ASSERT_TRUE(sr::parse_headless_options({ L"--output", L"Take.MP4" }, opt));
+    EXPECT_EQ(opt.output_dir, L".");
+    EXPECT_EQ(opt.output_stem, L"Take");
+}
+
+TEST(HeadlessOptionsTest, RejectsBadValuesAndUnknownOptions) {
+    HeadlessOptions opt;
+    EXPECT_FALSE(sr::parse_headless_options({ L"--profile", L"ultra" }, opt));
+    EXPECT_FALSE(opt.error.empty());
+    EXPECT_FALSE(sr::parse_headless_options({ L"--duration", L"-3" }, opt));
+    EXPECT_FALSE(sr::parse_headless_options({ L"--duration", L"10s" }, opt));
+    EXPECT_FALSE(sr::parse_headless_options({ L"--segment-minutes", L"-1" }, opt));
+    EXPECT_FALSE(sr::parse_headless_options({ L"--segment-mb" }, opt));
+    EXPECT_FALSE(sr::parse_headless_options({ L"--camera", L"on" }, opt));
+    EXPECT_NE(opt.error.find(L"--camera"), std::wstring::npos);
+}
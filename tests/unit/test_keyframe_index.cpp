@@ -0,0 +1,72 @@
+// test_keyframe_index.cpp — Unit tests for the keyframe index sidecar and trim cut points
+
+#include <gtest/gtest.h>
+#include <filesystem>
+#include "storage/keyframe_index.h"
+#include "storage/mp4_trim.h"
+
+static constexpr int64_t kSec = 10'000'000;
+
+// 1 fps video, a keyframe every `gop` frames, `bytes` per frame
+static sr::KeyframeIndex make_index(int seconds, int gop, uint32_t bytes = 1000) {
+    sr::KeyframeIndex index;
+    for (int i = 0; i < seconds; ++i) index.on_video_sample(i * kSec, bytes, i % gop == 0);
+    return index;
+}
+
+TEST(KeyframeIndexTest, RecordsKeyframesWithFrameAndStreamPosition) {
+    const sr::KeyframeIndex index = make_index(10, 4);
+    ASSERT_EQ(index.entries().size(), 3u);
+    EXPECT_EQ(index.entries()[1], (sr::KeyframeEntry{ 4 * kSec, 4, 4000 }));
+    EXPECT_EQ(index.entries()[2], (sr::KeyframeEntry{ 8 * kSec, 8, 8000 }));
+    EXPECT_EQ(index.frames(), 10u);
+    EXPECT_EQ(index.stream_bytes(), 10'000u);
+}
+
+TEST(KeyframeIndexTest, CutStartSnapsBackToKeyframe) {
+    const sr::KeyframeIndex index = make_index(10, 4);
+    EXPECT_EQ(sr::lossless_cut_start(index, 0), 0);
+    EXPECT_EQ(sr::lossless_cut_start(index, 5 * kSec), 4 * kSec);
+    EXPECT_EQ(sr::lossless_cut_start(index, 8 * kSec), 8 * kSec);
+    EXPECT_EQ(sr::lossless_cut_start(index, 60 * kSec), 8 * kSec);
+    EXPECT_EQ(sr::lossless_cut_start(index, -kSec), 0);
+
+    // No index: the requested time goes to the container seek unchanged
+    EXPECT_EQ(sr::lossless_cut_start(sr::KeyframeIndex{}, 5 * kSec), 5 * kSec);
+}
+
+TEST(KeyframeIndexTest, SerializeRoundTrips) {
+    const sr::KeyframeIndex index = make_index(20, 5);
+    const std::vector<uint8_t> bytes = index.serialize();
+    EXPECT_EQ(bytes.size(), sr::KeyframeIndex::kHeaderSize + 4 * sr::KeyframeIndex::kEntrySize);
+
+    sr::KeyframeIndex parsed;
+    ASSERT_TRUE(sr::KeyframeIndex::parse(bytes.data(), bytes.size(), parsed));
+    EXPECT_EQ(parsed.entries(), index.entries());
+}
+
+TEST(KeyframeIndexTest, RejectsCorruptOrTruncatedData) {
+    std::vector<uint8_t> bytes = make_index(10, 2).serialize();
+    sr::KeyframeIndex parsed;
+    EXPECT_FALSE(sr::KeyframeIndex::parse(bytes.data(), bytes.size() - 1, parsed));
+    EXPECT_TRUE(parsed.empty());
+    EXPECT_FALSE(sr::KeyframeIndex::parse(bytes.data(), 8, parsed));
+
+    bytes[0] ^= 0xFF;
+    EXPECT_FALSE(sr::KeyframeIndex::parse(bytes.data(), bytes.size(), parsed));
+}
+
+TEST(KeyframeIndexTest, SavesAndLoadsSidecar) {
+    const std::wstring media = (std::filesystem::temp_directory_path() / L"sr_keyidx_test.mp4").wstring();
+    const std::wstring path  = sr::KeyframeIndex::sidecar_path(media);
+    EXPECT_EQ(path, media + L".keyidx");
+
+    const sr::KeyframeIndex index = make_index(30, 10);
+    ASSERT_TRUE(index.save(path));
+    sr::KeyframeIndex loaded;
+    ASSERT_TRUE(sr::KeyframeIndex::load(path, loaded));
+    EXPECT_EQ(loaded.entries(), index.entries());
+
+    std::filesystem::remove(path);
+    EXPECT_FALSE(sr::KeyframeIndex::load(path, loaded));
+}
@@ -0,0 +1,36 @@
+// test_keyframe_schedule.cpp — Unit tests for KeyframeSchedule (time-based IDR cadence)
+
+#include <gtest/gtest.h>
+#include "sync/keyframe_schedule.h"
+
+using sr::KeyframeSchedule;
+
+TEST(KeyframeScheduleTest, DisabledNeverDue) {
+    KeyframeSchedule s;
+    s.reset(0);
+    EXPECT_FALSE(s.enabled());
+    EXPECT_FALSE(s.due(0));
+    EXPECT_FALSE(s.due(100'000'000));
+}
+
+TEST(KeyframeScheduleTest, FirstFrameAndEachIntervalAreDue) {
+    KeyframeSchedule s;
+    s.reset(20'000'000);  // 2 s
+    constexpr int64_t kFrame = 333'333;  // 30 fps
+    uint32_t due = 0;
+    for (int64_t f = 0; f < 180; ++f) {   // 6 s
+        if (s.due(f * kFrame)) ++due;
+    }
+    EXPECT_EQ(due, 3u);
+    EXPECT_EQ(s.count(), 3u);
+}
+
+TEST(KeyframeScheduleTest, LongGapYieldsSingleKeyframe) {
+    KeyframeSchedule s;
+    s.reset(20'000'000);
+    EXPECT_TRUE(s.due(0));
+    // Static screen: next frame arrives 10 s later — one IDR, not five
+    EXPECT_TRUE(s.due(100'000'000));
+    EXPECT_FALSE(s.due(100'333'333));
+    EXPECT_TRUE(s.due(120'000'000));
+}
@@ -0,0 +1,61 @@
+// test_latency_histogram.cpp — Unit tests for LatencyHistogram (log-linear, lock-free)
+
+#include <gtest/gtest.h>
+#include "utils/latency_histogram.h"
+
+#include <thread>
+#include <vector>
+
+using sr::LatencyHistogram;
+
+TEST(LatencyHistogramTest, EmptyReportsZero) {
+    LatencyHistogram h;
+    EXPECT_EQ(h.count(), 0u);
+    EXPECT_EQ(h.percentile(50.0), 0u);
+    EXPECT_EQ(h.max(), 0u);
+}
+
+TEST(LatencyHistogramTest, BucketsAreContiguousAndBounded) {
+    // Every value lands in a bucket whose range contains it, within 1/16 precision
+    for (uint64_t v : { 0ull, 1ull, 15ull, 16ull, 31ull, 32ull, 33ull, 1000ull,
+                        16'667ull, 1'000'000ull, 30'000'000ull }) {
+        const size_t b = LatencyHistogram::bucket_for(v);
+        ASSERT_LT(b, LatencyHistogram::kBucketCount);
+        const uint64_t hi = LatencyHistogram::bucket_upper(b);
+        const uint64_t lo = b == 0 ? 0 : LatencyHistogram::bucket_upper(b - 1);
+        EXPECT_LE(lo, v) << v;
+        EXPECT_LT(v, hi) << v;
+        EXPECT_LE(hi - lo, (v / 16) + 1) << v;
+    }
+    // Values past the top exponent clamp into the last bucket
+    EXPECT_EQ(LatencyHistogram::bucket_for(UINT64_MAX), LatencyHistogram::kBucketCount - 1);
+}
+
+TEST(LatencyHistogramTest, PercentilesTrackDistribution) {
+    LatencyHistogram h;
+    for (int i = 0; i < 990; ++i) h.record(2'000);    // 2 ms
+    for (int i = 0; i < 10; ++i)  h.record(50'000);   // 50 ms tail
+    EXPECT_EQ(h.count(), 1000u);
+    EXPECT_NEAR(static_cast<double>(h.percentile(50.0)), 2'000.0, 2'000.0 / 16);
+    EXPECT_NEAR(static_cast<double>(h.percentile(99.0)), 2'000.0, 2'000.0 / 16);
+    EXPECT_EQ(h.percentile(99.9), 50'000u);            // capped at the recorded max
+    EXPECT_EQ(h.max(), 50'000u);
+
+    h.record(-5);                                      // clock skew clamps to 0
+    EXPECT_EQ(h.percentile(0.0), 0u);
+    h.reset();
+    EXPECT_EQ(h.count(), 0u);
+}
+
+TEST(LatencyHistogramTest, ConcurrentRecordsAreAllCounted) {
+    LatencyHistogram h;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&h, t] {
+            for (int i = 0; i < 10'000; ++i) h.record(t * 1000 + i % 500);
+        });
+    }
+    for (auto& th : threads) th.join();
+    EXPECT_EQ(h.count(), 40'000u);
+    EXPECT_EQ(h.max(), 3'499u);
+}
@@ -0,0 +1,113 @@
+// test_log_ring.cpp — Unit tests for the lock-free MPSC log ring behind sr::Logger
+
+#include <gtest/gtest.h>
+#include "utils/log_ring.h"
+#include <atomic>
+#include <cwchar>
+#include <string>
+#include <thread>
+#include <vector>
+
+using sr::LogLevel;
+
+namespace {
+
+using SmallRing = sr::LogRing<8, 64>;
+
+bool push_number(SmallRing& ring, int n, LogLevel level = LogLevel::Info) {
+    return ring.try_push(level, [n](wchar_t* buf, size_t chars) {
+        swprintf(buf, chars, L"line %d", n);
+    });
+}
+
+std::wstring pop_text(SmallRing& ring) {
+    std::wstring text;
+    if (!ring.try_pop([&](const SmallRing::Line& line) { text = line.text; })) return L"<empty>";
+    return text;
+}
+
+} // namespace
+
+TEST(LogRingTest, PopsInPushOrder) {
+    SmallRing ring;
+    ASSERT_TRUE(push_number(ring, 1));
+    ASSERT_TRUE(push_number(ring, 2, LogLevel::Error));
+    EXPECT_EQ(pop_text(ring), L"line 1");
+
+    LogLevel level = LogLevel::Debug;
+    ASSERT_TRUE(ring.try_pop([&](const SmallRing::Line& line) { level = line.level; }));
+    EXPECT_EQ(level, LogLevel::Error);
+    EXPECT_EQ(pop_text(ring), L"<empty>");
+}
+
+TEST(LogRingTest, FullRingDropsInsteadOfBlocking) {
+    SmallRing ring;
+    for (int i = 0; i < 8; ++i) ASSERT_TRUE(push_number(ring, i));
+    EXPECT_FALSE(push_number(ring, 8));
+    EXPECT_FALSE(push_number(ring, 9));
+    EXPECT_EQ(ring.dropped(), 2u);
+
+    // Draining one slot makes room again; the dropped lines stay dropped
+    EXPECT_EQ(pop_text(ring), L"line 0");
+    EXPECT_TRUE(push_number(ring, 10));
+    for (int i = 1; i < 8; ++i) EXPECT_EQ(pop_text(ring), L"line " + std::to_wstring(i));
+    EXPECT_EQ(pop_text(ring), L"line 10");
+}
+
+TEST(LogRingTest, WrapsAroundManyLaps) {
+    SmallRing ring;
+    for (int i = 0; i < 100; ++i) {
+        ASSERT_TRUE(push_number(ring, i));
+        ASSERT_EQ(pop_text(ring), L"line " + std::to_wstring(i));
+    }
+    EXPECT_EQ(ring.dropped(), 0u);
+}
+
+TEST(LogRingTest, LongLinesAreTruncated) {
+    SmallRing ring;
+    ASSERT_TRUE(ring.try_push(LogLevel::Warn, [](wchar_t* buf, size_t chars) {
+        for (size_t i = 0; i < chars; ++i) buf[i] = L'x';   // no terminator
+    }));
+    EXPECT_EQ(pop_text(ring).size(), 63u);
+}
+
+TEST(LogRingTest, ConcurrentProducersLoseNothingWhenDrained) {
+    sr::LogRing<1024, 32> ring;
+    constexpr int kThreads = 4;
+    constexpr int kPerThread = 5000;
+
+    std::vector<int> next(kThreads, 0);
+    bool in_order = true;
+    int popped = 0;
+    std::atomic<int> done{ 0 };
+
+    std::vector<std::thread> producers;
+    for (int t = 0; t < kThreads; ++t) {
+        producers.emplace_back([&ring, &done, t]() {
+            for (int i = 0; i < kPerThread; ++i) {
+                while (!ring.try_push(LogLevel::Info, [&](wchar_t* buf, size_t chars) {
+                    swprintf(buf, chars, L"%d %d", t, i);
+                })) {
+                    std::this_thread::yield();
+                }
+            }
+            done.fetch_add(1);
+        });
+    }
+
+    auto consume = [&](const sr::LogRing<1024, 32>::Line& line) {
+        int t = -1, i = -1;
+        swscanf(line.text, L"%d %d", &t, &i);
+        if (t < 0 || t >= kThreads || next[t] != i) in_order = false;
+        else ++next[t];
+        ++popped;
+    };
+    while (done.load() < kThreads) {
+        if (!ring.try_pop(consume)) std::this_thread::yield();
+    }
+    while (ring.try_pop(consume)) {}
+    for (auto& p : producers) p.join();
+
+    EXPECT_EQ(popped, kThreads * kPerThread);
+    EXPECT_TRUE(in_order);   // per-producer FIFO
+}
@@ -0,0 +1,91 @@
+// test_mdat_scan.cpp — Unit tests for moov-less MP4 recovery (mdat scan + moov rebuild)
+
+#include <gtest/gtest.h>
+#include "storage/mdat_scan.h"
+
+namespace {
+
+void put_nal(std::vector<uint8_t>& out, std::initializer_list<uint8_t> payload) {
+    const uint32_t n = static_cast<uint32_t>(payload.size());
+    for (int i = 0; i < 4; ++i) out.push_back(static_cast<uint8_t>(n >> (24 - 8 * i)));
+    out.insert(out.end(), payload);
+}
+
+// IDR AU, an audio chunk, a P AU, an AUD-led P AU, then a torn NAL
+struct SyntheticMdat {
+    std::vector<uint8_t> bytes;
+    uint64_t au[3]{};
+    uint64_t audio_begin = 0, audio_end = 0, torn = 0;
+
+    SyntheticMdat() {
+        au[0] = bytes.size();
+        put_nal(bytes, { 0x67, 0x42, 0x00, 0x1F, 0xAA });         // SPS
+        put_nal(bytes, { 0x68, 0xCE, 0x38, 0x80 });               // PPS
+        put_nal(bytes, { 0x65, 0x88, 0x84, 0x00, 0x10, 0x20 });   // IDR slice
+        audio_begin = bytes.size();
+        bytes.insert(bytes.end(), 64, 0xFF);                     // raw AAC
+        audio_end = bytes.size();
+        au[1] = bytes.size();
+        put_nal(bytes, { 0x41, 0x9A, 0x02, 0x03, 0x04 });         // P slice
+        au[2] = bytes.size();
+        put_nal(bytes, { 0x09, 0xF0 });                           // AUD
+        put_nal(bytes, { 0x41, 0x9A, 0x05, 0x06 });               // P slice
+        torn = bytes.size();
+        bytes.insert(bytes.end(), { 0x00, 0x00, 0x01, 0x00, 0x41, 0x9A, 0x07 });   // 256 bytes declared
+    }
+};
+
+} // namespace
+
+TEST(MdatScanTest, GroupsAccessUnitsAndSkipsAudioAndTornTail) {
+    const SyntheticMdat m;
+    const sr::MdatScan scan = sr::scan_avcc_mdat(m.bytes.data(), 0, m.bytes.size());
+
+    ASSERT_EQ(scan.video.size(), 3u);
+    EXPECT_EQ(scan.video[0].offset, m.au[0]);
+    EXPECT_EQ(scan.video[0].size, m.audio_begin - m.au[0]);
+    EXPECT_TRUE(scan.video[0].keyframe);
+    EXPECT_EQ(scan.video[1].offset, m.au[1]);
+    EXPECT_EQ(scan.video[1].size, m.au[2] - m.au[1]);
+    EXPECT_FALSE(scan.video[1].keyframe);
+    EXPECT_EQ(scan.video[2].offset, m.au[2]);
+    EXPECT_EQ(scan.video[2].size, m.torn - m.au[2]);
+
+    EXPECT_EQ(scan.skipped_bytes, m.audio_end - m.audio_begin);
+    EXPECT_EQ(scan.data_end, m.torn);
+    EXPECT_EQ(scan.sps, (std::vector<uint8_t>{ 0x67, 0x42, 0x00, 0x1F, 0xAA }));
+    EXPECT_EQ(scan.pps, (std::vector<uint8_t>{ 0x68, 0xCE, 0x38, 0x80 }));
+}
+
+TEST(MdatScanTest, ZeroFilledMdatYieldsNothing) {
+    const std::vector<uint8_t> zeros(4096, 0);
+    const sr::MdatScan scan = sr::scan_avcc_mdat(zeros.data(), 0, zeros.size());
+    EXPECT_TRUE(scan.video.empty());
+    EXPECT_EQ(scan.data_end, 0u);
+    EXPECT_TRUE(sr::build_avc_moov(scan, sr::RebuildParams{}).empty());
+}
+
+TEST(MdatScanTest, BuildsSingleMoovBox) {
+    const SyntheticMdat m;
+    const sr::MdatScan scan = sr::scan_avcc_mdat(m.bytes.data(), 0, m.bytes.size());
+    const std::vector<uint8_t> moov = sr::build_avc_moov(scan, sr::RebuildParams{});
+    ASSERT_FALSE(moov.empty());
+
+    const auto boxes = sr::list_top_level_boxes(moov.data(), moov.size());
+    ASSERT_EQ(boxes.size(), 1u);
+    EXPECT_EQ(boxes[0].type, sr::mp4_fourcc("moov"));
+    EXPECT_EQ(boxes[0].size, moov.size());
+}
+
+TEST(MdatScanTest, SplitsAnnexBSequenceHeader) {
+    const std::vector<uint8_t> blob = {
+        0x00, 0x00, 0x00, 0x01, 0x67, 0x64, 0x00, 0x28,
+        0x00, 0x00, 0x01, 0x68, 0xEE, 0x3C,
+    };
+    std::vector<uint8_t> sps, pps;
+    ASSERT_TRUE(sr::split_annexb_parameter_sets(blob, sps, pps));
+    EXPECT_EQ(sps, (std::vector<uint8_t>{ 0x67, 0x64, 0x00, 0x28 }));
+    EXPECT_EQ(pps, (std::vector<uint8_t>{ 0x68, 0xEE, 0x3C }));
+
+    EXPECT_FALSE(sr::split_annexb_parameter_sets({ 0x00, 0x00, 0x01, 0x67 }, sps, pps));
+}
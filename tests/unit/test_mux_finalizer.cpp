@@ -0,0 +1,83 @@
+// test_mux_finalizer.cpp — Unit tests for the background finalize queue
+
+#include <gtest/gtest.h>
+#include "storage/mux_finalizer.h"
+
+#include <atomic>
+#include <chrono>
+#include <vector>
+
+using namespace sr;
+
+namespace {
+
+struct FakeWriter {
+    std::vector<int>* log = nullptr;
+    std::mutex*       log_mutex = nullptr;
+    int               id = 0;
+    bool              result = true;
+    std::atomic<bool>* gate = nullptr;   // finalize() blocks until set
+
+    bool finalize() {
+        while (gate && !gate->load()) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        std::lock_guard<std::mutex> lock(*log_mutex);
+        log->push_back(id);
+        return result;
+    }
+};
+
+} // namespace
+
+TEST(MuxFinalizerTest, FinalizesInQueueOrderAndReportsResult) {
+    std::vector<int> order;
+    std::mutex order_mutex;
+    std::vector<bool> results;
+    FinalizeQueue<FakeWriter> queue;
+    for (int i = 0; i < 3; ++i) {
+        auto w = std::make_unique<FakeWriter>();
+        w->log = &order;
+        w->log_mutex = &order_mutex;
+        w->id = i;
+        w->result = i != 1;
+        queue.enqueue(std::move(w), [&results](bool ok) { results.push_back(ok); });
+    }
+    queue.drain();
+    EXPECT_EQ(order, (std::vector<int>{ 0, 1, 2 }));
+    EXPECT_EQ(results, (std::vector<bool>{ true, false, true }));
+    EXPECT_EQ(queue.pending(), 0u);
+    EXPECT_EQ(queue.completed(), 3u);
+}
+
+TEST(MuxFinalizerTest, EnqueueReturnsWhileFinalizeIsRunning) {
+    std::vector<int> order;
+    std::mutex order_mutex;
+    std::atomic<bool> gate{ false };
+    FinalizeQueue<FakeWriter> queue;
+    auto w = std::make_unique<FakeWriter>();
+    w->log = &order;
+    w->log_mutex = &order_mutex;
+    w->gate = &gate;
+    queue.enqueue(std::move(w));
+    EXPECT_EQ(queue.pending(), 1u);   // the caller is not blocked on the close
+
+    gate = true;
+    queue.drain();
+    EXPECT_EQ(queue.pending(), 0u);
+    EXPECT_EQ(order.size(), 1u);
+}
+
+TEST(MuxFinalizerTest, DestructionWaitsForQueuedWriters) {
+    std::vector<int> order;
+    std::mutex order_mutex;
+    {
+        FinalizeQueue<FakeWriter> queue;
+        for (int i = 0; i < 4; ++i) {
+            auto w = std::make_unique<FakeWriter>();
+            w->log = &order;
+            w->log_mutex = &order_mutex;
+            w->id = i;
+            queue.enqueue(std::move(w));
+        }
+    }
+    EXPECT_EQ(order.size(), 4u);
+}
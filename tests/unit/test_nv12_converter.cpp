@@ -0,0 +1,43 @@
+// test_nv12_converter.cpp — Unit tests for the BGRA->NV12 converter choice
+
+#include <gtest/gtest.h>
+#include "capture/nv12_converter.h"
+
+using namespace sr;
+
+TEST(Nv12ConverterTest, BoxTapsCoverTheFootprint) {
+    EXPECT_EQ(nv12_box_taps(1920, 1920), 1u);
+    EXPECT_EQ(nv12_box_taps(1280, 1920), 1u);   // upscale: plain bilinear
+    EXPECT_EQ(nv12_box_taps(2560, 1920), 2u);   // 1440p -> 1080p
+    EXPECT_EQ(nv12_box_taps(3840, 1920), 2u);
+    EXPECT_EQ(nv12_box_taps(3840, 1280), 3u);
+    EXPECT_EQ(nv12_box_taps(7680, 640), kNv12MaxBoxTaps);
+    EXPECT_EQ(nv12_box_taps(1920, 0), 1u);
+}
+
+TEST(Nv12ConverterTest, AutoNeedsAClearWin) {
+    EXPECT_TRUE(use_compute_converter(Nv12ConverterMode::Auto, true, 6.2, 1.1));
+    EXPECT_FALSE(use_compute_converter(Nv12ConverterMode::Auto, true, 1.0, 0.95));
+    EXPECT_FALSE(use_compute_converter(Nv12ConverterMode::Auto, true, 0.8, 1.4));
+}
+
+TEST(Nv12ConverterTest, FailedMeasurementsFavourTheWorkingPath) {
+    EXPECT_FALSE(use_compute_converter(Nv12ConverterMode::Auto, true, 1.0, -1.0));
+    EXPECT_TRUE(use_compute_converter(Nv12ConverterMode::Auto, true, -1.0, 1.0));
+    EXPECT_FALSE(use_compute_converter(Nv12ConverterMode::Auto, true, -1.0, -1.0));
+}
+
+TEST(Nv12ConverterTest, ForcedModesIgnoreTimings) {
+    EXPECT_TRUE(use_compute_converter(Nv12ConverterMode::Compute, true, -1.0, -1.0));
+    EXPECT_FALSE(use_compute_converter(Nv12ConverterMode::VideoProcessor, true, 9.0, 1.0));
+    // Without UAV-capable NV12 every mode ends on the video processor
+    for (Nv12ConverterMode mode : { Nv12ConverterMode::Auto, Nv12ConverterMode::VideoProcessor,
+                                    Nv12ConverterMode::Compute }) {
+        EXPECT_FALSE(use_compute_converter(mode, false, 9.0, 1.0));
+    }
+}
+
+TEST(Nv12ConverterTest, Labels) {
+    EXPECT_STREQ(nv12_converter_label(Nv12ConverterMode::VideoProcessor), L"vp");
+    EXPECT_STREQ(nv12_scale_filter_label(Nv12ScaleFilter::Box), L"box");
+}
@@ -0,0 +1,48 @@
+// test_nv12_copy.cpp — Unit tests for the pitched -> tight NV12 copy
+
+#include <gtest/gtest.h>
+#include "encoder/nv12_copy.h"
+#include <vector>
+
+using sr::copy_nv12_tight;
+using sr::nv12_tight_size;
+
+namespace {
+
+// Each byte encodes plane, row and column; padding is 0xEE
+std::vector<uint8_t> make_pitched(uint32_t w, uint32_t h, size_t pitch) {
+    std::vector<uint8_t> src(pitch * (h + h / 2), 0xEE);
+    for (uint32_t r = 0; r < h + h / 2; ++r) {
+        for (uint32_t c = 0; c < w; ++c) src[r * pitch + c] = static_cast<uint8_t>((r * 7 + c) & 0x7F);
+    }
+    return src;
+}
+
+} // namespace
+
+TEST(Nv12CopyTest, TightSizeIsOneAndAHalfPlanes) {
+    EXPECT_EQ(nv12_tight_size(848, 480), 848u * 480u * 3u / 2u);
+    EXPECT_EQ(nv12_tight_size(4, 3), 4u * 3u + 4u * 1u);  // odd height: UV rows round down
+}
+
+TEST(Nv12CopyTest, StripsRowPadding) {
+    constexpr uint32_t w = 6, h = 4;
+    constexpr size_t pitch = 16;
+    const auto src = make_pitched(w, h, pitch);
+    std::vector<uint8_t> dst(nv12_tight_size(w, h), 0);
+    copy_nv12_tight(dst.data(), src.data(), pitch, w, h);
+
+    for (uint32_t r = 0; r < h + h / 2; ++r) {
+        for (uint32_t c = 0; c < w; ++c) {
+            ASSERT_EQ(dst[r * w + c], src[r * pitch + c]) << "row " << r << " col " << c;
+        }
+    }
+}
+
+TEST(Nv12CopyTest, UnpaddedSourceIsCopiedVerbatim) {
+    constexpr uint32_t w = 8, h = 6;
+    const auto src = make_pitched(w, h, w);
+    std::vector<uint8_t> dst(nv12_tight_size(w, h), 0);
+    copy_nv12_tight(dst.data(), src.data(), w, w, h);
+    EXPECT_EQ(dst, src);
+}
@@ -0,0 +1,81 @@
+// test_orphan_scanner.cpp — Unit tests for the background orphan scan and its change cache
+
+#include <gtest/gtest.h>
+#include "storage/orphan_scanner.h"
+#include <chrono>
+#include <condition_variable>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <thread>
+
+namespace fs = std::filesystem;
+
+TEST(OrphanSetTest, MatchesOnlyPartialMp4Names) {
+    EXPECT_TRUE(sr::is_partial_mp4_name(L"ScreenRec_2026.partial.mp4"));
+    EXPECT_FALSE(sr::is_partial_mp4_name(L".partial.mp4"));
+    EXPECT_FALSE(sr::is_partial_mp4_name(L"ScreenRec_2026.mp4"));
+    EXPECT_FALSE(sr::is_partial_mp4_name(L"ScreenRec_2026.partial.mp4.recovery"));
+}
+
+TEST(OrphanSetTest, AppliesDirectoryChangeActions) {
+    sr::OrphanSet set;
+    set.assign({ L"b.partial.mp4", L"a.partial.mp4", L"a.partial.mp4" });
+    ASSERT_EQ(set.names().size(), 2u);
+    EXPECT_EQ(set.names().front(), L"a.partial.mp4");
+
+    EXPECT_TRUE(set.apply(FILE_ACTION_ADDED, L"c.partial.mp4"));
+    EXPECT_FALSE(set.apply(FILE_ACTION_ADDED, L"c.partial.mp4"));
+    EXPECT_FALSE(set.apply(FILE_ACTION_ADDED, L"c.mp4"));
+    EXPECT_FALSE(set.apply(FILE_ACTION_MODIFIED, L"a.partial.mp4"));
+
+    // Recovery renames x.partial.mp4 -> x.mp4: only the old name matters
+    EXPECT_TRUE(set.apply(FILE_ACTION_RENAMED_OLD_NAME, L"a.partial.mp4"));
+    EXPECT_FALSE(set.apply(FILE_ACTION_RENAMED_NEW_NAME, L"a.mp4"));
+    EXPECT_TRUE(set.apply(FILE_ACTION_REMOVED, L"b.partial.mp4"));
+
+    ASSERT_EQ(set.names().size(), 1u);
+    EXPECT_TRUE(set.contains(L"c.partial.mp4"));
+    EXPECT_FALSE(set.contains(L"a.partial.mp4"));
+}
+
+TEST(OrphanScannerTest, ReportsOrphansAndTracksRemovals) {
+    const fs::path dir = fs::temp_directory_path() / (L"sr_orphans_" + std::to_wstring(GetCurrentProcessId()));
+    fs::create_directories(dir);
+    std::ofstream(dir / L"one.partial.mp4") << "x";
+    std::ofstream(dir / L"two.partial.mp4") << "x";
+    std::ofstream(dir / L"done.mp4") << "x";
+
+    std::mutex m;
+    std::condition_variable cv;
+    std::vector<std::wstring> reported;
+    bool got = false;
+
+    sr::OrphanScanner scanner;
+    ASSERT_TRUE(scanner.start(dir.wstring(), [&](const std::vector<std::wstring>& orphans) {
+        std::lock_guard<std::mutex> lock(m);
+        reported = orphans;
+        got = true;
+        cv.notify_all();
+    }));
+    {
+        std::unique_lock<std::mutex> lock(m);
+        ASSERT_TRUE(cv.wait_for(lock, std::chrono::seconds(5), [&] { return got; }));
+    }
+    EXPECT_EQ(reported.size(), 2u);
+    EXPECT_TRUE(scanner.ready());
+
+    const std::wstring one = (dir / L"one.partial.mp4").wstring();
+    EXPECT_TRUE(scanner.contains(one));
+    fs::remove(one);
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (scanner.contains(one) && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    EXPECT_FALSE(scanner.contains(one));
+    EXPECT_EQ(scanner.snapshot().size(), 1u);
+
+    scanner.stop();
+    std::error_code ec;
+    fs::remove_all(dir, ec);
+}
@@ -0,0 +1,97 @@
+// test_pcm_buffer_pool.cpp — Unit tests for PcmBlockPool / PcmBuffer (pooled AudioPacket storage)
+
+#include <gtest/gtest.h>
+#include "utils/pcm_buffer_pool.h"
+#include <thread>
+#include <vector>
+
+using sr::PcmBlockPool;
+using sr::PcmBuffer;
+
+TEST(PcmBufferPoolTest, ResizeWithPoolBorrowsBlock) {
+    PcmBlockPool pool;
+    {
+        PcmBuffer buf;
+        buf.resize(3840, &pool);
+        EXPECT_TRUE(buf.pooled());
+        EXPECT_EQ(buf.size(), 3840u);
+        EXPECT_EQ(pool.available(), PcmBlockPool::kBlockCount - 1);
+    }
+    // Destructor returns the block
+    EXPECT_EQ(pool.available(), PcmBlockPool::kBlockCount);
+    EXPECT_EQ(pool.fallbacks(), 0u);
+}
+
+TEST(PcmBufferPoolTest, ResizeWithoutPoolUsesHeap) {
+    PcmBuffer buf;
+    buf.assign(1920, 0);
+    EXPECT_FALSE(buf.pooled());
+    EXPECT_EQ(buf.size(), 1920u);
+    EXPECT_EQ(buf.data()[1919], 0u);
+}
+
+TEST(PcmBufferPoolTest, OversizedPacketFallsBackToHeap) {
+    PcmBlockPool pool;
+    PcmBuffer buf;
+    buf.resize(PcmBlockPool::kBlockBytes + 1, &pool);
+    EXPECT_FALSE(buf.pooled());
+    EXPECT_EQ(buf.size(), PcmBlockPool::kBlockBytes + 1);
+    EXPECT_EQ(pool.fallbacks(), 1u);
+    EXPECT_EQ(pool.available(), PcmBlockPool::kBlockCount);
+}
+
+TEST(PcmBufferPoolTest, ExhaustedPoolFallsBackToHeap) {
+    PcmBlockPool pool;
+    std::vector<PcmBuffer> held(PcmBlockPool::kBlockCount);
+    for (auto& b : held) b.resize(64, &pool);
+    EXPECT_EQ(pool.available(), 0u);
+
+    PcmBuffer extra;
+    extra.resize(64, &pool);
+    EXPECT_FALSE(extra.pooled());
+    EXPECT_EQ(pool.fallbacks(), 1u);
+
+    held.clear();
+    EXPECT_EQ(pool.available(), PcmBlockPool::kBlockCount);
+}
+
+TEST(PcmBufferPoolTest, MoveTransfersBlockOwnership) {
+    PcmBlockPool pool;
+    PcmBuffer a;
+    a.resize(100, &pool);
+    a.data()[0] = 42;
+
+    PcmBuffer b(std::move(a));
+    EXPECT_TRUE(b.pooled());
+    EXPECT_EQ(b.data()[0], 42u);
+    EXPECT_EQ(a.size(), 0u); // NOLINT(bugprone-use-after-move)
+    EXPECT_EQ(pool.available(), PcmBlockPool::kBlockCount - 1);
+
+    PcmBuffer c;
+    c = std::move(b);
+    EXPECT_EQ(pool.available(), PcmBlockPool::kBlockCount - 1);
+    c.reset();
+    EXPECT_EQ(pool.available(), PcmBlockPool::kBlockCount);
+}
+
+TEST(PcmBufferPoolTest, CopyIsDeepAndHeapBacked) {
+    PcmBlockPool pool;
+    PcmBuffer a;
+    a.resize(8, &pool);
+    for (uint8_t i = 0; i < 8; ++i) a.data()[i] = i;
+
+    PcmBuffer b(a);
+    EXPECT_FALSE(b.pooled());
+    ASSERT_EQ(b.size(), 8u);
+    EXPECT_EQ(b.data()[7], 7u);
+    EXPECT_EQ(pool.available(), PcmBlockPool::kBlockCount - 1);
+}
+
+TEST(PcmBufferPoolTest, ReleaseFromAnotherThreadReturnsBlock) {
+    PcmBlockPool pool;
+    PcmBuffer buf;
+    buf.resize(256, &pool);
+    std::thread consumer([b = std::move(buf)]() mutable { b.reset(); });
+    consumer.join();
+    EXPECT_EQ(pool.available(), PcmBlockPool::kBlockCount);
+}
@@ -0,0 +1,156 @@
+#include <gtest/gtest.h>
+
+#include "utils/perf_trace.h"
+
+#include <cstdio>
+#include <cstring>
+
+namespace {
+
+sr::PerfTraceSample second(uint32_t t, uint16_t out, uint32_t encode_us) {
+    sr::PerfTraceSample s;
+    s.t_s           = t;
+    s.frames_in     = out;
+    s.frames_out    = out;
+    s.encode_us_avg = encode_us;
+    s.encode_us_max = encode_us * 2;
+    return s;
+}
+
+} // namespace
+
+TEST(PerfTraceTest, PathForOutputReplacesMp4Suffix) {
+    EXPECT_EQ(sr::PerfTraceWriter::path_for_output(L"C:\\Recordings\\ScreenRec.mp4"),
+              L"C:\\Recordings\\ScreenRec.perftrace");
+    EXPECT_EQ(sr::PerfTraceWriter::path_for_output(L"C:\\Recordings\\ScreenRec"),
+              L"C:\\Recordings\\ScreenRec.perftrace");
+}
+
+TEST(PerfTraceTest, DeltasAreSaturatedAndAdvanceTheBaseline) {
+    sr::PerfTraceCounters prev;
+    sr::PerfTraceCounters now{ 60, 58, 2, 1, 5 };
+    sr::PerfTraceSample s;
+    sr::perf_trace_deltas(now, prev, s);
+    EXPECT_EQ(s.frames_in, 60);
+    EXPECT_EQ(s.frames_out, 58);
+    EXPECT_EQ(s.drops, 2);
+    EXPECT_EQ(s.duplicates, 1);
+    EXPECT_EQ(s.unchanged, 5);
+
+    now.captured = 60 + 100'000;
+    now.encoded  = 3;  // counters reset by a new session
+    sr::perf_trace_deltas(now, prev, s);
+    EXPECT_EQ(s.frames_in, 0xFFFF);
+    EXPECT_EQ(s.frames_out, 3);
+    EXPECT_EQ(s.drops, 0);
+    EXPECT_EQ(prev.captured, now.captured);
+}
+
+TEST(PerfTraceTest, AccumulatorAveragesAndRestartsOnTake) {
+    sr::PerfTraceAccumulator acc;
+    acc.on_encode(4'000, 1);
+    acc.on_encode(8'000, 3);
+    acc.on_encode(-5, 300);
+
+    sr::PerfTraceSample s;
+    acc.take(s);
+    EXPECT_EQ(s.encode_us_avg, 4'000u);
+    EXPECT_EQ(s.encode_us_max, 8'000u);
+    EXPECT_EQ(s.queue_avg_x100, 10'133);
+    EXPECT_EQ(s.queue_max, 255);
+
+    acc.take(s);
+    EXPECT_EQ(s.encode_us_avg, 0u);
+    EXPECT_EQ(s.encode_us_max, 0u);
+    EXPECT_EQ(s.queue_max, 0);
+}
+
+TEST(PerfTraceTest, WriterRoundTripsThroughTheFile) {
+    // Working directory of the test run (the build tree)
+    const std::wstring path = L"sr_perf_trace_test.perftrace";
+    sr::PerfTraceHeader header;
+    header.start_unix_ms = 1'780'000'000'000;
+    header.fps    = 60;
+    header.width  = 1920;
+    header.height = 1080;
+    {
+        sr::PerfTraceWriter writer;
+        ASSERT_TRUE(writer.open(path, header));
+        for (uint32_t t = 0; t < 100; ++t) writer.append(second(t, 60, 1'000 + t));
+        writer.close();
+        EXPECT_EQ(writer.written(), 100u);
+        EXPECT_FALSE(writer.is_open());
+    }
+
+    sr::PerfTraceHeader read_header;
+    std::vector<sr::PerfTraceSample> samples;
+    ASSERT_TRUE(sr::read_perf_trace(path, read_header, samples));
+    EXPECT_EQ(read_header.sample_size, sizeof(sr::PerfTraceSample));
+    EXPECT_EQ(read_header.start_unix_ms, header.start_unix_ms);
+    EXPECT_EQ(read_header.width, 1920);
+    ASSERT_EQ(samples.size(), 100u);
+    EXPECT_EQ(samples[42].t_s, 42u);
+    EXPECT_EQ(samples[42].encode_us_avg, 1'042u);
+    std::remove("sr_perf_trace_test.perftrace");
+}
+
+TEST(PerfTraceTest, ParseIgnoresATornTailAndRejectsForeignFiles) {
+    sr::PerfTraceHeader header;
+    header.sample_size = sizeof(sr::PerfTraceSample);
+    std::vector<uint8_t> image(sizeof(header) + 2 * sizeof(sr::PerfTraceSample) + 10);
+    std::memcpy(image.data(), &header, sizeof(header));
+    const sr::PerfTraceSample s = second(7, 30, 500);
+    std::memcpy(image.data() + sizeof(header), &s, sizeof(s));
+
+    sr::PerfTraceHeader out;
+    std::vector<sr::PerfTraceSample> samples;
+    ASSERT_TRUE(sr::parse_perf_trace(image.data(), image.size(), out, samples));
+    ASSERT_EQ(samples.size(), 2u);
+    EXPECT_EQ(samples[0].t_s, 7u);
+
+    image[0] = 'X';
+    EXPECT_FALSE(sr::parse_perf_trace(image.data(), image.size(), out, samples));
+    EXPECT_TRUE(samples.empty());
+    EXPECT_FALSE(sr::parse_perf_trace(image.data(), 8, out, samples));
+}
+
+TEST(PerfTraceTest, StalledSampleIsSpreadOverTheSecondsItCovers) {
+    sr::PerfTraceSample late = second(9, 100, 3'000);
+    late.drops = 2;
+    const auto spread = sr::spread_perf_sample(late, 3);
+    ASSERT_EQ(spread.size(), 3u);
+    uint32_t out = 0, drops = 0;
+    for (uint32_t i = 0; i < 3; ++i) {
+        EXPECT_EQ(spread[i].t_s, 7u + i);
+        EXPECT_EQ(spread[i].encode_us_avg, 3'000u);
+        out += spread[i].frames_out;
+        drops += spread[i].drops;
+    }
+    EXPECT_EQ(spread[0].frames_out, 33);
+    EXPECT_EQ(spread[2].frames_out, 34);
+    EXPECT_EQ(out, 100u);
+    EXPECT_EQ(drops, 2u);
+
+    EXPECT_EQ(sr::spread_perf_sample(late, 1).size(), 1u);
+    EXPECT_EQ(sr::spread_perf_sample(second(1, 10, 0), 5).size(), 2u);   // never before t = 0
+}
+
+TEST(PerfTraceTest, BucketsAddCountsAndWeightMeansByFrames) {
+    std::vector<sr::PerfTraceSample> samples{ second(0, 60, 1'000), second(1, 20, 5'000),
+                                              second(5, 30, 2'000) };
+    samples[0].flags = sr::kPerfTracePaused;
+    samples[1].flags = sr::kPerfTraceOnAc;
+    samples[2].flags = sr::kPerfTracePaused;
+
+    const auto buckets = sr::bucket_perf_samples(samples, 5);
+    ASSERT_EQ(buckets.size(), 2u);
+    EXPECT_EQ(buckets[0].t_s, 0u);
+    EXPECT_EQ(buckets[0].frames_out, 80);
+    EXPECT_EQ(buckets[0].encode_us_avg, 2'000u);
+    EXPECT_EQ(buckets[0].encode_us_max, 10'000u);
+    EXPECT_EQ(buckets[0].flags, sr::kPerfTraceOnAc);
+    EXPECT_EQ(buckets[1].t_s, 5u);
+    EXPECT_EQ(buckets[1].flags, sr::kPerfTracePaused);
+
+    EXPECT_EQ(sr::bucket_perf_samples(samples, 1).size(), 3u);
+}
@@ -225,6 +225,15 @@ TEST(T035_EncoderFallback, IntelHardwareAdapterPreferredForHardwareEncoding) {
     EXPECT_GT(other_hw_score, intel_sw_score);
 }
 
+TEST(T035_EncoderFallback, DisplayAdapterOutranksVendorPreference) {
+    // Hybrid laptop: external monitor on the NVIDIA GPU beats Quick Sync,
+    // but a software adapter never wins even if it owns the output
+    EXPECT_GT(EncoderProbe::adapter_preference_score(0x10DE, false, true),
+              EncoderProbe::adapter_preference_score(0x8086, false, false));
+    EXPECT_LT(EncoderProbe::adapter_preference_score(0x1414, true, true),
+              EncoderProbe::adapter_preference_score(0x10DE, false, false));
+}
+
 TEST(T035_EncoderFallback, VideoEncoderDefaultIsUninitialised) {
     // Before initialize(), VideoEncoder must report a sane default state
     // (it shouldn't crash if used uninitialized).
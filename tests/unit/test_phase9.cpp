@@ -15,7 +15,7 @@
 
 #include "app/telemetry.h"
 #include "app/camera_overlay.h"
-#include "audio/audio_mixer.h"
+#include "audio/audio_timeline_mixer.h"
 #include "sync/frame_pacer.h"
 #include "encoder/power_mode.h"
 #include "utils/bounded_queue.h"
@@ -67,6 +67,26 @@ TEST(T037_Telemetry, ResetClearsAllCounters) {
     EXPECT_EQ(snap.frames_encoded,  0u);
 }
 
+TEST(T037_Telemetry, ChangeNotificationIsCoalescedAndRateLimited) {
+    sr::TelemetryStore ts;
+    int posted = 0;
+    ts.set_change_listener([&posted]() { ++posted; }, 250);
+
+    EXPECT_FALSE(ts.note_change(1000));          // disabled until the UI is visible
+    ts.set_notify_enabled(true);
+    EXPECT_TRUE(ts.note_change(1000));
+    EXPECT_FALSE(ts.note_change(1300));          // previous push not acknowledged yet
+    ts.acknowledge_change();
+    EXPECT_FALSE(ts.note_change(1100));          // inside the interval
+    EXPECT_TRUE(ts.note_change(1250));
+    EXPECT_EQ(posted, 2);
+
+    ts.set_notify_enabled(false);                // hidden: counters still count
+    ts.on_frame_encoded();
+    EXPECT_EQ(posted, 2);
+    EXPECT_EQ(ts.snapshot(0, true).frames_encoded, 1u);
+}
+
 TEST(T037_Telemetry, BacklogSetAndReflectedInSnapshot) {
     sr::TelemetryStore ts;
     ts.set_backlog(3);
@@ -82,6 +102,42 @@ TEST(T037_Telemetry, EncoderModeLabelStrings) {
     s.encoder_mode = 2; EXPECT_STREQ(s.encoder_mode_label(), L"SW 720p");
 }
 
+TEST(T037_Telemetry, MuxStageCountersReflectedAndReset) {
+    sr::TelemetryStore ts;
+    ts.set_mux_backlog(4, 9);
+    ts.on_mux_stall();
+    ts.on_mux_stall();
+
+    auto snap = ts.snapshot(0, true);
+    EXPECT_EQ(snap.mux_video_backlog, 4u);
+    EXPECT_EQ(snap.mux_audio_backlog, 9u);
+    EXPECT_EQ(snap.mux_stalls,        2u);
+    EXPECT_EQ(snap.audio_dropped,     0u); // filled by SessionController from the engines
+
+    ts.reset();
+    snap = ts.snapshot(0, true);
+    EXPECT_EQ(snap.mux_video_backlog, 0u);
+    EXPECT_EQ(snap.mux_audio_backlog, 0u);
+    EXPECT_EQ(snap.mux_stalls,        0u);
+}
+
+TEST(T037_Telemetry, StageLatencyPercentilesReflectedAndReset) {
+    sr::TelemetryStore ts;
+    for (int i = 1; i <= 100; ++i) ts.record_latency(sr::LatencyStage::Encode, i * 100);  // 0.1 .. 10 ms
+    ts.record_latency(sr::LatencyStage::Count, 5);  // ignored
+
+    auto snap = ts.snapshot(0, true);
+    const auto& enc = snap.stage_latency(sr::LatencyStage::Encode);
+    EXPECT_EQ(enc.samples, 100u);
+    EXPECT_NEAR(enc.p50_us, 5000u, 5000 / 16 + 1);
+    EXPECT_NEAR(enc.p99_us, 9900u, 9900 / 16 + 1);
+    EXPECT_EQ(enc.max_us, 10000u);
+    EXPECT_EQ(snap.stage_latency(sr::LatencyStage::Mux).samples, 0u);
+
+    ts.reset();
+    EXPECT_EQ(ts.snapshot(0, true).stage_latency(sr::LatencyStage::Encode).samples, 0u);
+}
+
 // ============================================================
 // T038: FramePacer
 // ============================================================
@@ -168,6 +224,79 @@ TEST(T038_FramePacer, OutputPTSMonotonicUnderJitter) {
     EXPECT_TRUE(monotonic) << "FramePacer output PTS is not monotonic under jitter";
 }
 
+TEST(T038_FramePacer, UnchangedFramesSkippedWithPeriodicRefresh) {
+    sr::FramePacer pacer;
+    pacer.initialize(30);
+    int64_t out = 0;
+    ASSERT_EQ(pacer.pace_frame(0, false, &out), sr::PaceAction::Accept);
+
+    // 3 s of unchanged frames: all skipped except one refresh per full second
+    int encoded = 0;
+    for (int i = 1; i <= 90; ++i) {
+        auto action = pacer.pace_frame(i * 333'333LL, false, &out, /*unchanged=*/true);
+        EXPECT_NE(action, sr::PaceAction::Duplicate);
+        if (action != sr::PaceAction::Skip) ++encoded;
+    }
+    EXPECT_EQ(encoded, 2);
+    EXPECT_EQ(pacer.skips(), 88u);
+
+    // A real change after the static run is paced normally, not as a gap
+    EXPECT_EQ(pacer.pace_frame(91 * 333'333LL, false, &out), sr::PaceAction::Accept);
+    EXPECT_EQ(pacer.duplicates_inserted(), 0u);
+}
+
+TEST(T038_FramePacer, UnchangedFrameAfterResetIsEncoded) {
+    sr::FramePacer pacer;
+    pacer.initialize(30);
+    int64_t out = 0;
+    pacer.pace_frame(333'333LL, false, &out);
+    pacer.reset();
+    EXPECT_EQ(pacer.pace_frame(50'000'000LL, false, &out, /*unchanged=*/true),
+              sr::PaceAction::Accept);
+}
+
+TEST(T038_FramePacer, VariableRateKeepsCapturePtsWithoutDuplicates) {
+    sr::FramePacer pacer;
+    pacer.set_variable_rate(true);
+    pacer.initialize(30);
+    EXPECT_TRUE(pacer.variable_rate());
+    int64_t out = 0;
+    ASSERT_EQ(pacer.pace_frame(0, false, &out), sr::PaceAction::Accept);
+
+    // A 2 s gap is passed through as-is: no duplicate, no clamping
+    EXPECT_EQ(pacer.pace_frame(20'000'000LL, false, &out), sr::PaceAction::Accept);
+    EXPECT_EQ(out, 20'000'000LL);
+    EXPECT_EQ(pacer.pace_frame(20'100'000LL, false, &out), sr::PaceAction::Accept);
+    EXPECT_EQ(out, 20'100'000LL);
+    EXPECT_EQ(pacer.duplicates_inserted(), 0u);
+
+    // Non-increasing capture PTS is nudged forward
+    EXPECT_EQ(pacer.pace_frame(20'100'000LL, false, &out), sr::PaceAction::Accept);
+    EXPECT_EQ(out, 20'100'001LL);
+}
+
+TEST(T038_FramePacer, VariableRateSkipsEveryUnchangedFrame) {
+    sr::FramePacer pacer;
+    pacer.set_variable_rate(true);
+    pacer.initialize(30);
+    int64_t out = 0;
+    ASSERT_EQ(pacer.pace_frame(0, false, &out), sr::PaceAction::Accept);
+
+    // No periodic refresh: 3 s of unchanged frames are all skipped
+    for (int i = 1; i <= 90; ++i) {
+        EXPECT_EQ(pacer.pace_frame(i * 333'333LL, false, &out, /*unchanged=*/true),
+                  sr::PaceAction::Skip);
+    }
+    EXPECT_EQ(pacer.skips(), 90u);
+
+    // Mode survives a power-profile re-initialize
+    pacer.initialize(60);
+    pacer.reset();
+    pacer.pace_frame(0, false, &out);
+    EXPECT_EQ(pacer.pace_frame(50'000'000LL, false, &out), sr::PaceAction::Accept);
+    EXPECT_EQ(pacer.duplicates_inserted(), 0u);
+}
+
 // ============================================================
 // T039: CaptureEngine device_lost_ atomic flag
 // ============================================================
@@ -332,6 +461,29 @@ TEST(T042_PowerMode, CameraPreviewProcessingSkipsFramesBeforeInterval) {
     EXPECT_TRUE(sr::CameraOverlay::should_process_preview_frame(1000, 1000, 0));
 }
 
+TEST(T042_PowerMode, CameraPreviewCropFillsWithoutLetterbox) {
+    // 16:9 frame into a square window: crop the sides
+    RECT c = sr::CameraOverlay::preview_source_crop(1280, 720, 300, 300);
+    EXPECT_EQ(c.left, 280);
+    EXPECT_EQ(c.right, 1000);
+    EXPECT_EQ(c.top, 0);
+    EXPECT_EQ(c.bottom, 720);
+
+    // 4:3 frame into a 16:9 window: crop top and bottom
+    c = sr::CameraOverlay::preview_source_crop(640, 480, 320, 180);
+    EXPECT_EQ(c.left, 0);
+    EXPECT_EQ(c.right, 640);
+    EXPECT_EQ(c.top, 60);
+    EXPECT_EQ(c.bottom, 420);
+
+    // Matching aspect or an empty window: the whole frame
+    c = sr::CameraOverlay::preview_source_crop(1280, 720, 640, 360);
+    EXPECT_EQ(c.right - c.left, 1280);
+    EXPECT_EQ(c.bottom - c.top, 720);
+    c = sr::CameraOverlay::preview_source_crop(1280, 720, 0, 0);
+    EXPECT_EQ(c.right, 1280);
+}
+
 TEST(T042_PowerMode, CameraPreviewTuningOnlyReappliesWhenProfileChanges) {
     EXPECT_TRUE(sr::CameraOverlay::should_reapply_preview_tuning(
         false, false, false, false, false));
@@ -369,30 +521,49 @@ TEST(T043_WGCConsent, IsWGCSupportedDoesNotCrash) {
     EXPECT_TRUE(supported) << "WGC is expected to be available on Win10 1903+ machines";
 }
 
-TEST(T044_AudioMixing, FindsClosestTimestampCompatibleLoopbackPacket) {
-    sr::AudioPacket mic;
-    mic.pts = 1'000'000;
-    mic.sample_rate = 48000;
-    mic.channels = 2;
-    mic.buffer.assign(1920, 0);
-
-    std::vector<sr::AudioPacket> loopback(3);
-    loopback[0].pts = 900'000;
-    loopback[0].sample_rate = 48000;
-    loopback[0].channels = 2;
-    loopback[0].buffer.assign(1920, 0);
-
-    loopback[1].pts = 1'012'000;
-    loopback[1].sample_rate = 48000;
-    loopback[1].channels = 2;
-    loopback[1].buffer.assign(1920, 0);
-
-    loopback[2].pts = 1'004'000;
-    loopback[2].sample_rate = 48000;
-    loopback[2].channels = 2;
-    loopback[2].buffer.assign(960, 0);
-
-    const auto match = sr::find_loopback_mix_candidate(mic, loopback, 20'000);
-    ASSERT_TRUE(match.has_value());
-    EXPECT_EQ(*match, 1u);
+TEST(T044_AudioMixing, MixesLoopbackPacketsOfDifferentSizeOnTimeline) {
+    sr::AudioTimelineMixer timeline;
+    sr::AudioTimelineMixer::Format fmt;
+    fmt.sample_rate = 48000;
+    fmt.channels = 2;
+    fmt.bits_per_sample = 16;
+    ASSERT_TRUE(timeline.configure(fmt, 20));
+
+    // Mic: two 10 ms packets. Loopback: one 20 ms packet starting 0.4 us late.
+    auto make = [](int64_t pts, uint32_t frames, int16_t value) {
+        sr::AudioPacket pkt;
+        pkt.pts = pts;
+        pkt.frame_count = frames;
+        pkt.buffer.resize(frames * 2 * sizeof(int16_t));
+        auto* s = reinterpret_cast<int16_t*>(pkt.buffer.data());
+        for (uint32_t i = 0; i < frames * 2; ++i) s[i] = value;
+        return pkt;
+    };
+    ASSERT_TRUE(timeline.add(0, make(1'000'000, 480, 100)));
+    ASSERT_TRUE(timeline.add(0, make(1'100'000, 480, 100)));
+    ASSERT_TRUE(timeline.add(1, make(1'000'004, 960, 10)));
+
+    size_t blocks = 0;
+    timeline.drain([&](const sr::AudioTimelineMixer::Block& block) {
+        ++blocks;
+        EXPECT_EQ(block.pts, 1'000'000);
+        EXPECT_EQ(block.frames, 960u);
+        const auto* s = reinterpret_cast<const int16_t*>(block.data);
+        for (uint32_t i = 0; i < block.frames * 2; ++i) ASSERT_EQ(s[i], 110);
+    });
+    EXPECT_EQ(blocks, 1u);
+}
+
+TEST(T042_PowerMode, AutoAudioLatencyBatchesWakeupsOnBattery) {
+    using sr::AudioLatencyMode;
+    using sr::PowerModeDetector;
+    EXPECT_EQ(PowerModeDetector::audio_latency_for_power_state(AudioLatencyMode::Auto, true),
+              AudioLatencyMode::Default);
+    EXPECT_EQ(PowerModeDetector::audio_latency_for_power_state(AudioLatencyMode::Auto, false),
+              AudioLatencyMode::PowerSaving);
+    // An explicit choice is kept on either power source
+    EXPECT_EQ(PowerModeDetector::audio_latency_for_power_state(AudioLatencyMode::LowLatency, false),
+              AudioLatencyMode::LowLatency);
+    EXPECT_EQ(PowerModeDetector::audio_latency_for_power_state(AudioLatencyMode::PowerSaving, true),
+              AudioLatencyMode::PowerSaving);
 }
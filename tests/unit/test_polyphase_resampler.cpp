@@ -0,0 +1,155 @@
+// test_polyphase_resampler.cpp — Unit tests for the native polyphase resampler (no MF needed)
+
+#include <gtest/gtest.h>
+#include "audio/polyphase_resampler.h"
+
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+using sr::MixerIsa;
+using sr::PolyphaseResampler;
+
+namespace {
+
+constexpr double kPi = 3.14159265358979323846;
+
+std::vector<float> sine(uint32_t rate, double freq, size_t frames, uint16_t channels, float amp = 0.5f) {
+    std::vector<float> v(frames * channels);
+    for (size_t i = 0; i < frames; ++i) {
+        const float s = amp * static_cast<float>(std::sin(2.0 * kPi * freq * static_cast<double>(i) / rate));
+        for (uint16_t c = 0; c < channels; ++c) v[i * channels + c] = s;
+    }
+    return v;
+}
+
+// Feeds `in` in chunks of chunk_frames and flushes; returns all float output
+std::vector<float> run(PolyphaseResampler& rs, const std::vector<float>& in,
+                       uint16_t channels, size_t chunk_frames) {
+    std::vector<uint8_t> out;
+    const auto* bytes = reinterpret_cast<const uint8_t*>(in.data());
+    const size_t frame_bytes = channels * sizeof(float);
+    const size_t frames = in.size() / channels;
+    for (size_t f = 0; f < frames; f += chunk_frames) {
+        const size_t n = std::min(chunk_frames, frames - f);
+        EXPECT_TRUE(rs.process(bytes + f * frame_bytes, n * frame_bytes, out));
+    }
+    EXPECT_TRUE(rs.flush(out));
+    const auto* samples = reinterpret_cast<const float*>(out.data());
+    return std::vector<float>(samples, samples + out.size() / sizeof(float));
+}
+
+} // namespace
+
+TEST(PolyphaseResamplerTest, ReducesRatioAndRejectsUnsupported) {
+    PolyphaseResampler rs;
+    ASSERT_TRUE(rs.initialize(44100, 48000, 2, 32));
+    EXPECT_EQ(rs.phases(), 160u);
+    EXPECT_EQ(rs.decimation(), 147u);
+    ASSERT_TRUE(rs.initialize(16000, 48000, 1, 16));
+    EXPECT_EQ(rs.phases(), 3u);
+    EXPECT_EQ(rs.decimation(), 1u);
+
+    EXPECT_FALSE(rs.initialize(44101, 48000, 2, 32));  // 48000/44101 needs 48000 phases
+    EXPECT_FALSE(rs.initialize(44100, 48000, 2, 24));
+    EXPECT_FALSE(rs.initialize(0, 48000, 2, 32));
+    EXPECT_FALSE(rs.initialized());
+}
+
+TEST(PolyphaseResamplerTest, OutputLengthMatchesRatio) {
+    PolyphaseResampler rs;
+    ASSERT_TRUE(rs.initialize(44100, 48000, 2, 32));
+    const auto out = run(rs, sine(44100, 1000.0, 44100, 2), 2, 441);
+    EXPECT_EQ(out.size(), 48000u * 2u);
+}
+
+TEST(PolyphaseResamplerTest, ChunkingDoesNotChangeOutput) {
+    PolyphaseResampler a, b;
+    ASSERT_TRUE(a.initialize(44100, 48000, 2, 32));
+    ASSERT_TRUE(b.initialize(44100, 48000, 2, 32));
+    const auto in = sine(44100, 3000.0, 8820, 2);
+    const auto whole  = run(a, in, 2, 8820);
+    const auto pieces = run(b, in, 2, 97);
+    ASSERT_EQ(whole.size(), pieces.size());
+    for (size_t i = 0; i < whole.size(); ++i) ASSERT_FLOAT_EQ(whole[i], pieces[i]) << i;
+}
+
+TEST(PolyphaseResamplerTest, SineSurvives44100To48000) {
+    PolyphaseResampler rs;
+    ASSERT_TRUE(rs.initialize(44100, 48000, 1, 32));
+    const auto out = run(rs, sine(44100, 1000.0, 44100, 1), 1, 441);
+    const auto ideal = sine(48000, 1000.0, 48000, 1);
+    double max_err = 0.0;
+    for (size_t i = 200; i + 200 < out.size(); ++i) {
+        max_err = std::max(max_err, static_cast<double>(std::fabs(out[i] - ideal[i])));
+    }
+    EXPECT_LT(max_err, 2e-3);
+}
+
+TEST(PolyphaseResamplerTest, SineSurvives16000To48000) {
+    PolyphaseResampler rs;
+    ASSERT_TRUE(rs.initialize(16000, 48000, 1, 32));
+    const auto out = run(rs, sine(16000, 440.0, 16000, 1), 1, 160);
+    ASSERT_EQ(out.size(), 48000u);
+    const auto ideal = sine(48000, 440.0, 48000, 1);
+    double max_err = 0.0;
+    for (size_t i = 200; i + 200 < out.size(); ++i) {
+        max_err = std::max(max_err, static_cast<double>(std::fabs(out[i] - ideal[i])));
+    }
+    EXPECT_LT(max_err, 2e-3);
+}
+
+TEST(PolyphaseResamplerTest, Int16DcLevelPreserved) {
+    PolyphaseResampler rs;
+    ASSERT_TRUE(rs.initialize(44100, 48000, 2, 16));
+    std::vector<int16_t> in(4410 * 2, 10000);
+    std::vector<uint8_t> out;
+    ASSERT_TRUE(rs.process(reinterpret_cast<const uint8_t*>(in.data()),
+                           in.size() * sizeof(int16_t), out));
+    const auto* s = reinterpret_cast<const int16_t*>(out.data());
+    const size_t n = out.size() / sizeof(int16_t);
+    ASSERT_GT(n, 400u);
+    for (size_t i = 200; i < n; ++i) ASSERT_NEAR(s[i], 10000, 2) << i;
+}
+
+TEST(PolyphaseResamplerTest, Int16FullScaleSaturatesInsteadOfWrapping) {
+    PolyphaseResampler rs;
+    ASSERT_TRUE(rs.initialize(16000, 48000, 1, 16));
+    // Square wave at full scale overshoots (Gibbs) — must clip, not wrap
+    std::vector<int16_t> in(1600);
+    for (size_t i = 0; i < in.size(); ++i) in[i] = ((i / 8) % 2) ? 32767 : -32768;
+    std::vector<uint8_t> out;
+    ASSERT_TRUE(rs.process(reinterpret_cast<const uint8_t*>(in.data()), in.size() * 2, out));
+    const auto* s = reinterpret_cast<const int16_t*>(out.data());
+    for (size_t i = 100; i + 1 < out.size() / 2; ++i) {
+        // A wrapped sample would flip sign in the middle of a half-period
+        if (s[i - 1] > 20000 && s[i + 1] > 20000) {
+            ASSERT_GT(s[i], 0) << i;
+        }
+    }
+}
+
+#if defined(SR_MIXER_X86)
+TEST(PolyphaseResamplerTest, SimdDotProductsMatchScalar) {
+    std::vector<float> a(PolyphaseResampler::kTaps), b(PolyphaseResampler::kTaps);
+    for (size_t i = 0; i < a.size(); ++i) {
+        a[i] = std::sin(static_cast<float>(i) * 0.37f);
+        b[i] = std::cos(static_cast<float>(i) * 0.11f);
+    }
+    const float ref = sr::resample::dot_scalar(a.data(), b.data(), a.size());
+    EXPECT_NEAR(sr::resample::dot_sse2(a.data(), b.data(), a.size()), ref, 1e-5f);
+    if (sr::mixer::cpu_has_avx2()) {
+        EXPECT_NEAR(sr::resample::dot_avx2(a.data(), b.data(), a.size()), ref, 1e-5f);
+    }
+
+    // Whole-stream output is ISA-independent within float rounding
+    PolyphaseResampler scalar_rs, simd_rs;
+    ASSERT_TRUE(scalar_rs.initialize(44100, 48000, 2, 32, MixerIsa::Scalar));
+    ASSERT_TRUE(simd_rs.initialize(44100, 48000, 2, 32));
+    const auto in = sine(44100, 5000.0, 4410, 2);
+    const auto x = run(scalar_rs, in, 2, 441);
+    const auto y = run(simd_rs, in, 2, 441);
+    ASSERT_EQ(x.size(), y.size());
+    for (size_t i = 0; i < x.size(); ++i) ASSERT_NEAR(x[i], y[i], 1e-5f) << i;
+}
+#endif
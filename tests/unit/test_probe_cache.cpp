@@ -0,0 +1,74 @@
+// test_probe_cache.cpp — Unit tests for the persisted hardware-encoder probe
+
+#include <gtest/gtest.h>
+#include "encoder/probe_cache.h"
+#include <filesystem>
+
+using sr::AdapterIdentity;
+using sr::CachedEncoders;
+using sr::ProbeCache;
+
+class ProbeCacheTest : public ::testing::Test {
+protected:
+    std::wstring path;
+    AdapterIdentity id;
+    CachedEncoders encoders;
+
+    void SetUp() override {
+        wchar_t tmp[MAX_PATH];
+        GetTempPathW(MAX_PATH, tmp);
+        path = std::wstring(tmp) + L"sr_probe_cache_" + std::to_wstring(GetCurrentProcessId()) + L".ini";
+        DeleteFileW(path.c_str());
+
+        id.vendor_id      = 0x8086;
+        id.device_id      = 0x46A6;
+        id.subsys_id      = 0x0B1A1028;
+        id.revision       = 0x0C;
+        id.driver_version = 0x001F00650E1B1C3Aull;
+        encoders.h264_name = L"Intel® Quick Sync Video H.264 Encoder MFT";
+        encoders.hevc_name = L"Intel® Hardware H265 Encoder MFT";
+    }
+
+    void TearDown() override { DeleteFileW(path.c_str()); }
+};
+
+TEST_F(ProbeCacheTest, MissingFileIsAMiss) {
+    CachedEncoders out;
+    EXPECT_FALSE(ProbeCache::load(path, id, out));
+    EXPECT_FALSE(ProbeCache::load(L"", id, out));
+}
+
+TEST_F(ProbeCacheTest, RoundTripForSameAdapterAndDriver) {
+    ASSERT_TRUE(ProbeCache::save(path, id, encoders));
+    CachedEncoders out;
+    ASSERT_TRUE(ProbeCache::load(path, id, out));
+    EXPECT_EQ(out, encoders);
+    EXPECT_TRUE(out.av1_name.empty());  // no AV1 encoder on this adapter
+}
+
+TEST_F(ProbeCacheTest, DriverUpdateInvalidates) {
+    ASSERT_TRUE(ProbeCache::save(path, id, encoders));
+    AdapterIdentity updated = id;
+    updated.driver_version += 1;
+    CachedEncoders out;
+    EXPECT_FALSE(ProbeCache::load(path, updated, out));
+}
+
+TEST_F(ProbeCacheTest, DifferentGpuInvalidates) {
+    ASSERT_TRUE(ProbeCache::save(path, id, encoders));
+    AdapterIdentity other = id;
+    other.vendor_id = 0x10DE;
+    CachedEncoders out;
+    EXPECT_FALSE(ProbeCache::load(path, other, out));
+}
+
+TEST_F(ProbeCacheTest, RewriteReplacesEncoderList) {
+    ASSERT_TRUE(ProbeCache::save(path, id, encoders));
+    CachedEncoders refreshed = encoders;
+    refreshed.av1_name = L"Intel® Hardware AV1 Encoder MFT";
+    refreshed.hevc_name.clear();
+    ASSERT_TRUE(ProbeCache::save(path, id, refreshed));
+    CachedEncoders out;
+    ASSERT_TRUE(ProbeCache::load(path, id, out));
+    EXPECT_EQ(out, refreshed);
+}
@@ -6,6 +6,7 @@
 #include <chrono>
 
 using sr::QPCClock;
+using sr::qpc_ticks_to;
 
 TEST(QPCClockTest, FrequencyIsPositive) {
     const auto& clock = QPCClock::instance();
@@ -49,5 +50,44 @@ TEST(QPCClockTest, TicksToHnsConsistent) {
     const auto& clock = QPCClock::instance();
     // 1 second worth of ticks should be 10,000,000 HNS
     int64_t one_sec_hns = clock.ticks_to_hns(clock.frequency());
-    EXPECT_NEAR(one_sec_hns, 10'000'000, 100); // Allow tiny float rounding
+    EXPECT_EQ(one_sec_hns, 10'000'000);
+}
+
+// Exact for the common frequencies: 10 MHz (Win10+ default), 3.579545 MHz
+// (ACPI PM timer) and a 3 GHz TSC
+static_assert(qpc_ticks_to(10'000'000, 10'000'000, 10'000'000) == 10'000'000);
+static_assert(qpc_ticks_to(3'579'545, 3'579'545, 10'000'000) == 10'000'000);
+static_assert(qpc_ticks_to(1, 3'000'000'000, 1'000'000'000) == 0);
+static_assert(qpc_ticks_to(3, 3'000'000'000, 1'000'000'000) == 1);
+
+TEST(QPCClockTest, MultiDayUptimeStaysExact) {
+    // 40 days of uptime plus a fraction of a second
+    constexpr int64_t kDays = 40;
+    const int64_t freqs[] = { 10'000'000, 3'579'545, 2'995'000'000 };
+    for (int64_t freq : freqs) {
+        const int64_t base   = freq * 86'400 * kDays;
+        const int64_t offset = freq / 3;
+        const int64_t hns    = qpc_ticks_to(base + offset, freq, 10'000'000);
+        EXPECT_EQ(hns, 10'000'000LL * 86'400 * kDays + offset * 10'000'000 / freq) << freq;
+
+        // One frame interval later: the delta is unaffected by the large base
+        const int64_t frame = freq / 60;
+        EXPECT_EQ(qpc_ticks_to(base + offset + frame, freq, 10'000'000) - hns,
+                  qpc_ticks_to(offset + frame, freq, 10'000'000) -
+                  qpc_ticks_to(offset, freq, 10'000'000)) << freq;
+    }
+}
+
+TEST(QPCClockTest, NegativeDeltasTruncateTowardZero) {
+    EXPECT_EQ(qpc_ticks_to(-10'000'000, 10'000'000, 10'000'000), -10'000'000);
+    EXPECT_EQ(qpc_ticks_to(-15, 10, 1'000), -1'500);
+    EXPECT_EQ(qpc_ticks_to(-1, 3, 10), -3);
+}
+
+TEST(QPCClockTest, UnitsAgree) {
+    const auto& clock = QPCClock::instance();
+    const int64_t ticks = clock.frequency() * 7 + 12'345;
+    const int64_t ns  = qpc_ticks_to(ticks, clock.frequency(), 1'000'000'000);
+    const int64_t hns = clock.ticks_to_hns(ticks);
+    EXPECT_EQ(hns, ns / 100);
 }
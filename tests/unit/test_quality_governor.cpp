@@ -0,0 +1,137 @@
+// test_quality_governor.cpp — Unit tests for QualityGovernor (closed-loop bitrate/fps)
+
+#include <gtest/gtest.h>
+#include "sync/quality_governor.h"
+
+using sr::QualityGovernor;
+
+namespace {
+
+constexpr int64_t kSecond = QualityGovernor::kWindowUs;
+
+// One 1 s window of `frames` encodes at `encode_us` each, then close it
+bool run_window(QualityGovernor& g, int64_t& now, uint32_t frames, int64_t encode_us,
+                size_t depth = 0, uint32_t drops = 0) {
+    for (uint32_t i = 0; i < frames; ++i) g.on_frame(encode_us, depth);
+    g.on_drop(drops);
+    now += kSecond;
+    return g.evaluate(now);
+}
+
+} // namespace
+
+TEST(QualityGovernorTest, HealthyEncoderStaysNominal) {
+    QualityGovernor g;
+    g.reset(8'000'000, 30);
+    int64_t now = 0;
+    g.evaluate(now);
+    for (int i = 0; i < 30; ++i) EXPECT_FALSE(run_window(g, now, 30, 5'000));
+    EXPECT_EQ(g.level(), 0u);
+    EXPECT_EQ(g.bitrate_bps(), 8'000'000u);
+    EXPECT_EQ(g.fps(), 30u);
+}
+
+TEST(QualityGovernorTest, SustainedSlowEncodeStepsDown) {
+    QualityGovernor g;
+    g.reset(8'000'000, 30);
+    int64_t now = 0;
+    g.evaluate(now);
+    // 30 ms per frame against a 33 ms budget: overloaded
+    EXPECT_FALSE(run_window(g, now, 30, 30'000));
+    EXPECT_TRUE(run_window(g, now, 30, 30'000));
+    EXPECT_EQ(g.level(), 1u);
+    EXPECT_EQ(g.bitrate_bps(), 6'000'000u);
+    EXPECT_EQ(g.downgrades(), 1u);
+}
+
+TEST(QualityGovernorTest, SingleSpikeIsIgnored) {
+    QualityGovernor g;
+    g.reset(8'000'000, 30);
+    int64_t now = 0;
+    g.evaluate(now);
+    run_window(g, now, 30, 30'000);
+    run_window(g, now, 30, 5'000);
+    run_window(g, now, 30, 30'000);
+    EXPECT_EQ(g.level(), 0u);
+}
+
+TEST(QualityGovernorTest, DropRateAloneTriggersStepDown) {
+    QualityGovernor g;
+    g.reset(8'000'000, 30);
+    int64_t now = 0;
+    g.evaluate(now);
+    run_window(g, now, 27, 5'000, 0, 3);
+    EXPECT_TRUE(run_window(g, now, 27, 5'000, 0, 3));
+    EXPECT_EQ(g.level(), 1u);
+}
+
+TEST(QualityGovernorTest, HoldsAfterChangeThenRecovers) {
+    QualityGovernor g;
+    g.reset(8'000'000, 30);
+    int64_t now = 0;
+    g.evaluate(now);
+    run_window(g, now, 30, 30'000);
+    ASSERT_TRUE(run_window(g, now, 30, 30'000));
+
+    // Still overloaded, but the hold windows let the encoder settle first
+    for (uint32_t i = 0; i < QualityGovernor::kHoldWindows; ++i) {
+        EXPECT_FALSE(run_window(g, now, 30, 30'000));
+    }
+    EXPECT_EQ(g.level(), 1u);
+
+    // Recovery needs kHealthyWindows healthy windows in a row
+    for (uint32_t i = 0; i + 1 < QualityGovernor::kHealthyWindows; ++i) {
+        EXPECT_FALSE(run_window(g, now, 30, 5'000));
+    }
+    EXPECT_TRUE(run_window(g, now, 30, 5'000));
+    EXPECT_EQ(g.level(), 0u);
+    EXPECT_EQ(g.upgrades(), 1u);
+}
+
+TEST(QualityGovernorTest, LastLevelHalvesFpsByDecimation) {
+    QualityGovernor g;
+    g.reset(8'000'000, 60);
+    int64_t now = 0;
+    g.evaluate(now);
+    while (g.level() < QualityGovernor::kMaxLevel) {
+        run_window(g, now, 60, 20'000);
+        ASSERT_LT(now, 100 * kSecond);
+    }
+    EXPECT_EQ(g.fps(), 30u);
+    EXPECT_EQ(g.bitrate_bps(), 3'200'000u);
+
+    // 60 fps input with a little jitter: every other frame is admitted
+    constexpr int64_t kFrame = 10'000'000 / 60;
+    uint32_t admitted = 0;
+    for (int64_t f = 0; f < 120; ++f) {
+        const int64_t jitter = (f % 3 == 0) ? 2'000 : -1'000;
+        if (g.admit(f * kFrame + jitter)) ++admitted;
+    }
+    EXPECT_EQ(admitted, 60u);
+}
+
+TEST(QualityGovernorTest, LowFpsNeverDecimatesBelowMinimum) {
+    QualityGovernor g;
+    g.reset(4'000'000, 24);
+    int64_t now = 0;
+    g.evaluate(now);
+    for (int i = 0; i < 40; ++i) run_window(g, now, 24, 40'000);
+    EXPECT_EQ(g.level(), QualityGovernor::kMaxLevel - 1);
+    EXPECT_EQ(g.fps(), 24u);
+    EXPECT_TRUE(g.admit(0));
+    EXPECT_TRUE(g.admit(1));
+}
+
+TEST(QualityGovernorTest, IdleWindowsCountAsHealthy) {
+    QualityGovernor g;
+    g.reset(8'000'000, 30);
+    int64_t now = 0;
+    g.evaluate(now);
+    run_window(g, now, 30, 30'000);
+    ASSERT_TRUE(run_window(g, now, 30, 30'000));
+    // Static screen: nothing encoded, nothing dropped
+    for (uint32_t i = 0; i < QualityGovernor::kHoldWindows + QualityGovernor::kHealthyWindows; ++i) {
+        run_window(g, now, 0, 0);
+    }
+    EXPECT_EQ(g.level(), 0u);
+}
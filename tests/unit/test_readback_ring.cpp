@@ -0,0 +1,76 @@
+// test_readback_ring.cpp — Unit tests for ReadbackRing (SW encoder deferred readback)
+
+#include <gtest/gtest.h>
+#include "encoder/readback_ring.h"
+
+using sr::ReadbackRing;
+
+TEST(ReadbackRingTest, StartsEmptyAndNotReady) {
+    ReadbackRing<3> ring;
+    EXPECT_TRUE(ring.empty());
+    EXPECT_FALSE(ring.ready());
+    EXPECT_EQ(ring.pending(), 0u);
+}
+
+TEST(ReadbackRingTest, BecomesReadyOnlyWhenFull) {
+    ReadbackRing<3> ring;
+    ASSERT_TRUE(ring.stage(100, false).has_value());
+    EXPECT_FALSE(ring.ready());
+    ASSERT_TRUE(ring.stage(200, false).has_value());
+    EXPECT_FALSE(ring.ready());
+    ASSERT_TRUE(ring.stage(300, false).has_value());
+    EXPECT_TRUE(ring.ready());
+    EXPECT_FALSE(ring.stage(400, false).has_value()); // must read back first
+}
+
+TEST(ReadbackRingTest, ReadsBackOldestFrameSizeMinusOneBehind) {
+    ReadbackRing<3> ring;
+    int64_t read_pts[8]{};
+    size_t reads = 0;
+    for (int64_t frame = 0; frame < 8; ++frame) {
+        ASSERT_TRUE(ring.stage(frame * 10, false).has_value());
+        if (ring.ready()) {
+            read_pts[reads++] = ring.slot(ring.oldest()).pts;
+            ring.release_oldest();
+        }
+    }
+    // Frames 0..5 read back while frames 2..7 were being copied
+    ASSERT_EQ(reads, 6u);
+    for (size_t i = 0; i < reads; ++i) {
+        EXPECT_EQ(read_pts[i], static_cast<int64_t>(i) * 10);
+    }
+    EXPECT_EQ(ring.pending(), 2u); // drained by flush()
+}
+
+TEST(ReadbackRingTest, SlotIndicesWrapAround) {
+    ReadbackRing<2> ring;
+    EXPECT_EQ(*ring.stage(1, false), 0u);
+    EXPECT_EQ(*ring.stage(2, false), 1u);
+    ring.release_oldest();
+    EXPECT_EQ(*ring.stage(3, false), 0u);
+    EXPECT_EQ(ring.oldest(), 1u);
+}
+
+TEST(ReadbackRingTest, KeyframeFlagTravelsWithSlot) {
+    ReadbackRing<3> ring;
+    ring.stage(1, false);
+    ring.stage(2, true);
+    EXPECT_FALSE(ring.slot(ring.oldest()).force_keyframe);
+    ring.release_oldest();
+    EXPECT_TRUE(ring.slot(ring.oldest()).force_keyframe);
+}
+
+TEST(ReadbackRingTest, ResetDiscardsPending) {
+    ReadbackRing<3> ring;
+    ring.stage(1, false);
+    ring.stage(2, false);
+    ring.reset();
+    EXPECT_TRUE(ring.empty());
+    EXPECT_EQ(*ring.stage(3, false), 0u);
+}
+
+TEST(ReadbackRingTest, ReleaseOnEmptyIsNoop) {
+    ReadbackRing<3> ring;
+    ring.release_oldest();
+    EXPECT_TRUE(ring.empty());
+}
@@ -0,0 +1,58 @@
+// test_replay_ring.cpp — Unit tests for the instant-replay sample ring
+
+#include <gtest/gtest.h>
+#include "storage/replay_ring.h"
+
+using Ring = sr::ReplayRing<int>;
+
+static constexpr int64_t kSec = 10'000'000;
+
+// 1 fps video with a keyframe every `gop` frames, one audio packet per frame
+static void feed(Ring& ring, int seconds, int gop, uint32_t bytes = 100) {
+    for (int i = 0; i < seconds; ++i) {
+        ring.push_video(i, i * kSec, bytes, i % gop == 0);
+        ring.push_audio(-i, i * kSec + 1, 10);
+    }
+}
+
+TEST(ReplayRingTest, StartsOnKeyframeAndDropsLeadingSamples) {
+    Ring ring;
+    ring.reset(10 * kSec, 0);
+    ring.push_audio(0, 0, 10);
+    ring.push_video(0, 0, 100, false);
+    EXPECT_TRUE(ring.empty());
+
+    ring.push_video(1, kSec, 100, true);
+    ring.push_audio(2, kSec + 1, 10);
+    ASSERT_EQ(ring.size(), 2u);
+    EXPECT_TRUE(ring.entries().front().keyframe);
+    EXPECT_EQ(ring.start_pts(), kSec);
+    EXPECT_EQ(ring.bytes(), 110u);
+}
+
+TEST(ReplayRingTest, EvictsWholeGopsButCoversWindow) {
+    Ring ring;
+    ring.reset(10 * kSec, 0);
+    feed(ring, 30, 4);   // keyframes at 0, 4, 8, ... 28; newest = 29 s
+
+    // Latest keyframe at least 10 s old is 16 s (20 is only 9 s old)
+    EXPECT_EQ(ring.start_pts(), 16 * kSec);
+    EXPECT_GE(ring.duration(), 10 * kSec);
+    EXPECT_LT(ring.duration(), 14 * kSec);
+    EXPECT_TRUE(ring.entries().front().video);
+    EXPECT_TRUE(ring.entries().front().keyframe);
+    EXPECT_EQ(ring.size(), 28u);   // frames 16..29 with their audio
+    EXPECT_EQ(ring.bytes(), 14u * 110u);
+}
+
+TEST(ReplayRingTest, ByteCapKeepsNewestGop) {
+    Ring ring;
+    ring.reset(60 * kSec, 1000);
+    feed(ring, 20, 5, 100);   // 5 frames per GOP = 550 bytes
+    EXPECT_LE(ring.bytes(), 1000u);
+    EXPECT_EQ(ring.start_pts(), 15 * kSec);
+
+    ring.clear();
+    EXPECT_TRUE(ring.empty());
+    EXPECT_EQ(ring.bytes(), 0u);
+}
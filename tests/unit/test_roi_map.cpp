@@ -0,0 +1,60 @@
+// test_roi_map.cpp — Unit tests for RoiMap (dirty rects -> encoder ROI areas)
+
+#include <gtest/gtest.h>
+#include "encoder/roi_map.h"
+
+using sr::DirtyRegion;
+using sr::FrameRect;
+using sr::RoiMap;
+using sr::RoiParams;
+
+TEST(RoiMapTest, NoAreasWithoutUsableDirtyInfo) {
+    RoiMap roi;
+    EXPECT_EQ(roi.build(DirtyRegion{}, 1920, 1080), 0u);   // unknown
+
+    DirtyRegion none;
+    none.reset(1920, 1080);
+    EXPECT_EQ(roi.build(none, 1920, 1080), 0u);            // nothing changed
+
+    DirtyRegion full;
+    full.set_full(1920, 1080);
+    EXPECT_EQ(roi.build(full, 1920, 1080), 0u);            // whole frame changed
+
+    DirtyRegion small;
+    small.reset(1920, 1080);
+    small.add({ 10, 10, 20, 20 });
+    RoiParams off;
+    off.qp_delta = 0;
+    EXPECT_EQ(roi.build(small, 1920, 1080, off), 0u);
+}
+
+TEST(RoiMapTest, AlignsToMacroblocksAndClipsToFrame) {
+    DirtyRegion dirty;
+    dirty.reset(1920, 1080);
+    dirty.add({ 17, 33, 40, 47 });
+    dirty.add({ 1900, 1070, 1920, 1080 });
+
+    RoiMap roi;
+    ASSERT_EQ(roi.build(dirty, 1920, 1080), 2u);
+    EXPECT_EQ(roi[0].rect, (FrameRect{ 16, 32, 48, 48 }));
+    EXPECT_EQ(roi[0].qp_delta, -4);
+    EXPECT_EQ(roi[1].rect, (FrameRect{ 1888, 1056, 1920, 1080 }));
+}
+
+TEST(RoiMapTest, MergesDownToEncoderAreaLimit) {
+    DirtyRegion dirty;
+    dirty.reset(1920, 1080);
+    for (uint32_t i = 0; i < 12; ++i) dirty.add({ i * 100, 0, i * 100 + 16, 16 });
+    ASSERT_EQ(dirty.size(), 12u);
+
+    RoiMap roi;
+    const size_t n = roi.build(dirty, 1920, 1080);
+    EXPECT_LE(n, RoiMap::kMaxAreas);
+    EXPECT_GT(n, 0u);
+    // Every original rect is still covered by some area
+    for (const FrameRect& r : dirty) {
+        bool covered = false;
+        for (const auto& a : roi) covered = covered || a.rect.contains(r);
+        EXPECT_TRUE(covered) << r.left;
+    }
+}
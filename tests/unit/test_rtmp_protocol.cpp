@@ -0,0 +1,234 @@
+// test_rtmp_protocol.cpp — Unit tests for the live-stream sink's RTMP framing and GOP send queue
+
+#include <gtest/gtest.h>
+#include "storage/rtmp_protocol.h"
+#include "storage/gop_send_queue.h"
+
+using namespace sr;
+
+namespace {
+
+std::vector<RtmpMessage> read_all(const std::vector<uint8_t>& wire, size_t feed_step,
+                                  uint32_t chunk_size = 128) {
+    std::vector<RtmpMessage> got;
+    RtmpChunkReader reader([&](const RtmpMessage& m) { got.push_back(m); });
+    if (chunk_size != 128) {
+        std::vector<uint8_t> set;
+        const uint8_t body[4] = { static_cast<uint8_t>(chunk_size >> 24), static_cast<uint8_t>(chunk_size >> 16),
+                                  static_cast<uint8_t>(chunk_size >> 8), static_cast<uint8_t>(chunk_size) };
+        append_rtmp_message(set, rtmp::kCsidControl, 0, rtmp::kSetChunkSize, 0, body, 4, 128);
+        EXPECT_TRUE(reader.feed(set.data(), set.size()));
+        EXPECT_EQ(reader.chunk_size(), chunk_size);
+    }
+    for (size_t pos = 0; pos < wire.size(); pos += feed_step) {
+        const size_t n = std::min(feed_step, wire.size() - pos);
+        EXPECT_TRUE(reader.feed(wire.data() + pos, n));
+    }
+    return got;
+}
+
+} // namespace
+
+TEST(RtmpUrlTest, SplitsHostPortAppAndKey) {
+    RtmpUrl u;
+    ASSERT_TRUE(parse_rtmp_url("rtmp://live.example.com/app/abc-123", u));
+    EXPECT_EQ(u.host, "live.example.com");
+    EXPECT_EQ(u.port, 1935);
+    EXPECT_EQ(u.app, "app");
+    EXPECT_EQ(u.stream_key, "abc-123");
+    EXPECT_EQ(u.tc_url, "rtmp://live.example.com/app");
+
+    ASSERT_TRUE(parse_rtmp_url("rtmp://10.0.0.2:1936/live/sub/key", u));
+    EXPECT_EQ(u.host, "10.0.0.2");
+    EXPECT_EQ(u.port, 1936);
+    EXPECT_EQ(u.app, "live/sub");
+    EXPECT_EQ(u.stream_key, "key");
+
+    EXPECT_FALSE(parse_rtmp_url("rtmps://host/app/key", u));
+    EXPECT_FALSE(parse_rtmp_url("rtmp://host/app", u));
+    EXPECT_FALSE(parse_rtmp_url("rtmp://host:99999/app/key", u));
+}
+
+TEST(Amf0Test, CommandRoundTrips) {
+    std::vector<uint8_t> bytes;
+    Amf0Writer w(bytes);
+    w.string("_result");
+    w.number(1);
+    w.null();
+    w.begin_object();
+    w.key("code");  w.string("NetConnection.Connect.Success");
+    w.key("level"); w.boolean(true);
+    w.end_object();
+    w.begin_ecma_array(1);
+    w.key("width"); w.number(1920);
+    w.end_object();
+
+    std::vector<Amf0Value> v;
+    ASSERT_TRUE(parse_amf0_values(bytes.data(), bytes.size(), v));
+    ASSERT_EQ(v.size(), 5u);
+    EXPECT_EQ(v[0].string, "_result");
+    EXPECT_EQ(v[1].number, 1.0);
+    EXPECT_EQ(v[2].type, Amf0Value::Type::Null);
+    ASSERT_NE(v[3].find("code"), nullptr);
+    EXPECT_EQ(v[3].find("code")->string, "NetConnection.Connect.Success");
+    EXPECT_TRUE(v[3].find("level")->boolean);
+    EXPECT_EQ(v[3].find("missing"), nullptr);
+    ASSERT_NE(v[4].find("width"), nullptr);
+    EXPECT_EQ(v[4].find("width")->number, 1920.0);
+
+    // Truncated input is an error, not a partial result
+    EXPECT_FALSE(parse_amf0_values(bytes.data(), bytes.size() - 3, v));
+}
+
+TEST(RtmpChunkTest, MessagesSurviveChunkingAndArbitraryReads) {
+    std::vector<uint8_t> big(10'000);
+    for (size_t i = 0; i < big.size(); ++i) big[i] = static_cast<uint8_t>(i * 7);
+    const uint8_t small[3] = { 1, 2, 3 };
+
+    for (uint32_t chunk : { 128u, 4096u }) {
+        std::vector<uint8_t> wire;
+        append_rtmp_message(wire, rtmp::kCsidVideo, 40, rtmp::kVideo, 1, big.data(), big.size(), chunk);
+        append_rtmp_message(wire, rtmp::kCsidCommand, 0, rtmp::kCommandAmf0, 0, small, 3, chunk);
+        append_rtmp_message(wire, rtmp::kCsidVideo, 0x1234567, rtmp::kVideo, 1, big.data(), 300, chunk);
+
+        for (size_t step : { size_t{ 1 }, size_t{ 7 }, wire.size() }) {
+            const auto got = read_all(wire, step, chunk);
+            ASSERT_EQ(got.size(), 3u) << "chunk " << chunk << " step " << step;
+            EXPECT_EQ(got[0].type, rtmp::kVideo);
+            EXPECT_EQ(got[0].stream_id, 1u);
+            EXPECT_EQ(got[0].timestamp, 40u);
+            EXPECT_EQ(got[0].payload, big);
+            EXPECT_EQ(got[1].type, rtmp::kCommandAmf0);
+            EXPECT_EQ(got[1].payload, std::vector<uint8_t>(small, small + 3));
+            // Extended timestamp, repeated on the continuation chunks
+            EXPECT_EQ(got[2].timestamp, 0x1234567u);
+            EXPECT_EQ(got[2].payload, std::vector<uint8_t>(big.begin(), big.begin() + 300));
+        }
+    }
+}
+
+TEST(RtmpChunkTest, ParsesCompressedHeadersFromTheServer) {
+    // fmt 0 then a fmt 2 (timestamp delta only) on the same chunk stream
+    const std::vector<uint8_t> wire = {
+        0x03, 0x00, 0x00, 0x10, 0x00, 0x00, 0x02, 0x14, 0x01, 0x00, 0x00, 0x00, 0xAA, 0xBB,
+        0x83, 0x00, 0x00, 0x05, 0xCC, 0xDD,
+    };
+    const auto got = read_all(wire, 1);
+    ASSERT_EQ(got.size(), 2u);
+    EXPECT_EQ(got[0].timestamp, 0x10u);
+    EXPECT_EQ(got[1].timestamp, 0x15u);
+    EXPECT_EQ(got[1].type, rtmp::kCommandAmf0);
+    EXPECT_EQ(got[1].stream_id, 1u);
+    EXPECT_EQ(got[1].payload, (std::vector<uint8_t>{ 0xCC, 0xDD }));
+}
+
+TEST(FlvAvcTest, AnnexBBecomesLengthPrefixedWithoutAud) {
+    const std::vector<uint8_t> annexb = {
+        0, 0, 0, 1, 0x09, 0xF0,                  // AUD (dropped)
+        0, 0, 0, 1, 0x67, 0x64, 0x00, 0x28,      // SPS
+        0, 0, 1, 0x68, 0xEE,                     // PPS, 3-byte start code
+        0, 0, 0, 1, 0x65, 0x88, 0x00, 0x10,      // IDR with an inner zero
+    };
+    std::vector<uint8_t> avcc;
+    annexb_to_avcc(annexb.data(), annexb.size(), avcc);
+    const std::vector<uint8_t> expected = {
+        0, 0, 0, 4, 0x67, 0x64, 0x00, 0x28,
+        0, 0, 0, 2, 0x68, 0xEE,
+        0, 0, 0, 4, 0x65, 0x88, 0x00, 0x10,
+    };
+    EXPECT_EQ(avcc, expected);
+}
+
+TEST(FlvAvcTest, SequenceHeaderIsAnAvcDecoderConfigurationRecord) {
+    const std::vector<uint8_t> sps = { 0x67, 0x64, 0x00, 0x28, 0xAC };
+    const std::vector<uint8_t> pps = { 0x68, 0xEE, 0x3C };
+    const auto h = flv_avc_sequence_header(sps, pps);
+    const std::vector<uint8_t> expected = {
+        0x17, 0x00, 0x00, 0x00, 0x00,
+        0x01, 0x64, 0x00, 0x28, 0xFF, 0xE1,
+        0x00, 0x05, 0x67, 0x64, 0x00, 0x28, 0xAC,
+        0x01, 0x00, 0x03, 0x68, 0xEE, 0x3C,
+    };
+    EXPECT_EQ(h, expected);
+    EXPECT_TRUE(flv_avc_sequence_header({ 0x67 }, pps).empty());
+
+    std::vector<uint8_t> tag;
+    flv_avc_nalu_header(tag, false);
+    EXPECT_EQ(tag, (std::vector<uint8_t>{ 0x27, 0x01, 0x00, 0x00, 0x00 }));
+}
+
+// ---------------------------------------------------------------------------
+
+namespace {
+
+constexpr int64_t kFrame100ns = 333'333;   // 30 fps
+
+// GOPs of `gop` frames; the frame value is its index
+void push_frames(GopSendQueue<int>& q, int first, int count, int gop) {
+    for (int i = first; i < first + count; ++i) {
+        q.push(i, i * kFrame100ns, 1000, i % gop == 0);
+    }
+}
+
+std::vector<int> drain(GopSendQueue<int>& q) {
+    std::vector<int> out;
+    GopSendQueue<int>::Entry e;
+    while (q.pop(e, std::chrono::milliseconds(0))) out.push_back(e.frame);
+    return out;
+}
+
+} // namespace
+
+TEST(GopSendQueueTest, PassesEverythingWithinLimits) {
+    GopSendQueue<int> q;
+    q.reset(2 * 10'000'000, 0);
+    push_frames(q, 0, 30, 10);
+    const auto out = drain(q);
+    ASSERT_EQ(out.size(), 30u);
+    EXPECT_EQ(out.front(), 0);
+    EXPECT_EQ(out.back(), 29);
+    EXPECT_EQ(q.stats().dropped_frames, 0u);
+}
+
+TEST(GopSendQueueTest, LatencyOverflowDropsWholeOldestGops) {
+    GopSendQueue<int> q;
+    q.reset(2 * 10'000'000, 0);   // 2 s = 60 frames
+    push_frames(q, 0, 90, 30);    // three 1 s GOPs with nothing popped
+    const auto out = drain(q);
+    ASSERT_FALSE(out.empty());
+    // The stream resumes on a keyframe and is contiguous from there
+    EXPECT_EQ(out.front() % 30, 0);
+    for (size_t i = 1; i < out.size(); ++i) EXPECT_EQ(out[i], out[i - 1] + 1);
+    EXPECT_EQ(out.back(), 89);
+    EXPECT_EQ(q.stats().dropped_frames, static_cast<uint64_t>(90 - out.size()));
+    EXPECT_GE(q.stats().dropped_gops, 1u);
+}
+
+TEST(GopSendQueueTest, ByteLimitWithoutALaterKeyframeWaitsForTheNextOne) {
+    GopSendQueue<int> q;
+    q.reset(0, 5 * 1000);       // five frames of 1000 bytes
+    push_frames(q, 0, 8, 100);  // one long GOP: no keyframe to fall back to
+    EXPECT_TRUE(drain(q).empty());
+    // Inter frames are refused until the next keyframe
+    EXPECT_FALSE(q.push(8, 8 * kFrame100ns, 1000, false));
+    EXPECT_TRUE(q.push(9, 9 * kFrame100ns, 1000, true));
+    EXPECT_EQ(drain(q), std::vector<int>{ 9 });
+}
+
+TEST(GopSendQueueTest, StartsAndRestartsOnAKeyframe) {
+    GopSendQueue<int> q;
+    q.reset(0, 0);
+    EXPECT_FALSE(q.push(0, 0, 10, false));   // a stream cannot open on a P frame
+    push_frames(q, 1, 5, 3);                 // key at 3
+    EXPECT_EQ(drain(q), (std::vector<int>{ 3, 4, 5 }));
+
+    push_frames(q, 6, 3, 3);                 // 6 key, 7, 8
+    q.restart_at_keyframe();                 // reconnect: stale frames go
+    EXPECT_EQ(q.size(), 0u);
+    EXPECT_FALSE(q.push(10, 10 * kFrame100ns, 10, false));
+    EXPECT_TRUE(q.push(12, 12 * kFrame100ns, 10, true));
+    EXPECT_EQ(drain(q), std::vector<int>{ 12 });
+
+    q.close();
+    EXPECT_FALSE(q.push(15, 15 * kFrame100ns, 10, true));
+}
@@ -0,0 +1,156 @@
+// test_sample_pool.cpp — Unit tests for the tracked-sample recycling pool
+
+#include <gtest/gtest.h>
+#include "encoder/sample_pool.h"
+
+#include <d3d11.h>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+using namespace sr;
+
+namespace {
+
+// The release callback may run on an MF work-queue thread
+bool wait_free(SamplePool& pool, uint32_t n) {
+    for (int i = 0; i < 200 && pool.free_samples() < n; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    return pool.free_samples() >= n;
+}
+
+ULONG ref_count(IUnknown* obj) {
+    obj->AddRef();
+    return obj->Release();
+}
+
+} // namespace
+
+class SamplePoolTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        MFStartup(MF_VERSION);
+        pool_.Attach(SamplePool::create(L"Test", 2));
+    }
+    void TearDown() override {
+        pool_->shutdown();
+        pool_.Reset();
+        MFShutdown();
+    }
+
+    ComPtr<SamplePool> pool_;
+};
+
+TEST_F(SamplePoolTest, ReleasedSampleIsHandedOutAgain) {
+    ComPtr<IMFSample> a;
+    ComPtr<IMFMediaBuffer> buf;
+    ASSERT_TRUE(pool_->acquire(4096, a, buf));
+    IMFSample* first = a.Get();
+    IMFMediaBuffer* first_buffer = buf.Get();
+    DWORD max_len = 0;
+    buf->GetMaxLength(&max_len);
+    EXPECT_GE(max_len, 4096u);
+
+    a->SetUINT32(MFSampleExtension_CleanPoint, TRUE);
+    buf.Reset();
+    a.Reset();   // last reference: back to the pool
+    ASSERT_TRUE(wait_free(*pool_, 1));
+
+    ComPtr<IMFSample> b;
+    ASSERT_TRUE(pool_->acquire(1024, b, buf));
+    EXPECT_EQ(b.Get(), first);
+    EXPECT_EQ(buf.Get(), first_buffer);   // big enough, kept
+    UINT32 clean = 0;
+    EXPECT_TRUE(FAILED(b->GetUINT32(MFSampleExtension_CleanPoint, &clean))) << "stale attribute after reuse";
+    EXPECT_EQ(pool_->created(), 1u);
+    EXPECT_EQ(pool_->recycled(), 1u);
+}
+
+TEST_F(SamplePoolTest, LargerRequestGetsBigEnoughBuffer) {
+    ComPtr<IMFSample> s;
+    ComPtr<IMFMediaBuffer> buf;
+    ASSERT_TRUE(pool_->acquire(256, s, buf));
+    s.Reset();
+    buf.Reset();
+    ASSERT_TRUE(wait_free(*pool_, 1));
+    ASSERT_TRUE(pool_->acquire(8192, s, buf));
+    DWORD max_len = 0;
+    buf->GetMaxLength(&max_len);
+    EXPECT_GE(max_len, 8192u);
+    DWORD count = 0;
+    s->GetBufferCount(&count);
+    EXPECT_EQ(count, 1u);
+}
+
+TEST_F(SamplePoolTest, FallsBackToTransientWhenAllInFlight) {
+    std::vector<ComPtr<IMFSample>> held(3);
+    for (auto& s : held) ASSERT_TRUE(pool_->acquire(512, s));
+    EXPECT_EQ(pool_->created(), 2u);
+    EXPECT_EQ(pool_->transient(), 1u);
+    ComPtr<IMFTrackedSample> tracked;
+    EXPECT_TRUE(FAILED(held[2].As(&tracked))) << "the fallback is a plain sample";
+}
+
+TEST_F(SamplePoolTest, SamplesOutliveShutdown) {
+    ComPtr<IMFSample> s;
+    ASSERT_TRUE(pool_->acquire(512, s));
+    pool_->shutdown();
+    pool_.Reset();   // the lent sample still references the pool
+    EXPECT_TRUE(SUCCEEDED(s->SetSampleTime(1)));
+    s.Reset();
+    pool_.Attach(SamplePool::create(L"Test", 2));   // for TearDown
+}
+
+TEST_F(SamplePoolTest, SharedBufferIsDetachedOnReturn) {
+    ComPtr<IMFMediaBuffer> silence;
+    ASSERT_TRUE(SUCCEEDED(MFCreateMemoryBuffer(1920, &silence)));
+    silence->SetCurrentLength(1920);
+
+    std::vector<ComPtr<IMFSample>> held(2);
+    for (auto& s : held) ASSERT_TRUE(pool_->acquire_shared(silence.Get(), s));
+    for (auto& s : held) {
+        ComPtr<IMFMediaBuffer> b;
+        ASSERT_TRUE(SUCCEEDED(s->GetBufferByIndex(0, &b)));
+        EXPECT_EQ(b.Get(), silence.Get());   // one buffer behind every silent sample
+    }
+    held.clear();
+    ASSERT_TRUE(wait_free(*pool_, 2));
+
+    // The borrowed buffer is not recycled as pool memory
+    ComPtr<IMFSample> s;
+    ComPtr<IMFMediaBuffer> buf;
+    ASSERT_TRUE(pool_->acquire(512, s, buf));
+    EXPECT_NE(buf.Get(), silence.Get());
+    DWORD count = 0;
+    s->GetBufferCount(&count);
+    EXPECT_EQ(count, 1u);
+}
+
+TEST_F(SamplePoolTest, ReturnedSurfaceSampleReleasesTheTexture) {
+    ComPtr<ID3D11Device> device;
+    ASSERT_TRUE(SUCCEEDED(D3D11CreateDevice(nullptr, D3D_DRIVER_TYPE_WARP, nullptr, 0, nullptr, 0,
+                                            D3D11_SDK_VERSION, &device, nullptr, nullptr)));
+    D3D11_TEXTURE2D_DESC td{};
+    td.Width = td.Height = 64;
+    td.MipLevels = td.ArraySize = 1;
+    td.Format = DXGI_FORMAT_B8G8R8A8_UNORM;
+    td.SampleDesc.Count = 1;
+    td.Usage = D3D11_USAGE_DEFAULT;
+    td.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+    ComPtr<ID3D11Texture2D> tex;
+    ASSERT_TRUE(SUCCEEDED(device->CreateTexture2D(&td, nullptr, &tex)));
+
+    // The capture rings reclaim a slot once its texture is back at this count
+    const ULONG idle = ref_count(tex.Get());
+    for (int round = 0; round < 2; ++round) {
+        ComPtr<IMFSample> s;
+        ASSERT_TRUE(pool_->acquire_surface(tex.Get(), 64 * 64 * 4, s));
+        EXPECT_GT(ref_count(tex.Get()), idle);
+        s.Reset();
+        ASSERT_TRUE(wait_free(*pool_, 1));
+        EXPECT_EQ(ref_count(tex.Get()), idle) << "round " << round;
+    }
+    EXPECT_EQ(pool_->created(), 1u);
+    EXPECT_EQ(pool_->recycled(), 1u);
+}
@@ -0,0 +1,54 @@
+// test_segment_policy.cpp — Unit tests for segment rotation decisions
+
+#include <gtest/gtest.h>
+#include "storage/segment_policy.h"
+
+using sr::SegmentLimits;
+using sr::SegmentPolicy;
+
+static constexpr int64_t kMinute = 60LL * 10'000'000;
+
+TEST(SegmentPolicyTest, DisabledNeverRotates) {
+    SegmentPolicy p;
+    p.reset({});
+    EXPECT_FALSE(p.enabled());
+    EXPECT_FALSE(p.check(600 * kMinute, 100ULL << 30));
+    EXPECT_FALSE(p.opens_segment(true));
+}
+
+TEST(SegmentPolicyTest, DurationLimitWaitsForKeyframe) {
+    SegmentPolicy p;
+    p.reset({ 10, 0 });
+    EXPECT_FALSE(p.check(9 * kMinute, 0));
+    EXPECT_TRUE(p.check(10 * kMinute, 0));
+    // Signalled once until the segment actually rotates
+    EXPECT_FALSE(p.check(10 * kMinute + 1, 0));
+    EXPECT_TRUE(p.pending());
+    EXPECT_FALSE(p.opens_segment(false));
+    EXPECT_TRUE(p.opens_segment(true));
+
+    p.start_segment(10 * kMinute + 5);
+    EXPECT_EQ(p.segment_index(), 2u);
+    EXPECT_FALSE(p.pending());
+    EXPECT_FALSE(p.check(19 * kMinute, 0));
+    EXPECT_TRUE(p.check(20 * kMinute + 5, 0));
+}
+
+TEST(SegmentPolicyTest, SizeLimitUsesMegabytes) {
+    SegmentPolicy p;
+    p.reset({ 0, 512 });
+    EXPECT_FALSE(p.check(kMinute, 511ULL * 1024 * 1024));
+    EXPECT_TRUE(p.check(kMinute, 512ULL * 1024 * 1024));
+}
+
+TEST(SegmentPolicyTest, DisableKeepsIndex) {
+    SegmentPolicy p;
+    p.reset({ 1, 0 });
+    EXPECT_TRUE(p.check(kMinute, 0));
+    p.start_segment(kMinute);
+    EXPECT_TRUE(p.check(2 * kMinute, 0));
+    p.disable();
+    EXPECT_FALSE(p.pending());
+    EXPECT_FALSE(p.check(10 * kMinute, 0));
+    EXPECT_EQ(p.segment_index(), 2u);
+}
@@ -39,4 +39,62 @@ TEST(SessionDiagnosticsTest, StartSummaryIncludesHardwareProfileAndPowerState) {
     EXPECT_NE(summary.find(L"power=Battery"), std::wstring::npos);
     EXPECT_NE(summary.find(L"quality=HQ"), std::wstring::npos);
     EXPECT_NE(summary.find(L"profile=1920x1080@60fps 10000000bps"), std::wstring::npos);
+    EXPECT_NE(summary.find(L"cross_adapter=no"), std::wstring::npos);
+    EXPECT_NE(summary.find(L"split_encode=no"), std::wstring::npos);
+}
+
+TEST(SessionDiagnosticsTest, SummaryTracksWritesWithoutAnOpenFile) {
+    sr::SessionDiagnostics diagnostics;
+    EXPECT_EQ(sr::SessionDiagnostics::exit_code(diagnostics.summary()),
+              sr::SessionDiagnostics::kExitStartFailed);
+
+    sr::SessionDiagnostics::StartInfo start;
+    start.width = 1280;
+    diagnostics.write_start(start);
+    sr::SessionDiagnostics::StopInfo stop;
+    stop.status = L"complete";
+    stop.frames_encoded = 300;
+    diagnostics.write_stop(stop);
+    EXPECT_TRUE(diagnostics.summary().started);
+    EXPECT_EQ(diagnostics.summary().stop.frames_encoded, 300u);
+    EXPECT_EQ(sr::SessionDiagnostics::exit_code(diagnostics.summary()),
+              sr::SessionDiagnostics::kExitComplete);
+
+    diagnostics.write_failure(L"capture_start_failed");
+    EXPECT_EQ(diagnostics.summary().failure, L"capture_start_failed");
+    EXPECT_EQ(sr::SessionDiagnostics::exit_code(diagnostics.summary()),
+              sr::SessionDiagnostics::kExitStartFailed);
+}
+
+TEST(SessionDiagnosticsTest, ExitCodeSeparatesFailedStartFromPartialFile) {
+    sr::SessionDiagnostics::Summary summary;
+    summary.started = true;
+    EXPECT_EQ(sr::SessionDiagnostics::exit_code(summary), sr::SessionDiagnostics::kExitStartFailed);
+    summary.stopped = true;
+    summary.stop.status = L"finalize_failed_partial_kept";
+    EXPECT_EQ(sr::SessionDiagnostics::exit_code(summary), sr::SessionDiagnostics::kExitPartialKept);
+}
+
+TEST(SessionDiagnosticsTest, JsonSummaryEscapesPathsAndListsFiles) {
+    sr::SessionDiagnostics::Summary summary;
+    summary.started = true;
+    summary.stopped = true;
+    summary.start.output_path = L"C:\\Rec\\\"ci\".mp4";
+    summary.start.fps = 30;
+    summary.stop.status = L"complete";
+    summary.stop.frames_encoded = 900;
+
+    const std::string json = sr::SessionDiagnostics::format_json_summary(
+        summary, { L"C:\\Rec\\a.mp4", L"C:\\Rec\\b.mp4" });
+
+    EXPECT_EQ(json.front(), '{');
+    EXPECT_EQ(json.back(), '}');
+    EXPECT_NE(json.find("\"status\":\"complete\""), std::string::npos);
+    EXPECT_NE(json.find("\"exit_code\":0"), std::string::npos);
+    EXPECT_NE(json.find("\"output\":\"C:\\\\Rec\\\\\\\"ci\\\".mp4\""), std::string::npos);
+    EXPECT_NE(json.find("\"fps\":30"), std::string::npos);
+    EXPECT_NE(json.find("\"frames_encoded\":900"), std::string::npos);
+    EXPECT_NE(json.find("\"files\":[\"C:\\\\Rec\\\\a.mp4\",\"C:\\\\Rec\\\\b.mp4\"]"), std::string::npos);
+
+    EXPECT_NE(sr::SessionDiagnostics::format_json_summary({}).find("\"status\":\"failed\""), std::string::npos);
 }
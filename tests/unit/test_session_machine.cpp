@@ -68,6 +68,40 @@ TEST_F(SessionMachineTest, FullCycle) {
     EXPECT_TRUE(machine.is_idle());
 }
 
+TEST_F(SessionMachineTest, ArmDisarmCycle) {
+    EXPECT_TRUE(machine.transition(SessionEvent::Arm));
+    EXPECT_TRUE(machine.is_armed());
+    EXPECT_FALSE(machine.is_idle());
+    EXPECT_TRUE(machine.transition(SessionEvent::Disarm));
+    EXPECT_TRUE(machine.is_idle());
+}
+
+TEST_F(SessionMachineTest, ArmedStartRecords) {
+    machine.transition(SessionEvent::Arm);
+    EXPECT_TRUE(machine.transition(SessionEvent::Start));
+    EXPECT_TRUE(machine.is_recording());
+    EXPECT_TRUE(machine.transition(SessionEvent::Stop));
+    EXPECT_TRUE(machine.transition(SessionEvent::Finalized));
+    EXPECT_TRUE(machine.is_idle());  // re-arming is the controller's job
+}
+
+TEST_F(SessionMachineTest, ArmedRejectsSessionEvents) {
+    machine.transition(SessionEvent::Arm);
+    EXPECT_FALSE(machine.transition(SessionEvent::Arm));
+    EXPECT_FALSE(machine.transition(SessionEvent::Pause));
+    EXPECT_FALSE(machine.transition(SessionEvent::Stop));
+    EXPECT_FALSE(machine.transition(SessionEvent::Finalized));
+    EXPECT_EQ(machine.state(), SessionState::Armed);
+}
+
+TEST_F(SessionMachineTest, DisarmOnlyFromArmed) {
+    EXPECT_FALSE(machine.transition(SessionEvent::Disarm));
+    machine.transition(SessionEvent::Start);
+    EXPECT_FALSE(machine.transition(SessionEvent::Disarm));
+    EXPECT_FALSE(machine.transition(SessionEvent::Arm));
+    EXPECT_EQ(machine.state(), SessionState::Recording);
+}
+
 // T007: Invalid transitions (rejected)
 
 TEST_F(SessionMachineTest, IdleCannotPause) {
@@ -70,6 +70,29 @@ TEST_F(StorageManagerTest, FilenameFormat) {
     EXPECT_EQ(ext, L".partial.mp4");
 }
 
+TEST_F(StorageManagerTest, FileStemReplacesTheTimestamp) {
+    StorageManager mgr;
+    mgr.setOutputDirectory(temp_dir);
+    mgr.setFileStem(L"ci_run");
+    auto name = mgr.generateFilename();
+    EXPECT_EQ(name, temp_dir + L"\\ci_run.partial.mp4");
+
+    HANDLE h = CreateFileW(StorageManager::partialToFinal(name).c_str(), GENERIC_WRITE, 0, nullptr,
+                           CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (h != INVALID_HANDLE_VALUE) CloseHandle(h);
+    EXPECT_EQ(mgr.generateFilename(), temp_dir + L"\\ci_run_001.partial.mp4");
+}
+
+TEST_F(StorageManagerTest, TaggedNamesAreUniqueBeforeTheirFilesExist) {
+    StorageManager mgr;
+    mgr.setOutputDirectory(temp_dir);
+    mgr.setFileStem(L"session");
+    EXPECT_EQ(mgr.generateFilename(L"replay"), temp_dir + L"\\session_replay.partial.mp4");
+    // Nothing written yet (the replay saver creates it later): still a new name
+    EXPECT_EQ(mgr.generateFilename(L"replay"), temp_dir + L"\\session_replay_001.partial.mp4");
+    EXPECT_EQ(mgr.generateFilename(L"replay"), temp_dir + L"\\session_replay_002.partial.mp4");
+}
+
 TEST_F(StorageManagerTest, PartialToFinal) {
     auto result = StorageManager::partialToFinal(L"C:\\test\\ScreenRec_2026.partial.mp4");
     EXPECT_EQ(result, L"C:\\test\\ScreenRec_2026.mp4");
@@ -85,6 +108,24 @@ TEST_F(StorageManagerTest, PartialToFinalLeavesUnrelatedPathUnchanged) {
     EXPECT_EQ(result, L"C:\\test\\ScreenRec_2026.mp4");
 }
 
+TEST_F(StorageManagerTest, ProxyFilenameSitsNextToMainFile) {
+    auto proxy = StorageManager::proxyFilename(L"C:\\test\\ScreenRec_2026.partial.mp4");
+    EXPECT_EQ(proxy, L"C:\\test\\ScreenRec_2026_proxy.partial.mp4");
+    EXPECT_EQ(StorageManager::partialToFinal(proxy), L"C:\\test\\ScreenRec_2026_proxy.mp4");
+}
+
+TEST_F(StorageManagerTest, DisplayFilenameNumbersEachMonitor) {
+    auto display = StorageManager::displayFilename(L"C:\\test\\ScreenRec_2026.partial.mp4", 2);
+    EXPECT_EQ(display, L"C:\\test\\ScreenRec_2026_display2.partial.mp4");
+    EXPECT_EQ(StorageManager::partialToFinal(display), L"C:\\test\\ScreenRec_2026_display2.mp4");
+}
+
+TEST_F(StorageManagerTest, TranscodeFilenameTagsTheRendition) {
+    auto rendition = StorageManager::transcodeFilename(L"C:\\test\\ScreenRec_2026.mp4", L"720p");
+    EXPECT_EQ(rendition, L"C:\\test\\ScreenRec_2026_720p.partial.mp4");
+    EXPECT_EQ(StorageManager::partialToFinal(rendition), L"C:\\test\\ScreenRec_2026_720p.mp4");
+}
+
 TEST_F(StorageManagerTest, DiskSpaceCheck) {
     StorageManager mgr;
     uint64_t free = mgr.getFreeDiskSpace();
@@ -0,0 +1,76 @@
+// test_surface_ring.cpp — Unit tests for SurfaceRing (capture NV12 slot free-list)
+
+#include <gtest/gtest.h>
+#include "capture/surface_ring.h"
+
+#include <array>
+
+using sr::SurfaceRing;
+
+TEST(SurfaceRingTest, ClampsSizeAndStartsFree) {
+    SurfaceRing ring;
+    ring.reset(1);
+    EXPECT_EQ(ring.size(), SurfaceRing::kMinSlots);
+    ring.reset(64);
+    EXPECT_EQ(ring.size(), SurfaceRing::kMaxSlots);
+    ring.reset(5);
+    EXPECT_EQ(ring.free_count(), 5u);
+    EXPECT_FALSE(ring.latest().has_value());
+}
+
+TEST(SurfaceRingTest, HeldSlotsAreNeverReissued) {
+    SurfaceRing ring;
+    ring.reset(3);
+    std::array<bool, 3> held{};
+    auto still_held = [&](uint32_t i) { return held[i]; };
+
+    // Three frames queued downstream, none released yet
+    for (int f = 0; f < 3; ++f) {
+        const auto slot = ring.acquire(still_held);
+        ASSERT_TRUE(slot.has_value());
+        EXPECT_FALSE(held[*slot]);
+        held[*slot] = true;
+        ring.publish(*slot);
+    }
+    EXPECT_FALSE(ring.acquire(still_held).has_value());
+    EXPECT_EQ(ring.exhausted(), 1u);
+
+    // Consumer releases the oldest frame: exactly that slot comes back
+    held[0] = false;
+    const auto slot = ring.acquire(still_held);
+    ASSERT_TRUE(slot.has_value());
+    EXPECT_EQ(*slot, 0u);
+}
+
+TEST(SurfaceRingTest, LatestSlotKeptForDuplicates) {
+    SurfaceRing ring;
+    ring.reset(2);
+    auto released = [](uint32_t) { return false; };
+
+    const auto a = ring.acquire(released);
+    ASSERT_TRUE(a.has_value());
+    ring.publish(*a);
+    EXPECT_EQ(ring.latest(), a);
+
+    // Even though nobody holds `a`, it is the duplicate source and stays put
+    const auto b = ring.acquire(released);
+    ASSERT_TRUE(b.has_value());
+    EXPECT_NE(*b, *a);
+    ring.publish(*b);
+
+    // Now `a` is no longer latest and can be reclaimed
+    const auto c = ring.acquire(released);
+    ASSERT_TRUE(c.has_value());
+    EXPECT_EQ(*c, *a);
+}
+
+TEST(SurfaceRingTest, AbandonedSlotReturnsToFreeList) {
+    SurfaceRing ring;
+    ring.reset(2);
+    auto released = [](uint32_t) { return false; };
+    const auto a = ring.acquire(released);
+    ASSERT_TRUE(a.has_value());
+    ring.abandon(*a);
+    EXPECT_EQ(ring.free_count(), 2u);
+    EXPECT_FALSE(ring.latest().has_value());
+}
@@ -3,7 +3,6 @@
 
 #include <gtest/gtest.h>
 #include "sync/sync_manager.h"
-#include <windows.h>
 #include <thread>
 #include <chrono>
 
@@ -11,16 +10,12 @@ namespace {
 
 // Helper: get current QPC value
 int64_t now_qpc() {
-    LARGE_INTEGER li{};
-    QueryPerformanceCounter(&li);
-    return li.QuadPart;
+    return sr::QPCClock::ticks();
 }
 
 // Helper: get QPC frequency
 int64_t qpc_freq() {
-    LARGE_INTEGER li{};
-    QueryPerformanceFrequency(&li);
-    return li.QuadPart;
+    return sr::QPCClock::instance().frequency();
 }
 
 // Convert milliseconds to QPC ticks
@@ -172,3 +167,29 @@ TEST_F(SyncManagerTest, PTSNonNegativeDuringPause) {
     int64_t pts_while_paused = sync_.now_pts();
     EXPECT_GE(pts_while_paused, 0) << "PTS should be >= 0 while paused";
 }
+
+// System-relative 100ns timestamps (WGC SystemRelativeTime) share the QPC time
+// base: the anchor maps to 0 and later times advance 1:1
+TEST_F(SyncManagerTest, SessionTimeFromSystemRelativeTime) {
+    sync_.start();
+    const int64_t anchor_100ns = sr::QPCClock::instance().ticks_to_hns(sync_.anchor_qpc());
+    EXPECT_EQ(sync_.session_time(anchor_100ns), 0);
+    EXPECT_EQ(sync_.session_time(anchor_100ns + 166'667), 166'667);
+    EXPECT_LT(sync_.session_time(anchor_100ns - 1), 0);  // composed before start
+
+    // Agrees with the tick-based PTS to within one 100ns unit
+    const int64_t later = sync_.anchor_qpc() + ms_to_ticks(250);
+    EXPECT_NEAR(sync_.session_time(sr::QPCClock::instance().ticks_to_hns(later)),
+                sync_.to_pts(later), 1);
+}
+
+// Pause gaps are kept: the audio sample clock doesn't stop either
+TEST_F(SyncManagerTest, SessionTimeKeepsPauseGap) {
+    sync_.start();
+    const int64_t anchor_100ns = sr::QPCClock::instance().ticks_to_hns(sync_.anchor_qpc());
+    sync_.pause();
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    sync_.resume();
+    ASSERT_GT(sync_.paused_total_100ns(), 0);
+    EXPECT_EQ(sync_.session_time(anchor_100ns + 10'000'000), 10'000'000);
+}
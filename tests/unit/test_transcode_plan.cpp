@@ -0,0 +1,47 @@
+// test_transcode_plan.cpp — Unit tests for background transcode sizing / bitrate / workers
+
+#include <gtest/gtest.h>
+#include "encoder/transcode_plan.h"
+
+using sr::TranscodeSize;
+
+TEST(TranscodePlanTest, FitsTheBoxAndKeepsTheAspectRatio) {
+    const TranscodeSize s = sr::transcode_frame_size(1920, 1080, 1280, 720);
+    EXPECT_EQ(s.width, 1280u);
+    EXPECT_EQ(s.height, 720u);
+
+    const TranscodeSize tall = sr::transcode_frame_size(2560, 1600, 1280, 720);
+    EXPECT_EQ(tall.height, 720u);
+    EXPECT_EQ(tall.width, 1152u);
+}
+
+TEST(TranscodePlanTest, NeverUpscalesAndRoundsToEvenSizes) {
+    const TranscodeSize same = sr::transcode_frame_size(1280, 720, 1920, 1080);
+    EXPECT_EQ(same.width, 1280u);
+    EXPECT_EQ(same.height, 720u);
+
+    const TranscodeSize odd = sr::transcode_frame_size(1366, 768, 0, 480);
+    EXPECT_EQ(odd.height, 480u);
+    EXPECT_EQ(odd.width % 2, 0u);
+    EXPECT_EQ(odd.width, 854u);
+
+    const TranscodeSize none = sr::transcode_frame_size(0, 1080, 1280, 720);
+    EXPECT_EQ(none.width, 0u);
+}
+
+TEST(TranscodePlanTest, BitrateFollowsThePixelCount) {
+    const TranscodeSize src{ 1920, 1080 }, out{ 960, 540 };
+    EXPECT_EQ(sr::transcode_bitrate(0, 8'000'000, src, out), 2'000'000u);
+    EXPECT_EQ(sr::transcode_bitrate(0, 8'000'000, src, src), 8'000'000u);
+    EXPECT_EQ(sr::transcode_bitrate(0, 300'000, src, { 320, 180 }), sr::kTranscodeMinBitrate);
+    EXPECT_EQ(sr::transcode_bitrate(1'500'000, 8'000'000, src, out), 1'500'000u);
+    EXPECT_EQ(sr::transcode_bitrate(0, 0, src, out), 4'000'000u);
+}
+
+TEST(TranscodePlanTest, WorkersLeaveAHardwareSessionFree) {
+    EXPECT_EQ(sr::transcode_worker_count(0, 8), 1u);
+    EXPECT_EQ(sr::transcode_worker_count(2, 8), 2u);
+    EXPECT_EQ(sr::transcode_worker_count(16, 16), sr::kTranscodeMaxWorkers);
+    EXPECT_EQ(sr::transcode_worker_count(3, 2), 1u);
+    EXPECT_EQ(sr::transcode_worker_count(3, 0), 3u);   // no hardware limit known
+}
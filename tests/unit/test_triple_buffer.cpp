@@ -0,0 +1,77 @@
+// test_triple_buffer.cpp — Unit tests for the lock-free latest-value hand-off
+
+#include <gtest/gtest.h>
+#include "utils/triple_buffer.h"
+#include <atomic>
+#include <thread>
+
+using sr::TripleBuffer;
+
+TEST(TripleBufferTest, NothingPublishedKeepsDefault) {
+    TripleBuffer<int> tb;
+    EXPECT_FALSE(tb.update());
+    EXPECT_EQ(tb.front(), 0);
+}
+
+TEST(TripleBufferTest, ConsumerSeesLatestPublish) {
+    TripleBuffer<int> tb;
+    tb.back() = 1;
+    tb.publish();
+    tb.back() = 2;
+    tb.publish();
+    ASSERT_TRUE(tb.update());
+    EXPECT_EQ(tb.front(), 2);
+    // No newer value: front stays put
+    EXPECT_FALSE(tb.update());
+    EXPECT_EQ(tb.front(), 2);
+}
+
+TEST(TripleBufferTest, ProducerNeverWritesTheFrontSlot) {
+    TripleBuffer<int> tb;
+    tb.back() = 10;
+    tb.publish();
+    ASSERT_TRUE(tb.update());
+    const int* front = &tb.front();
+    for (int i = 0; i < 5; ++i) {
+        EXPECT_NE(&tb.back(), front);
+        tb.back() = 100 + i;
+        tb.publish();
+    }
+    EXPECT_EQ(tb.front(), 10);
+    ASSERT_TRUE(tb.update());
+    EXPECT_EQ(tb.front(), 104);
+}
+
+TEST(TripleBufferTest, ResetClearsSlots) {
+    TripleBuffer<int> tb;
+    tb.back() = 7;
+    tb.publish();
+    tb.reset();
+    EXPECT_FALSE(tb.update());
+    EXPECT_EQ(tb.front(), 0);
+}
+
+TEST(TripleBufferTest, ConcurrentValuesAreNeverTorn) {
+    struct Pair { uint64_t a = 0; uint64_t b = 0; };
+    TripleBuffer<Pair> tb;
+    std::atomic<bool> done{ false };
+    std::thread producer([&] {
+        for (uint64_t i = 1; i <= 200000; ++i) {
+            tb.back() = { i, ~i };
+            tb.publish();
+        }
+        done = true;
+    });
+    uint64_t last = 0;
+    while (!done.load()) {
+        if (tb.update()) {
+            const Pair p = tb.front();
+            ASSERT_EQ(p.b, ~p.a);
+            ASSERT_GE(p.a, last);
+            last = p.a;
+        }
+    }
+    producer.join();
+    tb.update();
+    EXPECT_EQ(tb.front().a, 200000u);
+}
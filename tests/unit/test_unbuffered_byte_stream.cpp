@@ -0,0 +1,110 @@
+// test_unbuffered_byte_stream.cpp — Unit tests for the write-behind IMFByteStream
+
+#include <gtest/gtest.h>
+#include "storage/unbuffered_byte_stream.h"
+#include <wrl/client.h>
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <vector>
+
+namespace fs = std::filesystem;
+using Microsoft::WRL::ComPtr;
+using sr::UnbufferedByteStream;
+
+class UnbufferedByteStreamTest : public ::testing::Test {
+protected:
+    std::wstring temp_dir;
+    std::wstring path;
+
+    void SetUp() override {
+        wchar_t tmp[MAX_PATH];
+        GetTempPathW(MAX_PATH, tmp);
+        temp_dir = std::wstring(tmp) + L"sr_ubs_" + std::to_wstring(GetCurrentProcessId());
+        fs::create_directories(temp_dir);
+        path = temp_dir + L"\\stream.bin";
+    }
+
+    void TearDown() override {
+        std::error_code ec;
+        fs::remove_all(temp_dir, ec);
+    }
+
+    std::vector<uint8_t> file_bytes() const {
+        std::ifstream in(fs::path(path), std::ios::binary);
+        return { std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>() };
+    }
+};
+
+static std::vector<uint8_t> pattern(size_t size, uint8_t seed) {
+    std::vector<uint8_t> v(size);
+    for (size_t i = 0; i < size; ++i) v[i] = static_cast<uint8_t>(seed + i * 7);
+    return v;
+}
+
+TEST_F(UnbufferedByteStreamTest, SequentialWritesSpanChunksAndTrimTail) {
+    ComPtr<UnbufferedByteStream> stream;
+    stream.Attach(UnbufferedByteStream::create(path, UnbufferedByteStream::kMinChunkBytes));
+    ASSERT_TRUE(stream);
+
+    // 2.5 chunks in odd-sized writes
+    const auto data = pattern(UnbufferedByteStream::kMinChunkBytes * 5 / 2 + 123, 1);
+    size_t off = 0;
+    while (off < data.size()) {
+        const ULONG n = static_cast<ULONG>((std::min)(data.size() - off, size_t{ 65'537 }));
+        ULONG written = 0;
+        ASSERT_TRUE(SUCCEEDED(stream->Write(data.data() + off, n, &written)));
+        ASSERT_EQ(written, n);
+        off += n;
+    }
+    QWORD length = 0;
+    stream->GetLength(&length);
+    EXPECT_EQ(length, data.size());
+    ASSERT_TRUE(SUCCEEDED(stream->Close()));
+
+    EXPECT_EQ(file_bytes(), data);
+    EXPECT_GE(stream->bytes_submitted(), data.size());
+}
+
+TEST_F(UnbufferedByteStreamTest, BackPatchesAndReadsBack) {
+    ComPtr<UnbufferedByteStream> stream;
+    stream.Attach(UnbufferedByteStream::create(path, UnbufferedByteStream::kMinChunkBytes));
+    ASSERT_TRUE(stream);
+
+    auto data = pattern(UnbufferedByteStream::kMinChunkBytes + 5000, 9);
+    ULONG written = 0;
+    ASSERT_TRUE(SUCCEEDED(stream->Write(data.data(), static_cast<ULONG>(data.size()), &written)));
+
+    // Patch inside the submitted first chunk (disk) and inside the current chunk (memory)
+    const uint8_t box_size[4] = { 0xDE, 0xAD, 0xBE, 0xEF };
+    for (const size_t at : { size_t{ 4094 }, UnbufferedByteStream::kMinChunkBytes + 100 }) {
+        ASSERT_TRUE(SUCCEEDED(stream->SetCurrentPosition(at)));
+        ASSERT_TRUE(SUCCEEDED(stream->Write(box_size, 4, &written)));
+        std::copy(box_size, box_size + 4, data.begin() + at);
+    }
+    EXPECT_EQ(stream->disk_patches(), 1u);
+
+    uint8_t back[4]{};
+    ULONG read = 0;
+    ASSERT_TRUE(SUCCEEDED(stream->SetCurrentPosition(4094)));
+    ASSERT_TRUE(SUCCEEDED(stream->Read(back, 4, &read)));
+    EXPECT_EQ(read, 4u);
+    EXPECT_EQ(0, memcmp(back, box_size, 4));
+
+    ASSERT_TRUE(SUCCEEDED(stream->Close()));
+    EXPECT_EQ(file_bytes(), data);
+}
+
+TEST_F(UnbufferedByteStreamTest, HoldsExclusiveWriteLock) {
+    ComPtr<UnbufferedByteStream> stream;
+    stream.Attach(UnbufferedByteStream::create(path, UnbufferedByteStream::kMinChunkBytes));
+    ASSERT_TRUE(stream);
+
+    HANDLE other = CreateFileW(path.c_str(), GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_WRITE,
+                               nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    EXPECT_EQ(other, INVALID_HANDLE_VALUE);
+    if (other != INVALID_HANDLE_VALUE) CloseHandle(other);
+    stream->Close();
+}
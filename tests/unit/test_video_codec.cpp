@@ -0,0 +1,36 @@
+// test_video_codec.cpp — Unit tests for codec preference ordering and bitrate scaling
+
+#include <gtest/gtest.h>
+#include "utils/video_codec.h"
+
+using sr::CodecPreference;
+using sr::VideoCodec;
+
+TEST(VideoCodecTest, AutoPrefersMostEfficientCodecWithH264Last) {
+    std::array<VideoCodec, 3> order{};
+    ASSERT_EQ(sr::codec_try_order(CodecPreference::Auto, order), 3u);
+    EXPECT_EQ(order[0], VideoCodec::AV1);
+    EXPECT_EQ(order[1], VideoCodec::HEVC);
+    EXPECT_EQ(order[2], VideoCodec::H264);
+
+    ASSERT_EQ(sr::codec_try_order(CodecPreference::HEVC, order), 2u);
+    EXPECT_EQ(order[0], VideoCodec::HEVC);
+    EXPECT_EQ(order[1], VideoCodec::H264);
+
+    ASSERT_EQ(sr::codec_try_order(CodecPreference::H264, order), 1u);
+    EXPECT_EQ(order[0], VideoCodec::H264);
+}
+
+TEST(VideoCodecTest, BitrateScalesWithCodecEfficiency) {
+    EXPECT_EQ(sr::codec_bitrate(8'000'000, VideoCodec::H264), 8'000'000u);
+    EXPECT_EQ(sr::codec_bitrate(8'000'000, VideoCodec::HEVC), 4'800'000u);
+    EXPECT_EQ(sr::codec_bitrate(8'000'000, VideoCodec::AV1),  4'400'000u);
+}
+
+TEST(VideoCodecTest, SubtypesAreDistinctFourccs) {
+    EXPECT_TRUE(sr::video_codec_subtype(VideoCodec::H264) == MFVideoFormat_H264);
+    EXPECT_TRUE(sr::video_codec_subtype(VideoCodec::HEVC) == MFVideoFormat_HEVC);
+    const GUID av1 = sr::video_codec_subtype(VideoCodec::AV1);
+    EXPECT_EQ(av1.Data1, static_cast<unsigned long>(FCC('AV01')));
+    EXPECT_TRUE(memcmp(&av1.Data2, &MFVideoFormat_H264.Data2, sizeof(GUID) - sizeof(av1.Data1)) == 0);
+}
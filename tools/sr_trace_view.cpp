@@ -0,0 +1,162 @@
+// sr_trace_view.cpp — Render a recording's .perftrace as a text timeline
+//
+//   sr_trace_view <file.perftrace> [--bucket N] [--from mm:ss] [--to mm:ss] [--csv]
+//
+// One row per second (or per N-second bucket): encoded fps against the
+// target as a bar, drops and duplicates, encode time, frame-queue depth,
+// process and GPU memory, power state and encoder mode. Rows that dropped
+// frames or fell under 90 % of the target rate are marked with '!', so a
+// "stuttered at minute 37" report reads straight off the output.
+
+#include "utils/perf_trace.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+namespace {
+
+void usage() {
+    std::fprintf(stderr,
+                 "usage: sr_trace_view <file.perftrace> [--bucket N] [--from mm:ss] [--to mm:ss] [--csv]\n");
+}
+
+// "mm:ss", "hh:mm:ss" or plain seconds; -1 on garbage
+long parse_time(const char* s) {
+    long total = 0, part = 0;
+    bool digits = false;
+    for (; *s; ++s) {
+        if (*s >= '0' && *s <= '9') {
+            part = part * 10 + (*s - '0');
+            digits = true;
+        } else if (*s == ':' && digits) {
+            total = (total + part) * 60;
+            part = 0;
+            digits = false;
+        } else {
+            return -1;
+        }
+    }
+    return digits ? total + part : -1;
+}
+
+std::string clock_label(uint32_t t) {
+    char buf[16];
+    if (t >= 3600) {
+        std::snprintf(buf, sizeof(buf), "%u:%02u:%02u", t / 3600, (t / 60) % 60, t % 60);
+    } else {
+        std::snprintf(buf, sizeof(buf), "%02u:%02u", t / 60, t % 60);
+    }
+    return buf;
+}
+
+std::string fps_bar(double fps, double target) {
+    constexpr int kWidth = 20;
+    std::string bar(kWidth, ' ');
+    if (target <= 0) return bar;
+    const int filled = static_cast<int>(fps / target * kWidth + 0.5);
+    for (int i = 0; i < kWidth && i < filled; ++i) bar[i] = '#';
+    return bar;
+}
+
+std::string gpu_label(const sr::PerfTraceSample& s) {
+    if (!(s.flags & sr::kPerfTraceGpuMemory)) return "-";
+    char buf[32];
+    std::snprintf(buf, sizeof(buf), "%u/%u", s.gpu_local_mb, s.gpu_local_budget_mb);
+    return buf;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const char* file = nullptr;
+    uint32_t bucket = 1;
+    long from = 0, to = -1;
+    bool csv = false;
+    for (int i = 1; i < argc; ++i) {
+        const char* arg = argv[i];
+        const bool has_value = i + 1 < argc;
+        if (std::strcmp(arg, "--bucket") == 0 && has_value) {
+            const long n = std::strtol(argv[++i], nullptr, 10);
+            bucket = n > 0 ? static_cast<uint32_t>(n) : 1;
+        } else if (std::strcmp(arg, "--from") == 0 && has_value) {
+            from = parse_time(argv[++i]);
+        } else if (std::strcmp(arg, "--to") == 0 && has_value) {
+            to = parse_time(argv[++i]);
+        } else if (std::strcmp(arg, "--csv") == 0) {
+            csv = true;
+        } else if (arg[0] != '-' && !file) {
+            file = arg;
+        } else {
+            usage();
+            return 2;
+        }
+    }
+    if (!file || from < 0) {
+        usage();
+        return 2;
+    }
+
+    sr::PerfTraceHeader header;
+    std::vector<sr::PerfTraceSample> samples;
+    if (!sr::read_perf_trace(std::filesystem::path(file).wstring(), header, samples)) {
+        std::fprintf(stderr, "%s: not a perf trace, or written by another trace version\n", file);
+        return 1;
+    }
+
+    std::vector<sr::PerfTraceSample> window;
+    for (const auto& s : samples) {
+        if (s.t_s >= static_cast<uint32_t>(from) && (to < 0 || s.t_s <= static_cast<uint32_t>(to))) {
+            window.push_back(s);
+        }
+    }
+    const std::vector<sr::PerfTraceSample> rows = sr::bucket_perf_samples(window, bucket);
+    const double target = static_cast<double>(header.fps);
+
+    if (csv) {
+        std::printf("t_s,frames_in,frames_out,drops,duplicates,unchanged,encode_us_avg,encode_us_max,"
+                    "queue_avg,queue_max,private_mb,working_set_mb,gpu_local_mb,gpu_local_budget_mb,"
+                    "gpu_shared_mb,gpu_shared_budget_mb,quality_level,encoder_mode,on_ac,paused\n");
+        for (const auto& r : rows) {
+            std::printf("%u,%u,%u,%u,%u,%u,%u,%u,%.2f,%u,%u,%u,%u,%u,%u,%u,%u,%s,%d,%d\n",
+                        r.t_s, r.frames_in, r.frames_out, r.drops, r.duplicates, r.unchanged,
+                        r.encode_us_avg, r.encode_us_max, r.queue_avg_x100 / 100.0, r.queue_max,
+                        r.private_mb, r.working_set_mb, r.gpu_local_mb, r.gpu_local_budget_mb,
+                        r.gpu_shared_mb, r.gpu_shared_budget_mb, r.quality_level,
+                        sr::perf_trace_mode_label(r.encoder_mode), (r.flags & sr::kPerfTraceOnAc) ? 1 : 0,
+                        (r.flags & sr::kPerfTracePaused) ? 1 : 0);
+        }
+        return 0;
+    }
+
+    std::printf("%ux%u @ %u fps, %u kbps, %zu s recorded\n", header.width, header.height, header.fps,
+                header.bitrate_bps / 1000, samples.size());
+    std::printf("  %-8s %-20s %6s %5s %5s %13s %9s %7s %11s %5s %-5s %s\n", "time", "fps out", "in/out",
+                "drop", "dup", "enc avg/max", "queue", "mem MB", "gpu MB", "power", "mode", "lvl");
+    uint32_t flagged = 0;
+    for (const auto& r : rows) {
+        // The last bucket may be cut short by the end of the window
+        const uint32_t span  = (std::min)(bucket, window.back().t_s - r.t_s + 1);
+        const double fps_in  = static_cast<double>(r.frames_in) / span;
+        const double fps_out = static_cast<double>(r.frames_out) / span;
+        const bool paused = (r.flags & sr::kPerfTracePaused) != 0;
+        const bool bad = !paused && (r.drops > 0 || (target > 0 && fps_out < target * 0.9));
+        flagged += bad ? 1 : 0;
+        char rate[24], encode[24], queue[16];
+        std::snprintf(rate, sizeof(rate), "%.0f/%.0f", fps_in, fps_out);
+        std::snprintf(encode, sizeof(encode), "%.1f/%.1f", r.encode_us_avg / 1000.0, r.encode_us_max / 1000.0);
+        std::snprintf(queue, sizeof(queue), "%.1f/%u", r.queue_avg_x100 / 100.0, r.queue_max);
+        std::printf("%c %-8s %-20s %6s %5u %5u %13s %9s %7s %11s %5s %-5s %u\n", bad ? '!' : ' ',
+                    clock_label(r.t_s).c_str(), paused ? "(paused)" : fps_bar(fps_out, target).c_str(), rate,
+                    r.drops, r.duplicates, encode, queue,
+                    (r.flags & sr::kPerfTraceMemory) ? std::to_string(r.private_mb).c_str() : "-",
+                    gpu_label(r).c_str(), (r.flags & sr::kPerfTraceOnAc) ? "AC" : "batt",
+                    sr::perf_trace_mode_label(r.encoder_mode), r.quality_level);
+    }
+    std::printf("%u of %zu rows below target or dropping\n", flagged, rows.size());
+    return 0;
+}